@@ -13,6 +13,7 @@ else
 	CFLAGS="$CFLAGS -O3" #--compiler-options -fno-strict-aliasing --compiler-options -fno-inline
 	CXXFLAGS="$CXXFLAGS -O3" #-fomit-frame-pointer"
 	AC_DEFINE([NDEBUG], [], [Description])
+	AC_DEFINE([ROFL_LOGGING_MAX_LEVEL], [9], [Strip TRACE logging statements])
 	AC_MSG_RESULT(no)
 fi
 AM_CONDITIONAL(DEBUG, test "$enable_debug" = yes)
@@ -0,0 +1,30 @@
+# Check for io_uring based I/O backend
+AC_MSG_CHECKING(whether to compile io_uring backend)
+io_uring_default="no"
+AC_ARG_ENABLE(io-uring,
+	AS_HELP_STRING([--enable-io-uring], [Compile io_uring based I/O backend for rofl::cioloop [default=no]])
+		, , enable_io_uring=$io_uring_default)
+
+if test "$enable_io_uring" = "yes"; then
+	AC_MSG_RESULT(yes)
+	AC_MSG_CHECKING(for io_uring with provided buffer rings in linux/io_uring.h)
+	AC_COMPILE_IFELSE([AC_LANG_PROGRAM([[
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+]], [[
+struct io_uring_buf_reg reg;
+struct io_uring_getevents_arg arg;
+(void)reg; (void)arg;
+return IORING_RECV_MULTISHOT + IORING_REGISTER_PBUF_RING + __NR_io_uring_setup
+	+ IORING_SETUP_SUBMIT_ALL + IORING_SETUP_COOP_TASKRUN;
+]])], [AC_MSG_RESULT(yes)], [
+		AC_MSG_RESULT(no)
+		AC_MSG_ERROR([io_uring requested, but linux/io_uring.h is missing or too old (Linux 5.19 or newer required)])])
+	AC_SUBST([ROFL_HAVE_IO_URING], ["#define ROFL_HAVE_IO_URING 1"])
+else
+	AC_SUBST([ROFL_HAVE_IO_URING], ["//Compiled without io_uring support"])
+	AC_MSG_RESULT(no)
+fi
+
+#Set automake conditional
+AM_CONDITIONAL(ROFL_HAVE_IO_URING, test "$enable_io_uring" = yes)
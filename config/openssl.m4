@@ -6,7 +6,7 @@ AC_ARG_WITH(ssl,
 		, ssl_detected="no",)
      
 if test "$ssl_detected" = "yes"; then
-	AC_CHECK_LIB(ssl, SSL_library_init, , ssl_detected="no")
+	AC_CHECK_LIB(ssl, SSL_CTX_new, , ssl_detected="no")
 	AC_CHECK_LIB(crypto, ERR_get_error, , ssl_detected="no")
 
 	AC_MSG_CHECKING(for availabilty of openssl and crypto libraries(SSL/TLS))
@@ -0,0 +1,378 @@
+/*
+ * cchecksum.cc
+ */
+
+#include "cchecksum.h"
+
+#include <string.h>
+#include <endian.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ROFL_CHECKSUM_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace rofl;
+
+namespace {
+
+typedef uint64_t (*sum_func_t)(const uint8_t*, size_t);
+
+/*
+ * Sums 32-bit words in host byte order, a trailing 16-bit word and byte
+ * are added as they appear in memory, i.e., padded with zero.
+ */
+uint64_t
+sum_scalar(
+		const uint8_t* buf,
+		size_t buflen)
+{
+	uint64_t sum0 = 0, sum1 = 0;
+	uint32_t w0, w1;
+	size_t i = 0;
+
+	for (; i + 8 <= buflen; i += 8) {
+		memcpy(&w0, buf + i, sizeof(w0));
+		memcpy(&w1, buf + i + 4, sizeof(w1));
+		sum0 += w0;
+		sum1 += w1;
+	}
+	if (i + 4 <= buflen) {
+		memcpy(&w0, buf + i, sizeof(w0));
+		sum0 += w0;
+		i += 4;
+	}
+	if (i + 2 <= buflen) {
+		uint16_t w = 0;
+		memcpy(&w, buf + i, sizeof(w));
+		sum1 += w;
+		i += 2;
+	}
+	if (i < buflen) {
+		uint8_t last[2] = { buf[i], 0 };
+		uint16_t w = 0;
+		memcpy(&w, last, sizeof(w));
+		sum1 += w;
+	}
+	return sum0 + sum1;
+}
+
+#ifdef ROFL_CHECKSUM_X86
+
+__attribute__((target("sse2")))
+uint64_t
+sum_sse2(
+		const uint8_t* buf,
+		size_t buflen)
+{
+	// widens 32-bit words into 64-bit lanes, no carries to be handled in the loop
+	__m128i zero = _mm_setzero_si128();
+	__m128i acc0 = _mm_setzero_si128();
+	__m128i acc1 = _mm_setzero_si128();
+	size_t i = 0;
+
+	for (; i + 32 <= buflen; i += 32) {
+		__m128i v0 = _mm_loadu_si128((const __m128i*)(buf + i));
+		__m128i v1 = _mm_loadu_si128((const __m128i*)(buf + i + 16));
+		acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v0, zero));
+		acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v0, zero));
+		acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v1, zero));
+		acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v1, zero));
+	}
+	if (i + 16 <= buflen) {
+		__m128i v0 = _mm_loadu_si128((const __m128i*)(buf + i));
+		acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v0, zero));
+		acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v0, zero));
+		i += 16;
+	}
+
+	uint64_t lanes[2];
+	_mm_storeu_si128((__m128i*)lanes, _mm_add_epi64(acc0, acc1));
+	return lanes[0] + lanes[1] + sum_scalar(buf + i, buflen - i);
+}
+
+__attribute__((target("avx2")))
+uint64_t
+sum_avx2(
+		const uint8_t* buf,
+		size_t buflen)
+{
+	__m256i zero = _mm256_setzero_si256();
+	__m256i acc0 = _mm256_setzero_si256();
+	__m256i acc1 = _mm256_setzero_si256();
+	size_t i = 0;
+
+	for (; i + 64 <= buflen; i += 64) {
+		__m256i v0 = _mm256_loadu_si256((const __m256i*)(buf + i));
+		__m256i v1 = _mm256_loadu_si256((const __m256i*)(buf + i + 32));
+		acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v0, zero));
+		acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v0, zero));
+		acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v1, zero));
+		acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v1, zero));
+	}
+	if (i + 32 <= buflen) {
+		__m256i v0 = _mm256_loadu_si256((const __m256i*)(buf + i));
+		acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v0, zero));
+		acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v0, zero));
+		i += 32;
+	}
+
+	uint64_t lanes[4];
+	_mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(acc0, acc1));
+	// avoids the penalty for mixing AVX and legacy SSE code in the remainder
+	_mm256_zeroupper();
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sum_scalar(buf + i, buflen - i);
+}
+
+__attribute__((target("sse4.2")))
+uint32_t
+crc32c_sse42(
+		const uint8_t* buf,
+		size_t buflen,
+		uint32_t crc)
+{
+	size_t i = 0;
+#ifdef __x86_64__
+	uint64_t crc64 = crc;
+	for (; i + 8 <= buflen; i += 8) {
+		uint64_t w;
+		memcpy(&w, buf + i, sizeof(w));
+		crc64 = _mm_crc32_u64(crc64, w);
+	}
+	crc = (uint32_t)crc64;
+#endif
+	for (; i + 4 <= buflen; i += 4) {
+		uint32_t w;
+		memcpy(&w, buf + i, sizeof(w));
+		crc = _mm_crc32_u32(crc, w);
+	}
+	for (; i < buflen; i++) {
+		crc = _mm_crc32_u8(crc, buf[i]);
+	}
+	return crc;
+}
+
+#endif
+
+/*
+ * Table for reflected CRC32C polynomial 0x82f63b78, used when the CPU
+ * lacks SSE4.2.
+ */
+struct crc32c_table_t {
+	uint32_t	table[256];
+
+	crc32c_table_t() {
+		for (uint32_t n = 0; n < 256; n++) {
+			uint32_t crc = n;
+			for (unsigned int k = 0; k < 8; k++) {
+				crc = (crc & 1) ? (crc >> 1) ^ 0x82f63b78 : (crc >> 1);
+			}
+			table[n] = crc;
+		}
+	};
+};
+
+uint32_t
+crc32c_scalar(
+		const uint8_t* buf,
+		size_t buflen,
+		uint32_t crc)
+{
+	static crc32c_table_t const crc32c_table;
+	for (size_t i = 0; i < buflen; i++) {
+		crc = crc32c_table.table[(crc ^ buf[i]) & 0xff] ^ (crc >> 8);
+	}
+	return crc;
+}
+
+bool
+cpu_supports(
+		enum cchecksum::cchecksum_impl_t impl)
+{
+	switch (impl) {
+	case cchecksum::IMPL_SCALAR:
+		return true;
+#ifdef ROFL_CHECKSUM_X86
+	case cchecksum::IMPL_SSE2:
+		return __builtin_cpu_supports("sse2");
+	case cchecksum::IMPL_AVX2:
+		return __builtin_cpu_supports("avx2");
+#endif
+	default:
+		return false;
+	}
+}
+
+sum_func_t
+impl2func(
+		enum cchecksum::cchecksum_impl_t impl)
+{
+	switch (impl) {
+#ifdef ROFL_CHECKSUM_X86
+	case cchecksum::IMPL_SSE2:
+		return &sum_sse2;
+	case cchecksum::IMPL_AVX2:
+		return &sum_avx2;
+#endif
+	default:
+		return &sum_scalar;
+	}
+}
+
+/*
+ * Scalar implementation until the CPU has been probed during static
+ * initialization of this library.
+ */
+enum cchecksum::cchecksum_impl_t	sum_impl		= cchecksum::IMPL_SCALAR;
+sum_func_t							sum_func		= &sum_scalar;
+bool								crc32c_hw		= false;
+
+struct cpu_probe_t {
+	cpu_probe_t() {
+		enum cchecksum::cchecksum_impl_t impl = cchecksum::IMPL_SCALAR;
+		if (cpu_supports(cchecksum::IMPL_AVX2)) {
+			impl = cchecksum::IMPL_AVX2;
+		} else
+		if (cpu_supports(cchecksum::IMPL_SSE2)) {
+			impl = cchecksum::IMPL_SSE2;
+		}
+		__atomic_store_n(&sum_func, impl2func(impl), __ATOMIC_RELAXED);
+		__atomic_store_n(&sum_impl, impl, __ATOMIC_RELAXED);
+#ifdef ROFL_CHECKSUM_X86
+		crc32c_hw = __builtin_cpu_supports("sse4.2");
+#endif
+	};
+} cpu_probe;
+
+}; // end of anonymous namespace
+
+
+
+/*static*/uint32_t
+cchecksum::sum(
+		const void* buf,
+		size_t buflen,
+		uint32_t initial)
+{
+	sum_func_t func = __atomic_load_n(&sum_func, __ATOMIC_RELAXED);
+	uint64_t sum = func((const uint8_t*)buf, buflen) + initial;
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	return (uint32_t)sum;
+}
+
+
+
+/*static*/uint32_t
+cchecksum::sum_pseudo_in4(
+		uint32_t src,
+		uint32_t dst,
+		uint8_t proto,
+		uint16_t length)
+{
+	uint64_t sum = (uint64_t)src + dst + htobe16((uint16_t)proto) + htobe16(length);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	return (uint32_t)sum;
+}
+
+
+
+/*static*/uint32_t
+cchecksum::sum_pseudo_in6(
+		const uint8_t* src,
+		const uint8_t* dst,
+		uint8_t proto,
+		uint32_t length)
+{
+	uint64_t sum = sum_scalar(src, 16) + sum_scalar(dst, 16);
+	uint32_t len = htobe32(length);
+	uint32_t nxt = htobe32((uint32_t)proto);
+	sum += len;
+	sum += nxt;
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	return (uint32_t)sum;
+}
+
+
+
+/*static*/uint16_t
+cchecksum::update(
+		uint16_t check,
+		const void* oldbuf,
+		const void* newbuf,
+		size_t buflen)
+{
+	// HC' = ~(~HC + ~m + m'), with fold() returning ~m
+	uint32_t sum = (uint16_t)~check;
+	sum += fold(cchecksum::sum(oldbuf, buflen));
+	sum = cchecksum::sum(newbuf, buflen, sum);
+	return fold(sum);
+}
+
+
+
+/*static*/uint32_t
+cchecksum::crc32c(
+		const void* buf,
+		size_t buflen,
+		uint32_t crc)
+{
+#ifdef ROFL_CHECKSUM_X86
+	if (crc32c_hw)
+		return ~crc32c_sse42((const uint8_t*)buf, buflen, ~crc);
+#endif
+	return ~crc32c_scalar((const uint8_t*)buf, buflen, ~crc);
+}
+
+
+
+/*static*/enum cchecksum::cchecksum_impl_t
+cchecksum::get_impl()
+{
+	return __atomic_load_n(&sum_impl, __ATOMIC_RELAXED);
+}
+
+
+
+/*static*/void
+cchecksum::set_impl(
+		enum cchecksum_impl_t impl)
+{
+	if (not cpu_supports(impl)) {
+		throw eChecksumUnsupported("cchecksum::set_impl() implementation not supported by CPU");
+	}
+	__atomic_store_n(&sum_func, impl2func(impl), __ATOMIC_RELAXED);
+	__atomic_store_n(&sum_impl, impl, __ATOMIC_RELAXED);
+}
+
+
+
+/*static*/bool
+cchecksum::has_impl(
+		enum cchecksum_impl_t impl)
+{
+	return cpu_supports(impl);
+}
+
+
+
+/*static*/bool
+cchecksum::has_crc32c_hw()
+{
+	return crc32c_hw;
+}
+
+
+
+/*static*/const char*
+cchecksum::impl2str(
+		enum cchecksum_impl_t impl)
+{
+	switch (impl) {
+	case IMPL_SCALAR:	return "scalar";
+	case IMPL_SSE2:		return "sse2";
+	case IMPL_AVX2:		return "avx2";
+	default:			return "unknown";
+	}
+}
@@ -0,0 +1,192 @@
+/*
+ * cchecksum.h
+ */
+
+#ifndef CCHECKSUM_H_
+#define CCHECKSUM_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#include "rofl/common/croflexception.h"
+
+namespace rofl {
+
+class eChecksumBase 		: public RoflException {
+public:
+	eChecksumBase(const std::string& __arg = std::string("eChecksumBase")) : RoflException(__arg) {};
+};
+class eChecksumUnsupported 	: public eChecksumBase {
+public:
+	eChecksumUnsupported(const std::string& __arg = std::string("eChecksumUnsupported")) : eChecksumBase(__arg) {};
+};
+
+/**
+ * @ingroup common_devel_protocols
+ * @brief	Internet checksum (RFC 1071) and CRC32C used by the protocol frames
+ *
+ * The one's complement sum is computed over 32-bit words in host byte order
+ * with 64-bit accumulators, vectorized with SSE2 or AVX2 on x86 when the CPU
+ * supports it, selected at runtime. As the one's complement sum is byte order
+ * independent, all 16-bit values taken and returned by this class are in
+ * network byte order, i.e., as stored in a protocol header, and a checksum
+ * may be assigned to a header field without conversion.
+ *
+ * For rewriting single header fields the checksum may be updated
+ * incrementally instead (RFC 1624, eqn. 3). CRC32C for SCTP (RFC 4960) uses
+ * the SSE4.2 crc32 instruction when available.
+ */
+class cchecksum {
+public:
+
+	enum cchecksum_impl_t {
+		IMPL_SCALAR			= 0,
+		IMPL_SSE2			= 1,
+		IMPL_AVX2			= 2,
+	};
+
+public:
+
+	/**
+	 * @brief	Returns the partial one's complement sum of buf, e.g., for chaining a pseudo header and a payload.
+	 *
+	 * All but the last buffer of a chain must have an even length.
+	 */
+	static uint32_t
+	sum(
+			const void* buf,
+			size_t buflen,
+			uint32_t initial = 0);
+
+	/**
+	 * @brief	Folds a partial sum to 16 bits and returns its complement, i.e., the checksum.
+	 */
+	static uint16_t
+	fold(
+			uint32_t sum)
+	{
+		sum = (sum & 0xffff) + (sum >> 16);
+		sum = (sum & 0xffff) + (sum >> 16);
+		return (uint16_t)~sum;
+	};
+
+	/**
+	 * @brief	Returns the checksum of buf including a partial sum initial, e.g., of a pseudo header.
+	 */
+	static uint16_t
+	checksum(
+			const void* buf,
+			size_t buflen,
+			uint32_t initial = 0)
+	{ return fold(sum(buf, buflen, initial)); };
+
+	/**
+	 * @brief	Returns the partial sum of an IPv4 pseudo header, addresses in network byte order.
+	 */
+	static uint32_t
+	sum_pseudo_in4(
+			uint32_t src,
+			uint32_t dst,
+			uint8_t proto,
+			uint16_t length);
+
+	/**
+	 * @brief	Returns the partial sum of an IPv6 pseudo header, addresses are 16 bytes each.
+	 */
+	static uint32_t
+	sum_pseudo_in6(
+			const uint8_t* src,
+			const uint8_t* dst,
+			uint8_t proto,
+			uint32_t length);
+
+	/**
+	 * @brief	Updates checksum check after rewriting a 16-bit field from oldval to newval (RFC 1624).
+	 *
+	 * The field must reside at an even offset within the checksummed data.
+	 */
+	static uint16_t
+	update16(
+			uint16_t check,
+			uint16_t oldval,
+			uint16_t newval)
+	{
+		uint32_t sum = (uint16_t)~check + (uint32_t)(uint16_t)~oldval + newval;
+		sum = (sum & 0xffff) + (sum >> 16);
+		sum = (sum & 0xffff) + (sum >> 16);
+		return (uint16_t)~sum;
+	};
+
+	/**
+	 * @brief	Updates checksum check after rewriting a 32-bit field from oldval to newval, e.g., an IPv4 address.
+	 */
+	static uint16_t
+	update32(
+			uint16_t check,
+			uint32_t oldval,
+			uint32_t newval)
+	{
+		check = update16(check, (uint16_t)(oldval >> 16), (uint16_t)(newval >> 16));
+		return update16(check, (uint16_t)(oldval & 0xffff), (uint16_t)(newval & 0xffff));
+	};
+
+	/**
+	 * @brief	Updates checksum check after rewriting a field of even length buflen, e.g., a MAC or IPv6 address.
+	 */
+	static uint16_t
+	update(
+			uint16_t check,
+			const void* oldbuf,
+			const void* newbuf,
+			size_t buflen);
+
+	/**
+	 * @brief	Returns CRC32C (Castagnoli) of buf, crc continues a previous calculation.
+	 */
+	static uint32_t
+	crc32c(
+			const void* buf,
+			size_t buflen,
+			uint32_t crc = 0);
+
+public:
+
+	/**
+	 * @brief	Returns the implementation used by sum().
+	 */
+	static enum cchecksum_impl_t
+	get_impl();
+
+	/**
+	 * @brief	Selects the implementation used by sum(), e.g., for benchmarks.
+	 *
+	 * @throws eChecksumUnsupported when the CPU lacks support for impl
+	 */
+	static void
+	set_impl(
+			enum cchecksum_impl_t impl);
+
+	/**
+	 * @brief	Returns true when impl is supported by the CPU.
+	 */
+	static bool
+	has_impl(
+			enum cchecksum_impl_t impl);
+
+	/**
+	 * @brief	Returns true when crc32c() uses the SSE4.2 crc32 instruction.
+	 */
+	static bool
+	has_crc32c_hw();
+
+	/**
+	 * @brief	Returns a name for impl.
+	 */
+	static const char*
+	impl2str(
+			enum cchecksum_impl_t impl);
+};
+
+}; // end of namespace rofl
+
+#endif /* CCHECKSUM_H_ */
@@ -79,3 +79,13 @@ cevents::clear()
 }
 
 
+
+void
+cevents::swap(cevents& evs)
+{
+	if (this == &evs)
+		return;
+	RwLock lock1(rwlock, RwLock::RWLOCK_WRITE);
+	RwLock lock2(evs.rwlock, RwLock::RWLOCK_WRITE);
+	events.swap(evs.events);
+}
@@ -76,6 +76,12 @@ public:
 	void
 	clear();
 
+	/**
+	 * @brief	Exchanges content with evs atomically with respect to add_event().
+	 */
+	void
+	swap(cevents& evs);
+
 public:
 
 	friend std::ostream&
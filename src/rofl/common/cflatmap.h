@@ -0,0 +1,233 @@
+/*
+ * cflatmap.h
+ */
+
+#ifndef CFLATMAP_H_
+#define CFLATMAP_H_
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+namespace rofl {
+
+/**
+ * @brief	Associative container stored as a vector sorted by key
+ *
+ * Provides the subset of the std::map interface used for small
+ * collections within rofl-common. Elements are kept contiguously
+ * in ascending key order, so iteration walks a single array and
+ * lookup is a binary search. Inserting or erasing an element
+ * invalidates all iterators and references, unlike std::map.
+ */
+template<typename K, typename V>
+class cflatmap {
+public:
+
+	/**
+	 * @brief	Capacity reserved on first insertion
+	 */
+	static size_t const INITIAL_CAPACITY = 8;
+
+	typedef K 										key_type;
+	typedef V 										mapped_type;
+	typedef std::pair<K, V> 						value_type;
+	typedef typename std::vector<value_type>::iterator 			iterator;
+	typedef typename std::vector<value_type>::const_iterator 	const_iterator;
+
+public:
+
+	/**
+	 *
+	 */
+	cflatmap()
+	{};
+
+	/**
+	 *
+	 */
+	iterator
+	begin() { return elems.begin(); };
+
+	/**
+	 *
+	 */
+	const_iterator
+	begin() const { return elems.begin(); };
+
+	/**
+	 *
+	 */
+	iterator
+	end() { return elems.end(); };
+
+	/**
+	 *
+	 */
+	const_iterator
+	end() const { return elems.end(); };
+
+	/**
+	 *
+	 */
+	size_t
+	size() const { return elems.size(); };
+
+	/**
+	 *
+	 */
+	bool
+	empty() const { return elems.empty(); };
+
+	/**
+	 *
+	 */
+	void
+	clear() { elems.clear(); };
+
+	/**
+	 *
+	 */
+	void
+	reserve(
+			size_t n) { elems.reserve(n); };
+
+	/**
+	 * @brief	Returns iterator to first element with key not less than key.
+	 */
+	iterator
+	lower_bound(
+			const K& key)
+	{ return std::lower_bound(elems.begin(), elems.end(), key, key_less()); };
+
+	/**
+	 * @brief	Returns iterator to first element with key not less than key.
+	 */
+	const_iterator
+	lower_bound(
+			const K& key) const
+	{ return std::lower_bound(elems.begin(), elems.end(), key, key_less()); };
+
+	/**
+	 *
+	 */
+	iterator
+	find(
+			const K& key) {
+		iterator it = lower_bound(key);
+		return ((it != elems.end()) && (it->first == key)) ? it : elems.end();
+	};
+
+	/**
+	 *
+	 */
+	const_iterator
+	find(
+			const K& key) const {
+		const_iterator it = lower_bound(key);
+		return ((it != elems.end()) && (it->first == key)) ? it : elems.end();
+	};
+
+	/**
+	 *
+	 */
+	size_t
+	count(
+			const K& key) const { return (find(key) == end()) ? 0 : 1; };
+
+	/**
+	 * @brief	Returns element for key, inserts a default value if none exists.
+	 */
+	V&
+	operator[] (
+			const K& key) {
+		iterator it = lower_bound(key);
+		if ((it == elems.end()) || (it->first != key)) {
+			it = insert_at(it, value_type(key, V()));
+		}
+		return it->second;
+	};
+
+	/**
+	 * @throws std::out_of_range when key does not exist
+	 */
+	V&
+	at(
+			const K& key) {
+		iterator it = find(key);
+		if (it == elems.end())
+			throw std::out_of_range("cflatmap::at()");
+		return it->second;
+	};
+
+	/**
+	 * @throws std::out_of_range when key does not exist
+	 */
+	const V&
+	at(
+			const K& key) const {
+		const_iterator it = find(key);
+		if (it == elems.end())
+			throw std::out_of_range("cflatmap::at()");
+		return it->second;
+	};
+
+	/**
+	 * @brief	Inserts elem unless its key exists already.
+	 */
+	std::pair<iterator, bool>
+	insert(
+			const value_type& elem) {
+		iterator it = lower_bound(elem.first);
+		if ((it != elems.end()) && (it->first == elem.first)) {
+			return std::pair<iterator, bool>(it, false);
+		}
+		return std::pair<iterator, bool>(insert_at(it, elem), true);
+	};
+
+	/**
+	 *
+	 */
+	void
+	erase(
+			iterator it) { elems.erase(it); };
+
+	/**
+	 *
+	 */
+	size_t
+	erase(
+			const K& key) {
+		iterator it = find(key);
+		if (it == elems.end())
+			return 0;
+		elems.erase(it);
+		return 1;
+	};
+
+private:
+
+	iterator
+	insert_at(
+			iterator it,
+			const value_type& elem) {
+		if (elems.capacity() == 0) {
+			elems.reserve(INITIAL_CAPACITY); // it == end() for an empty vector
+			return elems.insert(elems.end(), elem);
+		}
+		return elems.insert(it, elem);
+	};
+
+	struct key_less {
+		bool
+		operator() (const value_type& elem, const K& key) const
+		{ return (elem.first < key); };
+	};
+
+	std::vector<value_type>		elems;
+};
+
+}; // end of namespace rofl
+
+#endif /* CFLATMAP_H_ */
@@ -0,0 +1,462 @@
+/*
+ * cioring.cc
+ */
+
+#include "cioring.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#ifdef ROFL_HAVE_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+using namespace rofl;
+
+#ifdef ROFL_HAVE_IO_URING
+
+namespace {
+
+/*
+ * the provided buffer group used for all receive operations
+ */
+static uint16_t const BUFFER_GROUP = 0;
+
+inline int
+sys_io_uring_setup(unsigned int entries, struct io_uring_params* p)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+inline int
+sys_io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+		unsigned int flags, void* arg, size_t argsz)
+{
+	return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+inline int
+sys_io_uring_register(int fd, unsigned int opcode, void* arg, unsigned int nr_args)
+{
+	return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+}; // end of anonymous namespace
+
+
+
+bool
+cioring::is_compiled_in()
+{
+	return true;
+}
+
+
+
+cioring::cioring(
+		unsigned int entries,
+		unsigned int num_buffers,
+		size_t buffer_size) :
+				fd(-1),
+				sq_ring(MAP_FAILED),
+				sq_ring_size(0),
+				sqes(MAP_FAILED),
+				sqes_size(0),
+				sq_head(NULL),
+				sq_tail(NULL),
+				sq_array(NULL),
+				sq_mask(0),
+				sq_entries(0),
+				sqe_tail(0),
+				sqe_head(0),
+				cq_ring(MAP_FAILED),
+				cq_ring_size(0),
+				cq_head(NULL),
+				cq_tail(NULL),
+				cq_mask(0),
+				cqes(NULL),
+				buf_ring(MAP_FAILED),
+				buf_ring_size(0),
+				buffers(NULL),
+				num_buffers(num_buffers),
+				buffer_size(buffer_size),
+				buf_tail(0),
+				num_enters(0)
+{
+	if ((0 == num_buffers) || (num_buffers & (num_buffers - 1)) || (num_buffers > 32768)) {
+		throw eInval("cioring::cioring() num_buffers must be a power of 2");
+	}
+	try {
+		setup(entries);
+	} catch (...) {
+		teardown();
+		throw;
+	}
+}
+
+
+
+void
+cioring::setup(
+		unsigned int entries)
+{
+	struct io_uring_params p;
+
+	// task running and submission flags are optional, retry without them on older kernels
+	memset(&p, 0, sizeof(p));
+	p.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+	p.cq_entries = 4 * entries;
+	if ((fd = sys_io_uring_setup(entries, &p)) < 0) {
+		memset(&p, 0, sizeof(p));
+		p.flags = IORING_SETUP_CQSIZE;
+		p.cq_entries = 4 * entries;
+		if ((fd = sys_io_uring_setup(entries, &p)) < 0) {
+			switch (errno) {
+			case ENOSYS:
+			case EPERM:
+				throw eIoRingNotSupported("io_uring_setup() not permitted");
+			default:
+				throw eSysCall("io_uring_setup()");
+			}
+		}
+	}
+
+	unsigned int const required =
+			IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+	if ((p.features & required) != required) {
+		throw eIoRingNotSupported("io_uring lacks required features");
+	}
+
+	sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+	cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (cq_ring_size > sq_ring_size)
+		sq_ring_size = cq_ring_size;
+	cq_ring_size = 0; // single mapping shared by both rings
+
+	if ((sq_ring = mmap(NULL, sq_ring_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING)) == MAP_FAILED) {
+		throw eSysCall("mmap(IORING_OFF_SQ_RING)");
+	}
+	cq_ring = sq_ring;
+
+	sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+	if ((sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES)) == MAP_FAILED) {
+		throw eSysCall("mmap(IORING_OFF_SQES)");
+	}
+
+	uint8_t* sq = (uint8_t*)sq_ring;
+	sq_head 	= (unsigned int*)(sq + p.sq_off.head);
+	sq_tail 	= (unsigned int*)(sq + p.sq_off.tail);
+	sq_array 	= (unsigned int*)(sq + p.sq_off.array);
+	sq_mask 	= *(unsigned int*)(sq + p.sq_off.ring_mask);
+	sq_entries 	= p.sq_entries;
+	sqe_tail = sqe_head = *sq_tail;
+
+	uint8_t* cq = (uint8_t*)cq_ring;
+	cq_head 	= (unsigned int*)(cq + p.cq_off.head);
+	cq_tail 	= (unsigned int*)(cq + p.cq_off.tail);
+	cq_mask 	= *(unsigned int*)(cq + p.cq_off.ring_mask);
+	cqes 		= (void*)(cq + p.cq_off.cqes);
+
+	// ring of provided buffers, page aligned by mmap()
+	buf_ring_size = num_buffers * sizeof(struct io_uring_buf);
+	if ((buf_ring = mmap(NULL, buf_ring_size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED) {
+		throw eSysCall("mmap(buffer ring)");
+	}
+	if ((buffers = (uint8_t*)malloc(num_buffers * buffer_size)) == NULL) {
+		throw eSysCall("malloc(buffers)");
+	}
+
+	struct io_uring_buf_reg reg;
+	memset(&reg, 0, sizeof(reg));
+	reg.ring_addr = (uint64_t)(uintptr_t)buf_ring;
+	reg.ring_entries = num_buffers;
+	reg.bgid = BUFFER_GROUP;
+	if (sys_io_uring_register(fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+		switch (errno) {
+		case EINVAL:
+		case EOPNOTSUPP:
+			throw eIoRingNotSupported("io_uring lacks provided buffer rings");
+		default:
+			throw eSysCall("io_uring_register(IORING_REGISTER_PBUF_RING)");
+		}
+	}
+
+	for (unsigned int bid = 0; bid < num_buffers; bid++) {
+		recycle_buffer(bid);
+	}
+}
+
+
+
+cioring::~cioring()
+{
+	teardown();
+}
+
+
+
+void
+cioring::teardown()
+{
+	if (fd >= 0)
+		::close(fd);
+	if (buf_ring != MAP_FAILED)
+		munmap(buf_ring, buf_ring_size);
+	if (buffers != NULL)
+		free(buffers);
+	if (sqes != MAP_FAILED)
+		munmap(sqes, sqes_size);
+	if (sq_ring != MAP_FAILED)
+		munmap(sq_ring, sq_ring_size);
+	fd = -1;
+	buf_ring = sqes = sq_ring = MAP_FAILED;
+	buffers = NULL;
+}
+
+
+
+void*
+cioring::get_sqe()
+{
+	// submission queue full: hand prepared entries over to the kernel first
+	if ((sqe_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE)) >= sq_entries) {
+		enter(false);
+		if ((sqe_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE)) >= sq_entries) {
+			throw eSysCall("io_uring submission queue overflow");
+		}
+	}
+	unsigned int index = sqe_tail & sq_mask;
+	struct io_uring_sqe* sqe = (struct io_uring_sqe*)sqes + index;
+	memset(sqe, 0, sizeof(*sqe));
+	sq_array[index] = index;
+	sqe_tail++;
+	return sqe;
+}
+
+
+
+void
+cioring::prep_poll(
+		int fd, uint64_t user_data)
+{
+	struct io_uring_sqe* sqe = (struct io_uring_sqe*)get_sqe();
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fd;
+	sqe->poll32_events = POLLIN;
+	sqe->len = IORING_POLL_ADD_MULTI;
+	sqe->user_data = user_data;
+}
+
+
+
+void
+cioring::prep_recv(
+		int fd, bool multishot, uint64_t user_data)
+{
+	struct io_uring_sqe* sqe = (struct io_uring_sqe*)get_sqe();
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = fd;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = BUFFER_GROUP;
+	sqe->ioprio = multishot ? IORING_RECV_MULTISHOT : 0;
+	sqe->user_data = user_data;
+}
+
+
+
+void
+cioring::prep_sendmsg(
+		int fd, const struct msghdr* msg, int flags, uint64_t user_data)
+{
+	struct io_uring_sqe* sqe = (struct io_uring_sqe*)get_sqe();
+	sqe->opcode = IORING_OP_SENDMSG;
+	sqe->fd = fd;
+	sqe->addr = (uint64_t)(uintptr_t)msg;
+	sqe->len = 1;
+	sqe->msg_flags = flags;
+	sqe->user_data = user_data;
+}
+
+
+
+void
+cioring::prep_cancel(
+		uint64_t target, uint64_t user_data)
+{
+	struct io_uring_sqe* sqe = (struct io_uring_sqe*)get_sqe();
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = target;
+	sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL;
+	sqe->user_data = user_data;
+}
+
+
+
+int
+cioring::enter(
+		bool wait,
+		const struct timespec* ts,
+		const sigset_t* sigmask)
+{
+	// publish prepared entries
+	if (sqe_tail != sqe_head) {
+		__atomic_store_n(sq_tail, sqe_tail, __ATOMIC_RELEASE);
+	}
+	unsigned int to_submit = sqe_tail - sqe_head;
+
+	if ((0 == to_submit) && not wait) {
+		return 0;
+	}
+
+	struct __kernel_timespec kts;
+	struct io_uring_getevents_arg arg;
+	memset(&arg, 0, sizeof(arg));
+	unsigned int flags = 0;
+	if (wait) {
+		flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+		arg.sigmask = (uint64_t)(uintptr_t)sigmask;
+		arg.sigmask_sz = _NSIG / 8;
+		if (ts != NULL) {
+			kts.tv_sec = ts->tv_sec;
+			kts.tv_nsec = ts->tv_nsec;
+			arg.ts = (uint64_t)(uintptr_t)&kts;
+		}
+	}
+
+	num_enters++;
+	int rc = sys_io_uring_enter(fd, to_submit, wait ? 1 : 0, flags,
+			wait ? &arg : NULL, wait ? sizeof(arg) : 0);
+	if (rc < 0) {
+		return -errno;
+	}
+	sqe_head += rc;
+	return 0;
+}
+
+
+
+bool
+cioring::next_completion(
+		ccompletion& completion)
+{
+	unsigned int head = *cq_head;
+	if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+		return false;
+	}
+	struct io_uring_cqe* cqe = (struct io_uring_cqe*)cqes + (head & cq_mask);
+	completion.user_data = cqe->user_data;
+	completion.res = cqe->res;
+	completion.flags = cqe->flags;
+	__atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+
+
+void
+cioring::recycle_buffer(
+		uint16_t bid)
+{
+	/*
+	 * struct io_uring_buf_ring declares its flexible array via an empty
+	 * struct, which occupies a byte in C++: address entries directly,
+	 * the tail overlays the resv field of the first entry
+	 */
+	struct io_uring_buf* bufs = (struct io_uring_buf*)buf_ring;
+	struct io_uring_buf* buf = &bufs[buf_tail & (num_buffers - 1)];
+	buf->addr = (uint64_t)(uintptr_t)(buffers + (size_t)bid * buffer_size);
+	buf->len = buffer_size;
+	buf->bid = bid;
+	buf_tail++;
+	__atomic_store_n(&bufs[0].resv, buf_tail, __ATOMIC_RELEASE);
+}
+
+#else
+
+bool
+cioring::is_compiled_in()
+{
+	return false;
+}
+
+
+
+cioring::cioring(
+		unsigned int entries,
+		unsigned int num_buffers,
+		size_t buffer_size) :
+				fd(-1),
+				num_enters(0)
+{
+	throw eIoRingNotSupported("compiled without io_uring support");
+}
+
+
+
+cioring::~cioring()
+{}
+
+
+
+void
+cioring::prep_poll(
+		int fd, uint64_t user_data)
+{}
+
+
+
+void
+cioring::prep_recv(
+		int fd, bool multishot, uint64_t user_data)
+{}
+
+
+
+void
+cioring::prep_sendmsg(
+		int fd, const struct msghdr* msg, int flags, uint64_t user_data)
+{}
+
+
+
+void
+cioring::prep_cancel(
+		uint64_t target, uint64_t user_data)
+{}
+
+
+
+int
+cioring::enter(
+		bool wait,
+		const struct timespec* ts,
+		const sigset_t* sigmask)
+{
+	return -ENOSYS;
+}
+
+
+
+bool
+cioring::next_completion(
+		ccompletion& completion)
+{
+	return false;
+}
+
+
+
+void
+cioring::recycle_buffer(
+		uint16_t bid)
+{}
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ * cioring.h
+ */
+
+#ifndef CIORING_H_
+#define CIORING_H_
+
+#include <inttypes.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "rofl_common_conf.h"
+#include "rofl/common/croflexception.h"
+
+namespace rofl {
+
+class eIoRingBase 			: public RoflException {
+public:
+	eIoRingBase(const std::string& __arg = std::string("eIoRingBase")) : RoflException(__arg) {};
+};
+class eIoRingNotSupported 	: public eIoRingBase {
+public:
+	eIoRingNotSupported(const std::string& __arg = std::string("eIoRingNotSupported")) : eIoRingBase(__arg) {};
+};
+
+/**
+ * @brief	Minimal wrapper around a Linux io_uring instance
+ *
+ * Used by rofl::cioloop as an alternative to epoll: submission and
+ * completion queues are mapped into user space, so a single call to
+ * enter() submits all operations prepared since the last call and
+ * waits for completions. Receive operations select their buffers from
+ * a ring of provided buffers owned by this instance.
+ *
+ * Not thread-safe, all methods must be called by the loop's thread.
+ * Requires Linux 5.19 or newer, the constructor throws
+ * eIoRingNotSupported on older kernels or when compiled without
+ * io_uring support (see configure option --enable-io-uring).
+ */
+class cioring {
+public:
+
+	/**
+	 * @brief	A completed operation
+	 */
+	struct ccompletion {
+		uint64_t	user_data;
+		int32_t		res;
+		uint32_t	flags;
+	};
+
+	/**
+	 * @brief	Completion flags
+	 */
+	enum cioring_completion_flag_t {
+		COMPLETION_F_BUFFER		= (1 << 0),	/**< provided buffer in use, id in upper 16 bits */
+		COMPLETION_F_MORE		= (1 << 1),	/**< multishot operation remains armed */
+	};
+
+	/**
+	 * @brief	Returns true when io_uring support has been compiled in.
+	 */
+	static bool
+	is_compiled_in();
+
+public:
+
+	/**
+	 * @param entries size of submission queue, completion queue has four times this size
+	 * @param num_buffers number of provided receive buffers, power of 2
+	 * @param buffer_size size of a single provided receive buffer
+	 * @throws eIoRingNotSupported when the kernel lacks any of the required features
+	 * @throws eSysCall on any other failure
+	 */
+	cioring(
+			unsigned int entries,
+			unsigned int num_buffers,
+			size_t buffer_size);
+
+	/**
+	 *
+	 */
+	~cioring();
+
+public:
+
+	/**
+	 * @brief	Prepares a multishot poll for read events on fd.
+	 */
+	void
+	prep_poll(
+			int fd, uint64_t user_data);
+
+	/**
+	 * @brief	Prepares a receive on fd into a provided buffer.
+	 */
+	void
+	prep_recv(
+			int fd, bool multishot, uint64_t user_data);
+
+	/**
+	 * @brief	Prepares a sendmsg() on fd, msg must remain valid until completion.
+	 */
+	void
+	prep_sendmsg(
+			int fd, const struct msghdr* msg, int flags, uint64_t user_data);
+
+	/**
+	 * @brief	Prepares cancellation of all operations identified by target.
+	 */
+	void
+	prep_cancel(
+			uint64_t target, uint64_t user_data);
+
+	/**
+	 * @brief	Submits all prepared operations and optionally waits for a completion.
+	 *
+	 * @param wait wait for at least one completion, until ts expires
+	 * @param ts relative timeout, used when wait is true
+	 * @param sigmask signal mask applied while waiting, may be NULL
+	 * @return 0 on success or a negative error code, e.g., -ETIME or -EINTR
+	 */
+	int
+	enter(
+			bool wait,
+			const struct timespec* ts = NULL,
+			const sigset_t* sigmask = NULL);
+
+	/**
+	 * @brief	Pops the next completion, returns false when none is pending.
+	 */
+	bool
+	next_completion(
+			ccompletion& cqe);
+
+	/**
+	 * @brief	Returns provided buffer bid.
+	 */
+	const uint8_t*
+	get_buffer(
+			uint16_t bid) const
+	{ return buffers + (size_t)bid * buffer_size; };
+
+	/**
+	 * @brief	Returns provided buffer bid to the kernel.
+	 */
+	void
+	recycle_buffer(
+			uint16_t bid);
+
+	/**
+	 * @brief	Returns number of system calls issued by enter().
+	 */
+	uint64_t
+	get_num_enters() const
+	{ return num_enters; };
+
+private:
+
+	cioring(
+			const cioring& ring);
+
+	cioring&
+	operator= (
+			const cioring& ring);
+
+	void*
+	get_sqe();
+
+	void
+	setup(
+			unsigned int entries);
+
+	void
+	teardown();
+
+private:
+
+	int					fd;
+
+	void*				sq_ring;
+	size_t				sq_ring_size;
+	void*				sqes;
+	size_t				sqes_size;
+	unsigned int*		sq_head;
+	unsigned int*		sq_tail;
+	unsigned int*		sq_array;
+	unsigned int		sq_mask;
+	unsigned int		sq_entries;
+	unsigned int		sqe_tail;		// prepared, not yet published
+	unsigned int		sqe_head;		// published, not yet consumed by enter()
+
+	void*				cq_ring;
+	size_t				cq_ring_size;
+	unsigned int*		cq_head;
+	unsigned int*		cq_tail;
+	unsigned int		cq_mask;
+	void*				cqes;
+
+	void*				buf_ring;
+	size_t				buf_ring_size;
+	uint8_t*			buffers;
+	unsigned int		num_buffers;
+	size_t				buffer_size;
+	uint16_t			buf_tail;
+
+	uint64_t			num_enters;
+};
+
+}; // end of namespace rofl
+
+#endif /* CIORING_H_ */
@@ -3,13 +3,112 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "rofl/common/ciosrv.h"
+#include "rofl/common/cioring.h"
+
+#include <sys/uio.h>
+#include <sys/socket.h>
 
 using namespace rofl;
 
+namespace {
+
+/*
+ * user_data of io_uring operations: operation type in the lowest two
+ * bits, receives carry descriptor and generation of their slot, sends
+ * a pointer to their cringtx instance
+ */
+enum ring_op_t {
+	RING_OP_POLL	= 0,
+	RING_OP_RECV	= 1,
+	RING_OP_SEND	= 2,
+	RING_OP_CANCEL	= 3,
+};
+
+static uint64_t const RING_OP_MASK = 0x3;
+
+inline uint64_t
+ring_recv_id(int fd, uint32_t gen)
+{
+	return ((uint64_t)gen << 32) | ((uint64_t)(fd & 0x3fffffff) << 2) | RING_OP_RECV;
+}
+
+cioloop::cioloop_backend_t
+backend_from_env()
+{
+	const char* value = getenv("ROFL_IOLOOP_BACKEND");
+	if ((NULL != value) && (strcmp(value, "io_uring") == 0)) {
+		return cioloop::BACKEND_IO_URING;
+	}
+	return cioloop::BACKEND_EPOLL;
+}
+
+}; // end of anonymous namespace
+
 /*static*/PthreadRwLock 				cioloop::threads_lock;
 /*static*/std::map<pthread_t, int> 		cioloop::threads;
 /*static*/PthreadRwLock 				cioloop::loops_rwlock;
 /*static*/std::map<pthread_t, cioloop*> cioloop::loops;
+/*static*/enum cioloop::cioloop_backend_t volatile cioloop::default_backend = backend_from_env();
+/*static*/unsigned int const			cioloop::RING_ENTRIES = 256;
+/*static*/unsigned int const			cioloop::RING_NUM_BUFFERS = 256;
+/*static*/size_t const					cioloop::RING_BUFFER_SIZE = 4096;
+/*static*/unsigned int const			cioloop::RING_MAX_TX_IOVECS = 64;
+
+/*
+ * A sendmsg operation submitted to the ring, owns the transmitted data.
+ */
+struct cioloop::cringtx {
+	int								fd;
+	uint32_t						gen;
+	std::vector<cmemory*>			mems;
+	std::vector<struct iovec>		iov;
+	size_t							iov_first;	// first iovec not sent completely
+	size_t							length;
+	struct msghdr					msg;
+
+	cringtx(int fd, uint32_t gen) :
+		fd(fd), gen(gen), iov_first(0), length(0)
+	{ memset(&msg, 0, sizeof(msg)); };
+
+	~cringtx() {
+		for (std::vector<cmemory*>::iterator
+				it = mems.begin(); it != mems.end(); ++it) {
+			delete *it;
+		}
+	};
+
+	void
+	push_back(cmemory* mem) {
+		struct iovec v;
+		v.iov_base = mem->somem();
+		v.iov_len = mem->memlen();
+		mems.push_back(mem);
+		iov.push_back(v);
+		length += v.iov_len;
+	};
+
+	/* advances past num bytes sent, returns true when data remains */
+	bool
+	advance(size_t num) {
+		while ((num > 0) && (iov_first < iov.size())) {
+			if (num < iov[iov_first].iov_len) {
+				iov[iov_first].iov_base = (uint8_t*)iov[iov_first].iov_base + num;
+				iov[iov_first].iov_len -= num;
+				break;
+			}
+			num -= iov[iov_first].iov_len;
+			iov_first++;
+		}
+		while ((iov_first < iov.size()) && (0 == iov[iov_first].iov_len)) {
+			iov_first++;
+		}
+		if (iov_first == iov.size())
+			return false;
+		msg.msg_iov = &iov[iov_first];
+		msg.msg_iovlen = iov.size() - iov_first;
+		return true;
+	};
+};
 
 
 ciosrv::ciosrv(
@@ -36,9 +135,8 @@ ciosrv::~ciosrv()
 			<< ", target tid: " << std::hex << get_thread_id() << std::dec
 			<< ", running tid: " << std::hex << pthread_self() << std::dec
 			<< std::endl;
-	timers.clear();
 	events.clear();
-	rofl::cioloop::get_loop(get_thread_id()).has_no_timer(this);
+	rofl::cioloop::get_loop(get_thread_id()).cancel_all_timers(this);
 	rofl::cioloop::get_loop(get_thread_id()).has_no_event(this);
 	for (std::set<int>::iterator
 			it = rfds.begin(); it != rfds.end(); ++it) {
@@ -48,6 +146,10 @@ ciosrv::~ciosrv()
 			it = wfds.begin(); it != wfds.end(); ++it) {
 		rofl::cioloop::get_loop(get_thread_id()).drop_writefd(this, (*it));
 	}
+	for (std::set<int>::iterator
+			it = ringfds.begin(); it != ringfds.end(); ++it) {
+		rofl::cioloop::get_loop(get_thread_id()).drop_ringfd(this, (*it));
+	}
 	rofl::cioloop::get_loop(get_thread_id()).deregister_ciosrv(this);
 }
 
@@ -66,7 +168,7 @@ ciosrv::__handle_event()
 			return;
 		}
 
-		cevents clone = events; events.clear();
+		cevents clone; events.swap(clone); // events added meanwhile must not get lost
 
 		while (not clone.empty()) {
 			cevent event = clone.get_event();
@@ -92,6 +194,49 @@ ciosrv::__handle_event()
 
 
 
+cioloop::~cioloop()
+{
+	// closing the ring cancels all operations still pending in the kernel
+	if (NULL != ring) {
+		delete ring;
+	}
+	for (std::set<cringtx*>::iterator
+			it = ring_tx_inflight.begin(); it != ring_tx_inflight.end(); ++it) {
+		delete *it;
+	}
+	close(epollfd);
+	for (std::vector<cpollslot*>::iterator
+			it = poll_slots.begin(); it != poll_slots.end(); ++it) {
+		if (NULL == *it)
+			continue;
+		while (not (*it)->txqueue.empty()) {
+			delete (*it)->txqueue.front();
+			(*it)->txqueue.pop_front();
+		}
+		delete *it;
+	}
+}
+
+
+
+void
+cioloop::cancel_all_timers(
+		ciosrv* iosrv)
+{
+	timers.clear(iosrv);
+}
+
+
+
+size_t
+cioloop::num_timers(
+		ciosrv* iosrv) const
+{
+	return timers.size(iosrv);
+}
+
+
+
 /* static */
 void
 cioloop::child_sig_handler (int x) {
@@ -143,19 +288,17 @@ cioloop::run_loop()
 		exit(EXIT_FAILURE);
 	}
 
-	// register pipe read file descriptor
+	// register wakeup file descriptor, identified by a NULL slot
 	{
-		check_poll_set(pipe.pipefd[0]);
-		RwLock lock(poll_rwlock, RwLock::RWLOCK_READ);
-		poll_events[pipe.pipefd[0]].events |= (EPOLLET | EPOLLIN);
-		poll_events[pipe.pipefd[0]].data.fd = pipe.pipefd[0];
-		if ((epoll_ctl(epollfd, EPOLL_CTL_ADD, pipe.pipefd[0],
-				&poll_events[pipe.pipefd[0]])) < 0) {
+		struct epoll_event ev;
+		ev.events = (EPOLLET | EPOLLIN);
+		ev.data.ptr = NULL;
+		if ((epoll_ctl(epollfd, EPOLL_CTL_ADD, wakeup_event.get_fd(), &ev)) < 0) {
 			throw eSysCall("epoll_ctl()");
 		}
 	}
 
-	std::pair<ciosrv*, ctimespec> next_timeout(NULL, ctimespec::now() + ctimespec(3600));
+	ctimespec next_timeout(ctimespec::now() + ctimespec(3600));
 
 	/*
 	 * the infinite loop ...
@@ -170,15 +313,11 @@ cioloop::run_loop()
 		run_on_kernel(next_timeout);
 	}
 
-	// deregister pipe read file descriptor
+	// deregister wakeup file descriptor
 	{
-		RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
-		if (poll_events.find(pipe.pipefd[0]) != poll_events.end()) {
-			if ((epoll_ctl(epollfd, EPOLL_CTL_DEL, pipe.pipefd[0],
-					&poll_events[pipe.pipefd[0]])) < 0) {
-				// do nothing
-			}
-			poll_events.erase(pipe.pipefd[0]);
+		struct epoll_event ev;
+		if ((epoll_ctl(epollfd, EPOLL_CTL_DEL, wakeup_event.get_fd(), &ev)) < 0) {
+			// do nothing
 		}
 	}
 
@@ -190,78 +329,161 @@ cioloop::run_loop()
 
 
 
-void
-cioloop::run_on_timers(
-		std::pair<ciosrv*, ctimespec>& next_timeout)
+cioloop::cpollslot*
+cioloop::get_slot(
+		int fd)
 {
-#ifndef NDEBUG
-	rofl::logging::trace << "[rofl-common][cioloop][run_on_timers] looking for timers,"
-			<< " tid: 0x" << std::hex << tid << std::dec << std::endl;
-#endif
+	if (poll_slots.size() <= (size_t)fd) {
+		poll_slots.resize(fd + 1, NULL);
+	}
+	if (NULL == poll_slots[fd]) {
+		poll_slots[fd] = new cpollslot;
+		poll_slots[fd]->fd = fd;
+		poll_slots[fd]->events = 0;
+		poll_slots[fd]->iosrv = NULL;
+		poll_slots[fd]->ring = false;
+		poll_slots[fd]->gen = 0;
+		poll_slots[fd]->rx_armed = false;
+		poll_slots[fd]->tx_id = 0;
+		poll_slots[fd]->tx_backlog = 0;
+	}
+	return poll_slots[fd];
+}
 
-	do {
 
-		std::list<ciosrv*> clone;
 
-		// make a copy of timers map
-		{
-			flag_new_timer_installed = false;
-			RwLock lock(timers_rwlock, RwLock::RWLOCK_READ);
-			for (std::map<ciosrv*, bool>::iterator
-					it = timers.begin(); it != timers.end(); ++it) {
-				if ((true == it->second) || (it->first->has_next_timer()))
-					clone.push_back(it->first);
+void
+cioloop::poll_set_add(
+		ciosrv* iosrv, int fd, uint32_t events)
+{
+	RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
+
+	cpollslot* slot = get_slot(fd);
+
+	struct epoll_event ev;
+	ev.data.ptr = slot;
+
+	if (0 == slot->events) {
+		ev.events = EPOLLET | events;
+		if (epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+			switch (errno) {
+			case EEXIST:
+			case ENOENT: {
+				// ignore
+			} break;
+			default: {
+				throw eSysCall("epoll_ctl()");
+			}
 			}
 		}
-
-		if (clone.empty()) {
-			next_timeout = std::pair<ciosrv*, ctimespec>(NULL, ctimespec::now() + ctimespec(3600));
-			return;
+		slot->events = ev.events;
+		slot->iosrv = iosrv;
+		poll_num_fds++;
+	} else {
+		ev.events = slot->events | events;
+		if (epoll_ctl(epollfd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+			switch (errno) {
+			case EEXIST:
+			case ENOENT: {
+				// ignore
+			} break;
+			default: {
+				throw eSysCall("epoll_ctl()");
+			}
+			}
 		}
+		slot->events = ev.events;
+	}
+}
 
-#ifndef NDEBUG
-		rofl::logging::trace << "[rofl-common][cioloop][run_on_timers] there are " << clone.size()
-							<< " active timer(s), tid: 0x" << std::hex << tid << std::dec << std::endl;
-#endif
 
-		// iterate over all elements with active timer needs
-		for (std::list<ciosrv*>::iterator
-				it = clone.begin(); it != clone.end(); ++it) {
-			ciosrv* svc = *it;
 
-			if (not has_ciosrv(svc) || not svc->has_next_timer())
-				continue;
+void
+cioloop::poll_set_drop(
+		ciosrv* iosrv, int fd, uint32_t events)
+{
+	RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
 
-			while (svc->has_expired_timer()) {
-				try {
-#ifndef NDEBUG
-					rofl::logging::trace << "[rofl-common][cioloop][run_on_timers] urgent timer found,"
-							<< " tid: 0x" << std::hex << tid << std::dec << std::endl;
-#endif
-					// this may set again FLAG_HAS_TIMER
-					svc->__handle_timeout();
-				} catch (RoflException& e) {/* do nothing */};
+	if ((poll_slots.size() <= (size_t)fd) || (NULL == poll_slots[fd]) || (0 == poll_slots[fd]->events)) {
+		return;
+	}
+	cpollslot* slot = poll_slots[fd];
+
+	struct epoll_event ev;
+	ev.events = slot->events & ~events;
+	ev.data.ptr = slot;
+
+	if ((uint32_t)EPOLLET == ev.events) {
+		if (epoll_ctl(epollfd, EPOLL_CTL_DEL, fd, &ev) < 0) {
+			switch (errno) {
+			case EEXIST:
+			case ENOENT: {
+				// ignore
+			} break;
+			default: {
+				throw eSysCall("epoll_ctl()");
 			}
-
-			// no more urgent timers, extract next potential timeout for select/poll/...
-			if ((svc->has_next_timer()) &&
-					(svc->get_next_timer().get_timespec() < next_timeout.second)) {
-				next_timeout = std::pair<ciosrv*, ctimespec>( svc, svc->get_next_timer().get_timespec() );
-#ifndef NDEBUG
-				rofl::logging::trace << "[rofl-common][cioloop][run_on_timers] normal timer found, "
-						<< "tid: 0x" << std::hex << tid << std::dec << ", timeout: "
-						<< (svc->get_next_timer().get_timespec() - ctimespec::now()).str() << std::endl;
-#endif
 			}
 		}
+		slot->events = 0;
+		if (not slot->ring)
+			slot->iosrv = NULL;
+		poll_num_fds--;
+	} else {
+		if (epoll_ctl(epollfd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+			switch (errno) {
+			case EEXIST:
+			case ENOENT: {
+				// ignore
+			} break;
+			default: {
+				throw eSysCall("epoll_ctl()");
+			}
+			}
+		}
+		slot->events = ev.events;
+	}
+}
+
+
+
+void
+cioloop::run_on_timers(
+		ctimespec& next_timeout)
+{
+	ROFL_TRACE << "[rofl-common][cioloop][run_on_timers] looking for timers,"
+			<< " tid: 0x" << std::hex << tid << std::dec << std::endl;
+
+	do {
+		flag_new_timer_installed = false;
+
+		// move all timers due until now to the wheel's list of expired timers
+		timers.advance(ctimespec::now());
+
+		ctimer timer;
+		while (timers.get_expired_timer(timer)) {
+			ciosrv* svc = static_cast<ciosrv*>(timer.get_timer_env());
+
+			if ((NULL == svc) || not has_ciosrv(svc))
+				continue;
+
+			ROFL_TRACE << "[rofl-common][cioloop][run_on_timers] urgent timer found,"
+					<< " tid: 0x" << std::hex << tid << std::dec << std::endl;
+			try {
+				// this may install new timers
+				svc->__handle_timeout(timer);
+			} catch (RoflException& e) {/* do nothing */};
+		}
 	} while (flag_new_timer_installed);
 
-#ifndef NDEBUG
-	rofl::logging::trace << "[rofl-common][cioloop][run_on_timers] done with urgent timers,"
-			<< " next timeout: " << (next_timeout.second - ctimespec::now()).str()
+	if (not timers.get_next_timeout(next_timeout)) {
+		next_timeout = ctimespec::now() + ctimespec(3600);
+	}
+
+	ROFL_TRACE << "[rofl-common][cioloop][run_on_timers] done with urgent timers,"
+			<< " next timeout: " << (next_timeout - ctimespec::now()).str()
 			<< " tid: 0x" << std::hex << tid << std::dec
 			<< std::endl;
-#endif
 }
 
 
@@ -305,22 +527,33 @@ cioloop::run_on_events()
 
 
 void
-cioloop::run_on_kernel(std::pair<ciosrv*, ctimespec>& next_timeout)
+cioloop::run_on_kernel(ctimespec& next_timeout)
 {
 	int rc = 0;
 
 	if (not flag_keep_on_running)
 		return;
 
+	// the ring is created by add_ringfd() on any thread, read it under poll_rwlock
+	bool use_ring = false;
+	{
+		RwLock lock(poll_rwlock, RwLock::RWLOCK_READ);
+		use_ring = (NULL != ring);
+	}
+	if (use_ring) {
+		run_on_ring(next_timeout);
+		return;
+	}
+
 	rofl::indent::null();
 
 	struct timespec ts;
 	ctimespec now(ctimespec::now());
-	if ( next_timeout.second < now ) {
+	if ( next_timeout < now ) {
 		ts.tv_nsec = 0;
 		ts.tv_sec = 0;
 	} else {
-		ts = (next_timeout.second - now).get_timespec();
+		ts = (next_timeout - now).get_timespec();
 	}
 
 #ifndef NDEBUG
@@ -329,11 +562,17 @@ cioloop::run_on_kernel(std::pair<ciosrv*, ctimespec>& next_timeout)
 			<< " tid: 0x" << std::hex << tid << std::dec << std::endl << *this;
 #endif
 
+	// room for all registered descriptors plus the wakeup event, grows only
+	size_t num_fds = poll_num_fds + 1;
+	if (poll_buffer.size() < num_fds) {
+		poll_buffer.resize(num_fds);
+	}
+
 	// blocking
 	flag_wait_on_kernel = true;
-	std::vector<struct epoll_event> events(poll_events.size());
-	int timeout = ts.tv_sec * 1000 + (ts.tv_nsec / 1e6);
-	rc = epoll_pwait(epollfd, &events[0], events.size(), timeout, &sigmask);
+	// round up, waking up before the next timer's tick results in a busy loop
+	int timeout = ts.tv_sec * 1000 + ((ts.tv_nsec + 999999) / 1000000);
+	rc = epoll_pwait(epollfd, &poll_buffer[0], poll_buffer.size(), timeout, &sigmask);
 	flag_wait_on_kernel = false;
 
 #ifndef NDEBUG
@@ -353,83 +592,450 @@ cioloop::run_on_kernel(std::pair<ciosrv*, ctimespec>& next_timeout)
 
 	} else if ((0 == rc)/* || (EINTR == errno)*/) {
 
-		if ((NULL != next_timeout.first) && has_ciosrv(next_timeout.first)) {
-#ifndef NDEBUG
-			rofl::logging::trace << "[rofl-common][cioloop][run] timeout event: "
-					<< next_timeout.first << std::endl;
-#endif
-			next_timeout.first->__handle_timeout();
-		}
-
-		next_timeout = std::pair<ciosrv*, ctimespec>(NULL, ctimespec::now() + ctimespec(3600));
+		// timeout: expired timers are handled in run_on_timers()
+		next_timeout = ctimespec::now() + ctimespec(3600);
 
 	} else { // rc > 0
-		try {
-			ciosrv* iosrv = NULL;
-
-			for (int i = 0; i < rc; i++) {
-				{
-					RwLock lock(poll_rwlock, RwLock::RWLOCK_READ);
+		poll_dispatch(rc);
+	}
+}
 
-					if (poll_iosrvs.find(events[i].data.fd) == poll_iosrvs.end()) {
 
-						// pipe
-						if ((events[i].events & EPOLLIN) && (events[i].data.fd == pipe.pipefd[0])) {
-#ifndef NDEBUG
-							rofl::logging::trace << "[rofl-common][cioloop][run] wakeup signal received via pipe"
-									<< " tid: 0x" << std::hex << tid << std::dec << std::endl;
-#endif
-							flag_waking_up = false;
-							pipe.recvmsg();
-						}
 
-						continue;
-					}
+void
+cioloop::poll_dispatch(
+		int num_events)
+{
+	try {
+		for (int i = 0; i < num_events; i++) {
+			struct epoll_event& ev = poll_buffer[i];
+			cpollslot* slot = (cpollslot*)ev.data.ptr;
+
+			// wakeup from other thread
+			if (NULL == slot) {
+				ROFL_TRACE << "[rofl-common][cioloop][run] wakeup signal received"
+						<< " tid: 0x" << std::hex << tid << std::dec << std::endl;
+				wakeup_event.drain();
+				continue;
+			}
 
-					iosrv = poll_iosrvs[events[i].data.fd];
-				}
+			// slots are never freed while the loop exists, iosrv is NULL after deregistration
+			int fd = slot->fd;
+			ciosrv* iosrv = slot->iosrv;
+			if (NULL == iosrv) {
+				continue;
+			}
 
-				if ((events[i].events & EPOLLERR) && has_ciosrv(iosrv)) {
+			if ((ev.events & EPOLLERR) && has_ciosrv(iosrv)) {
 #ifndef NDEBUG
-					rofl::logging::trace << "[rofl-common][cioloop][run]"
-							<< " error event: " << events[i].data.fd << " on " << std::hex << iosrv << std::dec
-							<< " tid: 0x" << std::hex << tid << std::dec << std::endl;
+				rofl::logging::trace << "[rofl-common][cioloop][run]"
+						<< " error event: " << fd << " on " << std::hex << iosrv << std::dec
+						<< " tid: 0x" << std::hex << tid << std::dec << std::endl;
 #endif
-					iosrv->handle_xevent(events[i].data.fd);
-				}
-				if ((events[i].events & EPOLLOUT) && has_ciosrv(iosrv)) {
+				iosrv->handle_xevent(fd);
+			}
+			if ((ev.events & EPOLLOUT) && has_ciosrv(iosrv)) {
 #ifndef NDEBUG
-					rofl::logging::trace << "[rofl-common][cioloop][run]"
-							<< " write event: " << events[i].data.fd << " on " << std::hex << iosrv << std::dec
-							<< " tid: 0x" << std::hex << tid << std::dec << std::endl;
+				rofl::logging::trace << "[rofl-common][cioloop][run]"
+						<< " write event: " << fd << " on " << std::hex << iosrv << std::dec
+						<< " tid: 0x" << std::hex << tid << std::dec << std::endl;
 #endif
-					iosrv->handle_wevent(events[i].data.fd);
-				}
-				if ((events[i].events & EPOLLIN ) && has_ciosrv(iosrv)) {
+				iosrv->handle_wevent(fd);
+			}
+			if ((ev.events & EPOLLIN ) && has_ciosrv(iosrv)) {
 #ifndef NDEBUG
-					rofl::logging::trace << "[rofl-common][cioloop][run]"
-							<< " read event: " << events[i].data.fd << " on " << std::hex << iosrv << std::dec
-							<< " tid: 0x" << std::hex << tid << std::dec << std::endl;;
+				rofl::logging::trace << "[rofl-common][cioloop][run]"
+						<< " read event: " << fd << " on " << std::hex << iosrv << std::dec
+						<< " tid: 0x" << std::hex << tid << std::dec << std::endl;;
 #endif
-					iosrv->handle_revent(events[i].data.fd);
-				}
+				iosrv->handle_revent(fd);
+			}
+
+		}
+
+	} catch (rofl::RoflException& e) {
+		rofl::logging::error << "[rofl-common][cioloop][run] caught "
+				<< "RoflException in main loop: " << e.what() << std::endl;
+		rofl::indent::null();
+
+	} catch (std::exception& e) {
+		rofl::logging::error << "[rofl-common][cioloop][run] caught "
+				<< "std::exception in main loop: " << e.what() << std::endl;
+		rofl::indent::null();
+		flag_keep_on_running = false;
+		throw;
+	}
+}
 
+
+
+void
+cioloop::run_on_ring(ctimespec& next_timeout)
+{
+	rofl::indent::null();
+
+	struct timespec ts;
+	ctimespec now(ctimespec::now());
+	if ( next_timeout < now ) {
+		ts.tv_nsec = 0;
+		ts.tv_sec = 0;
+	} else {
+		ts = (next_timeout - now).get_timespec();
+	}
+
+	ring_prepare();
+
+	// blocking, submits all operations prepared during this iteration
+	flag_wait_on_kernel = true;
+	int rc = ring->enter(true, &ts, &sigmask);
+	flag_wait_on_kernel = false;
+
+	switch (rc) {
+	case 0:
+	case -EINTR:
+	case -EBUSY:
+	case -EAGAIN: {
+		// completions are reaped below
+	} break;
+	case -ETIME: {
+		// timeout: expired timers are handled in run_on_timers()
+		next_timeout = ctimespec::now() + ctimespec(3600);
+	} break;
+	default: {
+		errno = -rc;
+		rofl::logging::error << "[rofl-common][cioloop][run] " << eSysCall("io_uring_enter()") << std::endl;
+	};
+	}
+
+	bool poll_ready = false;
+	cioring::ccompletion cqe;
+
+	try {
+		while (ring->next_completion(cqe)) {
+			switch (cqe.user_data & RING_OP_MASK) {
+			case RING_OP_POLL: {
+				poll_ready = true;
+				if (not (cqe.flags & cioring::COMPLETION_F_MORE))
+					ring_poll_armed = false;
+			} break;
+			case RING_OP_RECV: {
+				ring_complete_recv(cqe.user_data, cqe.res, cqe.flags);
+			} break;
+			case RING_OP_SEND: {
+				ring_complete_send(cqe.user_data, cqe.res, cqe.flags);
+			} break;
+			default: {
+				// cancellations
+			};
 			}
+		}
+
+	} catch (rofl::RoflException& e) {
+		rofl::logging::error << "[rofl-common][cioloop][run] caught "
+				<< "RoflException in main loop: " << e.what() << std::endl;
+		rofl::indent::null();
+
+	} catch (std::exception& e) {
+		rofl::logging::error << "[rofl-common][cioloop][run] caught "
+				<< "std::exception in main loop: " << e.what() << std::endl;
+		rofl::indent::null();
+		flag_keep_on_running = false;
+		throw;
+	}
+
+	// descriptors served by epoll are ready
+	if (poll_ready) {
+		size_t num_fds = poll_num_fds + 1;
+		if (poll_buffer.size() < num_fds) {
+			poll_buffer.resize(num_fds);
+		}
+		if ((rc = epoll_wait(epollfd, &poll_buffer[0], poll_buffer.size(), 0)) > 0) {
+			poll_dispatch(rc);
+		}
+	}
+}
+
+
+
+void
+cioloop::ring_prepare()
+{
+	if (not ring_poll_armed) {
+		ring->prep_poll(epollfd, RING_OP_POLL);
+		ring_poll_armed = true;
+	}
+
+	RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
+
+	for (std::vector<int>::iterator
+			it = ring_arm.begin(); it != ring_arm.end(); ++it) {
+		cpollslot* slot = poll_slots[*it];
+		if ((not slot->ring) || slot->rx_armed)
+			continue;
+		ring->prep_recv(*it, ring_recv_multishot, ring_recv_id(*it, slot->gen));
+		slot->rx_armed = true;
+	}
+	ring_arm.clear();
+
+	for (std::vector<uint64_t>::iterator
+			it = ring_cancel.begin(); it != ring_cancel.end(); ++it) {
+		ring->prep_cancel(*it, RING_OP_CANCEL);
+	}
+	ring_cancel.clear();
+
+	// gather queued data per descriptor, a single sendmsg in flight keeps the byte order
+	for (std::vector<int>::iterator
+			it = ring_tx.begin(); it != ring_tx.end(); ++it) {
+		cpollslot* slot = poll_slots[*it];
+		if ((not slot->ring) || (0 != slot->tx_id) || slot->txqueue.empty())
+			continue;
+		cringtx* tx = new cringtx(*it, slot->gen);
+		while ((not slot->txqueue.empty()) && (tx->mems.size() < RING_MAX_TX_IOVECS)) {
+			tx->push_back(slot->txqueue.front());
+			slot->txqueue.pop_front();
+		}
+		tx->advance(0);
+		ring_tx_inflight.insert(tx);
+		slot->tx_id = (uint64_t)(uintptr_t)tx | RING_OP_SEND;
+		ring->prep_sendmsg(*it, &tx->msg, MSG_NOSIGNAL | MSG_WAITALL, slot->tx_id);
+	}
+	ring_tx.clear();
+}
+
+
+
+void
+cioloop::ring_complete_recv(
+		uint64_t user_data, int32_t res, uint32_t flags)
+{
+	int fd = (int)((user_data >> 2) & 0x3fffffff);
+	uint32_t gen = (uint32_t)(user_data >> 32);
+	bool has_buffer = (flags & cioring::COMPLETION_F_BUFFER);
+	uint16_t bid = (uint16_t)(flags >> 16);
+
+	ciosrv* iosrv = NULL;
+	{
+		RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
+		cpollslot* slot = ((size_t)fd < poll_slots.size()) ? poll_slots[fd] : NULL;
+		if ((NULL != slot) && slot->ring && (slot->gen == gen)) {
+			iosrv = slot->iosrv;
+			if (not (flags & cioring::COMPLETION_F_MORE))
+				slot->rx_armed = false;
+		}
+	}
+
+	// descriptor deregistered meanwhile
+	if ((NULL == iosrv) || not has_ciosrv(iosrv)) {
+		if (has_buffer)
+			ring->recycle_buffer(bid);
+		return;
+	}
 
-		} catch (rofl::RoflException& e) {
-			rofl::logging::error << "[rofl-common][cioloop][run] caught "
-					<< "RoflException in main loop: " << e.what() << std::endl;
-			rofl::indent::null();
+	bool rearm = false;
 
-		} catch (std::exception& e) {
-			rofl::logging::error << "[rofl-common][cioloop][run] caught "
-					<< "std::exception in main loop: " << e.what() << std::endl;
-			rofl::indent::null();
-			flag_keep_on_running = false;
+	if (res > 0) {
+		try {
+			iosrv->handle_recv(fd, has_buffer ? ring->get_buffer(bid) : NULL, res);
+		} catch (...) {
+			if (has_buffer)
+				ring->recycle_buffer(bid);
 			throw;
 		}
+		rearm = true;
+	} else {
+		switch (res) {
+		case -ENOBUFS:
+		case -EAGAIN: {
+			// all provided buffers in use, recycled meanwhile
+			rearm = true;
+		} break;
+		case -EINVAL: {
+			if (ring_recv_multishot) {
+				rofl::logging::info << "[rofl-common][cioloop][ring] "
+						<< "multishot receive not supported by kernel, using single receives" << std::endl;
+				ring_recv_multishot = false;
+				rearm = true;
+			} else {
+				iosrv->handle_recv(fd, NULL, res);
+			}
+		} break;
+		case -ECANCELED: {
+			// do nothing
+		} break;
+		default: {
+			// 0: peer closed connection
+			iosrv->handle_recv(fd, NULL, res);
+		};
+		}
+	}
+
+	if (has_buffer)
+		ring->recycle_buffer(bid);
+
+	if (not rearm)
+		return;
+
+	// submit another receive, unless multishot is still armed or fd has been deregistered
+	RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
+	cpollslot* slot = poll_slots[fd];
+	if (slot->ring && (slot->gen == gen) && not slot->rx_armed) {
+		ring_arm.push_back(fd);
+	}
+}
+
+
+
+void
+cioloop::ring_complete_send(
+		uint64_t user_data, int32_t res, uint32_t flags)
+{
+	cringtx* tx = (cringtx*)(uintptr_t)(user_data & ~RING_OP_MASK);
+	int fd = tx->fd;
+	ciosrv* iosrv = NULL;
+	ssize_t result = res;
+	{
+		RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
+		cpollslot* slot = ((size_t)fd < poll_slots.size()) ? poll_slots[fd] : NULL;
+
+		if ((NULL != slot) && slot->ring && (slot->gen == tx->gen)) {
+			if ((-EAGAIN == res) || (-EINTR == res)) {
+				ring->prep_sendmsg(fd, &tx->msg, MSG_NOSIGNAL | MSG_WAITALL, user_data);
+				return;
+			}
+			if (res < 0) {
+				// connection is broken, drop all data queued on fd
+				while (not slot->txqueue.empty()) {
+					delete slot->txqueue.front();
+					slot->txqueue.pop_front();
+				}
+				slot->tx_backlog = 0;
+			} else {
+				slot->tx_backlog -= res;
+				if (tx->advance(res)) {
+					ring->prep_sendmsg(fd, &tx->msg, MSG_NOSIGNAL | MSG_WAITALL, user_data);
+					return;
+				}
+				result = tx->length;
+				if (not slot->txqueue.empty())
+					ring_tx.push_back(fd);
+			}
+			slot->tx_id = 0;
+			iosrv = slot->iosrv;
+		}
+	}
+
+	ring_tx_inflight.erase(tx);
+	delete tx;
+
+	if ((NULL != iosrv) && has_ciosrv(iosrv)) {
+		iosrv->handle_sent(fd, result);
+	}
+}
+
+
+
+bool
+cioloop::add_ringfd(
+		ciosrv* iosrv, int fd)
+{
+	{
+		RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
+		if (BACKEND_IO_URING != backend) {
+			return false;
+		}
+		if (NULL == ring) {
+			try {
+				ring = new cioring(RING_ENTRIES, RING_NUM_BUFFERS, RING_BUFFER_SIZE);
+			} catch (RoflException& e) {
+				rofl::logging::warn << "[rofl-common][cioloop][add_ringfd] io_uring not available, "
+						<< "falling back to epoll: " << e.what()
+						<< ", tid: 0x" << std::hex << tid << std::dec << std::endl;
+				backend = BACKEND_EPOLL;
+				return false;
+			}
+		}
+		cpollslot* slot = get_slot(fd);
+		slot->ring = true;
+		slot->gen++;
+		slot->iosrv = iosrv;
+		slot->rx_armed = false;
+		slot->tx_id = 0;
+		slot->tx_backlog = 0;
+		ring_arm.push_back(fd);
 	}
+	rofl::logging::debug << "[rofl-common][cioloop][add_ringfd] fd:" << fd
+			<< ", tid: 0x" << std::hex << tid << std::dec << std::endl;
+	wakeup(); // wakeup main loop for submitting a receive
+	return true;
 }
 
 
 
+void
+cioloop::drop_ringfd(
+		ciosrv* iosrv, int fd)
+{
+	std::deque<cmemory*> dropped;
+	{
+		RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
+		if ((poll_slots.size() <= (size_t)fd) || (NULL == poll_slots[fd]) || (not poll_slots[fd]->ring)) {
+			return;
+		}
+		cpollslot* slot = poll_slots[fd];
+		// pending operations hold a reference on the socket, cancel them
+		if (slot->rx_armed)
+			ring_cancel.push_back(ring_recv_id(fd, slot->gen));
+		if (0 != slot->tx_id)
+			ring_cancel.push_back(slot->tx_id);
+		slot->ring = false;
+		slot->gen++;
+		slot->rx_armed = false;
+		slot->tx_id = 0;
+		slot->tx_backlog = 0;
+		dropped.swap(slot->txqueue);
+		if (0 == slot->events)
+			slot->iosrv = NULL;
+	}
+	while (not dropped.empty()) {
+		delete dropped.front();
+		dropped.pop_front();
+	}
+	rofl::logging::debug << "[rofl-common][cioloop][drop_ringfd] fd:" << fd
+			<< ", tid: 0x" << std::hex << tid << std::dec << std::endl;
+	wakeup(); // wakeup main loop for submitting cancellations
+}
+
+
+
+void
+cioloop::send_ringfd(
+		ciosrv* iosrv, int fd, cmemory* mem)
+{
+	{
+		RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
+		if ((poll_slots.size() <= (size_t)fd) || (NULL == poll_slots[fd]) ||
+				(not poll_slots[fd]->ring) || (poll_slots[fd]->iosrv != iosrv)) {
+			delete mem;
+			return;
+		}
+		cpollslot* slot = poll_slots[fd];
+		if (slot->txqueue.empty() && (0 == slot->tx_id))
+			ring_tx.push_back(fd);
+		slot->txqueue.push_back(mem);
+		slot->tx_backlog += mem->memlen();
+	}
+	wakeup(); // wakeup main loop for submitting data
+}
+
+
+
+size_t
+cioloop::get_ringfd_backlog(
+		int fd) const
+{
+	RwLock lock(poll_rwlock, RwLock::RWLOCK_READ);
+	if ((poll_slots.size() <= (size_t)fd) || (NULL == poll_slots[fd]) || (not poll_slots[fd]->ring)) {
+		return 0;
+	}
+	return poll_slots[fd]->tx_backlog;
+}
@@ -7,6 +7,7 @@
 
 #include <set>
 #include <list>
+#include <deque>
 #include <bitset>
 #include <utility>
 #include <map>
@@ -32,10 +33,11 @@
 #include "rofl/common/logging.h"
 #include "rofl/common/croflexception.h"
 #include "rofl/common/thread_helper.h"
-#include "rofl/common/cpipe.h"
+#include "rofl/common/cwakeup.h"
 #include "rofl/common/cevents.h"
 #include "rofl/common/ctimers.h"
 #include "rofl/common/ctimer.h"
+#include "rofl/common/ctimerwheel.h"
 
 namespace rofl {
 
@@ -49,12 +51,20 @@ public:
 };
 
 class ciosrv;
+class cioring;
 
 /**
  * @brief	Defines an IO service loop for a single thread.
  * @ingroup common_devel_ioservice
  *
- *
+ * A loop waits for kernel events either via epoll (default) or via
+ * io_uring, see set_default_backend(). With io_uring, descriptors
+ * registered via ciosrv::register_filedesc_ring() receive data by
+ * multishot receive operations into provided buffers and transmit
+ * queued data by sendmsg operations, all submitted together with a
+ * single system call per loop iteration. Descriptors registered for
+ * read or write events are still served by epoll, whose descriptor
+ * is polled via the ring.
  */
 class cioloop {
 private:
@@ -72,10 +82,7 @@ private:
 
 		logging::debug << "[rofl-common][thread] stopping, tid: 0x" << std::hex << tid << std::dec << std::endl;
 
-		// set result code, usually just 0
-		rofl::cioloop::threads[tid] = 0;
-
-		return &(rofl::cioloop::threads[tid]);
+		return NULL;
 	};
 
 	static PthreadRwLock 			threads_lock;
@@ -99,7 +106,7 @@ public:
 		}
 		logging::debug << "[rofl-common][cioloop][thread] starting, tid: 0x"
 				<< std::hex << tid << std::dec << std::endl;
-		RwLock(cioloop::threads_lock, RwLock::RWLOCK_WRITE);
+		RwLock lock(cioloop::threads_lock, RwLock::RWLOCK_WRITE);
 		cioloop::threads[tid] = 0;
 		return tid;
 	};
@@ -116,27 +123,61 @@ public:
 		logging::debug << "[rofl-common][cioloop][thread] done, tid: 0x"
 				<< std::hex << tid << std::dec << std::endl;
 		int rc = 0;
-		RwLock(cioloop::threads_lock, RwLock::RWLOCK_WRITE);
-		if (cioloop::threads.find(tid) == cioloop::threads.end()) {
-			return;
-		}
-		if (cioloop::get_loop(tid).has_active_elements()) {
-			throw eRofIoLoopBusy("loop has still active elements");
+		{
+			RwLock lock(cioloop::threads_lock, RwLock::RWLOCK_WRITE);
+			if (cioloop::threads.find(tid) == cioloop::threads.end()) {
+				return;
+			}
+			if (cioloop::get_loop(tid).has_active_elements()) {
+				throw eRofIoLoopBusy("loop has still active elements");
+			}
+			cioloop::threads.erase(tid);
 		}
 		cioloop::get_loop(tid).stop();
 		if ((rc = pthread_join(tid, NULL)) < 0) {
 			pthread_cancel(tid);
 		}
-		cioloop::threads.erase(tid);
 		cioloop::drop_loop(tid);
 	};
 
+	/**
+	 * @brief	Stops a running rofl::cioloop instance and waits for termination of its POSIX thread.
+	 *
+	 * Unlike drop_thread(), the loop instance is kept, so elements still
+	 * assigned to it can be destroyed afterwards without racing against
+	 * the loop. Call drop_loop() for finally removing the loop instance.
+	 *
+	 * @param tid identifier of thread to be joined
+	 */
+	static void
+	join_thread(pthread_t tid) {
+		{
+			RwLock lock(cioloop::threads_lock, RwLock::RWLOCK_WRITE);
+			if (cioloop::threads.find(tid) == cioloop::threads.end()) {
+				return;
+			}
+			cioloop::threads.erase(tid);
+		}
+		// a stop request is lost, when the thread has not yet entered its loop: repeat it
+		int rc = 0;
+		do {
+			cioloop::get_loop(tid).stop();
+			struct timespec ts;
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_nsec += 10000000;
+			if (ts.tv_nsec >= 1000000000) {
+				ts.tv_sec += 1; ts.tv_nsec -= 1000000000;
+			}
+			rc = pthread_timedjoin_np(tid, NULL, &ts);
+		} while (ETIMEDOUT == rc);
+	};
+
 	/**
 	 * @brief	Checks for existence of a certain pthread_t thread identifier.
 	 */
 	static bool
 	has_thread(pthread_t tid) {
-		RwLock(cioloop::threads_lock, RwLock::RWLOCK_READ);
+		RwLock lock(cioloop::threads_lock, RwLock::RWLOCK_READ);
 		return (not (cioloop::threads.find(tid) == cioloop::threads.end()));
 	};
 
@@ -200,7 +241,7 @@ public:
 		for (std::map<pthread_t, cioloop*>::iterator
 				it = cioloop::loops.begin(); it != cioloop::loops.end(); ++it) {
 			it->second->flag_keep_on_running = false;
-			it->second->pipe.writemsg('1');
+			it->second->wakeup_event.notify();
 		}
 	};
 
@@ -214,7 +255,7 @@ public:
 			for (std::map<pthread_t, cioloop*>::iterator
 					it = cioloop::loops.begin(); it != cioloop::loops.end(); ++it) {
 				it->second->flag_keep_on_running = false;
-				it->second->pipe.writemsg('1');
+				it->second->wakeup_event.notify();
 				if (it->first != pthread_self()) {
 					pthread_join(it->first, NULL);
 					delete it->second;
@@ -227,6 +268,41 @@ public:
 
 public:
 
+	/**
+	 * @brief	Kernel interfaces used by a loop for waiting on I/O
+	 */
+	enum cioloop_backend_t {
+		BACKEND_EPOLL		= 0,	/**< readiness notification via epoll */
+		BACKEND_IO_URING	= 1,	/**< completion based I/O via io_uring */
+	};
+
+	/**
+	 * @brief	Selects the backend for loops created afterwards.
+	 *
+	 * Default is BACKEND_EPOLL, unless environment variable
+	 * ROFL_IOLOOP_BACKEND is set to "io_uring". A loop configured for
+	 * BACKEND_IO_URING falls back to epoll when rofl-common has been
+	 * compiled without io_uring support or the kernel lacks it.
+	 */
+	static void
+	set_default_backend(
+			enum cioloop_backend_t backend)
+	{ cioloop::default_backend = backend; };
+
+	/**
+	 *
+	 */
+	static enum cioloop_backend_t
+	get_default_backend()
+	{ return cioloop::default_backend; };
+
+	/**
+	 * @brief	Returns backend of this loop, BACKEND_EPOLL after a fallback.
+	 */
+	enum cioloop_backend_t
+	get_backend() const
+	{ RwLock lock(poll_rwlock, RwLock::RWLOCK_READ); return backend; };
+
 	/**
 	 *
 	 */
@@ -262,6 +338,21 @@ public:
 	get_tid() const
 	{ return tid; };
 
+	/**
+	 * @brief	Returns number of wakeups requested by other threads.
+	 */
+	uint64_t
+	get_wakeups_requested() const
+	{ return wakeup_event.get_requested(); };
+
+	/**
+	 * @brief	Returns number of wakeups delivered to this loop, i.e.,
+	 * requests not coalesced with a pending wakeup.
+	 */
+	uint64_t
+	get_wakeups_delivered() const
+	{ return wakeup_event.get_delivered(); };
+
 protected:
 
 	friend class ciosrv;
@@ -279,11 +370,6 @@ protected:
 			ciolist.insert(elem);
 			wakeup();
 		}
-		{
-			RwLock lock(timers_rwlock, RwLock::RWLOCK_WRITE);
-			if (timers.find(elem) == timers.end())
-				timers[elem] = false;
-		}
 		{
 			RwLock lock(events_rwlock, RwLock::RWLOCK_WRITE);
 			if (events.find(elem) == events.end())
@@ -305,15 +391,7 @@ protected:
 			wakeup();
 		}
 
-		{
-			RwLock lock(timers_rwlock, RwLock::RWLOCK_WRITE);
-			for (std::map<ciosrv*, bool>::iterator
-					it = timers.begin(); it != timers.end(); ++it) {
-				if (elem == it->first) {
-					timers.erase(it); break;
-				}
-			}
-		}
+		cancel_all_timers(elem);
 
 		{
 			RwLock lock(events_rwlock, RwLock::RWLOCK_WRITE);
@@ -340,37 +418,7 @@ protected:
 	 */
 	void
 	add_readfd(ciosrv* iosrv, int fd) {
-		check_poll_set(fd);
-
-		RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
-		poll_events[fd].events |= EPOLLIN;
-
-		if (poll_iosrvs.find(fd) == poll_iosrvs.end()) {
-			poll_iosrvs[fd] = iosrv;
-			if (epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &poll_events[fd]) < 0) {
-				switch (errno) {
-				case EEXIST:
-				case ENOENT: {
-					// ignore
-				} break;
-				default: {
-					throw eSysCall("epoll_ctl()");
-				}
-				}
-			}
-		} else {
-			if (epoll_ctl(epollfd, EPOLL_CTL_MOD, fd, &poll_events[fd]) < 0) {
-				switch (errno) {
-				case EEXIST:
-				case ENOENT: {
-					// ignore
-				} break;
-				default: {
-					throw eSysCall("epoll_ctl()");
-				}
-				}
-			}
-		}
+		poll_set_add(iosrv, fd, EPOLLIN);
 		rofl::logging::debug << "[rofl-common][cioloop][add_readfd] fd:" << fd
 				<< ", tid: 0x" << std::hex << tid << std::dec << std::endl;
 		wakeup(); // wakeup main loop, just in case
@@ -381,39 +429,7 @@ protected:
 	 */
 	void
 	drop_readfd(ciosrv* iosrv, int fd) {
-		check_poll_set(fd);
-
-		RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
-		poll_events[fd].events &= ~EPOLLIN;
-
-		if ((unsigned int)EPOLLET == poll_events[fd].events) {
-			poll_iosrvs[fd] = NULL;
-			if (epoll_ctl(epollfd, EPOLL_CTL_DEL, fd, &poll_events[fd]) < 0) {
-				switch (errno) {
-				case EEXIST:
-				case ENOENT: {
-					// ignore
-				} break;
-				default: {
-					throw eSysCall("epoll_ctl()");
-				}
-				}
-			}
-			poll_events.erase(fd);
-			poll_iosrvs.erase(fd);
-		} else {
-			if (epoll_ctl(epollfd, EPOLL_CTL_MOD, fd, &poll_events[fd]) < 0) {
-				switch (errno) {
-				case EEXIST:
-				case ENOENT: {
-					// ignore
-				} break;
-				default: {
-					throw eSysCall("epoll_ctl()");
-				}
-				}
-			}
-			}
+		poll_set_drop(iosrv, fd, EPOLLIN);
 		rofl::logging::debug << "[rofl-common][cioloop][drop_readfd] fd:" << fd
 				<< ", tid: 0x" << std::hex << tid << std::dec << std::endl;
 		wakeup(); // wakeup main loop, just in case
@@ -424,37 +440,7 @@ protected:
 	 */
 	void
 	add_writefd(ciosrv* iosrv, int fd) {
-		check_poll_set(fd);
-
-		RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
-		poll_events[fd].events |= EPOLLOUT;
-
-		if (poll_iosrvs.find(fd) == poll_iosrvs.end()) {
-			poll_iosrvs[fd] = iosrv;
-			if (epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &poll_events[fd]) < 0) {
-				switch (errno) {
-				case EEXIST:
-				case ENOENT: {
-					// ignore
-				} break;
-				default: {
-					throw eSysCall("epoll_ctl()");
-				}
-				}
-			}
-		} else {
-			if (epoll_ctl(epollfd, EPOLL_CTL_MOD, fd, &poll_events[fd]) < 0) {
-				switch (errno) {
-				case EEXIST:
-				case ENOENT: {
-					// ignore
-				} break;
-				default: {
-					throw eSysCall("epoll_ctl()");
-				}
-				}
-			}
-		}
+		poll_set_add(iosrv, fd, EPOLLOUT);
 		rofl::logging::debug << "[rofl-common][cioloop][add_writefd] fd:" << fd
 				<< ", tid: 0x" << std::hex << tid << std::dec << std::endl;
 		wakeup(); // wakeup main loop, just in case
@@ -465,62 +451,89 @@ protected:
 	 */
 	void
 	drop_writefd(ciosrv* iosrv, int fd) {
-		check_poll_set(fd);
-
-		RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
-		poll_events[fd].events &= ~EPOLLOUT;
-
-		if ((unsigned int)EPOLLET == poll_events[fd].events) {
-			poll_iosrvs[fd] = NULL;
-			if (epoll_ctl(epollfd, EPOLL_CTL_DEL, fd, &poll_events[fd]) < 0) {
-				switch (errno) {
-				case EEXIST:
-				case ENOENT: {
-					// ignore
-				} break;
-				default: {
-					throw eSysCall("epoll_ctl()");
-				}
-				}
-			}
-			poll_events.erase(fd);
-			poll_iosrvs.erase(fd);
-		} else {
-			if (epoll_ctl(epollfd, EPOLL_CTL_MOD, fd, &poll_events[fd]) < 0) {
-				switch (errno) {
-				case EEXIST:
-				case ENOENT: {
-					// ignore
-				} break;
-				default: {
-					throw eSysCall("epoll_ctl()");
-				}
-				}
-			}
-		}
+		poll_set_drop(iosrv, fd, EPOLLOUT);
 		rofl::logging::debug << "[rofl-common][cioloop][drop_writefd] fd:" << fd
 				<< ", tid: 0x" << std::hex << tid << std::dec << std::endl;
 		wakeup(); // wakeup main loop, just in case
 	};
 
 	/**
-	 *
+	 * @brief	Serves fd by the io_uring backend, returns false when running on epoll.
+	 */
+	bool
+	add_ringfd(ciosrv* iosrv, int fd);
+
+	/**
+	 * @brief	Cancels pending receives on fd and drops data not yet submitted.
 	 */
 	void
-	has_timer(ciosrv* iosrv) {
-		flag_new_timer_installed = true;
-		RwLock lock(timers_rwlock, RwLock::RWLOCK_READ);
-		timers[iosrv] = true; // already exists => previously created in register_ciosrv
-		wakeup(); // wakeup main loop, just in case
+	drop_ringfd(ciosrv* iosrv, int fd);
+
+	/**
+	 * @brief	Queues mem for transmission on fd, takes ownership of mem.
+	 */
+	void
+	send_ringfd(ciosrv* iosrv, int fd, cmemory* mem);
+
+	/**
+	 * @brief	Returns number of bytes queued on fd and not yet accepted by the kernel.
+	 */
+	size_t
+	get_ringfd_backlog(int fd) const;
+
+	/**
+	 * @brief	Inserts a new timer into this loop's timer wheel.
+	 */
+	rofl::ctimerid
+	add_timer(const rofl::ctimer& timer) {
+		rofl::ctimerid timer_id = timers.add_timer(timer);
+		has_timer();
+		return timer_id;
 	};
 
+	/**
+	 * @brief	Resets an existing timer in this loop's timer wheel.
+	 */
+	rofl::ctimerid
+	reset_timer(const rofl::ctimerid& timer_id, const rofl::ctimespec& timespec) {
+		rofl::ctimerid tid = timers.reset(timer_id, timespec);
+		has_timer();
+		return tid;
+	};
+
+	/**
+	 * @brief	Checks for a pending timer in this loop's timer wheel.
+	 */
+	bool
+	pending_timer(const rofl::ctimerid& timer_id) const
+	{ return timers.pending(timer_id); };
+
+	/**
+	 * @brief	Removes a timer from this loop's timer wheel.
+	 */
+	void
+	cancel_timer(const rofl::ctimerid& timer_id)
+	{ timers.cancel(timer_id); };
+
+	/**
+	 * @brief	Removes all timers registered by iosrv from this loop's timer wheel.
+	 */
+	void
+	cancel_all_timers(ciosrv* iosrv);
+
+	/**
+	 * @brief	Returns number of timers registered by iosrv.
+	 */
+	size_t
+	num_timers(ciosrv* iosrv) const;
+
 	/**
 	 *
 	 */
 	void
-	has_no_timer(ciosrv *iosrv) {
-		RwLock lock(timers_rwlock, RwLock::RWLOCK_READ);
-		timers[iosrv] = false; // already exists => previously created in register_ciosrv
+	has_timer() {
+		flag_new_timer_installed = true;
+		wakeup(); // loop may be sleeping in epoll_wait with an outdated timeout
 	};
 
 	/**
@@ -552,11 +565,15 @@ private:
 			pthread_t tid = 0) :
 				flag_keep_on_running(false),
 				flag_wait_on_kernel(false),
-				flag_waking_up(false),
 				flag_new_event_installed(false),
 				flag_new_timer_installed(false),
 				tid(tid),
-				epollfd(-1) {
+				epollfd(-1),
+				poll_num_fds(0),
+				backend(cioloop::default_backend),
+				ring(NULL),
+				ring_poll_armed(false),
+				ring_recv_multishot(true) {
 		if (0 == tid) {
 			this->tid = pthread_self();
 		}
@@ -575,8 +592,7 @@ private:
 	 *
 	 */
 	virtual
-	~cioloop()
-	{ close(epollfd); };
+	~cioloop();
 
 	/**
 	 *
@@ -611,46 +627,82 @@ private:
 
 	/**
 	 * @brief	Wake up this loop from this or other thread.
+	 *
+	 * A loop is never blocked in epoll_wait() while its own thread calls
+	 * wakeup(), so only calls from other threads notify the loop.
+	 * Concurrent wakeups are coalesced by rofl::cwakeup.
 	 */
 	void
 	wakeup() {
-#ifndef NDEBUG
-		logging::trace << "[rofl-common][cioloop][wakeup] waking up thread, "
-				<< "tid: 0x" << std::hex << tid << std::dec << std::endl;
-#endif
-		if (not flag_waking_up) {
-			flag_waking_up = true;
-			pipe.writemsg('1');
+		if (pthread_self() == tid) {
+			return;
 		}
+		ROFL_TRACE << "[rofl-common][cioloop][wakeup] waking up thread, "
+				<< "tid: 0x" << std::hex << tid << std::dec << std::endl;
+		wakeup_event.notify();
 	};
 
 private:
 
 	void
 	run_on_timers(
-			std::pair<ciosrv*, ctimespec>& next_timeout);
+			ctimespec& next_timeout);
 
 	void
 	run_on_events();
 
 	void
 	run_on_kernel(
-			std::pair<ciosrv*, ctimespec>& next_timeout);
+			ctimespec& next_timeout);
 
-	bool
-	poll_set_has_fd(int fd) const {
-		RwLock lock(poll_rwlock, RwLock::RWLOCK_READ);
-		return (not (poll_events.find(fd) == poll_events.end()));
-	};
+	void
+	run_on_ring(
+			ctimespec& next_timeout);
 
+	/**
+	 * @brief	Dispatches num_events entries from poll_buffer.
+	 */
 	void
-	check_poll_set(int fd) {
-		if (poll_set_has_fd(fd))
-			return;
-		RwLock lock(poll_rwlock, RwLock::RWLOCK_WRITE);
-		poll_events[fd].events = EPOLLET;
-		poll_events[fd].data.fd = fd;
-	};
+	poll_dispatch(
+			int num_events);
+
+	/**
+	 * @brief	Turns pending receives, cancellations and transmissions into submissions.
+	 */
+	void
+	ring_prepare();
+
+	void
+	ring_complete_recv(
+			uint64_t user_data, int32_t res, uint32_t flags);
+
+	void
+	ring_complete_send(
+			uint64_t user_data, int32_t res, uint32_t flags);
+
+	/**
+	 * @brief	Adds events for fd owned by iosrv to the epoll set.
+	 */
+	void
+	poll_set_add(
+			ciosrv* iosrv, int fd, uint32_t events);
+
+	/**
+	 * @brief	Removes events for fd from the epoll set, the descriptor
+	 * is deleted from the set once no events remain.
+	 */
+	void
+	poll_set_drop(
+			ciosrv* iosrv, int fd, uint32_t events);
+
+	struct cpollslot;
+
+	/**
+	 * @brief	Returns slot for fd, allocated on first use. Caller must hold poll_rwlock.
+	 */
+	cpollslot*
+	get_slot(
+			int fd);
 
 public:
 
@@ -662,13 +714,10 @@ public:
 		{
 			RwLock lock(ioloop.poll_rwlock, RwLock::RWLOCK_READ);
 			os << indent(2) << "<instances with rfds: ";
-			for (std::map<int, struct epoll_event>::const_iterator
-					it = ioloop.poll_events.begin(); it != ioloop.poll_events.end(); ++it) {
-				if (ioloop.poll_iosrvs.find(it->first) == ioloop.poll_iosrvs.end()) {
-					continue;
-				}
-				if (it->second.events & EPOLLIN) {
-					os << ioloop.poll_iosrvs.at(it->first) << ":" << it->first << " ";
+			for (std::vector<cpollslot*>::const_iterator
+					it = ioloop.poll_slots.begin(); it != ioloop.poll_slots.end(); ++it) {
+				if ((NULL != *it) && ((*it)->events & EPOLLIN)) {
+					os << (*it)->iosrv << ":" << (*it)->fd << " ";
 				}
 			}
 			os << ">" << std::endl;
@@ -677,28 +726,16 @@ public:
 		{
 			RwLock lock(ioloop.poll_rwlock, RwLock::RWLOCK_READ);
 			os << indent(2) << "<instances with wfds: ";
-			for (std::map<int, struct epoll_event>::const_iterator
-					it = ioloop.poll_events.begin(); it != ioloop.poll_events.end(); ++it) {
-				if (ioloop.poll_iosrvs.find(it->first) == ioloop.poll_iosrvs.end()) {
-					continue;
-				}
-				if (it->second.events & EPOLLOUT) {
-					os << ioloop.poll_iosrvs.at(it->first) << ":" << it->first << " ";
+			for (std::vector<cpollslot*>::const_iterator
+					it = ioloop.poll_slots.begin(); it != ioloop.poll_slots.end(); ++it) {
+				if ((NULL != *it) && ((*it)->events & EPOLLOUT)) {
+					os << (*it)->iosrv << ":" << (*it)->fd << " ";
 				}
 			}
 			os << ">" << std::endl;
 		}
 
-		{
-			RwLock lock(ioloop.timers_rwlock, RwLock::RWLOCK_READ);
-			os << indent(2) << "<instances with timer needs: ";
-			// locking?
-			for (std::map<ciosrv*, bool>::const_iterator
-					it = ioloop.timers.begin(); it != ioloop.timers.end(); ++it) {
-				os << it->first << ":" << it->second << " ";
-			}
-			os << ">" << std::endl;
-		}
+		{ indent i(2); os << ioloop.timers; }
 
 		{
 			RwLock lock(ioloop.events_rwlock, RwLock::RWLOCK_READ);
@@ -720,24 +757,70 @@ private:
 	 * bitset is not thread-safe and I am too lazy to write a wrapper ... */
 	bool									flag_keep_on_running;
 	bool									flag_wait_on_kernel;
-	bool									flag_waking_up;
 	bool									flag_new_event_installed;
 	bool									flag_new_timer_installed;
 
 	std::set<ciosrv*> 						ciolist;
 	mutable PthreadRwLock 					ciolist_rwlock;
-	std::map<ciosrv*, bool>					timers;
-	mutable PthreadRwLock					timers_rwlock;
+	ctimerwheel								timers; // has its own locking
 	std::map<ciosrv*, bool>					events;
 	mutable PthreadRwLock					events_rwlock;
 
-	cpipe									pipe;
+	cwakeup									wakeup_event;
 	pthread_t        			       		tid;
 
+	/*
+	 * Dispatch entry for a file descriptor, referenced by epoll_event.data.ptr.
+	 * Slots are allocated on first use of a descriptor and reused until the
+	 * loop is destroyed, so a pointer returned by epoll_wait() never dangles.
+	 * A slot of a deregistered descriptor has no events and no iosrv.
+	 */
+	struct cpollslot {
+		int										fd;
+		uint32_t								events;
+		ciosrv* volatile						iosrv;
+		/*
+		 * io_uring backend only: completions carry the generation of the
+		 * registration they were submitted for, so completions arriving
+		 * after deregistration or reuse of the descriptor are discarded.
+		 */
+		bool									ring;
+		uint32_t								gen;
+		bool									rx_armed;	// receive submitted
+		uint64_t								tx_id;		// submitted sendmsg, 0 if none
+		std::deque<cmemory*>					txqueue;	// waiting for submission
+		size_t									tx_backlog;	// bytes queued or in flight
+	};
+
 	int										epollfd;
 	mutable PthreadRwLock					poll_rwlock;
-	std::map<int, struct epoll_event>		poll_events;
-	std::map<int, ciosrv*>					poll_iosrvs;
+	std::vector<cpollslot*>					poll_slots;		// indexed by file descriptor
+	size_t									poll_num_fds;	// descriptors in epoll set
+	std::vector<struct epoll_event>			poll_buffer;	// used by run_on_kernel() only
+
+	/*
+	 * io_uring backend, the ring is created on first registration of a
+	 * descriptor. backend and ring are written under poll_rwlock and the
+	 * ring is never reset before destruction of the loop. Lists of pending
+	 * work are protected by poll_rwlock and turned into submissions by the
+	 * loop's thread, which is the only user of the ring.
+	 */
+	static unsigned int const				RING_ENTRIES;
+	static unsigned int const				RING_NUM_BUFFERS;
+	static size_t const						RING_BUFFER_SIZE;
+	static unsigned int const				RING_MAX_TX_IOVECS;
+
+	struct cringtx;
+
+	static enum cioloop_backend_t volatile	default_backend;
+	enum cioloop_backend_t					backend;
+	cioring*								ring;
+	bool									ring_poll_armed;	// multishot poll on epollfd
+	bool									ring_recv_multishot;// cleared when unsupported by kernel
+	std::vector<int>						ring_arm;			// descriptors waiting for a receive
+	std::vector<uint64_t>					ring_cancel;		// operations to be cancelled
+	std::vector<int>						ring_tx;			// descriptors with queued data
+	std::set<cringtx*>						ring_tx_inflight;	// loop's thread only
 
 	sigset_t 								sigmask;
 };
@@ -769,6 +852,10 @@ private:
  *
  * 1.d) deregister_filedesc_w() deregister a write descriptor
  *
+ * 1.l) register_filedesc_ring() serve a stream socket by the io_uring backend
+ *
+ * 1.m) send_filedesc_ring() queue data for transmission on such a socket
+ *
  * Methods for timer management:
  *
  * 1.e) register_timer() register a timer
@@ -800,6 +887,10 @@ private:
  *
  * 2.e) handle_event() events sent via notify() method
  *
+ * 2.f) handle_recv() data received on a descriptor served by io_uring
+ *
+ * 2.g) handle_sent() transmission completed on a descriptor served by io_uring
+ *
  * This class utilizes timer handles based on class rofl::ctimerid
  * for managing pending timers, e.g., cancel or restarting them.
  *
@@ -938,6 +1029,35 @@ protected:
 	handle_timeout(int opaque, void *data = (void*)0)
 	{};
 
+	/**
+	 * @brief	Handler for data received on descriptors registered via register_filedesc_ring().
+	 *
+	 * To be overwritten by derived class. Default behaviour: data is ignored.
+	 * buf is owned by the loop and valid until this handler returns.
+	 *
+	 * @param fd descriptor data was received on
+	 * @param buf received data, NULL when len <= 0
+	 * @param len number of bytes received, 0 when the peer has closed the
+	 * connection, a negative error code on failure
+	 */
+	virtual void
+	handle_recv(int fd, const uint8_t* buf, ssize_t len)
+	{};
+
+	/**
+	 * @brief	Handler for transmissions on descriptors registered via register_filedesc_ring().
+	 *
+	 * To be overwritten by derived class. Default behaviour: event is ignored.
+	 *
+	 * @param fd descriptor data was sent on
+	 * @param res number of bytes sent by a completed batch of
+	 * send_filedesc_ring() calls or a negative error code on failure,
+	 * data queued on fd has been dropped in this case
+	 */
+	virtual void
+	handle_sent(int fd, ssize_t res)
+	{};
+
 	/**@}*/
 
 protected:
@@ -1000,44 +1120,76 @@ protected:
 		rofl::cioloop::get_loop(get_thread_id()).drop_writefd(this, fd);
 	};
 
-	/**@}*/
-
-protected:
-
 	/**
+	 * @brief	Registers a connected stream socket with the io_uring backend.
+	 *
+	 * Received data will be indicated via calling handle_recv(fd). Do not
+	 * register fd for read events in addition.
 	 *
+	 * @param fd the socket descriptor
+	 * @return false when the loop is running on epoll, fd is not registered then
 	 */
 	bool
-	has_next_event() const
-	{ return (not events.empty()); };
+	register_filedesc_ring(int fd) {
+		RwLock lock(ringfds_rwlock, RwLock::RWLOCK_WRITE);
+		if (not rofl::cioloop::get_loop(get_thread_id()).add_ringfd(this, fd))
+			return false;
+		ringfds.insert(fd);
+		return true;
+	};
 
 	/**
+	 * @brief	Deregisters a socket from the io_uring backend, drops data not yet submitted.
 	 *
+	 * @param fd the socket descriptor
 	 */
-	ctimer
-	get_next_timer()
-	{ return timers.get_next_timer(); };
+	void
+	deregister_filedesc_ring(int fd) {
+		RwLock lock(ringfds_rwlock, RwLock::RWLOCK_WRITE);
+		if (ringfds.erase(fd) == 0)
+			return;
+		rofl::cioloop::get_loop(get_thread_id()).drop_ringfd(this, fd);
+	};
 
 	/**
+	 * @brief	Queues data for transmission on a socket registered with the io_uring backend.
+	 *
+	 * Data queued on all sockets of a loop is submitted with a single
+	 * system call. Completion is indicated via calling handle_sent(fd).
 	 *
+	 * @param fd the socket descriptor
+	 * @param mem heap allocated data, ownership is passed to the loop
 	 */
-	bool
-	has_next_timer() const
-	{ return (not (timers.empty())); };
+	void
+	send_filedesc_ring(int fd, cmemory* mem) {
+		rofl::cioloop::get_loop(get_thread_id()).send_ringfd(this, fd, mem);
+	};
+
+	/**
+	 * @brief	Returns number of bytes queued on fd and not yet accepted by the kernel.
+	 */
+	size_t
+	get_filedesc_ring_backlog(int fd) const {
+		return rofl::cioloop::get_loop(get_thread_id()).get_ringfd_backlog(fd);
+	};
+
+	/**@}*/
+
+protected:
 
 	/**
 	 *
 	 */
-	ctimer
-	get_expired_timer()
-	{ return timers.get_expired_timer(); };
+	bool
+	has_next_event() const
+	{ return (not events.empty()); };
 
 	/**
 	 *
 	 */
 	bool
-	has_expired_timer() const
-	{ return timers.has_expired_timer(); };
+	has_next_timer() const
+	{ return (rofl::cioloop::get_loop(get_thread_id()).num_timers(const_cast<ciosrv*>(this)) > 0); };
 
 	/**
 	 * @name Management methods for timers and events
@@ -1052,10 +1204,9 @@ protected:
 	 * @param ctimer object
 	 * @return timer handle
 	 */
-	const rofl::ctimerid&
+	rofl::ctimerid
 	register_timer(int opaque, const rofl::ctimespec& timespec) {
-		rofl::cioloop::get_loop(get_thread_id()).has_timer(this);
-		return timers.add_timer(ctimer(this, opaque, timespec));
+		return rofl::cioloop::get_loop(get_thread_id()).add_timer(ctimer(this, opaque, timespec));
 	};
 
 	/**
@@ -1067,10 +1218,9 @@ protected:
 	 * @param t timeout in seconds of this timer
 	 * @return timer handle
 	 */
-	const rofl::ctimerid&
+	rofl::ctimerid
 	reset_timer(const rofl::ctimerid& timer_id, const rofl::ctimespec& timespec) {
-		rofl::cioloop::get_loop(get_thread_id()).has_timer(this);
-		return timers.reset(timer_id, timespec);
+		return rofl::cioloop::get_loop(get_thread_id()).reset_timer(timer_id, timespec);
 	};
 
 	/**
@@ -1103,7 +1253,7 @@ protected:
 	 */
 	bool
 	pending_timer(const rofl::ctimerid& timer_id) {
-		return timers.pending(timer_id);
+		return rofl::cioloop::get_loop(get_thread_id()).pending_timer(timer_id);
 	};
 
 	/**
@@ -1113,9 +1263,7 @@ protected:
 	 */
 	void
 	cancel_timer(const rofl::ctimerid& timer_id) {
-		timers.cancel(timer_id);
-		if (timers.empty())
-			rofl::cioloop::get_loop(get_thread_id()).has_no_timer(this);
+		rofl::cioloop::get_loop(get_thread_id()).cancel_timer(timer_id);
 	};
 
 	/**
@@ -1124,8 +1272,7 @@ protected:
 	 */
 	void
 	cancel_all_timers() {
-		timers.clear();
-		rofl::cioloop::get_loop(get_thread_id()).has_no_timer(this);
+		rofl::cioloop::get_loop(get_thread_id()).cancel_all_timers(this);
 	};
 
 	/**
@@ -1164,19 +1311,10 @@ private:
 	 * @brief	Called by cioloop
 	 */
 	void
-	__handle_timeout() {
-		try {
-#ifndef NDEBUG
-			rofl::logging::trace << "[rofl-common][ciosrv][handle_timeout] #timers: "
-					<< timers.size() << std::endl;
-#endif
-			ctimer timer = timers.get_expired_timer();
-#ifndef NDEBUG
-			rofl::logging::trace << "[rofl-common][ciosrv][handle_timeout] timer: "
-					<< (ctimer::now().get_timespec() - timer.get_timespec()).str() << std::endl;
-#endif
-			handle_timeout(timer.get_opaque());
-		} catch (eTimersNotFound& e) {/*do nothing*/}
+	__handle_timeout(const rofl::ctimer& timer) {
+		ROFL_TRACE << "[rofl-common][ciosrv][handle_timeout] timer: "
+				<< (ctimer::now().get_timespec() - timer.get_timespec()).str() << std::endl;
+		handle_timeout(timer.get_opaque());
 	};
 
 public:
@@ -1195,7 +1333,6 @@ public:
 			}
 			os << ">" << std::endl;
 
-			{ indent i(2); os << iosvc.timers; }
 			{ indent i(2); os << iosvc.events; }
 		return os;
 	};
@@ -1207,7 +1344,8 @@ private:
 	mutable PthreadRwLock 			rfds_rwlock;
 	std::set<int>					wfds;
 	mutable PthreadRwLock 			wfds_rwlock;
-	ctimers							timers; // has its own locking
+	std::set<int>					ringfds;
+	mutable PthreadRwLock 			ringfds_rwlock;
 	cevents							events; // has its own locking
 };
 
@@ -4,6 +4,8 @@
 
 #include "cmemory.h"
 
+#include <new>
+
 using namespace rofl;
 
 /*static*/std::set<cmemory*> 	cmemory::cmemory_list;
@@ -81,6 +83,28 @@ cmemory::~cmemory()
 
 
 
+void*
+cmemory::operator new (
+		size_t size)
+{
+	void* ptr = cmempool::allocate(size);
+	if (NULL == ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+
+
+void
+cmemory::operator delete (
+		void* ptr)
+{
+	cmempool::release(ptr);
+}
+
+
+
 cmemory&
 cmemory::operator= (
 		cmemory const& m)
@@ -88,6 +112,16 @@ cmemory::operator= (
 	if (this == &m)
 		return *this;
 
+	// small area and no heap allocated area to be released: copy inline
+	if ((m.memlen() <= CMEMORY_INLINE_SIZE) && ((0 == data.first) || is_inline())) {
+		data.first = (uint8_t*)inline_area;
+		data.second = m.memlen();
+		if (m.memlen() > 0) {
+			memcpy(data.first, m.somem(), m.memlen());
+		}
+		return *this;
+	}
+
 	mallocate(m.memlen());
 
 	memcpy(this->somem(), m.somem(), m.memlen());
@@ -255,18 +289,42 @@ cmemory::resize(
 {
 	if (0 == len) {
 		mfree();
+	} else if (0 == data.first) {
+		mallocate(len);
+	} else if (is_inline() && (len <= CMEMORY_INLINE_SIZE)) {
+		if (len > data.second) {
+			memset(data.first + data.second, 0x00, len - data.second);
+		}
+
+		// adjust data
+		data.second = len;
+	} else if (is_inline()) {
+		uint8_t* area = (uint8_t*)cmempool::allocate(len);
+		if (0 == area) {
+			throw eMemAllocFailed();
+		}
+		memcpy(area, data.first, data.second);
+		memset(area + data.second, 0x00, len - data.second);
+
+		// adjust data
+		data.first = area;
+		data.second = len;
 	} else if (len <= data.second) {
-		if ((data.first = (uint8_t*)realloc(data.first, len)) == 0) {
+		uint8_t* area = (uint8_t*)cmempool::reallocate(data.first, len);
+		if (0 == area) {
 			throw eMemAllocFailed();
 		}
+		data.first = area;
 		//memset(data.first + len, 0x00, data.second);
 
 		// adjust data
 		data.second = len;
 	} else {
-		if ((data.first = (uint8_t*)realloc(data.first, len)) == 0) {
+		uint8_t* area = (uint8_t*)cmempool::reallocate(data.first, len);
+		if (0 == area) {
 			throw eMemAllocFailed();
 		}
+		data.first = area;
 		memset(data.first + data.second, 0x00, len - data.second);
 
 		// adjust data
@@ -329,7 +387,10 @@ cmemory::mallocate(
 	data.second = len;
 
 
-	if ((data.first = (uint8_t*)calloc(1, data.second)) == 0) {
+	if (len <= CMEMORY_INLINE_SIZE) {
+		data.first = (uint8_t*)inline_area;
+	} else if ((data.first = (uint8_t*)cmempool::allocate(data.second)) == 0) {
+		data.second = 0;
 		throw eMemAllocFailed();
 	}
 
@@ -343,7 +404,9 @@ cmemory::mfree()
 {
 	if (data.first) {
 		memset(data.first, 0, data.second);
-		free(data.first);
+		if (not is_inline()) {
+			cmempool::release(data.first);
+		}
 	}
 	data = std::make_pair<uint8_t*, size_t>(NULL, 0);
 }
@@ -381,8 +444,16 @@ cmemory::insert(
 	uint8_t *p_ptr = (uint8_t*)0;
 	size_t p_len = data.second + len;
 
+	if (is_inline() && (p_len <= CMEMORY_INLINE_SIZE)) {
+		memmove(data.first + offset + len, data.first + offset, data.second - offset);
+		memset(data.first + offset, 0x00, len);
+		data.second = p_len;
+		return (somem() + offset);
+	}
 
-	if ((p_ptr = (uint8_t*)calloc(1, p_len)) == 0) {
+	if (p_len <= CMEMORY_INLINE_SIZE) {
+		p_ptr = (uint8_t*)inline_area;
+	} else if ((p_ptr = (uint8_t*)cmempool::allocate(p_len)) == 0) {
 		throw eMemInval();
 	}
 
@@ -390,7 +461,9 @@ cmemory::insert(
 	memset(p_ptr + offset, 0x00, len);
 	memcpy(p_ptr + offset + len, data.first + offset, data.second - offset);
 
-	free(data.first);
+	if (not is_inline()) {
+		cmempool::release(data.first);
+	}
 
 	data.first = p_ptr;
 	data.second = p_len;
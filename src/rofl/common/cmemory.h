@@ -13,6 +13,7 @@
 #include <stdlib.h>
 
 #include "croflexception.h"
+#include "cmempool.h"
 #include "logging.h"
 
 namespace rofl
@@ -40,6 +41,11 @@ class eMemInval 			: public eMemBase {};
  * such changes and updates its internal variables appropriately.
  * Memory addresses kept outside of cmemory must be updated by
  * the developer explicitly.
+ *
+ * Memory areas of up to CMEMORY_INLINE_SIZE bytes, e.g., OXM TLVs
+ * and addresses, are stored inline within the cmemory instance.
+ * Larger memory areas and heap allocated cmemory instances are
+ * obtained from rofl::cmempool.
  */
 class cmemory {
 private:
@@ -51,6 +57,9 @@ private:
 	std::pair<uint8_t*, size_t> 	data;		//< memory area including head- and tail-space
 
 #define CMEMORY_DEFAULT_SIZE 		0
+#define CMEMORY_INLINE_SIZE 		40
+
+	uint64_t						inline_area[CMEMORY_INLINE_SIZE / sizeof(uint64_t)];	//< storage for small memory areas
 
 
 public:
@@ -90,13 +99,31 @@ public:
 
 
 	/**
-	 * @brief	Destructor. Calls C-function free() for allocated memory area.
+	 * @brief	Destructor. Releases allocated memory area.
 	 *
 	 */
 	virtual
 	~cmemory();
 
 
+
+	/**
+	 * @brief	Allocates cmemory instances from rofl::cmempool.
+	 */
+	static void*
+	operator new (
+			size_t size);
+
+
+
+	/**
+	 * @brief	Returns cmemory instances to rofl::cmempool.
+	 */
+	static void
+	operator delete (
+			void* ptr);
+
+
 public:
 
 	/**
@@ -391,6 +418,14 @@ private: // methods
 	 */
 	void mfree();
 
+
+	/** returns true when memory area is stored inline
+	 *
+	 */
+	bool
+	is_inline() const
+	{ return (data.first == (uint8_t*)inline_area); };
+
 public:
 
 	friend std::ostream&
@@ -0,0 +1,417 @@
+/*
+ * cmempool.cc
+ */
+
+#include "cmempool.h"
+
+#include <string.h>
+#include <pthread.h>
+
+using namespace rofl;
+
+size_t const cmempool::MIN_BLOCK_SIZE;
+size_t const cmempool::MAX_BLOCK_SIZE;
+unsigned int const cmempool::NUM_CLASSES;
+unsigned int const cmempool::CACHE_LIMIT;
+
+namespace {
+
+/*
+ * Each block is preceded by a header storing its size class, padded
+ * to 16 bytes for keeping the payload suitably aligned. Blocks from
+ * malloc() carry FALLBACK_CLASS and their requested length instead.
+ */
+static uint32_t const FALLBACK_CLASS = 0xffffffff;
+
+union block_header {
+	struct {
+		size_t		len;
+		uint32_t	cls;
+	} h;
+	uint8_t pad[16];
+};
+
+struct free_block {
+	free_block* next;
+};
+
+/*
+ * hits and misses are written by the owning thread only and read by
+ * others via atomic loads. reset_stats() does not write them, but
+ * records their current values in hits_base and misses_base, which
+ * are protected by pool_lock.
+ */
+struct mempool_cache {
+	free_block*		heads[cmempool::NUM_CLASSES];
+	unsigned int	counts[cmempool::NUM_CLASSES];
+	uint64_t		hits[cmempool::NUM_CLASSES];
+	uint64_t		misses[cmempool::NUM_CLASSES];
+	uint64_t		hits_base[cmempool::NUM_CLASSES];
+	uint64_t		misses_base[cmempool::NUM_CLASSES];
+	mempool_cache*	prev;
+	mempool_cache*	next;
+};
+
+/*
+ * Global state is plain old data, so it remains usable while static
+ * objects are being destroyed.
+ */
+static pthread_mutex_t 		pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t 		pool_once = PTHREAD_ONCE_INIT;
+static pthread_key_t 		pool_key;
+static volatile bool 		pool_enabled = true;
+
+static free_block*			global_heads[cmempool::NUM_CLASSES];
+static size_t				global_blocks[cmempool::NUM_CLASSES];
+static size_t				global_high_water[cmempool::NUM_CLASSES];
+static uint64_t				retired_hits[cmempool::NUM_CLASSES];
+static uint64_t				retired_misses[cmempool::NUM_CLASSES];
+static uint64_t				fallbacks = 0;
+static mempool_cache*		caches = NULL;
+
+static __thread mempool_cache* tls_cache = NULL;
+
+/*
+ * Increments a counter written by a single thread, i.e., without a
+ * locked read-modify-write, while keeping concurrent reads race free.
+ */
+inline void
+increment(uint64_t* counter)
+{
+	__atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+}
+
+inline uint64_t
+counted(const uint64_t* counter, uint64_t base)
+{
+	return __atomic_load_n(counter, __ATOMIC_RELAXED) - base;
+}
+
+inline block_header*
+header_of(const void* ptr)
+{
+	return (block_header*)((uint8_t*)ptr - sizeof(block_header));
+}
+
+inline size_t
+block_size(unsigned int cls)
+{
+	return (cmempool::MIN_BLOCK_SIZE << cls);
+}
+
+inline unsigned int
+size_class(size_t len)
+{
+	unsigned int cls = 0;
+	size_t size = cmempool::MIN_BLOCK_SIZE;
+	while (size < len) {
+		size <<= 1;
+		cls++;
+	}
+	return cls;
+}
+
+/*
+ * Moves up to num free blocks of class cls from cache to the global
+ * free list. Caller must hold pool_lock.
+ */
+void
+flush_locked(mempool_cache* cache, unsigned int cls, unsigned int num)
+{
+	while ((num-- > 0) && (cache->heads[cls] != NULL)) {
+		free_block* block = cache->heads[cls];
+		cache->heads[cls] = block->next;
+		cache->counts[cls]--;
+		block->next = global_heads[cls];
+		global_heads[cls] = block;
+	}
+}
+
+void
+destroy_cache(void* arg)
+{
+	mempool_cache* cache = (mempool_cache*)arg;
+	pthread_mutex_lock(&pool_lock);
+	for (unsigned int cls = 0; cls < cmempool::NUM_CLASSES; cls++) {
+		flush_locked(cache, cls, cache->counts[cls]);
+		retired_hits[cls] += counted(&cache->hits[cls], cache->hits_base[cls]);
+		retired_misses[cls] += counted(&cache->misses[cls], cache->misses_base[cls]);
+	}
+	if (cache->prev)
+		cache->prev->next = cache->next;
+	else
+		caches = cache->next;
+	if (cache->next)
+		cache->next->prev = cache->prev;
+	pthread_mutex_unlock(&pool_lock);
+	if (tls_cache == cache)
+		tls_cache = NULL;
+	free(cache);
+}
+
+void
+initialize()
+{
+	pthread_key_create(&pool_key, &destroy_cache);
+	if (getenv("ROFL_MEMPOOL_DISABLE") != NULL) {
+		pool_enabled = false;
+	}
+}
+
+mempool_cache*
+create_cache()
+{
+	pthread_once(&pool_once, &initialize);
+	mempool_cache* cache = (mempool_cache*)calloc(1, sizeof(mempool_cache));
+	if (NULL == cache)
+		return NULL;
+	pthread_mutex_lock(&pool_lock);
+	cache->next = caches;
+	if (caches)
+		caches->prev = cache;
+	caches = cache;
+	pthread_mutex_unlock(&pool_lock);
+	pthread_setspecific(pool_key, cache);
+	return (tls_cache = cache);
+}
+
+inline mempool_cache*
+get_cache()
+{
+	return (tls_cache != NULL) ? tls_cache : create_cache();
+}
+
+void*
+allocate_fallback(size_t len)
+{
+	__sync_fetch_and_add(&fallbacks, 1);
+	block_header* hdr = (block_header*)malloc(sizeof(block_header) + len);
+	if (NULL == hdr)
+		return NULL;
+	hdr->h.len = len;
+	hdr->h.cls = FALLBACK_CLASS;
+	return (hdr + 1);
+}
+
+/*
+ * Refills an empty cache from the global free list or, if empty as
+ * well, allocates a new block from the system.
+ */
+free_block*
+refill(mempool_cache* cache, unsigned int cls)
+{
+	pthread_mutex_lock(&pool_lock);
+	for (unsigned int i = 0; (i < cmempool::CACHE_LIMIT / 2) && (global_heads[cls] != NULL); i++) {
+		free_block* block = global_heads[cls];
+		global_heads[cls] = block->next;
+		block->next = cache->heads[cls];
+		cache->heads[cls] = block;
+		cache->counts[cls]++;
+	}
+	if (cache->heads[cls] != NULL) {
+		pthread_mutex_unlock(&pool_lock);
+		increment(&cache->hits[cls]);
+		free_block* block = cache->heads[cls];
+		cache->heads[cls] = block->next;
+		cache->counts[cls]--;
+		return block;
+	}
+	if (++global_blocks[cls] > global_high_water[cls])
+		global_high_water[cls] = global_blocks[cls];
+	pthread_mutex_unlock(&pool_lock);
+
+	increment(&cache->misses[cls]);
+	block_header* hdr = (block_header*)malloc(sizeof(block_header) + block_size(cls));
+	if (NULL == hdr) {
+		pthread_mutex_lock(&pool_lock);
+		global_blocks[cls]--;
+		pthread_mutex_unlock(&pool_lock);
+		return NULL;
+	}
+	hdr->h.len = block_size(cls);
+	hdr->h.cls = cls;
+	return (free_block*)(hdr + 1);
+}
+
+}; // end of anonymous namespace
+
+
+
+void*
+cmempool::allocate(
+		size_t len)
+{
+	if (len > MAX_BLOCK_SIZE) {
+		return allocate_fallback(len);
+	}
+	// first allocation of a thread creates its cache, which reads ROFL_MEMPOOL_DISABLE once per process
+	mempool_cache* cache = get_cache();
+	if ((NULL == cache) || (not pool_enabled)) {
+		return allocate_fallback(len);
+	}
+	unsigned int cls = size_class(len);
+	free_block* block = cache->heads[cls];
+	if (block != NULL) {
+		cache->heads[cls] = block->next;
+		cache->counts[cls]--;
+		increment(&cache->hits[cls]);
+		return block;
+	}
+	return refill(cache, cls);
+}
+
+
+
+void*
+cmempool::reallocate(
+		void* ptr,
+		size_t len)
+{
+	if (NULL == ptr) {
+		return allocate(len);
+	}
+	block_header* hdr = header_of(ptr);
+	if (FALLBACK_CLASS == hdr->h.cls) {
+		if ((hdr = (block_header*)realloc(hdr, sizeof(block_header) + len)) == NULL)
+			return NULL;
+		hdr->h.len = len;
+		return (hdr + 1);
+	}
+	if ((len <= MAX_BLOCK_SIZE) && (size_class(len) == hdr->h.cls)) {
+		return ptr;
+	}
+	void* area = allocate(len);
+	if (NULL == area)
+		return NULL;
+	memcpy(area, ptr, (len < hdr->h.len) ? len : hdr->h.len);
+	release(ptr);
+	return area;
+}
+
+
+
+void
+cmempool::release(
+		void* ptr)
+{
+	if (NULL == ptr) {
+		return;
+	}
+	block_header* hdr = header_of(ptr);
+	if (FALLBACK_CLASS == hdr->h.cls) {
+		free(hdr);
+		return;
+	}
+	unsigned int cls = hdr->h.cls;
+	mempool_cache* cache = get_cache();
+	if (NULL == cache) {
+		pthread_mutex_lock(&pool_lock);
+		((free_block*)ptr)->next = global_heads[cls];
+		global_heads[cls] = (free_block*)ptr;
+		pthread_mutex_unlock(&pool_lock);
+		return;
+	}
+	((free_block*)ptr)->next = cache->heads[cls];
+	cache->heads[cls] = (free_block*)ptr;
+	if (++cache->counts[cls] > CACHE_LIMIT) {
+		pthread_mutex_lock(&pool_lock);
+		flush_locked(cache, cls, CACHE_LIMIT / 2);
+		pthread_mutex_unlock(&pool_lock);
+	}
+}
+
+
+
+size_t
+cmempool::capacity(
+		const void* ptr)
+{
+	return (NULL == ptr) ? 0 : header_of(ptr)->h.len;
+}
+
+
+
+void
+cmempool::trim()
+{
+	pthread_mutex_lock(&pool_lock);
+	for (unsigned int cls = 0; cls < NUM_CLASSES; cls++) {
+		while (global_heads[cls] != NULL) {
+			free_block* block = global_heads[cls];
+			global_heads[cls] = block->next;
+			free(header_of(block));
+			global_blocks[cls]--;
+		}
+	}
+	pthread_mutex_unlock(&pool_lock);
+}
+
+
+
+void
+cmempool::set_enabled(
+		bool enabled)
+{
+	pthread_once(&pool_once, &initialize);
+	pool_enabled = enabled;
+}
+
+
+
+bool
+cmempool::is_enabled()
+{
+	pthread_once(&pool_once, &initialize);
+	return pool_enabled;
+}
+
+
+
+cmempool_stats
+cmempool::get_stats(
+		unsigned int cls)
+{
+	if (cls >= NUM_CLASSES) {
+		throw eMemPoolInval();
+	}
+	cmempool_stats stats;
+	stats.block_size = block_size(cls);
+	pthread_mutex_lock(&pool_lock);
+	stats.hits = retired_hits[cls];
+	stats.misses = retired_misses[cls];
+	for (mempool_cache* cache = caches; cache != NULL; cache = cache->next) {
+		stats.hits += counted(&cache->hits[cls], cache->hits_base[cls]);
+		stats.misses += counted(&cache->misses[cls], cache->misses_base[cls]);
+	}
+	stats.blocks = global_blocks[cls];
+	stats.high_water = global_high_water[cls];
+	pthread_mutex_unlock(&pool_lock);
+	return stats;
+}
+
+
+
+uint64_t
+cmempool::get_fallbacks()
+{
+	return __sync_fetch_and_add(&fallbacks, 0);
+}
+
+
+
+void
+cmempool::reset_stats()
+{
+	pthread_mutex_lock(&pool_lock);
+	for (unsigned int cls = 0; cls < NUM_CLASSES; cls++) {
+		retired_hits[cls] = 0;
+		retired_misses[cls] = 0;
+		for (mempool_cache* cache = caches; cache != NULL; cache = cache->next) {
+			cache->hits_base[cls] = __atomic_load_n(&cache->hits[cls], __ATOMIC_RELAXED);
+			cache->misses_base[cls] = __atomic_load_n(&cache->misses[cls], __ATOMIC_RELAXED);
+		}
+		global_high_water[cls] = global_blocks[cls];
+	}
+	__sync_lock_test_and_set(&fallbacks, 0);
+	pthread_mutex_unlock(&pool_lock);
+}
@@ -0,0 +1,191 @@
+/*
+ * cmempool.h
+ */
+
+#ifndef CMEMPOOL_H_
+#define CMEMPOOL_H_
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include <iostream>
+
+#include "rofl/common/croflexception.h"
+
+namespace rofl {
+
+class eMemPoolBase 			: public RoflException {};
+class eMemPoolInval 		: public eMemPoolBase {}; // invalid size class
+
+/**
+ * @brief	Statistics for a single size class of rofl::cmempool
+ */
+class cmempool_stats {
+public:
+
+	cmempool_stats() :
+		block_size(0),
+		hits(0),
+		misses(0),
+		blocks(0),
+		high_water(0)
+	{};
+
+public:
+
+	size_t		block_size;	//< usable size of a block in this class
+	uint64_t	hits;		//< allocations served from a thread cache or the global free list
+	uint64_t	misses;		//< allocations requiring a new block from malloc
+	size_t		blocks;		//< blocks currently held by the pool, in use or free
+	size_t		high_water;	//< maximum number of blocks held by the pool
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, const cmempool_stats& stats) {
+		os << "<cmempool_stats block-size: " << stats.block_size
+				<< " hits: " << stats.hits << " misses: " << stats.misses
+				<< " blocks: " << stats.blocks << " high-water: " << stats.high_water
+				<< " >" << std::endl;
+		return os;
+	};
+};
+
+/**
+ * @brief	Size-class pool allocator for memory areas and messages
+ *
+ * Requests up to MAX_BLOCK_SIZE bytes are rounded up to the next power
+ * of two and served from a free list of that size class. Each thread,
+ * i.e., each rofl::cioloop, owns a cache of free blocks per size class,
+ * so allocation and release take no lock in the common case. A cache
+ * exceeding CACHE_LIMIT blocks returns half of them to a global free
+ * list, an empty cache refills from it. Blocks are returned to the
+ * system only by trim().
+ *
+ * Larger requests and all requests while the pool is disabled are
+ * served by malloc() directly. Any pointer returned by allocate() or
+ * reallocate() must be released via release(), regardless of whether
+ * the pool was enabled at allocation time. The pool can be disabled
+ * at runtime via set_enabled() or by defining ROFL_MEMPOOL_DISABLE in
+ * the environment.
+ */
+class cmempool {
+public:
+
+	/**
+	 * @brief	Smallest size class in bytes
+	 */
+	static size_t const MIN_BLOCK_SIZE = 32;
+
+	/**
+	 * @brief	Largest size class in bytes, i.e., a maximum sized OpenFlow message
+	 */
+	static size_t const MAX_BLOCK_SIZE = 65536;
+
+	/**
+	 * @brief	Number of size classes
+	 */
+	static unsigned int const NUM_CLASSES = 12;
+
+	/**
+	 * @brief	Maximum number of free blocks per size class in a thread cache
+	 */
+	static unsigned int const CACHE_LIMIT = 64;
+
+public:
+
+	/**
+	 * @brief	Allocates a memory area of len bytes, content is undefined.
+	 *
+	 * @return pointer to memory area or NULL when the system is out of memory
+	 */
+	static void*
+	allocate(
+			size_t len);
+
+	/**
+	 * @brief	Resizes a memory area, preserving its content up to the new length.
+	 *
+	 * The area is moved only when len falls into another size class.
+	 * A NULL ptr allocates a new memory area.
+	 *
+	 * @return pointer to memory area or NULL when the system is out of
+	 * memory, ptr remains valid in this case
+	 */
+	static void*
+	reallocate(
+			void* ptr,
+			size_t len);
+
+	/**
+	 * @brief	Releases a memory area, NULL is ignored.
+	 */
+	static void
+	release(
+			void* ptr);
+
+	/**
+	 * @brief	Returns the usable size of a memory area.
+	 */
+	static size_t
+	capacity(
+			const void* ptr);
+
+	/**
+	 * @brief	Returns all free blocks on the global free lists to the system.
+	 */
+	static void
+	trim();
+
+	/**
+	 * @brief	Enables or disables the pool at runtime.
+	 */
+	static void
+	set_enabled(
+			bool enabled);
+
+	/**
+	 * @brief	Returns true when allocations are served from the pool.
+	 */
+	static bool
+	is_enabled();
+
+	/**
+	 * @brief	Returns statistics for size class cls.
+	 *
+	 * Counters of threads still running are read atomically, but may lag
+	 * behind allocations in progress slightly.
+	 *
+	 * @throws eMemPoolInval for cls >= NUM_CLASSES
+	 */
+	static cmempool_stats
+	get_stats(
+			unsigned int cls);
+
+	/**
+	 * @brief	Returns the number of allocations served by malloc().
+	 */
+	static uint64_t
+	get_fallbacks();
+
+	/**
+	 * @brief	Resets hit, miss and fallback counters and sets high-water
+	 * marks to the current number of blocks.
+	 */
+	static void
+	reset_stats();
+
+	friend std::ostream&
+	operator<< (std::ostream& os, const cmempool& pool) {
+		os << "<cmempool enabled: " << is_enabled()
+				<< " fallbacks: " << get_fallbacks() << " >" << std::endl;
+		for (unsigned int cls = 0; cls < NUM_CLASSES; cls++) {
+			os << "  " << get_stats(cls);
+		}
+		return os;
+	};
+};
+
+}; // end of namespace rofl
+
+#endif /* CMEMPOOL_H_ */
@@ -6,14 +6,68 @@
 
 #include "crofbase.h"
 
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
 using namespace rofl;
 
+namespace {
+
+/*
+ * hash of a datapath identifier, spreads sequentially assigned dpids evenly
+ */
+inline uint64_t
+hash_dpid(uint64_t dpid)
+{
+	return (dpid * 0x9e3779b97f4a7c15ULL) >> 32;
+}
+
+/*
+ * FNV-1a hash of the peer's address connected to socket descriptor sd,
+ * ports are excluded, as auxiliary connections use different ones
+ */
+uint64_t
+hash_peer(int sd)
+{
+	struct sockaddr_storage ss;
+	socklen_t sslen = sizeof(ss);
+	memset(&ss, 0, sizeof(ss));
+	if (getpeername(sd, (struct sockaddr*)&ss, &sslen) < 0) {
+		return 0;
+	}
+	const uint8_t* addr = NULL;
+	size_t addrlen = 0;
+	switch (ss.ss_family) {
+	case AF_INET: {
+		addr = (const uint8_t*)&(((struct sockaddr_in*)&ss)->sin_addr);
+		addrlen = sizeof(struct in_addr);
+	} break;
+	case AF_INET6: {
+		addr = (const uint8_t*)&(((struct sockaddr_in6*)&ss)->sin6_addr);
+		addrlen = sizeof(struct in6_addr);
+	} break;
+	default: {
+		return 0;
+	};
+	}
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (size_t i = 0; i < addrlen; i++) {
+		hash = (hash ^ addr[i]) * 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+}; // end of anonymous namespace
+
 /* static */ std::set<crofbase*> crofbase::rofbases;
 
 crofbase::crofbase(
 		const rofl::openflow::cofhello_elem_versionbitmap& versionbitmap,
 		pthread_t tid) :
 				rofl::ciosrv(tid),
+				placement(PLACEMENT_DPID_HASH),
+				conn_queue_capacity(crofqueue::DEFAULT_CAPACITY),
 				versionbitmap(versionbitmap),
 				transactions(this, tid),
 				generation_is_defined(false),
@@ -33,20 +87,128 @@ crofbase::~crofbase()
 		close_dpt_listening();
 		close_ctl_listening();
 
+		// no datapath may be served by a worker thread while being destroyed
+		for (std::vector<crofworker*>::iterator
+				it = workers.begin(); it != workers.end(); ++it) {
+			cioloop::join_thread((*it)->get_thread_id());
+		}
+
 		// detach from higher layer entities
 		while (not rofctls.empty()) {
 			drop_ctl(rofctls.begin()->first);
 		}
 
-		while (not rofdpts.empty()) {
-			drop_dpt(rofdpts.begin()->first);
-		}
+		drop_dpts();
+
+		drop_workers();
 
 	} catch (RoflException& e) {}
 }
 
 
 
+void
+crofbase::set_workers(
+		unsigned int num_workers,
+		enum crofbase_placement_t placement)
+{
+	{
+		RwLock lock(rofdpts_rwlock, RwLock::RWLOCK_READ);
+		if (not rofdpts.empty()) {
+			throw eRofBaseIsBusy();
+		}
+	}
+
+	for (std::vector<crofworker*>::iterator
+			it = workers.begin(); it != workers.end(); ++it) {
+		cioloop::join_thread((*it)->get_thread_id());
+	}
+	drop_workers();
+
+	this->placement = placement;
+	for (unsigned int index = 0; index < num_workers; index++) {
+		workers.push_back(new crofworker(this, versionbitmap, index, cioloop::add_thread()));
+	}
+
+	rofl::logging::info << "[rofl-common][crofbase] "
+			<< "using " << num_workers << " worker thread(s)" << std::endl;
+}
+
+
+
+void
+crofbase::drop_workers()
+{
+	// worker threads must have been joined already
+	for (std::vector<crofworker*>::iterator
+			it = workers.begin(); it != workers.end(); ++it) {
+		pthread_t tid = (*it)->get_thread_id();
+		delete *it;
+		cioloop::drop_loop(tid);
+	}
+	workers.clear();
+	peer_workers.clear();
+}
+
+
+
+crofworker*
+crofbase::least_loaded_worker() const
+{
+	crofworker* worker = workers.front();
+	for (std::vector<crofworker*>::const_iterator
+			it = workers.begin(); it != workers.end(); ++it) {
+		if (((*it)->get_num_dpts() < worker->get_num_dpts()) ||
+				(((*it)->get_num_dpts() == worker->get_num_dpts()) &&
+						((*it)->get_num_accepted() < worker->get_num_accepted()))) {
+			worker = *it;
+		}
+	}
+	return worker;
+}
+
+
+
+pthread_t
+crofbase::select_worker(
+		const rofl::cdpid& dpid) const
+{
+	if (workers.empty()) {
+		return get_thread_id();
+	}
+	if ((PLACEMENT_DPID_HASH == placement) && (0 != dpid.get_uint64_t())) {
+		return workers[hash_dpid(dpid.get_uint64_t()) % workers.size()]->get_thread_id();
+	}
+	return least_loaded_worker()->get_thread_id();
+}
+
+
+
+crofworker*
+crofbase::select_worker(
+		int sd)
+{
+	uint64_t hash = hash_peer(sd);
+	RwLock lock(peer_workers_rwlock, RwLock::RWLOCK_WRITE);
+	std::map<uint64_t, unsigned int>::iterator it = peer_workers.find(hash);
+	if (it != peer_workers.end()) {
+		return workers[it->second];
+	}
+	switch (placement) {
+	case PLACEMENT_LEAST_LOAD: {
+		crofworker* worker = least_loaded_worker();
+		peer_workers[hash] = worker->get_index();
+		return worker;
+	} break;
+	case PLACEMENT_DPID_HASH:
+	default: {
+		return workers[hash % workers.size()];
+	};
+	}
+}
+
+
+
 void
 crofbase::handle_connect_refused(
 		crofconn& conn)
@@ -87,12 +249,47 @@ crofbase::handle_connected(
 				<< "creating new crofctl instance for ctl peer" << std::endl;
 		add_ctl(get_idle_ctlid(), conn.get_versionbitmap(), /*remove_upon_channel_termination=*/true).add_connection(&conn);
 	} break;
-	case rofl::crofconn::FLAVOUR_DPT: try {
-		crofdpt::get_dpt(conn.get_dpid()).add_connection(&conn);
-	} catch (eRofDptNotFound& e) {
-		rofl::logging::info << "[rofl-common][crofbase] "
-				<< "creating new crofdpt instance for dpt peer, dpid:" << conn.get_dpid() << std::endl;
-		add_dpt(get_idle_dptid(), conn.get_versionbitmap(), /*remove_upon_channel_termination=*/true).add_connection(&conn);
+	case rofl::crofconn::FLAVOUR_DPT: {
+		crofworker* worker = find_worker(conn.get_thread_id());
+
+		crofdpt* dpt = NULL;
+		try {
+			dpt = &(crofdpt::get_dpt(conn.get_dpid()));
+		} catch (eRofDptNotFound& e) {}
+
+		if ((NULL != dpt) && (dpt->get_thread_id() != conn.get_thread_id())) {
+			/*
+			 * The connection was placed by its peer's address before its dpid was known.
+			 * It must not be attached to a datapath served by another thread, so close
+			 * it and place the peer's next connection on the datapath's worker.
+			 */
+			rofl::logging::warn << "[rofl-common][crofbase] "
+					<< "connection and crofdpt instance served by different threads, "
+					<< "closing connection, dpid:" << conn.get_dpid() << std::endl;
+			crofworker* target = find_worker(dpt->get_thread_id());
+			if (target) {
+				RwLock lock(peer_workers_rwlock, RwLock::RWLOCK_WRITE);
+				peer_workers[hash_peer(conn.get_rofsocket().get_socket().get_sd())] = target->get_index();
+			}
+			if (not (worker && worker->drop(&conn))) {
+				conn.close();
+			}
+			return;
+		}
+
+		// connection is owned by its control channel from now on
+		if (worker)
+			worker->release(&conn);
+
+		if (NULL == dpt) {
+			rofl::logging::info << "[rofl-common][crofbase] "
+					<< "creating new crofdpt instance for dpt peer, dpid:" << conn.get_dpid() << std::endl;
+			// datapath runs in the thread of its main connection, i.e., on its worker
+			RwLock lock(rofdpts_rwlock, RwLock::RWLOCK_WRITE);
+			dpt = &create_dpt(get_idle_dptid_locked(), conn.get_versionbitmap(),
+					/*remove_upon_channel_termination=*/true, rofl::cdpid(0), conn.get_thread_id());
+		}
+		dpt->add_connection(&conn);
 	} break;
 	default: {
 
@@ -102,6 +299,20 @@ crofbase::handle_connected(
 
 
 
+void
+crofbase::handle_closed(
+		crofconn& conn)
+{
+	// connection closed during its OpenFlow handshake
+	crofworker* worker = find_worker(conn.get_thread_id());
+	if (worker && worker->drop(&conn)) {
+		rofl::logging::debug << "[rofl-common][crofbase] "
+				<< "dropping connection closed during handshake, worker: " << worker->get_index() << std::endl;
+	}
+}
+
+
+
 void
 crofbase::handle_listen(
 		csocket& socket, int newsd)
@@ -109,13 +320,22 @@ crofbase::handle_listen(
 	if (is_ctl_listening(socket)) {
 		rofl::logging::debug << "[rofl-common][crofbase] "
 				<< "accept => creating new crofconn for ctl peer on sd: " << newsd << std::endl;
-		(new rofl::crofconn(this, versionbitmap))->accept(
+		(new rofl::crofconn(this, versionbitmap, 0, conn_queue_capacity))->accept(
 				socket.get_socket_type(), socket.get_socket_params(), newsd, rofl::crofconn::FLAVOUR_CTL);
 	}
 	if (is_dpt_listening(socket)) {
+		if (not workers.empty()) {
+			crofworker* worker = select_worker(newsd);
+			rofl::logging::debug << "[rofl-common][crofbase] "
+							<< "accept => handing over dpt peer on sd: " << newsd
+							<< " to worker: " << worker->get_index() << std::endl;
+			worker->handoff(socket.get_socket_type(), socket.get_socket_params(), newsd, rofl::crofconn::FLAVOUR_DPT,
+					conn_queue_capacity);
+			return;
+		}
 		rofl::logging::debug << "[rofl-common][crofbase] "
 						<< "accept => creating new crofconn for dpt peer on sd: " << newsd << std::endl;
-		(new rofl::crofconn(this, versionbitmap))->accept(
+		(new rofl::crofconn(this, versionbitmap, 0, conn_queue_capacity))->accept(
 				socket.get_socket_type(), socket.get_socket_params(), newsd, rofl::crofconn::FLAVOUR_DPT);
 	}
 }
@@ -32,6 +32,7 @@
 #include "rofl/common/logging.h"
 #include "rofl/common/crofdpt.h"
 #include "rofl/common/crofctl.h"
+#include "rofl/common/crofworker.h"
 #include "rofl/common/openflow/openflow.h"
 #include "rofl/common/openflow/cofhelloelemversionbitmap.h"
 #include "rofl/common/crandom.h"
@@ -56,6 +57,7 @@ class eRofBaseTableNotFound         : public eRofBase {}; // flow-table not foun
 class eRofBaseGotoTableNotFound     : public eRofBase {}; // table-id specified in OFPIT_GOTO_TABLE invalid
 class eRofBaseFspSupportDisabled    : public eRofBase {};
 class eRofBaseCongested             : public eRofBase {}; // control channel is congested, dropping messages
+class eRofBaseTxQueueFull           : public eRofBaseCongested {}; // transmit queue is full, message has not been sent
 
 
 
@@ -353,11 +355,8 @@ public:
 	 */
 	rofl::cdptid
 	get_idle_dptid() const {
-		uint64_t id = 0;
-		while (has_dpt(rofl::cdptid(id))) {
-			id++;
-		}
-		return rofl::cdptid(id);
+		RwLock lock(rofdpts_rwlock, RwLock::RWLOCK_READ);
+		return get_idle_dptid_locked();
 	};
 
 	/**
@@ -365,11 +364,16 @@ public:
 	 */
 	void
 	drop_dpts() {
-		for (std::map<rofl::cdptid, crofdpt*>::iterator
-				it = rofdpts.begin(); it != rofdpts.end(); ++it) {
-			delete it->second;
+		while (true) {
+			rofl::cdptid dptid;
+			{
+				RwLock lock(rofdpts_rwlock, RwLock::RWLOCK_READ);
+				if (rofdpts.empty())
+					return;
+				dptid = rofdpts.begin()->first;
+			}
+			drop_dpt(dptid);
 		}
-		rofdpts.clear();
 	};
 
 	/**
@@ -388,6 +392,10 @@ public:
 	 * @param remove_on_channel_close when true, automatically remove this
 	 * rofl::crofdpt instance, when all OpenFlow control channel connections
 	 * have been terminated
+	 * When a worker pool has been configured via set_workers(), the new
+	 * instance is placed on a worker thread according to the placement
+	 * policy.
+	 *
 	 * @param dpid OpenFlow datapath identifier (optional)
 	 * @result reference to new rofl::crofdpt instance
 	 */
@@ -397,12 +405,9 @@ public:
 		const rofl::openflow::cofhello_elem_versionbitmap& versionbitmap,
 		bool remove_on_channel_close = false,
 		const rofl::cdpid& dpid = rofl::cdpid(0)) {
-		if (rofdpts.find(dptid) != rofdpts.end()) {
-			delete rofdpts[dptid];
-			rofdpts.erase(dptid);
-		}
-		rofdpts[dptid] = new crofdpt(this, dptid, remove_on_channel_close, versionbitmap, dpid, get_thread_id());
-		return *(rofdpts[dptid]);
+		drop_dpt(dptid);
+		RwLock lock(rofdpts_rwlock, RwLock::RWLOCK_WRITE);
+		return create_dpt(dptid, versionbitmap, remove_on_channel_close, dpid, select_worker(dpid));
 	};
 
 	/**
@@ -427,8 +432,9 @@ public:
 		const rofl::openflow::cofhello_elem_versionbitmap& versionbitmap,
 		bool remove_on_channel_close = false,
 		const rofl::cdpid& dpid = rofl::cdpid(0)) {
+		RwLock lock(rofdpts_rwlock, RwLock::RWLOCK_WRITE);
 		if (rofdpts.find(dptid) == rofdpts.end()) {
-			rofdpts[dptid] = new crofdpt(this, dptid, remove_on_channel_close, versionbitmap, dpid, get_thread_id());
+			return create_dpt(dptid, versionbitmap, remove_on_channel_close, dpid, select_worker(dpid));
 		}
 		return *(rofdpts[dptid]);
 	};
@@ -446,6 +452,7 @@ public:
 	rofl::crofdpt&
 	set_dpt(
 			const rofl::cdptid& dptid) {
+		RwLock lock(rofdpts_rwlock, RwLock::RWLOCK_READ);
 		if (rofdpts.find(dptid) == rofdpts.end()) {
 			throw eRofBaseNotFound();
 		}
@@ -465,6 +472,7 @@ public:
 	const rofl::crofdpt&
 	get_dpt(
 			const rofl::cdptid& dptid) const {
+		RwLock lock(rofdpts_rwlock, RwLock::RWLOCK_READ);
 		if (rofdpts.find(dptid) == rofdpts.end()) {
 			throw eRofBaseNotFound();
 		}
@@ -479,11 +487,20 @@ public:
 	void
 	drop_dpt(
 		rofl::cdptid dptid) { // make a copy here, do not use a const reference
-		if (rofdpts.find(dptid) == rofdpts.end()) {
-			return;
+		crofdpt* dpt = NULL;
+		{
+			RwLock lock(rofdpts_rwlock, RwLock::RWLOCK_WRITE);
+			if (rofdpts.find(dptid) == rofdpts.end()) {
+				return;
+			}
+			dpt = rofdpts[dptid];
+			rofdpts.erase(dptid);
+			crofworker* worker = find_worker(dpt->get_thread_id());
+			if (worker)
+				worker->dec_dpts();
 		}
-		delete rofdpts[dptid];
-		rofdpts.erase(dptid);
+		// destructor may call back into this crofbase instance
+		delete dpt;
 	};
 
 	/**
@@ -495,11 +512,108 @@ public:
 	bool
 	has_dpt(
 		const rofl::cdptid& dptid) const {
+		RwLock lock(rofdpts_rwlock, RwLock::RWLOCK_READ);
 		return (not (rofdpts.find(dptid) == rofdpts.end()));
 	};
 
 	/**@}*/
 
+public:
+
+	/**
+	 * @name	Methods for managing worker threads serving datapath elements
+	 */
+
+	/**@{*/
+
+	/**
+	 * @brief	Placement policies for rofl::crofdpt instances on worker threads
+	 */
+	enum crofbase_placement_t {
+		PLACEMENT_DPID_HASH		= 0,	/**< by hash of datapath identifier */
+		PLACEMENT_LEAST_LOAD	= 1,	/**< on worker serving fewest datapaths */
+	};
+
+	/**
+	 * @brief	Replaces the worker pool by num_workers new rofl::cioloop threads.
+	 *
+	 * Without workers, all rofl::crofdpt instances and their connections
+	 * run in this crofbase instance's thread. With workers, connections
+	 * accepted on listening sockets for datapath elements are handed over
+	 * to a worker thread, which also runs the rofl::crofdpt instance
+	 * created for the connection. Instances created via add_dpt() or
+	 * set_dpt() are placed on a worker as well. Handlers for datapath
+	 * related events are called in the worker thread's context, so
+	 * derived classes must synchronize any state shared among datapaths.
+	 *
+	 * With PLACEMENT_DPID_HASH, an instance with known datapath identifier
+	 * is placed by hashing its dpid. The dpid of an accepted connection is
+	 * unknown until its handshake has completed, so the peer's address is
+	 * hashed instead, which keeps a datapath's main and auxiliary
+	 * connections on the same worker. With PLACEMENT_LEAST_LOAD, a new peer
+	 * is placed on the worker serving the fewest datapaths, further
+	 * connections from this peer follow it. A connection whose handshake
+	 * reveals a datapath served by another worker is closed, the peer's
+	 * next connection is placed on that datapath's worker.
+	 *
+	 * @param num_workers number of worker threads, 0 disables the pool
+	 * @param placement placement policy
+	 * @throws eRofBaseIsBusy when rofl::crofdpt instances exist
+	 */
+	void
+	set_workers(
+			unsigned int num_workers,
+			enum crofbase_placement_t placement = PLACEMENT_DPID_HASH);
+
+	/**
+	 * @brief	Returns number of worker threads.
+	 */
+	unsigned int
+	get_num_workers() const
+	{ return workers.size(); };
+
+	/**
+	 * @brief	Returns placement policy for worker threads.
+	 */
+	enum crofbase_placement_t
+	get_placement() const
+	{ return placement; };
+
+	/**
+	 * @brief	Returns worker thread identified by index including its load statistics.
+	 *
+	 * @throws eRofBaseNotFound for index >= get_num_workers()
+	 */
+	const rofl::crofworker&
+	get_worker(
+			unsigned int index) const {
+		if (index >= workers.size()) {
+			throw eRofBaseNotFound();
+		}
+		return *(workers[index]);
+	};
+
+	/**
+	 * @brief	Sets capacity of receive and transmit queues for connections created afterwards.
+	 *
+	 * Applies to connections accepted on listening sockets and is inherited
+	 * by rofl::crofdpt instances created afterwards, see
+	 * rofl::crofdpt::set_conn_queue_capacity().
+	 */
+	void
+	set_conn_queue_capacity(
+			size_t capacity)
+	{ conn_queue_capacity = capacity; };
+
+	/**
+	 *
+	 */
+	size_t
+	get_conn_queue_capacity() const
+	{ return conn_queue_capacity; };
+
+	/**@}*/
+
 public:
 
 	/**
@@ -1558,6 +1672,28 @@ protected:
 			rofl::openflow::cofmsg_packet_in& msg)
 	{};
 
+	/**
+	 * @brief	OpenFlow Packet-In message received, offered as zero-copy view.
+	 *
+	 * Executed before any message object is allocated. Return true when the
+	 * message has been consumed, false for receiving it via handle_packet_in().
+	 *
+	 * Unlike all other handlers of rofl::crofbase, this method runs on the I/O
+	 * thread of the datapath's rofl::crofsock instance and may run concurrently
+	 * with them, see rofl::crofdpt_env::handle_packet_in_view() for the rules
+	 * applying. view and auxid are valid during this call only.
+	 *
+	 * @param dpt datapath instance
+	 * @param auxid control connection identifier
+	 * @param view non-owning view on the received message
+	 */
+	virtual bool
+	handle_packet_in_view(
+			rofl::crofdpt& dpt,
+			const rofl::cauxid& auxid,
+			rofl::openflow::cofmsg_view const& view)
+	{ return false; };
+
 	/**
 	 * @brief	OpenFlow Barrier-Reply message received.
 	 *
@@ -2318,10 +2454,18 @@ public:
 			rofl::indent i(2);
 			os << it->first;
 		}
-		for (std::map<cdptid, crofdpt*>::const_iterator
-				it = rofbase.rofdpts.begin(); it != rofbase.rofdpts.end(); ++it) {
+		{
+			RwLock lock(rofbase.rofdpts_rwlock, RwLock::RWLOCK_READ);
+			for (std::map<cdptid, crofdpt*>::const_iterator
+					it = rofbase.rofdpts.begin(); it != rofbase.rofdpts.end(); ++it) {
+				rofl::indent i(2);
+				os << it->first;
+			}
+		}
+		for (std::vector<crofworker*>::const_iterator
+				it = rofbase.workers.begin(); it != rofbase.workers.end(); ++it) {
 			rofl::indent i(2);
-			os << it->first;
+			os << *(*it);
 		}
 		return os;
 	};
@@ -2351,8 +2495,7 @@ private:
 
 	virtual void
 	handle_closed(
-			crofconn& conn)
-	{};
+			crofconn& conn);
 
 	virtual void
 	handle_write(
@@ -2437,6 +2580,58 @@ private:
 
 private:
 
+	rofl::cdptid
+	get_idle_dptid_locked() const {
+		uint64_t id = 0;
+		while (rofdpts.find(rofl::cdptid(id)) != rofdpts.end()) {
+			id++;
+		}
+		return rofl::cdptid(id);
+	};
+
+	/*
+	 * creates a new crofdpt instance running in thread tid, caller must hold rofdpts_rwlock
+	 */
+	rofl::crofdpt&
+	create_dpt(
+			const rofl::cdptid& dptid,
+			const rofl::openflow::cofhello_elem_versionbitmap& versionbitmap,
+			bool remove_on_channel_close,
+			const rofl::cdpid& dpid,
+			pthread_t tid) {
+		rofdpts[dptid] = new crofdpt(this, dptid, remove_on_channel_close, versionbitmap, dpid, tid);
+		rofdpts[dptid]->set_conn_queue_capacity(conn_queue_capacity);
+		crofworker* worker = find_worker(tid);
+		if (worker)
+			worker->inc_dpts();
+		return *(rofdpts[dptid]);
+	};
+
+	crofworker*
+	find_worker(
+			pthread_t tid) const {
+		for (std::vector<crofworker*>::const_iterator
+				it = workers.begin(); it != workers.end(); ++it) {
+			if ((*it)->get_thread_id() == tid)
+				return *it;
+		}
+		return NULL;
+	};
+
+	crofworker*
+	least_loaded_worker() const;
+
+	pthread_t
+	select_worker(
+			const rofl::cdpid& dpid) const;
+
+	crofworker*
+	select_worker(
+			int sd);
+
+	void
+	drop_workers();
+
 	bool
 	is_dpt_listening(
 			csocket& socket) const {
@@ -2524,6 +2719,19 @@ private:
 	std::map<cctlid, crofctl*>		rofctls;
 	/**< set of active data path connections */
 	std::map<cdptid, crofdpt*>		rofdpts;
+	/**< rwlock for rofdpts, modified by worker threads */
+	mutable PthreadRwLock			rofdpts_rwlock;
+	/**< worker threads serving datapath elements */
+	std::vector<crofworker*>		workers;
+	/**< placement policy for worker threads */
+	enum crofbase_placement_t		placement;
+	/**< capacity of receive and transmit queues of new connections */
+	size_t							conn_queue_capacity;
+	/**< worker index per peer address hash, learned from placed datapaths */
+	std::map<uint64_t, unsigned int>
+									peer_workers;
+	/**< rwlock for peer_workers, modified by worker threads */
+	mutable PthreadRwLock			peer_workers_rwlock;
 	/**< listening sockets for incoming connections from datapath elements */
 	std::map<unsigned int, csocket*>
 									dpt_sockets;
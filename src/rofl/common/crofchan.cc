@@ -11,6 +11,7 @@
 using namespace rofl;
 
 /*static*/std::set<crofchan_env*> crofchan_env::rofchan_envs;
+/*static*/PthreadRwLock crofchan_env::rofchan_envs_lock;
 
 
 
@@ -30,6 +31,8 @@ crofchan::close()
 {
 	while (not conns.empty()) {
 		std::map<cauxid, crofconn*>::reverse_iterator it = conns.rbegin();
+		save_rx_counters(*(it->second));
+		save_queue_stats(*(it->second));
 		delete it->second;
 		conns.erase(it->first);
 	}
@@ -100,7 +103,11 @@ crofchan::add_conn(
 		drop_conn(auxid); // drop old connection first
 	}
 
-	(conns[auxid] = new crofconn(this, vbitmap, get_thread_id()));
+	(conns[auxid] = new crofconn(this, vbitmap, get_thread_id(), queue_capacity));
+
+	apply_rx_limits(*(conns[auxid]));
+	apply_sched(*(conns[auxid]));
+	conns[auxid]->set_multipart_streaming(multipart_streaming);
 
 	set_conn(auxid).connect(auxid, socket_type, socket_params);
 
@@ -146,6 +153,10 @@ crofchan::add_conn(
 	conns[auxid] = conn;
 	conns[auxid]->set_env(this);
 
+	apply_rx_limits(*(conns[auxid]));
+	apply_sched(*(conns[auxid]));
+	conns[auxid]->set_multipart_streaming(multipart_streaming);
+
 	rofl::logging::debug << "[rofl-common][crofchan] "
 			<< "added connection, auxid: " << auxid.str() << " " << str() << std::endl;
 
@@ -184,7 +195,7 @@ crofchan::set_conn(
 		} else {
 			vbitmap.add_ofp_version(ofp_version);	// auxiliary connections: use OFP version negotiated for main connection
 		}
-		conns[auxid] = new crofconn(this, vbitmap, get_thread_id());
+		conns[auxid] = new crofconn(this, vbitmap, get_thread_id(), queue_capacity);
 
 		rofl::logging::debug << "[rofl-common][crofchan][set_conn] "
 				<< "added connection, auxid: " << auxid << " " << str() << std::endl;
@@ -218,6 +229,8 @@ crofchan::drop_conn(
 	if (rofl::cauxid(0) == auxid) {
 		rofl::logging::debug << "[rofl-common][crofchan][drop_conn] "
 				<< "dropping main connection and all auxiliary connections. " << str() << std::endl;
+		save_rx_counters(*conns[auxid]);
+		save_queue_stats(*conns[auxid]);
 		delete conns[auxid];
 		conns.erase(auxid);
 
@@ -227,6 +240,8 @@ crofchan::drop_conn(
 	} else {
 		rofl::logging::debug << "[rofl-common][crofchan][drop_conn] "
 				<< "dropping auxiliary connection, auxid: " << auxid.str() << " " << str() << std::endl;
+		save_rx_counters(*conns[auxid]);
+		save_queue_stats(*conns[auxid]);
 		delete conns[auxid];
 		conns.erase(auxid);
 	}
@@ -244,6 +259,222 @@ crofchan::has_conn(
 
 
 
+void
+crofchan::set_conn_rx_limit(
+		enum crofconn::outqueue_type_t queue_id,
+		const crofconn::crxlimit& limit)
+{
+	if (queue_id >= crofconn::QUEUE_MAX) {
+		throw eRofChanInval();
+	}
+	rxlimits[queue_id] = limit;
+	for (std::map<cauxid, crofconn*>::iterator
+			it = conns.begin(); it != conns.end(); ++it) {
+		it->second->set_rx_limit(queue_id, limit);
+	}
+}
+
+
+
+void
+crofchan::set_rx_rate_limit(
+		enum crofconn::outqueue_type_t queue_id,
+		unsigned int rate,
+		unsigned int burst)
+{
+	if (queue_id >= crofconn::QUEUE_MAX) {
+		throw eRofChanInval();
+	}
+	rxbuckets[queue_id].set_rate(rate, burst);
+}
+
+
+
+crofconn::crxcounters
+crofchan::get_rx_counters(
+		enum crofconn::outqueue_type_t queue_id) const
+{
+	if (queue_id >= crofconn::QUEUE_MAX) {
+		throw eRofChanInval();
+	}
+	crofconn::crxcounters counters(rxcounters[queue_id]);
+	for (std::map<cauxid, crofconn*>::const_iterator
+			it = conns.begin(); it != conns.end(); ++it) {
+		counters += it->second->get_rx_counters(queue_id);
+	}
+	return counters;
+}
+
+
+
+void
+crofchan::apply_rx_limits(
+		crofconn& conn)
+{
+	for (unsigned int queue_id = 0; queue_id < crofconn::QUEUE_MAX; queue_id++) {
+		conn.set_rx_limit((enum crofconn::outqueue_type_t)queue_id, rxlimits[queue_id]);
+		conn.set_rx_shared_bucket((enum crofconn::outqueue_type_t)queue_id, &rxbuckets[queue_id]);
+	}
+}
+
+
+
+void
+crofchan::save_rx_counters(
+		crofconn& conn)
+{
+	for (unsigned int queue_id = 0; queue_id < crofconn::QUEUE_MAX; queue_id++) {
+		rxcounters[queue_id] += conn.get_rx_counters((enum crofconn::outqueue_type_t)queue_id);
+	}
+}
+
+
+
+void
+crofchan::set_rx_scheduler(
+		enum crofsched::crofsched_type_t type)
+{
+	if (type > crofsched::SCHED_WFQ) {
+		throw eRofSchedInval("crofchan::set_rx_scheduler() invalid scheduler type");
+	}
+	for (std::map<cauxid, crofconn*>::iterator
+			it = conns.begin(); it != conns.end(); ++it) {
+		it->second->set_rx_scheduler(type); // may throw
+	}
+	rxsched_type = type;
+}
+
+
+
+void
+crofchan::set_rx_weight(
+		enum crofconn::outqueue_type_t queue_id,
+		unsigned int weight)
+{
+	if (queue_id >= crofconn::QUEUE_MAX) {
+		throw eRofChanInval();
+	}
+	rxweights[queue_id] = (0 == weight) ? 1 : weight;
+	for (std::map<cauxid, crofconn*>::iterator
+			it = conns.begin(); it != conns.end(); ++it) {
+		it->second->set_rx_weight(queue_id, weight);
+	}
+}
+
+
+
+crofsched_stats
+crofchan::get_rx_queue_stats(
+		enum crofconn::outqueue_type_t queue_id) const
+{
+	if (queue_id >= crofconn::QUEUE_MAX) {
+		throw eRofChanInval();
+	}
+	crofsched_stats stats(rxqstats[queue_id]);
+	for (std::map<cauxid, crofconn*>::const_iterator
+			it = conns.begin(); it != conns.end(); ++it) {
+		stats += it->second->get_rx_queue_stats(queue_id);
+	}
+	return stats;
+}
+
+
+
+void
+crofchan::set_tx_scheduler(
+		enum crofsched::crofsched_type_t type)
+{
+	if (type > crofsched::SCHED_WFQ) {
+		throw eRofSchedInval("crofchan::set_tx_scheduler() invalid scheduler type");
+	}
+	for (std::map<cauxid, crofconn*>::iterator
+			it = conns.begin(); it != conns.end(); ++it) {
+		it->second->set_tx_scheduler(type); // may throw
+	}
+	txsched_type = type;
+}
+
+
+
+void
+crofchan::set_tx_weight(
+		enum crofconn::outqueue_type_t queue_id,
+		unsigned int weight)
+{
+	if (queue_id >= crofconn::QUEUE_MAX) {
+		throw eRofChanInval();
+	}
+	txweights[queue_id] = (0 == weight) ? 1 : weight;
+	for (std::map<cauxid, crofconn*>::iterator
+			it = conns.begin(); it != conns.end(); ++it) {
+		it->second->set_tx_weight(queue_id, weight);
+	}
+}
+
+
+
+crofsched_stats
+crofchan::get_tx_queue_stats(
+		enum crofconn::outqueue_type_t queue_id) const
+{
+	if (queue_id >= crofconn::QUEUE_MAX) {
+		throw eRofChanInval();
+	}
+	crofsched_stats stats(txqstats[queue_id]);
+	for (std::map<cauxid, crofconn*>::const_iterator
+			it = conns.begin(); it != conns.end(); ++it) {
+		stats += it->second->get_tx_queue_stats(queue_id);
+	}
+	return stats;
+}
+
+
+
+void
+crofchan::set_multipart_streaming(
+		bool streaming)
+{
+	multipart_streaming = streaming;
+	for (std::map<cauxid, crofconn*>::iterator
+			it = conns.begin(); it != conns.end(); ++it) {
+		it->second->set_multipart_streaming(streaming);
+	}
+}
+
+
+
+void
+crofchan::apply_sched(
+		crofconn& conn)
+{
+	if (conn.get_rx_scheduler() != rxsched_type) {
+		conn.set_rx_scheduler(rxsched_type);
+	}
+	if (conn.get_tx_scheduler() != txsched_type) {
+		conn.set_tx_scheduler(txsched_type);
+	}
+	for (unsigned int queue_id = 0; queue_id < crofconn::QUEUE_MAX; queue_id++) {
+		if (0 != rxweights[queue_id])
+			conn.set_rx_weight((enum crofconn::outqueue_type_t)queue_id, rxweights[queue_id]);
+		if (0 != txweights[queue_id])
+			conn.set_tx_weight((enum crofconn::outqueue_type_t)queue_id, txweights[queue_id]);
+	}
+}
+
+
+
+void
+crofchan::save_queue_stats(
+		crofconn& conn)
+{
+	for (unsigned int queue_id = 0; queue_id < crofconn::QUEUE_MAX; queue_id++) {
+		rxqstats[queue_id] += conn.get_rx_queue_stats((enum crofconn::outqueue_type_t)queue_id);
+		txqstats[queue_id] += conn.get_tx_queue_stats((enum crofconn::outqueue_type_t)queue_id);
+	}
+}
+
+
+
 unsigned int
 crofchan::send_message(
 		const cauxid& aux_id,
@@ -261,7 +492,12 @@ crofchan::send_message(
 
 	unsigned int cwnd_size = 0;
 
-	cwnd_size = conns[aux_id]->send_message(msg);
+	try {
+		cwnd_size = conns[aux_id]->send_message(msg);
+	} catch (eRofSockTxQueueFull& e) {
+		delete msg; // message has not been queued
+		throw eRofBaseTxQueueFull();
+	}
 
 	if (cwnd_size == 0) {
 		throw eRofBaseCongested();
@@ -39,21 +39,26 @@ class crofchan; // forward declaration
  */
 class crofchan_env {
 	static std::set<crofchan_env*> rofchan_envs;
+	static PthreadRwLock rofchan_envs_lock;
 
 public:
 
 	/**
 	 * @brief	crofchan_env constructor
 	 */
-	crofchan_env()
-	{ crofchan_env::rofchan_envs.insert(this); };
+	crofchan_env() {
+		RwLock lock(crofchan_env::rofchan_envs_lock, RwLock::RWLOCK_WRITE);
+		crofchan_env::rofchan_envs.insert(this);
+	};
 
 	/**
 	 * @brief	crofchan_env destructor
 	 */
 	virtual
-	~crofchan_env()
-	{ crofchan_env::rofchan_envs.erase(this); };
+	~crofchan_env() {
+		RwLock lock(crofchan_env::rofchan_envs_lock, RwLock::RWLOCK_WRITE);
+		crofchan_env::rofchan_envs.erase(this);
+	};
 
 protected:
 
@@ -120,6 +125,21 @@ protected:
 	virtual void
 	recv_message(crofchan& chan, const cauxid& aux_id, rofl::openflow::cofmsg *msg) = 0;
 
+	/**
+	 * @brief	Offers a received Packet-In message as zero-copy view.
+	 *
+	 * Note: This method is executed in the thread context of the underlying
+	 * socket instance. The view is valid during this call only.
+	 *
+	 * @param chan crofchan instance
+	 * @param auxid auxiliary connection
+	 * @param view non-owning view on the received message
+	 * @return true when the message has been consumed, false for receiving it via recv_message()
+	 */
+	virtual bool
+	recv_message_view(crofchan& chan, const cauxid& aux_id, rofl::openflow::cofmsg_view const& view)
+	{ return false; };
+
 	/**
 	 * @brief	Acquires an OpenFlow transaction ID for an asynchronous message.
 	 *
@@ -181,7 +201,18 @@ public:
 			pthread_t tid = 0) :
 				rofl::ciosrv(tid),
 				env(NULL),
-				ofp_version(rofl::openflow::OFP_VERSION_UNKNOWN)
+				ofp_version(rofl::openflow::OFP_VERSION_UNKNOWN),
+				rxlimits(crofconn::QUEUE_MAX, crofconn::crxlimit()),
+				rxbuckets(crofconn::QUEUE_MAX, ctokenbucket()),
+				rxcounters(crofconn::QUEUE_MAX, crofconn::crxcounters()),
+				rxsched_type(crofsched::SCHED_WRR),
+				txsched_type(crofsched::SCHED_WRR),
+				rxweights(crofconn::QUEUE_MAX, 0),
+				txweights(crofconn::QUEUE_MAX, 0),
+				rxqstats(crofconn::QUEUE_MAX, crofsched_stats()),
+				txqstats(crofconn::QUEUE_MAX, crofsched_stats()),
+				multipart_streaming(false),
+				queue_capacity(crofqueue::DEFAULT_CAPACITY)
 	{};
 
 	/**
@@ -194,7 +225,18 @@ public:
 				rofl::ciosrv(tid),
 				env(env),
 				versionbitmap(versionbitmap),
-				ofp_version(rofl::openflow::OFP_VERSION_UNKNOWN)
+				ofp_version(rofl::openflow::OFP_VERSION_UNKNOWN),
+				rxlimits(crofconn::QUEUE_MAX, crofconn::crxlimit()),
+				rxbuckets(crofconn::QUEUE_MAX, ctokenbucket()),
+				rxcounters(crofconn::QUEUE_MAX, crofconn::crxcounters()),
+				rxsched_type(crofsched::SCHED_WRR),
+				txsched_type(crofsched::SCHED_WRR),
+				rxweights(crofconn::QUEUE_MAX, 0),
+				txweights(crofconn::QUEUE_MAX, 0),
+				rxqstats(crofconn::QUEUE_MAX, crofsched_stats()),
+				txqstats(crofconn::QUEUE_MAX, crofsched_stats()),
+				multipart_streaming(false),
+				queue_capacity(crofqueue::DEFAULT_CAPACITY)
 	{};
 
 	/**
@@ -299,6 +341,130 @@ public:
 	has_conn(
 			const cauxid& aux_id) const;
 
+public:
+
+	/**
+	 * @brief	Sets admission control parameters applied to each connection.
+	 *
+	 * Applies to all existing and future connections of this channel.
+	 */
+	void
+	set_conn_rx_limit(
+			enum crofconn::outqueue_type_t queue_id,
+			const crofconn::crxlimit& limit);
+
+	/**
+	 * @brief	Sets a token bucket shared by all connections of this channel.
+	 *
+	 * @param rate messages per second, 0: unlimited
+	 * @param burst token bucket depth in messages
+	 */
+	void
+	set_rx_rate_limit(
+			enum crofconn::outqueue_type_t queue_id,
+			unsigned int rate,
+			unsigned int burst);
+
+	/**
+	 * @brief	Returns admission counters summed up over all connections including closed ones.
+	 */
+	crofconn::crxcounters
+	get_rx_counters(
+			enum crofconn::outqueue_type_t queue_id) const;
+
+	/**
+	 * @brief	Sets scheduler for receive queues of all existing and future connections of this channel.
+	 *
+	 * @throws eRofSchedInval for an unknown type
+	 */
+	void
+	set_rx_scheduler(
+			enum crofsched::crofsched_type_t type);
+
+	/**
+	 *
+	 */
+	enum crofsched::crofsched_type_t
+	get_rx_scheduler() const
+	{ return rxsched_type; };
+
+	/**
+	 * @brief	Sets scheduling weight of receive queue queue_id for all existing and future connections.
+	 */
+	void
+	set_rx_weight(
+			enum crofconn::outqueue_type_t queue_id,
+			unsigned int weight);
+
+	/**
+	 * @brief	Returns receive queue metrics merged over all connections including closed ones.
+	 */
+	crofsched_stats
+	get_rx_queue_stats(
+			enum crofconn::outqueue_type_t queue_id) const;
+
+	/**
+	 * @brief	Sets scheduler for transmit queues of all existing and future connections of this channel.
+	 *
+	 * @throws eRofSchedInval for an unknown type
+	 */
+	void
+	set_tx_scheduler(
+			enum crofsched::crofsched_type_t type);
+
+	/**
+	 *
+	 */
+	enum crofsched::crofsched_type_t
+	get_tx_scheduler() const
+	{ return txsched_type; };
+
+	/**
+	 * @brief	Sets scheduling weight of transmit queue queue_id for all existing and future connections.
+	 */
+	void
+	set_tx_weight(
+			enum crofconn::outqueue_type_t queue_id,
+			unsigned int weight);
+
+	/**
+	 * @brief	Returns transmit queue metrics merged over all connections including closed ones.
+	 */
+	crofsched_stats
+	get_tx_queue_stats(
+			enum crofconn::outqueue_type_t queue_id) const;
+
+	/**
+	 * @brief	Enables or disables streaming of multipart reply fragments on all existing and future connections.
+	 *
+	 * @see crofconn::set_multipart_streaming()
+	 */
+	void
+	set_multipart_streaming(
+			bool streaming);
+
+	/**
+	 *
+	 */
+	bool
+	get_multipart_streaming() const
+	{ return multipart_streaming; };
+
+	/**
+	 * @brief	Sets capacity of receive and transmit queues for connections created by this channel afterwards.
+	 */
+	void
+	set_conn_queue_capacity(
+			size_t capacity)
+	{ queue_capacity = capacity; };
+
+	/**
+	 *
+	 */
+	size_t
+	get_conn_queue_capacity() const
+	{ return queue_capacity; };
+
 private:
 
 	/**
@@ -427,6 +593,11 @@ private:
 		env->recv_message(*this, conn.get_aux_id(), msg);
 	};
 
+	virtual bool
+	recv_message_view(crofconn& conn, rofl::openflow::cofmsg_view const& view) {
+		return env->recv_message_view(*this, conn.get_aux_id(), view);
+	};
+
 	/**
 	 *
 	 */
@@ -497,11 +668,40 @@ private:
 	void
 	event_conn_failed();
 
+	/**
+	 * @brief	Applies admission control parameters and shared token buckets to a connection.
+	 */
+	void
+	apply_rx_limits(
+			crofconn& conn);
+
+	/**
+	 * @brief	Keeps admission counters of a connection about to be destroyed.
+	 */
+	void
+	save_rx_counters(
+			crofconn& conn);
+
+	/**
+	 * @brief	Applies scheduler types and weights set for this channel to a connection.
+	 */
+	void
+	apply_sched(
+			crofconn& conn);
+
+	/**
+	 * @brief	Keeps queue metrics of a connection about to be destroyed.
+	 */
+	void
+	save_queue_stats(
+			crofconn& conn);
+
 	/**
 	 *
 	 */
 	crofchan_env&
 	call_env() {
+		RwLock lock(crofchan_env::rofchan_envs_lock, RwLock::RWLOCK_READ);
 		if (crofchan_env::rofchan_envs.find(env) == crofchan_env::rofchan_envs.end()) {
 			throw eRofChanNotFound();
 		}
@@ -559,6 +759,25 @@ private:
 	std::bitset<32>						flags;
 	// event queue
 	std::deque<enum crofchan_event_t> 	events;
+	// admission control parameters applied to each connection
+	std::vector<crofconn::crxlimit>		rxlimits;
+	// token buckets shared by all connections
+	std::vector<ctokenbucket>			rxbuckets;
+	// admission counters of closed connections
+	std::vector<crofconn::crxcounters>	rxcounters;
+	// scheduler types applied to each connection
+	enum crofsched::crofsched_type_t	rxsched_type;
+	enum crofsched::crofsched_type_t	txsched_type;
+	// scheduling weights applied to each connection, 0: connection's default
+	std::vector<unsigned int>			rxweights;
+	std::vector<unsigned int>			txweights;
+	// queue metrics of closed connections
+	std::vector<crofsched_stats>		rxqstats;
+	std::vector<crofsched_stats>		txqstats;
+	// hand over multipart reply fragments without reassembly
+	bool								multipart_streaming;
+	// capacity of receive and transmit queues of new connections
+	size_t								queue_capacity;
 
 	// established connection ids
 	std::list<rofl::cauxid>				conns_established;
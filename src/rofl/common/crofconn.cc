@@ -10,13 +10,16 @@
 using namespace rofl;
 
 /*static*/std::set<crofconn_env*> crofconn_env::rofconn_envs;
+/*static*/PthreadRwLock crofconn_env::rofconn_envs_lock;
 
 crofconn::crofconn(
 		crofconn_env *env,
 		rofl::openflow::cofhello_elem_versionbitmap const& versionbitmap,
-		pthread_t tid) :
+		pthread_t tid,
+		size_t queue_capacity) :
 				rofl::ciosrv(tid),
 				env(env),
+				view_env(NULL),
 				dpid(0), // will be determined later via Features.request
 				auxiliary_id(0), // will be determined later via Features.request
 				rofsocktid(0),
@@ -25,6 +28,7 @@ crofconn::crofconn(
 				ofp_version(rofl::openflow::OFP_VERSION_UNKNOWN),
 				sar(8/*seconds*/, tid),
 				fragmentation_threshold(DEFAULT_FRAGMENTATION_THRESHOLD),
+				multipart_streaming(false),
 				max_backoff(ctimespec(16, 0)),
 				reconnect_start_timeout(ctimespec(0, CROFCONN_RECONNECT_START_TIMEOUT_IN_NSECS)),
 				reconnect_timespec(ctimespec(0, CROFCONN_RECONNECT_START_TIMEOUT_IN_NSECS)),
@@ -34,27 +38,34 @@ crofconn::crofconn(
 				socket_type(rofl::csocket::SOCKET_TYPE_UNKNOWN),
 				newsd(0),
 				state(STATE_INIT),
-				rxqueues(QUEUE_MAX, crofqueue()),
-				rxweights(QUEUE_MAX, 1),
+				rxqueues(QUEUE_MAX, crofqueue(queue_capacity)),
+				rxsched(crofsched::create(crofsched::SCHED_WRR, QUEUE_MAX)),
+				rxsched_pending(NULL),
+				rxlimits(QUEUE_MAX, crxlimit()),
+				rxbuckets(QUEUE_MAX, ctokenbucket()),
+				rxbuckets_shared(QUEUE_MAX, (ctokenbucket*)0),
+				rxcounters(QUEUE_MAX, crxcounters()),
+				rxstalled(0),
 				hello_timeout(DEFAULT_HELLO_TIMEOUT),
 				echo_timeout(DEFAULT_ECHO_TIMEOUT),
 				echo_interval(DEFAULT_ECHO_INTERVAL * (1 + crandom::draw_random_number()))
 {
-	// scheduler weights for transmission
-	rxweights[QUEUE_OAM ] = 4;
-	rxweights[QUEUE_MGMT] = 8;
-	rxweights[QUEUE_FLOW] = 4;
-	rxweights[QUEUE_PKT ] = 2;
+	// scheduler weights for reception
+	rxsched->set_weight(QUEUE_OAM , 4);
+	rxsched->set_weight(QUEUE_MGMT, 8);
+	rxsched->set_weight(QUEUE_FLOW, 4);
+	rxsched->set_weight(QUEUE_PKT , 2);
 	rofl::logging::debug << "[rofl-common][crofconn] "
 			<< "connection created, auxid: " << auxiliary_id.str() << std::endl;
 
-	rofsock = new crofsock(this, rofsocktid = rofl::cioloop::add_thread());
+	rofsock = new crofsock(this, rofsocktid = rofl::cioloop::add_thread(), queue_capacity);
 }
 
 
 
 crofconn::~crofconn()
 {
+	publish_view_env(false);
 	env = NULL;
 	rofl::logging::debug << "[rofl-common][crofconn] "
 			<< "connection destroyed, auxid: " << auxiliary_id.str() << std::endl;
@@ -66,6 +77,11 @@ crofconn::~crofconn()
 		delete rofsock; rofsock = NULL;
 	}
 	rofl::cioloop::drop_thread(rofsocktid);
+
+	clear_queues();
+
+	delete rxsched_pending;
+	delete rxsched;
 }
 
 
@@ -305,6 +321,7 @@ crofconn::event_tcp_connected()
 	case STATE_ACCEPT_PENDING:
 	case STATE_WAIT_FOR_HELLO:
 	case STATE_CONNECTED: {
+		publish_view_env(false);
 		state = STATE_WAIT_FOR_HELLO;
 		rofl::logging::debug << "[rofl-common][crofconn] entering state -wait-for-hello- " << std::endl;
 		reconnect_timespec = reconnect_start_timeout;
@@ -321,20 +338,49 @@ crofconn::event_tcp_connected()
 
 
 void
-crofconn::event_disconnected()
+crofconn::publish_view_env(
+		bool connected)
 {
-	while (not timer_ids.empty()) {
-		timer_stop(timer_ids.begin()->first);
+	crofconn_env* view_env = NULL;
+	if (connected && crofconn_env::has_env(env)) {
+		view_env = env;
 	}
+	__atomic_store_n(&(this->view_env), view_env, __ATOMIC_RELEASE);
+}
+
+
 
-	// remove all pending packets from rxqueues
+void
+crofconn::clear_queues()
+{
 	for (std::vector<crofqueue>::iterator
 			it = rxqueues.begin(); it != rxqueues.end(); ++it) {
 		(*it).clear();
 	}
+	while (not dlqueue.empty()) {
+		delete dlqueue.front();
+		dlqueue.pop_front();
+	}
+}
+
+
+
+void
+crofconn::event_disconnected()
+{
+	publish_view_env(false);
+
+	while (not timer_ids.empty()) {
+		timer_stop(timer_ids.begin()->first);
+	}
 
-	// purge delay queue
-	dlqueue.clear();
+	// remove all pending packets from rxqueues and delay queue
+	if (pthread_self() == get_thread_id()) {
+		clear_queues();
+	} else {
+		// rxqueues have a single consumer, i.e., this instance's thread
+		rofl::ciosrv::notify(rofl::cevent(EVENT_CLEAR_QUEUES));
+	}
 
 	switch (state) {
 	case STATE_DISCONNECTED: {
@@ -412,6 +458,7 @@ crofconn::event_hello_rcvd()
 		} else {
 			rofl::logging::debug << "[rofl-common][crofconn] entering state -established-" << std::endl;
 			state = STATE_CONNECTED;
+			publish_view_env(true);
 			if (crofconn_env::has_env(env)) {
 				crofconn_env::set_env(env).handle_connected(*this, ofp_version);
 			};
@@ -456,6 +503,7 @@ crofconn::event_features_rcvd()
 		if (flags.test(FLAGS_PASSIVE)) {
 			rofl::logging::debug << "[rofl-common][crofconn] entering state -connected-" << std::endl;
 			state = STATE_CONNECTED;
+			publish_view_env(true);
 			cancel_timer(timer_ids[TIMER_WAIT_FOR_FEATURES]);
 			timer_ids.erase(TIMER_WAIT_FOR_FEATURES);
 
@@ -466,9 +514,13 @@ crofconn::event_features_rcvd()
 
 		// send all postponed messages to higher layers
 		while (not dlqueue.empty()) {
+			rofl::openflow::cofmsg* msg = dlqueue.front();
+			dlqueue.pop_front();
 			if (crofconn_env::has_env(env)) {
-				crofconn_env::set_env(env).recv_message(*this, dlqueue.retrieve());
-			};
+				crofconn_env::set_env(env).recv_message(*this, msg);
+			} else {
+				delete msg;
+			}
 		}
 
 	} break;
@@ -582,7 +634,7 @@ crofconn::action_send_hello_message()
 		rofl::logging::debug << "[rofl-common][crofconn] sending HELLO message: "
 				<< hello->str() << versionbitmap.str() << std::endl;
 
-		if (rofsock) rofsock->send_message(hello);
+		if (rofsock) rofsock->send_control_message(hello);
 
 	} catch (eRofConnXidSpaceExhausted& e) {
 
@@ -609,7 +661,7 @@ crofconn::action_send_features_request()
 
 		rofl::logging::debug << "[rofl-common][crofconn] sending FEATURES.request: " << request->str() << std::endl;
 
-		if (rofsock) rofsock->send_message(request);
+		if (rofsock) rofsock->send_control_message(request);
 
 	} catch (eRofConnXidSpaceExhausted& e) {
 
@@ -635,7 +687,7 @@ crofconn::action_send_echo_request()
 
 		rofl::logging::debug << "[rofl-common][crofconn] sending Echo.request: " << echo->str() << std::endl;
 
-		if (rofsock) rofsock->send_message(echo);
+		if (rofsock) rofsock->send_control_message(echo);
 
 		timer_start_wait_for_echo();
 
@@ -657,19 +709,19 @@ crofconn::action_send_echo_request()
 
 
 
-void
-crofconn::recv_message(
-		crofsock& rofsock,
-		rofl::openflow::cofmsg *msg) {
-	rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] received message" << std::endl << *msg;
+/*static*/unsigned int
+crofconn::get_rx_queue_id(
+		uint8_t version,
+		uint8_t type)
+{
+	unsigned int queue_id = QUEUE_MGMT;
 
-	switch (msg->get_version()) {
+	switch (version) {
 	case rofl::openflow10::OFP_VERSION: {
-		switch (msg->get_type()) {
+		switch (type) {
 		case rofl::openflow10::OFPT_PACKET_IN:
 		case rofl::openflow10::OFPT_PACKET_OUT: {
-			rxqueues[QUEUE_PKT].store(msg);
-			rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] rxqueues[QUEUE_PKT]:" << std::endl << rxqueues[QUEUE_PKT];
+			queue_id = QUEUE_PKT;
 		} break;
 		case rofl::openflow10::OFPT_FLOW_MOD:
 		case rofl::openflow10::OFPT_FLOW_REMOVED:
@@ -677,27 +729,23 @@ crofconn::recv_message(
 		case rofl::openflow10::OFPT_STATS_REPLY:
 		case rofl::openflow10::OFPT_BARRIER_REQUEST:
 		case rofl::openflow10::OFPT_BARRIER_REPLY: {
-			rxqueues[QUEUE_FLOW].store(msg);
-			rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] rxqueues[QUEUE_FLOW]:" << std::endl << rxqueues[QUEUE_FLOW];
+			queue_id = QUEUE_FLOW;
 		} break;
 		case rofl::openflow10::OFPT_HELLO:
 		case rofl::openflow10::OFPT_ECHO_REQUEST:
 		case rofl::openflow10::OFPT_ECHO_REPLY: {
-			rxqueues[QUEUE_OAM].store(msg);
-			rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] rxqueues[QUEUE_OAM]:" << std::endl << rxqueues[QUEUE_OAM];
+			queue_id = QUEUE_OAM;
 		} break;
 		default: {
-			rxqueues[QUEUE_MGMT].store(msg);
-			rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] rxqueues[QUEUE_MGMT]:" << std::endl << rxqueues[QUEUE_MGMT];
+			queue_id = QUEUE_MGMT;
 		};
 		}
 	} break;
 	case rofl::openflow12::OFP_VERSION: {
-		switch (msg->get_type()) {
+		switch (type) {
 		case rofl::openflow12::OFPT_PACKET_IN:
 		case rofl::openflow12::OFPT_PACKET_OUT: {
-			rxqueues[QUEUE_PKT].store(msg);
-			rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] rxqueues[QUEUE_PKT]:" << std::endl << rxqueues[QUEUE_PKT];
+			queue_id = QUEUE_PKT;
 		} break;
 		case rofl::openflow12::OFPT_FLOW_MOD:
 		case rofl::openflow12::OFPT_FLOW_REMOVED:
@@ -708,27 +756,23 @@ crofconn::recv_message(
 		case rofl::openflow12::OFPT_STATS_REPLY:
 		case rofl::openflow12::OFPT_BARRIER_REQUEST:
 		case rofl::openflow12::OFPT_BARRIER_REPLY: {
-			rxqueues[QUEUE_FLOW].store(msg);
-			rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] rxqueues[QUEUE_FLOW]:" << std::endl << rxqueues[QUEUE_FLOW];
+			queue_id = QUEUE_FLOW;
 		} break;
 		case rofl::openflow12::OFPT_HELLO:
 		case rofl::openflow12::OFPT_ECHO_REQUEST:
 		case rofl::openflow12::OFPT_ECHO_REPLY: {
-			rxqueues[QUEUE_OAM].store(msg);
-			rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] rxqueues[QUEUE_OAM]:" << std::endl << rxqueues[QUEUE_OAM];
+			queue_id = QUEUE_OAM;
 		} break;
 		default: {
-			rxqueues[QUEUE_MGMT].store(msg);
-			rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] rxqueues[QUEUE_MGMT]:" << std::endl << rxqueues[QUEUE_MGMT];
+			queue_id = QUEUE_MGMT;
 		};
 		}
 	} break;
 	case rofl::openflow13::OFP_VERSION: {
-		switch (msg->get_type()) {
+		switch (type) {
 		case rofl::openflow13::OFPT_PACKET_IN:
 		case rofl::openflow13::OFPT_PACKET_OUT: {
-			rxqueues[QUEUE_PKT].store(msg);
-			rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] rxqueues[QUEUE_PKT]:" << std::endl << rxqueues[QUEUE_PKT];
+			queue_id = QUEUE_PKT;
 		} break;
 		case rofl::openflow13::OFPT_FLOW_MOD:
 		case rofl::openflow13::OFPT_FLOW_REMOVED:
@@ -739,22 +783,37 @@ crofconn::recv_message(
 		case rofl::openflow13::OFPT_MULTIPART_REPLY:
 		case rofl::openflow13::OFPT_BARRIER_REQUEST:
 		case rofl::openflow13::OFPT_BARRIER_REPLY: {
-			rxqueues[QUEUE_FLOW].store(msg);
-			rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] rxqueues[QUEUE_FLOW]:" << std::endl << rxqueues[QUEUE_FLOW];
+			queue_id = QUEUE_FLOW;
 		} break;
 		case rofl::openflow13::OFPT_HELLO:
 		case rofl::openflow13::OFPT_ECHO_REQUEST:
 		case rofl::openflow13::OFPT_ECHO_REPLY: {
-			rxqueues[QUEUE_OAM].store(msg);
-			rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] rxqueues[QUEUE_OAM]:" << std::endl << rxqueues[QUEUE_OAM];
+			queue_id = QUEUE_OAM;
 		} break;
 		default: {
-			rxqueues[QUEUE_MGMT].store(msg);
-			rofl::logging::debug2 << "[rofl-common][crofconn][recv_message] rxqueues[QUEUE_MGMT]:" << std::endl << rxqueues[QUEUE_MGMT];
+			queue_id = QUEUE_MGMT;
 		};
 		}
 	} break;
 	default: {
+		queue_id = QUEUE_MAX;
+	};
+	}
+
+	return queue_id;
+}
+
+
+
+void
+crofconn::recv_message(
+		crofsock& rofsock,
+		rofl::openflow::cofmsg *msg) {
+	ROFL_DEBUG2 << "[rofl-common][crofconn][recv_message] received message" << std::endl << *msg;
+
+	unsigned int queue_id = get_rx_queue_id(msg->get_version(), msg->get_type());
+
+	if (QUEUE_MAX == queue_id) {
 		rofl::logging::alert << "[rofl-common][rofsock] dropping message with unsupported OpenFlow version" << std::endl;
 		//throw eBadRequestBadVersion();
 		size_t len = (msg->framelen() > 64) ? 64 : msg->framelen();
@@ -764,17 +823,106 @@ crofconn::recv_message(
 					msg->get_xid(),
 					msg->soframe(),
 					len);
-		send_message(error);
+		rofsock.send_control_message(error);
 		delete msg; return;
-	};
 	}
 
-	rofl::logging::debug3 << "[rofl-common][crofconn][recv_message] -EVENT-RXQUEUE-" << std::endl;
+	// messages have been policed by recv_message_view() already
+	size_t max_size = __atomic_load_n(&(rxlimits[queue_id].max_size), __ATOMIC_RELAXED);
+	if ((0 != max_size) && (rxqueues[queue_id].size() >= max_size) &&
+			(RXDROP_NEWEST == __atomic_load_n(&(rxlimits[queue_id].policy), __ATOMIC_RELAXED))) {
+		ROFL_DEBUG2 << "[rofl-common][crofconn][recv_message] rxqueues[" << queue_id << "] limit reached, "
+				<< "dropping message, xid: 0x" << std::hex << msg->get_xid() << std::dec << std::endl;
+		__atomic_add_fetch(&(rxcounters[queue_id].overflow), 1, __ATOMIC_RELAXED);
+		delete msg; return;
+	}
+
+	// crofsock's thread is the only producer and recv_ready() has checked for a free slot
+	rxqueues[queue_id].store(msg);
+	__atomic_add_fetch(&(rxcounters[queue_id].admitted), 1, __ATOMIC_RELAXED);
+
+	ROFL_DEBUG3 << "[rofl-common][crofconn][recv_message] -EVENT-RXQUEUE-" << std::endl;
 	rofl::ciosrv::notify(rofl::cevent(EVENT_RXQUEUE));
 }
 
 
 
+bool
+crofconn::recv_ready(
+		crofsock& rofsock,
+		uint8_t version,
+		uint8_t type)
+{
+	unsigned int queue_id = get_rx_queue_id(version, type);
+	if (QUEUE_MAX == queue_id) {
+		return true;
+	}
+
+	crofqueue& rxqueue = rxqueues[queue_id];
+	if (rxqueue.size() < rxqueue.capacity()) {
+		return true;
+	}
+
+	// ask our own thread to resume reading, then check again to not miss a drain in between
+	__atomic_store_n(&rxstalled, 1, __ATOMIC_SEQ_CST);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (rxqueue.size() < rxqueue.capacity()) {
+		return true;
+	}
+
+	ROFL_DEBUG2 << "[rofl-common][crofconn][recv_ready] rxqueues[" << queue_id << "] full, "
+			<< "suspending reading from socket" << std::endl;
+	return false;
+}
+
+
+
+bool
+crofconn::recv_message_view(
+		crofsock& rofsock,
+		rofl::openflow::cofmsg_view const& view)
+{
+	/*
+	 * admission control for all messages on the raw header, policed
+	 * messages are dropped here without being parsed at all
+	 */
+	unsigned int queue_id = get_rx_queue_id(view.get_version(), view.get_type());
+	if ((queue_id < QUEUE_MAX) && not rx_admit(queue_id)) {
+		ROFL_DEBUG2 << "[rofl-common][crofconn][recv_message_view] rxqueues[" << queue_id << "] rate exceeded, "
+				<< "dropping message, xid: 0x" << std::hex << view.get_xid() << std::dec << std::endl;
+		__atomic_add_fetch(&(rxcounters[queue_id].policed), 1, __ATOMIC_RELAXED);
+		return true;
+	}
+
+	// state and env are owned by our own thread, rely on the env published while connected
+	crofconn_env* view_env = __atomic_load_n(&(this->view_env), __ATOMIC_ACQUIRE);
+	if (NULL == view_env) {
+		return false;
+	}
+
+	if (not view.is_packet_in()) {
+		return false;
+	}
+
+	// do not overtake Packet-In messages still waiting in the receive queue
+	if (not rxqueues[QUEUE_PKT].empty()) {
+		return false;
+	}
+
+	if (not view_env->recv_message_view(*this, view)) {
+		return false;
+	}
+
+	__atomic_add_fetch(&(rxcounters[queue_id].admitted), 1, __ATOMIC_RELAXED);
+
+	// we are running in crofsock's thread here, let our own thread reset the life check timer
+	rofl::ciosrv::notify(rofl::cevent(EVENT_LIFE_SIGNAL));
+
+	return true;
+}
+
+
+
 void
 crofconn::send_message_to_env(
 		rofl::openflow::cofmsg* msg)
@@ -789,6 +937,116 @@ crofconn::send_message_to_env(
 
 
 
+void
+crofconn::rx_trim(
+		unsigned int queue_id)
+{
+	if (RXDROP_OLDEST != __atomic_load_n(&(rxlimits[queue_id].policy), __ATOMIC_RELAXED)) {
+		return;
+	}
+	size_t max_size = __atomic_load_n(&(rxlimits[queue_id].max_size), __ATOMIC_RELAXED);
+	if (0 == max_size) {
+		return;
+	}
+	while (rxqueues[queue_id].size() > max_size) {
+		rofl::openflow::cofmsg* msg = rxqueues[queue_id].retrieve();
+		if (NULL == msg) {
+			break;
+		}
+		ROFL_DEBUG2 << "[rofl-common][crofconn][rx_trim] rxqueues[" << queue_id << "] limit exceeded, "
+				<< "dropping message, xid: 0x" << std::hex << msg->get_xid() << std::dec << std::endl;
+		__atomic_add_fetch(&(rxcounters[queue_id].overflow), 1, __ATOMIC_RELAXED);
+		delete msg;
+	}
+}
+
+
+
+void
+crofconn::set_rx_limit(
+		enum outqueue_type_t queue_id,
+		const crxlimit& limit)
+{
+	if (queue_id >= QUEUE_MAX) {
+		throw eInval("crofconn::set_rx_limit() invalid queue_id");
+	}
+	size_t max_size = (limit.max_size > rxqueues[queue_id].capacity()) ?
+			rxqueues[queue_id].capacity() : limit.max_size;
+	rxbuckets[queue_id].set_rate(limit.rate, limit.burst);
+	__atomic_store_n(&(rxlimits[queue_id].rate), limit.rate, __ATOMIC_RELAXED);
+	__atomic_store_n(&(rxlimits[queue_id].burst), rxbuckets[queue_id].get_burst(), __ATOMIC_RELAXED);
+	__atomic_store_n(&(rxlimits[queue_id].max_size), max_size, __ATOMIC_RELAXED);
+	__atomic_store_n(&(rxlimits[queue_id].policy), limit.policy, __ATOMIC_RELAXED);
+}
+
+
+
+crofconn::crxlimit
+crofconn::get_rx_limit(
+		enum outqueue_type_t queue_id) const
+{
+	if (queue_id >= QUEUE_MAX) {
+		throw eInval("crofconn::get_rx_limit() invalid queue_id");
+	}
+	return crxlimit(
+			__atomic_load_n(&(rxlimits[queue_id].rate), __ATOMIC_RELAXED),
+			__atomic_load_n(&(rxlimits[queue_id].burst), __ATOMIC_RELAXED),
+			__atomic_load_n(&(rxlimits[queue_id].max_size), __ATOMIC_RELAXED),
+			__atomic_load_n(&(rxlimits[queue_id].policy), __ATOMIC_RELAXED));
+}
+
+
+
+void
+crofconn::set_rx_shared_bucket(
+		enum outqueue_type_t queue_id,
+		ctokenbucket* bucket)
+{
+	if (queue_id >= QUEUE_MAX) {
+		throw eInval("crofconn::set_rx_shared_bucket() invalid queue_id");
+	}
+	__atomic_store_n(&rxbuckets_shared[queue_id], bucket, __ATOMIC_RELEASE);
+}
+
+
+
+crofconn::crxcounters
+crofconn::get_rx_counters(
+		enum outqueue_type_t queue_id) const
+{
+	if (queue_id >= QUEUE_MAX) {
+		throw eInval("crofconn::get_rx_counters() invalid queue_id");
+	}
+	crxcounters counters;
+	counters.admitted = __atomic_load_n(&(rxcounters[queue_id].admitted), __ATOMIC_RELAXED);
+	counters.policed = __atomic_load_n(&(rxcounters[queue_id].policed), __ATOMIC_RELAXED);
+	counters.overflow = __atomic_load_n(&(rxcounters[queue_id].overflow), __ATOMIC_RELAXED);
+	return counters;
+}
+
+
+
+void
+crofconn::set_rx_scheduler(
+		enum crofsched::crofsched_type_t type)
+{
+	crofsched* sched = crofsched::create(type, QUEUE_MAX); // may throw
+	RwLock rwlock(rxsched_lock, RwLock::RWLOCK_WRITE);
+	delete rxsched_pending;
+	rxsched_pending = sched;
+}
+
+
+
+enum crofsched::crofsched_type_t
+crofconn::get_rx_scheduler() const
+{
+	RwLock rwlock(rxsched_lock, RwLock::RWLOCK_READ);
+	return (NULL != rxsched_pending) ? rxsched_pending->get_type() : rxsched->get_type();
+}
+
+
+
 void
 crofconn::handle_messages()
 {
@@ -796,118 +1054,153 @@ crofconn::handle_messages()
 
 	flags.set(FLAGS_RXQUEUE_CONSUMING);
 
+	if (NULL != __atomic_load_n(&rxsched_pending, __ATOMIC_ACQUIRE)) {
+		RwLock rwlock(rxsched_lock, RwLock::RWLOCK_WRITE);
+		rxsched_pending->assign(*rxsched);
+		delete rxsched;
+		rxsched = rxsched_pending;
+		rxsched_pending = NULL;
+	}
+
+	size_t backlog[QUEUE_MAX];
+
 	for (unsigned int queue_id = 0; queue_id < QUEUE_MAX; ++queue_id) {
 
-		if (rxqueues[queue_id].empty()) {
-			continue; // no messages at all in this queue
+		rx_trim(queue_id);
+
+		rofl::openflow::cofmsg* msg = rxqueues[queue_id].front();
+		backlog[queue_id] = (NULL == msg) ? 0 : msg->framelen();
+	}
+
+	uint64_t now = crofqueue::now();
+
+	// one scheduling round, i.e., up to the sum of all weights messages
+	for (unsigned int num = rxsched->get_weights_sum(); num > 0; --num) {
+
+		int queue_id = rxsched->select(backlog);
+		if (queue_id < 0) {
+			break; // no further messages in any queue
 		}
 
-		rofl::logging::debug2 << "[rofl-common][crofconn][handle_messages] "
-				<< "rxqueue[" << queue_id << "]:" << std::endl << rxqueues[queue_id];
+		rofl::openflow::cofmsg* msg = (rofl::openflow::cofmsg*)0;
 
-		for (unsigned int num = 0; num < rxweights[queue_id]; ++num) {
+		crofqueue& rxqueue = rxqueues[queue_id];
+		uint64_t stamp = rxqueue.front_stamp();
+		size_t depth = rxqueue.size();
 
-			rofl::openflow::cofmsg* msg = (rofl::openflow::cofmsg*)0;
+		if ((msg = rxqueue.retrieve()) == NULL) {
+			backlog[queue_id] = 0;
+			continue; // no further messages in this queue
+		}
 
-			if ((msg = rxqueues[queue_id].retrieve()) == NULL) {
-				continue; // no further messages in this queue
-			}
+		rxsched->account(queue_id, backlog[queue_id], (now > stamp) ? now - stamp : 0, depth);
 
-			rofl::logging::debug2 << "[rofl-common][crofconn][handle_messages] "
-					<< "reading message from rxqueue:" << std::endl << *msg;
+		rofl::openflow::cofmsg* next = rxqueue.front();
+		backlog[queue_id] = (NULL == next) ? 0 : next->framelen();
 
-			if (rofl::openflow::OFP_VERSION_UNKNOWN == msg->get_version()) {
-				rofl::logging::error << "[rofl-common][crofconn][handle_messages] "
-						<< "received message with unknown version, dropping." << std::endl;
+		ROFL_DEBUG2 << "[rofl-common][crofconn][handle_messages] "
+				<< "reading message from rxqueue:" << std::endl << *msg;
 
-				send_message(new rofl::openflow::cofmsg_error_bad_request_bad_version(
-						get_version(), msg->get_xid(), msg->soframe(), msg->framelen()));
+		if (rofl::openflow::OFP_VERSION_UNKNOWN == msg->get_version()) {
+			rofl::logging::error << "[rofl-common][crofconn][handle_messages] "
+					<< "received message with unknown version, dropping." << std::endl;
 
-				delete msg; continue;
-			}
+			if (rofsock) rofsock->send_control_message(new rofl::openflow::cofmsg_error_bad_request_bad_version(
+					get_version(), msg->get_xid(), msg->soframe(), msg->framelen()));
 
-			// reset timer for transmitting next Echo.request, if we have seen a life signal from our peer
-			timer_start_life_check();
+			delete msg; continue;
+		}
 
-			switch (msg->get_type()) {
-			case OFPT_HELLO: {
-				hello_rcvd(msg);
-			} break;
-			case OFPT_ERROR: {
-				error_rcvd(msg);
-			} break;
-			case OFPT_ECHO_REQUEST: {
-				echo_request_rcvd(msg);
-			} break;
-			case OFPT_ECHO_REPLY: {
-				echo_reply_rcvd(msg);
-			} break;
-			case OFPT_FEATURES_REPLY: {
-				features_reply_rcvd(msg);
-			} break;
-			case OFPT_MULTIPART_REQUEST:
-			case OFPT_MULTIPART_REPLY: {
-				/*
-				 * add multipart support here for receiving messages
-				 */
-				switch (msg->get_version()) {
-				case rofl::openflow13::OFP_VERSION: {
-					rofl::openflow::cofmsg_stats *stats = dynamic_cast<rofl::openflow::cofmsg_stats*>( msg );
-
-					if (NULL == stats) {
-						rofl::logging::warn << "[rofl-common][crofconn] dropping multipart message, invalid message type." << str() << std::endl;
-						delete msg; continue;
-					}
+		// reset timer for transmitting next Echo.request, if we have seen a life signal from our peer
+		timer_start_life_check();
 
-					// start new or continue pending transaction
-					if (stats->get_stats_flags() & rofl::openflow13::OFPMPF_REQ_MORE) {
+		switch (msg->get_type()) {
+		case OFPT_HELLO: {
+			hello_rcvd(msg);
+		} break;
+		case OFPT_ERROR: {
+			error_rcvd(msg);
+		} break;
+		case OFPT_ECHO_REQUEST: {
+			echo_request_rcvd(msg);
+		} break;
+		case OFPT_ECHO_REPLY: {
+			echo_reply_rcvd(msg);
+		} break;
+		case OFPT_FEATURES_REPLY: {
+			features_reply_rcvd(msg);
+		} break;
+		case OFPT_MULTIPART_REQUEST:
+		case OFPT_MULTIPART_REPLY: {
+			/*
+			 * add multipart support here for receiving messages
+			 */
+			switch (msg->get_version()) {
+			case rofl::openflow13::OFP_VERSION: {
+				rofl::openflow::cofmsg_stats *stats = dynamic_cast<rofl::openflow::cofmsg_stats*>( msg );
+
+				if (NULL == stats) {
+					rofl::logging::warn << "[rofl-common][crofconn] dropping multipart message, invalid message type." << str() << std::endl;
+					delete msg; continue;
+				}
 
-						sar.set_transaction(msg->get_xid()).store_and_merge_msg(dynamic_cast<rofl::openflow::cofmsg_stats const&>(*msg));
-						delete msg; // delete msg here, we store a copy in the transaction
+				// streaming mode: no reassembly of reply fragments
+				if ((rofl::openflow13::OFPT_MULTIPART_REPLY == msg->get_type()) && get_multipart_streaming()) {
+					send_message_to_env(msg);
+					continue;
+				}
 
-					// end pending transaction or multipart message with single message only
-					} else {
+				// start new or continue pending transaction
+				if (stats->get_stats_flags() & rofl::openflow13::OFPMPF_REQ_MORE) {
 
-						if (sar.has_transaction(msg->get_xid())) {
+					sar.set_transaction(msg->get_xid()).store_and_merge_msg(dynamic_cast<rofl::openflow::cofmsg_stats const&>(*msg));
+					delete msg; // delete msg here, we store a copy in the transaction
 
-							sar.set_transaction(msg->get_xid()).store_and_merge_msg(dynamic_cast<rofl::openflow::cofmsg_stats const&>(*msg));
+				// end pending transaction or multipart message with single message only
+				} else {
 
-							rofl::openflow::cofmsg* reassembled_msg = sar.set_transaction(msg->get_xid()).retrieve_and_detach_msg();
+					if (sar.has_transaction(msg->get_xid())) {
 
-							sar.drop_transaction(msg->get_xid());
+						sar.set_transaction(msg->get_xid()).store_and_merge_msg(dynamic_cast<rofl::openflow::cofmsg_stats const&>(*msg));
 
-							delete msg; // delete msg here, we may get an exception from the next line
+						rofl::openflow::cofmsg* reassembled_msg = sar.set_transaction(msg->get_xid()).retrieve_and_detach_msg();
 
-							send_message_to_env(reassembled_msg);
-						} else {
-							// do not delete msg here, will be done by higher layers
-							send_message_to_env(msg);
-						}
+						sar.drop_transaction(msg->get_xid());
+
+						delete msg; // delete msg here, we may get an exception from the next line
+
+						send_message_to_env(reassembled_msg);
+					} else {
+						// do not delete msg here, will be done by higher layers
+						send_message_to_env(msg);
 					}
-				} break;
-				default: {
-					// no segmentation and reassembly below OF13, so send message directly to our environment
-					send_message_to_env(msg);
-				};
 				}
 			} break;
 			default: {
-				switch (state) {
-				case STATE_CONNECTED: {
-					send_message_to_env(msg);
-				} break;
-				default: {
-					rofl::logging::warn << "[rofl-common][crofconn][handle_messages] "
-							<< "delaying message, connection not fully established."
-							<< str() << std::endl;
-
-					dlqueue.store(msg); continue;
-				};
-				}
+				// no segmentation and reassembly below OF13, so send message directly to our environment
+				send_message_to_env(msg);
+			};
+			}
+		} break;
+		default: {
+			switch (state) {
+			case STATE_CONNECTED: {
+				send_message_to_env(msg);
 			} break;
+			default: {
+				rofl::logging::warn << "[rofl-common][crofconn][handle_messages] "
+						<< "delaying message, connection not fully established."
+						<< str() << std::endl;
+
+				dlqueue.push_back(msg);
+				continue;
+			};
 			}
+		} break;
 		}
+	}
 
+	for (unsigned int queue_id = 0; queue_id < QUEUE_MAX; ++queue_id) {
 		if (not rxqueues[queue_id].empty()) {
 			reschedule = true;
 		}
@@ -915,8 +1208,13 @@ crofconn::handle_messages()
 
 	flags.reset(FLAGS_RXQUEUE_CONSUMING);
 
+	// slots have been freed, let crofsock continue reading if it has been stalled on a full rxqueue
+	if (__atomic_exchange_n(&rxstalled, 0, __ATOMIC_SEQ_CST) && rofsock) {
+		rofsock->resume_reading();
+	}
+
 	if (reschedule) {
-		rofl::logging::debug3 << "[rofl-common][crofconn][handle_messages] "
+		ROFL_DEBUG3 << "[rofl-common][crofconn][handle_messages] "
 				<< "rescheduling -EVENT-RXQUEUE-" << std::endl;
 		rofl::ciosrv::notify(rofl::cevent(EVENT_RXQUEUE));
 	}
@@ -999,7 +1297,7 @@ crofconn::hello_rcvd(
 	} catch (eHelloIncompatible& e) {
 
 		rofl::logging::warn << "[rofl-common][crofconn] eHelloIncompatible " << *msg << std::endl;
-		if (rofsock) rofsock->send_message(
+		if (rofsock) rofsock->send_control_message(
 				new rofl::openflow::cofmsg_error_hello_failed_incompatible(
 						hello->get_version(), hello->get_xid(), hello->soframe(), hello->framelen()));
 
@@ -1008,7 +1306,7 @@ crofconn::hello_rcvd(
 	} catch (eHelloEperm& e) {
 
 		rofl::logging::warn << "[rofl-common][crofconn] eHelloEperm " << *msg << std::endl;
-		if (rofsock) rofsock->send_message(
+		if (rofsock) rofsock->send_control_message(
 				new rofl::openflow::cofmsg_error_hello_failed_eperm(
 						hello->get_version(), hello->get_xid(), hello->soframe(), hello->framelen()));
 
@@ -1040,7 +1338,7 @@ crofconn::echo_request_rcvd(
 
 		if (request->get_version() != get_version()) {
 
-			if (rofsock) rofsock->send_message(new rofl::openflow::cofmsg_error_bad_request_bad_version(
+			if (rofsock) rofsock->send_control_message(new rofl::openflow::cofmsg_error_bad_request_bad_version(
 					get_version(), request->get_xid(), request->soframe(), request->framelen()));
 			delete msg; return;
 		}
@@ -1051,7 +1349,7 @@ crofconn::echo_request_rcvd(
 
 		delete msg;
 
-		if (rofsock) rofsock->send_message(reply);
+		if (rofsock) rofsock->send_control_message(reply);
 
 	} catch (RoflException& e) {
 
@@ -1185,7 +1483,9 @@ crofconn::fragment_and_send_message(
 {
 	unsigned int cwnd_size = 0;
 
-	if (msg->length() <= fragmentation_threshold) {
+	// a Packet-Out batch consists of complete messages and is never fragmented
+	if ((msg->length() <= fragmentation_threshold) ||
+			(NULL != dynamic_cast<rofl::openflow::cofmsg_packet_out_batch*>( msg ))) {
 		cwnd_size = rofsock->send_message(msg); // default behaviour for now: send message directly to rofsock
 
 	} else {
@@ -1288,6 +1588,49 @@ crofconn::fragment_and_send_message(
 
 
 
+template<class T>
+unsigned int
+crofconn::send_fragments(
+		std::vector<T*>& fragments)
+{
+	unsigned int cwnd_size = 0;
+
+	typename std::vector<T*>::iterator it = fragments.begin();
+
+	try {
+		if (fragments.empty()) {
+			return cwnd_size;
+		}
+
+		if (NULL == rofsock) {
+			throw eRofSockTxQueueFull();
+		}
+
+		// the peer cannot make sense of a partially sent multipart message, so check for space upfront
+		if (rofsock->get_txqueue_space(fragments.front()->get_version(), fragments.front()->get_type()) < fragments.size()) {
+			throw eRofSockTxQueueFull();
+		}
+
+		for (; it != fragments.end(); ++it) {
+			cwnd_size = rofsock->send_message(*it);
+		}
+
+	} catch (eRofSockTxQueueFull& e) {
+		// space claimed by another thread in the meantime or none at all, drop remaining fragments
+		for (; it != fragments.end(); ++it) {
+			delete *it;
+		}
+		fragments.clear();
+		throw;
+	}
+
+	fragments.clear();
+
+	return cwnd_size;
+}
+
+
+
 unsigned int
 crofconn::fragment_table_features_stats_request(
 		rofl::openflow::cofmsg_table_features_stats_request *msg)
@@ -1319,14 +1662,7 @@ crofconn::fragment_table_features_stats_request(
 		fragments.back()->set_stats_flags(fragments.back()->get_stats_flags() & ~rofl::openflow13::OFPMPF_REQ_MORE);
 	}
 
-	unsigned int cwnd_size = 0;
-
-	for (std::vector<rofl::openflow::cofmsg_table_features_stats_request*>::iterator
-			it = fragments.begin(); it != fragments.end(); ++it) {
-		 if (rofsock) {
-			 cwnd_size = rofsock->send_message(*it);
-		 }
-	}
+	unsigned int cwnd_size = send_fragments(fragments); // msg is not consumed on exception
 
 	delete msg;
 
@@ -1366,14 +1702,7 @@ crofconn::fragment_flow_stats_reply(
 		fragments.back()->set_stats_flags(fragments.back()->get_stats_flags() & ~rofl::openflow13::OFPMPF_REPLY_MORE);
 	}
 
-	unsigned int cwnd_size = 0;
-
-	for (std::vector<rofl::openflow::cofmsg_flow_stats_reply*>::iterator
-			it = fragments.begin(); it != fragments.end(); ++it) {
-		 if (rofsock) {
-			 cwnd_size = rofsock->send_message(*it);
-		 }
-	}
+	unsigned int cwnd_size = send_fragments(fragments); // msg is not consumed on exception
 
 	delete msg;
 
@@ -1413,14 +1742,7 @@ crofconn::fragment_table_stats_reply(
 		fragments.back()->set_stats_flags(fragments.back()->get_stats_flags() & ~rofl::openflow13::OFPMPF_REPLY_MORE);
 	}
 
-	unsigned int cwnd_size = 0;
-
-	for (std::vector<rofl::openflow::cofmsg_table_stats_reply*>::iterator
-			it = fragments.begin(); it != fragments.end(); ++it) {
-		 if (rofsock) {
-			 cwnd_size = rofsock->send_message(*it);
-		 }
-	}
+	unsigned int cwnd_size = send_fragments(fragments); // msg is not consumed on exception
 
 	delete msg;
 
@@ -1460,14 +1782,7 @@ crofconn::fragment_port_stats_reply(
 		fragments.back()->set_stats_flags(fragments.back()->get_stats_flags() & ~rofl::openflow13::OFPMPF_REPLY_MORE);
 	}
 
-	unsigned int cwnd_size = 0;
-
-	for (std::vector<rofl::openflow::cofmsg_port_stats_reply*>::iterator
-			it = fragments.begin(); it != fragments.end(); ++it) {
-		 if (rofsock) {
-			 cwnd_size = rofsock->send_message(*it);
-		 }
-	}
+	unsigned int cwnd_size = send_fragments(fragments); // msg is not consumed on exception
 
 	delete msg;
 
@@ -1510,14 +1825,7 @@ crofconn::fragment_queue_stats_reply(
 		fragments.back()->set_stats_flags(fragments.back()->get_stats_flags() & ~rofl::openflow13::OFPMPF_REPLY_MORE);
 	}
 
-	unsigned int cwnd_size = 0;
-
-	for (std::vector<rofl::openflow::cofmsg_queue_stats_reply*>::iterator
-			it = fragments.begin(); it != fragments.end(); ++it) {
-		 if (rofsock) {
-			 cwnd_size = rofsock->send_message(*it);
-		 }
-	}
+	unsigned int cwnd_size = send_fragments(fragments); // msg is not consumed on exception
 
 	delete msg;
 
@@ -1557,14 +1865,7 @@ crofconn::fragment_group_stats_reply(
 		fragments.back()->set_stats_flags(fragments.back()->get_stats_flags() & ~rofl::openflow13::OFPMPF_REPLY_MORE);
 	}
 
-	unsigned int cwnd_size = 0;
-
-	for (std::vector<rofl::openflow::cofmsg_group_stats_reply*>::iterator
-			it = fragments.begin(); it != fragments.end(); ++it) {
-		 if (rofsock) {
-			 cwnd_size = rofsock->send_message(*it);
-		 }
-	}
+	unsigned int cwnd_size = send_fragments(fragments); // msg is not consumed on exception
 
 	delete msg;
 
@@ -1604,14 +1905,7 @@ crofconn::fragment_group_desc_stats_reply(
 		fragments.back()->set_stats_flags(fragments.back()->get_stats_flags() & ~rofl::openflow13::OFPMPF_REPLY_MORE);
 	}
 
-	unsigned int cwnd_size = 0;
-
-	for (std::vector<rofl::openflow::cofmsg_group_desc_stats_reply*>::iterator
-			it = fragments.begin(); it != fragments.end(); ++it) {
-		 if (rofsock) {
-			 cwnd_size = rofsock->send_message(*it);
-		 }
-	}
+	unsigned int cwnd_size = send_fragments(fragments); // msg is not consumed on exception
 
 	delete msg;
 
@@ -1651,14 +1945,7 @@ crofconn::fragment_table_features_stats_reply(
 		fragments.back()->set_stats_flags(fragments.back()->get_stats_flags() & ~rofl::openflow13::OFPMPF_REPLY_MORE);
 	}
 
-	unsigned int cwnd_size = 0;
-
-	for (std::vector<rofl::openflow::cofmsg_table_features_stats_reply*>::iterator
-			it = fragments.begin(); it != fragments.end(); ++it) {
-		 if (rofsock) {
-			 cwnd_size = rofsock->send_message(*it);
-		 }
-	}
+	unsigned int cwnd_size = send_fragments(fragments); // msg is not consumed on exception
 
 	delete msg;
 
@@ -1698,14 +1985,7 @@ crofconn::fragment_port_desc_stats_reply(
 		fragments.back()->set_stats_flags(fragments.back()->get_stats_flags() & ~rofl::openflow13::OFPMPF_REPLY_MORE);
 	}
 
-	unsigned int cwnd_size = 0;
-
-	for (std::vector<rofl::openflow::cofmsg_port_desc_stats_reply*>::iterator
-			it = fragments.begin(); it != fragments.end(); ++it) {
-		 if (rofsock) {
-			 cwnd_size = rofsock->send_message(*it);
-		 }
-	}
+	unsigned int cwnd_size = send_fragments(fragments); // msg is not consumed on exception
 
 	delete msg;
 
@@ -1747,14 +2027,7 @@ crofconn::fragment_meter_stats_reply(
 		fragments.back()->set_stats_flags(fragments.back()->get_stats_flags() & ~rofl::openflow13::OFPMPF_REPLY_MORE);
 	}
 
-	unsigned int cwnd_size = 0;
-
-	for (std::vector<rofl::openflow::cofmsg_meter_stats_reply*>::iterator
-			it = fragments.begin(); it != fragments.end(); ++it) {
-		 if (rofsock) {
-			 cwnd_size = rofsock->send_message(*it);
-		 }
-	}
+	unsigned int cwnd_size = send_fragments(fragments); // msg is not consumed on exception
 
 	delete msg;
 
@@ -1796,14 +2069,7 @@ crofconn::fragment_meter_config_stats_reply(
 		fragments.back()->set_stats_flags(fragments.back()->get_stats_flags() & ~rofl::openflow13::OFPMPF_REPLY_MORE);
 	}
 
-	unsigned int cwnd_size = 0;
-
-	for (std::vector<rofl::openflow::cofmsg_meter_config_stats_reply*>::iterator
-			it = fragments.begin(); it != fragments.end(); ++it) {
-		 if (rofsock) {
-			 cwnd_size = rofsock->send_message(*it);
-		 }
-	}
+	unsigned int cwnd_size = send_fragments(fragments); // msg is not consumed on exception
 
 	delete msg;
 
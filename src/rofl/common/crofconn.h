@@ -11,6 +11,7 @@
 #include <inttypes.h>
 #include <bitset>
 #include <set>
+#include <deque>
 
 #include "rofl/common/ciosrv.h"
 #include "rofl/common/crofsock.h"
@@ -21,6 +22,7 @@
 #include "rofl/common/ctimerid.h"
 #include "rofl/common/cauxid.h"
 #include "rofl/common/crofqueue.h"
+#include "rofl/common/ctokenbucket.h"
 
 namespace rofl {
 
@@ -38,6 +40,7 @@ class crofconn; // forward declaration
  */
 class crofconn_env {
 	static std::set<crofconn_env*> rofconn_envs;
+	static PthreadRwLock rofconn_envs_lock;
 public:
 
 	/**
@@ -45,6 +48,7 @@ public:
 	 */
 	static crofconn_env&
 	set_env(crofconn_env* env) {
+		RwLock lock(crofconn_env::rofconn_envs_lock, RwLock::RWLOCK_READ);
 		if (crofconn_env::rofconn_envs.find(env) == crofconn_env::rofconn_envs.end()) {
 			throw eRofConnNotFound();
 		}
@@ -56,6 +60,7 @@ public:
 	 */
 	static bool
 	has_env(crofconn_env* env) {
+		RwLock lock(crofconn_env::rofconn_envs_lock, RwLock::RWLOCK_READ);
 		return (not (crofconn_env::rofconn_envs.find(env) == crofconn_env::rofconn_envs.end()));
 	};
 
@@ -65,6 +70,7 @@ public:
 	 *
 	 */
 	crofconn_env() {
+		RwLock lock(crofconn_env::rofconn_envs_lock, RwLock::RWLOCK_WRITE);
 		crofconn_env::rofconn_envs.insert(this);
 	};
 
@@ -72,6 +78,7 @@ public:
 	 *
 	 */
 	virtual ~crofconn_env() {
+		RwLock lock(crofconn_env::rofconn_envs_lock, RwLock::RWLOCK_WRITE);
 		crofconn_env::rofconn_envs.erase(this);
 	};
 
@@ -115,6 +122,17 @@ protected:
 	virtual void
 	recv_message(crofconn& conn, rofl::openflow::cofmsg *msg) = 0;
 
+	/**
+	 * @brief	Offers a received Packet-In message as zero-copy view.
+	 *
+	 * Called in the thread context of the underlying rofl::crofsock instance
+	 * for established connections only. Return true when the message has
+	 * been consumed, false for receiving it via recv_message() as usual.
+	 */
+	virtual bool
+	recv_message_view(crofconn& conn, rofl::openflow::cofmsg_view const& view)
+	{ return false; };
+
 	/**
 	 *
 	 */
@@ -145,6 +163,8 @@ class crofconn :
 		public crofsock_env,
 		public ciosrv
 {
+public:
+
 	enum outqueue_type_t {
 		QUEUE_OAM  = 0, // Echo.request/Echo.reply
 		QUEUE_MGMT = 1, // all remaining packets, except ...
@@ -153,6 +173,50 @@ class crofconn :
 		QUEUE_MAX,		// do not use
 	};
 
+	enum crofconn_rxdrop_policy_t {
+		RXDROP_NEWEST			= 0,	// drop arriving message when queue limit is reached
+		RXDROP_OLDEST			= 1,	// drop oldest queued messages exceeding queue limit
+	};
+
+	/**
+	 * @brief	Admission control parameters for a receive queue
+	 */
+	struct crxlimit {
+		unsigned int	rate;		// messages per second, 0: unlimited
+		unsigned int	burst;		// token bucket depth in messages
+		size_t			max_size;	// max. number of queued messages, 0: queue capacity
+		enum crofconn_rxdrop_policy_t
+						policy;
+		crxlimit(
+				unsigned int rate = 0,
+				unsigned int burst = 1,
+				size_t max_size = 0,
+				enum crofconn_rxdrop_policy_t policy = RXDROP_NEWEST) :
+					rate(rate), burst(burst), max_size(max_size), policy(policy)
+		{};
+	};
+
+	/**
+	 * @brief	Admission counters for a receive queue
+	 */
+	struct crxcounters {
+		uint64_t		admitted;	// passed the token buckets and queued or consumed as view
+		uint64_t		policed;	// dropped by a token bucket
+		uint64_t		overflow;	// dropped due to queue limit or capacity
+		crxcounters() :
+			admitted(0), policed(0), overflow(0)
+		{};
+		crxcounters&
+		operator+= (const crxcounters& counters) {
+			admitted += counters.admitted;
+			policed += counters.policed;
+			overflow += counters.overflow;
+			return *this;
+		};
+	};
+
+private:
+
 	enum msg_type_t {
 		OFPT_HELLO = 0,
 		OFPT_ERROR = 1,
@@ -182,6 +246,8 @@ class crofconn :
 		EVENT_LOCAL_DISCONNECT	= 15,
 		EVENT_CONGESTION_SOLVED	= 16,
 		EVENT_PEER_DISCONNECTED	= 17,	// socket was closed by peer entity
+		EVENT_LIFE_SIGNAL		= 18,	// message consumed in crofsock's thread context
+		EVENT_CLEAR_QUEUES		= 19,	// drop pending messages in consumer thread context
 	};
 
 	enum crofconn_state_t {
@@ -225,11 +291,14 @@ public:
 
 	/**
 	 * controller mode
+	 *
+	 * @param queue_capacity max. number of messages per receive and transmit queue
 	 */
 	crofconn(
 			crofconn_env *env,
 			const rofl::openflow::cofhello_elem_versionbitmap& versionbitmap,
-			pthread_t tid = 0);
+			pthread_t tid = 0,
+			size_t queue_capacity = crofqueue::DEFAULT_CAPACITY);
 
 	/**
 	 *
@@ -342,6 +411,9 @@ public:
 
 	/**
 	 * @brief	Send OFP message via socket
+	 *
+	 * @return congestion window, 0 when the message has been queued on a congested connection
+	 * @throws eRofSockTxQueueFull when the transmit queue is full, msg is not consumed in this case
 	 */
 	unsigned int
 	send_message(
@@ -354,7 +426,7 @@ public:
 	void
 	set_env(
 			crofconn_env* env)
-	{ this->env = env; };
+	{ this->env = env; publish_view_env(STATE_CONNECTED == state); };
 
 	/**
 	 *
@@ -363,6 +435,171 @@ public:
 	set_max_backoff(
 			const ctimespec& timespec);
 
+	/**
+	 * @brief	Enables or disables delivery of multipart reply fragments as they arrive.
+	 *
+	 * By default, fragments of an OpenFlow 1.3 multipart reply are stitched
+	 * together and a single message is handed over to the environment
+	 * once the last fragment has been received, so memory grows with the
+	 * size of the full reply, e.g., a datapath's entire flow table. In
+	 * streaming mode, each fragment is handed over on its own and memory
+	 * is bounded by a single fragment. All fragments except the last one
+	 * carry flag OFPMPF_REPLY_MORE.
+	 */
+	void
+	set_multipart_streaming(
+			bool streaming)
+	{ __atomic_store_n(&multipart_streaming, streaming, __ATOMIC_RELAXED); };
+
+	/**
+	 *
+	 */
+	bool
+	get_multipart_streaming() const
+	{ return __atomic_load_n(&multipart_streaming, __ATOMIC_RELAXED); };
+
+	/**
+	 * @brief	Sets admission control parameters for receive queue queue_id.
+	 *
+	 * Messages are policed by a per-connection token bucket and an optional
+	 * token bucket shared with other connections, see set_rx_shared_bucket().
+	 * Policing is done in the socket's thread on the message header before
+	 * parsing, so a peer flooding messages costs as little as possible.
+	 * Admitted messages are queued up to limit.max_size, further messages
+	 * are dropped according to limit.policy. With policy RXDROP_OLDEST the
+	 * queue is trimmed by the consuming thread.
+	 *
+	 * @throws eInval for an invalid queue_id
+	 */
+	void
+	set_rx_limit(
+			enum outqueue_type_t queue_id,
+			const crxlimit& limit);
+
+	/**
+	 *
+	 */
+	crxlimit
+	get_rx_limit(
+			enum outqueue_type_t queue_id) const;
+
+	/**
+	 * @brief	Sets a token bucket shared with other connections, e.g., all connections of a datapath.
+	 *
+	 * The bucket must outlive this connection or be reset to NULL before.
+	 *
+	 * @throws eInval for an invalid queue_id
+	 */
+	void
+	set_rx_shared_bucket(
+			enum outqueue_type_t queue_id,
+			ctokenbucket* bucket);
+
+	/**
+	 * @brief	Returns admission counters for receive queue queue_id.
+	 *
+	 * @throws eInval for an invalid queue_id
+	 */
+	crxcounters
+	get_rx_counters(
+			enum outqueue_type_t queue_id) const;
+
+	/**
+	 * @brief	Replaces the scheduler serving the receive queues, weights and metrics are retained.
+	 *
+	 * The new scheduler takes over when the consuming thread handles
+	 * received messages next, so this may be called from any thread,
+	 * including handlers invoked for received messages.
+	 *
+	 * @throws eRofSchedInval for an unknown type
+	 */
+	void
+	set_rx_scheduler(
+			enum crofsched::crofsched_type_t type);
+
+	/**
+	 *
+	 */
+	enum crofsched::crofsched_type_t
+	get_rx_scheduler() const;
+
+	/**
+	 * @brief	Sets scheduling weight of receive queue queue_id, see rofl::crofsched for its meaning.
+	 *
+	 * @throws eRofSchedInval for an invalid queue_id
+	 */
+	void
+	set_rx_weight(
+			enum outqueue_type_t queue_id,
+			unsigned int weight) {
+		RwLock rwlock(rxsched_lock, RwLock::RWLOCK_READ);
+		rxsched->set_weight(queue_id, weight);
+	};
+
+	/**
+	 * @throws eRofSchedInval for an invalid queue_id
+	 */
+	unsigned int
+	get_rx_weight(
+			enum outqueue_type_t queue_id) const {
+		RwLock rwlock(rxsched_lock, RwLock::RWLOCK_READ);
+		return rxsched->get_weight(queue_id);
+	};
+
+	/**
+	 * @brief	Returns messages, bytes, queueing delay and depth of receive queue queue_id.
+	 *
+	 * @throws eRofSchedInval for an invalid queue_id
+	 */
+	crofsched_stats
+	get_rx_queue_stats(
+			enum outqueue_type_t queue_id) const {
+		RwLock rwlock(rxsched_lock, RwLock::RWLOCK_READ);
+		return rxsched->get_stats(queue_id);
+	};
+
+	/**
+	 * @brief	Replaces the scheduler serving the transmit queues of the underlying rofl::crofsock.
+	 */
+	void
+	set_tx_scheduler(
+			enum crofsched::crofsched_type_t type)
+	{ rofsock->set_tx_scheduler(type); };
+
+	/**
+	 *
+	 */
+	enum crofsched::crofsched_type_t
+	get_tx_scheduler() const
+	{ return rofsock->get_tx_scheduler(); };
+
+	/**
+	 * @throws eRofSchedInval for an invalid queue_id
+	 */
+	void
+	set_tx_weight(
+			enum outqueue_type_t queue_id,
+			unsigned int weight)
+	{ rofsock->set_tx_weight(queue_id, weight); };
+
+	/**
+	 * @throws eRofSchedInval for an invalid queue_id
+	 */
+	unsigned int
+	get_tx_weight(
+			enum outqueue_type_t queue_id) const
+	{ return rofsock->get_tx_weight(queue_id); };
+
+	/**
+	 * @brief	Returns messages, bytes, queueing delay and depth of transmit queue queue_id.
+	 *
+	 * @throws eRofSchedInval for an invalid queue_id
+	 */
+	crofsched_stats
+	get_tx_queue_stats(
+			enum outqueue_type_t queue_id) const
+	{ return rofsock->get_tx_queue_stats(queue_id); };
+
 private:
 
 	virtual void
@@ -407,6 +644,17 @@ private:
 			crofsock& rofsock,
 			rofl::openflow::cofmsg *msg);
 
+	virtual bool
+	recv_message_view(
+			crofsock& rofsock,
+			rofl::openflow::cofmsg_view const& view);
+
+	virtual bool
+	recv_ready(
+			crofsock& rofsock,
+			uint8_t version,
+			uint8_t type);
+
 private:
 
 	/**
@@ -415,6 +663,52 @@ private:
 	void
 	handle_messages();
 
+	/**
+	 * @brief	Drops all messages pending in rxqueues and dlqueue, consumer thread only.
+	 */
+	void
+	clear_queues();
+
+	/**
+	 * @brief	Returns receive queue for message type or QUEUE_MAX for unsupported versions.
+	 */
+	static unsigned int
+	get_rx_queue_id(
+			uint8_t version,
+			uint8_t type);
+
+	/**
+	 * @brief	Publishes env for recv_message_view() when connected or withdraws it (owner thread only).
+	 */
+	void
+	publish_view_env(
+			bool connected);
+
+	/**
+	 * @brief	Consumes a token from the per-connection and shared token buckets.
+	 *
+	 * A message rejected by the shared bucket does not count against
+	 * the per-connection bucket.
+	 */
+	bool
+	rx_admit(
+			unsigned int queue_id) {
+		if (not rxbuckets[queue_id].admit())
+			return false;
+		ctokenbucket* shared = __atomic_load_n(&rxbuckets_shared[queue_id], __ATOMIC_ACQUIRE);
+		if ((NULL == shared) || shared->admit())
+			return true;
+		rxbuckets[queue_id].refund();
+		return false;
+	};
+
+	/**
+	 * @brief	Drops oldest messages exceeding queue limit (consumer only).
+	 */
+	void
+	rx_trim(
+			unsigned int queue_id);
+
 	/**
 	 *
 	 */
@@ -440,6 +734,12 @@ private:
 		case EVENT_RXQUEUE: {
 			handle_messages();
 		} break;
+		case EVENT_LIFE_SIGNAL: {
+			timer_start_life_check();
+		} break;
+		case EVENT_CLEAR_QUEUES: {
+			clear_queues();
+		} break;
 		case EVENT_TCP_CONNECTED: {
 			flags.reset(FLAGS_RECONNECTING);
 			run_engine(EVENT_TCP_CONNECTED);
@@ -609,6 +909,16 @@ private:
 	fragment_and_send_message(
 			rofl::openflow::cofmsg *msg);
 
+	/**
+	 * @brief	Queues either all fragments or none of them and clears fragments.
+	 *
+	 * @throws eRofSockTxQueueFull when the transmit queue cannot take all fragments, these are deleted then
+	 */
+	template<class T>
+	unsigned int
+	send_fragments(
+			std::vector<T*>& fragments);
+
 	/**
 	 *
 	 */
@@ -845,6 +1155,7 @@ public:
 private:
 
 	crofconn_env* 		env;
+	crofconn_env*		view_env;				// env while connected, read by crofsock's thread
 	uint64_t			dpid;
 	cauxid				auxiliary_id;
 	pthread_t			rofsocktid;				// IO thread identifier
@@ -857,6 +1168,7 @@ private:
 	std::bitset<32>		flags;
 	csegmentation		sar;					// segmentation and reassembly for multipart messages
 	size_t				fragmentation_threshold;// maximum number of bytes for a multipart message before being fragmented
+	bool				multipart_streaming;	// hand over multipart reply fragments without reassembly
 
 	static unsigned int const
 						DEFAULT_FRAGMENTATION_THRESHOLD = 65535;
@@ -888,10 +1200,29 @@ private:
 	std::vector<crofqueue>
 						rxqueues;				// queues for receiving messages from crofsock instance => // QUEUE_MAX txqueues
 
-	std::vector<unsigned int>
-						rxweights;				// relative scheduling weights for txqueues
+	crofsched*			rxsched;				// scheduler serving the rxqueues, replaced by the consuming thread only
+
+	crofsched*			rxsched_pending;		// scheduler set by set_rx_scheduler() not yet in use or NULL
+
+	mutable PthreadRwLock
+						rxsched_lock;			// protects rxsched against replacement while accessed by other threads
+
+	std::vector<crxlimit>
+						rxlimits;				// admission control parameters for rxqueues
+
+	std::vector<ctokenbucket>
+						rxbuckets;				// per-connection token buckets for rxqueues
+
+	std::vector<ctokenbucket*>
+						rxbuckets_shared;		// token buckets shared with other connections or NULL
+
+	std::vector<crxcounters>
+						rxcounters;				// admission counters for rxqueues, updated atomically
+
+	unsigned int		rxstalled;				// set by crofsock's thread when reading has been suspended on a full rxqueue
 
-	rofl::crofqueue		dlqueue;				// delay queue, used for storing asynchronous messages during connection setup
+	std::deque<rofl::openflow::cofmsg*>
+						dlqueue;				// delay queue, used for storing asynchronous messages during connection setup
 
 	static const int 	DEFAULT_HELLO_TIMEOUT = 5;
 	static const int 	DEFAULT_ECHO_TIMEOUT = 60;
@@ -1835,7 +1835,7 @@ crofctl::features_request_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_featu
 {
 	rofl::openflow::cofmsg_features_request& request = dynamic_cast<rofl::openflow::cofmsg_features_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Features-Request message received" << std::endl << request;
 
 	call_env().handle_features_request(*this, auxid, request);
@@ -1850,7 +1850,7 @@ crofctl::get_config_request_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_get
 {
 	rofl::openflow::cofmsg_get_config_request& request = dynamic_cast<rofl::openflow::cofmsg_get_config_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Get-Config-Request message received" << std::endl << request;
 
 	check_role();
@@ -1867,7 +1867,7 @@ crofctl::set_config_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_set_config
 {
 	rofl::openflow::cofmsg_set_config& message = dynamic_cast<rofl::openflow::cofmsg_set_config&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Set-Config message received" << std::endl << message;
 
 	try {
@@ -1912,7 +1912,7 @@ crofctl::packet_out_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_packet_out
 {
 	rofl::openflow::cofmsg_packet_out& message = dynamic_cast<rofl::openflow::cofmsg_packet_out&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Packet-Out message received" << std::endl << message;
 
 	check_role();
@@ -1929,7 +1929,7 @@ crofctl::flow_mod_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_flow_mod *msg
 {
 	rofl::openflow::cofmsg_flow_mod& message = dynamic_cast<rofl::openflow::cofmsg_flow_mod&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Flow-Mod message received" << std::endl << message;
 
 	message.check_prerequisites();
@@ -2046,7 +2046,7 @@ crofctl::group_mod_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_group_mod *m
 {
 	rofl::openflow::cofmsg_group_mod& message = dynamic_cast<rofl::openflow::cofmsg_group_mod&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Group-Mod message received" << std::endl << message;
 
 	message.check_prerequisites();
@@ -2177,7 +2177,7 @@ crofctl::port_mod_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_port_mod *msg
 {
 	rofl::openflow::cofmsg_port_mod& message = dynamic_cast<rofl::openflow::cofmsg_port_mod&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Port-Mod message received" << std::endl << message;
 
 	try {
@@ -2236,7 +2236,7 @@ crofctl::table_mod_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_table_mod *m
 {
 	rofl::openflow::cofmsg_table_mod& message = dynamic_cast<rofl::openflow::cofmsg_table_mod&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Table-Mod message received" << std::endl << message;
 
 	try {
@@ -2283,7 +2283,7 @@ crofctl::meter_mod_rcvd(
 {
 	rofl::openflow::cofmsg_meter_mod& message = dynamic_cast<rofl::openflow::cofmsg_meter_mod&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Meter-Mod message received" << std::endl << message;
 
 	try {
@@ -2391,7 +2391,7 @@ crofctl::stats_request_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_stats *m
 {
 	rofl::openflow::cofmsg_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Stats-Request message received" << std::endl << request;
 
 	switch (msg->get_stats_type()) {
@@ -2452,7 +2452,7 @@ crofctl::desc_stats_request_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_des
 {
 	rofl::openflow::cofmsg_desc_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_desc_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Desc-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_desc_stats_request(*this, auxid, request);
@@ -2467,7 +2467,7 @@ crofctl::table_stats_request_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_ta
 {
 	rofl::openflow::cofmsg_table_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_table_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Table-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_table_stats_request(*this, auxid, request);
@@ -2482,7 +2482,7 @@ crofctl::port_stats_request_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_por
 {
 	rofl::openflow::cofmsg_port_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_port_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Port-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_port_stats_request(*this, auxid, request);
@@ -2497,7 +2497,7 @@ crofctl::flow_stats_request_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_flo
 {
 	rofl::openflow::cofmsg_flow_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_flow_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Flow-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_flow_stats_request(*this, auxid, request);
@@ -2512,7 +2512,7 @@ crofctl::aggregate_stats_request_rcvd(const cauxid& auxid, rofl::openflow::cofms
 {
 	rofl::openflow::cofmsg_aggr_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_aggr_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Aggregate-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_aggregate_stats_request(*this, auxid, request);
@@ -2527,7 +2527,7 @@ crofctl::queue_stats_request_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_qu
 {
 	rofl::openflow::cofmsg_queue_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_queue_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Queue-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_queue_stats_request(*this, auxid, request);
@@ -2542,7 +2542,7 @@ crofctl::group_stats_request_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_gr
 {
 	rofl::openflow::cofmsg_group_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_group_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Group-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_group_stats_request(*this, auxid, request);
@@ -2557,7 +2557,7 @@ crofctl::group_desc_stats_request_rcvd(const cauxid& auxid, rofl::openflow::cofm
 {
 	rofl::openflow::cofmsg_group_desc_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_group_desc_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Group-Desc-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_group_desc_stats_request(*this, auxid, request);
@@ -2572,7 +2572,7 @@ crofctl::group_features_stats_request_rcvd(const cauxid& auxid, rofl::openflow::
 {
 	rofl::openflow::cofmsg_group_features_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_group_features_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Group-Features-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_group_features_stats_request(*this, auxid, request);
@@ -2587,7 +2587,7 @@ crofctl::meter_stats_request_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_me
 {
 	rofl::openflow::cofmsg_meter_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_meter_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Meter-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_meter_stats_request(*this, auxid, request);
@@ -2602,7 +2602,7 @@ crofctl::meter_config_stats_request_rcvd(const cauxid& auxid, rofl::openflow::co
 {
 	rofl::openflow::cofmsg_meter_config_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_meter_config_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Meter-Config-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_meter_config_stats_request(*this, auxid, request);
@@ -2617,7 +2617,7 @@ crofctl::meter_features_stats_request_rcvd(const cauxid& auxid, rofl::openflow::
 {
 	rofl::openflow::cofmsg_meter_features_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_meter_features_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Meter-Features-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_meter_features_stats_request(*this, auxid, request);
@@ -2632,7 +2632,7 @@ crofctl::table_features_stats_request_rcvd(const cauxid& auxid, rofl::openflow::
 {
 	rofl::openflow::cofmsg_table_features_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_table_features_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Table-Features-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_table_features_stats_request(*this, auxid, request);
@@ -2647,7 +2647,7 @@ crofctl::port_desc_stats_request_rcvd(const cauxid& auxid, rofl::openflow::cofms
 {
 	rofl::openflow::cofmsg_port_desc_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_port_desc_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Port-Desc-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_port_desc_stats_request(*this, auxid, request);
@@ -2662,7 +2662,7 @@ crofctl::experimenter_stats_request_rcvd(const cauxid& auxid, rofl::openflow::co
 {
 	rofl::openflow::cofmsg_experimenter_stats_request& request = dynamic_cast<rofl::openflow::cofmsg_experimenter_stats_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Experimenter-Stats-Request message received" << std::endl << request;
 
 	call_env().handle_experimenter_stats_request(*this, auxid, request);
@@ -2678,7 +2678,7 @@ crofctl::role_request_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_role_requ
 	try {
 		rofl::openflow::cofmsg_role_request& request = dynamic_cast<rofl::openflow::cofmsg_role_request&>( *msg );
 
-		rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+		ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 				<< " Role-Request message received" << std::endl << request;
 
 		switch (msg->get_role().get_role()) {
@@ -2737,7 +2737,7 @@ crofctl::barrier_request_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_barrie
 {
 	rofl::openflow::cofmsg_barrier_request& request = dynamic_cast<rofl::openflow::cofmsg_barrier_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Barrier-Request message received" << std::endl << request;
 
 	call_env().handle_barrier_request(*this, auxid, request);
@@ -2752,7 +2752,7 @@ crofctl::queue_get_config_request_rcvd(const cauxid& auxid, rofl::openflow::cofm
 {
 	rofl::openflow::cofmsg_queue_get_config_request& request = dynamic_cast<rofl::openflow::cofmsg_queue_get_config_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Queue-Get-Config-Request message received" << std::endl << request;
 
 	call_env().handle_queue_get_config_request(*this, auxid, request);
@@ -2767,7 +2767,7 @@ crofctl::experimenter_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_experimen
 {
 	rofl::openflow::cofmsg_experimenter& message = dynamic_cast<rofl::openflow::cofmsg_experimenter&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Experimenter message received" << std::endl << message;
 
 	switch (msg->get_experimenter_id()) {
@@ -2786,7 +2786,7 @@ crofctl::error_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_error *msg)
 {
 	rofl::openflow::cofmsg_error& error = dynamic_cast<rofl::openflow::cofmsg_error&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Error message received" << std::endl << error;
 
 	call_env().handle_error_message(*this, auxid, error);
@@ -2801,7 +2801,7 @@ crofctl::get_async_config_request_rcvd(const cauxid& auxid, rofl::openflow::cofm
 {
 	rofl::openflow::cofmsg_get_async_config_request& request = dynamic_cast<rofl::openflow::cofmsg_get_async_config_request&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Get-Async-Config-Request message received" << std::endl << request;
 
 	send_get_async_config_reply(auxid, msg->get_xid(), async_config);
@@ -2816,7 +2816,7 @@ crofctl::set_async_config_rcvd(const cauxid& auxid, rofl::openflow::cofmsg_set_a
 {
 	rofl::openflow::cofmsg_set_async_config& message = dynamic_cast<rofl::openflow::cofmsg_set_async_config&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
+	ROFL_DEBUG2 << "[rofl-common][crofctl] ctlid:0x" << ctlid.str()
 			<< " Set-Async-Config message received" << std::endl << message;
 
 	async_config = msg->get_async_config();
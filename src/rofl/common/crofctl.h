@@ -875,6 +875,73 @@ public:
 
 	/**@}*/
 
+public:
+
+	/**
+	 * @name	Methods for scheduling of queued messages
+	 *
+	 * Messages exchanged with the controller are queued per message class, e.g.,
+	 * rofl::crofconn::QUEUE_PKT for Packet-In and Packet-Out messages, in a
+	 * receive and a transmit queue per control connection. A scheduler selects
+	 * the queue to be served next, see rofl::crofsched for the disciplines
+	 * available and the meaning of queue weights. By default, queues are
+	 * served by weighted round robin.
+	 */
+
+	/**@{*/
+
+	/**
+	 * @brief	Sets scheduler for receive queues of all control connections.
+	 */
+	void
+	set_rx_scheduler(
+			enum rofl::crofsched::crofsched_type_t type)
+	{ rofchan.set_rx_scheduler(type); };
+
+	/**
+	 * @brief	Sets scheduling weight of a message class for receive queues of all control connections.
+	 */
+	void
+	set_rx_weight(
+			enum rofl::crofconn::outqueue_type_t queue_id,
+			unsigned int weight)
+	{ rofchan.set_rx_weight(queue_id, weight); };
+
+	/**
+	 * @brief	Returns messages, bytes, queueing delay and depth of a message class received from the controller.
+	 */
+	rofl::crofsched_stats
+	get_rx_queue_stats(
+			enum rofl::crofconn::outqueue_type_t queue_id) const
+	{ return rofchan.get_rx_queue_stats(queue_id); };
+
+	/**
+	 * @brief	Sets scheduler for transmit queues of all control connections.
+	 */
+	void
+	set_tx_scheduler(
+			enum rofl::crofsched::crofsched_type_t type)
+	{ rofchan.set_tx_scheduler(type); };
+
+	/**
+	 * @brief	Sets scheduling weight of a message class for transmit queues of all control connections.
+	 */
+	void
+	set_tx_weight(
+			enum rofl::crofconn::outqueue_type_t queue_id,
+			unsigned int weight)
+	{ rofchan.set_tx_weight(queue_id, weight); };
+
+	/**
+	 * @brief	Returns messages, bytes, queueing delay and depth of a message class sent to the controller.
+	 */
+	rofl::crofsched_stats
+	get_tx_queue_stats(
+			enum rofl::crofconn::outqueue_type_t queue_id) const
+	{ return rofchan.get_tx_queue_stats(queue_id); };
+
+	/**@}*/
+
 public:
 
 	/**
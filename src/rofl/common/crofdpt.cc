@@ -11,12 +11,15 @@
 using namespace rofl;
 
 /*static*/std::set<crofdpt_env*> crofdpt_env::rofdpt_envs;
+/*static*/PthreadRwLock crofdpt_env::rofdpt_envs_lock;
 /*static*/std::map<cdptid, crofdpt*> crofdpt::rofdpts;
+/*static*/PthreadRwLock crofdpt::rofdpts_lock;
 
 /*static*/crofdpt&
 crofdpt::get_dpt(
 		const cdptid& dptid)
 {
+	RwLock lock(crofdpt::rofdpts_lock, RwLock::RWLOCK_READ);
 	if (crofdpt::rofdpts.find(dptid) == crofdpt::rofdpts.end()) {
 		throw eRofDptNotFound("rofl::crofdpt::get_dpt() dptid not found");
 	}
@@ -29,6 +32,7 @@ crofdpt::get_dpt(
 crofdpt::get_dpt(
 		const cdpid& dpid)
 {
+	RwLock lock(crofdpt::rofdpts_lock, RwLock::RWLOCK_READ);
 	std::map<cdptid, crofdpt*>::iterator it;
 	if ((it = find_if(crofdpt::rofdpts.begin(), crofdpt::rofdpts.end(),
 			crofdpt::crofdpt_find_by_dpid(dpid.get_uint64_t()))) == crofdpt::rofdpts.end()) {
@@ -121,6 +125,22 @@ crofdpt::work_on_eventqueue()
 
 
 
+void
+crofdpt::publish_view_env(
+		bool established)
+{
+	crofdpt_env* view_env = NULL;
+	if (established) {
+		RwLock lock(crofdpt_env::rofdpt_envs_lock, RwLock::RWLOCK_READ);
+		if (crofdpt_env::rofdpt_envs.find(env) != crofdpt_env::rofdpt_envs.end()) {
+			view_env = env;
+		}
+	}
+	__atomic_store_n(&(this->view_env), view_env, __ATOMIC_RELEASE);
+}
+
+
+
 void
 crofdpt::event_connected()
 {
@@ -159,7 +179,8 @@ crofdpt::event_disconnected()
 	tables.clear();
 	ports.clear();
 	state = STATE_DISCONNECTED;
-	dlqueue.clear();
+	publish_view_env(false);
+	clear_delayed_messages();
 	call_env().handle_chan_terminated(*this);
 }
 
@@ -257,10 +278,13 @@ crofdpt::event_get_config_reply_rcvd()
 		case rofl::openflow10::OFP_VERSION: {
 			rofl::logging::debug << "[rofl-common][crofdpt] entering state -established-" << std::endl;
 			state = STATE_ESTABLISHED;
+			publish_view_env(true);
 			call_env().handle_chan_established(*this);
 			// send all postponed messages to higher layers
 			while (not dlqueue.empty()) {
-				recv_message(rofchan, rofl::cauxid(0), dlqueue.retrieve());
+				rofl::openflow::cofmsg* msg = dlqueue.front();
+				dlqueue.pop_front();
+				recv_message(rofchan, rofl::cauxid(0), msg);
 			}
 
 		} break;
@@ -317,10 +341,13 @@ crofdpt::event_table_stats_reply_rcvd()
 		case rofl::openflow12::OFP_VERSION: {
 			rofl::logging::debug << "[rofl-common][crofdpt] entering state -established-" << std::endl;
 			state = STATE_ESTABLISHED;
+			publish_view_env(true);
 			call_env().handle_chan_established(*this);
 			// send all postponed messages to higher layers
 			while (not dlqueue.empty()) {
-				recv_message(rofchan, rofl::cauxid(0), dlqueue.retrieve());
+				rofl::openflow::cofmsg* msg = dlqueue.front();
+				dlqueue.pop_front();
+				recv_message(rofchan, rofl::cauxid(0), msg);
 			}
 
 		} break;
@@ -419,10 +446,13 @@ crofdpt::event_port_desc_reply_rcvd()
 		default: {
 			rofl::logging::debug << "[rofl-common][crofdpt] entering state -established-" << std::endl;
 			state = STATE_ESTABLISHED;
+			publish_view_env(true);
 			call_env().handle_chan_established(*this);
 			// send all postponed messages to higher layers
 			while (not dlqueue.empty()) {
-				recv_message(rofchan, rofl::cauxid(0), dlqueue.retrieve());
+				rofl::openflow::cofmsg* msg = dlqueue.front();
+				dlqueue.pop_front();
+				recv_message(rofchan, rofl::cauxid(0), msg);
 			}
 
 		} break;
@@ -1465,6 +1495,44 @@ crofdpt::send_packet_out_message(
 
 
 
+uint32_t
+crofdpt::send_packet_out_message(
+		const rofl::cauxid& auxid,
+		const rofl::openflow::cofpacketoutbatch& batch)
+{
+	uint32_t xid = 0;
+
+	try {
+		if (not is_established()) {
+			rofl::logging::warn << "[rofl-common][crofdpt] "
+					<< "control channel not connected" << std::endl;
+			throw eRofBaseNotConnected();
+		}
+
+		if (batch.get_version() != rofchan.get_version()) {
+			throw eBadVersion("crofdpt::send_packet_out_message() batch version mismatch");
+		}
+
+		if (batch.empty()) {
+			throw rofl::openflow::ePacketOutBatchInval("crofdpt::send_packet_out_message() empty batch");
+		}
+
+		// reserve one transaction ID per Packet-Out
+		xid = transactions.get_async_xids(batch.get_num_messages());
+
+		rofchan.send_message(auxid, batch.create_message(xid));
+
+		return xid;
+
+	} catch (eRofBaseCongested& e) {
+		rofl::logging::warn << "[rofl-common][crofdpt] "
+				<< "control channel congested" << std::endl;
+		throw;
+	}
+}
+
+
+
 uint32_t
 crofdpt::send_barrier_request(
 		const rofl::cauxid& auxid,
@@ -1572,6 +1640,39 @@ crofdpt::send_flow_mod_message(
 
 
 
+uint32_t
+crofdpt::send_flow_mod_message(
+		const rofl::cauxid& auxid,
+		const rofl::openflow::cofflowmodtemplate& tmpl)
+{
+	uint32_t xid = 0;
+
+	try {
+		if (not is_established()) {
+			rofl::logging::warn << "[rofl-common][crofdpt] "
+					<< "control channel not connected" << std::endl;
+			throw eRofBaseNotConnected();
+		}
+
+		if (tmpl.get_version() != rofchan.get_version()) {
+			throw eBadVersion("crofdpt::send_flow_mod_message() template version mismatch");
+		}
+
+		xid = transactions.get_async_xid();
+
+		rofchan.send_message(auxid, tmpl.create_message(xid));
+
+		return xid;
+
+	} catch (eRofBaseCongested& e) {
+		rofl::logging::warn << "[rofl-common][crofdpt] "
+				<< "control channel congested" << std::endl;
+		throw;
+	}
+}
+
+
+
 uint32_t
 crofdpt::send_group_mod_message(
 		const rofl::cauxid& auxid,
@@ -1961,7 +2062,7 @@ crofdpt::features_reply_rcvd(
 {
 	rofl::openflow::cofmsg_features_reply& reply = dynamic_cast<rofl::openflow::cofmsg_features_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << get_dpid().str()
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << get_dpid().str()
 				<< " rcvd Features-Reply: " << reply.str() << std::endl;
 
 	try {
@@ -2015,7 +2116,7 @@ crofdpt::get_config_reply_rcvd(
 {
 	rofl::openflow::cofmsg_get_config_reply& reply = dynamic_cast<rofl::openflow::cofmsg_get_config_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid: " << get_dpid().str()
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid: " << get_dpid().str()
 			<< " rcvd Get-Config-Reply: " << reply.str() << std::endl;
 
 	transactions.drop_ta(msg->get_xid());
@@ -2037,14 +2138,17 @@ crofdpt::multipart_reply_rcvd(
 		const rofl::cauxid& auxid,
 		rofl::openflow::cofmsg *msg)
 {
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Multipart-Reply message received" << std::endl << *msg;
 
-	transactions.drop_ta(msg->get_xid());
-
 	rofl::openflow::cofmsg_multipart_reply *reply = dynamic_cast<rofl::openflow::cofmsg_multipart_reply*>( msg );
 	assert(reply != NULL);
 
+	// streamed fragments: transaction ends with the last fragment
+	if (not (reply->get_stats_flags() & rofl::openflow13::OFPMPF_REPLY_MORE)) {
+		transactions.drop_ta(msg->get_xid());
+	}
+
 	switch (reply->get_stats_type()) {
 	case rofl::openflow13::OFPMP_DESC: {
 		desc_stats_reply_rcvd(auxid, msg);
@@ -2111,7 +2215,7 @@ crofdpt::desc_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_desc_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_desc_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " rcvd Desc-Stats-Reply: " << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2129,7 +2233,7 @@ crofdpt::table_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_table_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_table_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << get_dpid().str()
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << get_dpid().str()
 			<< " rcvd Table-Stats-Reply: " << reply.str() << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2149,7 +2253,7 @@ crofdpt::port_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_port_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_port_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Port-Stats-Reply message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2167,7 +2271,7 @@ crofdpt::flow_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_flow_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_flow_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Flow-Stats-Reply message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2185,7 +2289,7 @@ crofdpt::aggregate_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_aggr_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_aggr_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Aggregate-Stats-Reply message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2203,7 +2307,7 @@ crofdpt::queue_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_queue_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_queue_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Queue-Stats-Reply message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2221,7 +2325,7 @@ crofdpt::group_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_group_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_group_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Group-Stats-Reply message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2239,7 +2343,7 @@ crofdpt::group_desc_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_group_desc_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_group_desc_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Group-Desc-Stats-Reply message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2257,7 +2361,7 @@ crofdpt::group_features_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_group_features_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_group_features_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Group-Features-Stats-Reply message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2275,7 +2379,7 @@ crofdpt::meter_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_meter_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_meter_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Meter-Stats-Reply message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2293,7 +2397,7 @@ crofdpt::meter_config_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_meter_config_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_meter_config_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Meter-Config-Stats-Reply message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2311,7 +2415,7 @@ crofdpt::meter_features_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_meter_features_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_meter_features_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Meter-Features-Stats-Reply message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2329,7 +2433,7 @@ crofdpt::table_features_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_table_features_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_table_features_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << get_dpid().str()
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << get_dpid().str()
 			<< " rcvd Table-Features-Stats-Reply: " << reply.str() << std::endl;
 
 	tables = reply.get_tables();
@@ -2351,7 +2455,7 @@ crofdpt::port_desc_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_port_desc_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_port_desc_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " rcvd Port-Desc-Stats-Reply: " << reply.str() << std::endl;
 
 	ports = reply.get_ports();
@@ -2373,7 +2477,7 @@ crofdpt::experimenter_stats_reply_rcvd(
 {
 	rofl::openflow::cofmsg_experimenter_stats_reply& reply = dynamic_cast<rofl::openflow::cofmsg_experimenter_stats_reply&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Experimenter-Stats-Reply message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2393,7 +2497,7 @@ crofdpt::barrier_reply_rcvd(
 
 	transactions.drop_ta(msg->get_xid());
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Barrier-Reply message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2412,14 +2516,34 @@ crofdpt::flow_removed_rcvd(
 {
 	rofl::openflow::cofmsg_flow_removed& flow_removed = dynamic_cast<rofl::openflow::cofmsg_flow_removed&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Flow-Removed message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
 		call_env().handle_flow_removed(*this, auxid, flow_removed);
 		delete msg;
 	} else {
-		dlqueue.store(msg);
+		delay_message(msg);
+	}
+}
+
+
+
+void
+crofdpt::delay_message(
+		rofl::openflow::cofmsg *msg)
+{
+	dlqueue.push_back(msg);
+}
+
+
+
+void
+crofdpt::clear_delayed_messages()
+{
+	while (not dlqueue.empty()) {
+		delete dlqueue.front();
+		dlqueue.pop_front();
 	}
 }
 
@@ -2432,14 +2556,14 @@ crofdpt::packet_in_rcvd(
 {
 	rofl::openflow::cofmsg_packet_in& packet_in = dynamic_cast<rofl::openflow::cofmsg_packet_in&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Packet-In message received" << std::endl;
 
 	if (STATE_ESTABLISHED == state) {
 		call_env().handle_packet_in(*this, auxid, packet_in);
 		delete msg;
 	} else {
-		dlqueue.store(msg);
+		delay_message(msg);
 	}
 }
 
@@ -2452,7 +2576,7 @@ crofdpt::port_status_rcvd(
 {
 	rofl::openflow::cofmsg_port_status& port_status = dynamic_cast<rofl::openflow::cofmsg_port_status&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Port-Status message received" << std::endl;
 
 	ports.set_version(rofchan.get_version());
@@ -2476,7 +2600,7 @@ crofdpt::port_status_rcvd(
 		call_env().handle_port_status(*this, auxid, port_status);
 		delete msg;
 	} else {
-		dlqueue.store(msg);
+		delay_message(msg);
 	}
 }
 
@@ -2490,7 +2614,7 @@ crofdpt::experimenter_rcvd(
 
 	transactions.drop_ta(msg->get_xid());
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Experimenter message received" << std::endl << exp;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2508,7 +2632,7 @@ crofdpt::error_rcvd(
 {
 	rofl::openflow::cofmsg_error& error = dynamic_cast<rofl::openflow::cofmsg_error&>( *msg );
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Error message received" << std::endl << error;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2528,7 +2652,7 @@ crofdpt::role_reply_rcvd(
 
 	transactions.drop_ta(msg->get_xid());
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Role-Reply message received" << std::endl << reply;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2548,7 +2672,7 @@ crofdpt::queue_get_config_reply_rcvd(
 
 	transactions.drop_ta(msg->get_xid());
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< " Queue-Get-Config-Reply message received" << std::endl << reply;
 
 	if (STATE_ESTABLISHED == state) {
@@ -2568,7 +2692,7 @@ crofdpt::get_async_config_reply_rcvd(
 
 	transactions.drop_ta(msg->get_xid());
 
-	rofl::logging::debug2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
+	ROFL_DEBUG2 << "[rofl-common][crofdpt] dpid:" << std::hex << get_dpid().str() << std::dec
 			<< "Get-Async-Config-Reply message received" << std::endl << reply;
 
 	if (STATE_ESTABLISHED == state) {
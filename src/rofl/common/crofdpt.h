@@ -7,6 +7,7 @@
 
 #include <map>
 #include <set>
+#include <deque>
 #include <algorithm>
 #include <inttypes.h>
 #include <stdio.h>
@@ -31,6 +32,8 @@
 #include "rofl/common/openflow/openflow.h"
 #include "rofl/common/openflow/messages/cofmsg.h"
 #include "rofl/common/openflow/cofflowmod.h"
+#include "rofl/common/openflow/cofflowmodtemplate.h"
+#include "rofl/common/openflow/cofpacketoutbatch.h"
 #include "rofl/common/openflow/cofgroupmod.h"
 #include "rofl/common/openflow/cofhelloelemversionbitmap.h"
 #include "rofl/common/openflow/cofasyncconfig.h"
@@ -75,20 +78,25 @@ class crofdpt;
 class crofdpt_env {
 	friend class crofdpt;
 	static std::set<crofdpt_env*> rofdpt_envs;
+	static PthreadRwLock rofdpt_envs_lock;
 public:
 
 	/**
 	 * @brief	rofl::crofdpt_env constructor
 	 */
-	crofdpt_env()
-	{ crofdpt_env::rofdpt_envs.insert(this); };
+	crofdpt_env() {
+		RwLock lock(crofdpt_env::rofdpt_envs_lock, RwLock::RWLOCK_WRITE);
+		crofdpt_env::rofdpt_envs.insert(this);
+	};
 
 	/**
 	 * @brief	rofl::crofdpt_env destructor
 	 */
 	virtual
-	~crofdpt_env()
-	{ crofdpt_env::rofdpt_envs.erase(this); };
+	~crofdpt_env() {
+		RwLock lock(crofdpt_env::rofdpt_envs_lock, RwLock::RWLOCK_WRITE);
+		crofdpt_env::rofdpt_envs.erase(this);
+	};
 
 protected:
 
@@ -398,6 +406,10 @@ protected:
 	/**
 	 * @brief	OpenFlow Flow-Stats-Reply message received.
 	 *
+	 * With multipart streaming enabled, see rofl::crofdpt::set_multipart_streaming(),
+	 * this handler is called for every fragment and all fragments except the
+	 * last one carry flag rofl::openflow13::OFPMPF_REPLY_MORE.
+	 *
 	 * @param dpt datapath instance
 	 * @param auxid control connection identifier
 	 * @param msg OpenFlow message instance
@@ -757,6 +769,43 @@ protected:
 			rofl::openflow::cofmsg_packet_in& msg)
 	{};
 
+	/**
+	 * @brief	OpenFlow Packet-In message received, offered as zero-copy view.
+	 *
+	 * Called before any rofl::openflow::cofmsg_packet_in instance is allocated.
+	 * Inspect the fields needed via the view and return true for dropping or
+	 * having handled the message. Return false for receiving it via
+	 * handle_packet_in() as usual.
+	 *
+	 * Threading: unlike all other callbacks of rofl::crofdpt_env, this method
+	 * is executed on the I/O thread of the control connection's rofl::crofsock
+	 * instance, not on the thread of rofl::crofdpt. It may run concurrently with
+	 * any other handler of this class. Implementations must not block, must
+	 * protect any state shared with other handlers and must not alter the
+	 * datapath instance. Asynchronous messages may be sent via
+	 * rofl::crofdpt::send_packet_out_message() and
+	 * rofl::crofdpt::send_flow_mod_message(), as these allocate xids atomically
+	 * and enqueue into the connection's thread-safe transmission queues.
+	 * Requests creating a transaction must be issued from the crofdpt thread.
+	 * Views are offered only once the crofdpt thread has declared the control
+	 * channel established and until it has seen the channel terminate.
+	 *
+	 * Lifetime: view and auxid refer to the socket's receive buffer and are
+	 * valid during this call only. Use rofl::crofsock::materialize() for keeping
+	 * a copy and hand over any deferred work to the crofdpt thread.
+	 *
+	 * @param dpt datapath instance
+	 * @param auxid control connection identifier
+	 * @param view non-owning view on the received message
+	 * @return true when the message has been consumed
+	 */
+	virtual bool
+	handle_packet_in_view(
+			rofl::crofdpt& dpt,
+			const rofl::cauxid& auxid,
+			rofl::openflow::cofmsg_view const& view)
+	{ return false; };
+
 	/**
 	 * @brief	OpenFlow Barrier-Reply message received.
 	 *
@@ -1055,6 +1104,7 @@ public:
 			pthread_t tid = 0) :
 				rofl::ciosrv(tid),
 				env(env),
+				view_env(NULL),
 				dptid(dptid),
 				rofchan(this, versionbitmap, tid),
 				transactions(this, tid),
@@ -1067,6 +1117,7 @@ public:
 				config(0),
 				miss_send_len(0),
 				state(STATE_INIT) {
+		RwLock lock(crofdpt::rofdpts_lock, RwLock::RWLOCK_WRITE);
 		crofdpt::rofdpts[dptid] = this;
 		rofl::logging::debug << "[rofl-common][crofdpt] "
 				<< "instance created, dptid: " << dptid.str() << std::endl;
@@ -1081,10 +1132,15 @@ public:
 	~crofdpt() {
 		rofl::logging::debug << "[rofl-common][crofdpt] "
 				<< "instance destroyed, dptid: " << dptid.str() << std::endl;
-		crofdpt::rofdpts.erase(dptid);
+		publish_view_env(false);
+		{
+			RwLock lock(crofdpt::rofdpts_lock, RwLock::RWLOCK_WRITE);
+			crofdpt::rofdpts.erase(dptid);
+		}
 		events.clear();
 		rofchan.close();
 		transactions.clear();
+		clear_delayed_messages();
 	};
 
 	/**
@@ -1194,6 +1250,187 @@ public:
 
 	/**@}*/
 
+public:
+
+	/**
+	 * @name	Methods for admission control of received messages
+	 *
+	 * Received messages are sorted into receive queues by message class,
+	 * e.g., rofl::crofconn::QUEUE_PKT for Packet-In messages. For each class,
+	 * a token bucket per control connection and a token bucket shared by all
+	 * control connections of this datapath limit the rate of messages
+	 * admitted, and the number of admitted messages waiting for being handled
+	 * is bounded per connection. By default, no rate limits apply and a
+	 * receive queue holds up to its capacity, see set_conn_queue_capacity().
+	 */
+
+	/**@{*/
+
+	/**
+	 * @brief	Sets rate limit and receive queue limit applied to each control connection.
+	 *
+	 * @param queue_id message class
+	 * @param limit rate, burst, max. queue size and drop policy
+	 */
+	void
+	set_conn_rx_limit(
+			enum rofl::crofconn::outqueue_type_t queue_id,
+			const rofl::crofconn::crxlimit& limit)
+	{ rofchan.set_conn_rx_limit(queue_id, limit); };
+
+	/**
+	 * @brief	Sets rate limit for all control connections of this datapath.
+	 *
+	 * @param queue_id message class
+	 * @param rate messages per second, 0: unlimited
+	 * @param burst token bucket depth in messages
+	 */
+	void
+	set_rx_rate_limit(
+			enum rofl::crofconn::outqueue_type_t queue_id,
+			unsigned int rate,
+			unsigned int burst)
+	{ rofchan.set_rx_rate_limit(queue_id, rate, burst); };
+
+	/**
+	 * @brief	Returns admitted and dropped messages of a message class for all control connections.
+	 */
+	rofl::crofconn::crxcounters
+	get_rx_counters(
+			enum rofl::crofconn::outqueue_type_t queue_id) const
+	{ return rofchan.get_rx_counters(queue_id); };
+
+	/**@}*/
+
+public:
+
+	/**
+	 * @name	Methods for scheduling of queued messages
+	 *
+	 * Messages exchanged with the datapath are queued per message class, e.g.,
+	 * rofl::crofconn::QUEUE_PKT for Packet-In and Packet-Out messages, in a
+	 * receive and a transmit queue per control connection. A scheduler selects
+	 * the queue to be served next, see rofl::crofsched for the disciplines
+	 * available and the meaning of queue weights. By default, queues are
+	 * served by weighted round robin.
+	 */
+
+	/**@{*/
+
+	/**
+	 * @brief	Sets scheduler for receive queues of all control connections.
+	 */
+	void
+	set_rx_scheduler(
+			enum rofl::crofsched::crofsched_type_t type)
+	{ rofchan.set_rx_scheduler(type); };
+
+	/**
+	 * @brief	Sets scheduling weight of a message class for receive queues of all control connections.
+	 */
+	void
+	set_rx_weight(
+			enum rofl::crofconn::outqueue_type_t queue_id,
+			unsigned int weight)
+	{ rofchan.set_rx_weight(queue_id, weight); };
+
+	/**
+	 * @brief	Returns messages, bytes, queueing delay and depth of a message class received from the datapath.
+	 */
+	rofl::crofsched_stats
+	get_rx_queue_stats(
+			enum rofl::crofconn::outqueue_type_t queue_id) const
+	{ return rofchan.get_rx_queue_stats(queue_id); };
+
+	/**
+	 * @brief	Sets scheduler for transmit queues of all control connections.
+	 */
+	void
+	set_tx_scheduler(
+			enum rofl::crofsched::crofsched_type_t type)
+	{ rofchan.set_tx_scheduler(type); };
+
+	/**
+	 * @brief	Sets scheduling weight of a message class for transmit queues of all control connections.
+	 */
+	void
+	set_tx_weight(
+			enum rofl::crofconn::outqueue_type_t queue_id,
+			unsigned int weight)
+	{ rofchan.set_tx_weight(queue_id, weight); };
+
+	/**
+	 * @brief	Returns messages, bytes, queueing delay and depth of a message class sent to the datapath.
+	 */
+	rofl::crofsched_stats
+	get_tx_queue_stats(
+			enum rofl::crofconn::outqueue_type_t queue_id) const
+	{ return rofchan.get_tx_queue_stats(queue_id); };
+
+	/**@}*/
+
+public:
+
+	/**
+	 * @name	Methods for receiving multipart replies
+	 */
+
+	/**@{*/
+
+	/**
+	 * @brief	Enables or disables delivery of multipart reply fragments as they arrive.
+	 *
+	 * By default, fragments of a multipart reply are reassembled and the
+	 * complete reply is handed over to the environment, so dumping large
+	 * tables requires memory for the entire reply. In streaming mode, the
+	 * environment's handler, e.g., rofl::crofdpt_env::handle_flow_stats_reply(),
+	 * is called for each fragment as it arrives and memory is bounded by
+	 * a single fragment. The transaction ends with the last fragment, i.e.,
+	 * the first one without flag rofl::openflow13::OFPMPF_REPLY_MORE.
+	 */
+	void
+	set_multipart_streaming(
+			bool streaming)
+	{ rofchan.set_multipart_streaming(streaming); };
+
+	/**
+	 *
+	 */
+	bool
+	get_multipart_streaming() const
+	{ return rofchan.get_multipart_streaming(); };
+
+	/**
+	 * @brief	Sets capacity of receive and transmit queues for control connections opened by this instance afterwards.
+	 *
+	 * A message sent while its transmit queue is full is rejected with
+	 * rofl::eRofBaseTxQueueFull. A full receive queue suspends reading from
+	 * the control connection until the queue has been drained, so the
+	 * datapath is throttled by TCP flow control. Connections accepted from
+	 * datapaths use the capacity set by rofl::crofbase::set_conn_queue_capacity().
+	 */
+	void
+	set_conn_queue_capacity(
+			size_t capacity)
+	{ rofchan.set_conn_queue_capacity(capacity); };
+
+	/**
+	 *
+	 */
+	size_t
+	get_conn_queue_capacity() const
+	{ return rofchan.get_conn_queue_capacity(); };
+
+	/**
+	 * @brief	Returns true while the request with given xid awaits its reply, i.e., its last reply fragment.
+	 */
+	bool
+	has_pending_request(
+			uint32_t xid) const
+	{ return transactions.has_ta(xid); };
+
+	/**@}*/
+
 public:
 
 	/**
@@ -1786,6 +2023,26 @@ public:
 			uint8_t *data = NULL,
 			size_t datalen = 0);
 
+	/**
+	 * @brief	Sends a batch of OpenFlow Packet-Out messages to attached datapath element.
+	 *
+	 * All Packet-Outs of the batch are copied in one go and queued as a
+	 * single unit, see rofl::openflow::cofpacketoutbatch. The batch may be
+	 * cleared and reused afterwards.
+	 *
+	 * @param auxid controller connection identifier
+	 * @param batch Packet-Out messages sharing one action list
+	 * @return OpenFlow transaction ID assigned to the first Packet-Out, subsequent ones are numbered consecutively
+	 * @exception rofl::eRofBaseNotConnected
+	 * @exception rofl::eRofBaseCongested
+	 * @exception rofl::eBadVersion batch version differs from negotiated version
+	 * @exception rofl::openflow::ePacketOutBatchInval empty batch
+	 */
+	uint32_t
+	send_packet_out_message(
+			const rofl::cauxid& auxid,
+			const rofl::openflow::cofpacketoutbatch& batch);
+
 	/**
 	 * @brief	Sends OpenFlow Barrier-Request message to attached datapath element.
 	 *
@@ -1830,6 +2087,24 @@ public:
 			const rofl::cauxid& auxid,
 			const rofl::openflow::cofflowmod& flowmod);
 
+	/**
+	 * @brief	Sends OpenFlow Flow-Mod message stamped out from a template to attached datapath element.
+	 *
+	 * The serialized message is copied from the template's current state
+	 * and sent without packing, see rofl::openflow::cofflowmodtemplate.
+	 *
+	 * @param auxid controller connection identifier
+	 * @param tmpl OpenFlow flow mod template
+	 * @return OpenFlow transaction ID assigned to this request
+	 * @exception rofl::eRofBaseNotConnected
+	 * @exception rofl::eRofBaseCongested
+	 * @exception rofl::eBadVersion template version differs from negotiated version
+	 */
+	uint32_t
+	send_flow_mod_message(
+			const rofl::cauxid& auxid,
+			const rofl::openflow::cofflowmodtemplate& tmpl);
+
 	/**
 	 * @brief	Sends OpenFlow Group-Mod message to attached datapath element.
 	 *
@@ -2125,12 +2400,20 @@ private:
 
 	crofdpt_env&
 	call_env() {
+		RwLock lock(crofdpt_env::rofdpt_envs_lock, RwLock::RWLOCK_READ);
 		if (crofdpt_env::rofdpt_envs.find(env) == crofdpt_env::rofdpt_envs.end()) {
 			throw eRofDptNotFound("rofl::crofdpt::call_env() environment not found");
 		}
 		return *env;
 	};
 
+	/**
+	 * @brief	Publishes env for recv_message_view() when established or withdraws it (owner thread only).
+	 */
+	void
+	publish_view_env(
+			bool established);
+
 	virtual void
 	handle_conn_established(
 			crofchan& chan,
@@ -2192,6 +2475,13 @@ private:
 	virtual void
 	recv_message(crofchan& chan, const rofl::cauxid& auxid, rofl::openflow::cofmsg *msg);
 
+	virtual bool
+	recv_message_view(crofchan& chan, const rofl::cauxid& auxid, rofl::openflow::cofmsg_view const& view) {
+		// running in crofsock's thread, state and env are owned by our own thread
+		crofdpt_env* view_env = __atomic_load_n(&(this->view_env), __ATOMIC_ACQUIRE);
+		return (NULL != view_env) && view.is_packet_in() && view_env->handle_packet_in_view(*this, auxid, view);
+	};
+
 	virtual uint32_t
 	get_async_xid(crofchan& chan)
 	{ return transactions.get_async_xid(); };
@@ -2371,6 +2661,13 @@ private:
 	port_mod_sent(
 			rofl::openflow::cofmsg *pack);
 
+	void
+	delay_message(
+			rofl::openflow::cofmsg *msg);
+
+	void
+	clear_delayed_messages();
+
 	void
 	packet_in_rcvd(
 			const rofl::cauxid& auxid, rofl::openflow::cofmsg *msg);
@@ -2398,9 +2695,12 @@ private:
 private:
 
 	static std::map<rofl::cdptid, crofdpt*> rofdpts;
+	static PthreadRwLock rofdpts_lock;
 
 	// environment
 	rofl::crofdpt_env*      env;
+	// environment while established, read by crofsock's thread
+	rofl::crofdpt_env*      view_env;
 	// handle for this crofdpt instance
 	rofl::cdptid            dptid;
 	// OFP control channel
@@ -2442,7 +2742,8 @@ private:
 
 	std::bitset<32>         flags;
 	// delay queue, used for storing asynchronous messages during connection setup
-	rofl::crofqueue         dlqueue;
+	std::deque<rofl::openflow::cofmsg*>
+	                        dlqueue;
 
 	static const time_t     DEFAULT_REQUEST_TIMEOUT = 5; // seconds
 };
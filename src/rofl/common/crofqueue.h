@@ -8,29 +8,89 @@
 #ifndef CROFQUEUE_H_
 #define CROFQUEUE_H_
 
-#include <list>
+#include <stdint.h>
+#include <time.h>
 #include <ostream>
 
-#include "rofl/common/thread_helper.h"
+#include "rofl/common/croflexception.h"
 #include "rofl/common/openflow/messages/cofmsg.h"
 #include "rofl/common/logging.h"
 
 namespace rofl {
 
+class eRofQueueBase 		: public RoflException {};
+class eRofQueueFull 		: public eRofQueueBase {}; // queue has reached its capacity
+
+/**
+ * @ingroup common_devel_workflow
+ * @brief	Bounded lock-free queue for OpenFlow messages.
+ *
+ * A ring of fixed capacity with a sequence number per slot. Any number
+ * of threads may call store() concurrently, while front(), pop(),
+ * retrieve() and clear() must be called from a single consumer thread
+ * only, i.e., the thread running the rofl::cioloop that drains the queue.
+ * No lock is taken and no memory is allocated when storing or
+ * retrieving a message.
+ *
+ * When the queue is full, store() throws eRofQueueFull and the caller
+ * retains ownership of the message. Copying a crofqueue yields an empty
+ * queue of identical capacity.
+ *
+ * Each message is stamped with its enqueue time, so the consumer may
+ * determine the queueing delay of the first message via front_stamp().
+ */
 class crofqueue {
 public:
 
+	/**
+	 * @brief	Default capacity, rounded up to the next power of two.
+	 *
+	 * Slots are allocated upfront, 24 bytes each on 64bit platforms.
+	 */
+	static size_t const DEFAULT_CAPACITY = 256;
+
 	/**
 	 *
 	 */
-	crofqueue()
-	{};
+	crofqueue(
+			size_t capacity = DEFAULT_CAPACITY) :
+				mask(0),
+				cells(NULL),
+				enqueue_pos(0),
+				dequeue_pos(0)
+	{ initialize(capacity); };
+
+	/**
+	 *
+	 */
+	crofqueue(
+			const crofqueue& queue) :
+				mask(0),
+				cells(NULL),
+				enqueue_pos(0),
+				dequeue_pos(0)
+	{ initialize(queue.capacity()); };
+
+	/**
+	 *
+	 */
+	crofqueue&
+	operator= (
+			const crofqueue& queue) {
+		if (this == &queue)
+			return *this;
+		clear();
+		delete [] cells;
+		initialize(queue.capacity());
+		return *this;
+	};
 
 	/**
 	 *
 	 */
 	~crofqueue() {
 		clear();
+		delete [] cells;
 	};
 
 public:
@@ -38,96 +98,200 @@ public:
 	/**
 	 *
 	 */
-	bool
-	empty() {
-		RwLock rwlock(queuelock, RwLock::RWLOCK_READ);
-		return queue.empty();
+	size_t
+	capacity() const
+	{ return mask + 1; };
+
+	/**
+	 * @brief	Returns number of messages stored, exact for the consumer thread only.
+	 */
+	size_t
+	size() const {
+		return __atomic_load_n(&enqueue_pos, __ATOMIC_ACQUIRE) -
+				__atomic_load_n(&dequeue_pos, __ATOMIC_ACQUIRE);
 	};
 
 	/**
 	 *
 	 */
+	bool
+	empty() const {
+		size_t pos = __atomic_load_n(&dequeue_pos, __ATOMIC_ACQUIRE);
+		return (__atomic_load_n(&(cells[pos & mask].seq), __ATOMIC_ACQUIRE) != pos + 1);
+	};
+
+	/**
+	 * @brief	Deletes all messages stored in this queue (consumer only).
+	 */
 	void
 	clear() {
-		RwLock rwlock(queuelock, RwLock::RWLOCK_WRITE);
-		while (not queue.empty()) {
-			delete queue.front();
-			queue.pop_front();
+		rofl::openflow::cofmsg* msg = (rofl::openflow::cofmsg*)0;
+		while ((msg = retrieve()) != NULL) {
+			delete msg;
 		}
 	};
 
 	/**
+	 * @brief	Appends a message to the queue (thread-safe, lock-free).
 	 *
+	 * @return number of messages in queue after storing msg
+	 * @throws eRofQueueFull when the queue is full, msg is not consumed in this case
 	 */
 	size_t
 	store(rofl::openflow::cofmsg* msg) {
-		RwLock rwlock(queuelock, RwLock::RWLOCK_WRITE);
-		rofl::logging::trace << "[rofl-common][crofqueue][store] msg: " << std::endl << *msg;
-		queue.push_back(msg);
-		return queue.size();
+		size_t pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+		cell_t* cell;
+		while (true) {
+			cell = &cells[pos & mask];
+			size_t seq = __atomic_load_n(&(cell->seq), __ATOMIC_ACQUIRE);
+			intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+			if (0 == diff) {
+				// slot is free, try to claim it
+				if (__atomic_compare_exchange_n(&enqueue_pos, &pos, pos + 1,
+						true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+					break;
+				}
+			} else if (diff < 0) {
+				// slot still occupied from previous lap
+				throw eRofQueueFull();
+			} else {
+				pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+			}
+		}
+		cell->msg = msg;
+		cell->stamp = now();
+		__atomic_store_n(&(cell->seq), pos + 1, __ATOMIC_RELEASE);
+		return pos + 1 - __atomic_load_n(&dequeue_pos, __ATOMIC_ACQUIRE);
 	};
 
 	/**
-	 *
+	 * @brief	Removes and returns first message in queue or NULL (consumer only).
 	 */
 	rofl::openflow::cofmsg*
 	retrieve() {
-		rofl::openflow::cofmsg* msg = (rofl::openflow::cofmsg*)0;
-		RwLock rwlock(queuelock, RwLock::RWLOCK_WRITE);
-		if (queue.empty()) {
-			return msg;
+		rofl::openflow::cofmsg* msg = front();
+		if (msg) {
+			release();
 		}
-		msg = queue.front(); queue.pop_front();
-		rofl::logging::trace << "[rofl-common][crofqueue][retrieve] msg: " << std::endl << *msg;
 		return msg;
 	};
 
 	/**
-	 *
+	 * @brief	Returns first message in queue without removing it or NULL (consumer only).
 	 */
 	rofl::openflow::cofmsg*
 	front() {
-		rofl::openflow::cofmsg* msg = (rofl::openflow::cofmsg*)0;
-		RwLock rwlock(queuelock, RwLock::RWLOCK_READ);
-		if (queue.empty()) {
-			return msg;
+		size_t pos = dequeue_pos;
+		cell_t* cell = &cells[pos & mask];
+		if (__atomic_load_n(&(cell->seq), __ATOMIC_ACQUIRE) != pos + 1) {
+			return (rofl::openflow::cofmsg*)0;
 		}
-		msg = queue.front();
-		rofl::logging::trace << "[rofl-common][crofqueue][front] msg: " << std::endl << *msg;
-		return msg;
+		return cell->msg;
 	};
 
 	/**
-	 *
+	 * @brief	Returns enqueue time of first message in nanoseconds on CLOCK_MONOTONIC or 0 (consumer only).
+	 */
+	uint64_t
+	front_stamp() const {
+		size_t pos = dequeue_pos;
+		cell_t const* cell = &cells[pos & mask];
+		if (__atomic_load_n(&(cell->seq), __ATOMIC_ACQUIRE) != pos + 1) {
+			return 0;
+		}
+		return cell->stamp;
+	};
+
+	/**
+	 * @brief	Returns current time in nanoseconds on CLOCK_MONOTONIC.
+	 */
+	static uint64_t
+	now() {
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	};
+
+	/**
+	 * @brief	Removes first message from queue without deleting it (consumer only).
 	 */
 	void
 	pop() {
-		RwLock rwlock(queuelock, RwLock::RWLOCK_WRITE);
-		if (queue.empty()) {
+		size_t pos = dequeue_pos;
+		if (__atomic_load_n(&(cells[pos & mask].seq), __ATOMIC_ACQUIRE) != pos + 1) {
 			return;
 		}
-		queue.pop_front();
-		rofl::logging::trace << "[rofl-common][crofqueue][pop] " << std::endl;
+		release();
 	};
 
 public:
 
 	friend std::ostream&
 	operator<< (std::ostream& os, const crofqueue& queue) {
-		RwLock rwlock(queue.queuelock, RwLock::RWLOCK_READ);
-		os << rofl::indent(0) << "<crofqueue size #" << queue.queue.size() << " >" << std::endl;
+		os << rofl::indent(0) << "<crofqueue size #" << queue.size() << " capacity #" << queue.capacity() << " >" << std::endl;
 		rofl::indent i(2);
-		for (std::list<rofl::openflow::cofmsg*>::const_iterator
-				it = queue.queue.begin(); it != queue.queue.end(); ++it) {
-			os << *(*it);
+		for (size_t pos = queue.dequeue_pos; ; ++pos) {
+			cell_t const& cell = queue.cells[pos & queue.mask];
+			if (__atomic_load_n(&(cell.seq), __ATOMIC_ACQUIRE) != pos + 1)
+				break;
+			os << *(cell.msg);
 		}
 		return os;
 	};
 
 private:
 
-	std::list<rofl::openflow::cofmsg*> 	queue;
-	mutable PthreadRwLock				queuelock;
+	/**
+	 *
+	 */
+	void
+	initialize(
+			size_t capacity) {
+		size_t size = 2;
+		while (size < capacity) {
+			size <<= 1;
+		}
+		mask = size - 1;
+		cells = new cell_t[size];
+		for (size_t i = 0; i < size; i++) {
+			cells[i].seq = i;
+			cells[i].msg = (rofl::openflow::cofmsg*)0;
+			cells[i].stamp = 0;
+		}
+		enqueue_pos = dequeue_pos = 0;
+	};
+
+	/**
+	 * @brief	Hands slot at dequeue_pos back to producers.
+	 */
+	void
+	release() {
+		size_t pos = dequeue_pos;
+		cell_t* cell = &cells[pos & mask];
+		cell->msg = (rofl::openflow::cofmsg*)0;
+		__atomic_store_n(&(cell->seq), pos + mask + 1, __ATOMIC_RELEASE);
+		__atomic_store_n(&dequeue_pos, pos + 1, __ATOMIC_RELEASE);
+	};
+
+private:
+
+	struct cell_t {
+		size_t						seq;
+		rofl::openflow::cofmsg*		msg;
+		uint64_t					stamp;	// enqueue time
+	};
+
+	static size_t const CACHELINE_SIZE = 64;
+
+	size_t							mask;
+	cell_t*							cells;
+	char							pad0[CACHELINE_SIZE];
+	// next slot to be claimed by a producer
+	size_t							enqueue_pos;
+	char							pad1[CACHELINE_SIZE];
+	// next slot to be read by the consumer
+	size_t							dequeue_pos;
+	char							pad2[CACHELINE_SIZE];
 };
 
 }; // end of namespace rofl
@@ -0,0 +1,283 @@
+/*
+ * crofsched.cc
+ */
+
+#include "crofsched.h"
+
+using namespace rofl;
+
+/*static*/size_t const crofsched::DRR_QUANTUM;
+/*static*/uint64_t const crofsched_wfq::WFQ_SCALE;
+
+
+
+/*static*/crofsched*
+crofsched::create(
+		enum crofsched_type_t type,
+		unsigned int num_queues)
+{
+	if (0 == num_queues) {
+		throw eRofSchedInval("crofsched::create() no queues");
+	}
+	switch (type) {
+	case SCHED_WRR: {
+		return new crofsched_wrr(num_queues);
+	} break;
+	case SCHED_PRIORITY: {
+		return new crofsched_priority(num_queues);
+	} break;
+	case SCHED_DRR: {
+		return new crofsched_drr(num_queues);
+	} break;
+	case SCHED_WFQ: {
+		return new crofsched_wfq(num_queues);
+	} break;
+	default: {
+		throw eRofSchedInval("crofsched::create() invalid scheduler type");
+	};
+	}
+}
+
+
+
+/*static*/const char*
+crofsched::type2str(
+		enum crofsched_type_t type)
+{
+	switch (type) {
+	case SCHED_WRR:			return "wrr";
+	case SCHED_PRIORITY:	return "priority";
+	case SCHED_DRR:			return "drr";
+	case SCHED_WFQ:			return "wfq";
+	default:				return "unknown";
+	}
+}
+
+
+
+crofsched::crofsched(
+		enum crofsched_type_t type,
+		unsigned int num_queues) :
+				type(type),
+				weights(num_queues, 1),
+				stats(num_queues)
+{}
+
+
+
+void
+crofsched::set_weight(
+		unsigned int queue_id,
+		unsigned int weight)
+{
+	if (queue_id >= weights.size()) {
+		throw eRofSchedInval("crofsched::set_weight() invalid queue_id");
+	}
+	__atomic_store_n(&weights[queue_id], (0 == weight) ? 1 : weight, __ATOMIC_RELAXED);
+}
+
+
+
+unsigned int
+crofsched::get_weight(
+		unsigned int queue_id) const
+{
+	if (queue_id >= weights.size()) {
+		throw eRofSchedInval("crofsched::get_weight() invalid queue_id");
+	}
+	return weight(queue_id);
+}
+
+
+
+unsigned int
+crofsched::get_weights_sum() const
+{
+	unsigned int sum = 0;
+	for (unsigned int queue_id = 0; queue_id < weights.size(); queue_id++) {
+		sum += weight(queue_id);
+	}
+	return sum;
+}
+
+
+
+void
+crofsched::account(
+		unsigned int queue_id,
+		size_t len,
+		uint64_t delay,
+		size_t depth)
+{
+	if (queue_id >= stats.size())
+		return;
+	crofsched_stats& s = stats[queue_id];
+	__atomic_add_fetch(&s.msgs, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&s.bytes, len, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&s.delay_sum, delay, __ATOMIC_RELAXED);
+	// single writer, no compare-and-swap required for maxima
+	if (delay > __atomic_load_n(&s.delay_max, __ATOMIC_RELAXED))
+		__atomic_store_n(&s.delay_max, delay, __ATOMIC_RELAXED);
+	if (depth > __atomic_load_n(&s.depth_max, __ATOMIC_RELAXED))
+		__atomic_store_n(&s.depth_max, (uint64_t)depth, __ATOMIC_RELAXED);
+}
+
+
+
+crofsched_stats
+crofsched::get_stats(
+		unsigned int queue_id) const
+{
+	if (queue_id >= stats.size()) {
+		throw eRofSchedInval("crofsched::get_stats() invalid queue_id");
+	}
+	const crofsched_stats& s = stats[queue_id];
+	crofsched_stats result;
+	result.msgs			= __atomic_load_n(&s.msgs, __ATOMIC_RELAXED);
+	result.bytes		= __atomic_load_n(&s.bytes, __ATOMIC_RELAXED);
+	result.delay_sum	= __atomic_load_n(&s.delay_sum, __ATOMIC_RELAXED);
+	result.delay_max	= __atomic_load_n(&s.delay_max, __ATOMIC_RELAXED);
+	result.depth_max	= __atomic_load_n(&s.depth_max, __ATOMIC_RELAXED);
+	return result;
+}
+
+
+
+void
+crofsched::clear_stats()
+{
+	for (unsigned int queue_id = 0; queue_id < stats.size(); queue_id++) {
+		crofsched_stats& s = stats[queue_id];
+		__atomic_store_n(&s.msgs, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&s.bytes, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&s.delay_sum, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&s.delay_max, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&s.depth_max, 0, __ATOMIC_RELAXED);
+	}
+}
+
+
+
+void
+crofsched::assign(
+		const crofsched& sched)
+{
+	for (unsigned int queue_id = 0;
+			(queue_id < weights.size()) && (queue_id < sched.weights.size()); queue_id++) {
+		set_weight(queue_id, sched.weight(queue_id));
+		crofsched_stats s(sched.get_stats(queue_id));
+		__atomic_store_n(&stats[queue_id].msgs, s.msgs, __ATOMIC_RELAXED);
+		__atomic_store_n(&stats[queue_id].bytes, s.bytes, __ATOMIC_RELAXED);
+		__atomic_store_n(&stats[queue_id].delay_sum, s.delay_sum, __ATOMIC_RELAXED);
+		__atomic_store_n(&stats[queue_id].delay_max, s.delay_max, __ATOMIC_RELAXED);
+		__atomic_store_n(&stats[queue_id].depth_max, s.depth_max, __ATOMIC_RELAXED);
+	}
+}
+
+
+
+int
+crofsched_wrr::select(
+		const size_t* backlog)
+{
+	unsigned int num_queues = get_num_queues();
+	// checks each queue once with a fresh round budget
+	for (unsigned int i = 0; i <= num_queues; i++) {
+		if ((backlog[current] > 0) && (served < weight(current))) {
+			served++;
+			return current;
+		}
+		current = (current + 1) % num_queues;
+		served = 0;
+	}
+	return -1;
+}
+
+
+
+int
+crofsched_priority::select(
+		const size_t* backlog)
+{
+	int queue_id = -1;
+	unsigned int prio = 0;
+	for (unsigned int i = 0; i < get_num_queues(); i++) {
+		if (0 == backlog[i])
+			continue;
+		if ((queue_id < 0) || (weight(i) > prio)) {
+			queue_id = i;
+			prio = weight(i);
+		}
+	}
+	return queue_id;
+}
+
+
+
+int
+crofsched_drr::select(
+		const size_t* backlog)
+{
+	unsigned int num_queues = get_num_queues();
+
+	bool backlogged = false;
+	for (unsigned int i = 0; i < num_queues; i++) {
+		if (backlog[i] > 0) {
+			backlogged = true;
+		} else {
+			deficits[i] = 0;
+		}
+	}
+	if (not backlogged)
+		return -1;
+
+	// terminates, as the deficit of a backlogged queue grows with every round
+	while (true) {
+		if (backlog[current] > 0) {
+			if (not credited) {
+				deficits[current] += weight(current) * DRR_QUANTUM;
+				credited = true;
+			}
+			if (backlog[current] <= deficits[current]) {
+				deficits[current] -= backlog[current];
+				return current;
+			}
+		} else {
+			deficits[current] = 0;
+		}
+		current = (current + 1) % num_queues;
+		credited = false;
+	}
+	return -1;
+}
+
+
+
+int
+crofsched_wfq::select(
+		const size_t* backlog)
+{
+	int queue_id = -1;
+	uint64_t finish = 0;
+	for (unsigned int i = 0; i < get_num_queues(); i++) {
+		if (0 == backlog[i]) {
+			backlogged[i] = false;
+			continue;
+		}
+		if (not backlogged[i]) {
+			// queue becomes backlogged, start at current virtual time
+			starts[i] = (starts[i] > vtime) ? starts[i] : vtime;
+			backlogged[i] = true;
+		}
+		uint64_t f = starts[i] + (backlog[i] * WFQ_SCALE) / weight(i);
+		if ((queue_id < 0) || (f < finish)) {
+			queue_id = i;
+			finish = f;
+		}
+	}
+	if (queue_id >= 0) {
+		vtime = finish;
+		starts[queue_id] = finish;
+	}
+	return queue_id;
+}
@@ -0,0 +1,347 @@
+/*
+ * crofsched.h
+ */
+
+#ifndef CROFSCHED_H_
+#define CROFSCHED_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <vector>
+#include <ostream>
+
+#include "rofl/common/croflexception.h"
+#include "rofl/common/logging.h"
+
+namespace rofl {
+
+class eRofSchedBase 		: public RoflException {
+public:
+	eRofSchedBase(const std::string& __arg = std::string("eRofSchedBase")) : RoflException(__arg) {};
+};
+class eRofSchedInval 		: public eRofSchedBase {
+public:
+	eRofSchedInval(const std::string& __arg = std::string("eRofSchedInval")) : eRofSchedBase(__arg) {};
+};
+
+/**
+ * @ingroup common_devel_workflow
+ * @brief	Metrics of a queue served by a rofl::crofsched instance
+ */
+struct crofsched_stats {
+	uint64_t		msgs;			// messages dequeued
+	uint64_t		bytes;			// bytes dequeued
+	uint64_t		delay_sum;		// sum of queueing delays in nanoseconds
+	uint64_t		delay_max;		// max. queueing delay in nanoseconds
+	uint64_t		depth_max;		// max. queue depth seen when dequeuing
+
+	crofsched_stats() :
+		msgs(0), bytes(0), delay_sum(0), delay_max(0), depth_max(0)
+	{};
+
+	/**
+	 * @brief	Returns mean queueing delay in nanoseconds.
+	 */
+	uint64_t
+	get_delay_avg() const
+	{ return (0 == msgs) ? 0 : delay_sum / msgs; };
+
+	/**
+	 * @brief	Merges metrics of another queue, e.g., for all connections of a channel.
+	 */
+	crofsched_stats&
+	operator+= (
+			const crofsched_stats& stats) {
+		msgs += stats.msgs;
+		bytes += stats.bytes;
+		delay_sum += stats.delay_sum;
+		delay_max = (stats.delay_max > delay_max) ? stats.delay_max : delay_max;
+		depth_max = (stats.depth_max > depth_max) ? stats.depth_max : depth_max;
+		return *this;
+	};
+
+	friend std::ostream&
+	operator<< (std::ostream& os, const crofsched_stats& stats) {
+		os << rofl::indent(0) << "<crofsched_stats msgs: " << stats.msgs << " bytes: " << stats.bytes
+				<< " delay-avg: " << stats.get_delay_avg() << "ns delay-max: " << stats.delay_max
+				<< "ns depth-max: " << stats.depth_max << " >" << std::endl;
+		return os;
+	};
+};
+
+/**
+ * @ingroup common_devel_workflow
+ * @brief	Scheduler selecting the next queue to be served among a fixed number of queues
+ *
+ * Base class for scheduling disciplines used by rofl::crofsock for its
+ * transmit queues and by rofl::crofconn for its receive queues. A consumer
+ * passes the length of the head-of-line message of each queue (0 for an
+ * empty queue) to select() and dequeues the head of the queue returned.
+ *
+ * Each queue has a weight, its meaning depends on the discipline:
+ * - SCHED_WRR: messages per round (weighted round robin, default)
+ * - SCHED_PRIORITY: priority, the non-empty queue with the highest weight is served first
+ * - SCHED_DRR: quantum of weight * DRR_QUANTUM bytes per round (deficit round robin)
+ * - SCHED_WFQ: share of bandwidth (self-clocked weighted fair queueing)
+ *
+ * Weights may be changed by any thread at any time, select() and account()
+ * must be called by the consumer thread only. Metrics are updated by
+ * account() and may be read by any thread.
+ */
+class crofsched {
+public:
+
+	enum crofsched_type_t {
+		SCHED_WRR			= 0,
+		SCHED_PRIORITY		= 1,
+		SCHED_DRR			= 2,
+		SCHED_WFQ			= 3,
+	};
+
+	/**
+	 * @brief	Bytes per weight unit and round for SCHED_DRR
+	 */
+	static size_t const DRR_QUANTUM = 1500;
+
+	/**
+	 * @brief	Creates a scheduler of given type for num_queues queues with weight 1 each.
+	 *
+	 * @throws eRofSchedInval for an unknown type
+	 */
+	static crofsched*
+	create(
+			enum crofsched_type_t type,
+			unsigned int num_queues);
+
+public:
+
+	/**
+	 *
+	 */
+	crofsched(
+			enum crofsched_type_t type,
+			unsigned int num_queues);
+
+	/**
+	 *
+	 */
+	virtual
+	~crofsched()
+	{};
+
+	/**
+	 *
+	 */
+	enum crofsched_type_t
+	get_type() const
+	{ return type; };
+
+	/**
+	 *
+	 */
+	unsigned int
+	get_num_queues() const
+	{ return weights.size(); };
+
+	/**
+	 * @brief	Sets weight of queue_id, a weight of 0 is treated as 1.
+	 *
+	 * @throws eRofSchedInval for an invalid queue_id
+	 */
+	void
+	set_weight(
+			unsigned int queue_id,
+			unsigned int weight);
+
+	/**
+	 * @throws eRofSchedInval for an invalid queue_id
+	 */
+	unsigned int
+	get_weight(
+			unsigned int queue_id) const;
+
+	/**
+	 * @brief	Returns the sum of all weights, used by consumers as budget of messages per round.
+	 */
+	unsigned int
+	get_weights_sum() const;
+
+	/**
+	 * @brief	Selects the queue to be served next and accounts its head-of-line message as served.
+	 *
+	 * @param backlog length of head-of-line message in bytes for each queue, 0 for an empty queue
+	 * @return queue to dequeue the head-of-line message from or -1 when all queues are empty
+	 */
+	virtual int
+	select(
+			const size_t* backlog) = 0;
+
+	/**
+	 * @brief	Updates metrics of queue_id after dequeuing a message.
+	 *
+	 * @param len message length in bytes
+	 * @param delay time spent in queue in nanoseconds
+	 * @param depth queue depth before dequeuing
+	 */
+	void
+	account(
+			unsigned int queue_id,
+			size_t len,
+			uint64_t delay,
+			size_t depth);
+
+	/**
+	 * @throws eRofSchedInval for an invalid queue_id
+	 */
+	crofsched_stats
+	get_stats(
+			unsigned int queue_id) const;
+
+	/**
+	 *
+	 */
+	void
+	clear_stats();
+
+	/**
+	 * @brief	Copies weights and metrics of another scheduler, e.g., when replacing it.
+	 */
+	void
+	assign(
+			const crofsched& sched);
+
+	/**
+	 * @brief	Returns a name for type.
+	 */
+	static const char*
+	type2str(
+			enum crofsched_type_t type);
+
+protected:
+
+	/**
+	 *
+	 */
+	unsigned int
+	weight(
+			unsigned int queue_id) const
+	{ return __atomic_load_n(&weights[queue_id], __ATOMIC_RELAXED); };
+
+private:
+
+	crofsched(
+			const crofsched& sched);
+
+	crofsched&
+	operator= (
+			const crofsched& sched);
+
+private:
+
+	enum crofsched_type_t			type;
+	std::vector<unsigned int>		weights;
+	std::vector<crofsched_stats>	stats;
+};
+
+
+
+/**
+ * @brief	Weighted round robin, serves up to weight messages per queue and round in queue order
+ */
+class crofsched_wrr : public crofsched {
+public:
+
+	crofsched_wrr(
+			unsigned int num_queues) :
+				crofsched(SCHED_WRR, num_queues),
+				current(0),
+				served(0)
+	{};
+
+	virtual int
+	select(
+			const size_t* backlog);
+
+private:
+
+	unsigned int					current;	// queue currently served
+	unsigned int					served;		// messages served from current queue in this round
+};
+
+
+
+/**
+ * @brief	Strict priority, serves the non-empty queue with the highest weight, lower index on ties
+ */
+class crofsched_priority : public crofsched {
+public:
+
+	crofsched_priority(
+			unsigned int num_queues) :
+				crofsched(SCHED_PRIORITY, num_queues)
+	{};
+
+	virtual int
+	select(
+			const size_t* backlog);
+};
+
+
+
+/**
+ * @brief	Deficit round robin, serves up to weight * DRR_QUANTUM bytes per queue and round
+ */
+class crofsched_drr : public crofsched {
+public:
+
+	crofsched_drr(
+			unsigned int num_queues) :
+				crofsched(SCHED_DRR, num_queues),
+				current(0),
+				credited(false),
+				deficits(num_queues, 0)
+	{};
+
+	virtual int
+	select(
+			const size_t* backlog);
+
+private:
+
+	unsigned int					current;	// queue currently served
+	bool							credited;	// current queue has received its quantum in this round
+	std::vector<size_t>				deficits;
+};
+
+
+
+/**
+ * @brief	Self-clocked weighted fair queueing, serves the head-of-line message with the smallest virtual finish time
+ */
+class crofsched_wfq : public crofsched {
+public:
+
+	crofsched_wfq(
+			unsigned int num_queues) :
+				crofsched(SCHED_WFQ, num_queues),
+				vtime(0),
+				starts(num_queues, 0),
+				backlogged(num_queues, false)
+	{};
+
+	virtual int
+	select(
+			const size_t* backlog);
+
+private:
+
+	static uint64_t const			WFQ_SCALE = 65536;
+
+	uint64_t						vtime;		// finish time of message served last
+	std::vector<uint64_t>			starts;		// virtual start time of head-of-line message
+	std::vector<bool>				backlogged;
+};
+
+}; // end of namespace rofl
+
+#endif /* CROFSCHED_H_ */
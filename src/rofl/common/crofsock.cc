@@ -11,24 +11,30 @@ using namespace rofl;
 
 crofsock::crofsock(
 		crofsock_env *env,
-		pthread_t tid) :
+		pthread_t tid,
+		size_t txqueue_capacity) :
 				ciosrv(tid),
 				env(env),
 				socket(NULL),
 				state(STATE_INIT),
-				fragment((cmemory*)0),
-				msg_bytes_read(0),
+				rxbuf(DEFAULT_RXBUF_SIZE),
+				rxlen(0),
 				max_pkts_rcvd_per_round(DEFAULT_MAX_PKTS_RVCD_PER_ROUND),
-				txqueues(QUEUE_MAX, crofqueue()),
-				txweights(QUEUE_MAX, 1),
+				txqueues(QUEUE_MAX, crofqueue(txqueue_capacity + TXQUEUE_CONTROL_RESERVE)),
+				txqueue_capacity(txqueue_capacity),
+				txsched(crofsched::create(crofsched::SCHED_WRR, QUEUE_MAX)),
+				txbuf(DEFAULT_MAX_TX_BATCH_SIZE),
+				txbuflen(0),
+				clear_pending(0),
+				max_tx_batch_size(DEFAULT_MAX_TX_BATCH_SIZE),
 				socket_type(rofl::csocket::SOCKET_TYPE_UNKNOWN),
 				sd(-1)
 {
 	// scheduler weights for transmission
-	txweights[QUEUE_OAM ] = 4;
-	txweights[QUEUE_MGMT] = 8;
-	txweights[QUEUE_FLOW] = 4;
-	txweights[QUEUE_PKT ] = 2;
+	txsched->set_weight(QUEUE_OAM , 4);
+	txsched->set_weight(QUEUE_MGMT, 8);
+	txsched->set_weight(QUEUE_FLOW, 4);
+	txsched->set_weight(QUEUE_PKT , 2);
 	rofl::logging::debug2 << "[rofl-common][crofsock] "
 			<< "constructor " << std::hex << this << std::dec
 			<< ", target tid: " << std::hex << get_thread_id() << std::dec
@@ -45,98 +51,171 @@ crofsock::~crofsock()
 			<< ", target tid: " << std::hex << get_thread_id() << std::dec
 			<< ", running tid: " << std::hex << pthread_self() << std::dec
 			<< std::endl;
-	if (fragment)
-		delete fragment;
 	if (socket)
 		delete socket;
+	delete txsched;
 }
 
 
 
-unsigned int
-crofsock::send_message(
-		rofl::openflow::cofmsg *msg)
+void
+crofsock::set_tx_scheduler(
+		enum crofsched::crofsched_type_t type)
 {
-	unsigned int cwnd_size = 1;
+	crofsched* sched = crofsched::create(type, QUEUE_MAX); // may throw
+	RwLock rwlock(txsched_lock, RwLock::RWLOCK_WRITE);
+	sched->assign(*txsched);
+	delete txsched;
+	txsched = sched;
+}
 
-	if (NULL == msg) {
-		return cwnd_size;
-	}
 
-	if (not socket->is_established()) {
-		delete msg; return 0;
-	}
 
-	log_message(std::string("queueing message for sending:"), *msg);
+/*static*/unsigned int
+crofsock::get_tx_queue_id(
+		uint8_t version,
+		uint8_t type)
+{
+	unsigned int queue_id = QUEUE_MGMT;
 
-	switch (msg->get_version()) {
+	switch (version) {
 	case rofl::openflow10::OFP_VERSION: {
-		switch (msg->get_type()) {
+		switch (type) {
 		case rofl::openflow10::OFPT_PACKET_IN:
 		case rofl::openflow10::OFPT_PACKET_OUT: {
-			txqueues[QUEUE_PKT].store(msg);
+			queue_id = QUEUE_PKT;
 		} break;
 		case rofl::openflow10::OFPT_FLOW_MOD:
 		case rofl::openflow10::OFPT_FLOW_REMOVED: {
-			txqueues[QUEUE_FLOW].store(msg);
+			queue_id = QUEUE_FLOW;
 		} break;
 		case rofl::openflow10::OFPT_ECHO_REQUEST:
 		case rofl::openflow10::OFPT_ECHO_REPLY: {
-			txqueues[QUEUE_OAM].store(msg);
+			queue_id = QUEUE_OAM;
 		} break;
 		default: {
-			txqueues[QUEUE_MGMT].store(msg);
+			queue_id = QUEUE_MGMT;
 		};
 		}
 	} break;
 	case rofl::openflow12::OFP_VERSION: {
-		switch (msg->get_type()) {
+		switch (type) {
 		case rofl::openflow12::OFPT_PACKET_IN:
 		case rofl::openflow12::OFPT_PACKET_OUT: {
-			txqueues[QUEUE_PKT].store(msg);
+			queue_id = QUEUE_PKT;
 		} break;
 		case rofl::openflow12::OFPT_FLOW_MOD:
 		case rofl::openflow12::OFPT_FLOW_REMOVED:
 		case rofl::openflow12::OFPT_GROUP_MOD:
 		case rofl::openflow12::OFPT_PORT_MOD:
 		case rofl::openflow12::OFPT_TABLE_MOD: {
-			txqueues[QUEUE_FLOW].store(msg);
+			queue_id = QUEUE_FLOW;
 		} break;
 		case rofl::openflow12::OFPT_ECHO_REQUEST:
 		case rofl::openflow12::OFPT_ECHO_REPLY: {
-			txqueues[QUEUE_OAM].store(msg);
+			queue_id = QUEUE_OAM;
 		} break;
 		default: {
-			txqueues[QUEUE_MGMT].store(msg);
+			queue_id = QUEUE_MGMT;
 		};
 		}
 	} break;
 	case rofl::openflow13::OFP_VERSION: {
-		switch (msg->get_type()) {
+		switch (type) {
 		case rofl::openflow13::OFPT_PACKET_IN:
 		case rofl::openflow13::OFPT_PACKET_OUT: {
-			txqueues[QUEUE_PKT].store(msg);
+			queue_id = QUEUE_PKT;
 		} break;
 		case rofl::openflow13::OFPT_FLOW_MOD:
 		case rofl::openflow13::OFPT_FLOW_REMOVED:
 		case rofl::openflow13::OFPT_GROUP_MOD:
 		case rofl::openflow13::OFPT_PORT_MOD:
 		case rofl::openflow13::OFPT_TABLE_MOD: {
-			txqueues[QUEUE_FLOW].store(msg);
+			queue_id = QUEUE_FLOW;
 		} break;
 		case rofl::openflow13::OFPT_ECHO_REQUEST:
 		case rofl::openflow13::OFPT_ECHO_REPLY: {
-			txqueues[QUEUE_OAM].store(msg);
+			queue_id = QUEUE_OAM;
 		} break;
 		default: {
-			txqueues[QUEUE_MGMT].store(msg);
+			queue_id = QUEUE_MGMT;
 		};
 		}
 	} break;
 	default: {
+		queue_id = QUEUE_MAX;
+	};
+	}
+
+	return queue_id;
+}
+
+
+
+size_t
+crofsock::get_txqueue_space(
+		uint8_t version,
+		uint8_t type) const
+{
+	unsigned int queue_id = get_tx_queue_id(version, type);
+	if (QUEUE_MAX == queue_id) {
+		return 0;
+	}
+	size_t size = txqueues[queue_id].size();
+	return (size < txqueue_capacity) ? txqueue_capacity - size : 0;
+}
+
+
+
+unsigned int
+crofsock::enqueue_message(
+		rofl::openflow::cofmsg *msg,
+		bool control)
+{
+	unsigned int cwnd_size = 1;
+
+	if (NULL == msg) {
+		return cwnd_size;
+	}
+
+	if (not socket->is_established()) {
+		delete msg; return 0;
+	}
+
+	if (ROFL_LOG_ENABLED(rofl::logging::DBG2))
+		log_message(std::string("queueing message for sending:"), *msg);
+
+	unsigned int queue_id = get_tx_queue_id(msg->get_version(), msg->get_type());
+
+	if (QUEUE_MAX == queue_id) {
 		rofl::logging::alert << "[rofl-common][crofsock] dropping message with unsupported OpenFlow version" << std::endl;
 		delete msg; return 0;
-	};
+	}
+
+	crofqueue& txqueue = txqueues[queue_id];
+
+	// regular messages may fill txqueue_capacity slots, the remaining ones are reserved for control messages
+	if ((not control) && (txqueue.size() >= txqueue_capacity)) {
+		ROFL_DEBUG2 << "[rofl-common][crofsock] txqueue[" << queue_id << "] full, "
+				<< "rejecting message, xid: 0x" << std::hex << msg->get_xid() << std::dec << std::endl;
+		rofl::ciosrv::notify(EVENT_CONGESTION_SOLVED);
+		throw eRofSockTxQueueFull();
+	}
+
+	try {
+		txqueue.store(msg);
+	} catch (eRofQueueFull& e) {
+		if (not control) {
+			// reserve has been claimed by control messages in the meantime
+			rofl::ciosrv::notify(EVENT_CONGESTION_SOLVED);
+			throw eRofSockTxQueueFull();
+		}
+		// peer does not read from the socket at all
+		rofl::logging::error << "[rofl-common][crofsock] txqueue[" << queue_id << "] reserve for control messages exhausted, "
+				<< "closing connection, xid: 0x" << std::hex << msg->get_xid() << std::dec << std::endl;
+		delete msg;
+		close();
+		return 0;
 	}
 
 	rofl::ciosrv::notify(EVENT_CONGESTION_SOLVED);
@@ -152,51 +231,59 @@ crofsock::send_message(
 void
 crofsock::send_from_queue()
 {
-	bool reschedule = false;
+	if (__atomic_load_n(&clear_pending, __ATOMIC_ACQUIRE)) {
+		// messages queued for a connection closed from another thread
+		clear_queues();
+	}
 
-	for (unsigned int queue_id = 0; queue_id < QUEUE_MAX; ++queue_id) {
+	if (flags.test(FLAGS_CONGESTED)) {
+		// wait for socket to become writable again, messages remain in txqueues
+		return;
+	}
 
-		for (unsigned int num = 0; num < txweights[queue_id]; ++num) {
+	// a batch not accepted by the socket is resent before taking further messages from txqueues
+	if (0 == txbuflen) {
+		fill_txbuf();
+	}
 
-			cmemory *mem = (cmemory*)0;
+	if (0 == txbuflen) {
+		return;
+	}
 
-			try {
-				rofl::openflow::cofmsg *msg = txqueues[queue_id].front();
-				if (NULL == msg)
-					break;
+	try {
 
-				mem = new cmemory(msg->length());
-				msg->pack(mem->somem(), mem->memlen());
+		socket->send_buffer(txbuf.somem(), txbuflen); // may throw exception
 
-				rofl::logging::debug2 << "[rofl-common][crofsock][send-from-queue] msg:"
-						<< std::endl << *msg;
+		txbuflen = 0;
 
-				rofl::logging::debug2 << "[rofl-common][crofsock][send-from-queue] mem:"
-						<< std::endl << *mem;
+	} catch (eSocketTxAgainPacketDropped& e) {
+		// batch has not been accepted, keep it in txbuf
+		rofl::logging::error << "[rofl-common][crofsock][send-from-queue] transport "
+				<< "connection congested, batch deferred." << std::endl;
 
-				socket->send(mem); // may throw exception
+		flags.set(FLAGS_CONGESTED);
 
-				txqueues[queue_id].pop();
-				delete msg;
+	} catch (eSocketTxAgain& e) {
+		// batch has been queued by socket, but further sends must wait
+		rofl::logging::error << "[rofl-common][crofsock][send-from-queue] transport "
+				<< "connection congested, waiting." << std::endl;
 
+		txbuflen = 0;
 
-			} catch (eSocketTxAgain& e) {
-				rofl::logging::error << "[rofl-common][crofsock][send-from-queue] transport "
-						<< "connection congested, waiting." << std::endl;
+		flags.set(FLAGS_CONGESTED);
+	}
 
-				flags.set(FLAGS_CONGESTED);
-			}
-		}
+	if (flags.test(FLAGS_CONGESTED)) {
+		env->handle_write(*this);
+	}
 
+	bool reschedule = false;
+	for (unsigned int queue_id = 0; queue_id < QUEUE_MAX; ++queue_id) {
 		if (not txqueues[queue_id].empty()) {
 			reschedule = true;
 		}
 	}
 
-	if (flags.test(FLAGS_CONGESTED)) {
-		env->handle_write(*this);
-	}
-
 	if (reschedule && not flags.test(FLAGS_CONGESTED)) {
 		rofl::ciosrv::notify(EVENT_CONGESTION_SOLVED);
 	}
@@ -204,6 +291,68 @@ crofsock::send_from_queue()
 
 
 
+void
+crofsock::fill_txbuf()
+{
+	size_t backlog[QUEUE_MAX];
+	size_t num_msgs = 0;
+
+	for (unsigned int queue_id = 0; queue_id < QUEUE_MAX; ++queue_id) {
+		rofl::openflow::cofmsg *msg = txqueues[queue_id].front();
+		backlog[queue_id] = (NULL == msg) ? 0 : msg->length();
+	}
+
+	RwLock rwlock(txsched_lock, RwLock::RWLOCK_READ);
+
+	uint64_t now = crofqueue::now();
+
+	// take messages in scheduler order and pack them back-to-back until batch is full
+	while (txbuflen < max_tx_batch_size) {
+
+		int queue_id = txsched->select(backlog);
+		if (queue_id < 0)
+			break;
+
+		crofqueue& txqueue = txqueues[queue_id];
+		rofl::openflow::cofmsg *msg = txqueue.front();
+		uint64_t stamp = txqueue.front_stamp();
+		size_t depth = txqueue.size();
+		size_t msg_len = backlog[queue_id];
+
+		if (txbuf.memlen() < txbuflen + msg_len) {
+			txbuf.resize(std::max(2 * txbuf.memlen(), txbuflen + msg_len));
+		}
+
+		ROFL_DEBUG2 << "[rofl-common][crofsock][send-from-queue] msg:"
+				<< std::endl << *msg;
+
+		msg->pack(txbuf.somem() + txbuflen, msg_len);
+		txbuflen += msg_len;
+		num_msgs++;
+
+		txqueue.pop();
+		delete msg;
+
+		txsched->account(queue_id, msg_len, (now > stamp) ? now - stamp : 0, depth);
+
+		msg = txqueue.front();
+		backlog[queue_id] = (NULL == msg) ? 0 : msg->length();
+	}
+
+	if (0 == num_msgs) {
+		return;
+	}
+
+	txstats.flushes++;
+	txstats.msgs += num_msgs;
+	txstats.bytes += txbuflen;
+
+	ROFL_DEBUG2 << "[rofl-common][crofsock][send-from-queue] flushing "
+			<< num_msgs << " message(s), " << txbuflen << " bytes" << std::endl;
+}
+
+
+
 void
 crofsock::handle_event(
 		cevent const &ev)
@@ -215,6 +364,14 @@ crofsock::handle_event(
 	case EVENT_CONGESTION_SOLVED: {
 		send_from_queue();
 	} break;
+	case EVENT_RX_PENDING: {
+		if (socket && (STATE_CONNECTED == state)) {
+			handle_read(*socket);
+		}
+	} break;
+	case EVENT_CLEAR_QUEUES: {
+		clear_queues();
+	} break;
 	default:
 		rofl::logging::debug3 << "[rofl-common][crofsock] unknown event type:" << (int)ev.cmd << std::endl;
 	}
@@ -234,70 +391,46 @@ crofsock::handle_read(
 
 	try {
 
-		while (true) {
-
-			if (0 == fragment) {
-				fragment = new cmemory(sizeof(struct openflow::ofp_header));
-				msg_bytes_read = 0;
-			}
+		// deliver complete messages left over from a previous round first
+		if (not frame_messages(pkts_rcvd_in_round)) {
+			return;
+		}
 
-			uint16_t msg_len = 0;
+		while (true) {
 
-			// how many bytes do we have to read?
-			if (msg_bytes_read < sizeof(struct openflow::ofp_header)) {
-				msg_len = sizeof(struct openflow::ofp_header);
-			} else {
-				struct openflow::ofp_header *header = (struct openflow::ofp_header*)fragment->somem();
-				msg_len = be16toh(header->length);
-			}
+			/* space left in rxbuf behind a partial message carried forward from last round */
+			size_t space = rxbuf.memlen() - rxlen;
 
-			// sanity check: 8 <= msg_len <= 2^16
-			if (msg_len < sizeof(struct openflow::ofp_header)) {
-				rofl::logging::warn << "[rofl-common][crofsock] received message with invalid length field, closing socket." << std::endl;
+			if (0 == space) {
+				rofl::logging::warn << "[rofl-common][crofsock] receive buffer exhausted, closing socket." << std::endl;
 				socket.close();
 				return;
 			}
 
-			// resize msg buffer, if necessary
-			if (fragment->memlen() < msg_len) {
-				fragment->resize(msg_len);
+			// read as many bytes as are available, at most "space"
+			ssize_t rc = socket.recv((void*)(rxbuf.somem() + rxlen), space);
+
+			rxstats.syscalls++;
+			rxstats.bytes += rc;
+			rxlen += rc;
+
+			// deliver all complete messages from rxbuf in place
+			if (not frame_messages(pkts_rcvd_in_round)) {
+				return;
 			}
 
-			// read from socket more bytes, at most "msg_len - msg_bytes_read"
-			int rc = socket.recv((void*)(fragment->somem() + msg_bytes_read), msg_len - msg_bytes_read);
-
-			msg_bytes_read += rc;
-
-			// minimum message length received, check completeness of message
-			if (fragment->memlen() >= sizeof(struct openflow::ofp_header)) {
-				struct openflow::ofp_header *header =
-						(struct openflow::ofp_header*)fragment->somem();
-				uint16_t msg_len = be16toh(header->length);
-
-				// ok, message was received completely
-				if (msg_len == msg_bytes_read) {
-					cmemory *mem = fragment;
-					fragment = (cmemory*)0; // just in case, we get an exception from parse_message()
-					msg_bytes_read = 0;
-
-					parse_message(mem);
-
-					pkts_rcvd_in_round++;
-					// read at most max_pkts_rcvd_per_round (default: 16) packets from socket, reschedule afterwards
-					if (pkts_rcvd_in_round >= max_pkts_rcvd_per_round) {
-						rofl::logging::debug2 << "[rofl-common][crofsock] "
-								<< "received " << pkts_rcvd_in_round
-								<< " packet(s) from peer, rescheduling." << std::endl;
-						return;
-					}
-				}
+			// short read on a stream socket: receive queue has been drained, wait for next read event
+			if ((rofl::csocket::SOCKET_TYPE_PLAIN == socket.get_socket_type()) && ((size_t)rc < space)) {
+				break;
 			}
 		}
 
 	} catch (eSocketRxAgain& e) {
 
-		// more bytes are needed, keep pointer to msg in "fragment"
-		rofl::logging::debug2 << "[rofl-common][crofsock] eSocketRxAgain: "
+		rxstats.again++;
+
+		// more bytes are needed, partial message is kept in "rxbuf"
+		ROFL_DEBUG2 << "[rofl-common][crofsock] eSocketRxAgain: "
 				<< "no further data available on socket, read "
 				<< pkts_rcvd_in_round << " packet(s) in this round." << std::endl;
 
@@ -322,6 +455,90 @@ crofsock::handle_read(
 
 
 
+bool
+crofsock::frame_messages(
+		unsigned int& pkts_rcvd_in_round)
+{
+	size_t offset = 0;
+	bool keep_reading = true;
+
+	while ((rxlen - offset) >= sizeof(struct openflow::ofp_header)) {
+
+		struct openflow::ofp_header *header =
+				(struct openflow::ofp_header*)(rxbuf.somem() + offset);
+		uint16_t msg_len = be16toh(header->length);
+
+		// sanity check: 8 <= msg_len <= 2^16
+		if (msg_len < sizeof(struct openflow::ofp_header)) {
+			rofl::logging::warn << "[rofl-common][crofsock] received message with invalid length field, closing socket." << std::endl;
+			rxlen = 0;
+			socket->close();
+			return false;
+		}
+
+		// incomplete message, wait for more bytes
+		if ((rxlen - offset) < msg_len) {
+			break;
+		}
+
+		// environment cannot take further messages, keep this one in rxbuf and stop reading until resumed
+		if (env && not env->recv_ready(*this, header->version, header->type)) {
+			rxstats.stalls++;
+			keep_reading = false;
+			break;
+		}
+
+		uint8_t* msg_buf = rxbuf.somem() + offset;
+		offset += msg_len;
+		rxstats.msgs++;
+
+		// offer a zero-copy view first, allocate and parse only if not consumed by environment
+		bool consumed = false;
+		if (env) {
+			try {
+				consumed = env->recv_message_view(*this, rofl::openflow::cofmsg_view(msg_buf, msg_len));
+			} catch (RoflException& e) {
+				// malformed message, let the regular parser deal with it
+				consumed = false;
+			}
+		}
+
+		if (not consumed) {
+			parse_message(new cmemory(msg_buf, msg_len));
+		} else {
+			rxstats.views++;
+		}
+
+		// socket may have been closed while handling this message
+		if (STATE_CLOSED == state) {
+			rxlen = 0;
+			return false;
+		}
+
+		// read at most max_pkts_rcvd_per_round (default: 16) packets from socket, reschedule afterwards
+		if (++pkts_rcvd_in_round >= max_pkts_rcvd_per_round) {
+			ROFL_DEBUG2 << "[rofl-common][crofsock] "
+					<< "received " << pkts_rcvd_in_round
+					<< " packet(s) from peer, rescheduling." << std::endl;
+			rofl::ciosrv::notify(rofl::cevent(EVENT_RX_PENDING));
+			keep_reading = false;
+			break;
+		}
+	}
+
+	// carry partial tail forward to start of rxbuf
+	if (offset > 0) {
+		if (rxlen > offset) {
+			memmove(rxbuf.somem(), rxbuf.somem() + offset, rxlen - offset);
+		}
+		rxlen -= offset;
+	}
+
+	return keep_reading;
+}
+
+
+
 void
 crofsock::parse_message(
 		cmemory *mem)
@@ -395,6 +612,39 @@ crofsock::parse_message(
 
 
 
+rofl::openflow::cofmsg*
+crofsock::materialize(
+		rofl::openflow::cofmsg_view const& view)
+{
+	cmemory *mem = new cmemory(const_cast<uint8_t*>(view.somem()), view.memlen());
+	rofl::openflow::cofmsg *msg = (rofl::openflow::cofmsg*)0;
+
+	try {
+		switch (view.get_version()) {
+		case rofl::openflow10::OFP_VERSION: {
+			parse_of10_message(mem, &msg);
+		} break;
+		case rofl::openflow12::OFP_VERSION: {
+			parse_of12_message(mem, &msg);
+		} break;
+		case rofl::openflow13::OFP_VERSION: {
+			parse_of13_message(mem, &msg);
+		} break;
+		default: {
+			msg = new rofl::openflow::cofmsg(mem);
+		};
+		}
+	} catch (...) {
+		// msg takes ownership of mem once created
+		if (msg) delete msg; else delete mem;
+		throw;
+	}
+
+	return msg;
+}
+
+
+
 void
 crofsock::parse_of10_message(cmemory *mem, rofl::openflow::cofmsg **pmsg)
 {
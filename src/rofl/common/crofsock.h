@@ -22,6 +22,7 @@
 #include "rofl/common/csocket.h"
 #include "rofl/common/logging.h"
 #include "rofl/common/crofqueue.h"
+#include "rofl/common/crofsched.h"
 #include "rofl/common/thread_helper.h"
 #include "rofl/common/croflexception.h"
 
@@ -62,6 +63,7 @@
 #include "rofl/common/openflow/messages/cofmsg_meter_stats.h"
 #include "rofl/common/openflow/messages/cofmsg_meter_config_stats.h"
 #include "rofl/common/openflow/messages/cofmsg_meter_features_stats.h"
+#include "rofl/common/openflow/messages/cofmsg_view.h"
 
 
 namespace rofl {
@@ -98,11 +100,178 @@ protected:
 
 	virtual void
 	recv_message(crofsock& endpnt, rofl::openflow::cofmsg *msg) = 0;
+
+	/**
+	 * @brief	Offers a received message as zero-copy view before any heap allocation takes place.
+	 *
+	 * Called on the I/O thread of the rofl::crofsock instance. The view
+	 * refers to its receive buffer and is valid during this call only. When returning true, the message
+	 * is considered consumed and no rofl::openflow::cofmsg instance is created.
+	 * When returning false, the message is parsed and handed over via
+	 * recv_message() as usual.
+	 *
+	 * @param endpnt rofl::crofsock instance
+	 * @param view non-owning view on the received message
+	 * @return true when the message has been consumed
+	 */
+	virtual bool
+	recv_message_view(crofsock& endpnt, rofl::openflow::cofmsg_view const& view)
+	{ return false; };
+
+	/**
+	 * @brief	Checks whether the environment is able to take a received message right now.
+	 *
+	 * Called on the I/O thread of the rofl::crofsock instance before a
+	 * message is handed over. When returning false, the message remains
+	 * in the receive buffer and no further bytes are read from the socket,
+	 * so the peer is throttled by TCP flow control. Reading resumes when
+	 * the environment calls crofsock::resume_reading().
+	 *
+	 * @param endpnt rofl::crofsock instance
+	 * @param version OpenFlow version of the pending message
+	 * @param type OpenFlow type of the pending message
+	 * @return false when reading must be suspended
+	 */
+	virtual bool
+	recv_ready(crofsock& endpnt, uint8_t version, uint8_t type)
+	{ return true; };
+};
+
+/**
+ * @ingroup common_devel_workflow
+ * @brief	Counters for the receive path of a rofl::crofsock instance.
+ *
+ * The ratio of framed messages and recv() system calls indicates
+ * how many OpenFlow messages are extracted from a single read
+ * operation on the underlying socket.
+ */
+class crofsock_rx_stats {
+public:
+
+	/**
+	 *
+	 */
+	crofsock_rx_stats() :
+		syscalls(0),
+		again(0),
+		bytes(0),
+		msgs(0),
+		views(0),
+		stalls(0)
+	{};
+
+	/**
+	 *
+	 */
+	void
+	clear()
+	{ syscalls = again = bytes = msgs = views = stalls = 0; };
+
+	/**
+	 * @brief	Returns average number of messages framed per recv() system call.
+	 */
+	double
+	get_msgs_per_syscall() const
+	{ return (0 == syscalls) ? 0.0 : (double)msgs / (double)syscalls; };
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, crofsock_rx_stats const& stats) {
+		os << indent(0) << "<crofsock_rx_stats "
+				<< "#syscalls: " << stats.syscalls << " "
+				<< "#again: " << stats.again << " "
+				<< "#bytes: " << stats.bytes << " "
+				<< "#msgs: " << stats.msgs << " "
+				<< "#views: " << stats.views << " "
+				<< "#stalls: " << stats.stalls << " "
+				<< "msgs/syscall: " << stats.get_msgs_per_syscall() << " >" << std::endl;
+		return os;
+	};
+
+public:
+
+	// number of recv() calls on the socket
+	uint64_t	syscalls;
+	// number of recv() calls returning without any data (EAGAIN)
+	uint64_t	again;
+	// number of bytes received
+	uint64_t	bytes;
+	// number of complete OpenFlow messages framed
+	uint64_t	msgs;
+	// number of messages consumed as zero-copy view without allocation
+	uint64_t	views;
+	// number of times reading was suspended, as the environment could not take further messages
+	uint64_t	stalls;
+};
+
+/**
+ * @ingroup common_devel_workflow
+ * @brief	Counters for the transmit path of a rofl::crofsock instance.
+ *
+ * Queued messages are packed back-to-back into a single buffer and
+ * handed over to the socket as one unit, called a flush.
+ */
+class crofsock_tx_stats {
+public:
+
+	/**
+	 *
+	 */
+	crofsock_tx_stats() :
+		flushes(0),
+		bytes(0),
+		msgs(0)
+	{};
+
+	/**
+	 *
+	 */
+	void
+	clear()
+	{ flushes = bytes = msgs = 0; };
+
+	/**
+	 * @brief	Returns average number of messages per flush.
+	 */
+	double
+	get_msgs_per_flush() const
+	{ return (0 == flushes) ? 0.0 : (double)msgs / (double)flushes; };
+
+	/**
+	 * @brief	Returns average number of bytes per flush.
+	 */
+	double
+	get_bytes_per_flush() const
+	{ return (0 == flushes) ? 0.0 : (double)bytes / (double)flushes; };
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, crofsock_tx_stats const& stats) {
+		os << indent(0) << "<crofsock_tx_stats "
+				<< "#flushes: " << stats.flushes << " "
+				<< "#bytes: " << stats.bytes << " "
+				<< "#msgs: " << stats.msgs << " "
+				<< "msgs/flush: " << stats.get_msgs_per_flush() << " "
+				<< "bytes/flush: " << stats.get_bytes_per_flush() << " >" << std::endl;
+		return os;
+	};
+
+public:
+
+	// number of batches handed over to the socket
+	uint64_t	flushes;
+	// number of bytes handed over to the socket
+	uint64_t	bytes;
+	// number of OpenFlow messages handed over to the socket
+	uint64_t	msgs;
 };
 
 class eRofSockBase			: public RoflException {};
 class eRofSockTxAgain		: public eRofSockBase {};
 class eRofSockMsgTooLarge 	: public eRofSockBase {};
+class eRofSockTxQueueFull	: public eRofSockBase {}; // txqueue full, message has not been consumed
 
 /**
  * @ingroup common_devel_workflow
@@ -112,6 +281,8 @@ class crofsock :
 		public ciosrv,
 		public csocket_env
 {
+public:
+
 	enum outqueue_type_t {
 		QUEUE_OAM  = 0, // Echo.request/Echo.reply
 		QUEUE_MGMT = 1, // all remaining packets, except ...
@@ -120,6 +291,8 @@ class crofsock :
 		QUEUE_MAX,		// do not use
 	};
 
+private:
+
 	enum crofsock_event_t {
 		EVENT_NONE				= 0,
 		EVENT_CONNECT			= 1,
@@ -132,6 +305,8 @@ class crofsock :
 		EVENT_PEER_DISCONNECTED		= 8,
 		EVENT_LOCAL_DISCONNECT		= 9,
 		EVENT_CONGESTION_SOLVED	= 10,
+		EVENT_RX_PENDING		= 11,
+		EVENT_CLEAR_QUEUES		= 12,
 	};
 
 	enum crofsock_flag_t {
@@ -152,7 +327,8 @@ public:
 	 */
 	crofsock(
 			crofsock_env *env,
-			pthread_t tid = 0);
+			pthread_t tid = 0,
+			size_t txqueue_capacity = crofqueue::DEFAULT_CAPACITY);
 
 	/**
 	 *
@@ -216,11 +392,58 @@ public:
 	{ return *socket; /* FIXME */ };
 
 	/**
+	 * @brief	Queues a message for transmission and takes ownership of it.
 	 *
+	 * @return congestion window, 0 when the message has been queued on a congested connection
+	 * @throws eRofSockTxQueueFull when txqueue_capacity messages are waiting in the message's
+	 * txqueue already, msg is not consumed in this case
 	 */
 	unsigned int
 	send_message(
-			rofl::openflow::cofmsg *msg);
+			rofl::openflow::cofmsg *msg)
+	{ return enqueue_message(msg, false); };
+
+	/**
+	 * @brief	Queues a message originating from the protocol machinery, e.g., Hello or Echo.
+	 *
+	 * Control messages may occupy TXQUEUE_CONTROL_RESERVE slots beyond
+	 * txqueue_capacity and are never rejected. A peer not reading
+	 * from the socket until even this reserve is exhausted is disconnected.
+	 */
+	void
+	send_control_message(
+			rofl::openflow::cofmsg *msg)
+	{ enqueue_message(msg, true); };
+
+	/**
+	 * @brief	Returns maximum number of regular messages per txqueue.
+	 */
+	size_t
+	get_txqueue_capacity() const
+	{ return txqueue_capacity; };
+
+	/**
+	 * @brief	Returns number of regular messages the txqueue for messages of this version and type can take.
+	 */
+	size_t
+	get_txqueue_space(
+			uint8_t version,
+			uint8_t type) const;
+
+	/**
+	 * @brief	Returns txqueue for messages of this version and type or QUEUE_MAX for an unsupported version.
+	 */
+	static unsigned int
+	get_tx_queue_id(
+			uint8_t version,
+			uint8_t type);
+
+	/**
+	 * @brief	Resumes reading after crofsock_env::recv_ready() has refused a message (thread-safe).
+	 */
+	void
+	resume_reading()
+	{ rofl::ciosrv::notify(rofl::cevent(EVENT_RX_PENDING)); };
 
 	/**
 	 *
@@ -229,6 +452,108 @@ public:
 	is_established() const
 	{ return socket->is_established(); };
 
+	/**
+	 * @brief	Creates a full rofl::openflow::cofmsg instance from a view.
+	 *
+	 * The message is copied from the view's buffer and parsed. The caller
+	 * takes ownership of the returned object.
+	 *
+	 * @throws eBadRequestBadType, eBadSyntax and friends when parsing fails
+	 */
+	static rofl::openflow::cofmsg*
+	materialize(
+			rofl::openflow::cofmsg_view const& view);
+
+	/**
+	 * @brief	Returns counters for the receive path.
+	 */
+	crofsock_rx_stats const&
+	get_rx_stats() const
+	{ return rxstats; };
+
+	/**
+	 * @brief	Resets counters for the receive path.
+	 */
+	void
+	clear_rx_stats()
+	{ rxstats.clear(); };
+
+	/**
+	 * @brief	Returns counters for the transmit path.
+	 */
+	crofsock_tx_stats const&
+	get_tx_stats() const
+	{ return txstats; };
+
+	/**
+	 * @brief	Resets counters for the transmit path.
+	 */
+	void
+	clear_tx_stats()
+	{ txstats.clear(); };
+
+	/**
+	 * @brief	Replaces the scheduler serving the txqueues, weights and metrics are retained.
+	 *
+	 * @throws eRofSchedInval for an unknown type
+	 */
+	void
+	set_tx_scheduler(
+			enum crofsched::crofsched_type_t type);
+
+	/**
+	 *
+	 */
+	enum crofsched::crofsched_type_t
+	get_tx_scheduler() const {
+		RwLock rwlock(txsched_lock, RwLock::RWLOCK_READ);
+		return txsched->get_type();
+	};
+
+	/**
+	 * @brief	Sets scheduling weight of txqueue queue_id, see rofl::crofsched for its meaning.
+	 *
+	 * @throws eRofSchedInval for an invalid queue_id
+	 */
+	void
+	set_tx_weight(
+			unsigned int queue_id,
+			unsigned int weight) {
+		RwLock rwlock(txsched_lock, RwLock::RWLOCK_READ);
+		txsched->set_weight(queue_id, weight);
+	};
+
+	/**
+	 * @throws eRofSchedInval for an invalid queue_id
+	 */
+	unsigned int
+	get_tx_weight(
+			unsigned int queue_id) const {
+		RwLock rwlock(txsched_lock, RwLock::RWLOCK_READ);
+		return txsched->get_weight(queue_id);
+	};
+
+	/**
+	 * @brief	Returns messages, bytes, queueing delay and depth of txqueue queue_id.
+	 *
+	 * @throws eRofSchedInval for an invalid queue_id
+	 */
+	crofsched_stats
+	get_tx_queue_stats(
+			unsigned int queue_id) const {
+		RwLock rwlock(txsched_lock, RwLock::RWLOCK_READ);
+		return txsched->get_stats(queue_id);
+	};
+
+	/**
+	 *
+	 */
+	void
+	clear_tx_queue_stats() {
+		RwLock rwlock(txsched_lock, RwLock::RWLOCK_READ);
+		txsched->clear_stats();
+	};
+
 private:
 
 
@@ -240,9 +565,15 @@ private:
 		env(NULL),
 		socket(NULL),
 		state(STATE_INIT),
-		fragment(NULL),
-		msg_bytes_read(0),
+		rxbuf(DEFAULT_RXBUF_SIZE),
+		rxlen(0),
 		max_pkts_rcvd_per_round(DEFAULT_MAX_PKTS_RVCD_PER_ROUND),
+		txqueue_capacity(0),
+		txsched(NULL),
+		txbuf((size_t)0),
+		txbuflen(0),
+		clear_pending(0),
+		max_tx_batch_size(DEFAULT_MAX_TX_BATCH_SIZE),
 		socket_type(rofl::csocket::SOCKET_TYPE_UNKNOWN),
 		sd(-1)
 	{};
@@ -394,6 +725,9 @@ private:
 				delete socket;
 			ciosrv::cancel_all_timers();
 			ciosrv::cancel_all_events();
+			if (__atomic_load_n(&clear_pending, __ATOMIC_ACQUIRE)) {
+				rofl::ciosrv::notify(rofl::cevent(EVENT_CLEAR_QUEUES));
+			}
 			(socket = csocket::csocket_factory(socket_type, this, get_thread_id()))->connect(socket_params);
 		} break;
 		case STATE_CONNECTING: {
@@ -519,17 +853,41 @@ private:
 	void
 	__close() {
 		state = STATE_CLOSED;
-		if (fragment) {
-			delete fragment; fragment = NULL;
+		ciosrv::cancel_all_timers();
+		ciosrv::cancel_all_events();
+		if (pthread_self() == get_thread_id()) {
+			clear_queues();
+		} else {
+			// txqueues have a single consumer, i.e., this instance's thread
+			__atomic_store_n(&clear_pending, 1, __ATOMIC_RELEASE);
+			rofl::ciosrv::notify(rofl::cevent(EVENT_CLEAR_QUEUES));
 		}
+	};
+
+	/**
+	 * @brief	Drops all pending messages and buffered bytes, consumer thread only.
+	 */
+	void
+	clear_queues() {
+		__atomic_store_n(&clear_pending, 0, __ATOMIC_RELEASE);
+		rxlen = 0;
+		txbuflen = 0;
 		for (std::vector<crofqueue>::iterator
 				it = txqueues.begin(); it != txqueues.end(); ++it) {
 			(*it).clear();
 		}
-		ciosrv::cancel_all_timers();
-		ciosrv::cancel_all_events();
 	};
 
+	/**
+	 * @brief	Extracts all complete messages stored in rxbuf and moves a partial tail to the buffer's start.
+	 *
+	 * @param pkts_rcvd_in_round number of messages received in current round
+	 * @return false, when reading from the socket must stop (socket closed, round exhausted or environment stalled)
+	 */
+	bool
+	frame_messages(
+			unsigned int& pkts_rcvd_in_round);
+
 	/**
 	 *
 	 */
@@ -540,30 +898,50 @@ private:
 	/**
 	 *
 	 */
-	void
+	static void
 	parse_of10_message(
 			cmemory *mem, rofl::openflow::cofmsg **pmsg);
 
 	/**
 	 *
 	 */
-	void
+	static void
 	parse_of12_message(
 			cmemory *mem, rofl::openflow::cofmsg **pmsg);
 
 	/**
 	 *
 	 */
-	void
+	static void
 	parse_of13_message(
 			cmemory *mem, rofl::openflow::cofmsg **pmsg);
 
 	/**
+	 * @brief	Stores msg in its txqueue, see send_message() and send_control_message().
+	 */
+	unsigned int
+	enqueue_message(
+			rofl::openflow::cofmsg *msg,
+			bool control);
+
+	/**
+	 * @brief	Hands over the batch in txbuf to the socket, refilling txbuf from the txqueues first if empty.
 	 *
+	 * A batch not accepted by the socket remains in txbuf and is resent
+	 * once the congestion has been solved.
 	 */
 	void
 	send_from_queue();
 
+	/**
+	 * @brief	Packs queued messages back-to-back into txbuf.
+	 *
+	 * Messages are taken from the txqueues in the order selected by txsched
+	 * until all txqueues are empty or the batch exceeds max_tx_batch_size.
+	 */
+	void
+	fill_txbuf();
+
 	/**
 	 *
 	 */
@@ -634,10 +1012,14 @@ private:
 	 * receiving messages
 	 */
 
-	// incomplete fragment message fragment received in last round
-	cmemory*					fragment;
-	// number of bytes already received for current message fragment
-	unsigned int				msg_bytes_read;
+	// receive buffer, holds all bytes read from socket but not yet framed
+	cmemory						rxbuf;
+	// number of bytes stored in rxbuf
+	size_t						rxlen;
+	// default size of rxbuf, sufficient for any message of maximum length 2^16-1
+	static size_t const			DEFAULT_RXBUF_SIZE = 65536;
+	// counters for the receive path
+	crofsock_rx_stats			rxstats;
 	// read not more than this number of packets per round before rescheduling
 	unsigned int				max_pkts_rcvd_per_round;
 	// default value for max_pkts_rcvd_per_round
@@ -649,8 +1031,26 @@ private:
 
 	// QUEUE_MAX txqueues
 	std::vector<crofqueue>		txqueues;
-	// relative scheduling weights for txqueues
-	std::vector<unsigned int>	txweights;
+	// max. number of regular messages per txqueue
+	size_t						txqueue_capacity;
+	// slots per txqueue beyond txqueue_capacity reserved for control messages
+	static size_t const			TXQUEUE_CONTROL_RESERVE = 64;
+	// scheduler serving the txqueues
+	crofsched*					txsched;
+	// protects txsched against replacement while in use
+	mutable PthreadRwLock		txsched_lock;
+	// flush buffer, messages are packed back-to-back, reused across flushes
+	cmemory						txbuf;
+	// number of bytes in txbuf not yet accepted by the socket
+	size_t						txbuflen;
+	// set when queues must be cleared by the consumer thread after a close from another thread
+	unsigned int				clear_pending;
+	// stop adding messages to a batch once it has reached this size in bytes
+	size_t						max_tx_batch_size;
+	// default value for max_tx_batch_size
+	static size_t const			DEFAULT_MAX_TX_BATCH_SIZE = 65536;
+	// counters for the transmit path
+	crofsock_tx_stats			txstats;
 
 	enum rofl::csocket::socket_type_t
 								socket_type;
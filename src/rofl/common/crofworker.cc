@@ -0,0 +1,164 @@
+/*
+ * crofworker.cc
+ */
+
+#include "crofworker.h"
+
+#include <unistd.h>
+
+using namespace rofl;
+
+crofworker::crofworker(
+		crofconn_env* env,
+		const rofl::openflow::cofhello_elem_versionbitmap& versionbitmap,
+		unsigned int index,
+		pthread_t tid) :
+				rofl::ciosrv(tid),
+				env(env),
+				versionbitmap(versionbitmap),
+				index(index),
+				num_dpts(0),
+				num_accepted(0)
+{
+	rofl::logging::debug << "[rofl-common][crofworker] "
+			<< "worker created, index: " << index
+			<< ", tid: 0x" << std::hex << tid << std::dec << std::endl;
+}
+
+
+
+crofworker::~crofworker()
+{
+	std::set<crofconn*> conns;
+	{
+		RwLock lock(queue_rwlock, RwLock::RWLOCK_WRITE);
+		while (not queue.empty()) {
+			::close(queue.front().sd);
+			queue.pop_front();
+		}
+		conns.swap(pending);
+		conns.insert(dropped.begin(), dropped.end());
+		dropped.clear();
+	}
+	// connections may call back into their environment while being destroyed
+	for (std::set<crofconn*>::iterator
+			it = conns.begin(); it != conns.end(); ++it) {
+		delete *it;
+	}
+	rofl::logging::debug << "[rofl-common][crofworker] "
+			<< "worker destroyed, index: " << index << std::endl;
+}
+
+
+
+void
+crofworker::handoff(
+		enum rofl::csocket::socket_type_t socket_type,
+		const rofl::cparams& socket_params,
+		int sd,
+		enum rofl::crofconn::crofconn_flavour_t flavour,
+		size_t queue_capacity)
+{
+	caccepted accepted;
+	accepted.socket_type = socket_type;
+	accepted.socket_params = socket_params;
+	accepted.sd = sd;
+	accepted.flavour = flavour;
+	accepted.queue_capacity = queue_capacity;
+	{
+		RwLock lock(queue_rwlock, RwLock::RWLOCK_WRITE);
+		queue.push_back(accepted);
+	}
+	__sync_add_and_fetch(&num_accepted, 1);
+	notify(rofl::cevent(EVENT_ACCEPT));
+}
+
+
+
+bool
+crofworker::release(
+		rofl::crofconn* conn)
+{
+	RwLock lock(queue_rwlock, RwLock::RWLOCK_WRITE);
+	return (pending.erase(conn) > 0);
+}
+
+
+
+bool
+crofworker::drop(
+		rofl::crofconn* conn)
+{
+	{
+		RwLock lock(queue_rwlock, RwLock::RWLOCK_WRITE);
+		if (pending.erase(conn) == 0)
+			return false;
+		dropped.insert(conn);
+	}
+	notify(rofl::cevent(EVENT_DROP));
+	return true;
+}
+
+
+
+void
+crofworker::handle_event(
+		const rofl::cevent& event)
+{
+	switch (event.get_cmd()) {
+	case EVENT_ACCEPT: {
+		accept_pending();
+	} break;
+	case EVENT_DROP: {
+		std::set<crofconn*> conns;
+		{
+			RwLock lock(queue_rwlock, RwLock::RWLOCK_WRITE);
+			conns.swap(dropped);
+		}
+		for (std::set<crofconn*>::iterator
+				it = conns.begin(); it != conns.end(); ++it) {
+			delete *it;
+		}
+	} break;
+	default: {
+		rofl::logging::warn << "[rofl-common][crofworker] "
+				<< "unknown event type:" << event.get_cmd() << std::endl;
+	};
+	}
+}
+
+
+
+void
+crofworker::accept_pending()
+{
+	while (true) {
+		caccepted accepted;
+		{
+			RwLock lock(queue_rwlock, RwLock::RWLOCK_WRITE);
+			if (queue.empty())
+				return;
+			accepted = queue.front();
+			queue.pop_front();
+		}
+
+		rofl::logging::debug << "[rofl-common][crofworker] "
+				<< "accept => creating new crofconn on sd: " << accepted.sd
+				<< ", index: " << index << std::endl;
+
+		crofconn* conn = new rofl::crofconn(env, versionbitmap, get_thread_id(), accepted.queue_capacity);
+		{
+			RwLock lock(queue_rwlock, RwLock::RWLOCK_WRITE);
+			pending.insert(conn);
+		}
+		try {
+			conn->accept(accepted.socket_type, accepted.socket_params, accepted.sd, accepted.flavour);
+		} catch (RoflException& e) {
+			rofl::logging::error << "[rofl-common][crofworker] "
+					<< "accept failed on sd: " << accepted.sd << ", " << e.what() << std::endl;
+			if (release(conn)) {
+				delete conn;
+			}
+		}
+	}
+}
@@ -0,0 +1,188 @@
+/*
+ * crofworker.h
+ */
+
+#ifndef CROFWORKER_H_
+#define CROFWORKER_H_
+
+#include <set>
+#include <deque>
+#include <iostream>
+
+#include "rofl/common/ciosrv.h"
+#include "rofl/common/cparams.h"
+#include "rofl/common/csocket.h"
+#include "rofl/common/crofconn.h"
+#include "rofl/common/thread_helper.h"
+#include "rofl/common/logging.h"
+#include "rofl/common/openflow/cofhelloelemversionbitmap.h"
+
+namespace rofl {
+
+class crofbase;
+
+/**
+ * @brief	Worker thread of a rofl::crofbase instance serving datapath connections
+ *
+ * A crofworker lives in its own rofl::cioloop thread. Accepted socket
+ * descriptors are handed over from the listening thread via handoff()
+ * and queued. The worker creates a rofl::crofconn for each descriptor
+ * within its own thread context, so the connection's state machine and
+ * the rofl::crofdpt instance built upon it never run in the listening
+ * thread. The worker owns a connection until its OpenFlow handshake has
+ * completed and the connection has been attached to a control channel.
+ */
+class crofworker : public rofl::ciosrv {
+
+	enum crofworker_event_t {
+		EVENT_ACCEPT			= 1,
+		EVENT_DROP				= 2,
+	};
+
+public:
+
+	/**
+	 * @param env environment for connections created by this worker
+	 * @param versionbitmap OpenFlow versions offered on accepted connections
+	 * @param index position of this worker in its pool
+	 * @param tid thread running this worker's rofl::cioloop
+	 */
+	crofworker(
+			crofconn_env* env,
+			const rofl::openflow::cofhello_elem_versionbitmap& versionbitmap,
+			unsigned int index,
+			pthread_t tid);
+
+	/**
+	 * @brief	Destroys all connections still pending and closes queued descriptors.
+	 *
+	 * Must be called after the worker's loop has been stopped.
+	 */
+	virtual
+	~crofworker();
+
+public:
+
+	/**
+	 * @brief	Hands an accepted socket descriptor over to this worker.
+	 *
+	 * May be called from any thread.
+	 *
+	 * @param queue_capacity capacity of the new connection's receive and transmit queues
+	 */
+	void
+	handoff(
+			enum rofl::csocket::socket_type_t socket_type,
+			const rofl::cparams& socket_params,
+			int sd,
+			enum rofl::crofconn::crofconn_flavour_t flavour,
+			size_t queue_capacity = crofqueue::DEFAULT_CAPACITY);
+
+	/**
+	 * @brief	Releases a connection attached to a control channel from this worker.
+	 *
+	 * @return true when conn was created by this worker
+	 */
+	bool
+	release(
+			rofl::crofconn* conn);
+
+	/**
+	 * @brief	Releases a connection from this worker and destroys it later within the worker's loop.
+	 *
+	 * Used for connections, whose OpenFlow handshake has failed or which
+	 * cannot be attached to a control channel. May be called from within
+	 * the connection's own callbacks.
+	 *
+	 * @return true when conn was created by this worker
+	 */
+	bool
+	drop(
+			rofl::crofconn* conn);
+
+	/**
+	 *
+	 */
+	unsigned int
+	get_index() const
+	{ return index; };
+
+	/**
+	 * @brief	Returns number of rofl::crofdpt instances served by this worker.
+	 */
+	size_t
+	get_num_dpts() const
+	{ return __sync_add_and_fetch(const_cast<size_t*>(&num_dpts), 0); };
+
+	/**
+	 * @brief	Returns number of socket descriptors handed over to this worker.
+	 */
+	uint64_t
+	get_num_accepted() const
+	{ return __sync_add_and_fetch(const_cast<uint64_t*>(&num_accepted), 0); };
+
+	/**
+	 * @brief	Returns number of connections waiting for completion of their OpenFlow handshake.
+	 */
+	size_t
+	get_num_pending() const {
+		RwLock lock(queue_rwlock, RwLock::RWLOCK_READ);
+		return queue.size() + pending.size();
+	};
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, const crofworker& worker) {
+		os << indent(0) << "<crofworker index: " << worker.get_index()
+				<< " tid: 0x" << std::hex << worker.get_thread_id() << std::dec
+				<< " dpts: " << worker.get_num_dpts()
+				<< " accepted: " << worker.get_num_accepted()
+				<< " pending: " << worker.get_num_pending() << " >" << std::endl;
+		return os;
+	};
+
+private:
+
+	friend class crofbase;
+
+	void
+	inc_dpts()
+	{ __sync_add_and_fetch(&num_dpts, 1); };
+
+	void
+	dec_dpts()
+	{ __sync_sub_and_fetch(&num_dpts, 1); };
+
+	virtual void
+	handle_event(
+			const rofl::cevent& event);
+
+	void
+	accept_pending();
+
+private:
+
+	struct caccepted {
+		enum rofl::csocket::socket_type_t		socket_type;
+		rofl::cparams							socket_params;
+		int										sd;
+		enum rofl::crofconn::crofconn_flavour_t	flavour;
+		size_t									queue_capacity;
+	};
+
+	crofconn_env*								env;
+	rofl::openflow::cofhello_elem_versionbitmap	versionbitmap;
+	unsigned int								index;
+	size_t										num_dpts;
+	uint64_t									num_accepted;
+
+	mutable PthreadRwLock						queue_rwlock;
+	std::deque<caccepted>						queue;		// descriptors handed over, not yet accepted
+	std::set<rofl::crofconn*>					pending;	// connections in OpenFlow handshake
+	std::set<rofl::crofconn*>					dropped;	// connections to be destroyed
+};
+
+}; // end of namespace rofl
+
+#endif /* CROFWORKER_H_ */
@@ -329,6 +329,25 @@ public:
 	virtual void
 	send(cmemory *mem, rofl::csockaddr const& dest = rofl::csockaddr()) = 0;
 
+	/**
+	 * @brief	Sends buflen bytes from a buffer owned by the caller.
+	 *
+	 * Unlike send(), csocket does not take ownership of buf, which may
+	 * be reused once this method returns. Bytes that cannot be written
+	 * immediately are copied to the outgoing queue. The default
+	 * implementation copies the whole buffer.
+	 *
+	 * Exceptions are those of send(). On eSocketTxAgainPacketDropped no
+	 * byte has been accepted and the caller remains responsible for
+	 * resending the buffer, on all others the bytes have been accepted.
+	 *
+	 * @param buf start of bytes to be sent out
+	 * @param buflen number of bytes to be sent out
+	 */
+	virtual void
+	send_buffer(const uint8_t *buf, size_t buflen)
+	{ send(new cmemory((uint8_t*)buf, buflen)); };
+
 
 	/**
 	 *
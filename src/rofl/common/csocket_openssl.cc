@@ -6,8 +6,6 @@
 
 using namespace rofl;
 
-/*static*/std::set<csocket_openssl*> csocket_openssl::openssl_sockets;
-
 //Defaults
 std::string const	csocket_openssl::PARAM_DEFAULT_VALUE_SSL_KEY_CA_PATH("");
 std::string const	csocket_openssl::PARAM_DEFAULT_VALUE_SSL_KEY_CA_FILE("ca.pem");
@@ -33,6 +31,8 @@ csocket_openssl::get_default_params()
 	return p;
 }
 
+/*static*/size_t const csocket_openssl::TX_RECORD_SIZE = SSL3_RT_MAX_PLAIN_LENGTH;
+
 bool csocket_openssl::ssl_initialized = false;
 
 void
@@ -43,8 +43,11 @@ csocket_openssl::openssl_init()
 
 	SSL_library_init();
 	SSL_load_error_strings();
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+	// loaded automatically since OpenSSL 1.1.0
 	ERR_load_ERR_strings();
 	ERR_load_BIO_strings();
+#endif
 	OpenSSL_add_all_algorithms();
 	OpenSSL_add_all_ciphers();
 	OpenSSL_add_all_digests();
@@ -59,16 +62,19 @@ csocket_openssl::csocket_openssl(
 		pthread_t tid) :
 				csocket(owner, rofl::csocket::SOCKET_TYPE_OPENSSL, tid),
 				socket(this),
+				txbuf(TX_RECORD_SIZE),
+				txlen(0),
 				ctx(NULL),
 				ssl(NULL),
 				bio(NULL)
 {
-	openssl_sockets.insert(this);
-
 	logging::debug << "[rofl][csocket][openssl] constructor:" << std::endl << *this;
 
 	socket_flags.set(FLAG_SSL_IDLE);
 
+	// openssl reads and writes the descriptor via its socket BIO
+	socket.disable_ring();
+
 	csocket_openssl::openssl_init();
 
 	pthread_rwlock_init(&ssl_lock, 0);
@@ -84,8 +90,6 @@ csocket_openssl::~csocket_openssl()
 	openssl_destroy_ssl();
 
 	pthread_rwlock_destroy(&ssl_lock);
-
-	openssl_sockets.erase(this);
 }
 
 
@@ -93,49 +97,21 @@ csocket_openssl::~csocket_openssl()
 void
 csocket_openssl::openssl_init_ctx()
 {
-	ctx = SSL_CTX_new(SSLv23_method());
-
-	// certificate
-	if (!SSL_CTX_use_certificate_file(ctx, certfile.c_str(), SSL_FILETYPE_PEM)) {
-		throw eOpenSSL("[rofl][csocket][openssl][init-ctx] unable to read certfile:"+certfile);
-	}
-
-	// private key
-	SSL_CTX_set_default_passwd_cb(ctx, &csocket_openssl::openssl_password_callback);
-	SSL_CTX_set_default_passwd_cb_userdata(ctx, (void*)this);
-
-	if (!SSL_CTX_use_PrivateKey_file(ctx, keyfile.c_str(), SSL_FILETYPE_PEM)) {
-		throw eOpenSSL("[rofl][csocket][openssl][init-ctx] unable to read keyfile:"+keyfile);
-	}
-
-	// ciphers
-	if ((not ciphers.empty()) && (0 == SSL_CTX_set_cipher_list(ctx, ciphers.c_str()))) {
-		throw eOpenSSL("[rofl][csocket][openssl][init-ctx] unable to set ciphers:"+ciphers);
-	}
-
-	// capath/cafile
-	if (!SSL_CTX_load_verify_locations(ctx,
-			cafile.empty() ? NULL : cafile.c_str(),
-			capath.empty() ? NULL : capath.c_str())) {
-		throw eOpenSSL("[rofl][csocket][openssl][init-ctx] unable to load ca locations");
-	}
-
-	int mode = SSL_VERIFY_NONE;
-	if (verify_mode == "NONE") {
-		mode = SSL_VERIFY_NONE;
-	} else
-	if (verify_mode == "PEER") {
-		mode = SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT;
-	}
-
-	SSL_CTX_set_verify(ctx, mode, NULL); // TODO: verify callback
-
-
-	int depth; std::istringstream( verify_depth ) >> depth;
-
-	SSL_CTX_set_verify_depth(ctx, depth);
+	if (NULL != ctx)
+		return;
 
-	// TODO: get random numbers
+	// certificate, key and CA files are loaded once per process
+	csslctx::ckey key;
+	key.capath			= capath;
+	key.cafile			= cafile;
+	key.certfile		= certfile;
+	key.keyfile			= keyfile;
+	key.password		= password;
+	key.verify_mode		= verify_mode;
+	key.verify_depth	= verify_depth;
+	key.ciphers			= ciphers;
+
+	ctx = csslctx::acquire(key);
 }
 
 
@@ -144,7 +120,7 @@ void
 csocket_openssl::openssl_destroy_ctx()
 {
 	if (ctx) {
-		SSL_CTX_free(ctx); ctx = NULL;
+		csslctx::release(ctx); ctx = NULL;
 	}
 }
 
@@ -155,7 +131,7 @@ csocket_openssl::openssl_init_ssl()
 {
 	openssl_init_ctx();
 
-	if ((ssl = SSL_new(ctx)) == NULL) {
+	if ((ssl = SSL_new(ctx->get_ssl_ctx())) == NULL) {
 		throw eOpenSSL("[rofl][csocket][openssl][init-ssl] unable to create new SSL object");
 	}
 
@@ -169,6 +145,7 @@ csocket_openssl::openssl_init_ssl()
 
 	if (socket_flags.test(FLAG_SSL_CONNECTING)) {
 		SSL_set_connect_state(ssl);
+		ctx->prepare_client(ssl, peer); // offer session negotiated on previous connection
 	} else
 	if (socket_flags.test(FLAG_SSL_ACCEPTING)) {
 		SSL_set_accept_state(ssl);
@@ -184,30 +161,16 @@ csocket_openssl::openssl_destroy_ssl()
 		SSL_free(ssl); ssl = NULL; bio = NULL;
 	}
 
-	openssl_destroy_ctx();
-}
-
-
-
-int
-csocket_openssl::openssl_password_callback(char *buf, int size, int rwflag, void *userdata)
-{
-	csocket_openssl *socket = static_cast<csocket_openssl*>(userdata);
-	if ((NULL == socket) ||
-			(csocket_openssl::openssl_sockets.find(socket) ==
-					csocket_openssl::openssl_sockets.end())) {
-		throw eOpenSSL("[rofl][csocket][openssl][password-callback] unable to find socket object");
-	}
-
-	// use rwflag?
-
-	if (socket->get_password().empty()) {
-		return 0;
+	// plaintext pending for the freed session must not leak into the next one
+	{
+		RwLock lock(&ssl_lock, RwLock::RWLOCK_WRITE);
+		txlen = 0;
+		while (not txqueue.empty()) {
+			delete txqueue.front(); txqueue.pop_front();
+		}
 	}
 
-	strncpy(buf, socket->get_password().c_str(), size);
-
-	return strlen(buf);
+	openssl_destroy_ctx();
 }
 
 
@@ -291,6 +254,9 @@ csocket_openssl::connect(
 	verify_depth= socket_params.get_param(PARAM_SSL_KEY_VERIFY_DEPTH).get_string();
 	ciphers		= socket_params.get_param(PARAM_SSL_KEY_CIPHERS).get_string();
 
+	peer		= socket_params.get_param(PARAM_KEY_REMOTE_HOSTNAME).get_string() + ":"
+					+ socket_params.get_param(PARAM_KEY_REMOTE_PORT).get_string();
+
 	socket_flags.set(FLAG_ACTIVE_SOCKET);
 
 	ciosrv::cancel_all_timers();
@@ -485,13 +451,36 @@ csocket_openssl::dequeue_packet()
 {
 	RwLock lock(&ssl_lock, RwLock::RWLOCK_WRITE);
 
-	while (not txqueue.empty()) {
+	while ((txlen > 0) || not txqueue.empty()) {
 
-		int rc = 0, err_code = 0;
+		/*
+		 * aggregate queued messages into a single TLS record, a message
+		 * exceeding TX_RECORD_SIZE is sent on its own. After SSL_ERROR_WANT_*
+		 * SSL_write() must be repeated with the same buffer, so txbuf is
+		 * refilled only when completely written (txlen is 0).
+		 */
+		if (0 == txlen) {
+			while (not txqueue.empty()) {
+
+				rofl::cmemory *mem = txqueue.front();
+
+				if ((txlen > 0) && (txlen + mem->memlen() > TX_RECORD_SIZE))
+					break;
+
+				if (mem->memlen() > txbuf.memlen()) {
+					txbuf.resize(mem->memlen());
+				}
+
+				memcpy(txbuf.somem() + txlen, mem->somem(), mem->memlen());
+				txlen += mem->memlen();
 
-		rofl::cmemory *mem = txqueue.front();
+				delete mem; txqueue.pop_front();
+			}
+		}
+
+		int rc = 0, err_code = 0;
 
-		if ((NULL != ssl) && (rc = SSL_write(ssl, mem->somem(), mem->memlen())) < 0) {
+		if ((NULL != ssl) && (rc = SSL_write(ssl, txbuf.somem(), txlen)) < 0) {
 
 			switch (err_code = SSL_get_error(ssl, rc)) {
 			case SSL_ERROR_WANT_READ: {
@@ -500,7 +489,8 @@ csocket_openssl::dequeue_packet()
 			} return;
 			case SSL_ERROR_WANT_WRITE: {
 				rofl::logging::debug << "[rofl][csocket][openssl][dequeue] sending => SSL_ERROR_WANT_WRITE" << std::endl;
-				notify(EVENT_SEND_TXQUEUE);
+				// retried from handle_write() when the socket drained, rescheduling an event would spin
+				socket.notify_writable();
 			} return;
 			default: {
 			};
@@ -508,7 +498,7 @@ csocket_openssl::dequeue_packet()
 
 		}
 
-		delete mem; txqueue.pop_front();
+		txlen = 0;
 	}
 }
 
@@ -669,7 +659,8 @@ csocket_openssl::openssl_accept()
 			return;
 		}
 
-		rofl::logging::debug << "[rofl][csocket][openssl][accept] SSL_accept() succeeded " << std::endl;
+		rofl::logging::debug << "[rofl][csocket][openssl][accept] SSL_accept() succeeded"
+				<< (SSL_session_reused(ssl) ? ", session resumed " : " ") << std::endl;
 
 		socket_flags.reset(FLAG_SSL_ACCEPTING);
 		socket_flags.set(FLAG_SSL_ESTABLISHED);
@@ -728,6 +719,9 @@ csocket_openssl::openssl_connect()
 		rofl::logging::debug << "[rofl][csocket][openssl][connect] SSL_connect() failed " << std::endl;
 		ERR_print_errors_fp(stderr);
 
+		// do not offer the session again
+		ctx->drop_session(peer);
+
 		openssl_destroy_ssl();
 		socket.close();
 		socket_flags.reset(FLAG_SSL_CONNECTING);
@@ -753,7 +747,8 @@ csocket_openssl::openssl_connect()
 			return;
 		}
 
-		rofl::logging::debug << "[rofl][csocket][openssl][connect] SSL_connect() succeeded " << std::endl;
+		rofl::logging::debug << "[rofl][csocket][openssl][connect] SSL_connect() succeeded"
+				<< (SSL_session_reused(ssl) ? ", session resumed " : " ") << std::endl;
 
 		socket_flags.reset(FLAG_SSL_CONNECTING);
 		socket_flags.set(FLAG_SSL_ESTABLISHED);
@@ -9,6 +9,7 @@
 #include <list>
 #include <bitset>
 #include <stdio.h>
+#include <string.h>
 
 #include <openssl/bio.h>
 #include <openssl/ssl.h>
@@ -17,25 +18,12 @@
 #include "rofl/common/ciosrv.h"
 #include "rofl/common/csocket.h"
 #include "rofl/common/csocket_plain.h"
+#include "rofl/common/csslctx.h"
 #include "rofl/common/logging.h"
 #include "rofl/common/croflexception.h"
 
 namespace rofl {
 
-class eOpenSSL 		: public	RoflException {
-	std::string error;
-public:
-	eOpenSSL(std::string const& error) : error(error) {};
-	virtual ~eOpenSSL() throw() {};
-	friend std::ostream& operator<< (std::ostream& os, eOpenSSL const& e) {
-		os << "<eOpenSSL error: " << e.error << " >" << std::endl;
-		return os;
-	};
-};
-
-class eOpenSSLVerify		: public eOpenSSL {};
-
-
 /**
  * @brief 	A single TLS encrypted socket.
  * @ingroup common_devel_bsd_sockets
@@ -78,17 +66,13 @@ class csocket_openssl :
 	static void
 	openssl_init();
 
-	/**
-	 * @brief	OpenSSL password callback.
-	 */
-	static int
-	openssl_password_callback(char *buf, int size, int rwflag, void *userdata);
-
-	static std::set<csocket_openssl*> openssl_sockets;
-
 	csocket_plain				socket;
 	pthread_rwlock_t			ssl_lock;	/**< rwlock for access to pout_squeue */
 	std::list<rofl::cmemory*>	txqueue;
+	rofl::cmemory				txbuf;		// plaintext aggregated from txqueue, retried unchanged after SSL_ERROR_WANT_*
+	size_t						txlen;		// bytes pending in txbuf, dropped with the SSL object
+
+	static size_t const			TX_RECORD_SIZE;	// max. plaintext aggregated for a single SSL_write()
 
 	enum openssl_event_t {
 		EVENT_SEND_TXQUEUE		= 0,
@@ -99,7 +83,7 @@ class csocket_openssl :
 	/*
 	 * OpenSSL related structures
 	 */
-	SSL_CTX						*ctx;
+	csslctx						*ctx;		// shared with other sockets using the same parameters
 	SSL							*ssl;
 	BIO							*bio;
 
@@ -114,6 +98,7 @@ class csocket_openssl :
 	std::string					verify_mode;
 	std::string					verify_depth;
 	std::string					ciphers;
+	std::string					peer;		// remote address, key for client side session resumption
 
 	enum openssl_flag_t {
 		FLAG_SSL_IDLE			= 0,
@@ -249,6 +234,12 @@ public:
 	virtual bool
 	write_would_block() const { return socket.write_would_block(); };
 
+	/**
+	 * @brief	Returns true when the TLS session has been resumed by an abbreviated handshake.
+	 */
+	bool
+	is_session_reused() const { return (NULL != ssl) && SSL_session_reused(ssl); };
+
 	/**
 	 *
 	 */
@@ -5,6 +5,8 @@
 #include "csocket_plain.h"
 #include "csocket_strings.h"
 
+#include <algorithm>
+
 
 using namespace rofl;
 
@@ -47,6 +49,11 @@ csocket_plain::csocket_plain(
 				csocket(owner, rofl::csocket::SOCKET_TYPE_PLAIN, tid),
 				had_short_write(false),
 				max_txqueue_size(DEFAULT_MAX_TXQUEUE_SIZE),
+				ring_rxbuf(NULL),
+				ring_rxlen(0),
+				ring_rxoffset(0),
+				ring_rxclosed(false),
+				ring_rxerrno(0),
 				reconnect_start_timeout(RECONNECT_START_TIMEOUT),
 				reconnect_in_seconds(RECONNECT_START_TIMEOUT),
 				reconnect_counter(0)
@@ -215,6 +222,8 @@ csocket_plain::handle_wevent(int fd)
 
 			sockflags[FLAG_CONNECTED] = true;
 
+			enable_ring();
+
 			if ((getsockname(sd, laddr.ca_saddr, &(laddr.salen))) < 0) {
 				rofl::logging::error << "[rofl-common][csocket][plain] unable to read local address from socket descriptor:"
 						<< sd << " " << eSysCall() << std::endl;
@@ -592,6 +601,7 @@ csocket_plain::accept(cparams const& socket_params, int sd)
 
 	sockflags.set(FLAG_CONNECTED);
 	register_filedesc_r(sd);
+	enable_ring();
 	handle_accepted();
 }
 
@@ -899,6 +909,7 @@ csocket_plain::connect(
 		// connect was successful, register sd for read events
 		register_filedesc_r(sd);
 		sockflags.set(FLAG_CONNECTED);
+		enable_ring();
 
 		if (sockflags.test(FLAG_DO_RECONNECT)) {
 			cancel_timer(reconnect_timerid);
@@ -950,6 +961,14 @@ csocket_plain::close()
 
 	deregister_filedesc_r(sd);
 	deregister_filedesc_w(sd);
+	if (sockflags.test(FLAG_RING)) {
+		deregister_filedesc_ring(sd);
+		sockflags.reset(FLAG_RING);
+		ring_rxstage.clear();
+		ring_rxoffset = 0;
+		ring_rxbuf = NULL;
+		ring_rxlen = 0;
+	}
 	if (not sockflags.test(FLAG_RAW_SOCKET) and sockflags.test(FLAG_CONNECTED)) {
 		if ((rc = shutdown(sd, SHUT_RDWR)) < 0) {
 			rofl::logging::error << "[rofl-common][csocket][plain][close] error occured during shutdown(): "
@@ -987,24 +1006,57 @@ csocket_plain::recv(void *buf, size_t count, int flags, rofl::csockaddr& from)
 		throw eSocketNotConnected();
 	int rc;
 
-	// read from socket:
-	switch (type) {
-	case SOCK_STREAM:
-	case SOCK_SEQPACKET: {
-		rc = ::read(sd, (void*)buf, count);
+	if (sockflags.test(FLAG_RING)) {
+		// serve data received by io_uring, left over data first
+		size_t len = 0;
 		from = raddr;
-	} break;
-	case SOCK_DGRAM:
-	case SOCK_RAW: {
-		switch (domain) {
-		case AF_INET:  from = csockaddr(caddress_in4("0.0.0.0"), 0); break;
-		case AF_INET6: from = csockaddr(caddress_in6("::"), 0); break;
+		if (ring_rxoffset < ring_rxstage.size()) {
+			len = std::min(count, ring_rxstage.size() - ring_rxoffset);
+			memcpy(buf, &ring_rxstage[ring_rxoffset], len);
+			ring_rxoffset += len;
+			if (ring_rxoffset == ring_rxstage.size()) {
+				ring_rxstage.clear();
+				ring_rxoffset = 0;
+			}
+		}
+		if ((len < count) && (ring_rxlen > 0)) {
+			size_t chunk = std::min(count - len, ring_rxlen);
+			memcpy((uint8_t*)buf + len, ring_rxbuf, chunk);
+			ring_rxbuf += chunk;
+			ring_rxlen -= chunk;
+			len += chunk;
+		}
+		if (len > 0) {
+			return len;
+		} else if (ring_rxclosed) {
+			rc = 0;
+		} else if (ring_rxerrno != 0) {
+			errno = ring_rxerrno;
+			rc = -1;
+		} else {
+			throw eSocketRxAgain();
+		}
+
+	} else {
+		// read from socket:
+		switch (type) {
+		case SOCK_STREAM:
+		case SOCK_SEQPACKET: {
+			rc = ::read(sd, (void*)buf, count);
+			from = raddr;
+		} break;
+		case SOCK_DGRAM:
+		case SOCK_RAW: {
+			switch (domain) {
+			case AF_INET:  from = csockaddr(caddress_in4("0.0.0.0"), 0); break;
+			case AF_INET6: from = csockaddr(caddress_in6("::"), 0); break;
+			}
+			rc = recvfrom(sd, (void*)buf, count, flags, from.ca_saddr, &from.salen);
+		} break;
+		default: {
+			return 0;
+		};
 		}
-		rc = recvfrom(sd, (void*)buf, count, flags, from.ca_saddr, &from.salen);
-	} break;
-	default: {
-		return 0;
-	};
 	}
 
 
@@ -1060,10 +1112,15 @@ csocket_plain::send(cmemory* mem, const rofl::csockaddr& dest)
 
 	RwLock lock(&pout_squeue_lock, RwLock::RWLOCK_WRITE);
 
-	register_filedesc_w(sd);
+	if (not sockflags.test(FLAG_RING)) {
+		register_filedesc_w(sd);
+	}
 
 	if (not sockflags.test(FLAG_TX_WOULD_BLOCK)) {
 		pout_squeue.push_back(pout_entry_t(mem, dest));
+		if (sockflags.test(FLAG_RING)) {
+			ring_flush();
+		}
 	} else {
 		struct rofl::openflow::ofp_header* hdr = (struct rofl::openflow::ofp_header*)(mem->somem());
 
@@ -1091,6 +1148,59 @@ csocket_plain::send(cmemory* mem, const rofl::csockaddr& dest)
 
 
 
+void
+csocket_plain::send_buffer(const uint8_t* buf, size_t buflen)
+{
+	if ((SOCK_STREAM == type) && sockflags.test(FLAG_CONNECTED) && not sockflags.test(FLAG_RING)) {
+		{
+			RwLock lock(&pout_squeue_lock, RwLock::RWLOCK_WRITE);
+
+			/* write directly, unless previously queued packets must be sent first */
+			if (pout_squeue.empty() && not sockflags.test(FLAG_TX_WOULD_BLOCK)) {
+
+				int rc = ::send(sd, buf, buflen, MSG_NOSIGNAL);
+
+				if (rc < 0) {
+					switch (errno) {
+					case EAGAIN: {
+						rc = 0;
+					} break;
+					case EPIPE:
+					case ECONNRESET: {
+						goto out;
+					} break;
+					default: {
+						rofl::logging::warn << "[rofl-common][csocket][plain] send_buffer() send failed" << std::endl;
+						throw eSysCall("send");
+					};
+					}
+				}
+
+				if ((size_t)rc == buflen) {
+					return;
+				}
+
+				rofl::logging::debug << "[rofl-common][csocket][plain] short write on socket descriptor:" << sd
+						<< ", " << rc << " of " << buflen << " bytes sent, queueing remainder." << std::endl;
+
+				pout_squeue.push_back(pout_entry_t(new cmemory((uint8_t*)buf + rc, buflen - rc), csockaddr()));
+				sockflags.set(FLAG_TX_WOULD_BLOCK);
+				register_filedesc_w(sd);
+				throw eSocketTxAgainCongestion(); // remainder queued, wait for socket to become writable
+			}
+		} // unlocks pout_squeue_lock
+	}
+
+	csocket::send_buffer(buf, buflen);
+	return;
+
+out:
+	close(); // clears also pout_squeue
+	handle_closed();
+}
+
+
+
 void
 csocket_plain::dequeue_packet()
 {
@@ -1099,7 +1209,72 @@ csocket_plain::dequeue_packet()
 
 		int rc = 0;
 
+		/* socket served by io_uring: hand packets over to the loop, they are sent in batches */
+		if (sockflags.test(FLAG_RING)) {
+			ring_flush();
+			deregister_filedesc_w(sd);
+			return;
+		}
+
 		while (not pout_squeue.empty()) {
+
+			/* stream sockets: gather queued packets and send them with a single system call */
+			if (SOCK_STREAM == type) {
+				struct iovec iov[MAX_TX_IOVECS];
+				unsigned int iovcnt = 0;
+				size_t iovlen = 0;
+
+				for (std::list<pout_entry_t>::iterator
+						it = pout_squeue.begin(); (it != pout_squeue.end()) && (iovcnt < MAX_TX_IOVECS); ++it, ++iovcnt) {
+					iov[iovcnt].iov_base = it->mem->somem() + it->msg_bytes_sent;
+					iov[iovcnt].iov_len  = it->mem->memlen() - it->msg_bytes_sent;
+					iovlen += iov[iovcnt].iov_len;
+				}
+
+				struct msghdr msg;
+				memset(&msg, 0, sizeof(msg));
+				msg.msg_iov = iov;
+				msg.msg_iovlen = iovcnt;
+
+				if ((rc = sendmsg(sd, &msg, MSG_NOSIGNAL)) < 0) {
+					switch (errno) {
+					case EAGAIN:
+						sockflags.set(FLAG_TX_WOULD_BLOCK);
+						return;
+					case EPIPE:
+						goto out;
+					default:
+						rofl::logging::warn << "[rofl-common][csocket][plain] dequeue_packet() sendmsg failed" << std::endl;
+						throw eSysCall("sendmsg");
+					}
+				}
+
+				/* release all packets sent completely, remember offset for a partially sent one */
+				size_t written = rc;
+				while ((written > 0) && (not pout_squeue.empty())) {
+					pout_entry_t& entry = pout_squeue.front();
+					size_t left = entry.mem->memlen() - entry.msg_bytes_sent;
+					if (written < left) {
+						entry.msg_bytes_sent += written;
+						break;
+					}
+					written -= left;
+					delete entry.mem;
+					pout_squeue.pop_front();
+				}
+
+				if ((size_t)rc < iovlen) {
+					rofl::logging::debug << "[rofl-common][csocket][plain] short write on socket descriptor:" << sd
+							<< ", " << rc << " of " << iovlen << " bytes sent, waiting." << std::endl;
+					return;
+				}
+
+				sockflags.reset(FLAG_TX_WOULD_BLOCK);
+				sockflags.reset(FLAG_TX_WOULD_BLOCK_NOTIFIED);
+
+				continue;
+			}
+
 			pout_entry_t& entry = pout_squeue.front(); // reference, do not make a copy
 
 			rofl::logging::trace << "[rofl-common][csocket][plain] sending to socket, message: "
@@ -1164,3 +1339,105 @@ out:
 }
 
 
+
+void
+csocket_plain::enable_ring()
+{
+	if ((SOCK_STREAM != type) || sockflags.test(FLAG_RING_DISABLED)) {
+		return;
+	}
+	if (not register_filedesc_ring(sd)) {
+		return;
+	}
+	deregister_filedesc_r(sd);
+	deregister_filedesc_w(sd);
+	ring_rxbuf = NULL;
+	ring_rxlen = 0;
+	ring_rxstage.clear();
+	ring_rxoffset = 0;
+	ring_rxclosed = false;
+	ring_rxerrno = 0;
+	sockflags.set(FLAG_RING);
+
+	rofl::logging::debug << "[rofl-common][csocket][plain] socket served by io_uring " << str() << std::endl;
+}
+
+
+
+void
+csocket_plain::ring_flush()
+{
+	// limit data in flight, pout_squeue and TX_WOULD_BLOCK throttle the sender beyond
+	while ((not pout_squeue.empty()) && (get_filedesc_ring_backlog(sd) < RING_MAX_TX_BACKLOG)) {
+		send_filedesc_ring(sd, pout_squeue.front().mem);
+		pout_squeue.pop_front();
+	}
+
+	if (pout_squeue.empty()) {
+		sockflags.reset(FLAG_TX_WOULD_BLOCK);
+		sockflags.reset(FLAG_TX_WOULD_BLOCK_NOTIFIED);
+	} else {
+		sockflags.set(FLAG_TX_WOULD_BLOCK);
+	}
+}
+
+
+
+void
+csocket_plain::handle_recv(int fd, const uint8_t* buf, ssize_t len)
+{
+	if (not sockflags.test(FLAG_RING)) {
+		return;
+	}
+
+	if (len > 0) {
+		ring_rxbuf = buf;
+		ring_rxlen = len;
+	} else if (len == 0) {
+		ring_rxclosed = true;
+	} else {
+		ring_rxerrno = -len;
+	}
+
+	if (sockflags.test(FLAG_CONNECTED)) {
+		handle_read(); // call method in derived class
+	}
+
+	// buf is owned by the loop, keep data not consumed for the next round
+	if (sockflags.test(FLAG_RING) && (ring_rxlen > 0)) {
+		ring_rxstage.insert(ring_rxstage.end(), ring_rxbuf, ring_rxbuf + ring_rxlen);
+	}
+	ring_rxbuf = NULL;
+	ring_rxlen = 0;
+}
+
+
+
+void
+csocket_plain::handle_sent(int fd, ssize_t res)
+{
+	if (not sockflags.test(FLAG_RING)) {
+		return;
+	}
+
+	if (res < 0) {
+		rofl::logging::warn << "[rofl-common][csocket][plain] sendmsg failed on socket: "
+				<< strerror(-res) << ", closing endpoint. " << str() << std::endl;
+		close(); // clears also pout_squeue
+		handle_closed();
+		return;
+	}
+
+	{
+		RwLock lock(&pout_squeue_lock, RwLock::RWLOCK_WRITE);
+		ring_flush();
+	}
+
+	if (sockflags.test(FLAG_CONNECTED)) {
+		try {
+			handle_write();
+		} catch (RoflException& e) {
+			rofl::logging::error << "[rofl-common][csocket][plain] RoflException " << e << std::endl;
+		}
+	}
+}
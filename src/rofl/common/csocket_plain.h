@@ -7,6 +7,7 @@
 
 #include <list>
 #include <bitset>
+#include <vector>
 #include <stdio.h>
 
 #include <netinet/in.h>
@@ -107,6 +108,8 @@ private:
 		FLAG_CLOSING = 7,
 		FLAG_TX_WOULD_BLOCK	= 8,	/**< socket would block for transmission */
 		FLAG_TX_WOULD_BLOCK_NOTIFIED = 9,	/**< user was notified about blocking condition */
+		FLAG_RING			= 10,	/**< socket is served by the loop's io_uring backend */
+		FLAG_RING_DISABLED	= 11,	/**< socket must not be served by io_uring, e.g., wrapped by openssl */
 	};
 
 	std::bitset<16> 			sockflags; /**< socket flags (see below) */
@@ -122,6 +125,15 @@ private:
 
 	static const unsigned int DEFAULT_MAX_TXQUEUE_SIZE;
 	unsigned int 				max_txqueue_size;		// limit for pout_squeue
+	static const unsigned int MAX_TX_IOVECS = 64;		// max. number of packets gathered in a single sendmsg() call
+	static const size_t RING_MAX_TX_BACKLOG = 131072;	// max. number of bytes handed over to io_uring, not yet sent
+
+	const uint8_t*				ring_rxbuf;				// data indicated by handle_recv(), not yet consumed
+	size_t						ring_rxlen;
+	std::vector<uint8_t>		ring_rxstage;			// data left over from previous handle_recv() calls
+	size_t						ring_rxoffset;
+	bool						ring_rxclosed;			// peer closed connection
+	int							ring_rxerrno;			// receive failed
 
 	ctimerid					reconnect_timerid;
 	int							reconnect_start_timeout;
@@ -242,6 +254,21 @@ public:
 	send(
 			cmemory *mem, rofl::csockaddr const& dest = rofl::csockaddr());
 
+	/**
+	 * @brief	Sends buflen bytes from a buffer owned by the caller.
+	 *
+	 * A connected stream socket with an empty outgoing queue writes
+	 * directly from buf, only bytes left by a short write are copied to
+	 * the outgoing queue and eSocketTxAgainCongestion is thrown. All other
+	 * sockets queue a copy via send(). A connection reset by the peer
+	 * closes the socket and the buffer is discarded.
+	 *
+	 * @see csocket::send_buffer()
+	 */
+	virtual void
+	send_buffer(
+			const uint8_t *buf, size_t buflen);
+
 
 	/**
 	 *
@@ -255,6 +282,30 @@ public:
 	virtual bool
 	write_would_block() const { return sockflags.test(FLAG_TX_WOULD_BLOCK); };
 
+	/**
+	 * @brief	Prevents this socket from being served by the io_uring backend.
+	 *
+	 * Must be called when the socket descriptor is read or written by
+	 * another entity, e.g., an openssl BIO.
+	 */
+	void
+	disable_ring() { sockflags.set(FLAG_RING_DISABLED); };
+
+	/**
+	 * @brief	Requests a call to handle_write() once the socket becomes writable.
+	 *
+	 * For another entity writing the socket descriptor, e.g., an openssl BIO
+	 * that failed with SSL_ERROR_WANT_WRITE.
+	 */
+	void
+	notify_writable() { if (-1 != sd) register_filedesc_w(sd); };
+
+	/**
+	 * @brief	Returns true when this socket is served by the io_uring backend.
+	 */
+	bool
+	is_ring() const { return sockflags.test(FLAG_RING); };
+
 
 	/**
 	 *
@@ -461,6 +512,18 @@ private:
 	backoff_reconnect(
 			bool reset_timeout = false);
 
+	/**
+	 * @brief	Hands a connected stream socket over to the io_uring backend, if available.
+	 */
+	void
+	enable_ring();
+
+	/**
+	 * @brief	Hands queued packets over to the io_uring backend, pout_squeue_lock must be held.
+	 */
+	void
+	ring_flush();
+
 
 	/*
 	 * inherited from ciosrv
@@ -515,6 +578,28 @@ private:
 	handle_xevent(int fd);
 
 
+	/**
+	 * Handle data received on a socket served by io_uring.
+	 *
+	 * Makes the data available to recv() and calls handle_read().
+	 * Data not consumed is kept for the next call to handle_read().
+	 * @param fd the socket descriptor
+	 */
+	virtual void
+	handle_recv(int fd, const uint8_t* buf, ssize_t len);
+
+
+	/**
+	 * Handle completed transmissions on a socket served by io_uring.
+	 *
+	 * Hands further packets from pout_squeue over to the backend and
+	 * calls handle_write().
+	 * @param fd the socket descriptor
+	 */
+	virtual void
+	handle_sent(int fd, ssize_t res);
+
+
 protected:
 
 
@@ -522,7 +607,8 @@ protected:
 	 * Send packets in outgoing queue pout_squeue.
 	 *
 	 * This method transmits all pending packets from the transmission
-	 * queue pout_squeue.
+	 * queue pout_squeue. On stream sockets up to MAX_TX_IOVECS packets
+	 * are gathered and sent with a single sendmsg() system call.
 	 */
 	virtual void
 	dequeue_packet();
@@ -558,6 +644,9 @@ public:
 		if (sock.sockflags.test(FLAG_TX_WOULD_BLOCK)) {
 			os << "TX-WOULD-BLOCK ";
 		}
+		if (sock.sockflags.test(FLAG_RING)) {
+			os << "RING ";
+		}
 		os << ">" << std::endl;
 		return os;
 	};
@@ -591,6 +680,9 @@ public:
 		if (sockflags.test(FLAG_TX_WOULD_BLOCK)) {
 			sstr << "TX-WOULD-BLOCK, ";
 		}
+		if (sockflags.test(FLAG_RING)) {
+			sstr << "RING, ";
+		}
 		return sstr.str();
 	};
 };
@@ -0,0 +1,319 @@
+/*
+ * csslctx.cc
+ */
+
+#include "csslctx.h"
+
+#include <string.h>
+#include <sstream>
+
+#include "rofl/common/logging.h"
+
+using namespace rofl;
+
+/*static*/unsigned int const			csslctx::MAX_SESSIONS = 4096;
+/*static*/PthreadRwLock					csslctx::contexts_rwlock;
+/*static*/std::map<csslctx::ckey, csslctx*>	csslctx::contexts;
+/*static*/int							csslctx::peer_index = -1;
+
+
+
+bool
+csslctx::ckey::operator< (
+		const ckey& key) const
+{
+	if (certfile != key.certfile)
+		return (certfile < key.certfile);
+	if (keyfile != key.keyfile)
+		return (keyfile < key.keyfile);
+	if (cafile != key.cafile)
+		return (cafile < key.cafile);
+	if (capath != key.capath)
+		return (capath < key.capath);
+	if (password != key.password)
+		return (password < key.password);
+	if (verify_mode != key.verify_mode)
+		return (verify_mode < key.verify_mode);
+	if (verify_depth != key.verify_depth)
+		return (verify_depth < key.verify_depth);
+	return (ciphers < key.ciphers);
+}
+
+
+
+/*static*/csslctx*
+csslctx::acquire(
+		const ckey& key)
+{
+	{
+		RwLock lock(contexts_rwlock, RwLock::RWLOCK_READ);
+		std::map<ckey, csslctx*>::iterator it = contexts.find(key);
+		if (it != contexts.end()) {
+			__sync_add_and_fetch(&(it->second->refcnt), 1);
+			return it->second;
+		}
+	}
+
+	RwLock lock(contexts_rwlock, RwLock::RWLOCK_WRITE);
+	// created by another thread meanwhile
+	std::map<ckey, csslctx*>::iterator it = contexts.find(key);
+	if (it != contexts.end()) {
+		__sync_add_and_fetch(&(it->second->refcnt), 1);
+		return it->second;
+	}
+	if (peer_index < 0) {
+		peer_index = SSL_get_ex_new_index(0, NULL, NULL, NULL, &csslctx::free_peer);
+	}
+	csslctx* sslctx = new csslctx(key); // may throw
+	sslctx->refcnt = 1;
+	contexts[key] = sslctx;
+	return sslctx;
+}
+
+
+
+/*static*/void
+csslctx::release(
+		csslctx* sslctx)
+{
+	if (NULL == sslctx)
+		return;
+	__sync_sub_and_fetch(&(sslctx->refcnt), 1);
+}
+
+
+
+/*static*/void
+csslctx::purge()
+{
+	RwLock lock(contexts_rwlock, RwLock::RWLOCK_WRITE);
+	for (std::map<ckey, csslctx*>::iterator
+			it = contexts.begin(); it != contexts.end(); ) {
+		if (0 == it->second->get_refcnt()) {
+			delete it->second;
+			contexts.erase(it++);
+		} else {
+			++it;
+		}
+	}
+}
+
+
+
+/*static*/size_t
+csslctx::get_num_contexts()
+{
+	RwLock lock(contexts_rwlock, RwLock::RWLOCK_READ);
+	return contexts.size();
+}
+
+
+
+csslctx::csslctx(
+		const ckey& key) :
+				key(key),
+				ctx(NULL),
+				refcnt(0)
+{
+	if ((ctx = SSL_CTX_new(SSLv23_method())) == NULL) {
+		throw eOpenSSL("[rofl][csslctx] unable to create new SSL context");
+	}
+
+	try {
+		// private key
+		SSL_CTX_set_default_passwd_cb(ctx, &csslctx::password_callback);
+		SSL_CTX_set_default_passwd_cb_userdata(ctx, (void*)this);
+
+		// certificate
+		if (!SSL_CTX_use_certificate_file(ctx, key.certfile.c_str(), SSL_FILETYPE_PEM)) {
+			throw eOpenSSL("[rofl][csslctx] unable to read certfile:"+key.certfile);
+		}
+
+		if (!SSL_CTX_use_PrivateKey_file(ctx, key.keyfile.c_str(), SSL_FILETYPE_PEM)) {
+			throw eOpenSSL("[rofl][csslctx] unable to read keyfile:"+key.keyfile);
+		}
+
+		// ciphers
+		if ((not key.ciphers.empty()) && (0 == SSL_CTX_set_cipher_list(ctx, key.ciphers.c_str()))) {
+			throw eOpenSSL("[rofl][csslctx] unable to set ciphers:"+key.ciphers);
+		}
+
+		// capath/cafile
+		if (!SSL_CTX_load_verify_locations(ctx,
+				key.cafile.empty() ? NULL : key.cafile.c_str(),
+				key.capath.empty() ? NULL : key.capath.c_str())) {
+			throw eOpenSSL("[rofl][csslctx] unable to load ca locations");
+		}
+
+	} catch (eOpenSSL& e) {
+		SSL_CTX_free(ctx);
+		throw;
+	}
+
+	int mode = SSL_VERIFY_NONE;
+	if (key.verify_mode == "NONE") {
+		mode = SSL_VERIFY_NONE;
+	} else
+	if (key.verify_mode == "PEER") {
+		mode = SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT;
+	}
+
+	// no callback, peers are checked by OpenSSL's default chain verification against the CA locations
+	SSL_CTX_set_verify(ctx, mode, NULL);
+
+	int depth = 1; std::istringstream( key.verify_depth ) >> depth;
+
+	SSL_CTX_set_verify_depth(ctx, depth);
+
+	/*
+	 * session resumption: server side cache and tickets, client side
+	 * sessions are stored per peer by new_session_callback()
+	 */
+	SSL_CTX_clear_options(ctx, SSL_OP_NO_TICKET);
+	SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_BOTH);
+	SSL_CTX_sess_set_new_cb(ctx, &csslctx::new_session_callback);
+
+	// sessions are bound to this context, required for resumption with peer verification
+	unsigned char sid_ctx[SSL_MAX_SID_CTX_LENGTH];
+	unsigned int sid_len = 0;
+	std::string id = key.certfile + '\0' + key.keyfile + '\0' + key.cafile + '\0' + key.capath + '\0' + key.ciphers;
+	if (!EVP_Digest(id.data(), id.length(), sid_ctx, &sid_len, EVP_sha256(), NULL)) {
+		sid_len = 0;
+	}
+	if (sid_len > SSL_MAX_SID_CTX_LENGTH)
+		sid_len = SSL_MAX_SID_CTX_LENGTH;
+	SSL_CTX_set_session_id_context(ctx, sid_ctx, sid_len);
+
+	rofl::logging::debug << "[rofl][csslctx] created SSL context for certfile:" << key.certfile
+			<< " keyfile:" << key.keyfile << " cafile:" << key.cafile << std::endl;
+}
+
+
+
+csslctx::~csslctx()
+{
+	{
+		RwLock lock(sessions_rwlock, RwLock::RWLOCK_WRITE);
+		for (std::map<std::string, csession>::iterator
+				it = sessions.begin(); it != sessions.end(); ++it) {
+			SSL_SESSION_free(it->second.session);
+		}
+		sessions.clear();
+		sessions_age.clear();
+	}
+	SSL_CTX_free(ctx);
+}
+
+
+
+void
+csslctx::prepare_client(
+		SSL* ssl,
+		const std::string& peer)
+{
+	if (peer.empty())
+		return;
+
+	SSL_set_ex_data(ssl, peer_index, new std::string(peer));
+
+	RwLock lock(sessions_rwlock, RwLock::RWLOCK_READ);
+	std::map<std::string, csession>::iterator it = sessions.find(peer);
+	if (it == sessions.end())
+		return;
+	if (!SSL_set_session(ssl, it->second.session)) {
+		rofl::logging::debug << "[rofl][csslctx] unable to offer session for peer:" << peer << std::endl;
+	}
+}
+
+
+
+void
+csslctx::drop_session(
+		const std::string& peer)
+{
+	RwLock lock(sessions_rwlock, RwLock::RWLOCK_WRITE);
+	std::map<std::string, csession>::iterator it = sessions.find(peer);
+	if (it == sessions.end())
+		return;
+	SSL_SESSION_free(it->second.session);
+	sessions_age.erase(it->second.age);
+	sessions.erase(it);
+}
+
+
+
+void
+csslctx::store_session(
+		const std::string& peer,
+		SSL_SESSION* session)
+{
+	RwLock lock(sessions_rwlock, RwLock::RWLOCK_WRITE);
+	std::map<std::string, csession>::iterator it = sessions.find(peer);
+	if (it != sessions.end()) {
+		SSL_SESSION_free(it->second.session);
+		it->second.session = session;
+		// refreshed, move to the end of the eviction order
+		sessions_age.splice(sessions_age.end(), sessions_age, it->second.age);
+		return;
+	}
+	if (sessions.size() >= MAX_SESSIONS) {
+		// evict the session stored longest ago
+		std::map<std::string, csession>::iterator oldest = sessions.find(sessions_age.front());
+		SSL_SESSION_free(oldest->second.session);
+		sessions.erase(oldest);
+		sessions_age.pop_front();
+	}
+	csession& entry = sessions[peer];
+	entry.session = session;
+	entry.age = sessions_age.insert(sessions_age.end(), peer);
+}
+
+
+
+/*static*/int
+csslctx::password_callback(
+		char* buf, int size, int rwflag, void* userdata)
+{
+	csslctx* sslctx = static_cast<csslctx*>(userdata);
+
+	if ((NULL == sslctx) || sslctx->key.password.empty() || (size <= 0)) {
+		return 0;
+	}
+
+	strncpy(buf, sslctx->key.password.c_str(), size);
+	buf[size - 1] = '\0';
+
+	return strlen(buf);
+}
+
+
+
+/*static*/int
+csslctx::new_session_callback(
+		SSL* ssl, SSL_SESSION* session)
+{
+	// server side sessions are held by OpenSSL's internal cache
+	if (SSL_is_server(ssl))
+		return 0;
+
+	std::string* peer = static_cast<std::string*>(SSL_get_ex_data(ssl, peer_index));
+	if (NULL == peer)
+		return 0;
+
+	csslctx* sslctx = static_cast<csslctx*>(SSL_CTX_get_default_passwd_cb_userdata(SSL_get_SSL_CTX(ssl)));
+	if (NULL == sslctx)
+		return 0;
+
+	sslctx->store_session(*peer, session);
+
+	return 1; // reference to session is kept
+}
+
+
+
+/*static*/void
+csslctx::free_peer(
+		void* parent, void* ptr, CRYPTO_EX_DATA* ad, int idx, long argl, void* argp)
+{
+	delete static_cast<std::string*>(ptr);
+}
@@ -0,0 +1,214 @@
+/*
+ * csslctx.h
+ */
+
+#ifndef CSSLCTX_H_
+#define CSSLCTX_H_
+
+#include <map>
+#include <list>
+#include <string>
+#include <inttypes.h>
+
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+
+#include "rofl/common/thread_helper.h"
+#include "rofl/common/croflexception.h"
+
+namespace rofl {
+
+class eOpenSSL 		: public	RoflException {
+	std::string error;
+public:
+	eOpenSSL(std::string const& error) : error(error) {};
+	virtual ~eOpenSSL() throw() {};
+	friend std::ostream& operator<< (std::ostream& os, eOpenSSL const& e) {
+		os << "<eOpenSSL error: " << e.error << " >" << std::endl;
+		return os;
+	};
+};
+
+class eOpenSSLVerify		: public eOpenSSL {};
+
+
+/**
+ * @brief	Process-wide cache of OpenSSL contexts shared by rofl::csocket_openssl instances
+ * @ingroup common_devel_bsd_sockets
+ *
+ * An SSL_CTX is created once per set of certificate, key, CA and cipher
+ * parameters, so certificate and key files are parsed only once and not
+ * for every connection. Instances are reference counted via acquire()
+ * and release(). Unreferenced contexts are kept for later use, so sockets
+ * reconnecting after all connections have been lost still find their
+ * context and session state. Call purge() for freeing them, e.g., after
+ * certificates have been renewed.
+ *
+ * Each context enables the server side session cache and session tickets.
+ * On the client side, the last session negotiated with a peer is stored
+ * and offered for resumption on the next connection to the same peer.
+ * Following OpenSSL, sessions of connections freed without sending a
+ * close_notify alert are not resumed.
+ */
+class csslctx {
+public:
+
+	/**
+	 * @brief	Parameters identifying a shared context
+	 */
+	struct ckey {
+		std::string		capath;
+		std::string		cafile;
+		std::string		certfile;
+		std::string		keyfile;
+		std::string		password;
+		std::string		verify_mode;
+		std::string		verify_depth;
+		std::string		ciphers;
+
+		bool
+		operator< (
+				const ckey& key) const;
+	};
+
+public:
+
+	/**
+	 * @brief	Returns the context for key, created on first use, and increments its reference count.
+	 *
+	 * @throws eOpenSSL when certificate, key or CA files cannot be loaded
+	 */
+	static csslctx*
+	acquire(
+			const ckey& key);
+
+	/**
+	 * @brief	Decrements the reference count of a context obtained via acquire().
+	 */
+	static void
+	release(
+			csslctx* sslctx);
+
+	/**
+	 * @brief	Frees all contexts currently not referenced.
+	 */
+	static void
+	purge();
+
+	/**
+	 * @brief	Returns number of contexts in cache.
+	 */
+	static size_t
+	get_num_contexts();
+
+public:
+
+	/**
+	 *
+	 */
+	SSL_CTX*
+	get_ssl_ctx() const
+	{ return ctx; };
+
+	/**
+	 *
+	 */
+	const ckey&
+	get_key() const
+	{ return key; };
+
+	/**
+	 *
+	 */
+	unsigned int
+	get_refcnt() const
+	{ return __sync_add_and_fetch(const_cast<unsigned int*>(&refcnt), 0); };
+
+	/**
+	 * @brief	Prepares a client side SSL object for connecting to peer.
+	 *
+	 * Offers the session stored for peer for resumption and stores the
+	 * session negotiated on ssl for peer. An empty peer disables both.
+	 */
+	void
+	prepare_client(
+			SSL* ssl,
+			const std::string& peer);
+
+	/**
+	 * @brief	Forgets the session stored for peer, e.g., after a failed verification.
+	 */
+	void
+	drop_session(
+			const std::string& peer);
+
+	/**
+	 * @brief	Returns number of client side sessions stored.
+	 */
+	size_t
+	get_num_sessions() const {
+		RwLock lock(sessions_rwlock, RwLock::RWLOCK_READ);
+		return sessions.size();
+	};
+
+private:
+
+	csslctx(
+			const ckey& key);
+
+	~csslctx();
+
+	csslctx(
+			const csslctx& sslctx);
+
+	csslctx&
+	operator= (
+			const csslctx& sslctx);
+
+	static int
+	password_callback(
+			char* buf, int size, int rwflag, void* userdata);
+
+	static int
+	new_session_callback(
+			SSL* ssl, SSL_SESSION* session);
+
+	static void
+	free_peer(
+			void* parent, void* ptr, CRYPTO_EX_DATA* ad, int idx, long argl, void* argp);
+
+	void
+	store_session(
+			const std::string& peer,
+			SSL_SESSION* session);
+
+private:
+
+	static unsigned int const						MAX_SESSIONS;
+
+	static PthreadRwLock							contexts_rwlock;
+	static std::map<ckey, csslctx*>					contexts;
+	static int										peer_index;	// SSL ex_data index of peer name
+
+	ckey											key;
+	SSL_CTX*										ctx;
+	unsigned int									refcnt;
+
+	/*
+	 * client side session stored for a peer, entries in sessions_age are
+	 * ordered by time of storing, the oldest one is evicted first
+	 */
+	struct csession {
+		SSL_SESSION*								session;
+		std::list<std::string>::iterator			age;
+	};
+
+	mutable PthreadRwLock							sessions_rwlock;
+	std::map<std::string, csession>				sessions;		// client side, by peer
+	std::list<std::string>							sessions_age;	// peers, oldest first
+};
+
+}; // end of namespace rofl
+
+#endif /* CSSLCTX_H_ */
@@ -21,6 +21,8 @@
 
 namespace rofl {
 
+class ctimernode;
+
 /**
  * @brief	Environment expected by an instance of class rofl::ctimer
  */
@@ -29,6 +31,27 @@ public:
 	virtual
 	~ctimer_env()
 	{};
+
+	ctimer_env() :
+		timers(0)
+	{};
+
+	ctimer_env(
+			const ctimer_env& env) :
+				timers(0)
+	{};
+
+	ctimer_env&
+	operator= (
+			const ctimer_env& env)
+	{ return *this; };
+
+private:
+
+	friend class ctimerwheel;
+
+	// list of pending timers registered by this environment, managed by rofl::ctimerwheel
+	ctimernode*		timers;
 };
 
 /**
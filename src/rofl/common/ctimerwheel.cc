@@ -0,0 +1,576 @@
+/*
+ * ctimerwheel.cc
+ */
+
+#include "rofl/common/ctimerwheel.h"
+
+using namespace rofl;
+
+/*static*/const unsigned int ctimerwheel::WHEEL_BITS;
+/*static*/const unsigned int ctimerwheel::WHEEL_SIZE;
+/*static*/const unsigned int ctimerwheel::WHEEL_MASK;
+/*static*/const unsigned int ctimerwheel::WHEEL_LEVELS;
+/*static*/const long ctimerwheel::DEFAULT_TICK_NS;
+/*static*/const uint64_t ctimerwheel::COARSE_THRESHOLD;
+/*static*/const uint64_t ctimerwheel::COARSE_TICKS;
+/*static*/const int ctimerwheel::SLOT_EXPIRED;
+
+
+
+ctimerwheel::~ctimerwheel()
+{
+	clear();
+}
+
+
+
+ctimerwheel::ctimerwheel(
+		const rofl::ctimespec& tick) :
+				base(ctimespec::now()),
+				tick_ns((uint64_t)tick.get_timespec().tv_sec * 1000000000 + tick.get_timespec().tv_nsec),
+				cur_tick(0),
+				expired_head(0),
+				expired_tail(0),
+				num_scheduled(0),
+				buckets(64, (ctimernode*)0),
+				num_timers(0)
+{
+	if (0 == tick_ns) {
+		tick_ns = DEFAULT_TICK_NS;
+	}
+	for (unsigned int level = 0; level < WHEEL_LEVELS; level++) {
+		for (unsigned int index = 0; index < WHEEL_SIZE; index++) {
+			slots[level][index] = 0;
+		}
+		for (unsigned int word = 0; word < WHEEL_SIZE / 64; word++) {
+			bitmap[level][word] = 0;
+		}
+	}
+}
+
+
+
+rofl::ctimerid
+ctimerwheel::add_timer(
+		const rofl::ctimer& timer)
+{
+	RwLock lock(rwlock, RwLock::RWLOCK_WRITE);
+	ctimernode* node = new ctimernode(timer);
+	hash_link(node);
+	env_link(node);
+	schedule(node);
+	return node->timer.get_timer_id();
+}
+
+
+
+rofl::ctimerid
+ctimerwheel::reset(
+		const rofl::ctimerid& timer_id,
+		const rofl::ctimespec& timespec)
+{
+	RwLock lock(rwlock, RwLock::RWLOCK_WRITE);
+	ctimernode* node = lookup(timer_id.get_tid());
+	if (0 == node) {
+		throw eTimersNotFound();
+	}
+	slot_unlink(node);
+	node->timer.set_timespec() = ctimespec::now() + timespec;
+	schedule(node);
+	return node->timer.get_timer_id();
+}
+
+
+
+bool
+ctimerwheel::pending(
+		const rofl::ctimerid& timer_id) const
+{
+	RwLock lock(rwlock, RwLock::RWLOCK_READ);
+	return (0 != lookup(timer_id.get_tid()));
+}
+
+
+
+void
+ctimerwheel::cancel(
+		const rofl::ctimerid& timer_id)
+{
+	RwLock lock(rwlock, RwLock::RWLOCK_WRITE);
+	ctimernode* node = lookup(timer_id.get_tid());
+	if (0 == node) {
+		return;
+	}
+	drop(node);
+}
+
+
+
+void
+ctimerwheel::clear(
+		rofl::ctimer_env* env)
+{
+	if (0 == env) {
+		return;
+	}
+	RwLock lock(rwlock, RwLock::RWLOCK_WRITE);
+	while (0 != env->timers) {
+		drop(env->timers);
+	}
+}
+
+
+
+void
+ctimerwheel::clear()
+{
+	RwLock lock(rwlock, RwLock::RWLOCK_WRITE);
+	for (size_t i = 0; i < buckets.size(); i++) {
+		while (0 != buckets[i]) {
+			drop(buckets[i]);
+		}
+	}
+}
+
+
+
+size_t
+ctimerwheel::size() const
+{
+	RwLock lock(rwlock, RwLock::RWLOCK_READ);
+	return num_timers;
+}
+
+
+
+size_t
+ctimerwheel::size(
+		rofl::ctimer_env* env) const
+{
+	if (0 == env) {
+		return 0;
+	}
+	RwLock lock(rwlock, RwLock::RWLOCK_READ);
+	size_t num = 0;
+	for (ctimernode* node = env->timers; node != 0; node = node->enext) {
+		num++;
+	}
+	return num;
+}
+
+
+
+void
+ctimerwheel::advance(
+		const rofl::ctimespec& now)
+{
+	RwLock lock(rwlock, RwLock::RWLOCK_WRITE);
+
+	uint64_t target = to_ticks(now, false);
+
+	while (cur_tick <= target) {
+
+		// nothing left in the wheel, jump ahead
+		if (0 == num_scheduled) {
+			cur_tick = target + 1;
+			break;
+		}
+
+		unsigned int index = cur_tick & WHEEL_MASK;
+
+		// start of a new round on level 0: cascade timers from higher levels, highest level first
+		if (0 == index) {
+			unsigned int top = 1;
+			while ((top + 1 < WHEEL_LEVELS) && (0 == ((cur_tick >> (WHEEL_BITS * top)) & WHEEL_MASK))) {
+				top++;
+			}
+			for (unsigned int level = top; level > 0; level--) {
+				cascade(level, (cur_tick >> (WHEEL_BITS * level)) & WHEEL_MASK);
+			}
+		}
+
+		// next occupied slot within this round on level 0
+		int offset = find_slot(0, index);
+		if ((offset >= 0) && (offset < (int)(WHEEL_SIZE - index)) && (cur_tick + offset <= target)) {
+			cur_tick += offset;
+			index += offset;
+			ctimernode* node = slots[0][index];
+			slots[0][index] = 0;
+			bitmap[0][index / 64] &= ~((uint64_t)1 << (index % 64));
+			while (0 != node) {
+				ctimernode* next = node->next;
+				num_scheduled--;
+				expired_link(node);
+				node = next;
+			}
+			cur_tick++;
+			continue;
+		}
+
+		// no further timers due in this round, skip rounds of all empty lower levels at once
+		unsigned int bits = WHEEL_BITS;
+		for (unsigned int level = 0; (level + 1 < WHEEL_LEVELS) && level_empty(level) && level_empty(level + 1); level++) {
+			bits += WHEEL_BITS;
+		}
+		uint64_t next_round = ((cur_tick >> bits) + 1) << bits;
+		if (next_round > target) {
+			cur_tick = target + 1;
+			break;
+		}
+		cur_tick = next_round;
+	}
+}
+
+
+
+bool
+ctimerwheel::get_expired_timer(
+		rofl::ctimer& timer)
+{
+	RwLock lock(rwlock, RwLock::RWLOCK_WRITE);
+	if (0 == expired_head) {
+		return false;
+	}
+	ctimernode* node = expired_head;
+	timer = node->timer;
+	drop(node);
+	return true;
+}
+
+
+
+bool
+ctimerwheel::get_next_timeout(
+		rofl::ctimespec& timespec) const
+{
+	RwLock lock(rwlock, RwLock::RWLOCK_READ);
+
+	if (0 != expired_head) {
+		timespec = base;
+		return true;
+	}
+
+	if (0 == num_scheduled) {
+		return false;
+	}
+
+	uint64_t next_tick = ~(uint64_t)0;
+
+	// level 0 holds timers for the next WHEEL_SIZE ticks with exact expiration times
+	int offset = find_slot(0, cur_tick & WHEEL_MASK);
+	if (offset >= 0) {
+		next_tick = cur_tick + offset;
+	}
+
+	// higher levels: start of the next round that cascades an occupied slot
+	for (unsigned int level = 1; level < WHEEL_LEVELS; level++) {
+		uint64_t round = (cur_tick >> (WHEEL_BITS * level)) + 1;
+		if ((offset = find_slot(level, round & WHEEL_MASK)) < 0) {
+			continue;
+		}
+		uint64_t tick = (round + offset) << (WHEEL_BITS * level);
+		if (tick < next_tick) {
+			next_tick = tick;
+		}
+	}
+
+	timespec = to_timespec(next_tick);
+	return true;
+}
+
+
+
+uint64_t
+ctimerwheel::to_ticks(
+		const rofl::ctimespec& timespec, bool round_up) const
+{
+	int64_t ns =
+			((int64_t)timespec.get_timespec().tv_sec - (int64_t)base.get_timespec().tv_sec) * 1000000000 +
+			((int64_t)timespec.get_timespec().tv_nsec - (int64_t)base.get_timespec().tv_nsec);
+	if (ns <= 0) {
+		return 0;
+	}
+	if (round_up) {
+		return ((uint64_t)ns + tick_ns - 1) / tick_ns;
+	}
+	return (uint64_t)ns / tick_ns;
+}
+
+
+
+rofl::ctimespec
+ctimerwheel::to_timespec(
+		uint64_t tick) const
+{
+	uint64_t ns = tick * tick_ns;
+	return base + ctimespec(ns / 1000000000, ns % 1000000000);
+}
+
+
+
+ctimernode*
+ctimerwheel::lookup(
+		uint32_t tid) const
+{
+	for (ctimernode* node = buckets[tid & (buckets.size() - 1)]; node != 0; node = node->hnext) {
+		if (node->timer.get_timer_id().get_tid() == tid) {
+			return node;
+		}
+	}
+	return 0;
+}
+
+
+
+void
+ctimerwheel::hash_link(
+		ctimernode* node)
+{
+	// keep load factor below one, timer ids are sequential and spread evenly
+	if (num_timers >= buckets.size()) {
+		std::vector<ctimernode*> rehashed(2 * buckets.size(), (ctimernode*)0);
+		for (size_t i = 0; i < buckets.size(); i++) {
+			ctimernode* entry = buckets[i];
+			while (0 != entry) {
+				ctimernode* next = entry->hnext;
+				size_t bucket = entry->timer.get_timer_id().get_tid() & (rehashed.size() - 1);
+				entry->hnext = rehashed[bucket];
+				rehashed[bucket] = entry;
+				entry = next;
+			}
+		}
+		buckets.swap(rehashed);
+	}
+	size_t bucket = node->timer.get_timer_id().get_tid() & (buckets.size() - 1);
+	node->hnext = buckets[bucket];
+	buckets[bucket] = node;
+	num_timers++;
+}
+
+
+
+void
+ctimerwheel::hash_unlink(
+		ctimernode* node)
+{
+	ctimernode** pnode = &buckets[node->timer.get_timer_id().get_tid() & (buckets.size() - 1)];
+	while (0 != *pnode) {
+		if (*pnode == node) {
+			*pnode = node->hnext;
+			node->hnext = 0;
+			num_timers--;
+			return;
+		}
+		pnode = &((*pnode)->hnext);
+	}
+}
+
+
+
+void
+ctimerwheel::env_link(
+		ctimernode* node)
+{
+	ctimer_env* env = node->timer.get_timer_env();
+	if (0 == env) {
+		return;
+	}
+	node->eprev = 0;
+	node->enext = env->timers;
+	if (0 != env->timers) {
+		env->timers->eprev = node;
+	}
+	env->timers = node;
+}
+
+
+
+void
+ctimerwheel::env_unlink(
+		ctimernode* node)
+{
+	ctimer_env* env = node->timer.get_timer_env();
+	if (0 == env) {
+		return;
+	}
+	if (0 != node->eprev) {
+		node->eprev->enext = node->enext;
+	} else {
+		env->timers = node->enext;
+	}
+	if (0 != node->enext) {
+		node->enext->eprev = node->eprev;
+	}
+	node->eprev = node->enext = 0;
+}
+
+
+
+void
+ctimerwheel::schedule(
+		ctimernode* node)
+{
+	node->expires = to_ticks(node->timer.get_timespec(), true);
+
+	// low precision timer: align expiration time for batching
+	if (node->expires > cur_tick + COARSE_THRESHOLD) {
+		node->expires = ((node->expires + COARSE_TICKS - 1) / COARSE_TICKS) * COARSE_TICKS;
+	}
+
+	slot_link(node);
+}
+
+
+
+void
+ctimerwheel::slot_link(
+		ctimernode* node)
+{
+	if (node->expires < cur_tick) {
+		expired_link(node);
+		return;
+	}
+
+	uint64_t delta = node->expires - cur_tick;
+	uint64_t expires = node->expires;
+
+	unsigned int level = 0;
+	while ((level + 1 < WHEEL_LEVELS) && (delta >= ((uint64_t)1 << (WHEEL_BITS * (level + 1))))) {
+		level++;
+	}
+
+	// beyond wheel's range: park timer in the farthest slot, it is rescheduled when cascaded
+	if (delta >= ((uint64_t)1 << (WHEEL_BITS * WHEEL_LEVELS))) {
+		expires = cur_tick + ((uint64_t)1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+	}
+
+	unsigned int index = (expires >> (WHEEL_BITS * level)) & WHEEL_MASK;
+
+	node->slot = level * WHEEL_SIZE + index;
+	node->prev = 0;
+	node->next = slots[level][index];
+	if (0 != node->next) {
+		node->next->prev = node;
+	}
+	slots[level][index] = node;
+	bitmap[level][index / 64] |= ((uint64_t)1 << (index % 64));
+	num_scheduled++;
+}
+
+
+
+void
+ctimerwheel::slot_unlink(
+		ctimernode* node)
+{
+	if (SLOT_EXPIRED == node->slot) {
+		if (0 != node->prev) {
+			node->prev->next = node->next;
+		} else {
+			expired_head = node->next;
+		}
+		if (0 != node->next) {
+			node->next->prev = node->prev;
+		} else {
+			expired_tail = node->prev;
+		}
+	} else if (node->slot >= 0) {
+		unsigned int level = node->slot / WHEEL_SIZE;
+		unsigned int index = node->slot % WHEEL_SIZE;
+		if (0 != node->prev) {
+			node->prev->next = node->next;
+		} else {
+			slots[level][index] = node->next;
+		}
+		if (0 != node->next) {
+			node->next->prev = node->prev;
+		}
+		if (0 == slots[level][index]) {
+			bitmap[level][index / 64] &= ~((uint64_t)1 << (index % 64));
+		}
+		num_scheduled--;
+	}
+	node->slot = -1;
+	node->prev = node->next = 0;
+}
+
+
+
+void
+ctimerwheel::expired_link(
+		ctimernode* node)
+{
+	node->slot = SLOT_EXPIRED;
+	node->next = 0;
+	node->prev = expired_tail;
+	if (0 != expired_tail) {
+		expired_tail->next = node;
+	} else {
+		expired_head = node;
+	}
+	expired_tail = node;
+}
+
+
+
+void
+ctimerwheel::cascade(
+		unsigned int level,
+		unsigned int index)
+{
+	ctimernode* node = slots[level][index];
+	slots[level][index] = 0;
+	bitmap[level][index / 64] &= ~((uint64_t)1 << (index % 64));
+	while (0 != node) {
+		ctimernode* next = node->next;
+		num_scheduled--;
+		slot_link(node);
+		node = next;
+	}
+}
+
+
+
+int
+ctimerwheel::find_slot(
+		unsigned int level,
+		unsigned int start) const
+{
+	unsigned int offset = 0;
+	while (offset < WHEEL_SIZE) {
+		unsigned int index = (start + offset) & WHEEL_MASK;
+		uint64_t word = bitmap[level][index / 64] >> (index % 64);
+		if (0 != word) {
+			offset += __builtin_ctzll(word);
+			return (offset < WHEEL_SIZE) ? (int)offset : -1;
+		}
+		offset += 64 - (index % 64);
+	}
+	return -1;
+}
+
+
+
+bool
+ctimerwheel::level_empty(
+		unsigned int level) const
+{
+	for (unsigned int word = 0; word < WHEEL_SIZE / 64; word++) {
+		if (0 != bitmap[level][word]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+void
+ctimerwheel::drop(
+		ctimernode* node)
+{
+	slot_unlink(node);
+	hash_unlink(node);
+	env_unlink(node);
+	delete node;
+}
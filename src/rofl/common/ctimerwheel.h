@@ -0,0 +1,321 @@
+/*
+ * ctimerwheel.h
+ */
+
+#ifndef CTIMERWHEEL_H_
+#define CTIMERWHEEL_H_
+
+#include <inttypes.h>
+
+#include <vector>
+#include <iostream>
+
+#include "rofl/common/ctimer.h"
+#include "rofl/common/ctimers.h"
+#include "rofl/common/ctimerid.h"
+#include "rofl/common/ctimespec.h"
+#include "rofl/common/logging.h"
+#include "rofl/common/thread_helper.h"
+
+namespace rofl {
+
+/**
+ * @brief	Single entry of a rofl::ctimerwheel
+ *
+ * Each node is linked into three lists at the same time: the wheel slot
+ * (or list of expired timers) it currently resides in, a hash bucket
+ * indexed by its ctimerid and the list of timers owned by its ctimer_env.
+ */
+class ctimernode {
+	friend class ctimerwheel;
+
+	ctimernode(
+			const rofl::ctimer& timer) :
+				timer(timer),
+				expires(0),
+				slot(-1),
+				prev(0),
+				next(0),
+				hnext(0),
+				eprev(0),
+				enext(0)
+	{};
+
+	rofl::ctimer		timer;
+	uint64_t			expires;	// expiration time in ticks since creation of wheel
+	int					slot;		// level * WHEEL_SIZE + index, or SLOT_EXPIRED
+	ctimernode*			prev;		// wheel slot list
+	ctimernode*			next;
+	ctimernode*			hnext;		// hash bucket chain
+	ctimernode*			eprev;		// per ctimer_env list
+	ctimernode*			enext;
+};
+
+/**
+ * @ingroup common_devel_ioservice
+ *
+ * @brief	Hierarchical timing wheel for all timers of a rofl::cioloop
+ *
+ * Replaces the per rofl::ciosrv instances of class rofl::ctimers. Time is
+ * divided into ticks (default: 1ms). The wheel consists of WHEEL_LEVELS levels
+ * with WHEEL_SIZE slots each, level n covering 2^(8*(n+1)) ticks. Timers in
+ * higher levels are cascaded down when the wheel reaches their slot. Timers are
+ * indexed by their rofl::ctimerid in a hash table, so adding, resetting and
+ * cancelling a timer are O(1) operations.
+ *
+ * Timers never expire before their deadline, but may expire up to one tick
+ * later. Timers further away than COARSE_THRESHOLD ticks (low precision timers
+ * like echo or expiry timers) are rounded up to a multiple of COARSE_TICKS,
+ * so that timers registered within the same period expire in a single batch.
+ *
+ * All methods are thread-safe.
+ */
+class ctimerwheel {
+public:
+
+	static const unsigned int WHEEL_BITS		= 8;
+	static const unsigned int WHEEL_SIZE		= (1 << WHEEL_BITS);
+	static const unsigned int WHEEL_MASK		= (WHEEL_SIZE - 1);
+	static const unsigned int WHEEL_LEVELS		= 4;
+
+	static const long DEFAULT_TICK_NS			= 1000000; // 1ms
+	static const uint64_t COARSE_THRESHOLD		= 1024;	// ticks
+	static const uint64_t COARSE_TICKS			= 16;	// ticks
+
+public:
+
+	/**
+	 * @brief	ctimerwheel destructor
+	 */
+	~ctimerwheel();
+
+	/**
+	 * @brief	ctimerwheel constructor
+	 *
+	 * @param tick resolution of this timer wheel
+	 */
+	ctimerwheel(
+			const rofl::ctimespec& tick = rofl::ctimespec(0, DEFAULT_TICK_NS));
+
+private:
+
+	ctimerwheel(
+			const ctimerwheel& wheel);
+
+	ctimerwheel&
+	operator= (
+			const ctimerwheel& wheel);
+
+public:
+
+	/**
+	 * @name	Managing timers
+	 */
+
+	/**@{*/
+
+	/**
+	 * @brief	Inserts a new timer into the wheel
+	 *
+	 * @param timer timer with absolute expiration time and environment set
+	 * @return rofl-common's timer handle
+	 */
+	rofl::ctimerid
+	add_timer(
+			const rofl::ctimer& timer);
+
+	/**
+	 * @brief	Resets an existing timer identified by its handle with a new timeout value
+	 *
+	 * The timer keeps its handle.
+	 *
+	 * @param timer_id handle to existing timer
+	 * @param timespec new timeout value relative to now
+	 * @return timer handle
+	 *
+	 * @exception eTimersNotFound timer handle not found
+	 */
+	rofl::ctimerid
+	reset(
+			const rofl::ctimerid& timer_id,
+			const rofl::ctimespec& timespec);
+
+	/**
+	 * @brief	Checks whether a timer identified by the given handle is still pending
+	 */
+	bool
+	pending(
+			const rofl::ctimerid& timer_id) const;
+
+	/**
+	 * @brief	Removes a timer identified by the given handle from the wheel
+	 */
+	void
+	cancel(
+			const rofl::ctimerid& timer_id);
+
+	/**
+	 * @brief	Removes all timers registered by the given environment
+	 */
+	void
+	clear(
+			rofl::ctimer_env* env);
+
+	/**
+	 * @brief	Removes all timers
+	 */
+	void
+	clear();
+
+	/**
+	 * @brief	Returns number of pending timers
+	 */
+	size_t
+	size() const;
+
+	/**
+	 * @brief	Returns number of pending timers registered by the given environment
+	 */
+	size_t
+	size(
+			rofl::ctimer_env* env) const;
+
+	/**@}*/
+
+	/**
+	 * @name	Expiring timers
+	 */
+
+	/**@{*/
+
+	/**
+	 * @brief	Advances the wheel to the given point in time and moves all timers due until then to the list of expired timers
+	 */
+	void
+	advance(
+			const rofl::ctimespec& now = rofl::ctimespec::now());
+
+	/**
+	 * @brief	Removes the next timer from the list of expired timers
+	 *
+	 * @param timer copy of the expired timer is stored here
+	 * @return false, when no (further) timer has expired
+	 */
+	bool
+	get_expired_timer(
+			rofl::ctimer& timer);
+
+	/**
+	 * @brief	Returns point in time when the wheel needs servicing next
+	 *
+	 * The returned value is exact for timers due within the next WHEEL_SIZE
+	 * ticks and a lower bound otherwise, i.e., the time of the next cascade.
+	 *
+	 * @param timespec next timeout is stored here
+	 * @return false, when no timer is pending
+	 */
+	bool
+	get_next_timeout(
+			rofl::ctimespec& timespec) const;
+
+	/**@}*/
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, const ctimerwheel& wheel) {
+		RwLock lock(wheel.rwlock, RwLock::RWLOCK_READ);
+		os << indent(0) << "<ctimerwheel #timers: " << wheel.num_timers
+				<< " tick: " << wheel.cur_tick << " >" << std::endl;
+		return os;
+	};
+
+private:
+
+	static const int SLOT_EXPIRED = -2;
+
+	uint64_t
+	to_ticks(
+			const rofl::ctimespec& timespec, bool round_up) const;
+
+	rofl::ctimespec
+	to_timespec(
+			uint64_t tick) const;
+
+	ctimernode*
+	lookup(
+			uint32_t tid) const;
+
+	void
+	hash_link(
+			ctimernode* node);
+
+	void
+	hash_unlink(
+			ctimernode* node);
+
+	void
+	env_link(
+			ctimernode* node);
+
+	void
+	env_unlink(
+			ctimernode* node);
+
+	void
+	schedule(
+			ctimernode* node);
+
+	void
+	slot_link(
+			ctimernode* node);
+
+	void
+	slot_unlink(
+			ctimernode* node);
+
+	void
+	expired_link(
+			ctimernode* node);
+
+	void
+	cascade(
+			unsigned int level,
+			unsigned int index);
+
+	int
+	find_slot(
+			unsigned int level,
+			unsigned int start) const;
+
+	bool
+	level_empty(
+			unsigned int level) const;
+
+	void
+	drop(
+			ctimernode* node);
+
+private:
+
+	rofl::ctimespec				base;		// point in time of tick 0
+	uint64_t					tick_ns;
+	uint64_t					cur_tick;	// next tick to be processed
+
+	ctimernode*					slots[WHEEL_LEVELS][WHEEL_SIZE];
+	uint64_t					bitmap[WHEEL_LEVELS][WHEEL_SIZE / 64];
+
+	ctimernode*					expired_head;
+	ctimernode*					expired_tail;
+
+	size_t						num_scheduled;	// number of timers stored in wheel slots
+
+	std::vector<ctimernode*>	buckets;
+	size_t						num_timers;
+
+	mutable PthreadRwLock		rwlock;
+};
+
+}; // end of namespace rofl
+
+#endif /* CTIMERWHEEL_H_ */
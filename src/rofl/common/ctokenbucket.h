@@ -0,0 +1,177 @@
+/*
+ * ctokenbucket.h
+ */
+
+#ifndef CTOKENBUCKET_H_
+#define CTOKENBUCKET_H_
+
+#include <inttypes.h>
+#include <time.h>
+
+namespace rofl {
+
+/**
+ * @ingroup common_devel_workflow
+ * @brief	Lock-free token bucket for rate limiting messages.
+ *
+ * Admits on average "rate" messages per second and bursts of up to
+ * "burst" messages. Implemented as generic cell rate algorithm, i.e.,
+ * the bucket state is a single theoretical arrival time updated by
+ * compare-and-swap, so admit() may be called from any number of threads
+ * concurrently without taking a lock. A rate of 0 disables limiting.
+ */
+class ctokenbucket {
+public:
+
+	/**
+	 *
+	 */
+	ctokenbucket(
+			unsigned int rate = 0,
+			unsigned int burst = 1) :
+				rate(0),
+				burst(0),
+				interval(0),
+				tolerance(0),
+				tat(0)
+	{ set_rate(rate, burst); };
+
+	/**
+	 *
+	 */
+	ctokenbucket(
+			const ctokenbucket& bucket) :
+				rate(0),
+				burst(0),
+				interval(0),
+				tolerance(0),
+				tat(0)
+	{ set_rate(bucket.get_rate(), bucket.get_burst()); };
+
+	/**
+	 *
+	 */
+	ctokenbucket&
+	operator= (
+			const ctokenbucket& bucket) {
+		if (this == &bucket)
+			return *this;
+		set_rate(bucket.get_rate(), bucket.get_burst());
+		return *this;
+	};
+
+public:
+
+	/**
+	 * @brief	Sets rate in messages per second and bucket depth, refills the bucket.
+	 */
+	void
+	set_rate(
+			unsigned int rate,
+			unsigned int burst) {
+		if (0 == burst)
+			burst = 1;
+		uint64_t interval = (0 == rate) ? 0 : (NSEC_PER_SEC + rate - 1) / rate;
+		__atomic_store_n(&(this->rate), rate, __ATOMIC_RELAXED);
+		__atomic_store_n(&(this->burst), burst, __ATOMIC_RELAXED);
+		__atomic_store_n(&(this->tolerance), (uint64_t)(burst - 1) * interval, __ATOMIC_RELAXED);
+		__atomic_store_n(&(this->tat), 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&(this->interval), interval, __ATOMIC_RELEASE);
+	};
+
+	/**
+	 *
+	 */
+	unsigned int
+	get_rate() const
+	{ return __atomic_load_n(&rate, __ATOMIC_RELAXED); };
+
+	/**
+	 *
+	 */
+	unsigned int
+	get_burst() const
+	{ return __atomic_load_n(&burst, __ATOMIC_RELAXED); };
+
+	/**
+	 *
+	 */
+	bool
+	is_limited() const
+	{ return (0 != __atomic_load_n(&interval, __ATOMIC_ACQUIRE)); };
+
+	/**
+	 * @brief	Consumes a token, returns false when the bucket is empty.
+	 */
+	bool
+	admit() {
+		if (not is_limited())
+			return true;
+		return admit(now());
+	};
+
+	/**
+	 * @brief	Consumes a token at time "now" in nanoseconds on CLOCK_MONOTONIC.
+	 */
+	bool
+	admit(
+			uint64_t now) {
+		uint64_t interval = __atomic_load_n(&(this->interval), __ATOMIC_ACQUIRE);
+		if (0 == interval)
+			return true;
+		uint64_t tolerance = __atomic_load_n(&(this->tolerance), __ATOMIC_RELAXED);
+		uint64_t tat = __atomic_load_n(&(this->tat), __ATOMIC_RELAXED);
+		while (true) {
+			uint64_t next = (tat > now) ? tat : now;
+			if (next - now > tolerance) {
+				return false;
+			}
+			if (__atomic_compare_exchange_n(&(this->tat), &tat, next + interval,
+					false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				return true;
+			}
+		}
+	};
+
+	/**
+	 * @brief	Returns a token consumed by admit(), e.g., when the message is rejected by another limit.
+	 */
+	void
+	refund() {
+		uint64_t interval = __atomic_load_n(&(this->interval), __ATOMIC_ACQUIRE);
+		if (0 == interval)
+			return;
+		uint64_t tat = __atomic_load_n(&(this->tat), __ATOMIC_RELAXED);
+		// tat below interval: bucket was refilled by set_rate() meanwhile
+		while (tat >= interval) {
+			if (__atomic_compare_exchange_n(&(this->tat), &tat, tat - interval,
+					false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				return;
+			}
+		}
+	};
+
+	/**
+	 *
+	 */
+	static uint64_t
+	now() {
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+	};
+
+private:
+
+	static uint64_t const	NSEC_PER_SEC = 1000000000ULL;
+
+	unsigned int			rate;
+	unsigned int			burst;
+	uint64_t				interval;	// nanoseconds per token, 0: unlimited
+	uint64_t				tolerance;	// (burst - 1) * interval
+	uint64_t				tat;		// theoretical arrival time of next message
+};
+
+}; // end of namespace rofl
+
+#endif /* CTOKENBUCKET_H_ */
@@ -5,10 +5,14 @@
  *      Author: andi
  */
 
+#include <algorithm>
+
 #include "rofl/common/ctransactions.h"
 
 using namespace rofl;
 
+/*static*/const uint32_t ctransactions::INDEX_EMPTY;
+
 ctransactions::ctransactions(
 		ctransactions_env *env,
 		pthread_t tid) :
@@ -47,7 +51,9 @@ void
 ctransactions::clear()
 {
 	RwLock lock(queuelock, RwLock::RWLOCK_WRITE);
-	std::list<ctransaction>::clear();
+	heap.clear();
+	index_xid.clear();
+	index_pos.clear();
 	//cancel_timer(ta_queue_timer_id);
 	cancel_all_timers();
 }
@@ -57,16 +63,13 @@ ctransactions::clear()
 void
 ctransactions::get_next_ta(ctransaction& ta)
 {
-	//std::cerr << "PUNKT A: " << *this;
 	RwLock lock(queuelock, RwLock::RWLOCK_WRITE);
-	std::list<ctransaction>::iterator it;
-	if (((it = (*this).begin()) != (*this).end()) && ((*it).get_expires() <= cclock::now())) {
-		ta = *it;
-		(*this).erase(it);
+	if ((not heap.empty()) && (heap.front().get_expires() <= cclock::now())) {
+		ta = heap.front();
+		heap_erase(0);
 	} else {
 		throw eTransactionNotFound();
 	}
-	//std::cerr << "PUNKT B: " << *this;
 }
 
 
@@ -76,19 +79,15 @@ ctransactions::work_on_ta_queue()
 {
 	try {
 		while (true) {
-			//std::cerr << "PUNKT 1" << std::endl;
 			ctransaction ta;
 			get_next_ta(ta);
 			env->ta_expired(*this, ta);
 		}
-		//std::cerr << "PUNKT 2" << std::endl;
 
 	} catch (eTransactionNotFound& e) {}
 
-	//std::cerr << "PUNKT 3" << std::endl;
 	RwLock lock(queuelock, RwLock::RWLOCK_READ);
-	if (not (*this).empty()) {
-		//std::cerr << "PUNKT 4" << std::endl;
+	if (not heap.empty()) {
 		ta_queue_timer_id = register_timer(TIMER_WORK_ON_TA_QUEUE, ctimespec(work_interval));
 	}
 }
@@ -103,21 +102,24 @@ ctransactions::add_ta(
 {
 	RwLock lock(queuelock, RwLock::RWLOCK_WRITE);
 
-	++nxid;
-
-	cclock expires(delta);
+	// get_async_xid() may be called without holding queuelock
+	uint32_t xid = __sync_add_and_fetch(&nxid, 1);
 
-	std::list<ctransaction>::iterator it = begin();
-	while ((it != end()) && ((*it).get_expires() < expires)) {
-		++it;
+	// xid space wrapped around: replace stale transaction
+	size_t slot = index_find(xid);
+	if (slot < index_xid.size()) {
+		heap_erase(index_pos[slot]);
 	}
-	(*this).insert(it, ctransaction(nxid, delta, msg_type, msg_sub_type));
+
+	heap.push_back(ctransaction(xid, delta, msg_type, msg_sub_type));
+	index_set(xid, heap.size() - 1);
+	heap_up(heap.size() - 1);
 
 	if (not pending_timer(ta_queue_timer_id)) {
 		ta_queue_timer_id = register_timer(TIMER_WORK_ON_TA_QUEUE, ctimespec(work_interval));
 	}
 
-	return nxid;
+	return xid;
 }
 
 
@@ -128,16 +130,185 @@ ctransactions::drop_ta(
 {
 	RwLock lock(queuelock, RwLock::RWLOCK_WRITE);
 
-	for (std::list<ctransaction>::iterator
-			it = begin(); it != end(); ++it) {
-		if ((*it).get_xid() == xid) {
-			(*this).erase(it);
+	size_t slot = index_find(xid);
+	if (slot < index_xid.size()) {
+		heap_erase(index_pos[slot]);
+	}
+
+	if (heap.empty() && pending_timer(ta_queue_timer_id)) {
+		cancel_timer(ta_queue_timer_id);
+	}
+}
+
+
+
+bool
+ctransactions::has_ta(
+		uint32_t xid) const
+{
+	RwLock lock(queuelock, RwLock::RWLOCK_READ);
+	return (index_find(xid) < index_xid.size());
+}
+
+
+
+size_t
+ctransactions::size() const
+{
+	RwLock lock(queuelock, RwLock::RWLOCK_READ);
+	return heap.size();
+}
+
+
+
+size_t
+ctransactions::index_slot(
+		uint32_t xid) const
+{
+	// multiplicative hashing, consecutive xids map to distinct slots
+	return (size_t)((uint32_t)(xid * 2654435761U) & (index_xid.size() - 1));
+}
+
+
+
+size_t
+ctransactions::index_find(
+		uint32_t xid) const
+{
+	if (index_xid.empty()) {
+		return 0;
+	}
+	size_t mask = index_xid.size() - 1;
+	for (size_t slot = index_slot(xid); index_pos[slot] != INDEX_EMPTY; slot = (slot + 1) & mask) {
+		if (index_xid[slot] == xid) {
+			return slot;
+		}
+	}
+	return index_xid.size();
+}
+
+
+
+void
+ctransactions::index_set(
+		uint32_t xid, uint32_t pos)
+{
+	size_t slot = index_find(xid);
+	if (slot < index_xid.size()) {
+		index_pos[slot] = pos;
+		return;
+	}
+
+	// keep load factor below 1/2, rebuild index from heap
+	if (2 * heap.size() > index_xid.size()) {
+		size_t capacity = (index_xid.empty()) ? 64 : index_xid.size();
+		while (2 * heap.size() > capacity) {
+			capacity *= 2;
+		}
+		index_xid.assign(capacity, 0);
+		index_pos.assign(capacity, INDEX_EMPTY);
+		for (size_t i = 0; i < heap.size(); i++) {
+			if (heap[i].get_xid() != xid) {
+				index_set(heap[i].get_xid(), i);
+			}
+		}
+	}
+
+	size_t mask = index_xid.size() - 1;
+	for (slot = index_slot(xid); index_pos[slot] != INDEX_EMPTY; slot = (slot + 1) & mask);
+	index_xid[slot] = xid;
+	index_pos[slot] = pos;
+}
+
+
+
+void
+ctransactions::index_erase(
+		uint32_t xid)
+{
+	size_t slot = index_find(xid);
+	if (slot >= index_xid.size()) {
+		return;
+	}
+	index_pos[slot] = INDEX_EMPTY;
+
+	// backward shift deletion: close the gap for entries probing past this slot
+	size_t mask = index_xid.size() - 1;
+	for (size_t next = (slot + 1) & mask; index_pos[next] != INDEX_EMPTY; next = (next + 1) & mask) {
+		size_t home = index_slot(index_xid[next]);
+		if (((next - home) & mask) >= ((next - slot) & mask)) {
+			index_xid[slot] = index_xid[next];
+			index_pos[slot] = index_pos[next];
+			index_pos[next] = INDEX_EMPTY;
+			slot = next;
+		}
+	}
+}
+
+
+
+void
+ctransactions::heap_swap(
+		size_t a, size_t b)
+{
+	std::swap(heap[a], heap[b]);
+	index_pos[index_find(heap[a].get_xid())] = a;
+	index_pos[index_find(heap[b].get_xid())] = b;
+}
+
+
+
+void
+ctransactions::heap_up(
+		size_t pos)
+{
+	while (pos > 0) {
+		size_t parent = (pos - 1) / 2;
+		if (not (heap[pos].get_expires() < heap[parent].get_expires())) {
 			break;
 		}
+		heap_swap(pos, parent);
+		pos = parent;
 	}
+}
 
-	if ((*this).empty() && pending_timer(ta_queue_timer_id)) {
-		cancel_timer(ta_queue_timer_id);
+
+
+void
+ctransactions::heap_down(
+		size_t pos)
+{
+	while (true) {
+		size_t child = 2 * pos + 1;
+		if (child >= heap.size()) {
+			break;
+		}
+		if ((child + 1 < heap.size()) && (heap[child + 1].get_expires() < heap[child].get_expires())) {
+			child++;
+		}
+		if (not (heap[child].get_expires() < heap[pos].get_expires())) {
+			break;
+		}
+		heap_swap(pos, child);
+		pos = child;
+	}
+}
+
+
+
+void
+ctransactions::heap_erase(
+		size_t pos)
+{
+	size_t last = heap.size() - 1;
+	if (pos != last) {
+		heap_swap(pos, last);
+	}
+	index_erase(heap.back().get_xid());
+	heap.pop_back();
+	if (pos < heap.size()) {
+		heap_up(pos);
+		heap_down(pos);
 	}
 }
 
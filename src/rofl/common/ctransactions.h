@@ -9,7 +9,7 @@
 #define CTRANSACTIONS_H_
 
 #include <inttypes.h>
-#include <map>
+#include <vector>
 
 #include "rofl/common/thread_helper.h"
 #include "rofl/common/ciosrv.h"
@@ -32,16 +32,29 @@ protected:
 	virtual void ta_expired(ctransactions& tas, ctransaction& ta) = 0;
 };
 
+/**
+ * @brief	Table of pending transactions
+ *
+ * Transactions are stored in a binary min-heap ordered by expiration time.
+ * An open addressing hash table maps each xid to its position in the heap,
+ * so adding and dropping a transaction costs O(log n) and looking up an xid
+ * O(1). Expired transactions are removed from the top of the heap.
+ */
 class ctransactions :
-		public std::list<ctransaction>,
 		public rofl::ciosrv
 {
 	ctransactions_env			*env;
 	uint32_t					nxid;			// next xid
 	unsigned int				work_interval; 	// time interval for checking work-queue
-	PthreadRwLock				queuelock;		// rwlock for work-queue
+	mutable PthreadRwLock		queuelock;		// rwlock for work-queue
 	ctimerid					ta_queue_timer_id;
 
+	std::vector<ctransaction>	heap;			// transactions ordered by expiration time
+	std::vector<uint32_t>		index_xid;		// hash table: xid
+	std::vector<uint32_t>		index_pos;		// hash table: position in heap, INDEX_EMPTY for unused slots
+
+	static const uint32_t		INDEX_EMPTY = 0xffffffff;
+
 	enum ctransactions_timer_t {
 		TIMER_WORK_ON_TA_QUEUE 	= 1,	// lookup all expired TAs in list
 	};
@@ -87,7 +100,34 @@ public:
 	 *
 	 */
 	uint32_t
-	get_async_xid() { return ++nxid; };
+	get_async_xid() { return __sync_add_and_fetch(&nxid, 1); };
+
+	/**
+	 * @brief	Reserves num consecutive xids and returns the first one
+	 */
+	uint32_t
+	get_async_xids(
+			unsigned int num) { return __sync_add_and_fetch(&nxid, num) - num + 1; };
+
+	/**
+	 * @brief	Checks for a pending transaction with the given xid
+	 */
+	bool
+	has_ta(
+			uint32_t xid) const;
+
+	/**
+	 * @brief	Returns number of pending transactions
+	 */
+	size_t
+	size() const;
+
+	/**
+	 * @brief	Checks for an empty transaction table
+	 */
+	bool
+	empty() const
+	{ return (0 == size()); };
 
 private:
 
@@ -123,14 +163,71 @@ private:
 	void
 	work_on_ta_queue();
 
+	/**
+	 *
+	 */
+	size_t
+	index_slot(
+			uint32_t xid) const;
+
+	/**
+	 *
+	 */
+	size_t
+	index_find(
+			uint32_t xid) const;
+
+	/**
+	 *
+	 */
+	void
+	index_set(
+			uint32_t xid, uint32_t pos);
+
+	/**
+	 *
+	 */
+	void
+	index_erase(
+			uint32_t xid);
+
+	/**
+	 *
+	 */
+	void
+	heap_swap(
+			size_t a, size_t b);
+
+	/**
+	 *
+	 */
+	void
+	heap_up(
+			size_t pos);
+
+	/**
+	 *
+	 */
+	void
+	heap_down(
+			size_t pos);
+
+	/**
+	 *
+	 */
+	void
+	heap_erase(
+			size_t pos);
+
 public:
 
 	friend std::ostream&
 	operator<< (std::ostream& os, ctransactions const& tas) {
-		os << indent(0) << "<transactions #ta:" << tas.size() << " >" << std::endl;
+		RwLock lock(tas.queuelock, RwLock::RWLOCK_READ);
+		os << indent(0) << "<transactions #ta:" << tas.heap.size() << " >" << std::endl;
 		indent i(2);
-		for (std::list<ctransaction>::const_iterator
-				it = tas.begin(); it != tas.end(); ++it) {
+		for (std::vector<ctransaction>::const_iterator
+				it = tas.heap.begin(); it != tas.heap.end(); ++it) {
 			os << (*it);
 		}
 		return os;
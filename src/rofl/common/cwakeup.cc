@@ -0,0 +1,60 @@
+/*
+ * cwakeup.cc
+ */
+
+#include "cwakeup.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+using namespace rofl;
+
+cwakeup::cwakeup() :
+		fd(-1),
+		pending(0),
+		requested(0),
+		delivered(0)
+{
+	if ((fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+		throw eSysCall("eventfd()");
+	}
+}
+
+
+
+cwakeup::~cwakeup()
+{
+	close(fd);
+}
+
+
+
+void
+cwakeup::notify()
+{
+	__sync_fetch_and_add(&requested, 1);
+
+	// first notification since last drain() writes to the eventfd
+	if (not __sync_bool_compare_and_swap(&pending, 0, 1)) {
+		return;
+	}
+
+	__sync_fetch_and_add(&delivered, 1);
+
+	uint64_t value = 1;
+	while ((write(fd, &value, sizeof(value)) < 0) && (EINTR == errno)) {}
+	// EAGAIN: counter saturated, the polling thread is woken up anyway
+}
+
+
+
+void
+cwakeup::drain()
+{
+	// clear before reading, so a concurrent notify() issues a new wakeup
+	__sync_fetch_and_and(&pending, 0);
+
+	uint64_t value = 0;
+	while ((read(fd, &value, sizeof(value)) < 0) && (EINTR == errno)) {}
+}
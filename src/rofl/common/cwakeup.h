@@ -0,0 +1,93 @@
+/*
+ * cwakeup.h
+ */
+
+#ifndef CWAKEUP_H_
+#define CWAKEUP_H_
+
+#include <inttypes.h>
+
+#include "rofl/common/croflexception.h"
+
+namespace rofl {
+
+/**
+ * @brief	Coalescing wakeup primitive based on eventfd
+ *
+ * Any thread may call notify() to wake up the thread polling the file
+ * descriptor returned by get_fd(). While a wakeup is pending, i.e.,
+ * until the polling thread calls drain(), further notifications are
+ * merged into the pending one and do not issue a system call.
+ *
+ * The polling thread must call drain() before processing the work it
+ * was woken up for: a notification arriving afterwards then triggers
+ * another wakeup and is never lost.
+ *
+ * notify() is async-signal-safe.
+ */
+class cwakeup {
+public:
+
+	/**
+	 * @throws eSysCall when the eventfd cannot be created
+	 */
+	cwakeup();
+
+	/**
+	 *
+	 */
+	~cwakeup();
+
+	/**
+	 * @brief	Requests a wakeup, skipped if one is already pending.
+	 */
+	void
+	notify();
+
+	/**
+	 * @brief	Acknowledges a pending wakeup, called by the polling thread.
+	 */
+	void
+	drain();
+
+	/**
+	 * @brief	Returns the file descriptor to be polled for reading.
+	 */
+	int
+	get_fd() const
+	{ return fd; };
+
+	/**
+	 * @brief	Returns number of calls to notify().
+	 */
+	uint64_t
+	get_requested() const
+	{ return __sync_fetch_and_add(const_cast<uint64_t*>(&requested), 0); };
+
+	/**
+	 * @brief	Returns number of wakeups written to the eventfd.
+	 */
+	uint64_t
+	get_delivered() const
+	{ return __sync_fetch_and_add(const_cast<uint64_t*>(&delivered), 0); };
+
+private:
+
+	cwakeup(
+			const cwakeup& wakeup);
+
+	cwakeup&
+	operator= (
+			const cwakeup& wakeup);
+
+private:
+
+	int					fd;
+	volatile int		pending;
+	uint64_t			requested;
+	uint64_t			delivered;
+};
+
+}; // end of namespace rofl
+
+#endif /* CWAKEUP_H_ */
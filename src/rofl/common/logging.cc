@@ -28,6 +28,7 @@ std::ostream logging::debug3 (&logging::devnull);
 std::ostream logging::trace  (&logging::devnull);
 
 std::streamsize logging::width(70);
+int logging::level(-1);
 unsigned int indent::width(0);
 
 
@@ -56,6 +57,8 @@ logging::set_debug_level(
 {
 	logging::init();
 
+	logging::level = (debug_level > TRACE) ? TRACE : debug_level;
+
 	// EMERG
 	logging::emerg .rdbuf(std::cerr.rdbuf());
 
@@ -32,6 +32,11 @@ public:
 	static std::ostream trace;
 	static std::streamsize width;
 
+	/*
+	 * active debug level, -1 before set_debug_level() has been called
+	 */
+	static int level;
+
 public:
 
 
@@ -70,9 +75,50 @@ public:
 	static void
 	set_debug_level(
 			unsigned int debug_level);
+
+	/**
+	 * Returns true, when messages for the given level reach a stream other than /dev/null
+	 */
+	static bool
+	is_enabled(
+			unsigned int debug_level)
+	{ return ((int)debug_level <= logging::level); };
 };
 
 
+
+/*
+ * Highest logging level compiled into the library. Statements for
+ * levels above this value are removed by the compiler entirely. Release
+ * builds (configure without --enable-debug) define this as DBG3, i.e.,
+ * all TRACE statements are stripped.
+ */
+#ifndef ROFL_LOGGING_MAX_LEVEL
+#define ROFL_LOGGING_MAX_LEVEL 10 // rofl::logging::TRACE
+#endif
+
+/*
+ * Level-checked logging front end. The stream expression following the
+ * macro is evaluated only if the level is active, e.g.,
+ *
+ * 	ROFL_DEBUG2 << "[rofl-common][crofsock] msg: " << *msg << std::endl;
+ *
+ * does neither format nor even compute *msg when debug2 is disabled,
+ * while writing to rofl::logging::debug2 directly formats the whole
+ * message into /dev/null.
+ */
+#define ROFL_LOG_ENABLED(lvl) \
+	(((lvl) <= ROFL_LOGGING_MAX_LEVEL) && rofl::logging::is_enabled(lvl))
+
+#define ROFL_LOG(lvl, stream) \
+	if (not ROFL_LOG_ENABLED(lvl)) {} else rofl::logging::stream
+
+#define ROFL_DEBUG	ROFL_LOG(rofl::logging::DBG,	debug)
+#define ROFL_DEBUG2	ROFL_LOG(rofl::logging::DBG2,	debug2)
+#define ROFL_DEBUG3	ROFL_LOG(rofl::logging::DBG3,	debug3)
+#define ROFL_TRACE	ROFL_LOG(rofl::logging::TRACE,	trace)
+
+
 class indent
 {
 	static unsigned int width;
@@ -0,0 +1,263 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+ * cofflowmodtemplate.cc
+ */
+
+#include "cofflowmodtemplate.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <endian.h>
+
+using namespace rofl::openflow;
+
+namespace {
+
+inline uint16_t
+read16(const uint8_t* buf)
+{
+	uint16_t value;
+	memcpy(&value, buf, sizeof(value));
+	return be16toh(value);
+}
+
+inline uint32_t
+read32(const uint8_t* buf)
+{
+	uint32_t value;
+	memcpy(&value, buf, sizeof(value));
+	return be32toh(value);
+}
+
+}; // end of anonymous namespace
+
+
+
+cofflowmodtemplate::cofflowmodtemplate(
+		uint8_t ofp_version,
+		const rofl::openflow::cofflowmod& flowmod) :
+				ofp_version(ofp_version)
+{
+	switch (ofp_version) {
+	case rofl::openflow10::OFP_VERSION:
+	case rofl::openflow12::OFP_VERSION:
+	case rofl::openflow13::OFP_VERSION: {
+		rofl::openflow::cofmsg_flow_mod msg(ofp_version, 0, flowmod);
+		frame.resize(msg.length());
+		msg.pack(frame.somem(), frame.memlen());
+	} break;
+	default:
+		throw eBadVersion("cofflowmodtemplate::cofflowmodtemplate() unsupported OpenFlow version");
+	}
+}
+
+
+
+unsigned int
+cofflowmodtemplate::add(
+		size_t offset,
+		size_t width)
+{
+	if ((0 == width) || (offset + width > frame.memlen())) {
+		throw eFlowModTemplateInval("cofflowmodtemplate::add() field exceeds message");
+	}
+	fields.push_back(cfield(offset, width));
+	return fields.size() - 1;
+}
+
+
+
+unsigned int
+cofflowmodtemplate::add_field(
+		enum cofflowmodtemplate_field_t type)
+{
+	switch (ofp_version) {
+	case rofl::openflow10::OFP_VERSION: {
+		switch (type) {
+		case FIELD_COOKIE:
+			return add(offsetof(struct rofl::openflow10::ofp_flow_mod, cookie), sizeof(uint64_t));
+		case FIELD_IDLE_TIMEOUT:
+			return add(offsetof(struct rofl::openflow10::ofp_flow_mod, idle_timeout), sizeof(uint16_t));
+		case FIELD_HARD_TIMEOUT:
+			return add(offsetof(struct rofl::openflow10::ofp_flow_mod, hard_timeout), sizeof(uint16_t));
+		case FIELD_PRIORITY:
+			return add(offsetof(struct rofl::openflow10::ofp_flow_mod, priority), sizeof(uint16_t));
+		case FIELD_BUFFER_ID:
+			return add(offsetof(struct rofl::openflow10::ofp_flow_mod, buffer_id), sizeof(uint32_t));
+		default:
+			break;
+		}
+	} break;
+	default: {
+		// identical layout in OpenFlow 1.2 and 1.3
+		switch (type) {
+		case FIELD_COOKIE:
+			return add(offsetof(struct rofl::openflow13::ofp_flow_mod, cookie), sizeof(uint64_t));
+		case FIELD_IDLE_TIMEOUT:
+			return add(offsetof(struct rofl::openflow13::ofp_flow_mod, idle_timeout), sizeof(uint16_t));
+		case FIELD_HARD_TIMEOUT:
+			return add(offsetof(struct rofl::openflow13::ofp_flow_mod, hard_timeout), sizeof(uint16_t));
+		case FIELD_PRIORITY:
+			return add(offsetof(struct rofl::openflow13::ofp_flow_mod, priority), sizeof(uint16_t));
+		case FIELD_BUFFER_ID:
+			return add(offsetof(struct rofl::openflow13::ofp_flow_mod, buffer_id), sizeof(uint32_t));
+		default:
+			break;
+		}
+	};
+	}
+	throw eFlowModTemplateInval("cofflowmodtemplate::add_field() invalid field type");
+}
+
+
+
+unsigned int
+cofflowmodtemplate::add_field_oxm(
+		uint32_t oxm_id)
+{
+	if (rofl::openflow10::OFP_VERSION == ofp_version) {
+		throw eFlowModTemplateInval("cofflowmodtemplate::add_field_oxm() no OXM fields in OpenFlow 1.0");
+	}
+
+	const uint8_t* buf = frame.somem();
+	size_t match_offset = offsetof(struct rofl::openflow13::ofp_flow_mod, match);
+	size_t end = match_offset + read16(buf + match_offset + offsetof(struct rofl::openflow13::ofp_match, length));
+	size_t pos = match_offset + offsetof(struct rofl::openflow13::ofp_match, oxm_fields);
+
+	if (end > frame.memlen()) {
+		throw eFlowModTemplateInval("cofflowmodtemplate::add_field_oxm() invalid match length");
+	}
+
+	while (pos + sizeof(uint32_t) <= end) {
+		uint32_t oxm_hdr = read32(buf + pos);
+		size_t oxm_len = oxm_hdr & 0x000000ff;
+
+		if (pos + sizeof(uint32_t) + oxm_len > end) {
+			break;
+		}
+
+		// compare class and field only
+		if ((oxm_hdr & 0xfffffe00) == (oxm_id & 0xfffffe00)) {
+			size_t offset = pos + sizeof(uint32_t);
+			size_t width = oxm_len;
+			if (rofl::openflow13::OFPXMC_EXPERIMENTER == (oxm_hdr >> 16)) {
+				offset += sizeof(uint32_t);
+				width -= (width < sizeof(uint32_t)) ? width : sizeof(uint32_t);
+			}
+			if (oxm_hdr & 0x00000100) {
+				width /= 2; // value followed by mask
+			}
+			return add(offset, width);
+		}
+
+		pos += sizeof(uint32_t) + oxm_len;
+	}
+
+	throw eFlowModTemplateNotFound("cofflowmodtemplate::add_field_oxm() OXM field not found in match");
+}
+
+
+
+unsigned int
+cofflowmodtemplate::add_field_output(
+		unsigned int index)
+{
+	const uint8_t* buf = frame.somem();
+	unsigned int num = 0;
+
+	switch (ofp_version) {
+	case rofl::openflow10::OFP_VERSION: {
+		size_t pos = sizeof(struct rofl::openflow10::ofp_flow_mod);
+
+		while (pos + sizeof(struct rofl::openflow10::ofp_action_header) <= frame.memlen()) {
+			uint16_t type = read16(buf + pos);
+			uint16_t len = read16(buf + pos + sizeof(uint16_t));
+			if ((0 == len) || (pos + len > frame.memlen()))
+				break;
+			if ((rofl::openflow10::OFPAT_OUTPUT == type) && (num++ == index)) {
+				return add(pos + offsetof(struct rofl::openflow10::ofp_action_output, port), sizeof(uint16_t));
+			}
+			pos += len;
+		}
+	} break;
+	default: {
+		size_t match_offset = offsetof(struct rofl::openflow13::ofp_flow_mod, match);
+		size_t match_len = read16(buf + match_offset + offsetof(struct rofl::openflow13::ofp_match, length));
+		size_t pos = match_offset + (match_len + 7) / 8 * 8;
+
+		while (pos + sizeof(struct rofl::openflow13::ofp_instruction) <= frame.memlen()) {
+			uint16_t type = read16(buf + pos);
+			uint16_t len = read16(buf + pos + sizeof(uint16_t));
+			if ((0 == len) || (pos + len > frame.memlen()))
+				break;
+
+			if ((rofl::openflow13::OFPIT_APPLY_ACTIONS == type) || (rofl::openflow13::OFPIT_WRITE_ACTIONS == type)) {
+				size_t apos = pos + sizeof(struct rofl::openflow13::ofp_instruction_actions);
+
+				while (apos + sizeof(struct rofl::openflow13::ofp_action_header) <= pos + len) {
+					uint16_t atype = read16(buf + apos);
+					uint16_t alen = read16(buf + apos + sizeof(uint16_t));
+					if ((0 == alen) || (apos + alen > pos + len))
+						break;
+					if ((rofl::openflow13::OFPAT_OUTPUT == atype) && (num++ == index)) {
+						return add(apos + offsetof(struct rofl::openflow13::ofp_action_output, port), sizeof(uint32_t));
+					}
+					apos += alen;
+				}
+			}
+			pos += len;
+		}
+	};
+	}
+
+	throw eFlowModTemplateNotFound("cofflowmodtemplate::add_field_output() output action not found");
+}
+
+
+
+void
+cofflowmodtemplate::set_field(
+		unsigned int field_id,
+		uint64_t value)
+{
+	if (field_id >= fields.size()) {
+		throw eFlowModTemplateInval("cofflowmodtemplate::set_field() invalid field");
+	}
+	const cfield& field = fields[field_id];
+	if (field.width > sizeof(uint64_t)) {
+		throw eFlowModTemplateInval("cofflowmodtemplate::set_field() field wider than 64 bits");
+	}
+	uint8_t* buf = frame.somem() + field.offset;
+	for (size_t i = field.width; i > 0; i--) {
+		buf[i - 1] = (uint8_t)(value & 0xff);
+		value >>= 8;
+	}
+}
+
+
+
+void
+cofflowmodtemplate::set_field(
+		unsigned int field_id,
+		const uint8_t* buf,
+		size_t buflen)
+{
+	if ((field_id >= fields.size()) || (NULL == buf) || (buflen != fields[field_id].width)) {
+		throw eFlowModTemplateInval("cofflowmodtemplate::set_field() invalid field or length");
+	}
+	memcpy(frame.somem() + fields[field_id].offset, buf, buflen);
+}
+
+
+
+rofl::openflow::cofmsg_flow_mod*
+cofflowmodtemplate::create_message(
+		uint32_t xid) const
+{
+	rofl::openflow::cofmsg_flow_mod* msg = new rofl::openflow::cofmsg_flow_mod_packed(new rofl::cmemory(frame));
+	msg->set_xid(xid);
+	return msg;
+}
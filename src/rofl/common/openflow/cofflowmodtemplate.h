@@ -0,0 +1,264 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+ * cofflowmodtemplate.h
+ */
+
+#ifndef COFFLOWMODTEMPLATE_H_
+#define COFFLOWMODTEMPLATE_H_ 1
+
+#include <inttypes.h>
+#include <vector>
+#include <ostream>
+
+#include "rofl/common/cmemory.h"
+#include "rofl/common/openflow/cofflowmod.h"
+#include "rofl/common/openflow/messages/cofmsg_flow_mod.h"
+
+namespace rofl {
+namespace openflow {
+
+class eFlowModTemplateBase 		: public RoflException {
+public:
+	eFlowModTemplateBase(const std::string& __arg = std::string("eFlowModTemplateBase")) : RoflException(__arg) {};
+};
+class eFlowModTemplateNotFound	: public eFlowModTemplateBase {
+public:
+	eFlowModTemplateNotFound(const std::string& __arg = std::string("eFlowModTemplateNotFound")) : eFlowModTemplateBase(__arg) {};
+};
+class eFlowModTemplateInval		: public eFlowModTemplateBase {
+public:
+	eFlowModTemplateInval(const std::string& __arg = std::string("eFlowModTemplateInval")) : eFlowModTemplateBase(__arg) {};
+};
+
+/**
+ * @ingroup common_devel_openflow
+ * @brief	Flow-Mod message serialized once and stamped out with patched fields
+ *
+ * Packs a rofl::openflow::cofflowmod once into a wire-ready Flow-Mod
+ * message and records the byte offsets of fields designated as variable,
+ * e.g., an OXM match field's value or an output action's port. Setting
+ * a field writes the new value directly into the serialized message, and
+ * create_message() copies the message into a new buffer for sending, so
+ * installing many similar flow entries needs neither cofmatch or
+ * cofinstructions instances nor packing per entry.
+ *
+ * Variable fields must be present in the cofflowmod used as template,
+ * their values given there are defaults. OXM and output fields are
+ * supported for OpenFlow 1.2 and 1.3. A template is not thread-safe, use
+ * one instance per thread.
+ */
+class cofflowmodtemplate {
+public:
+
+	/**
+	 * @brief	Fixed fields of struct ofp_flow_mod
+	 */
+	enum cofflowmodtemplate_field_t {
+		FIELD_COOKIE			= 0,
+		FIELD_IDLE_TIMEOUT		= 1,
+		FIELD_HARD_TIMEOUT		= 2,
+		FIELD_PRIORITY			= 3,
+		FIELD_BUFFER_ID			= 4,
+	};
+
+public:
+
+	/**
+	 * @brief	Serializes flowmod as Flow-Mod message of version ofp_version.
+	 *
+	 * @throws eBadVersion for an unsupported version
+	 */
+	cofflowmodtemplate(
+			uint8_t ofp_version,
+			const rofl::openflow::cofflowmod& flowmod);
+
+	/**
+	 *
+	 */
+	virtual
+	~cofflowmodtemplate()
+	{};
+
+	/**
+	 *
+	 */
+	cofflowmodtemplate(
+			const cofflowmodtemplate& tmpl) :
+				ofp_version(tmpl.ofp_version),
+				frame(tmpl.frame),
+				fields(tmpl.fields)
+	{};
+
+	/**
+	 *
+	 */
+	cofflowmodtemplate&
+	operator= (
+			const cofflowmodtemplate& tmpl) {
+		if (this == &tmpl)
+			return *this;
+		ofp_version = tmpl.ofp_version;
+		frame = tmpl.frame;
+		fields = tmpl.fields;
+		return *this;
+	};
+
+public:
+
+	/**
+	 * @brief	Designates a fixed field of struct ofp_flow_mod as variable.
+	 *
+	 * @return field identifier for set_field()
+	 */
+	unsigned int
+	add_field(
+			enum cofflowmodtemplate_field_t type);
+
+	/**
+	 * @brief	Designates the value of OXM match field oxm_id as variable.
+	 *
+	 * Class and field of oxm_id are compared only, e.g., OXM_TLV_BASIC_ETH_DST
+	 * designates the field also when matching with a mask. The mask remains
+	 * constant.
+	 *
+	 * @return field identifier for set_field()
+	 * @throws eFlowModTemplateNotFound when the match does not contain oxm_id
+	 */
+	unsigned int
+	add_field_oxm(
+			uint32_t oxm_id);
+
+	/**
+	 * @brief	Designates the port of an output action as variable.
+	 *
+	 * Output actions in Apply-Actions and Write-Actions instructions are
+	 * counted in order of appearance.
+	 *
+	 * @param index index of output action, 0 for the first one
+	 * @return field identifier for set_field()
+	 * @throws eFlowModTemplateNotFound when there are less output actions
+	 */
+	unsigned int
+	add_field_output(
+			unsigned int index = 0);
+
+	/**
+	 * @brief	Sets a field of up to 64 bits in host byte order, e.g., a MAC address from caddress_ll::get_mac().
+	 *
+	 * @throws eFlowModTemplateInval for an invalid field identifier or a field wider than 64 bits
+	 */
+	void
+	set_field(
+			unsigned int field_id,
+			uint64_t value);
+
+	/**
+	 * @brief	Sets a field from a buffer in network byte order, e.g., an IPv6 address.
+	 *
+	 * @throws eFlowModTemplateInval for an invalid field identifier or a buffer length different from the field's width
+	 */
+	void
+	set_field(
+			unsigned int field_id,
+			const uint8_t* buf,
+			size_t buflen);
+
+	/**
+	 * @brief	Returns width of a field in bytes.
+	 */
+	size_t
+	get_field_width(
+			unsigned int field_id) const {
+		if (field_id >= fields.size())
+			throw eFlowModTemplateInval("cofflowmodtemplate::get_field_width() invalid field");
+		return fields[field_id].width;
+	};
+
+	/**
+	 *
+	 */
+	unsigned int
+	get_num_fields() const
+	{ return fields.size(); };
+
+	/**
+	 * @brief	Creates a Flow-Mod message from the current state of this template.
+	 *
+	 * The serialized message is copied into a new buffer and sent as is
+	 * without packing. The caller takes ownership of the returned object.
+	 */
+	rofl::openflow::cofmsg_flow_mod*
+	create_message(
+			uint32_t xid) const;
+
+	/**
+	 *
+	 */
+	uint8_t
+	get_version() const
+	{ return ofp_version; };
+
+	/**
+	 * @brief	Returns the serialized Flow-Mod message.
+	 */
+	const rofl::cmemory&
+	get_frame() const
+	{ return frame; };
+
+	/**
+	 *
+	 */
+	size_t
+	length() const
+	{ return frame.memlen(); };
+
+private:
+
+	struct cfield {
+		size_t		offset;		// offset of field in frame
+		size_t		width;		// width of field in bytes
+
+		cfield(
+				size_t offset = 0,
+				size_t width = 0) :
+					offset(offset),
+					width(width)
+		{};
+	};
+
+	/**
+	 *
+	 */
+	unsigned int
+	add(
+			size_t offset,
+			size_t width);
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, const cofflowmodtemplate& tmpl) {
+		os << rofl::indent(0) << "<cofflowmodtemplate ofp-version: " << (int)tmpl.ofp_version
+				<< " length: " << tmpl.length() << " #fields: " << tmpl.fields.size() << " >" << std::endl;
+		rofl::indent i(2);
+		for (unsigned int field_id = 0; field_id < tmpl.fields.size(); field_id++) {
+			os << rofl::indent(0) << "<field #" << field_id << " offset: " << tmpl.fields[field_id].offset
+					<< " width: " << tmpl.fields[field_id].width << " >" << std::endl;
+		}
+		return os;
+	};
+
+private:
+
+	uint8_t						ofp_version;
+	rofl::cmemory				frame;		// serialized Flow-Mod message including OpenFlow header
+	std::vector<cfield>			fields;		// variable fields
+};
+
+}; // end of namespace openflow
+}; // end of namespace rofl
+
+#endif /* COFFLOWMODTEMPLATE_H_ */
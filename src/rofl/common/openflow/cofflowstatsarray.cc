@@ -144,10 +144,17 @@ cofflowstatsarray::unpack(uint8_t *buf, size_t buflen)
 
 		while (buflen >= sizeof(struct rofl::openflow10::ofp_flow_stats)) {
 
-			add_flow_stats(flow_id++).unpack(buf, sizeof(struct rofl::openflow10::ofp_flow_stats));
+			struct rofl::openflow10::ofp_flow_stats* flow_stats = (struct rofl::openflow10::ofp_flow_stats*)buf;
 
-			buf += sizeof(struct rofl::openflow10::ofp_flow_stats);
-			buflen -= sizeof(struct rofl::openflow10::ofp_flow_stats);
+			uint16_t length = be16toh(flow_stats->length);
+
+			if ((length < sizeof(struct rofl::openflow10::ofp_flow_stats)) || (length > buflen))
+				throw eInval();
+
+			add_flow_stats(flow_id++).unpack(buf, length);
+
+			buf += length;
+			buflen -= length;
 		}
 	} break;
 	case rofl::openflow12::OFP_VERSION: {
@@ -0,0 +1,189 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+ * cofpacketoutbatch.cc
+ */
+
+#include "cofpacketoutbatch.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <endian.h>
+
+using namespace rofl::openflow;
+
+namespace {
+
+inline void
+write16(uint8_t* buf, uint16_t value)
+{
+	value = htobe16(value);
+	memcpy(buf, &value, sizeof(value));
+}
+
+inline void
+write32(uint8_t* buf, uint32_t value)
+{
+	value = htobe32(value);
+	memcpy(buf, &value, sizeof(value));
+}
+
+}; // end of anonymous namespace
+
+
+
+cofpacketoutbatch::cofpacketoutbatch(
+		uint8_t ofp_version,
+		const rofl::openflow::cofactions& actions,
+		size_t capacity) :
+				ofp_version(ofp_version),
+				hdrlen(0),
+				actions((size_t)0),
+				frame(capacity),
+				used(0)
+{
+	switch (ofp_version) {
+	case rofl::openflow10::OFP_VERSION: {
+		hdrlen = sizeof(struct rofl::openflow10::ofp_packet_out);
+	} break;
+	case rofl::openflow12::OFP_VERSION: {
+		hdrlen = sizeof(struct rofl::openflow12::ofp_packet_out);
+	} break;
+	case rofl::openflow13::OFP_VERSION: {
+		hdrlen = sizeof(struct rofl::openflow13::ofp_packet_out);
+	} break;
+	default:
+		throw eBadVersion("cofpacketoutbatch::cofpacketoutbatch() unsupported OpenFlow version");
+	}
+	set_actions(actions);
+}
+
+
+
+cofpacketoutbatch::cofpacketoutbatch(
+		const cofpacketoutbatch& batch) :
+				ofp_version(batch.ofp_version),
+				hdrlen(batch.hdrlen),
+				actions(batch.actions),
+				frame(batch.frame),
+				used(batch.used),
+				offsets(batch.offsets)
+{}
+
+
+
+cofpacketoutbatch&
+cofpacketoutbatch::operator= (
+		const cofpacketoutbatch& batch)
+{
+	if (this == &batch)
+		return *this;
+	ofp_version = batch.ofp_version;
+	hdrlen = batch.hdrlen;
+	actions = batch.actions;
+	frame = batch.frame;
+	used = batch.used;
+	offsets = batch.offsets;
+	return *this;
+}
+
+
+
+void
+cofpacketoutbatch::set_actions(
+		const rofl::openflow::cofactions& actions)
+{
+	if (actions.get_version() != ofp_version) {
+		throw eBadVersion("cofpacketoutbatch::set_actions() actions version mismatch");
+	}
+	size_t actions_len = actions.length();
+	if (hdrlen + actions_len > 0xffff) {
+		throw ePacketOutBatchInval("cofpacketoutbatch::set_actions() action list too long");
+	}
+	this->actions.resize(actions_len);
+	const_cast<rofl::openflow::cofactions&>(actions).pack(this->actions.somem(), this->actions.memlen());
+}
+
+
+
+void
+cofpacketoutbatch::add_packet_out(
+		uint32_t in_port,
+		const uint8_t* data,
+		size_t datalen,
+		uint32_t buffer_id)
+{
+	if (NULL == data) {
+		datalen = 0;
+	}
+	size_t actions_len = actions.memlen();
+	size_t msglen = hdrlen + actions_len + datalen;
+	if (msglen > 0xffff) {
+		throw ePacketOutBatchInval("cofpacketoutbatch::add_packet_out() message too long");
+	}
+
+	// grow geometrically, capacity is retained by clear()
+	if (used + msglen > frame.memlen()) {
+		size_t len = 2 * frame.memlen();
+		if (len < used + msglen)
+			len = used + msglen;
+		frame.resize(len);
+	}
+
+	uint8_t* buf = frame.somem() + used;
+	memset(buf, 0, hdrlen);
+
+	struct rofl::openflow::ofp_header* hdr = (struct rofl::openflow::ofp_header*)buf;
+	hdr->version = ofp_version;
+	write16(buf + offsetof(struct rofl::openflow::ofp_header, length), (uint16_t)msglen);
+
+	switch (ofp_version) {
+	case rofl::openflow10::OFP_VERSION: {
+		hdr->type = rofl::openflow10::OFPT_PACKET_OUT;
+		write32(buf + offsetof(struct rofl::openflow10::ofp_packet_out, buffer_id), buffer_id);
+		write16(buf + offsetof(struct rofl::openflow10::ofp_packet_out, in_port), (uint16_t)(in_port & 0x0000ffff));
+		write16(buf + offsetof(struct rofl::openflow10::ofp_packet_out, actions_len), (uint16_t)actions_len);
+	} break;
+	case rofl::openflow12::OFP_VERSION: {
+		hdr->type = rofl::openflow12::OFPT_PACKET_OUT;
+		write32(buf + offsetof(struct rofl::openflow12::ofp_packet_out, buffer_id), buffer_id);
+		write32(buf + offsetof(struct rofl::openflow12::ofp_packet_out, in_port), in_port);
+		write16(buf + offsetof(struct rofl::openflow12::ofp_packet_out, actions_len), (uint16_t)actions_len);
+	} break;
+	default: {
+		hdr->type = rofl::openflow13::OFPT_PACKET_OUT;
+		write32(buf + offsetof(struct rofl::openflow13::ofp_packet_out, buffer_id), buffer_id);
+		write32(buf + offsetof(struct rofl::openflow13::ofp_packet_out, in_port), in_port);
+		write16(buf + offsetof(struct rofl::openflow13::ofp_packet_out, actions_len), (uint16_t)actions_len);
+	};
+	}
+
+	if (actions_len > 0) {
+		memcpy(buf + hdrlen, actions.somem(), actions_len);
+	}
+	if (datalen > 0) {
+		memcpy(buf + hdrlen + actions_len, data, datalen);
+	}
+
+	offsets.push_back(used);
+	used += msglen;
+}
+
+
+
+rofl::openflow::cofmsg_packet_out_batch*
+cofpacketoutbatch::create_message(
+		uint32_t xid) const
+{
+	if (offsets.empty()) {
+		throw ePacketOutBatchInval("cofpacketoutbatch::create_message() empty batch");
+	}
+	rofl::cmemory* mem = new rofl::cmemory(const_cast<uint8_t*>(frame.somem()), used);
+	for (std::vector<size_t>::const_iterator
+			it = offsets.begin(); it != offsets.end(); ++it) {
+		write32(mem->somem() + *it + offsetof(struct rofl::openflow::ofp_header, xid), xid++);
+	}
+	return new rofl::openflow::cofmsg_packet_out_batch(mem, offsets.size());
+}
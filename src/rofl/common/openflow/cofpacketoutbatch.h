@@ -0,0 +1,193 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+ * cofpacketoutbatch.h
+ */
+
+#ifndef COFPACKETOUTBATCH_H_
+#define COFPACKETOUTBATCH_H_ 1
+
+#include <inttypes.h>
+#include <vector>
+#include <ostream>
+
+#include "rofl/common/cmemory.h"
+#include "rofl/common/openflow/cofactions.h"
+#include "rofl/common/openflow/messages/cofmsg_packet_out.h"
+
+namespace rofl {
+namespace openflow {
+
+class ePacketOutBatchBase 		: public RoflException {
+public:
+	ePacketOutBatchBase(const std::string& __arg = std::string("ePacketOutBatchBase")) : RoflException(__arg) {};
+};
+class ePacketOutBatchInval		: public ePacketOutBatchBase {
+public:
+	ePacketOutBatchInval(const std::string& __arg = std::string("ePacketOutBatchInval")) : ePacketOutBatchBase(__arg) {};
+};
+
+/**
+ * @ingroup common_devel_openflow
+ * @brief	Builds a batch of Packet-Out messages sharing one action list in a single wire buffer
+ *
+ * The action list is packed once when set. Each add_packet_out() appends
+ * a complete Packet-Out message with its own in_port, buffer_id and
+ * payload directly to a contiguous buffer, so neither cofactions nor
+ * cpacket instances are created per packet. create_message() copies the
+ * batch into a single rofl::openflow::cofmsg_packet_out_batch that is
+ * queued and sent as one unit.
+ *
+ * The buffer grows on demand and keeps its capacity across clear(), so a
+ * batch instance reused, e.g., for periodic LLDP discovery, stops
+ * allocating after the first rounds. A batch is not thread-safe, use one
+ * instance per thread.
+ */
+class cofpacketoutbatch {
+public:
+
+	enum cofpacketoutbatch_const_t {
+		DEFAULT_CAPACITY		= 16384,
+	};
+
+public:
+
+	/**
+	 * @brief	Creates an empty batch for version ofp_version with actions applied to all Packet-Outs.
+	 *
+	 * @throws eBadVersion for an unsupported version or actions of a different version
+	 */
+	cofpacketoutbatch(
+			uint8_t ofp_version,
+			const rofl::openflow::cofactions& actions,
+			size_t capacity = DEFAULT_CAPACITY);
+
+	/**
+	 *
+	 */
+	virtual
+	~cofpacketoutbatch()
+	{};
+
+	/**
+	 *
+	 */
+	cofpacketoutbatch(
+			const cofpacketoutbatch& batch);
+
+	/**
+	 *
+	 */
+	cofpacketoutbatch&
+	operator= (
+			const cofpacketoutbatch& batch);
+
+public:
+
+	/**
+	 * @brief	Replaces the action list for subsequently added Packet-Outs.
+	 *
+	 * Packet-Outs already in the batch keep their actions.
+	 *
+	 * @throws eBadVersion for actions of a different version
+	 */
+	void
+	set_actions(
+			const rofl::openflow::cofactions& actions);
+
+	/**
+	 * @brief	Appends a Packet-Out message for payload data to the batch.
+	 *
+	 * @param in_port ingress port, e.g., OFPP_CONTROLLER
+	 * @param buffer_id buffer on the datapath, payload is ignored unless OFP_NO_BUFFER
+	 * @throws ePacketOutBatchInval when the message exceeds the maximum OpenFlow message length
+	 */
+	void
+	add_packet_out(
+			uint32_t in_port,
+			const uint8_t* data,
+			size_t datalen,
+			uint32_t buffer_id = rofl::openflow13::OFP_NO_BUFFER);
+
+	/**
+	 * @brief	Removes all Packet-Outs, the buffer's capacity is retained.
+	 */
+	void
+	clear()
+	{ used = 0; offsets.clear(); };
+
+	/**
+	 *
+	 */
+	bool
+	empty() const
+	{ return offsets.empty(); };
+
+	/**
+	 *
+	 */
+	unsigned int
+	get_num_messages() const
+	{ return offsets.size(); };
+
+	/**
+	 * @brief	Returns the number of bytes of all Packet-Outs in the batch.
+	 */
+	size_t
+	length() const
+	{ return used; };
+
+	/**
+	 *
+	 */
+	size_t
+	capacity() const
+	{ return frame.memlen(); };
+
+	/**
+	 *
+	 */
+	uint8_t
+	get_version() const
+	{ return ofp_version; };
+
+	/**
+	 * @brief	Creates a message containing all Packet-Outs of the batch.
+	 *
+	 * Packet-Outs are assigned consecutive transaction identifiers
+	 * starting with xid. The caller takes ownership of the returned
+	 * object. The batch remains unchanged and may be cleared afterwards.
+	 *
+	 * @throws ePacketOutBatchInval for an empty batch
+	 */
+	rofl::openflow::cofmsg_packet_out_batch*
+	create_message(
+			uint32_t xid) const;
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, const cofpacketoutbatch& batch) {
+		os << rofl::indent(0) << "<cofpacketoutbatch ofp-version: " << (int)batch.ofp_version
+				<< " #msgs: " << batch.offsets.size() << " length: " << batch.used
+				<< " capacity: " << batch.frame.memlen() << " actions-len: " << batch.actions.memlen()
+				<< " >" << std::endl;
+		return os;
+	};
+
+private:
+
+	uint8_t						ofp_version;
+	size_t						hdrlen;		// length of struct ofp_packet_out for ofp_version
+	rofl::cmemory				actions;	// packed action list
+	rofl::cmemory				frame;		// Packet-Out messages, valid up to used
+	size_t						used;
+	std::vector<size_t>			offsets;	// offset of each Packet-Out in frame
+};
+
+}; // end of namespace openflow
+}; // end of namespace rofl
+
+#endif /* COFPACKETOUTBATCH_H_ */
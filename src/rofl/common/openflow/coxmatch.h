@@ -76,8 +76,6 @@ public:
 class coxmatch :
 	public rofl::cmemory
 {
-	PthreadRwLock		oxmlock;
-
 public:
 
 	enum coxmatch_bit_t {
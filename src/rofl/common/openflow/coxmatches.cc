@@ -41,12 +41,7 @@ coxmatches::operator= (
 	if (this == &oxms)
 		return *this;
 
-	clear();
-
-	for (std::map<uint32_t, coxmatch>::const_iterator
-			jt = oxms.matches.begin(); jt != oxms.matches.end(); ++jt) {
-		add_match(jt->second);
-	}
+	matches = oxms.matches;
 
 	return *this;
 }
@@ -68,12 +63,10 @@ coxmatches::operator== (coxmatches const& oxms) const
 	if (matches.size() != oxms.matches.size()) {
 		return false;
 	}
-	for (std::map<uint32_t, coxmatch>::const_iterator
-			it = matches.begin(); it != matches.end(); ++it) {
-		if (oxms.matches.find(it->first) == oxms.matches.end()) {
-			return false;
-		}
-		if (it->second != oxms.matches.at(it->first)) {
+	// both lists are sorted by oxm-id
+	for (oxm_map_t::const_iterator
+			it = matches.begin(), jt = oxms.matches.begin(); it != matches.end(); ++it, ++jt) {
+		if ((it->first != jt->first) || (it->second != jt->second)) {
 			return false;
 		}
 	}
@@ -96,6 +89,15 @@ coxmatches::unpack(
 		throw eBadMatchBadLen();
 	}
 
+	// count TLVs first, so the flat map allocates its storage only once
+	size_t num_oxms = 0;
+	for (size_t offset = 0; offset + sizeof(struct openflow::ofp_oxm_hdr) <= buflen; num_oxms++) {
+		struct openflow::ofp_oxm_hdr *hdr = (struct openflow::ofp_oxm_hdr*)(buf + offset);
+		if (0 == hdr->oxm_length)
+			break;
+		offset += sizeof(struct openflow::ofp_oxm_hdr) + hdr->oxm_length;
+	}
+	matches.reserve(num_oxms);
 
 	while (buflen > 0) {
 		struct openflow::ofp_oxm_hdr *hdr = (struct openflow::ofp_oxm_hdr*)buf;
@@ -123,14 +125,12 @@ coxmatches::pack(
 	if (buflen < length()) {
 		throw eBadMatchBadLen();
 	}
-	for (std::map<uint32_t, coxmatch>::iterator
+	for (oxm_map_t::iterator
 			jt = matches.begin(); jt != matches.end(); ++jt) {
 
-		coxmatch& match = (matches[jt->first]);
-
-		match.pack(buf, match.length());
+		memcpy(buf, jt->second.somem(), jt->second.memlen());
 
-		buf += match.length();
+		buf += jt->second.memlen();
 	}
 }
 
@@ -139,9 +139,6 @@ coxmatch&
 coxmatches::add_match(coxmatch const& oxm)
 {
 	uint32_t oid = oxm.get_oxm_id() & 0xfffffe00; // keep class and field, hide mask and length
-	if (matches.find(oid) != matches.end()) {
-		matches.erase(oid);
-	}
 	return (matches[oid] = oxm);
 }
 
@@ -150,9 +147,6 @@ coxmatch&
 coxmatches::add_match(uint32_t oxm_id)
 {
 	uint32_t oid = oxm_id & 0xfffffe00; // keep class and field, hide mask and length
-	if (matches.find(oid) != matches.end()) {
-		matches.erase(oid);
-	}
 	return (matches[oid] = coxmatch(oxm_id));
 }
 
@@ -161,10 +155,11 @@ coxmatch&
 coxmatches::set_match(uint32_t oxm_id)
 {
 	uint32_t oid = oxm_id & 0xfffffe00; // keep class and field, hide mask and length
-	if (matches.find(oid) == matches.end()) {
-		matches[oid] = coxmatch(oxm_id);
+	oxm_map_t::iterator it = matches.find(oid);
+	if (it == matches.end()) {
+		return (matches[oid] = coxmatch(oxm_id));
 	}
-	return matches[oid];
+	return it->second;
 }
 
 
@@ -172,10 +167,11 @@ coxmatch const&
 coxmatches::get_match(uint32_t oxm_id) const
 {
 	uint32_t oid = oxm_id & 0xfffffe00; // keep class and field, hide mask and length
-	if (matches.find(oid) == matches.end()) {
+	oxm_map_t::const_iterator it = matches.find(oid);
+	if (it == matches.end()) {
 		throw eOxmNotFound("coxmatches::get_match() oxm-id not found");
 	}
-	return matches.at(oid);
+	return it->second;
 }
 
 
@@ -183,9 +179,6 @@ void
 coxmatches::drop_match(uint32_t oxm_id)
 {
 	uint32_t oid = oxm_id & 0xfffffe00; // keep class and field, hide mask and length
-	if (matches.find(oid) == matches.end()) {
-		return;
-	}
 	matches.erase(oid);
 }
 
@@ -203,9 +196,9 @@ size_t
 coxmatches::length() const
 {
 	size_t len = 0;
-	for (std::map<uint32_t, coxmatch>::const_iterator
+	for (oxm_map_t::const_iterator
 			it = matches.begin(); it != matches.end(); ++it) {
-		len += it->second.length();
+		len += it->second.memlen();
 	}
 	return len;
 }
@@ -239,22 +232,22 @@ coxmatches::contains(
 	}
 
 	// strict: check all TLVs for specific class in oxl.matches => must exist and have same value
-	for (std::map<uint32_t, coxmatch>::iterator
+	// both lists are sorted by oxm-id, so walk them in parallel
+	oxm_map_t::const_iterator rt = oxms.matches.begin();
+	for (oxm_map_t::const_iterator
 			jt = matches.begin(); jt != matches.end(); ++jt) {
 
-		coxmatch& lmatch = (jt->second);
-
-		// keep in mind: match.get_oxm_id() & 0xfffffe00 == jt->first
+		while ((rt != oxms.matches.end()) && (rt->first < jt->first)) {
+			++rt;
+		}
 
 		// strict: all OXM TLVs must also exist in oxl
-		if (oxms.matches.find(lmatch.get_oxm_id() & 0xfffffe00) == oxms.matches.end()) {
+		if ((rt == oxms.matches.end()) || (rt->first != jt->first)) {
 			return false;
 		}
 
-		coxmatch const& rmatch = (oxms.matches.find(jt->first)->second);
-
 		// strict: both OXM TLVs must have identical values
-		if (lmatch != rmatch) {
+		if (jt->second != rt->second) {
 			return false;
 		}
 	}
@@ -274,18 +267,20 @@ coxmatches::is_part_of(
 {
 	bool result = true;
 
-	for (std::map<uint32_t, coxmatch>::const_iterator
+	// both lists are sorted by oxm-id, so walk them in parallel
+	oxm_map_t::const_iterator lt = matches.begin();
+	for (oxm_map_t::const_iterator
 			jt = oxms.matches.begin(); jt != oxms.matches.end(); ++jt) {
 
-		coxmatch const& rmatch = (jt->second);
-
-		// keep in mind: match.get_oxm_id() & 0xfffffe00 == jt->first
+		while ((lt != matches.end()) && (lt->first < jt->first)) {
+			++lt;
+		}
 
-		if (matches.find(rmatch.get_oxm_id() & 0xfffffe00) == matches.end()) {
+		if ((lt == matches.end()) || (lt->first != jt->first)) {
 			wildcard_hits++; continue;
 		}
 
-		if (matches[jt->first] != rmatch) {
+		if (lt->second != jt->second) {
 			missed++; result = false; continue;
 		}
 
@@ -20,6 +20,7 @@
 #include <algorithm>
 
 #include "rofl/common/cmemory.h"
+#include "rofl/common/cflatmap.h"
 #include "rofl/common/croflexception.h"
 #include "rofl/common/openflow/openflow_rofl_exceptions.h"
 
@@ -43,10 +44,18 @@ class eOxmListOutOfRange 	: public eOxmListBase {}; // out of range
 /** this class contains a list of Openflow eXtensible Matches (OXM)
  * it does not contain a full struct ofp_match, see class cofmatch for this
  *
+ * OXM TLVs are stored in a vector sorted by class and field, so packing
+ * walks a single array and comparing two lists is a merge of both.
  */
 class coxmatches
 {
-	std::map<uint32_t, coxmatch>	matches;
+public:
+
+	typedef rofl::cflatmap<uint32_t, coxmatch>	oxm_map_t;
+
+private:
+
+	oxm_map_t	matches;
 
 public:
 
@@ -109,13 +118,13 @@ public:
 	/**
 	 *
 	 */
-	std::map<uint32_t, coxmatch>&
+	oxm_map_t&
 	set_matches() { return matches; }
 
 	/**
 	 *
 	 */
-	std::map<uint32_t, coxmatch> const&
+	oxm_map_t const&
 	get_matches() const { return matches; }
 
 	/**
@@ -193,7 +202,7 @@ public:
 	operator<< (std::ostream& os, coxmatches const& oxl) {
 		os << rofl::indent(0) << "<coxmatches #matches:" << oxl.matches.size() << " >" << std::endl;
 		rofl::indent i(2);
-		for (std::map<uint32_t, coxmatch>::const_iterator
+		for (oxm_map_t::const_iterator
 				it = oxl.matches.begin(); it != oxl.matches.end(); ++it) {
 			os << coxmatch_output(it->second);
 		}
@@ -4,6 +4,8 @@
 
 #include "rofl/common/openflow/messages/cofmsg.h"
 
+#include <new>
+
 using namespace rofl::openflow;
 
 
@@ -197,6 +199,26 @@ cofmsg::~cofmsg()
 
 
 
+void*
+cofmsg::operator new(size_t size)
+{
+	void* ptr = rofl::cmempool::allocate(size);
+	if (0 == ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+
+
+void
+cofmsg::operator delete(void* ptr)
+{
+	rofl::cmempool::release(ptr);
+}
+
+
+
 cofmsg&
 cofmsg::operator=(const cofmsg &p)
 {
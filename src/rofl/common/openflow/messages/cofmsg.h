@@ -20,6 +20,7 @@
 #include "rofl/common/openflow/openflow_rofl_exceptions.h"
 #include "rofl/common/fframe.h"
 #include "rofl/common/cpacket.h"
+#include "rofl/common/cmempool.h"
 
 #include "rofl/common/openflow/openflow.h"
 #if 0
@@ -136,6 +137,20 @@ public:
 	~cofmsg();
 
 
+	/** allocate message instances from rofl::cmempool
+	 *
+	 */
+	static void*
+	operator new(size_t size);
+
+
+	/** return message instances to rofl::cmempool
+	 *
+	 */
+	static void
+	operator delete(void* ptr);
+
+
 	/** assignment operator
 	 *
 	 */
@@ -130,6 +130,50 @@ private:
 	rofl::openflow::cofflowmod	flowmod;
 };
 
+
+/**
+ * @brief	Flow-Mod message whose frame is already serialized, e.g., by rofl::openflow::cofflowmodtemplate
+ *
+ * The frame is sent as is: length() returns the frame length and pack()
+ * copies the frame without packing a cofflowmod. get_flowmod() returns an
+ * empty instance unless validate() is called.
+ */
+class cofmsg_flow_mod_packed : public cofmsg_flow_mod {
+public:
+
+	/**
+	 * @brief	Takes ownership of memarea containing a complete Flow-Mod message.
+	 */
+	cofmsg_flow_mod_packed(
+			cmemory *memarea) :
+				cofmsg_flow_mod(memarea)
+	{};
+
+	/**
+	 *
+	 */
+	virtual
+	~cofmsg_flow_mod_packed()
+	{};
+
+public:
+
+	/**
+	 *
+	 */
+	virtual size_t
+	length() const
+	{ return cofmsg::framelen(); };
+
+	/**
+	 *
+	 */
+	virtual void
+	pack(
+			uint8_t *buf = (uint8_t*)0, size_t buflen = 0)
+	{ cofmsg::pack(buf, buflen); };
+};
+
 } // end of namespace openflow
 } // end of namespace rofl
 
@@ -190,6 +190,64 @@ public:
 	};
 };
 
+
+/**
+ * @brief	Sequence of serialized Packet-Out messages, e.g., built by rofl::openflow::cofpacketoutbatch
+ *
+ * The frame holds one or more complete Packet-Out messages back-to-back
+ * and is queued and sent as a single unit: length() returns the length of
+ * all messages and pack() copies the frame as is. The header accessors
+ * refer to the first message.
+ */
+class cofmsg_packet_out_batch : public cofmsg_packet_out {
+public:
+
+	/**
+	 * @brief	Takes ownership of memarea containing num_messages Packet-Out messages.
+	 */
+	cofmsg_packet_out_batch(
+			cmemory *memarea,
+			unsigned int num_messages) :
+				cofmsg_packet_out(memarea),
+				num_messages(num_messages)
+	{};
+
+	/**
+	 *
+	 */
+	virtual
+	~cofmsg_packet_out_batch()
+	{};
+
+public:
+
+	/**
+	 *
+	 */
+	virtual size_t
+	length() const
+	{ return cofmsg::framelen(); };
+
+	/**
+	 *
+	 */
+	virtual void
+	pack(
+			uint8_t *buf = (uint8_t*)0, size_t buflen = 0)
+	{ cofmsg::pack(buf, buflen); };
+
+	/**
+	 *
+	 */
+	unsigned int
+	get_num_messages() const
+	{ return num_messages; };
+
+private:
+
+	unsigned int	num_messages;
+};
+
 } // end of namespace openflow
 } // end of namespace rofl
 
@@ -0,0 +1,218 @@
+/*
+ * cofmsg_view.cc
+ */
+
+#include "rofl/common/openflow/messages/cofmsg_view.h"
+
+using namespace rofl::openflow;
+
+cofmsg_view::cofmsg_view(
+		uint8_t const* buf,
+		size_t buflen) :
+				buf(buf),
+				buflen(buflen),
+				packet_in(false),
+				match_tlvs_off(0),
+				match_tlvs_len(0),
+				payload_off(0),
+				payload_len(0)
+{
+	if ((NULL == buf) || (buflen < sizeof(struct rofl::openflow::ofp_header)))
+		throw eBadSyntaxTooShort();
+
+	if (get_length() != buflen)
+		throw eBadSyntaxTooShort();
+
+	switch (get_version()) {
+	case rofl::openflow10::OFP_VERSION: {
+		if (rofl::openflow10::OFPT_PACKET_IN == get_type())
+			parse_packet_in();
+	} break;
+	case rofl::openflow12::OFP_VERSION: {
+		if (rofl::openflow12::OFPT_PACKET_IN == get_type())
+			parse_packet_in();
+	} break;
+	case rofl::openflow13::OFP_VERSION: {
+		if (rofl::openflow13::OFPT_PACKET_IN == get_type())
+			parse_packet_in();
+	} break;
+	default: {
+		// no typed accessors for unknown versions
+	};
+	}
+}
+
+
+
+void
+cofmsg_view::parse_packet_in()
+{
+	size_t static_hdr_len = 0;
+	struct rofl::openflow13::ofp_match const* match = NULL;
+
+	switch (get_version()) {
+	case rofl::openflow10::OFP_VERSION: {
+		if (buflen < (size_t)rofl::openflow10::OFP_PACKET_IN_STATIC_HDR_LEN)
+			throw eBadSyntaxTooShort();
+
+		payload_off = rofl::openflow10::OFP_PACKET_IN_STATIC_HDR_LEN;
+		payload_len = buflen - payload_off;
+		packet_in = true;
+	} return;
+	case rofl::openflow12::OFP_VERSION: {
+		if (buflen < sizeof(struct rofl::openflow12::ofp_packet_in))
+			throw eBadSyntaxTooShort();
+
+		static_hdr_len = rofl::openflow12::OFP_PACKET_IN_STATIC_HDR_LEN;
+		match = (struct rofl::openflow13::ofp_match const*)
+				&(((struct rofl::openflow12::ofp_packet_in const*)buf)->match);
+	} break;
+	case rofl::openflow13::OFP_VERSION: {
+		if (buflen < sizeof(struct rofl::openflow13::ofp_packet_in))
+			throw eBadSyntaxTooShort();
+
+		static_hdr_len = rofl::openflow13::OFP_PACKET_IN_STATIC_HDR_LEN;
+		match = &(((struct rofl::openflow13::ofp_packet_in const*)buf)->match);
+	} break;
+	default:
+		return;
+	}
+
+	// OF1.2 and OF1.3 share the layout of struct ofp_match
+	if (be16toh(match->type) != rofl::openflow13::OFPMT_OXM)
+		throw eBadSyntax();
+
+	size_t match_len = be16toh(match->length);
+
+	if (match_len < 2 * sizeof(uint16_t))
+		throw eBadSyntaxTooShort();
+
+	// struct ofp_match is padded to a multiple of 8 bytes, followed by 2 bytes of padding
+	size_t offset = static_hdr_len + ((match_len + 7) & ~((size_t)7)) + 2;
+
+	if (offset > buflen)
+		throw eBadSyntaxTooShort();
+
+	match_tlvs_off = static_hdr_len + 2 * sizeof(uint16_t);
+	match_tlvs_len = match_len - 2 * sizeof(uint16_t);
+	payload_off = offset;
+	payload_len = buflen - offset;
+	packet_in = true;
+}
+
+
+
+uint32_t
+cofmsg_view::get_buffer_id() const
+{
+	check_packet_in();
+	// buffer_id follows struct ofp_header in all versions
+	return be32toh(((struct rofl::openflow10::ofp_packet_in const*)buf)->buffer_id);
+}
+
+
+
+uint16_t
+cofmsg_view::get_total_len() const
+{
+	check_packet_in();
+	switch (get_version()) {
+	case rofl::openflow10::OFP_VERSION:
+		return be16toh(((struct rofl::openflow10::ofp_packet_in const*)buf)->total_len);
+	case rofl::openflow12::OFP_VERSION:
+		return be16toh(((struct rofl::openflow12::ofp_packet_in const*)buf)->total_len);
+	default:
+		return be16toh(((struct rofl::openflow13::ofp_packet_in const*)buf)->total_len);
+	}
+}
+
+
+
+uint8_t
+cofmsg_view::get_reason() const
+{
+	check_packet_in();
+	switch (get_version()) {
+	case rofl::openflow10::OFP_VERSION:
+		return ((struct rofl::openflow10::ofp_packet_in const*)buf)->reason;
+	case rofl::openflow12::OFP_VERSION:
+		return ((struct rofl::openflow12::ofp_packet_in const*)buf)->reason;
+	default:
+		return ((struct rofl::openflow13::ofp_packet_in const*)buf)->reason;
+	}
+}
+
+
+
+uint8_t
+cofmsg_view::get_table_id() const
+{
+	check_packet_in();
+	switch (get_version()) {
+	case rofl::openflow10::OFP_VERSION:
+		return 0;
+	case rofl::openflow12::OFP_VERSION:
+		return ((struct rofl::openflow12::ofp_packet_in const*)buf)->table_id;
+	default:
+		return ((struct rofl::openflow13::ofp_packet_in const*)buf)->table_id;
+	}
+}
+
+
+
+uint64_t
+cofmsg_view::get_cookie() const
+{
+	check_packet_in();
+	if (rofl::openflow13::OFP_VERSION != get_version())
+		return 0;
+	return be64toh(((struct rofl::openflow13::ofp_packet_in const*)buf)->cookie);
+}
+
+
+
+uint32_t
+cofmsg_view::get_in_port() const
+{
+	check_packet_in();
+	if (rofl::openflow10::OFP_VERSION == get_version()) {
+		return be16toh(((struct rofl::openflow10::ofp_packet_in const*)buf)->in_port);
+	}
+
+	uint8_t const* tlv = find_match_tlv(rofl::openflow::OXM_TLV_BASIC_IN_PORT);
+	if ((NULL == tlv) || (tlv[3] < sizeof(uint32_t)))
+		throw eBadSyntax();
+
+	uint32_t in_port;
+	memcpy(&in_port, tlv + sizeof(struct rofl::openflow::ofp_oxm_hdr), sizeof(in_port));
+	return be32toh(in_port);
+}
+
+
+
+uint8_t const*
+cofmsg_view::find_match_tlv(
+		uint32_t oxm_id) const
+{
+	check_packet_in();
+
+	size_t offset = 0;
+	while ((match_tlvs_len - offset) >= sizeof(struct rofl::openflow::ofp_oxm_hdr)) {
+		uint8_t const* tlv = buf + match_tlvs_off + offset;
+		size_t tlv_len = sizeof(struct rofl::openflow::ofp_oxm_hdr) + tlv[3];
+
+		if (tlv_len > (match_tlvs_len - offset))
+			return NULL; // truncated TLV
+
+		// compare class and field only, i.e., match masked variants as well
+		uint32_t hdr;
+		memcpy(&hdr, tlv, sizeof(hdr));
+		if (((be32toh(hdr) ^ oxm_id) & 0xfffffe00) == 0)
+			return tlv;
+
+		offset += tlv_len;
+	}
+	return NULL;
+}
+
+
@@ -0,0 +1,249 @@
+/*
+ * cofmsg_view.h
+ */
+
+#ifndef COFMSG_VIEW_H_
+#define COFMSG_VIEW_H_ 1
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <endian.h>
+#ifndef htobe16
+	#include "../../endian_conversion.h"
+#endif
+
+#include <iostream>
+
+#include "rofl/common/croflexception.h"
+#include "rofl/common/logging.h"
+#include "rofl/common/openflow/openflow.h"
+#include "rofl/common/openflow/openflow_rofl_exceptions.h"
+
+namespace rofl {
+namespace openflow {
+
+/**
+ * @ingroup common_devel_openflow_messages
+ * @brief	Non-owning, read-only view on a received OpenFlow message.
+ *
+ * A cofmsg_view offers typed accessors directly on top of the receive
+ * buffer of a rofl::crofsock instance. No heap memory is allocated and
+ * no match, action or packet objects are unpacked. A view is valid only
+ * for the duration of the callback it has been handed to. Use
+ * rofl::crofsock::materialize() for creating a full rofl::openflow::cofmsg
+ * instance from a view.
+ *
+ * All accessors for Packet-In specific fields throw eBadRequestBadType
+ * when the message is not a Packet-In.
+ */
+class cofmsg_view {
+public:
+
+	/**
+	 * @brief	Creates a view on a complete OpenFlow message of length "buflen".
+	 *
+	 * @throws eBadSyntaxTooShort if buflen is shorter than struct ofp_header
+	 * or the header's length field does not match buflen.
+	 */
+	cofmsg_view(
+			uint8_t const* buf,
+			size_t buflen);
+
+	/**
+	 *
+	 */
+	~cofmsg_view()
+	{};
+
+public:
+
+	/**
+	 *
+	 */
+	uint8_t const*
+	somem() const
+	{ return buf; };
+
+	/**
+	 *
+	 */
+	size_t
+	memlen() const
+	{ return buflen; };
+
+	/**
+	 *
+	 */
+	uint8_t
+	get_version() const
+	{ return ((struct rofl::openflow::ofp_header const*)buf)->version; };
+
+	/**
+	 *
+	 */
+	uint8_t
+	get_type() const
+	{ return ((struct rofl::openflow::ofp_header const*)buf)->type; };
+
+	/**
+	 *
+	 */
+	uint16_t
+	get_length() const
+	{ return be16toh(((struct rofl::openflow::ofp_header const*)buf)->length); };
+
+	/**
+	 *
+	 */
+	uint32_t
+	get_xid() const
+	{ return be32toh(((struct rofl::openflow::ofp_header const*)buf)->xid); };
+
+	/**
+	 * @brief	Returns true for an OpenFlow Packet-In message passing all length checks.
+	 */
+	bool
+	is_packet_in() const
+	{ return packet_in; };
+
+public:
+
+	/**
+	 * @name	Packet-In accessors
+	 */
+
+	/**@{*/
+
+	/**
+	 *
+	 */
+	uint32_t
+	get_buffer_id() const;
+
+	/**
+	 *
+	 */
+	uint16_t
+	get_total_len() const;
+
+	/**
+	 *
+	 */
+	uint8_t
+	get_reason() const;
+
+	/**
+	 * @brief	Returns table_id (OF1.2 and beyond), 0 for OF1.0.
+	 */
+	uint8_t
+	get_table_id() const;
+
+	/**
+	 * @brief	Returns cookie (OF1.3 only), 0 otherwise.
+	 */
+	uint64_t
+	get_cookie() const;
+
+	/**
+	 * @brief	Returns the ingress port.
+	 *
+	 * For OF1.0 this is the in_port field from the static header, for OF1.2
+	 * and beyond the OXM TLV OFPXMT_OFB_IN_PORT is searched in the match.
+	 *
+	 * @throws eBadSyntax if no valid in_port TLV exists in the match (OF1.2/1.3)
+	 */
+	uint32_t
+	get_in_port() const;
+
+	/**
+	 * @brief	Returns pointer to first OXM TLV in match or NULL (OF1.0 or empty match).
+	 */
+	uint8_t const*
+	get_match_tlvs() const
+	{ check_packet_in(); return (match_tlvs_len > 0) ? buf + match_tlvs_off : (uint8_t const*)0; };
+
+	/**
+	 * @brief	Returns the length of all OXM TLVs in the match without padding.
+	 */
+	size_t
+	get_match_tlvs_len() const
+	{ check_packet_in(); return match_tlvs_len; };
+
+	/**
+	 * @brief	Searches for an OXM TLV within the match.
+	 *
+	 * Only class and field of oxm_id are compared, so the TLV found may
+	 * carry a mask and its length may differ from oxm_id's length.
+	 *
+	 * @param oxm_id OXM header (class, field, hasmask, length) as defined in openflow_common.h
+	 * @return pointer to the TLV's header or NULL
+	 */
+	uint8_t const*
+	find_match_tlv(
+			uint32_t oxm_id) const;
+
+	/**
+	 * @brief	Returns pointer to the Ethernet frame or NULL if the frame is empty.
+	 */
+	uint8_t const*
+	get_payload() const
+	{ check_packet_in(); return (payload_len > 0) ? buf + payload_off : (uint8_t const*)0; };
+
+	/**
+	 *
+	 */
+	size_t
+	get_payload_len() const
+	{ check_packet_in(); return payload_len; };
+
+	/**@}*/
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, cofmsg_view const& view) {
+		os << indent(0) << "<cofmsg_view version: " << (int)view.get_version()
+				<< " type: " << (int)view.get_type()
+				<< " length: " << (int)view.get_length()
+				<< " xid: 0x" << std::hex << view.get_xid() << std::dec << " >" << std::endl;
+		if (view.is_packet_in()) {
+			os << indent(2) << "<packet-in buffer_id: 0x" << std::hex << view.get_buffer_id() << std::dec
+					<< " total_len: " << (int)view.get_total_len()
+					<< " reason: " << (int)view.get_reason()
+					<< " #match: " << view.get_match_tlvs_len()
+					<< " #payload: " << view.get_payload_len() << " >" << std::endl;
+		}
+		return os;
+	};
+
+private:
+
+	/**
+	 *
+	 */
+	void
+	parse_packet_in();
+
+	/**
+	 *
+	 */
+	void
+	check_packet_in() const
+	{ if (not packet_in) throw eBadRequestBadType(); };
+
+private:
+
+	uint8_t const*		buf;
+	size_t				buflen;
+
+	bool				packet_in;
+	size_t				match_tlvs_off;
+	size_t				match_tlvs_len;
+	size_t				payload_off;
+	size_t				payload_len;
+};
+
+}; // end of namespace openflow
+}; // end of namespace rofl
+
+#endif /* COFMSG_VIEW_H_ */
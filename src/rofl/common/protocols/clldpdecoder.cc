@@ -0,0 +1,128 @@
+/*
+ * clldpdecoder.cc
+ */
+
+#include "rofl/common/protocols/clldpdecoder.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <endian.h>
+
+using namespace rofl::protocol::lldp;
+
+namespace {
+
+uint16_t const LLDP_ETHER_TYPE		= 0x88cc;
+uint16_t const VLAN_CTAG_ETHER		= 0x8100;
+uint16_t const VLAN_STAG_ETHER		= 0x88a8;
+
+unsigned int const HAS_CHASSIS_ID	= (1 << 0);
+unsigned int const HAS_PORT_ID		= (1 << 1);
+unsigned int const HAS_TTL			= (1 << 2);
+unsigned int const HAS_MANDATORY	= HAS_CHASSIS_ID | HAS_PORT_ID | HAS_TTL;
+
+inline uint16_t
+rd16(const uint8_t* buf)
+{
+	uint16_t value;
+	memcpy(&value, buf, sizeof(value));
+	return be16toh(value);
+}
+
+}; // end of anonymous namespace
+
+
+
+/*static*/bool
+clldpdecoder::decode(
+		const uint8_t* buf,
+		size_t buflen,
+		clldpinfo& info)
+{
+	memset(&info, 0, sizeof(info));
+
+	if ((NULL == buf) || (buflen < sizeof(struct lldp_hdr_t))) {
+		return false;
+	}
+
+	size_t off = sizeof(struct lldp_hdr_t);
+	uint16_t eth_type = rd16(buf + offsetof(struct lldp_hdr_t, eth_type));
+	if ((VLAN_CTAG_ETHER == eth_type) || (VLAN_STAG_ETHER == eth_type)) {
+		if (buflen < off + 4)
+			return false;
+		eth_type = rd16(buf + off + 2);
+		off += 4;
+	}
+	if (LLDP_ETHER_TYPE != eth_type) {
+		return false;
+	}
+	info.eth_src = buf + offsetof(struct lldp_hdr_t, eth_src);
+
+	unsigned int found = 0;
+
+	while ((off + sizeof(struct lldp_tlv_hdr_t) <= buflen) && (found != HAS_MANDATORY)) {
+		uint16_t tlen = rd16(buf + off);
+		size_t len = tlen & 0x1ff;
+		const uint8_t* body = buf + off + sizeof(struct lldp_tlv_hdr_t);
+
+		if (off + sizeof(struct lldp_tlv_hdr_t) + len > buflen) {
+			return false;
+		}
+
+		switch (tlen >> 9) {
+		case LLDPTT_END: {
+			return false;
+		} break;
+		case LLDPTT_CHASSIS_ID: {
+			if (len < 2)
+				return false;
+			info.chassis_id_subtype = body[0];
+			info.chassis_id = body + 1;
+			info.chassis_id_len = len - 1;
+			found |= HAS_CHASSIS_ID;
+		} break;
+		case LLDPTT_PORT_ID: {
+			if (len < 2)
+				return false;
+			info.port_id_subtype = body[0];
+			info.port_id = body + 1;
+			info.port_id_len = len - 1;
+			found |= HAS_PORT_ID;
+		} break;
+		case LLDPTT_TTL: {
+			if (len < 2)
+				return false;
+			info.ttl = rd16(body);
+			found |= HAS_TTL;
+		} break;
+		default: {
+			// optional TLV
+		};
+		}
+
+		off += sizeof(struct lldp_tlv_hdr_t) + len;
+	}
+
+	return (found == HAS_MANDATORY);
+}
+
+
+
+namespace rofl {
+namespace protocol {
+namespace lldp {
+
+std::ostream&
+operator<< (std::ostream& os, const clldpinfo& info)
+{
+	os << rofl::indent(0) << "<clldpinfo chassis-id-subtype: " << (unsigned int)info.chassis_id_subtype
+			<< " chassis-id-len: " << info.chassis_id_len
+			<< " port-id-subtype: " << (unsigned int)info.port_id_subtype
+			<< " port-id-len: " << info.port_id_len
+			<< " ttl: " << info.ttl << " >" << std::endl;
+	return os;
+}
+
+}; // end of namespace lldp
+}; // end of namespace protocol
+}; // end of namespace rofl
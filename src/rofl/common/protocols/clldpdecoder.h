@@ -0,0 +1,78 @@
+/*
+ * clldpdecoder.h
+ */
+
+#ifndef CLLDPDECODER_H_
+#define CLLDPDECODER_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <ostream>
+
+#include "rofl/common/cpacket.h"
+#include "rofl/common/logging.h"
+#include "rofl/common/protocols/clldpattr.h"
+
+namespace rofl {
+namespace protocol {
+namespace lldp {
+
+/**
+ * @ingroup common_devel_protocols
+ * @brief	Mandatory fields of an LLDP frame determined by rofl::protocol::lldp::clldpdecoder
+ *
+ * IDs point into the decoded buffer and remain valid as long as the
+ * buffer does.
+ */
+struct clldpinfo {
+	const uint8_t*		eth_src;			// 6 bytes
+	uint8_t				chassis_id_subtype;
+	const uint8_t*		chassis_id;
+	size_t				chassis_id_len;
+	uint8_t				port_id_subtype;
+	const uint8_t*		port_id;
+	size_t				port_id_len;
+	uint16_t			ttl;
+
+	friend std::ostream&
+	operator<< (std::ostream& os, const clldpinfo& info);
+};
+
+/**
+ * @ingroup common_devel_protocols
+ * @brief	Zero-allocation decoder for LLDP frames, e.g., in Packet-In payloads
+ *
+ * Unlike clldpmsg::unpack(), which creates a clldpattr per TLV, decode()
+ * walks the frame once and extracts the chassis ID, port ID and TTL
+ * without copying, allocating or throwing. A single VLAN tag is skipped.
+ * Optional TLVs are ignored.
+ */
+class clldpdecoder {
+public:
+
+	/**
+	 * @brief	Decodes the LLDP frame in buf.
+	 *
+	 * @return false when buf is not an LLDP frame or lacks a well-formed chassis ID, port ID or TTL TLV
+	 */
+	static bool
+	decode(
+			const uint8_t* buf,
+			size_t buflen,
+			clldpinfo& info);
+
+	/**
+	 * @brief	Decodes the LLDP frame in pkt.
+	 */
+	static bool
+	decode(
+			const rofl::cpacket& pkt,
+			clldpinfo& info)
+	{ return decode(pkt.soframe(), pkt.length(), info); };
+};
+
+}; // end of namespace lldp
+}; // end of namespace protocol
+}; // end of namespace rofl
+
+#endif /* CLLDPDECODER_H_ */
@@ -0,0 +1,148 @@
+/*
+ * clldptemplate.cc
+ */
+
+#include "rofl/common/protocols/clldptemplate.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <endian.h>
+
+using namespace rofl::protocol::lldp;
+
+/*static*/uint16_t const clldptemplate::LLDP_ETHER_TYPE;
+/*static*/uint16_t const clldptemplate::DEFAULT_TTL;
+
+namespace {
+
+// TLV header (2 bytes) and subtype
+size_t const ID_TLV_OVERHEAD	= sizeof(struct lldp_tlv_id_hdr_t);
+// TTL TLV and End TLV
+size_t const TAIL_LEN			= sizeof(struct lldp_tlv_ttl_hdr_t) + sizeof(struct lldp_tlv_hdr_t);
+
+inline uint16_t
+tlen(uint8_t type, size_t len)
+{
+	return htobe16((uint16_t)((type << 9) | (len & 0x1ff)));
+}
+
+}; // end of anonymous namespace
+
+
+
+clldptemplate::clldptemplate(
+		const rofl::cmacaddr& eth_src,
+		uint8_t chassis_id_subtype,
+		const uint8_t* chassis_id,
+		size_t chassis_id_len,
+		uint8_t port_id_subtype,
+		const uint8_t* port_id,
+		size_t port_id_len,
+		uint16_t ttl,
+		const rofl::cmacaddr& eth_dst) :
+				frame((size_t)0),
+				port_id_offset(0),
+				ttl_offset(0)
+{
+	if ((NULL == chassis_id) || (0 == chassis_id_len) || (chassis_id_len > 255) ||
+			(NULL == port_id) || (0 == port_id_len) || (port_id_len > 255)) {
+		throw eLLDPTemplateInval();
+	}
+
+	port_id_offset = sizeof(struct lldp_hdr_t) + ID_TLV_OVERHEAD + chassis_id_len;
+	ttl_offset = port_id_offset + ID_TLV_OVERHEAD + port_id_len;
+	frame.resize(ttl_offset + TAIL_LEN);
+
+	struct lldp_hdr_t* hdr = (struct lldp_hdr_t*)frame.somem();
+	memcpy(hdr->eth_dst, eth_dst.somem(), ETH_ALEN);
+	memcpy(hdr->eth_src, eth_src.somem(), ETH_ALEN);
+	hdr->eth_type = htobe16(LLDP_ETHER_TYPE);
+
+	write_id(frame.somem() + sizeof(struct lldp_hdr_t), LLDPTT_CHASSIS_ID,
+			chassis_id_subtype, chassis_id, chassis_id_len);
+	write_id(frame.somem() + port_id_offset, LLDPTT_PORT_ID,
+			port_id_subtype, port_id, port_id_len);
+	write_tail(ttl);
+}
+
+
+
+void
+clldptemplate::set_ttl(
+		uint16_t ttl)
+{
+	uint16_t value = htobe16(ttl);
+	memcpy(frame.somem() + ttl_offset + offsetof(struct lldp_tlv_ttl_hdr_t, ttl), &value, sizeof(value));
+}
+
+
+
+uint16_t
+clldptemplate::get_ttl() const
+{
+	uint16_t value;
+	memcpy(&value, frame.somem() + ttl_offset + offsetof(struct lldp_tlv_ttl_hdr_t, ttl), sizeof(value));
+	return be16toh(value);
+}
+
+
+
+void
+clldptemplate::set_eth_src(
+		const rofl::cmacaddr& eth_src)
+{
+	memcpy(((struct lldp_hdr_t*)frame.somem())->eth_src, eth_src.somem(), ETH_ALEN);
+}
+
+
+
+void
+clldptemplate::set_port_id(
+		uint8_t port_id_subtype,
+		const uint8_t* port_id,
+		size_t port_id_len)
+{
+	if ((NULL == port_id) || (0 == port_id_len) || (port_id_len > 255)) {
+		throw eLLDPTemplateInval();
+	}
+
+	size_t new_ttl_offset = port_id_offset + ID_TLV_OVERHEAD + port_id_len;
+	if (new_ttl_offset != ttl_offset) {
+		uint16_t ttl = get_ttl();
+		frame.resize(new_ttl_offset + TAIL_LEN);
+		ttl_offset = new_ttl_offset;
+		write_tail(ttl);
+	}
+	write_id(frame.somem() + port_id_offset, LLDPTT_PORT_ID,
+			port_id_subtype, port_id, port_id_len);
+}
+
+
+
+/*static*/size_t
+clldptemplate::write_id(
+		uint8_t* buf,
+		uint8_t type,
+		uint8_t subtype,
+		const uint8_t* id,
+		size_t idlen)
+{
+	struct lldp_tlv_id_hdr_t* tlv = (struct lldp_tlv_id_hdr_t*)buf;
+	tlv->hdr.tlen = tlen(type, sizeof(tlv->subtype) + idlen);
+	tlv->subtype = subtype;
+	memcpy(tlv->body, id, idlen);
+	return ID_TLV_OVERHEAD + idlen;
+}
+
+
+
+void
+clldptemplate::write_tail(
+		uint16_t ttl)
+{
+	struct lldp_tlv_ttl_hdr_t* tlv = (struct lldp_tlv_ttl_hdr_t*)(frame.somem() + ttl_offset);
+	tlv->hdr.tlen = tlen(LLDPTT_TTL, sizeof(tlv->ttl));
+	tlv->ttl = htobe16(ttl);
+	struct lldp_tlv_hdr_t* end = (struct lldp_tlv_hdr_t*)(frame.somem() + ttl_offset + sizeof(struct lldp_tlv_ttl_hdr_t));
+	end->tlen = tlen(LLDPTT_END, 0);
+}
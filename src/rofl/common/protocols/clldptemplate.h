@@ -0,0 +1,181 @@
+/*
+ * clldptemplate.h
+ */
+
+#ifndef CLLDPTEMPLATE_H_
+#define CLLDPTEMPLATE_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <string>
+
+#include "rofl/common/cmemory.h"
+#include "rofl/common/caddress.h"
+#include "rofl/common/logging.h"
+#include "rofl/common/croflexception.h"
+#include "rofl/common/protocols/clldpattr.h"
+
+namespace rofl {
+namespace protocol {
+namespace lldp {
+
+class eLLDPTemplateBase		: public RoflException {};
+class eLLDPTemplateInval	: public eLLDPTemplateBase {};
+
+/**
+ * @ingroup common_devel_protocols
+ * @brief	Precomputed LLDP frame for a single port
+ *
+ * Holds a wire-ready LLDP frame with Ethernet header and the mandatory
+ * chassis ID, port ID and TTL TLVs followed by an End TLV. The frame is
+ * built once and fields are patched in place, so emitting discovery
+ * frames needs neither clldpattr instances nor packing per tick. Changing
+ * the length of the port ID moves the TTL and End TLVs only. Use one
+ * instance per port, e.g., together with
+ * rofl::openflow::cofpacketoutbatch.
+ */
+class clldptemplate {
+public:
+
+	static uint16_t const LLDP_ETHER_TYPE = 0x88cc;
+	static uint16_t const DEFAULT_TTL = 120;
+
+public:
+
+	/**
+	 * @brief	Builds the LLDP frame.
+	 *
+	 * @throws eLLDPTemplateInval for an empty ID or an ID exceeding 255 bytes
+	 */
+	clldptemplate(
+			const rofl::cmacaddr& eth_src,
+			uint8_t chassis_id_subtype,
+			const uint8_t* chassis_id,
+			size_t chassis_id_len,
+			uint8_t port_id_subtype,
+			const uint8_t* port_id,
+			size_t port_id_len,
+			uint16_t ttl = DEFAULT_TTL,
+			const rofl::cmacaddr& eth_dst = rofl::cmacaddr("01:80:c2:00:00:0e"));
+
+	/**
+	 *
+	 */
+	virtual
+	~clldptemplate()
+	{};
+
+	/**
+	 *
+	 */
+	clldptemplate(
+			const clldptemplate& tmpl) :
+				frame(tmpl.frame),
+				port_id_offset(tmpl.port_id_offset),
+				ttl_offset(tmpl.ttl_offset)
+	{};
+
+	/**
+	 *
+	 */
+	clldptemplate&
+	operator= (
+			const clldptemplate& tmpl) {
+		if (this == &tmpl)
+			return *this;
+		frame = tmpl.frame;
+		port_id_offset = tmpl.port_id_offset;
+		ttl_offset = tmpl.ttl_offset;
+		return *this;
+	};
+
+public:
+
+	/**
+	 * @brief	Patches the TTL, e.g., 0 for a shutdown frame.
+	 */
+	void
+	set_ttl(
+			uint16_t ttl);
+
+	/**
+	 *
+	 */
+	uint16_t
+	get_ttl() const;
+
+	/**
+	 * @brief	Patches the source MAC address.
+	 */
+	void
+	set_eth_src(
+			const rofl::cmacaddr& eth_src);
+
+	/**
+	 * @brief	Replaces the port ID, in place if its length remains unchanged.
+	 *
+	 * @throws eLLDPTemplateInval for an empty ID or an ID exceeding 255 bytes
+	 */
+	void
+	set_port_id(
+			uint8_t port_id_subtype,
+			const uint8_t* port_id,
+			size_t port_id_len);
+
+	/**
+	 * @brief	Returns the LLDP frame including Ethernet header.
+	 */
+	const uint8_t*
+	somem() const
+	{ return frame.somem(); };
+
+	/**
+	 *
+	 */
+	size_t
+	length() const
+	{ return frame.memlen(); };
+
+public:
+
+	friend std::ostream&
+	operator<< (std::ostream& os, const clldptemplate& tmpl) {
+		os << rofl::indent(0) << "<clldptemplate length: " << tmpl.length()
+				<< " ttl: " << tmpl.get_ttl() << " >" << std::endl;
+		rofl::indent i(2);
+		os << tmpl.frame;
+		return os;
+	};
+
+private:
+
+	/**
+	 * @brief	Writes a chassis or port ID TLV to buf, returns its length.
+	 */
+	static size_t
+	write_id(
+			uint8_t* buf,
+			uint8_t type,
+			uint8_t subtype,
+			const uint8_t* id,
+			size_t idlen);
+
+	/**
+	 * @brief	Writes TTL and End TLVs starting at ttl_offset.
+	 */
+	void
+	write_tail(
+			uint16_t ttl);
+
+private:
+
+	rofl::cmemory		frame;
+	size_t				port_id_offset;	// offset of port ID TLV
+	size_t				ttl_offset;		// offset of TTL TLV
+};
+
+}; // end of namespace lldp
+}; // end of namespace protocol
+}; // end of namespace rofl
+
+#endif /* CLLDPTEMPLATE_H_ */
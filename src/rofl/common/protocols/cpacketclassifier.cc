@@ -0,0 +1,569 @@
+/*
+ * cpacketclassifier.cc
+ */
+
+#include "cpacketclassifier.h"
+
+#include <string.h>
+#include <endian.h>
+
+#include "rofl/common/protocols/farpv4frame.h"
+#include "rofl/common/protocols/fipv4frame.h"
+#include "rofl/common/protocols/fipv6frame.h"
+#include "rofl/common/protocols/fvlanframe.h"
+#include "rofl/common/protocols/fmplsframe.h"
+#include "rofl/common/protocols/ftcpframe.h"
+#include "rofl/common/protocols/fudpframe.h"
+#include "rofl/common/protocols/fsctpframe.h"
+#include "rofl/common/protocols/ficmpv4frame.h"
+#include "rofl/common/protocols/ficmpv6frame.h"
+#include "rofl/common/protocols/fgtpuframe.h"
+#include "rofl/common/protocols/fl2tpv3frame.h"
+
+using namespace rofl;
+
+/*static*/uint16_t const cpacketinfo::OFFSET_NONE;
+/*static*/unsigned int const cpacketinfo::MAX_VLANS;
+
+namespace {
+
+static uint16_t const ETH_HDR_LEN			= 14;
+static uint16_t const MPLS_MCAST_ETHER		= 0x8848;
+static uint16_t const VLAN_QINQ_ETHER		= 0x9100;	// pre-standard S-tag
+static uint16_t const L2TPV3_UDP_PORT		= 1701;
+static uint8_t const IPPROTO_IPV6_ESP		= 50;
+static uint8_t const IPPROTO_IPV6_AUTH		= 51;
+
+inline uint16_t
+rd16(const uint8_t* buf)
+{
+	uint16_t value;
+	memcpy(&value, buf, sizeof(value));
+	return be16toh(value);
+}
+
+inline uint32_t
+rd32(const uint8_t* buf)
+{
+	uint32_t value;
+	memcpy(&value, buf, sizeof(value));
+	return be32toh(value);
+}
+
+void
+classify_gtpu(const uint8_t* buf, size_t buflen, size_t off, cpacketinfo& info)
+{
+	if (off + 8 > buflen) {
+		info.flags |= cpacketinfo::IS_TRUNCATED;
+		return;
+	}
+	uint8_t flags = buf[off];
+	if (((flags >> 5) != fgtpuframe::GTPU_VERS_1) || (0 == (flags & fgtpuframe::GTPU_PT_FLAG)))
+		return;
+
+	size_t hdrlen = 8;
+	if (flags & (fgtpuframe::GTPU_E_FLAG | fgtpuframe::GTPU_S_FLAG | fgtpuframe::GTPU_PN_FLAG)) {
+		hdrlen = 12;
+		if (off + hdrlen > buflen) {
+			info.flags |= cpacketinfo::IS_TRUNCATED;
+			return;
+		}
+		// chain of extension headers, length in units of 4 bytes, next type in last byte
+		uint8_t next = (flags & fgtpuframe::GTPU_E_FLAG) ? buf[off + 11] : 0;
+		while (0 != next) {
+			if (off + hdrlen + 1 > buflen) {
+				info.flags |= cpacketinfo::IS_TRUNCATED;
+				return;
+			}
+			size_t extlen = buf[off + hdrlen] * 4;
+			if (0 == extlen)
+				return;
+			if (off + hdrlen + extlen > buflen) {
+				info.flags |= cpacketinfo::IS_TRUNCATED;
+				return;
+			}
+			next = buf[off + hdrlen + extlen - 1];
+			hdrlen += extlen;
+		}
+	}
+
+	info.flags |= cpacketinfo::HAS_GTPU;
+	info.tunnel_offset = off;
+	info.tunnel_id = rd32(buf + off + 4);
+	info.payload_offset = off + hdrlen;
+}
+
+void
+classify_l2tpv3_udp(const uint8_t* buf, size_t buflen, size_t off, cpacketinfo& info)
+{
+	if (off + 8 > buflen) {
+		info.flags |= cpacketinfo::IS_TRUNCATED;
+		return;
+	}
+	uint16_t flags = rd16(buf + off);
+	if ((flags & VERS_MASK) != fl2tpv3frame::L2TP_VERSION_3)
+		return;
+
+	info.flags |= cpacketinfo::HAS_L2TPV3;
+	info.tunnel_offset = off;
+	// control messages carry the control connection ID instead of a session ID
+	info.tunnel_id = (flags & TBIT_FLAG) ? 0 : rd32(buf + off + 4);
+	info.payload_offset = off + 8;
+}
+
+void
+classify_l4(const uint8_t* buf, size_t buflen, size_t off, cpacketinfo& info)
+{
+	switch (info.ip_proto) {
+	case ftcpframe::TCP_IP_PROTO: {
+		if (off + 20 > buflen) {
+			info.flags |= cpacketinfo::IS_TRUNCATED;
+			return;
+		}
+		info.flags |= cpacketinfo::HAS_TCP;
+		info.l4_offset = off;
+		info.tp_src = rd16(buf + off);
+		info.tp_dst = rd16(buf + off + 2);
+		size_t doff = (buf[off + 12] >> 4) * 4;
+		if ((doff >= 20) && (off + doff <= buflen))
+			info.payload_offset = off + doff;
+	} break;
+	case fudpframe::UDP_IP_PROTO: {
+		if (off + 8 > buflen) {
+			info.flags |= cpacketinfo::IS_TRUNCATED;
+			return;
+		}
+		info.flags |= cpacketinfo::HAS_UDP;
+		info.l4_offset = off;
+		info.tp_src = rd16(buf + off);
+		info.tp_dst = rd16(buf + off + 2);
+		info.payload_offset = off + 8;
+		if (fgtpuframe::GTPU_UDP_PORT == info.tp_dst) {
+			classify_gtpu(buf, buflen, off + 8, info);
+		} else
+		if ((L2TPV3_UDP_PORT == info.tp_dst) || (L2TPV3_UDP_PORT == info.tp_src)) {
+			classify_l2tpv3_udp(buf, buflen, off + 8, info);
+		}
+	} break;
+	case fsctpframe::SCTP_IP_PROTO: {
+		if (off + 12 > buflen) {
+			info.flags |= cpacketinfo::IS_TRUNCATED;
+			return;
+		}
+		info.flags |= cpacketinfo::HAS_SCTP;
+		info.l4_offset = off;
+		info.tp_src = rd16(buf + off);
+		info.tp_dst = rd16(buf + off + 2);
+		info.payload_offset = off + 12;
+	} break;
+	case ficmpv4frame::ICMPV4_IP_PROTO:
+	case ficmpv6frame::ICMPV6_IP_PROTO: {
+		// ICMPv4 within IPv4 and ICMPv6 within IPv6 only
+		uint32_t flag = (ficmpv4frame::ICMPV4_IP_PROTO == info.ip_proto) ?
+				cpacketinfo::HAS_ICMPV4 : cpacketinfo::HAS_ICMPV6;
+		if ((cpacketinfo::HAS_ICMPV4 == flag) != info.has(cpacketinfo::HAS_IPV4))
+			return;
+		if (off + 4 > buflen) {
+			info.flags |= cpacketinfo::IS_TRUNCATED;
+			return;
+		}
+		info.flags |= flag;
+		info.l4_offset = off;
+		info.icmp_msgtype = buf[off];
+		info.icmp_msgcode = buf[off + 1];
+		if (off + 8 <= buflen)
+			info.payload_offset = off + 8;
+	} break;
+	case fl2tpv3frame::L2TPV3_IP_PROTO: {
+		if (off + 4 > buflen) {
+			info.flags |= cpacketinfo::IS_TRUNCATED;
+			return;
+		}
+		info.flags |= cpacketinfo::HAS_L2TPV3;
+		info.l4_offset = off;
+		info.tunnel_offset = off;
+		// session ID 0 indicates a control message
+		info.tunnel_id = rd32(buf + off);
+		info.payload_offset = off + 4;
+	} break;
+	default: {
+		// unknown upper layer protocol
+	};
+	}
+}
+
+void
+classify_ipv4(const uint8_t* buf, size_t buflen, size_t off, cpacketinfo& info)
+{
+	if (off + 20 > buflen) {
+		info.flags |= cpacketinfo::IS_TRUNCATED;
+		return;
+	}
+	size_t ihl = (buf[off] & 0x0f) * 4;
+	if (((buf[off] >> 4) != 4) || (ihl < 20))
+		return;
+	if (off + ihl > buflen) {
+		info.flags |= cpacketinfo::IS_TRUNCATED;
+		return;
+	}
+
+	info.flags |= cpacketinfo::HAS_IPV4;
+	info.l3_offset = off;
+	info.ip_dscp = buf[off + 1] >> 2;
+	info.ip_ecn = buf[off + 1] & 0x03;
+	info.ip_ttl = buf[off + 8];
+	info.ip_proto = buf[off + 9];
+	memcpy(info.ipv4_src, buf + off + 12, sizeof(info.ipv4_src));
+	memcpy(info.ipv4_dst, buf + off + 16, sizeof(info.ipv4_dst));
+
+	// ignore Ethernet padding
+	size_t total_len = rd16(buf + off + 2);
+	if ((total_len >= ihl) && (off + total_len < buflen))
+		buflen = off + total_len;
+
+	uint16_t frag = rd16(buf + off + 6);
+	if (frag & 0x3fff) // MF flag or fragment offset
+		info.flags |= cpacketinfo::HAS_FRAGMENT;
+	if (frag & 0x1fff)
+		return;
+
+	classify_l4(buf, buflen, off + ihl, info);
+}
+
+void
+classify_ipv6(const uint8_t* buf, size_t buflen, size_t off, cpacketinfo& info)
+{
+	if (off + 40 > buflen) {
+		info.flags |= cpacketinfo::IS_TRUNCATED;
+		return;
+	}
+	uint32_t w = rd32(buf + off);
+	if ((w >> 28) != 6)
+		return;
+
+	info.flags |= cpacketinfo::HAS_IPV6;
+	info.l3_offset = off;
+	info.ip_dscp = (w >> 22) & 0x3f;
+	info.ip_ecn = (w >> 20) & 0x03;
+	info.ipv6_flabel = w & 0x000fffff;
+	info.ip_ttl = buf[off + 7];
+	memcpy(info.ipv6_src, buf + off + 8, sizeof(info.ipv6_src));
+	memcpy(info.ipv6_dst, buf + off + 24, sizeof(info.ipv6_dst));
+
+	// ignore Ethernet padding, payload length 0 indicates a jumbogram
+	size_t payload_len = rd16(buf + off + 4);
+	if ((payload_len > 0) && (off + 40 + payload_len < buflen))
+		buflen = off + 40 + payload_len;
+
+	uint8_t nxthdr = buf[off + 6];
+	uint16_t exthdr = 0;
+	bool first_fragment = true;
+	off += 40;
+
+	// extension headers, OpenFlow 1.3 pseudo field ipv6_exthdr
+	while (true) {
+		uint16_t bit = 0;
+		switch (nxthdr) {
+		case fipv6frame::IPPROTO_IPV6_HOPOPT:	bit = rofl::openflow13::OFPIEH_HOP; break;
+		case fipv6frame::IPPROTO_IPV6_ROUTE:	bit = rofl::openflow13::OFPIEH_ROUTER; break;
+		case fipv6frame::IPPROTO_IPV6_FRAG:		bit = rofl::openflow13::OFPIEH_FRAG; break;
+		case fipv6frame::IPPROTO_IPV6_OPTS:		bit = rofl::openflow13::OFPIEH_DEST; break;
+		case IPPROTO_IPV6_AUTH:					bit = rofl::openflow13::OFPIEH_AUTH; break;
+		case IPPROTO_IPV6_ESP: {
+			// encrypted, upper layer is not accessible
+			info.ipv6_exthdr = exthdr | rofl::openflow13::OFPIEH_ESP;
+			info.ip_proto = nxthdr;
+			return;
+		} break;
+		case fipv6frame::IPPROTO_IPV6_NONXT: {
+			info.ipv6_exthdr = exthdr | rofl::openflow13::OFPIEH_NONEXT;
+			info.ip_proto = nxthdr;
+			return;
+		} break;
+		default: {
+			// upper layer protocol
+		};
+		}
+		if (0 == bit)
+			break;
+
+		if ((rofl::openflow13::OFPIEH_HOP == bit) && (0 != exthdr))
+			exthdr |= rofl::openflow13::OFPIEH_UNSEQ;
+		if ((exthdr & bit) && (rofl::openflow13::OFPIEH_DEST != bit))
+			exthdr |= rofl::openflow13::OFPIEH_UNREP;
+		exthdr |= bit;
+
+		if (off + 8 > buflen) {
+			info.ipv6_exthdr = exthdr;
+			info.flags |= cpacketinfo::IS_TRUNCATED;
+			return;
+		}
+
+		size_t hdrlen;
+		switch (bit) {
+		case rofl::openflow13::OFPIEH_FRAG: {
+			info.flags |= cpacketinfo::HAS_FRAGMENT;
+			if (rd16(buf + off + 2) & 0xfff8)
+				first_fragment = false;
+			hdrlen = 8;
+		} break;
+		case rofl::openflow13::OFPIEH_AUTH: {
+			hdrlen = (buf[off + 1] + 2) * 4;
+		} break;
+		default: {
+			hdrlen = (buf[off + 1] + 1) * 8;
+		};
+		}
+		nxthdr = buf[off];
+		off += hdrlen;
+
+		if (off > buflen) {
+			info.ipv6_exthdr = exthdr;
+			info.flags |= cpacketinfo::IS_TRUNCATED;
+			return;
+		}
+	}
+
+	info.ipv6_exthdr = exthdr;
+	info.ip_proto = nxthdr;
+
+	if (not first_fragment)
+		return;
+
+	classify_l4(buf, buflen, off, info);
+}
+
+void
+classify_arp(const uint8_t* buf, size_t buflen, size_t off, cpacketinfo& info)
+{
+	// Ethernet and IPv4 addresses only
+	if (off + 28 > buflen) {
+		info.flags |= cpacketinfo::IS_TRUNCATED;
+		return;
+	}
+	if ((1 != rd16(buf + off)) || (fipv4frame::IPV4_ETHER != rd16(buf + off + 2)) ||
+			(6 != buf[off + 4]) || (4 != buf[off + 5]))
+		return;
+
+	info.flags |= cpacketinfo::HAS_ARP;
+	info.l3_offset = off;
+	info.arp_op = rd16(buf + off + 6);
+	memcpy(info.arp_sha, buf + off + 8, sizeof(info.arp_sha));
+	memcpy(info.arp_spa, buf + off + 14, sizeof(info.arp_spa));
+	memcpy(info.arp_tha, buf + off + 18, sizeof(info.arp_tha));
+	memcpy(info.arp_tpa, buf + off + 24, sizeof(info.arp_tpa));
+}
+
+}; // end of anonymous namespace
+
+
+
+/*static*/bool
+cpacketclassifier::classify(
+		const uint8_t* buf,
+		size_t buflen,
+		cpacketinfo& info)
+{
+	memset(&info, 0, sizeof(info));
+	info.l3_offset = info.l4_offset = info.tunnel_offset = info.payload_offset = cpacketinfo::OFFSET_NONE;
+
+	if ((NULL == buf) || (buflen < ETH_HDR_LEN)) {
+		info.flags = cpacketinfo::IS_TRUNCATED;
+		return false;
+	}
+	// offsets are limited to 16 bits
+	if (buflen > cpacketinfo::OFFSET_NONE)
+		buflen = cpacketinfo::OFFSET_NONE;
+
+	memcpy(info.eth_dst, buf, sizeof(info.eth_dst));
+	memcpy(info.eth_src, buf + 6, sizeof(info.eth_src));
+	uint16_t eth_type = rd16(buf + 12);
+	size_t off = ETH_HDR_LEN;
+
+	// VLAN tags
+	while ((fvlanframe::VLAN_CTAG_ETHER == eth_type) ||
+			(fvlanframe::VLAN_STAG_ETHER == eth_type) || (VLAN_QINQ_ETHER == eth_type)) {
+		if (off + 4 > buflen) {
+			info.flags |= cpacketinfo::IS_TRUNCATED;
+			info.eth_type = eth_type;
+			return true;
+		}
+		uint16_t tci = rd16(buf + off);
+		if (info.num_vlans < cpacketinfo::MAX_VLANS) {
+			info.vlan_vid[info.num_vlans] = tci & 0x0fff;
+			info.vlan_pcp[info.num_vlans] = tci >> 13;
+		}
+		if (info.num_vlans < 0xff)
+			info.num_vlans++;
+		eth_type = rd16(buf + off + 2);
+		off += 4;
+	}
+	if (info.num_vlans > 0)
+		info.flags |= cpacketinfo::HAS_VLAN;
+	if (info.num_vlans > 1)
+		info.flags |= cpacketinfo::HAS_QINQ;
+	info.eth_type = eth_type;
+
+	// MPLS label stack, payload is guessed from IP version
+	if ((fmplsframe::MPLS_ETHER == eth_type) || (MPLS_MCAST_ETHER == eth_type)) {
+		while (true) {
+			if (off + 4 > buflen) {
+				info.flags |= cpacketinfo::IS_TRUNCATED;
+				return true;
+			}
+			uint32_t lse = rd32(buf + off);
+			if (0 == info.num_mpls) {
+				info.mpls_label = lse >> 12;
+				info.mpls_tc = (lse >> 9) & 0x07;
+				info.mpls_bos = (lse >> 8) & 0x01;
+			}
+			if (info.num_mpls < 0xff)
+				info.num_mpls++;
+			off += 4;
+			if (lse & 0x00000100)
+				break;
+		}
+		info.flags |= cpacketinfo::HAS_MPLS;
+		if (off >= buflen)
+			return true;
+		switch (buf[off] >> 4) {
+		case 4:	 eth_type = fipv4frame::IPV4_ETHER; break;
+		case 6:	 eth_type = fipv6frame::IPV6_ETHER; break;
+		default: return true;
+		}
+	}
+
+	switch (eth_type) {
+	case fipv4frame::IPV4_ETHER: {
+		classify_ipv4(buf, buflen, off, info);
+	} break;
+	case fipv6frame::IPV6_ETHER: {
+		classify_ipv6(buf, buflen, off, info);
+	} break;
+	case farpv4frame::ARPV4_ETHER: {
+		classify_arp(buf, buflen, off, info);
+	} break;
+	default: {
+		// unknown network layer protocol
+	};
+	}
+
+	return true;
+}
+
+
+
+/*static*/void
+cpacketclassifier::get_flowkey(
+		const cpacketinfo& info,
+		rofl::openflow::cofmatch& match,
+		uint32_t in_port)
+{
+	if (0 != in_port)
+		match.set_in_port(in_port);
+
+	match.set_eth_dst(rofl::cmacaddr(const_cast<uint8_t*>(info.eth_dst), sizeof(info.eth_dst)));
+	match.set_eth_src(rofl::cmacaddr(const_cast<uint8_t*>(info.eth_src), sizeof(info.eth_src)));
+	match.set_eth_type(info.eth_type);
+
+	if (info.has(cpacketinfo::HAS_VLAN)) {
+		match.set_vlan_vid(info.vlan_vid[0] | rofl::openflow13::OFPVID_PRESENT);
+		match.set_vlan_pcp(info.vlan_pcp[0]);
+	} else {
+		match.set_vlan_vid(rofl::openflow13::OFPVID_NONE);
+	}
+
+	if (info.has(cpacketinfo::HAS_MPLS)) {
+		match.set_mpls_label(info.mpls_label);
+		match.set_mpls_tc(info.mpls_tc);
+		match.set_mpls_bos(info.mpls_bos);
+		return;
+	}
+
+	if (info.has(cpacketinfo::HAS_ARP)) {
+		rofl::caddress_in4 spa, tpa;
+		uint32_t addr;
+		memcpy(&addr, info.arp_spa, sizeof(addr)); spa.set_addr_nbo(addr);
+		memcpy(&addr, info.arp_tpa, sizeof(addr)); tpa.set_addr_nbo(addr);
+		match.set_arp_opcode(info.arp_op);
+		match.set_arp_spa(spa);
+		match.set_arp_tpa(tpa);
+		match.set_arp_sha(rofl::cmacaddr(const_cast<uint8_t*>(info.arp_sha), sizeof(info.arp_sha)));
+		match.set_arp_tha(rofl::cmacaddr(const_cast<uint8_t*>(info.arp_tha), sizeof(info.arp_tha)));
+		return;
+	}
+
+	if (info.has(cpacketinfo::HAS_IPV4)) {
+		rofl::caddress_in4 src, dst;
+		uint32_t addr;
+		memcpy(&addr, info.ipv4_src, sizeof(addr)); src.set_addr_nbo(addr);
+		memcpy(&addr, info.ipv4_dst, sizeof(addr)); dst.set_addr_nbo(addr);
+		match.set_ipv4_src(src);
+		match.set_ipv4_dst(dst);
+	} else
+	if (info.has(cpacketinfo::HAS_IPV6)) {
+		rofl::caddress_in6 src, dst;
+		memcpy(src.somem(), info.ipv6_src, sizeof(info.ipv6_src));
+		memcpy(dst.somem(), info.ipv6_dst, sizeof(info.ipv6_dst));
+		match.set_ipv6_src(src);
+		match.set_ipv6_dst(dst);
+		match.set_ipv6_flabel(info.ipv6_flabel);
+		match.set_ipv6_exthdr(info.ipv6_exthdr);
+	} else {
+		return;
+	}
+	match.set_ip_dscp(info.ip_dscp);
+	match.set_ip_ecn(info.ip_ecn);
+	match.set_ip_proto(info.ip_proto);
+
+	if (info.has(cpacketinfo::HAS_TCP)) {
+		match.set_tcp_src(info.tp_src);
+		match.set_tcp_dst(info.tp_dst);
+	} else
+	if (info.has(cpacketinfo::HAS_UDP)) {
+		match.set_udp_src(info.tp_src);
+		match.set_udp_dst(info.tp_dst);
+	} else
+	if (info.has(cpacketinfo::HAS_SCTP)) {
+		match.set_sctp_src(info.tp_src);
+		match.set_sctp_dst(info.tp_dst);
+	} else
+	if (info.has(cpacketinfo::HAS_ICMPV4)) {
+		match.set_icmpv4_type(info.icmp_msgtype);
+		match.set_icmpv4_code(info.icmp_msgcode);
+	} else
+	if (info.has(cpacketinfo::HAS_ICMPV6)) {
+		match.set_icmpv6_type(info.icmp_msgtype);
+		match.set_icmpv6_code(info.icmp_msgcode);
+	}
+}
+
+
+
+namespace rofl {
+
+std::ostream&
+operator<< (std::ostream& os, const cpacketinfo& info)
+{
+	os << rofl::indent(0) << "<cpacketinfo flags: 0x" << std::hex << info.flags << std::dec
+			<< " eth-type: 0x" << std::hex << info.eth_type << std::dec
+			<< " #vlans: " << (unsigned int)info.num_vlans
+			<< " #mpls: " << (unsigned int)info.num_mpls << " >" << std::endl;
+	rofl::indent i(2);
+	os << rofl::indent(0) << "<offsets l3: " << info.l3_offset << " l4: " << info.l4_offset
+			<< " tunnel: " << info.tunnel_offset << " payload: " << info.payload_offset << " >" << std::endl;
+	if (info.has(cpacketinfo::HAS_IPV4) || info.has(cpacketinfo::HAS_IPV6)) {
+		os << rofl::indent(0) << "<ip proto: " << (unsigned int)info.ip_proto
+				<< " dscp: " << (unsigned int)info.ip_dscp << " ecn: " << (unsigned int)info.ip_ecn
+				<< " ttl: " << (unsigned int)info.ip_ttl << " >" << std::endl;
+	}
+	if (info.l4_offset != cpacketinfo::OFFSET_NONE) {
+		os << rofl::indent(0) << "<l4 src: " << info.tp_src << " dst: " << info.tp_dst
+				<< " icmp-type: " << (unsigned int)info.icmp_msgtype
+				<< " icmp-code: " << (unsigned int)info.icmp_msgcode
+				<< " tunnel-id: " << info.tunnel_id << " >" << std::endl;
+	}
+	return os;
+}
+
+}; // end of namespace rofl
@@ -0,0 +1,161 @@
+/*
+ * cpacketclassifier.h
+ */
+
+#ifndef CPACKETCLASSIFIER_H_
+#define CPACKETCLASSIFIER_H_ 1
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <ostream>
+
+#include "rofl/common/cpacket.h"
+#include "rofl/common/openflow/cofmatch.h"
+
+namespace rofl {
+
+/**
+ * @ingroup common_devel_protocols
+ * @brief	Layer offsets and key header fields of a packet determined by rofl::cpacketclassifier
+ *
+ * Multi-byte fields are in host byte order, addresses are kept as they
+ * appear in the packet. Fields of absent layers are zero, offsets of absent
+ * layers are OFFSET_NONE.
+ */
+struct cpacketinfo {
+
+	enum cpacketinfo_flags_t {
+		HAS_VLAN		= (1 << 0),		// at least one VLAN tag
+		HAS_QINQ		= (1 << 1),		// two or more VLAN tags
+		HAS_MPLS		= (1 << 2),
+		HAS_ARP			= (1 << 3),
+		HAS_IPV4		= (1 << 4),
+		HAS_IPV6		= (1 << 5),
+		HAS_FRAGMENT	= (1 << 6),		// IPv4 or IPv6 fragment, L4 is parsed for the first fragment only
+		HAS_TCP			= (1 << 7),
+		HAS_UDP			= (1 << 8),
+		HAS_SCTP		= (1 << 9),
+		HAS_ICMPV4		= (1 << 10),
+		HAS_ICMPV6		= (1 << 11),
+		HAS_GTPU		= (1 << 12),
+		HAS_L2TPV3		= (1 << 13),
+		IS_TRUNCATED	= (1 << 15),	// classification stopped at a header exceeding the buffer
+	};
+
+	static uint16_t const OFFSET_NONE = 0xffff;
+	static unsigned int const MAX_VLANS = 2;
+
+	uint32_t	flags;
+
+	uint16_t	l3_offset;			// IPv4, IPv6 or ARP header
+	uint16_t	l4_offset;			// TCP, UDP, SCTP, ICMP or L2TPv3 header
+	uint16_t	tunnel_offset;		// GTP-U header or L2TPv3 header in UDP
+	uint16_t	payload_offset;		// data after transport or tunnel header
+
+	uint8_t		eth_dst[6];
+	uint8_t		eth_src[6];
+	uint16_t	eth_type;			// after VLAN tags, MPLS_ETHER for MPLS
+
+	uint8_t		num_vlans;			// all tags, fields of the outer MAX_VLANS are kept
+	uint16_t	vlan_vid[MAX_VLANS];	// outer tag first
+	uint8_t		vlan_pcp[MAX_VLANS];
+
+	uint8_t		num_mpls;
+	uint32_t	mpls_label;			// outermost label
+	uint8_t		mpls_tc;
+	uint8_t		mpls_bos;
+
+	uint8_t		ip_proto;			// upper layer protocol, after IPv6 extension headers
+	uint8_t		ip_dscp;
+	uint8_t		ip_ecn;
+	uint8_t		ip_ttl;				// TTL or hop limit
+	uint8_t		ipv4_src[4];
+	uint8_t		ipv4_dst[4];
+	uint8_t		ipv6_src[16];
+	uint8_t		ipv6_dst[16];
+	uint32_t	ipv6_flabel;
+	uint16_t	ipv6_exthdr;		// OFPIEH_* flags
+
+	uint16_t	arp_op;
+	uint8_t		arp_sha[6];
+	uint8_t		arp_spa[4];
+	uint8_t		arp_tha[6];
+	uint8_t		arp_tpa[4];
+
+	uint16_t	tp_src;				// TCP, UDP or SCTP ports
+	uint16_t	tp_dst;
+	uint8_t		icmp_msgtype;		// ICMPv4 or ICMPv6, icmp_type is taken by a macro in openflow1x.h
+	uint8_t		icmp_msgcode;
+
+	uint32_t	tunnel_id;			// GTP-U TEID or L2TPv3 session ID
+
+	/**
+	 *
+	 */
+	bool
+	has(
+			uint32_t flag) const
+	{ return (flags & flag); };
+
+	friend std::ostream&
+	operator<< (std::ostream& os, const cpacketinfo& info);
+};
+
+
+
+/**
+ * @ingroup common_devel_protocols
+ * @brief	Single-pass header classifier for packet-in payloads
+ *
+ * Walks Ethernet, VLAN/QinQ tags, MPLS labels, ARP, IPv4 or IPv6 including
+ * extension headers and TCP, UDP, SCTP, ICMPv4 or ICMPv6, GTP-U (UDP port
+ * 2152) and L2TPv3 (IP protocol 115 or UDP port 1701) once and fills a
+ * rofl::cpacketinfo. Unlike stacking fetherframe, fvlanframe, fipv4frame
+ * etc. over a packet, classification neither allocates memory nor throws
+ * exceptions: it stops at the first header that is unknown or exceeds the
+ * buffer.
+ */
+class cpacketclassifier {
+public:
+
+	/**
+	 * @brief	Classifies the Ethernet frame in buf.
+	 *
+	 * @return false when buf does not contain a complete Ethernet header
+	 */
+	static bool
+	classify(
+			const uint8_t* buf,
+			size_t buflen,
+			cpacketinfo& info);
+
+	/**
+	 * @brief	Classifies the Ethernet frame in pkt.
+	 */
+	static bool
+	classify(
+			const rofl::cpacket& pkt,
+			cpacketinfo& info)
+	{ return classify(pkt.soframe(), pkt.length(), info); };
+
+	/**
+	 * @brief	Adds OXM fields for all classified headers to match, e.g., for a reactive Flow-Mod.
+	 *
+	 * Fields are added along with their prerequisites as defined by
+	 * OpenFlow 1.3: Ethernet, VLAN (OFPVID_NONE for an untagged frame),
+	 * outermost MPLS label, ARP, IPv4 or IPv6 and TCP, UDP, SCTP, ICMPv4
+	 * or ICMPv6. Upper layers are omitted for MPLS frames and non-first
+	 * fragments.
+	 *
+	 * @param in_port ingress port, omitted when 0
+	 */
+	static void
+	get_flowkey(
+			const cpacketinfo& info,
+			rofl::openflow::cofmatch& match,
+			uint32_t in_port = 0);
+};
+
+}; // end of namespace rofl
+
+#endif /* CPACKETCLASSIFIER_H_ */
@@ -3,6 +3,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "ficmpv4frame.h"
+#include "../cchecksum.h"
 
 using namespace rofl;
 
@@ -133,35 +134,8 @@ ficmpv4frame::icmpv4_calc_checksum(uint16_t length)
 
 	icmp_hdr->checksum = htobe16(0x0000);
 
-	// ICMPv4 header
-	//
-
-	// sum
-	uint32_t sum = 0;
-
-	// pointer on 16bit words
-	uint16_t *word16 = (uint16_t*)icmp_hdr;
-
-	// number of 16bit words
-	//int wnum = (sizeof(struct icmpv4_hdr_t) / sizeof(uint16_t));
-    int wnum = (length / sizeof(uint16_t));
-	// header loop
-	for (int i = 0; i < wnum; i++)
-	{
-		uint32_t tmp = (uint32_t)(be16toh(word16[i]));
-		sum += tmp;
-		//fprintf(stderr, "word16[%d]=0x%08x sum()=0x%08x\n", i, tmp, sum);
-	}
-
-	// TODO: checksum must also cover data portion of ICMP message!
-
-	uint16_t res16 = (sum & 0x0000ffff) + ((sum & 0xffff0000) >> 16);
-
-	//fprintf(stderr, " res16(1)=0x%x\n", res16);
-
-	icmp_hdr->checksum = htobe16(~res16);
-
-	//fprintf(stderr, "~res16(1)=0x%x\n", be16toh(udp_hdr->checksum));
+	// ICMPv4 header and data
+	icmp_hdr->checksum = cchecksum::checksum(icmp_hdr, length);
 }
 
 
@@ -3,6 +3,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "ficmpv6frame.h"
+#include "../cchecksum.h"
 
 using namespace rofl;
 
@@ -383,6 +384,25 @@ ficmpv6frame::icmpv6_calc_checksum()
 }
 
 
+void
+ficmpv6frame::icmpv6_calc_checksum(
+		const caddress_in6& ip_src,
+		const caddress_in6& ip_dst,
+		uint32_t length)
+{
+	initialize();
+
+	icmpv6_hdr->checksum = htobe16(0x0000);
+
+	// IPv6 pseudo header followed by ICMPv6 message
+	uint32_t sum = cchecksum::sum_pseudo_in6(
+			ip_src.somem(), ip_dst.somem(), 58 /* ICMPv6 */, length);
+
+	icmpv6_hdr->checksum = cchecksum::checksum(icmpv6_hdr, length, sum);
+}
+
+
+
 uint8_t
 ficmpv6frame::get_icmpv6_code() const
 {
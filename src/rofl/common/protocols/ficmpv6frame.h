@@ -429,6 +429,16 @@ public:
 	icmpv6_calc_checksum();
 
 
+	/** calculate ICMPv6 checksum including IPv6 pseudo header over length bytes
+	 *
+	 */
+	void
+	icmpv6_calc_checksum(
+			const caddress_in6& ip_src,
+			const caddress_in6& ip_dst,
+			uint32_t length);
+
+
 	/** get specific ICMPv6 option
 	 *
 	 */
@@ -3,6 +3,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "fipv4frame.h"
+#include "../cchecksum.h"
 
 using namespace rofl;
 
@@ -176,33 +177,14 @@ fipv4frame::ipv4_calc_checksum()
 {
 	initialize();
 
-	size_t datalen = sizeof(struct ipv4_hdr_t);
+	size_t hdrlen = get_ipv4_ihl() * sizeof(uint32_t);
+	if ((hdrlen < sizeof(struct ipv4_hdr_t)) || (hdrlen > framelen()))
+		hdrlen = sizeof(struct ipv4_hdr_t);
 
 	// force header checksum to 0x0000
 	ipv4_hdr->checksum = htobe16(0x0000);
 
-	// pointer on 16bit words
-	uint16_t *word16 = (uint16_t*)ipv4_hdr;
-	// number of 16bit words
-	int wnum = (datalen / (sizeof(uint16_t)));
-	// sum
-	uint32_t sum = 0;
-
-	for (int i = 0; i < wnum; i++)
-	{
-		uint32_t tmp = (uint32_t)(be16toh(word16[i]));
-		sum += tmp;
-		//fprintf(stderr, "word16[%d]=0x%08x sum()=0x%08x\n", i, tmp, sum);
-	}
-	//fprintf(stderr, "   sum(1)=0x%x\n", sum);
-
-	uint16_t res16 = (sum & 0x0000ffff) + ((sum & 0xffff0000) >> 16);
-
-	//fprintf(stderr, " res16(1)=0x%x\n", res16);
-
-	ipv4_hdr->checksum = htobe16(~res16);
-
-	//fprintf(stderr, "~res16(1)=0x%x\n", be16toh(ipv4_hdr->checksum));
+	ipv4_hdr->checksum = cchecksum::checksum(ipv4_hdr, hdrlen);
 }
 
 
@@ -297,7 +279,12 @@ fipv4frame::get_ipv4_ttl()
 void
 fipv4frame::dec_ipv4_ttl()
 {
+	// TTL shares a 16-bit word with the protocol field
+	uint16_t oldval, newval;
+	memcpy(&oldval, &(ipv4_hdr->ttl), sizeof(oldval));
 	ipv4_hdr->ttl--;
+	memcpy(&newval, &(ipv4_hdr->ttl), sizeof(newval));
+	ipv4_hdr->checksum = cchecksum::update16(ipv4_hdr->checksum, oldval, newval);
 }
 
 
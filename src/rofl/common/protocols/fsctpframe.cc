@@ -10,6 +10,7 @@
  */
 
 #include <rofl/common/protocols/fsctpframe.h>
+#include <rofl/common/cchecksum.h>
 
 using namespace rofl;
 
@@ -137,59 +138,10 @@ fsctpframe::sctp_calc_checksum(
 {
 	initialize();
 
-	sctp_hdr->checksum = htobe16(0x0000);
+	// CRC32C over SCTP common header and chunks, no pseudo header (RFC 4960, appendix B)
+	sctp_hdr->checksum = htobe32(0x00000000);
 
-	// part -I- (IPv4 pseudo header)
-	//
-
-	// create IPv4 pseudo header for UDP checksum calculation
-	struct ip_pseudo_hdr_t hdr;
-	bzero(&hdr, sizeof(hdr));
-
-	hdr.src 		= ip_src.get_addr_nbo();
-	hdr.dst 		= ip_dst.get_addr_nbo();
-	hdr.reserved 	= 0;
-	hdr.proto 		= ip_proto;
-	hdr.len 		= htobe16(datalen);
-
-	// sum
-	uint32_t sum = 0;
-
-	// pointer on 16bit words
-	uint16_t *word16 = (uint16_t*)&hdr;
-	// number of 16bit words
-	int wnum = 6;
-
-	for (int i = 0; i < wnum; i++)
-	{
-		uint32_t tmp = (uint32_t)(be16toh(word16[i]));
-		sum += tmp;
-		//fprintf(stderr, "word16[%d]=0x%08x sum()=0x%08x\n", i, tmp, sum);
-	}
-	//fprintf(stderr, "   sum(1)=0x%x\n", sum);
-
-	// part -II- (TCP header + payload)
-	//
-
-	// pointer on 16bit words
-	word16 = (uint16_t*)sctp_hdr;
-	// number of 16bit words
-	wnum = (datalen / sizeof(uint16_t));
-
-	for (int i = 0; i < wnum; i++)
-	{
-		uint32_t tmp = (uint32_t)(be16toh(word16[i]));
-		sum += tmp;
-		//fprintf(stderr, "word16[%d]=0x%08x sum()=0x%08x\n", i, tmp, sum);
-	}
-
-	uint16_t res16 = (sum & 0x0000ffff) + ((sum & 0xffff0000) >> 16);
-
-	//fprintf(stderr, " res16(1)=0x%x\n", res16);
-
-	sctp_hdr->checksum = htobe16(~res16);
-
-	//fprintf(stderr, "~res16(1)=0x%x\n", be16toh(sctp_hdr->checksum));
+	sctp_hdr->checksum = htole32(cchecksum::crc32c(sctp_hdr, length));
 }
 
 
@@ -78,7 +78,7 @@ public:
 	~fsctpframe();
 
 
-	/** calculate TCP header checksum
+	/** calculate SCTP CRC32C checksum over length bytes, addresses and protocol are not covered
 	 *
 	 */
 	void
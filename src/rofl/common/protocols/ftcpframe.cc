@@ -3,6 +3,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "ftcpframe.h"
+#include "../cchecksum.h"
 
 using namespace rofl;
 
@@ -131,53 +132,14 @@ ftcpframe::tcp_calc_checksum(
 		uint8_t ip_proto,
 		uint16_t length)
 {
-	int wnum;
-	uint32_t sum = 0; //sum
-	uint16_t* word16;
-	
 	//Set 0 to checksum
 	tcp_hdr->checksum = 0x0;
 
-	/*
-	* part -I- (IPv4 pseudo header)
-	*/
-	
-	word16 = (uint16_t*)(void*)ip_src.somem();
-	sum += *(word16+1);
-	sum += *(word16);
-
-	word16 = (uint16_t*)(void*)ip_dst.somem();
-	sum += *(word16+1);
-	sum += *(word16);
-	sum += htons(ip_proto);
-	
-	sum += htons(length); 
-
-	/*
-	* part -II- (TCP header + payload)
-	*/
-	
-	// pointer on 16bit words
-	// number of 16bit words
-	word16 = (uint16_t*)tcp_hdr;
-	wnum = (length / sizeof(uint16_t));
-
-	for (int i = 0; i < wnum; i++){
-		sum += (uint32_t)word16[i];
-	}
-	
-	if(length & 0x1)
-		//Last byte
-		sum += (uint32_t)( ((uint8_t*)(void*)tcp_hdr)[length-1]);
-
-	//Fold it
-	do{
-		sum = (sum & 0xFFFF)+(sum >> 16);
-	}while (sum >> 16); 
-
-	tcp_hdr->checksum =(uint16_t) ~sum;
+	// IPv4 pseudo header followed by TCP header and payload
+	uint32_t sum = cchecksum::sum_pseudo_in4(
+			ip_src.get_addr_nbo(), ip_dst.get_addr_nbo(), ip_proto, length);
 
-//	fprintf(stderr," %x \n", tcp_hdr->checksum);
+	tcp_hdr->checksum = cchecksum::checksum(tcp_hdr, length, sum);
 }
 
 
@@ -3,6 +3,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "fudpframe.h"
+#include "../cchecksum.h"
 
 using namespace rofl;
 
@@ -133,52 +134,18 @@ fudpframe::udp_calc_checksum(
 		uint8_t ip_proto,
 		uint16_t length)
 {
-	int wnum;
-	uint32_t sum = 0; //sum
-	uint16_t* word16;
-	
 	//Set 0 to checksum
 	udp_hdr->checksum = 0x0;
 
-	/*
-	* part -I- (IPv4 pseudo header)
-	*/
-	
-	word16 = (uint16_t*)(void*)ip_src.somem();
-	sum += *(word16+1);
-	sum += *(word16);
-
-	word16 = (uint16_t*)(void*)ip_dst.somem();
-	sum += *(word16+1);
-	sum += *(word16);
-	sum += htons(ip_proto);
-	sum += htons(length); 
-
-	/*
-	* part -II- (TCP header + payload)
-	*/
-	
-	// pointer on 16bit words
-	// number of 16bit words
-	word16 = (uint16_t*)udp_hdr;
-	wnum = (length / sizeof(uint16_t));
-
-	for (int i = 0; i < wnum; i++){
-		sum += (uint32_t)word16[i];
-	}
-	
-	if(length & 0x1)
-		//Last byte
-		sum += (uint32_t)( ((uint8_t*)(void*)udp_hdr)[length-1]);
-
-	//Fold it
-	do{
-		sum = (sum & 0xFFFF)+(sum >> 16);
-	}while (sum >> 16); 
+	// IPv4 pseudo header followed by UDP header and payload
+	uint32_t sum = cchecksum::sum_pseudo_in4(
+			ip_src.get_addr_nbo(), ip_dst.get_addr_nbo(), ip_proto, length);
 
-	udp_hdr->checksum =(uint16_t) ~sum;
+	udp_hdr->checksum = cchecksum::checksum(udp_hdr, length, sum);
 
-//	fprintf(stderr," %x \n", udp_hdr->checksum);
+	// a calculated checksum of zero is transmitted as all ones
+	if (0 == udp_hdr->checksum)
+		udp_hdr->checksum = 0xffff;
 }
 
 
@@ -0,0 +1,244 @@
+/*
+ * cchecksum_test.cc
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <endian.h>
+
+#include <vector>
+
+#include "rofl/common/caddress.h"
+#include "rofl/common/protocols/fipv4frame.h"
+#include "rofl/common/protocols/ftcpframe.h"
+#include "rofl/common/protocols/fudpframe.h"
+
+#include "cchecksum_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( cchecksum_test );
+
+namespace {
+
+rofl::cchecksum::cchecksum_impl_t const IMPLS[] = {
+	rofl::cchecksum::IMPL_SCALAR,
+	rofl::cchecksum::IMPL_SSE2,
+	rofl::cchecksum::IMPL_AVX2,
+};
+
+/*
+ * RFC 1071 reference: 16-bit words in network byte order, result in
+ * network byte order
+ */
+uint16_t
+reference(const uint8_t* buf, size_t buflen, uint32_t sum = 0)
+{
+	for (size_t i = 0; i < buflen; i += 2) {
+		sum += (uint32_t)buf[i] << 8;
+		if (i + 1 < buflen)
+			sum += buf[i + 1];
+	}
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return htobe16((uint16_t)~sum);
+}
+
+/*
+ * TCP and UDP segments from test/unit/frames/checksums.cc, 172.16.0.1 -> 172.16.0.99
+ */
+uint8_t const tcp_packet1[] = {
+		0x00, 0x14, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x50, 0x02, 0x20, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x37, 0x33, 0x32, 0x62, 0x72, 0x33, 0x32, 0x69, 0x66, 0x66, 0x32, 0x6F,
+		0x69, 0x32, 0x33, 0x6E, 0x6A, 0x66, 0x32, 0x6F, 0x69, 0x66, 0x32, 0x69, 0x6E, 0x6A, 0x66, 0x32,
+		0x6F, 0x66, 0x32, 0x69, 0x66, 0x32, 0x31
+};
+
+uint8_t const udp_packet1[] = {
+		0x00, 0x35, 0x00, 0x35, 0x00, 0x1F, 0x00, 0x00, 0x73, 0x66, 0x64, 0x68, 0x32, 0x33, 0x6A, 0x72,
+		0x34, 0x6A, 0x69, 0x77, 0x66, 0x65, 0x6A, 0x6F, 0x66, 0x34, 0x6A, 0x77, 0x66, 0x65, 0x74
+};
+
+uint8_t const tcp_header3[] = {
+		0x00, 0x14, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x50, 0x02, 0x20, 0x00,
+		0x00, 0x00, 0x00, 0x00
+};
+
+uint8_t const udp_header3[] = {
+		0x00, 0x35, 0x00, 0x35, 0x0A, 0xF8, 0x00, 0x00
+};
+
+void
+check_tcp(const uint8_t* segment, size_t hdrlen, size_t length, uint16_t expected)
+{
+	std::vector<uint8_t> buf(length, 0xff);
+	memcpy(&buf[0], segment, hdrlen);
+	rofl::ftcpframe tcp(&buf[0], buf.size());
+	tcp.tcp_calc_checksum(rofl::caddress_in4("172.16.0.1"), rofl::caddress_in4("172.16.0.99"), 0x06, length);
+	CPPUNIT_ASSERT(be16toh(tcp.tcp_hdr->checksum) == expected);
+}
+
+void
+check_udp(const uint8_t* datagram, size_t hdrlen, size_t length, uint16_t expected)
+{
+	std::vector<uint8_t> buf(length, 0xff);
+	memcpy(&buf[0], datagram, hdrlen);
+	rofl::fudpframe udp(&buf[0], buf.size());
+	udp.udp_calc_checksum(rofl::caddress_in4("172.16.0.1"), rofl::caddress_in4("172.16.0.99"), 0x11, length);
+	CPPUNIT_ASSERT(be16toh(udp.udp_hdr->checksum) == expected);
+}
+
+}; // end of anonymous namespace
+
+
+
+void
+cchecksum_test::setUp()
+{
+	impl = rofl::cchecksum::get_impl();
+}
+
+
+
+void
+cchecksum_test::tearDown()
+{
+	rofl::cchecksum::set_impl(impl);
+}
+
+
+
+void
+cchecksum_test::testImpls()
+{
+	std::vector<uint8_t> buf(9216 + 4);
+	for (size_t i = 0; i < buf.size(); i++) {
+		buf[i] = (i & 0x0f) ? rand() : 0xff;
+	}
+
+	size_t const lens[] = { 0, 1, 2, 3, 4, 7, 15, 16, 17, 31, 33, 63, 64, 65, 127, 1500, 1501, 9216 };
+
+	for (unsigned int n = 0; n < sizeof(IMPLS) / sizeof(IMPLS[0]); n++) {
+		if (not rofl::cchecksum::has_impl(IMPLS[n]))
+			continue;
+		rofl::cchecksum::set_impl(IMPLS[n]);
+		CPPUNIT_ASSERT(rofl::cchecksum::get_impl() == IMPLS[n]);
+
+		for (size_t offset = 0; offset < 4; offset++) {
+			for (unsigned int l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+				CPPUNIT_ASSERT(rofl::cchecksum::checksum(&buf[offset], lens[l]) == reference(&buf[offset], lens[l]));
+			}
+		}
+
+		// chaining partial sums of even length
+		uint32_t sum = rofl::cchecksum::sum(&buf[0], 64);
+		CPPUNIT_ASSERT(rofl::cchecksum::checksum(&buf[64], 1437, sum) == reference(&buf[0], 1501));
+	}
+
+	if (not rofl::cchecksum::has_impl(rofl::cchecksum::IMPL_AVX2)) {
+		try {
+			rofl::cchecksum::set_impl(rofl::cchecksum::IMPL_AVX2);
+			CPPUNIT_ASSERT(false);
+		} catch (rofl::eChecksumUnsupported& e) {}
+	}
+}
+
+
+
+void
+cchecksum_test::testFrames()
+{
+	for (unsigned int n = 0; n < sizeof(IMPLS) / sizeof(IMPLS[0]); n++) {
+		if (not rofl::cchecksum::has_impl(IMPLS[n]))
+			continue;
+		rofl::cchecksum::set_impl(IMPLS[n]);
+
+		check_tcp(tcp_packet1, sizeof(tcp_packet1) - 1, sizeof(tcp_packet1) - 1, 0xDDEB);
+		check_tcp(tcp_packet1, sizeof(tcp_packet1), sizeof(tcp_packet1), 0xACEA);
+		check_tcp(tcp_header3, sizeof(tcp_header3), 2820, 0x2C0A);
+
+		check_udp(udp_packet1, sizeof(udp_packet1), sizeof(udp_packet1), 0x1885);
+		check_udp(udp_header3, sizeof(udp_header3), 2808, 0x910F);
+	}
+
+	// IPv4 header, checksum valid when summing over the header including the checksum yields zero
+	uint8_t ipv4[20] = {
+			0x45, 0x00, 0x00, 0x73, 0x00, 0x00, 0x40, 0x00, 0x40, 0x11, 0xaa, 0xbb, 0xc0, 0xa8, 0x00, 0x01,
+			0xc0, 0xa8, 0x00, 0xc7 };
+	rofl::fipv4frame ip(ipv4, sizeof(ipv4));
+	ip.ipv4_calc_checksum();
+	CPPUNIT_ASSERT(ipv4[10] == 0xb8 && ipv4[11] == 0x61);
+	CPPUNIT_ASSERT(rofl::cchecksum::checksum(ipv4, sizeof(ipv4)) == 0);
+}
+
+
+
+void
+cchecksum_test::testIncremental()
+{
+	uint8_t buf[64];
+	for (size_t i = 0; i < sizeof(buf); i++) {
+		buf[i] = rand();
+	}
+
+	for (unsigned int i = 0; i < 1000; i++) {
+		uint16_t check = rofl::cchecksum::checksum(buf, sizeof(buf));
+
+		// 16-bit field
+		size_t offset = (rand() % (sizeof(buf) / 2)) * 2;
+		uint16_t oldval, newval = rand();
+		memcpy(&oldval, buf + offset, sizeof(oldval));
+		memcpy(buf + offset, &newval, sizeof(newval));
+		check = rofl::cchecksum::update16(check, oldval, newval);
+		CPPUNIT_ASSERT(check == rofl::cchecksum::checksum(buf, sizeof(buf)));
+
+		// 32-bit field
+		offset = (rand() % (sizeof(buf) / 4)) * 4;
+		uint32_t oldval32, newval32 = (i & 1) ? rand() : 0;
+		memcpy(&oldval32, buf + offset, sizeof(oldval32));
+		memcpy(buf + offset, &newval32, sizeof(newval32));
+		check = rofl::cchecksum::update32(check, oldval32, newval32);
+		CPPUNIT_ASSERT(check == rofl::cchecksum::checksum(buf, sizeof(buf)));
+
+		// MAC address
+		offset = (rand() % ((sizeof(buf) - 6) / 2)) * 2;
+		uint8_t oldmac[6], newmac[6];
+		for (unsigned int j = 0; j < 6; j++)
+			newmac[j] = rand();
+		memcpy(oldmac, buf + offset, sizeof(oldmac));
+		memcpy(buf + offset, newmac, sizeof(newmac));
+		check = rofl::cchecksum::update(check, oldmac, newmac, sizeof(newmac));
+		CPPUNIT_ASSERT(check == rofl::cchecksum::checksum(buf, sizeof(buf)));
+	}
+
+	// TTL decrement keeps the IPv4 header checksum valid
+	uint8_t ipv4[20] = {
+			0x45, 0x00, 0x00, 0x73, 0x00, 0x00, 0x40, 0x00, 0x40, 0x11, 0x00, 0x00, 0xc0, 0xa8, 0x00, 0x01,
+			0xc0, 0xa8, 0x00, 0xc7 };
+	rofl::fipv4frame ip(ipv4, sizeof(ipv4));
+	ip.ipv4_calc_checksum();
+	for (unsigned int i = 0; i < 64; i++) {
+		ip.dec_ipv4_ttl();
+		CPPUNIT_ASSERT(rofl::cchecksum::checksum(ipv4, sizeof(ipv4)) == 0);
+	}
+}
+
+
+
+void
+cchecksum_test::testCrc32c()
+{
+	CPPUNIT_ASSERT(rofl::cchecksum::crc32c("123456789", 9) == 0xe3069283);
+
+	// RFC 3720, appendix B.4
+	uint8_t buf[32];
+	memset(buf, 0x00, sizeof(buf));
+	CPPUNIT_ASSERT(rofl::cchecksum::crc32c(buf, sizeof(buf)) == 0x8a9136aa);
+	memset(buf, 0xff, sizeof(buf));
+	CPPUNIT_ASSERT(rofl::cchecksum::crc32c(buf, sizeof(buf)) == 0x62a8ab43);
+	for (unsigned int i = 0; i < sizeof(buf); i++)
+		buf[i] = i;
+	CPPUNIT_ASSERT(rofl::cchecksum::crc32c(buf, sizeof(buf)) == 0x46dd794e);
+
+	// continuing a previous calculation
+	uint32_t crc = rofl::cchecksum::crc32c(buf, 13);
+	CPPUNIT_ASSERT(rofl::cchecksum::crc32c(buf + 13, sizeof(buf) - 13, crc) == 0x46dd794e);
+}
@@ -0,0 +1,35 @@
+/*
+ * cchecksum_test.h
+ */
+
+#ifndef CCHECKSUM_TEST_H_
+#define CCHECKSUM_TEST_H_
+
+#include "rofl/common/cchecksum.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class cchecksum_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( cchecksum_test );
+	CPPUNIT_TEST( testImpls );
+	CPPUNIT_TEST( testFrames );
+	CPPUNIT_TEST( testIncremental );
+	CPPUNIT_TEST( testCrc32c );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testImpls();
+	void testFrames();
+	void testIncremental();
+	void testCrc32c();
+
+private:
+
+	rofl::cchecksum::cchecksum_impl_t	impl;
+};
+
+#endif /* CCHECKSUM_TEST_H_ */
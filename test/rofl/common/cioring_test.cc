@@ -0,0 +1,262 @@
+/*
+ * cioring_test.cc
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include <vector>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "cioring_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( cioring_test );
+
+namespace {
+
+static size_t const PAYLOAD_SIZE = 4 * 1024 * 1024;
+
+/*
+ * Sends back all data received on a socket and terminates its loop
+ * when the peer has closed the connection.
+ */
+class echo_env : public rofl::csocket_env {
+public:
+	echo_env() :
+		bytes(0)
+	{};
+	virtual
+	~echo_env()
+	{};
+	virtual void
+	handle_read(rofl::csocket& socket) {
+		uint8_t buf[8192];
+		// stop reading while the socket is congested, resumed in handle_write()
+		while (not socket.write_would_block()) {
+			ssize_t rc = 0;
+			try {
+				rc = socket.recv(buf, sizeof(buf));
+			} catch (rofl::eSocketRxAgain& e) {
+				return;
+			} catch (rofl::eSysCall& e) {
+				return; // peer closed connection
+			}
+			bytes += rc;
+			try {
+				socket.send(new rofl::cmemory(buf, rc));
+			} catch (rofl::eSocketTxAgain& e) {
+				// queued
+			}
+			if ((size_t)rc < sizeof(buf))
+				return;
+		}
+	};
+	virtual void
+	handle_write(rofl::csocket& socket) {
+		if (not socket.write_would_block())
+			handle_read(socket);
+	};
+	virtual void
+	handle_closed(rofl::csocket& socket) {
+		rofl::cioloop::get_loop().stop();
+	};
+	virtual void handle_listen(rofl::csocket& socket, int newsd) {};
+	virtual void handle_accepted(rofl::csocket& socket) {};
+	virtual void handle_accept_refused(rofl::csocket& socket) {};
+	virtual void handle_connected(rofl::csocket& socket) {};
+	virtual void handle_connect_refused(rofl::csocket& socket) {};
+	virtual void handle_connect_failed(rofl::csocket& socket) {};
+
+	size_t	bytes;
+};
+
+struct echo_thread {
+	int										sd;
+	bool									ring;
+	enum rofl::cioloop::cioloop_backend_t	backend;
+	size_t									bytes;
+};
+
+void*
+run_echo(void* arg)
+{
+	echo_thread* et = (echo_thread*)arg;
+	echo_env env;
+	{
+		rofl::csocket_plain socket(&env);
+		socket.accept(rofl::csocket_plain::get_default_params(), et->sd);
+		et->ring = socket.is_ring();
+		et->backend = rofl::cioloop::get_loop().get_backend();
+		rofl::cioloop::get_loop().run();
+	}
+	et->bytes = env.bytes;
+	return NULL;
+}
+
+}; // end of anonymous namespace
+
+
+
+void
+cioring_test::setUp()
+{
+	default_backend = rofl::cioloop::get_default_backend();
+}
+
+
+
+void
+cioring_test::tearDown()
+{
+	rofl::cioloop::set_default_backend(default_backend);
+}
+
+
+
+void
+cioring_test::testRecv()
+{
+	if (not rofl::cioring::is_compiled_in()) {
+		try {
+			rofl::cioring ring(8, 8, 256);
+			CPPUNIT_ASSERT(false);
+		} catch (rofl::eIoRingNotSupported& e) {
+			// expected
+		}
+		return;
+	}
+
+	rofl::cioring* ring = NULL;
+	try {
+		ring = new rofl::cioring(8, 8, 256);
+	} catch (rofl::eIoRingNotSupported& e) {
+		// kernel lacks io_uring, nothing to test
+		return;
+	}
+
+	int sv[2];
+	CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+
+	ring->prep_recv(sv[0], true, 0x1234);
+	CPPUNIT_ASSERT(0 == ring->enter(false));
+
+	const char* msg = "hello, world";
+	CPPUNIT_ASSERT((ssize_t)strlen(msg) == write(sv[1], msg, strlen(msg)));
+
+	struct timespec ts;
+	ts.tv_sec = 1;
+	ts.tv_nsec = 0;
+	CPPUNIT_ASSERT(0 == ring->enter(true, &ts));
+
+	rofl::cioring::ccompletion cqe;
+	CPPUNIT_ASSERT(ring->next_completion(cqe));
+	CPPUNIT_ASSERT(0x1234 == cqe.user_data);
+	CPPUNIT_ASSERT((int32_t)strlen(msg) == cqe.res);
+	CPPUNIT_ASSERT(cqe.flags & rofl::cioring::COMPLETION_F_BUFFER);
+	// multishot receive remains armed
+	CPPUNIT_ASSERT(cqe.flags & rofl::cioring::COMPLETION_F_MORE);
+	uint16_t bid = cqe.flags >> 16;
+	CPPUNIT_ASSERT(0 == memcmp(ring->get_buffer(bid), msg, strlen(msg)));
+	ring->recycle_buffer(bid);
+	CPPUNIT_ASSERT(not ring->next_completion(cqe));
+
+	// peer closes connection
+	::close(sv[1]);
+	CPPUNIT_ASSERT(0 == ring->enter(true, &ts));
+	CPPUNIT_ASSERT(ring->next_completion(cqe));
+	CPPUNIT_ASSERT(0x1234 == cqe.user_data);
+	CPPUNIT_ASSERT(0 == cqe.res);
+	CPPUNIT_ASSERT(not (cqe.flags & rofl::cioring::COMPLETION_F_MORE));
+
+	delete ring;
+	::close(sv[0]);
+}
+
+
+
+void
+cioring_test::testEchoEpoll()
+{
+	echo(rofl::cioloop::BACKEND_EPOLL);
+}
+
+
+
+void
+cioring_test::testEchoRing()
+{
+	echo(rofl::cioloop::BACKEND_IO_URING);
+}
+
+
+
+void
+cioring_test::echo(enum rofl::cioloop::cioloop_backend_t backend)
+{
+	int sv[2];
+	CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+
+	// loop of the new thread is created with this backend
+	rofl::cioloop::set_default_backend(backend);
+
+	echo_thread et;
+	et.sd = sv[1];
+	et.ring = false;
+	et.backend = rofl::cioloop::BACKEND_EPOLL;
+	et.bytes = 0;
+
+	pthread_t tid;
+	CPPUNIT_ASSERT(0 == pthread_create(&tid, NULL, &run_echo, &et));
+
+	std::vector<uint8_t> txbuf(PAYLOAD_SIZE);
+	std::vector<uint8_t> rxbuf(PAYLOAD_SIZE);
+	for (size_t i = 0; i < PAYLOAD_SIZE; i++) {
+		txbuf[i] = (uint8_t)(i * 7 + (i >> 12));
+	}
+
+	size_t sent = 0, rcvd = 0;
+	while (rcvd < PAYLOAD_SIZE) {
+		struct pollfd pfd;
+		pfd.fd = sv[0];
+		pfd.events = POLLIN | ((sent < PAYLOAD_SIZE) ? POLLOUT : 0);
+		pfd.revents = 0;
+		CPPUNIT_ASSERT(poll(&pfd, 1, 5000) > 0);
+		if ((pfd.revents & POLLOUT) && (sent < PAYLOAD_SIZE)) {
+			ssize_t rc = ::send(sv[0], &txbuf[sent], std::min((size_t)65536, PAYLOAD_SIZE - sent), MSG_DONTWAIT);
+			CPPUNIT_ASSERT((rc > 0) || (errno == EAGAIN));
+			if (rc > 0)
+				sent += rc;
+		}
+		if (pfd.revents & POLLIN) {
+			ssize_t rc = ::recv(sv[0], &rxbuf[rcvd], PAYLOAD_SIZE - rcvd, MSG_DONTWAIT);
+			CPPUNIT_ASSERT((rc > 0) || (errno == EAGAIN));
+			if (rc > 0)
+				rcvd += rc;
+		}
+	}
+
+	// all data echoed, peer closes its socket and terminates its loop
+	::shutdown(sv[0], SHUT_WR);
+	uint8_t c;
+	CPPUNIT_ASSERT(0 == ::read(sv[0], &c, sizeof(c)));
+	CPPUNIT_ASSERT(0 == pthread_join(tid, NULL));
+	rofl::cioloop::drop_loop(tid);
+	::close(sv[0]);
+
+	CPPUNIT_ASSERT(txbuf == rxbuf);
+	CPPUNIT_ASSERT(PAYLOAD_SIZE == et.bytes);
+	CPPUNIT_ASSERT(et.ring == (rofl::cioloop::BACKEND_IO_URING == et.backend));
+	if (rofl::cioloop::BACKEND_EPOLL == backend) {
+		CPPUNIT_ASSERT(rofl::cioloop::BACKEND_EPOLL == et.backend);
+	}
+	if (not rofl::cioring::is_compiled_in()) {
+		// fallback to epoll
+		CPPUNIT_ASSERT(not et.ring);
+	}
+}
@@ -0,0 +1,37 @@
+/*
+ * cioring_test.h
+ */
+
+#ifndef CIORING_TEST_H_
+#define CIORING_TEST_H_
+
+#include "rofl/common/cioring.h"
+#include "rofl/common/ciosrv.h"
+#include "rofl/common/csocket_plain.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class cioring_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( cioring_test );
+	CPPUNIT_TEST( testRecv );
+	CPPUNIT_TEST( testEchoEpoll );
+	CPPUNIT_TEST( testEchoRing );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testRecv();
+	void testEchoEpoll();
+	void testEchoRing();
+
+private:
+	void
+	echo(enum rofl::cioloop::cioloop_backend_t backend);
+
+	enum rofl::cioloop::cioloop_backend_t default_backend;
+};
+
+#endif /* CIORING_TEST_H_ */
@@ -0,0 +1,202 @@
+/*
+ * cmemory_test.cc
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "rofl/common/caddress.h"
+#include "rofl/common/openflow/coxmatch.h"
+
+#include "cmemory_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( cmemory_test );
+
+namespace {
+
+/*
+ * Number of blocks obtained from rofl::cmempool, a memory area
+ * stored inline does not show up here.
+ */
+uint64_t
+num_pool_allocs()
+{
+	uint64_t num = rofl::cmempool::get_fallbacks();
+	for (unsigned int cls = 0; cls < rofl::cmempool::NUM_CLASSES; cls++) {
+		rofl::cmempool_stats stats = rofl::cmempool::get_stats(cls);
+		num += stats.hits + stats.misses;
+	}
+	return num;
+}
+
+bool
+is_inside(const rofl::cmemory& mem, const uint8_t* ptr)
+{
+	return (ptr >= (const uint8_t*)&mem) && (ptr < (const uint8_t*)&mem + sizeof(mem));
+}
+
+}; // end of anonymous namespace
+
+
+
+void
+cmemory_test::setUp()
+{
+}
+
+
+
+void
+cmemory_test::tearDown()
+{
+}
+
+
+
+void
+cmemory_test::testInline()
+{
+	uint64_t allocs = num_pool_allocs();
+
+	rofl::cmemory mem(CMEMORY_INLINE_SIZE);
+	CPPUNIT_ASSERT(CMEMORY_INLINE_SIZE == mem.memlen());
+	CPPUNIT_ASSERT(is_inside(mem, mem.somem()));
+	CPPUNIT_ASSERT(0 == ((uintptr_t)mem.somem() % sizeof(uint64_t)));
+	for (unsigned int i = 0; i < mem.memlen(); i++) {
+		CPPUNIT_ASSERT(0 == mem[i]);
+	}
+
+	rofl::cmemory large(CMEMORY_INLINE_SIZE + 1);
+	CPPUNIT_ASSERT(not is_inside(large, large.somem()));
+
+	CPPUNIT_ASSERT(allocs + 1 == num_pool_allocs());
+
+	rofl::cmemory empty;
+	CPPUNIT_ASSERT(0 == empty.memlen());
+	CPPUNIT_ASSERT(NULL == empty.somem());
+}
+
+
+
+void
+cmemory_test::testResize()
+{
+	rofl::cmemory mem(4);
+	for (unsigned int i = 0; i < 4; i++) {
+		mem[i] = i + 1;
+	}
+
+	// growing within inline storage clears the new bytes
+	mem.resize(2);
+	mem.resize(CMEMORY_INLINE_SIZE);
+	CPPUNIT_ASSERT(is_inside(mem, mem.somem()));
+	CPPUNIT_ASSERT(1 == mem[0] && 2 == mem[1]);
+	for (unsigned int i = 2; i < mem.memlen(); i++) {
+		CPPUNIT_ASSERT(0 == mem[i]);
+	}
+
+	// moving to the heap preserves content
+	mem.resize(1500);
+	CPPUNIT_ASSERT(not is_inside(mem, mem.somem()));
+	CPPUNIT_ASSERT(1 == mem[0] && 2 == mem[1]);
+	for (unsigned int i = 2; i < mem.memlen(); i++) {
+		CPPUNIT_ASSERT(0 == mem[i]);
+	}
+
+	mem.resize(8);
+	CPPUNIT_ASSERT(8 == mem.memlen());
+	CPPUNIT_ASSERT(1 == mem[0] && 2 == mem[1]);
+
+	mem.resize(0);
+	CPPUNIT_ASSERT(0 == mem.memlen());
+	mem.resize(6);
+	CPPUNIT_ASSERT(is_inside(mem, mem.somem()));
+}
+
+
+
+void
+cmemory_test::testInsertRemove()
+{
+	uint8_t buf[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	rofl::cmemory mem(buf, sizeof(buf));
+
+	mem.insert((unsigned int)4, 4);
+	CPPUNIT_ASSERT(12 == mem.memlen());
+	CPPUNIT_ASSERT(is_inside(mem, mem.somem()));
+	uint8_t exp1[] = { 1, 2, 3, 4, 0, 0, 0, 0, 5, 6, 7, 8 };
+	CPPUNIT_ASSERT(0 == memcmp(mem.somem(), exp1, sizeof(exp1)));
+
+	// inserting beyond the inline storage moves to the heap
+	mem.insert((unsigned int)0, CMEMORY_INLINE_SIZE);
+	CPPUNIT_ASSERT(CMEMORY_INLINE_SIZE + 12 == mem.memlen());
+	CPPUNIT_ASSERT(not is_inside(mem, mem.somem()));
+	CPPUNIT_ASSERT(0 == memcmp(mem.somem() + CMEMORY_INLINE_SIZE, exp1, sizeof(exp1)));
+
+	mem.remove((unsigned int)0, CMEMORY_INLINE_SIZE);
+	CPPUNIT_ASSERT(0 == memcmp(mem.somem(), exp1, sizeof(exp1)));
+
+	mem.remove((unsigned int)4, 4);
+	CPPUNIT_ASSERT(0 == memcmp(mem.somem(), buf, sizeof(buf)));
+}
+
+
+
+void
+cmemory_test::testCopy()
+{
+	uint8_t buf[] = { 0xaa, 0xbb, 0xcc };
+	rofl::cmemory small(buf, sizeof(buf));
+	rofl::cmemory large(1024);
+	large[1023] = 0xdd;
+
+	rofl::cmemory copy(small);
+	CPPUNIT_ASSERT(copy == small);
+	CPPUNIT_ASSERT(is_inside(copy, copy.somem()));
+
+	copy = large;
+	CPPUNIT_ASSERT(copy == large);
+	CPPUNIT_ASSERT(copy.somem() != large.somem());
+
+	copy = small;
+	CPPUNIT_ASSERT(copy == small);
+	CPPUNIT_ASSERT(is_inside(copy, copy.somem()));
+
+	// instances stored in containers keep their own inline storage
+	std::vector<rofl::cmemory> mems;
+	for (unsigned int i = 0; i < 100; i++) {
+		mems.push_back(small);
+	}
+	for (unsigned int i = 0; i < mems.size(); i++) {
+		CPPUNIT_ASSERT(mems[i] == small);
+		CPPUNIT_ASSERT(is_inside(mems[i], mems[i].somem()));
+	}
+}
+
+
+
+void
+cmemory_test::testOxmAddress()
+{
+	rofl::caddress_in6 addr("fe80::1");
+	rofl::caddress_in6 mask("ffff:ffff:ffff:ffff::");
+
+	uint64_t allocs = num_pool_allocs();
+
+	// largest OXM TLV in OpenFlow 1.3: masked IPv6 address
+	rofl::openflow::coxmatch_ofb_ipv6_src oxm(addr, mask);
+	rofl::openflow::coxmatch_ofb_in_port in_port(1);
+	rofl::openflow::coxmatch_ofb_eth_dst eth_dst(rofl::cmacaddr("00:11:22:33:44:55"));
+	rofl::openflow::coxmatch copy(oxm);
+	rofl::caddress_in4 addr4("10.0.0.1");
+	rofl::caddress_in6 addr6(addr);
+
+	CPPUNIT_ASSERT(allocs == num_pool_allocs());
+	CPPUNIT_ASSERT(copy == oxm);
+	CPPUNIT_ASSERT(addr6 == addr);
+}
@@ -0,0 +1,33 @@
+/*
+ * cmemory_test.h
+ */
+
+#ifndef CMEMORY_TEST_H_
+#define CMEMORY_TEST_H_
+
+#include "rofl/common/cmemory.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class cmemory_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( cmemory_test );
+	CPPUNIT_TEST( testInline );
+	CPPUNIT_TEST( testResize );
+	CPPUNIT_TEST( testInsertRemove );
+	CPPUNIT_TEST( testCopy );
+	CPPUNIT_TEST( testOxmAddress );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testInline();
+	void testResize();
+	void testInsertRemove();
+	void testCopy();
+	void testOxmAddress();
+};
+
+#endif /* CMEMORY_TEST_H_ */
@@ -0,0 +1,264 @@
+/*
+ * cmempool_test.cc
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <vector>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "cmempool_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( cmempool_test );
+
+namespace {
+
+static unsigned int const NUM_THREADS = 4;
+static unsigned int const NUM_ROUNDS = 10000;
+
+uint64_t
+total_hits()
+{
+	uint64_t hits = 0;
+	for (unsigned int cls = 0; cls < rofl::cmempool::NUM_CLASSES; cls++) {
+		hits += rofl::cmempool::get_stats(cls).hits;
+	}
+	return hits;
+}
+
+void*
+run_thread(void* arg)
+{
+	// allocate here, release in main thread via the returned areas
+	std::vector<void*>* areas = (std::vector<void*>*)arg;
+	for (unsigned int i = 0; i < NUM_ROUNDS; i++) {
+		size_t len = 1 + (i * 7919) % 2048;
+		uint8_t* area = (uint8_t*)rofl::cmempool::allocate(len);
+		memset(area, 0xa5, len);
+		if (i % 10) {
+			rofl::cmempool::release(area);
+		} else {
+			areas->push_back(area);
+		}
+	}
+	return NULL;
+}
+
+}; // end of anonymous namespace
+
+
+
+void
+cmempool_test::setUp()
+{
+	rofl::cmempool::set_enabled(true);
+	rofl::cmempool::reset_stats();
+}
+
+
+
+void
+cmempool_test::tearDown()
+{
+	rofl::cmempool::set_enabled(true);
+}
+
+
+
+void
+cmempool_test::testSizeClasses()
+{
+	size_t lens[] = { 0, 1, 32, 33, 100, 1500, 4096, 65535, 65536 };
+	for (unsigned int i = 0; i < sizeof(lens) / sizeof(size_t); i++) {
+		void* area = rofl::cmempool::allocate(lens[i]);
+		CPPUNIT_ASSERT(NULL != area);
+		CPPUNIT_ASSERT(rofl::cmempool::capacity(area) >= lens[i]);
+		CPPUNIT_ASSERT(rofl::cmempool::capacity(area) < 2 * lens[i] || lens[i] <= rofl::cmempool::MIN_BLOCK_SIZE);
+		CPPUNIT_ASSERT(0 == ((uintptr_t)area % sizeof(void*)));
+		memset(area, 0xff, lens[i]);
+		rofl::cmempool::release(area);
+	}
+
+	CPPUNIT_ASSERT(32 == rofl::cmempool::get_stats(0).block_size);
+	CPPUNIT_ASSERT(65536 == rofl::cmempool::get_stats(rofl::cmempool::NUM_CLASSES - 1).block_size);
+	CPPUNIT_ASSERT(0 == rofl::cmempool::get_fallbacks());
+
+	try {
+		rofl::cmempool::get_stats(rofl::cmempool::NUM_CLASSES);
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eMemPoolInval& e) {}
+
+	rofl::cmempool::release(NULL);
+}
+
+
+
+void
+cmempool_test::testReuse()
+{
+	unsigned int cls = 5; // 1024 bytes
+
+	void* area1 = rofl::cmempool::allocate(1000);
+	rofl::cmempool::release(area1);
+	rofl::cmempool_stats stats = rofl::cmempool::get_stats(cls);
+
+	// released block is served again from this thread's cache
+	void* area2 = rofl::cmempool::allocate(1024);
+	CPPUNIT_ASSERT(area1 == area2);
+	CPPUNIT_ASSERT(stats.hits + 1 == rofl::cmempool::get_stats(cls).hits);
+	CPPUNIT_ASSERT(stats.misses == rofl::cmempool::get_stats(cls).misses);
+	rofl::cmempool::release(area2);
+
+	// exceeding the cache limit moves blocks to the global free list
+	std::vector<void*> areas;
+	for (unsigned int i = 0; i < 4 * rofl::cmempool::CACHE_LIMIT; i++) {
+		areas.push_back(rofl::cmempool::allocate(1024));
+	}
+	stats = rofl::cmempool::get_stats(cls);
+	CPPUNIT_ASSERT(stats.blocks >= 4 * rofl::cmempool::CACHE_LIMIT);
+	CPPUNIT_ASSERT(stats.high_water >= stats.blocks);
+	for (unsigned int i = 0; i < areas.size(); i++) {
+		rofl::cmempool::release(areas[i]);
+	}
+	CPPUNIT_ASSERT(stats.blocks == rofl::cmempool::get_stats(cls).blocks);
+
+	uint64_t misses = rofl::cmempool::get_stats(cls).misses;
+	for (unsigned int i = 0; i < areas.size(); i++) {
+		areas[i] = rofl::cmempool::allocate(1024);
+	}
+	CPPUNIT_ASSERT(misses == rofl::cmempool::get_stats(cls).misses);
+	for (unsigned int i = 0; i < areas.size(); i++) {
+		rofl::cmempool::release(areas[i]);
+	}
+
+	// trim releases blocks on the global free list, but not from the thread cache
+	size_t blocks = rofl::cmempool::get_stats(cls).blocks;
+	rofl::cmempool::trim();
+	CPPUNIT_ASSERT(rofl::cmempool::get_stats(cls).blocks + 3 * rofl::cmempool::CACHE_LIMIT <= blocks);
+}
+
+
+
+void
+cmempool_test::testReallocate()
+{
+	uint8_t* area = (uint8_t*)rofl::cmempool::reallocate(NULL, 40);
+	for (unsigned int i = 0; i < 40; i++) {
+		area[i] = i;
+	}
+
+	// same size class: area is not moved
+	CPPUNIT_ASSERT(area == rofl::cmempool::reallocate(area, 60));
+
+	area = (uint8_t*)rofl::cmempool::reallocate(area, 3000);
+	CPPUNIT_ASSERT(rofl::cmempool::capacity(area) >= 3000);
+	for (unsigned int i = 0; i < 40; i++) {
+		CPPUNIT_ASSERT(area[i] == i);
+	}
+
+	area = (uint8_t*)rofl::cmempool::reallocate(area, 100000);
+	CPPUNIT_ASSERT(1 == rofl::cmempool::get_fallbacks());
+	CPPUNIT_ASSERT(100000 == rofl::cmempool::capacity(area));
+	for (unsigned int i = 0; i < 40; i++) {
+		CPPUNIT_ASSERT(area[i] == i);
+	}
+
+	area = (uint8_t*)rofl::cmempool::reallocate(area, 20);
+	for (unsigned int i = 0; i < 20; i++) {
+		CPPUNIT_ASSERT(area[i] == i);
+	}
+	rofl::cmempool::release(area);
+}
+
+
+
+void
+cmempool_test::testFallback()
+{
+	void* large = rofl::cmempool::allocate(rofl::cmempool::MAX_BLOCK_SIZE + 1);
+	CPPUNIT_ASSERT(1 == rofl::cmempool::get_fallbacks());
+
+	// pool disabled at runtime
+	rofl::cmempool::set_enabled(false);
+	CPPUNIT_ASSERT(not rofl::cmempool::is_enabled());
+	uint64_t hits = total_hits();
+	void* small = rofl::cmempool::allocate(64);
+	CPPUNIT_ASSERT(2 == rofl::cmempool::get_fallbacks());
+	CPPUNIT_ASSERT(hits == total_hits());
+	CPPUNIT_ASSERT(64 == rofl::cmempool::capacity(small));
+
+	// blocks allocated before or after switching are released correctly
+	void* pooled = NULL;
+	rofl::cmempool::set_enabled(true);
+	pooled = rofl::cmempool::allocate(64);
+	rofl::cmempool::set_enabled(false);
+	rofl::cmempool::release(pooled);
+	rofl::cmempool::set_enabled(true);
+	rofl::cmempool::release(small);
+	rofl::cmempool::release(large);
+}
+
+
+
+void
+cmempool_test::testThreads()
+{
+	std::vector<void*> areas[NUM_THREADS];
+	pthread_t tids[NUM_THREADS];
+
+	for (unsigned int i = 0; i < NUM_THREADS; i++) {
+		CPPUNIT_ASSERT(0 == pthread_create(&tids[i], NULL, &run_thread, &areas[i]));
+	}
+	for (unsigned int i = 0; i < NUM_THREADS; i++) {
+		CPPUNIT_ASSERT(0 == pthread_join(tids[i], NULL));
+	}
+
+	// counters of terminated threads are retained
+	uint64_t num = 0;
+	for (unsigned int cls = 0; cls < rofl::cmempool::NUM_CLASSES; cls++) {
+		rofl::cmempool_stats stats = rofl::cmempool::get_stats(cls);
+		num += stats.hits + stats.misses;
+	}
+	CPPUNIT_ASSERT(NUM_THREADS * NUM_ROUNDS <= num);
+
+	// areas remain valid after their thread terminated
+	for (unsigned int i = 0; i < NUM_THREADS; i++) {
+		CPPUNIT_ASSERT(NUM_ROUNDS / 10 == areas[i].size());
+		for (unsigned int j = 0; j < areas[i].size(); j++) {
+			CPPUNIT_ASSERT(0xa5 == *(uint8_t*)areas[i][j]);
+			rofl::cmempool::release(areas[i][j]);
+		}
+	}
+}
+
+
+
+void
+cmempool_test::testCmemory()
+{
+	rofl::cmemory* mem = new rofl::cmemory(100);
+	CPPUNIT_ASSERT(rofl::cmempool::capacity(mem) >= sizeof(rofl::cmemory));
+	for (unsigned int i = 0; i < mem->memlen(); i++) {
+		CPPUNIT_ASSERT(0 == (*mem)[i]);
+	}
+
+	(*mem)[99] = 0x11;
+	mem->resize(2000);
+	CPPUNIT_ASSERT(0x11 == (*mem)[99]);
+	CPPUNIT_ASSERT(0 == (*mem)[1999]);
+	CPPUNIT_ASSERT(rofl::cmempool::capacity(mem->somem()) >= 2000);
+
+	mem->insert((unsigned int)0, 10);
+	CPPUNIT_ASSERT(2010 == mem->memlen());
+	CPPUNIT_ASSERT(0x11 == (*mem)[109]);
+
+	rofl::cmemory copy(*mem);
+	CPPUNIT_ASSERT(copy == *mem);
+
+	delete mem;
+	CPPUNIT_ASSERT(0 == rofl::cmempool::get_fallbacks());
+}
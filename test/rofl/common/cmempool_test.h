@@ -0,0 +1,36 @@
+/*
+ * cmempool_test.h
+ */
+
+#ifndef CMEMPOOL_TEST_H_
+#define CMEMPOOL_TEST_H_
+
+#include "rofl/common/cmempool.h"
+#include "rofl/common/cmemory.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class cmempool_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( cmempool_test );
+	CPPUNIT_TEST( testSizeClasses );
+	CPPUNIT_TEST( testReuse );
+	CPPUNIT_TEST( testReallocate );
+	CPPUNIT_TEST( testFallback );
+	CPPUNIT_TEST( testThreads );
+	CPPUNIT_TEST( testCmemory );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testSizeClasses();
+	void testReuse();
+	void testReallocate();
+	void testFallback();
+	void testThreads();
+	void testCmemory();
+};
+
+#endif /* CMEMPOOL_TEST_H_ */
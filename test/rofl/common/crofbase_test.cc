@@ -0,0 +1,280 @@
+/*
+ * crofbase_test.cc
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <set>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "crofbase_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( crofbase_test );
+
+namespace {
+
+static unsigned int const NUM_WORKERS = 4;
+static unsigned int const NUM_DPTS = 100;
+static uint16_t const LISTEN_PORT = 6693;
+
+rofl::openflow::cofhello_elem_versionbitmap
+ofp13_versions()
+{
+	rofl::openflow::cofhello_elem_versionbitmap vbitmap;
+	vbitmap.add_ofp_version(rofl::openflow13::OFP_VERSION);
+	return vbitmap;
+}
+
+size_t
+num_dpts(const rofl::crofbase& base)
+{
+	size_t num = 0;
+	for (unsigned int i = 0; i < base.get_num_workers(); i++) {
+		num += base.get_worker(i).get_num_dpts();
+	}
+	return num;
+}
+
+size_t
+num_pending(const rofl::crofbase& base)
+{
+	size_t num = 0;
+	for (unsigned int i = 0; i < base.get_num_workers(); i++) {
+		num += base.get_worker(i).get_num_pending();
+	}
+	return num;
+}
+
+/*
+ * Connects to the listening socket like a datapath element, reads
+ * the HELLO message sent by the controller's worker thread and closes
+ * the connection before completing the handshake.
+ */
+class controller : public rofl::crofbase {
+
+	enum controller_timer_t {
+		TIMER_START_PEER	= 1,
+		TIMER_TEST_TIMEOUT	= 2,
+		TIMER_CHECK_PENDING	= 3,
+	};
+
+public:
+
+	controller() :
+		rofl::crofbase(ofp13_versions()),
+		peer(0),
+		peer_done(false),
+		hello_type(0xff),
+		hello_version(0)
+	{};
+
+	void
+	run() {
+		register_timer(TIMER_START_PEER, rofl::ctimespec(0));
+		register_timer(TIMER_TEST_TIMEOUT, rofl::ctimespec(10));
+		rofl::cioloop::get_loop().run();
+		pthread_join(peer, NULL);
+	};
+
+	uint8_t
+	get_hello_type() const
+	{ return hello_type; };
+
+	uint8_t
+	get_hello_version() const
+	{ return hello_version; };
+
+private:
+
+	static void*
+	run_peer(void* arg) {
+		controller* ctl = (controller*)arg;
+		int sd = socket(AF_INET, SOCK_STREAM, 0);
+		struct timeval tv;
+		tv.tv_sec = 5;
+		tv.tv_usec = 0;
+		setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+		struct sockaddr_in sin;
+		memset(&sin, 0, sizeof(sin));
+		sin.sin_family = AF_INET;
+		sin.sin_port = htons(LISTEN_PORT);
+		sin.sin_addr.s_addr = inet_addr("127.0.0.1");
+		if (connect(sd, (struct sockaddr*)&sin, sizeof(sin)) == 0) {
+			struct rofl::openflow::ofp_header hdr;
+			if (recv(sd, &hdr, sizeof(hdr), MSG_WAITALL) == sizeof(hdr)) {
+				ctl->hello_type = hdr.type;
+				ctl->hello_version = hdr.version;
+			}
+		}
+		close(sd);
+		ctl->peer_done = true;
+		return NULL;
+	};
+
+	virtual void
+	handle_timeout(int opaque, void* data) {
+		switch (opaque) {
+		case TIMER_START_PEER: {
+			pthread_create(&peer, NULL, &controller::run_peer, this);
+			register_timer(TIMER_CHECK_PENDING, rofl::ctimespec(0, 50000000));
+		} break;
+		case TIMER_CHECK_PENDING: {
+			// worker releases the connection closed during its handshake
+			if (peer_done && (0 == num_pending(*this))) {
+				rofl::cioloop::get_loop().stop();
+				return;
+			}
+			register_timer(TIMER_CHECK_PENDING, rofl::ctimespec(0, 50000000));
+		} break;
+		case TIMER_TEST_TIMEOUT: {
+			rofl::cioloop::get_loop().stop();
+		} break;
+		}
+	};
+
+	pthread_t			peer;
+	volatile bool		peer_done;
+	volatile uint8_t	hello_type;
+	volatile uint8_t	hello_version;
+};
+
+}; // end of anonymous namespace
+
+
+
+void
+crofbase_test::setUp()
+{
+#ifdef DEBUG
+	rofl::logging::set_debug_level(7);
+#endif
+}
+
+
+
+void
+crofbase_test::tearDown()
+{
+}
+
+
+
+void
+crofbase_test::testDpidPlacement()
+{
+	rofl::crofbase base(ofp13_versions());
+	base.set_workers(NUM_WORKERS, rofl::crofbase::PLACEMENT_DPID_HASH);
+
+	CPPUNIT_ASSERT(NUM_WORKERS == base.get_num_workers());
+	CPPUNIT_ASSERT(rofl::crofbase::PLACEMENT_DPID_HASH == base.get_placement());
+
+	std::set<pthread_t> tids;
+	for (unsigned int i = 0; i < NUM_WORKERS; i++) {
+		tids.insert(base.get_worker(i).get_thread_id());
+	}
+	CPPUNIT_ASSERT(NUM_WORKERS == tids.size());
+	CPPUNIT_ASSERT(tids.find(pthread_self()) == tids.end());
+
+	std::vector<pthread_t> placed;
+	for (unsigned int i = 0; i < NUM_DPTS; i++) {
+		rofl::crofdpt& dpt = base.add_dpt(rofl::cdptid(i), ofp13_versions(), false, rofl::cdpid(0x1000 + i));
+		CPPUNIT_ASSERT(tids.find(dpt.get_thread_id()) != tids.end());
+		placed.push_back(dpt.get_thread_id());
+	}
+	CPPUNIT_ASSERT(NUM_DPTS == num_dpts(base));
+	for (unsigned int i = 0; i < NUM_WORKERS; i++) {
+		CPPUNIT_ASSERT(base.get_worker(i).get_num_dpts() > 0);
+	}
+
+	// placement depends on dpid only
+	for (unsigned int i = 0; i < NUM_DPTS; i += 7) {
+		base.drop_dpt(rofl::cdptid(i));
+		rofl::crofdpt& dpt = base.add_dpt(rofl::cdptid(i), ofp13_versions(), false, rofl::cdpid(0x1000 + i));
+		CPPUNIT_ASSERT(placed[i] == dpt.get_thread_id());
+	}
+	CPPUNIT_ASSERT(NUM_DPTS == num_dpts(base));
+
+	base.drop_dpts();
+	CPPUNIT_ASSERT(0 == num_dpts(base));
+}
+
+
+
+void
+crofbase_test::testLeastLoadPlacement()
+{
+	rofl::crofbase base(ofp13_versions());
+	base.set_workers(3, rofl::crofbase::PLACEMENT_LEAST_LOAD);
+
+	for (unsigned int i = 0; i < 9; i++) {
+		base.add_dpt(rofl::cdptid(i), ofp13_versions(), false, rofl::cdpid(0x2000 + i));
+	}
+	for (unsigned int i = 0; i < 3; i++) {
+		CPPUNIT_ASSERT(3 == base.get_worker(i).get_num_dpts());
+	}
+
+	// refills the worker that lost its datapaths
+	pthread_t tid = base.set_dpt(rofl::cdptid(0)).get_thread_id();
+	base.drop_dpt(rofl::cdptid(0));
+	CPPUNIT_ASSERT(tid == base.add_dpt(rofl::cdptid(0), ofp13_versions()).get_thread_id());
+}
+
+
+
+void
+crofbase_test::testWorkersBusy()
+{
+	rofl::crofbase base(ofp13_versions());
+	base.set_workers(2);
+	base.add_dpt(rofl::cdptid(0), ofp13_versions());
+
+	try {
+		base.set_workers(4);
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eRofBaseIsBusy& e) {}
+	CPPUNIT_ASSERT(2 == base.get_num_workers());
+
+	try {
+		base.get_worker(2);
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eRofBaseNotFound& e) {}
+
+	base.drop_dpts();
+	base.set_workers(0);
+	CPPUNIT_ASSERT(0 == base.get_num_workers());
+	CPPUNIT_ASSERT(pthread_self() == base.add_dpt(rofl::cdptid(0), ofp13_versions()).get_thread_id());
+}
+
+
+
+void
+crofbase_test::testAcceptHandoff()
+{
+	controller ctl;
+	ctl.set_workers(2);
+
+	rofl::cparams params = rofl::csocket::get_default_params(rofl::csocket::SOCKET_TYPE_PLAIN);
+	params.set_param(rofl::csocket::PARAM_KEY_LOCAL_HOSTNAME).set_string("127.0.0.1");
+	params.set_param(rofl::csocket::PARAM_KEY_LOCAL_PORT).set_string("6693");
+	params.set_param(rofl::csocket::PARAM_KEY_DOMAIN).set_string("inet");
+	params.set_param(rofl::csocket::PARAM_KEY_TYPE).set_string("stream");
+	params.set_param(rofl::csocket::PARAM_KEY_PROTOCOL).set_string("tcp");
+	ctl.add_dpt_listening(0, rofl::csocket::SOCKET_TYPE_PLAIN, params);
+
+	ctl.run();
+
+	// HELLO was sent by a crofconn instance created on a worker thread
+	CPPUNIT_ASSERT(rofl::openflow::OFPT_HELLO == ctl.get_hello_type());
+	CPPUNIT_ASSERT(rofl::openflow13::OFP_VERSION == ctl.get_hello_version());
+	CPPUNIT_ASSERT(1 == ctl.get_worker(0).get_num_accepted() + ctl.get_worker(1).get_num_accepted());
+	CPPUNIT_ASSERT(0 == num_dpts(ctl));
+	CPPUNIT_ASSERT(0 == num_pending(ctl));
+
+	ctl.close_dpt_listening();
+}
@@ -0,0 +1,31 @@
+/*
+ * crofbase_test.h
+ */
+
+#ifndef CROFBASE_TEST_H_
+#define CROFBASE_TEST_H_
+
+#include "rofl/common/crofbase.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class crofbase_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( crofbase_test );
+	CPPUNIT_TEST( testDpidPlacement );
+	CPPUNIT_TEST( testLeastLoadPlacement );
+	CPPUNIT_TEST( testWorkersBusy );
+	CPPUNIT_TEST( testAcceptHandoff );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testDpidPlacement();
+	void testLeastLoadPlacement();
+	void testWorkersBusy();
+	void testAcceptHandoff();
+};
+
+#endif /* CROFBASE_TEST_H_ */
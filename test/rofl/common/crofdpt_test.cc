@@ -0,0 +1,403 @@
+/*
+ * crofdpt_test.cc
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "crofdpt_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( crofdpt_test );
+
+namespace {
+
+static unsigned int const NUM_FRAGMENTS = 3;
+static unsigned int const NUM_FLOWS_PER_FRAGMENT = 4;
+static uint64_t const DPID = 0x0102030405060708ULL;
+static unsigned int const NUM_PACKET_INS = 8;
+
+rofl::openflow::cofhello_elem_versionbitmap
+ofp13_versions()
+{
+	rofl::openflow::cofhello_elem_versionbitmap vbitmap;
+	vbitmap.add_ofp_version(rofl::openflow13::OFP_VERSION);
+	return vbitmap;
+}
+
+rofl::cparams
+socket_params(bool listening)
+{
+	rofl::cparams params = rofl::csocket::get_default_params(rofl::csocket::SOCKET_TYPE_PLAIN);
+	if (listening) {
+		params.set_param(rofl::csocket::PARAM_KEY_LOCAL_HOSTNAME).set_string("127.0.0.1");
+		params.set_param(rofl::csocket::PARAM_KEY_LOCAL_PORT).set_string("6694");
+	} else {
+		params.set_param(rofl::csocket::PARAM_KEY_REMOTE_HOSTNAME).set_string("127.0.0.1");
+		params.set_param(rofl::csocket::PARAM_KEY_REMOTE_PORT).set_string("6694");
+	}
+	params.set_param(rofl::csocket::PARAM_KEY_DOMAIN).set_string("inet");
+	params.set_param(rofl::csocket::PARAM_KEY_TYPE).set_string("stream");
+	params.set_param(rofl::csocket::PARAM_KEY_PROTOCOL).set_string("tcp");
+	return params;
+}
+
+/*
+ * Datapath element answering the controller's handshake, replying
+ * to a Flow-Stats-Request with NUM_FRAGMENTS multipart fragments and
+ * to a Barrier-Request with NUM_PACKET_INS Packet-Ins before the reply.
+ */
+class datapath : public rofl::crofbase {
+public:
+
+	datapath() :
+		rofl::crofbase(ofp13_versions())
+	{};
+
+private:
+
+	virtual void
+	handle_features_request(
+			rofl::crofctl& ctl,
+			const rofl::cauxid& auxid,
+			rofl::openflow::cofmsg_features_request& msg) {
+		ctl.send_features_reply(auxid, msg.get_xid(), DPID, 0, 1, 0);
+	};
+
+	virtual void
+	handle_get_config_request(
+			rofl::crofctl& ctl,
+			const rofl::cauxid& auxid,
+			rofl::openflow::cofmsg_get_config_request& msg) {
+		ctl.send_get_config_reply(auxid, msg.get_xid(), 0, 128);
+	};
+
+	virtual void
+	handle_table_features_stats_request(
+			rofl::crofctl& ctl,
+			const rofl::cauxid& auxid,
+			rofl::openflow::cofmsg_table_features_stats_request& msg) {
+		ctl.send_table_features_stats_reply(auxid, msg.get_xid(),
+				rofl::openflow::coftables(rofl::openflow13::OFP_VERSION));
+	};
+
+	virtual void
+	handle_port_desc_stats_request(
+			rofl::crofctl& ctl,
+			const rofl::cauxid& auxid,
+			rofl::openflow::cofmsg_port_desc_stats_request& msg) {
+		ctl.send_port_desc_stats_reply(auxid, msg.get_xid(),
+				rofl::openflow::cofports(rofl::openflow13::OFP_VERSION));
+	};
+
+	virtual void
+	handle_flow_stats_request(
+			rofl::crofctl& ctl,
+			const rofl::cauxid& auxid,
+			rofl::openflow::cofmsg_flow_stats_request& msg) {
+		for (unsigned int i = 0; i < NUM_FRAGMENTS; i++) {
+			rofl::openflow::cofflowstatsarray flows(rofl::openflow13::OFP_VERSION);
+			for (unsigned int j = 0; j < NUM_FLOWS_PER_FRAGMENT; j++) {
+				flows.add_flow_stats(j).set_table_id(i);
+			}
+			ctl.send_flow_stats_reply(auxid, msg.get_xid(), flows,
+					(i < NUM_FRAGMENTS - 1) ? rofl::openflow13::OFPMPF_REPLY_MORE : 0);
+		}
+	};
+
+	virtual void
+	handle_barrier_request(
+			rofl::crofctl& ctl,
+			const rofl::cauxid& auxid,
+			rofl::openflow::cofmsg_barrier_request& msg) {
+		uint8_t data[64];
+		memset(data, 0, sizeof(data));
+		for (unsigned int i = 0; i < NUM_PACKET_INS; i++) {
+			rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION);
+			match.set_in_port(i + 1);
+			ctl.send_packet_in_message(auxid, rofl::openflow13::OFP_NO_BUFFER, sizeof(data),
+					rofl::openflow13::OFPR_NO_MATCH, 0, 0, 0, match, data, sizeof(data));
+		}
+		ctl.send_barrier_reply(auxid, msg.get_xid());
+	};
+};
+
+/*
+ * Controller requesting the flow table of an attached datapath element
+ * in streaming mode.
+ */
+class controller : public rofl::crofbase {
+
+	enum controller_timer_t {
+		TIMER_TEST_TIMEOUT	= 1,
+	};
+
+public:
+
+	/*
+	 * a fragment as seen by handle_flow_stats_reply()
+	 */
+	struct cfragment {
+		uint16_t		stats_flags;
+		size_t			num_flows;
+		uint8_t			table_id;
+		bool			pending;	// transaction still open
+	};
+
+	controller() :
+		rofl::crofbase(ofp13_versions()),
+		xid(0),
+		timed_out(false)
+	{};
+
+	void
+	run() {
+		register_timer(TIMER_TEST_TIMEOUT, rofl::ctimespec(10));
+		rofl::cioloop::get_loop().run();
+	};
+
+	const std::vector<cfragment>&
+	get_fragments() const
+	{ return fragments; };
+
+	bool
+	get_timed_out() const
+	{ return timed_out; };
+
+private:
+
+	virtual void
+	handle_dpt_open(
+			rofl::crofdpt& dpt) {
+		dpt.set_multipart_streaming(true);
+		xid = dpt.send_flow_stats_request(rofl::cauxid(0), 0,
+				rofl::openflow::cofflow_stats_request(rofl::openflow13::OFP_VERSION,
+						rofl::openflow::cofmatch(rofl::openflow13::OFP_VERSION),
+						rofl::openflow13::OFPTT_ALL,
+						rofl::openflow13::OFPP_ANY,
+						rofl::openflow13::OFPG_ANY,
+						0, 0));
+	};
+
+	virtual void
+	handle_flow_stats_reply(
+			rofl::crofdpt& dpt,
+			const rofl::cauxid& auxid,
+			rofl::openflow::cofmsg_flow_stats_reply& msg) {
+		cfragment fragment;
+		fragment.stats_flags = msg.get_stats_flags();
+		fragment.num_flows = msg.get_flow_stats_array().size();
+		fragment.table_id = fragment.num_flows ?
+				msg.get_flow_stats_array().get_flow_stats(0).get_table_id() : 0xff;
+		fragment.pending = dpt.has_pending_request(xid);
+		fragments.push_back(fragment);
+
+		if (not (msg.get_stats_flags() & rofl::openflow13::OFPMPF_REPLY_MORE)) {
+			rofl::cioloop::get_loop().stop();
+		}
+	};
+
+	virtual void
+	handle_flow_stats_reply_timeout(
+			rofl::crofdpt& dpt,
+			uint32_t xid) {
+		timed_out = true;
+		rofl::cioloop::get_loop().stop();
+	};
+
+	virtual void
+	handle_timeout(
+			int opaque, void* data) {
+		switch (opaque) {
+		case TIMER_TEST_TIMEOUT: {
+			timed_out = true;
+			rofl::cioloop::get_loop().stop();
+		} break;
+		}
+	};
+
+	uint32_t				xid;
+	bool					timed_out;
+	std::vector<cfragment>	fragments;
+};
+
+/*
+ * Controller consuming Packet-Ins as zero-copy views on the I/O thread.
+ */
+class viewer : public rofl::crofbase {
+
+	enum viewer_timer_t {
+		TIMER_TEST_TIMEOUT	= 1,
+		TIMER_CHECK_VIEWS	= 2,
+	};
+
+public:
+
+	viewer() :
+		rofl::crofbase(ofp13_versions()),
+		num_views(0),
+		sum_in_ports(0),
+		num_packet_ins(0),
+		timed_out(false)
+	{};
+
+	void
+	run() {
+		register_timer(TIMER_TEST_TIMEOUT, rofl::ctimespec(10));
+		rofl::cioloop::get_loop().run();
+	};
+
+	unsigned int
+	get_num_views() const
+	{ return __atomic_load_n(&num_views, __ATOMIC_ACQUIRE); };
+
+	unsigned int
+	get_sum_in_ports() const
+	{ return __atomic_load_n(&sum_in_ports, __ATOMIC_ACQUIRE); };
+
+	unsigned int
+	get_num_packet_ins() const
+	{ return num_packet_ins; };
+
+	bool
+	get_timed_out() const
+	{ return timed_out; };
+
+private:
+
+	virtual void
+	handle_dpt_open(
+			rofl::crofdpt& dpt) {
+		dpt.send_barrier_request(rofl::cauxid(0));
+	};
+
+	virtual bool
+	handle_packet_in_view(
+			rofl::crofdpt& dpt,
+			const rofl::cauxid& auxid,
+			rofl::openflow::cofmsg_view const& view) {
+		__atomic_add_fetch(&sum_in_ports, view.get_in_port(), __ATOMIC_RELEASE);
+		__atomic_add_fetch(&num_views, 1, __ATOMIC_RELEASE);
+		return true;
+	};
+
+	virtual void
+	handle_packet_in(
+			rofl::crofdpt& dpt,
+			const rofl::cauxid& auxid,
+			rofl::openflow::cofmsg_packet_in& msg) {
+		num_packet_ins++;
+	};
+
+	virtual void
+	handle_barrier_reply(
+			rofl::crofdpt& dpt,
+			const rofl::cauxid& auxid,
+			rofl::openflow::cofmsg_barrier_reply& msg) {
+		// Packet-Ins are not ordered with the reply, wait for all views
+		register_timer(TIMER_CHECK_VIEWS, rofl::ctimespec(0, 10000000));
+	};
+
+	virtual void
+	handle_timeout(
+			int opaque, void* data) {
+		switch (opaque) {
+		case TIMER_TEST_TIMEOUT: {
+			timed_out = true;
+			rofl::cioloop::get_loop().stop();
+		} break;
+		case TIMER_CHECK_VIEWS: {
+			if (get_num_views() < NUM_PACKET_INS) {
+				register_timer(TIMER_CHECK_VIEWS, rofl::ctimespec(0, 10000000));
+			} else {
+				rofl::cioloop::get_loop().stop();
+			}
+		} break;
+		}
+	};
+
+	unsigned int			num_views;		// updated on the I/O thread
+	unsigned int			sum_in_ports;	// updated on the I/O thread
+	unsigned int			num_packet_ins;
+	bool					timed_out;
+};
+
+}; // end of anonymous namespace
+
+
+
+void
+crofdpt_test::setUp()
+{
+#ifdef DEBUG
+	rofl::logging::set_debug_level(7);
+#endif
+}
+
+
+
+void
+crofdpt_test::tearDown()
+{
+	rofl::cioloop::get_loop().stop();
+	rofl::cioloop::get_loop().shutdown();
+}
+
+
+
+void
+crofdpt_test::testMultipartStreaming()
+{
+	controller ctl;
+	datapath dpt;
+
+	ctl.add_dpt_listening(0, rofl::csocket::SOCKET_TYPE_PLAIN, socket_params(true));
+	dpt.add_ctl(rofl::cctlid(0), ofp13_versions()).connect(
+			rofl::cauxid(0), rofl::csocket::SOCKET_TYPE_PLAIN, socket_params(false));
+
+	ctl.run();
+
+	CPPUNIT_ASSERT(not ctl.get_timed_out());
+
+	// every fragment reaches the handler on its own, in order
+	const std::vector<controller::cfragment>& fragments = ctl.get_fragments();
+	CPPUNIT_ASSERT(NUM_FRAGMENTS == fragments.size());
+	for (unsigned int i = 0; i < NUM_FRAGMENTS; i++) {
+		bool last = (i == NUM_FRAGMENTS - 1);
+		CPPUNIT_ASSERT(NUM_FLOWS_PER_FRAGMENT == fragments[i].num_flows);
+		CPPUNIT_ASSERT(i == fragments[i].table_id);
+		CPPUNIT_ASSERT(last == not (fragments[i].stats_flags & rofl::openflow13::OFPMPF_REPLY_MORE));
+		// the transaction is dropped with the last fragment only
+		CPPUNIT_ASSERT(last == not fragments[i].pending);
+	}
+
+	ctl.close_dpt_listening();
+}
+
+
+
+void
+crofdpt_test::testPacketInView()
+{
+	viewer ctl;
+	datapath dpt;
+
+	ctl.add_dpt_listening(0, rofl::csocket::SOCKET_TYPE_PLAIN, socket_params(true));
+	dpt.add_ctl(rofl::cctlid(0), ofp13_versions()).connect(
+			rofl::cauxid(0), rofl::csocket::SOCKET_TYPE_PLAIN, socket_params(false));
+
+	ctl.run();
+
+	CPPUNIT_ASSERT(not ctl.get_timed_out());
+
+	// Packet-Ins on the established channel are all consumed as views
+	CPPUNIT_ASSERT(NUM_PACKET_INS == ctl.get_num_views());
+	CPPUNIT_ASSERT(NUM_PACKET_INS * (NUM_PACKET_INS + 1) / 2 == ctl.get_sum_in_ports());
+	CPPUNIT_ASSERT(0 == ctl.get_num_packet_ins());
+
+	ctl.close_dpt_listening();
+}
@@ -0,0 +1,27 @@
+/*
+ * crofdpt_test.h
+ */
+
+#ifndef CROFDPT_TEST_H_
+#define CROFDPT_TEST_H_
+
+#include "rofl/common/crofbase.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class crofdpt_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( crofdpt_test );
+	CPPUNIT_TEST( testMultipartStreaming );
+	CPPUNIT_TEST( testPacketInView );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testMultipartStreaming();
+	void testPacketInView();
+};
+
+#endif /* CROFDPT_TEST_H_ */
@@ -0,0 +1,169 @@
+/*
+ * crofqueue_test.cc
+ */
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "crofqueue_test.h"
+#include "rofl/common/openflow/messages/cofmsg_echo.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( crofqueue_test );
+
+namespace {
+
+static unsigned int const NUM_PRODUCERS = 4;
+static unsigned int const NUM_MSGS_PER_PRODUCER = 20000;
+
+struct producer_ctx {
+	rofl::crofqueue*	queue;
+	unsigned int		producer_id;
+};
+
+void*
+producer(void* arg)
+{
+	producer_ctx* ctx = (producer_ctx*)arg;
+	for (unsigned int i = 0; i < NUM_MSGS_PER_PRODUCER; i++) {
+		// encode producer id and sequence number in xid
+		rofl::openflow::cofmsg* msg =
+				new rofl::openflow::cofmsg_echo_request(rofl::openflow13::OFP_VERSION, (ctx->producer_id << 24) | i);
+		while (true) {
+			try {
+				ctx->queue->store(msg);
+				break;
+			} catch (rofl::eRofQueueFull& e) {
+				sched_yield();
+			}
+		}
+	}
+	return NULL;
+}
+
+}; // end of anonymous namespace
+
+
+
+void
+crofqueue_test::setUp()
+{
+}
+
+
+
+void
+crofqueue_test::tearDown()
+{
+}
+
+
+
+void
+crofqueue_test::testStoreRetrieve()
+{
+	rofl::crofqueue queue;
+
+	CPPUNIT_ASSERT(queue.empty());
+	CPPUNIT_ASSERT(NULL == queue.front());
+	CPPUNIT_ASSERT(NULL == queue.retrieve());
+
+	for (unsigned int i = 0; i < 10; i++) {
+		CPPUNIT_ASSERT(i + 1 == queue.store(new rofl::openflow::cofmsg_echo_request(rofl::openflow13::OFP_VERSION, i)));
+	}
+
+	CPPUNIT_ASSERT(not queue.empty());
+	CPPUNIT_ASSERT(10 == queue.size());
+
+	rofl::openflow::cofmsg* msg = queue.front();
+	CPPUNIT_ASSERT(0 == msg->get_xid());
+	queue.pop();
+	delete msg;
+
+	for (unsigned int i = 1; i < 5; i++) {
+		msg = queue.retrieve();
+		CPPUNIT_ASSERT(i == msg->get_xid());
+		delete msg;
+	}
+
+	queue.clear();
+	CPPUNIT_ASSERT(queue.empty());
+	CPPUNIT_ASSERT(0 == queue.size());
+}
+
+
+
+void
+crofqueue_test::testCapacity()
+{
+	rofl::crofqueue queue(5);
+
+	CPPUNIT_ASSERT(8 == queue.capacity());
+
+	for (unsigned int i = 0; i < queue.capacity(); i++) {
+		queue.store(new rofl::openflow::cofmsg_echo_request(rofl::openflow13::OFP_VERSION, i));
+	}
+
+	rofl::openflow::cofmsg* msg = new rofl::openflow::cofmsg_echo_request(rofl::openflow13::OFP_VERSION, 8);
+	try {
+		queue.store(msg);
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eRofQueueFull& e) {}
+
+	// free one slot, message is accepted afterwards
+	delete queue.retrieve();
+	queue.store(msg);
+
+	for (unsigned int i = 1; i <= queue.capacity(); i++) {
+		msg = queue.retrieve();
+		CPPUNIT_ASSERT(i == msg->get_xid());
+		delete msg;
+	}
+	CPPUNIT_ASSERT(queue.empty());
+
+	// copies are empty queues of identical capacity
+	queue.store(new rofl::openflow::cofmsg_echo_request(rofl::openflow13::OFP_VERSION, 0));
+	rofl::crofqueue copy(queue);
+	CPPUNIT_ASSERT(copy.empty());
+	CPPUNIT_ASSERT(queue.capacity() == copy.capacity());
+}
+
+
+
+void
+crofqueue_test::testMultipleProducers()
+{
+	rofl::crofqueue queue(1024);
+	pthread_t tids[NUM_PRODUCERS];
+	producer_ctx ctxs[NUM_PRODUCERS];
+	unsigned int next_seqno[NUM_PRODUCERS];
+
+	for (unsigned int i = 0; i < NUM_PRODUCERS; i++) {
+		ctxs[i].queue = &queue;
+		ctxs[i].producer_id = i;
+		next_seqno[i] = 0;
+		CPPUNIT_ASSERT(0 == pthread_create(&tids[i], NULL, producer, &ctxs[i]));
+	}
+
+	unsigned int rcvd = 0;
+	while (rcvd < NUM_PRODUCERS * NUM_MSGS_PER_PRODUCER) {
+		rofl::openflow::cofmsg* msg = queue.retrieve();
+		if (NULL == msg) {
+			sched_yield();
+			continue;
+		}
+		unsigned int producer_id = msg->get_xid() >> 24;
+		unsigned int seqno = msg->get_xid() & 0x00ffffff;
+		CPPUNIT_ASSERT(producer_id < NUM_PRODUCERS);
+		// messages from a single producer arrive in order
+		CPPUNIT_ASSERT(next_seqno[producer_id] == seqno);
+		next_seqno[producer_id]++;
+		rcvd++;
+		delete msg;
+	}
+
+	for (unsigned int i = 0; i < NUM_PRODUCERS; i++) {
+		pthread_join(tids[i], NULL);
+		CPPUNIT_ASSERT(NUM_MSGS_PER_PRODUCER == next_seqno[i]);
+	}
+	CPPUNIT_ASSERT(queue.empty());
+}
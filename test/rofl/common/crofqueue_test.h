@@ -0,0 +1,29 @@
+/*
+ * crofqueue_test.h
+ */
+
+#ifndef CROFQUEUE_TEST_H_
+#define CROFQUEUE_TEST_H_
+
+#include "rofl/common/crofqueue.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class crofqueue_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( crofqueue_test );
+	CPPUNIT_TEST( testStoreRetrieve );
+	CPPUNIT_TEST( testCapacity );
+	CPPUNIT_TEST( testMultipleProducers );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testStoreRetrieve();
+	void testCapacity();
+	void testMultipleProducers();
+};
+
+#endif /* CROFQUEUE_TEST_H_ */
@@ -0,0 +1,242 @@
+/*
+ * crofsched_test.cc
+ */
+
+#include "crofsched_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( crofsched_test );
+
+namespace {
+
+static unsigned int const NUM_QUEUES = 4;
+
+/*
+ * serves num messages from queues with infinite backlog of messages of
+ * length len[queue_id] and returns bytes served per queue
+ */
+void
+serve(
+		rofl::crofsched& sched,
+		const size_t* len,
+		unsigned int num,
+		uint64_t* bytes)
+{
+	for (unsigned int i = 0; i < NUM_QUEUES; i++)
+		bytes[i] = 0;
+	for (unsigned int i = 0; i < num; i++) {
+		int queue_id = sched.select(len);
+		CPPUNIT_ASSERT(queue_id >= 0);
+		CPPUNIT_ASSERT(len[queue_id] > 0);
+		bytes[queue_id] += len[queue_id];
+	}
+}
+
+}; // end of anonymous namespace
+
+
+
+void
+crofsched_test::setUp()
+{}
+
+
+
+void
+crofsched_test::tearDown()
+{}
+
+
+
+void
+crofsched_test::testWeights()
+{
+	rofl::crofsched* sched = rofl::crofsched::create(rofl::crofsched::SCHED_WRR, NUM_QUEUES);
+
+	CPPUNIT_ASSERT(rofl::crofsched::SCHED_WRR == sched->get_type());
+	CPPUNIT_ASSERT(NUM_QUEUES == sched->get_num_queues());
+	CPPUNIT_ASSERT(NUM_QUEUES == sched->get_weights_sum());
+
+	sched->set_weight(0, 4);
+	sched->set_weight(1, 0);
+	CPPUNIT_ASSERT(4 == sched->get_weight(0));
+	CPPUNIT_ASSERT(1 == sched->get_weight(1));
+	CPPUNIT_ASSERT(7 == sched->get_weights_sum());
+
+	bool thrown = false;
+	try {
+		sched->set_weight(NUM_QUEUES, 1);
+	} catch (rofl::eRofSchedInval& e) {
+		thrown = true;
+	}
+	CPPUNIT_ASSERT(thrown);
+
+	thrown = false;
+	try {
+		delete rofl::crofsched::create((enum rofl::crofsched::crofsched_type_t)99, NUM_QUEUES);
+	} catch (rofl::eRofSchedInval& e) {
+		thrown = true;
+	}
+	CPPUNIT_ASSERT(thrown);
+
+	// a replacement inherits weights
+	rofl::crofsched* drr = rofl::crofsched::create(rofl::crofsched::SCHED_DRR, NUM_QUEUES);
+	drr->assign(*sched);
+	CPPUNIT_ASSERT(4 == drr->get_weight(0));
+	CPPUNIT_ASSERT(7 == drr->get_weights_sum());
+
+	delete drr;
+	delete sched;
+}
+
+
+
+void
+crofsched_test::testWrr()
+{
+	rofl::crofsched* sched = rofl::crofsched::create(rofl::crofsched::SCHED_WRR, NUM_QUEUES);
+	sched->set_weight(0, 2);
+	sched->set_weight(1, 1);
+	sched->set_weight(2, 3);
+	sched->set_weight(3, 1);
+
+	size_t backlog[NUM_QUEUES] = { 64, 64, 64, 0 };
+
+	// rounds of 2x queue 0, 1x queue 1, 3x queue 2, empty queue 3 skipped
+	int expected[] = { 0, 0, 1, 2, 2, 2, 0, 0, 1, 2 };
+	for (unsigned int i = 0; i < sizeof(expected) / sizeof(int); i++) {
+		CPPUNIT_ASSERT(expected[i] == sched->select(backlog));
+	}
+
+	size_t empty[NUM_QUEUES] = { 0, 0, 0, 0 };
+	CPPUNIT_ASSERT(-1 == sched->select(empty));
+
+	delete sched;
+}
+
+
+
+void
+crofsched_test::testPriority()
+{
+	rofl::crofsched* sched = rofl::crofsched::create(rofl::crofsched::SCHED_PRIORITY, NUM_QUEUES);
+	sched->set_weight(0, 8);
+	sched->set_weight(1, 2);
+	sched->set_weight(2, 2);
+	sched->set_weight(3, 4);
+
+	size_t backlog[NUM_QUEUES] = { 64, 64, 64, 64 };
+	CPPUNIT_ASSERT(0 == sched->select(backlog));
+	CPPUNIT_ASSERT(0 == sched->select(backlog));
+
+	backlog[0] = 0;
+	CPPUNIT_ASSERT(3 == sched->select(backlog));
+
+	// ties are broken by lower queue index
+	backlog[3] = 0;
+	CPPUNIT_ASSERT(1 == sched->select(backlog));
+
+	backlog[1] = 0;
+	CPPUNIT_ASSERT(2 == sched->select(backlog));
+
+	backlog[2] = 0;
+	CPPUNIT_ASSERT(-1 == sched->select(backlog));
+
+	delete sched;
+}
+
+
+
+void
+crofsched_test::testDrr()
+{
+	rofl::crofsched* sched = rofl::crofsched::create(rofl::crofsched::SCHED_DRR, NUM_QUEUES);
+
+	// equal weights share bytes equally regardless of message sizes
+	size_t len[NUM_QUEUES] = { 64, 1500, 9000, 0 };
+	uint64_t bytes[NUM_QUEUES];
+
+	serve(*sched, len, 30000, bytes);
+	uint64_t total = bytes[0] + bytes[1] + bytes[2];
+	for (unsigned int i = 0; i < 3; i++) {
+		CPPUNIT_ASSERT(bytes[i] * 3 > total * 95 / 100);
+		CPPUNIT_ASSERT(bytes[i] * 3 < total * 105 / 100);
+	}
+	CPPUNIT_ASSERT(0 == bytes[3]);
+
+	// bytes are shared according to weights
+	sched->set_weight(0, 3);
+	sched->set_weight(1, 1);
+	size_t len2[NUM_QUEUES] = { 200, 200, 0, 0 };
+	serve(*sched, len2, 40000, bytes);
+	CPPUNIT_ASSERT(bytes[0] > bytes[1] * 29 / 10);
+	CPPUNIT_ASSERT(bytes[0] < bytes[1] * 31 / 10);
+
+	// messages larger than a quantum are served eventually
+	size_t len3[NUM_QUEUES] = { 0, 0, 0, 65535 };
+	CPPUNIT_ASSERT(3 == sched->select(len3));
+
+	delete sched;
+}
+
+
+
+void
+crofsched_test::testWfq()
+{
+	rofl::crofsched* sched = rofl::crofsched::create(rofl::crofsched::SCHED_WFQ, NUM_QUEUES);
+	sched->set_weight(0, 1);
+	sched->set_weight(1, 2);
+	sched->set_weight(2, 4);
+	sched->set_weight(3, 1);
+
+	// bandwidth follows weights 1:2:4 for messages of different sizes
+	size_t len[NUM_QUEUES] = { 100, 300, 1000, 0 };
+	uint64_t bytes[NUM_QUEUES];
+
+	serve(*sched, len, 20000, bytes);
+	CPPUNIT_ASSERT(bytes[1] > bytes[0] * 19 / 10);
+	CPPUNIT_ASSERT(bytes[1] < bytes[0] * 21 / 10);
+	CPPUNIT_ASSERT(bytes[2] > bytes[0] * 39 / 10);
+	CPPUNIT_ASSERT(bytes[2] < bytes[0] * 41 / 10);
+	CPPUNIT_ASSERT(0 == bytes[3]);
+
+	// a queue becoming backlogged does not get credit for its idle time
+	len[3] = 100;
+	serve(*sched, len, 100, bytes);
+	CPPUNIT_ASSERT(bytes[3] > 0);
+	CPPUNIT_ASSERT(bytes[3] <= bytes[0] + 100);
+
+	delete sched;
+}
+
+
+
+void
+crofsched_test::testStats()
+{
+	rofl::crofsched* sched = rofl::crofsched::create(rofl::crofsched::SCHED_WRR, NUM_QUEUES);
+
+	sched->account(1, 100, 2000, 3);
+	sched->account(1, 50, 1000, 7);
+	sched->account(NUM_QUEUES, 50, 1000, 7); // ignored
+
+	rofl::crofsched_stats stats = sched->get_stats(1);
+	CPPUNIT_ASSERT(2 == stats.msgs);
+	CPPUNIT_ASSERT(150 == stats.bytes);
+	CPPUNIT_ASSERT(1500 == stats.get_delay_avg());
+	CPPUNIT_ASSERT(2000 == stats.delay_max);
+	CPPUNIT_ASSERT(7 == stats.depth_max);
+	CPPUNIT_ASSERT(0 == sched->get_stats(0).msgs);
+
+	rofl::crofsched_stats sum;
+	sum += stats;
+	sum += stats;
+	CPPUNIT_ASSERT(4 == sum.msgs);
+	CPPUNIT_ASSERT(2000 == sum.delay_max);
+
+	sched->clear_stats();
+	CPPUNIT_ASSERT(0 == sched->get_stats(1).msgs);
+	CPPUNIT_ASSERT(0 == sched->get_stats(1).delay_max);
+
+	delete sched;
+}
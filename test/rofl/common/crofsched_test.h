@@ -0,0 +1,35 @@
+/*
+ * crofsched_test.h
+ */
+
+#ifndef CROFSCHED_TEST_H_
+#define CROFSCHED_TEST_H_
+
+#include "rofl/common/crofsched.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class crofsched_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( crofsched_test );
+	CPPUNIT_TEST( testWeights );
+	CPPUNIT_TEST( testWrr );
+	CPPUNIT_TEST( testPriority );
+	CPPUNIT_TEST( testDrr );
+	CPPUNIT_TEST( testWfq );
+	CPPUNIT_TEST( testStats );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testWeights();
+	void testWrr();
+	void testPriority();
+	void testDrr();
+	void testWfq();
+	void testStats();
+};
+
+#endif /* CROFSCHED_TEST_H_ */
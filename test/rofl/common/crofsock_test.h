@@ -0,0 +1,143 @@
+/*
+ * crofsock_test.h
+ */
+
+#ifndef CROFSOCK_TEST_H_
+#define CROFSOCK_TEST_H_
+
+#include "rofl/common/ciosrv.h"
+#include "rofl/common/csocket.h"
+#include "rofl/common/crofsock.h"
+#include "rofl/common/ctimerid.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class crofsock_test :
+		public CppUnit::TestFixture,
+		public rofl::ciosrv,
+		public rofl::csocket_env,
+		public rofl::crofsock_env {
+
+	CPPUNIT_TEST_SUITE( crofsock_test );
+	CPPUNIT_TEST( testFramedReceive );
+	CPPUNIT_TEST( testBackpressure );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testFramedReceive();
+	void testBackpressure();
+
+private:
+
+	enum crofsock_test_timer_t {
+		TIMER_TEST_TIMEOUT = 1,
+		TIMER_RESUME_READING = 2,
+	};
+
+	static unsigned int const	NUM_MSGS = 256;
+	static unsigned int const	TXQUEUE_CAPACITY = 8;
+
+	unsigned int				num_msgs_expected;
+	unsigned int				num_msgs_rcvd;
+	bool						rx_stalled;
+	bool						txqueue_full;
+	rofl::ctimerid				timeout_timer_id;
+
+	rofl::csocket*				server;
+	rofl::crofsock*				client;
+	rofl::crofsock*				worker;
+	rofl::cparams				sparams;
+	rofl::cparams				cparams;
+
+	virtual void
+	handle_timeout(int opaque, void* data = NULL);
+
+private:
+
+	/*
+	 * csocket_env
+	 */
+
+	virtual void
+	handle_listen(
+			rofl::csocket& socket, int newsd);
+
+	virtual void
+	handle_accepted(
+			rofl::csocket& socket) {};
+
+	virtual void
+	handle_accept_refused(
+			rofl::csocket& socket) { CPPUNIT_ASSERT(false); };
+
+	virtual void
+	handle_connected(
+			rofl::csocket& socket) {};
+
+	virtual void
+	handle_connect_refused(
+			rofl::csocket& socket) { CPPUNIT_ASSERT(false); };
+
+	virtual void
+	handle_connect_failed(
+			rofl::csocket& socket) { CPPUNIT_ASSERT(false); };
+
+	virtual void
+	handle_read(
+			rofl::csocket& socket) {};
+
+	virtual void
+	handle_write(
+			rofl::csocket& socket) {};
+
+	virtual void
+	handle_closed(
+			rofl::csocket& socket) {};
+
+private:
+
+	/*
+	 * crofsock_env
+	 */
+
+	virtual void
+	handle_connect_refused(
+			rofl::crofsock& rofsock) { CPPUNIT_ASSERT(false); };
+
+	virtual void
+	handle_connect_failed(
+			rofl::crofsock& rofsock) { CPPUNIT_ASSERT(false); };
+
+	virtual void
+	handle_connected(
+			rofl::crofsock& rofsock);
+
+	virtual void
+	handle_closed(
+			rofl::crofsock& rofsock) {};
+
+	virtual void
+	handle_write(
+			rofl::crofsock& rofsock) {};
+
+	virtual void
+	recv_message(
+			rofl::crofsock& rofsock, rofl::openflow::cofmsg *msg);
+
+	virtual bool
+	recv_message_view(
+			rofl::crofsock& rofsock, rofl::openflow::cofmsg_view const& view);
+
+	virtual bool
+	recv_ready(
+			rofl::crofsock& rofsock, uint8_t version, uint8_t type)
+	{ return not rx_stalled; };
+
+	void
+	count_message();
+};
+
+#endif /* CROFSOCK_TEST_H_ */
@@ -0,0 +1,190 @@
+/*
+ * csocket_openssl_test.cc
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "csocket_openssl_test.h"
+#include "ssl_cert_helper.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( csocket_openssl_test );
+
+namespace {
+
+/*
+ * byte at offset in the stream sent from client to worker, a period not
+ * dividing the message sizes detects reordered or repeated data
+ */
+inline uint8_t
+stream_byte(size_t offset)
+{
+	return (uint8_t)(offset % 251);
+}
+
+}; // end of anonymous namespace
+
+
+
+void
+csocket_openssl_test::setUp()
+{
+#ifdef DEBUG
+	rofl::logging::set_debug_level(7);
+#endif
+	CPPUNIT_ASSERT(create_self_signed_cert("csocket_openssl_test", certfile, keyfile));
+	num_bytes_sent = 0;
+	num_bytes_rcvd = 0;
+	data_ok = true;
+	server = NULL;
+	client = NULL;
+	worker = NULL;
+}
+
+
+
+void
+csocket_openssl_test::tearDown()
+{
+	rofl::cioloop::get_loop().stop();
+	rofl::cioloop::get_loop().shutdown();
+	rofl::csslctx::purge();
+	unlink(certfile.c_str());
+	unlink(keyfile.c_str());
+}
+
+
+
+void
+csocket_openssl_test::testAggregatedWrite()
+{
+	try {
+		sparams = rofl::csocket::get_default_params(rofl::csocket::SOCKET_TYPE_OPENSSL);
+		sparams.set_param(rofl::csocket::PARAM_KEY_LOCAL_HOSTNAME).set_string("127.0.0.1");
+		sparams.set_param(rofl::csocket::PARAM_KEY_LOCAL_PORT).set_string("3336");
+		sparams.set_param(rofl::csocket::PARAM_KEY_DOMAIN).set_string("inet");
+		sparams.set_param(rofl::csocket::PARAM_KEY_TYPE).set_string("stream");
+		sparams.set_param(rofl::csocket::PARAM_KEY_PROTOCOL).set_string("tcp");
+		sparams.set_param(rofl::csocket::PARAM_SSL_KEY_CA_FILE).set_string(certfile);
+		sparams.set_param(rofl::csocket::PARAM_SSL_KEY_CERT).set_string(certfile);
+		sparams.set_param(rofl::csocket::PARAM_SSL_KEY_PRIVATE_KEY).set_string(keyfile);
+
+		server = rofl::csocket::csocket_factory(rofl::csocket::SOCKET_TYPE_OPENSSL, this);
+		server->listen(sparams);
+
+		cparams = rofl::csocket::get_default_params(rofl::csocket::SOCKET_TYPE_OPENSSL);
+		cparams.set_param(rofl::csocket::PARAM_KEY_REMOTE_HOSTNAME).set_string("127.0.0.1");
+		cparams.set_param(rofl::csocket::PARAM_KEY_REMOTE_PORT).set_string("3336");
+		cparams.set_param(rofl::csocket::PARAM_KEY_DOMAIN).set_string("inet");
+		cparams.set_param(rofl::csocket::PARAM_KEY_TYPE).set_string("stream");
+		cparams.set_param(rofl::csocket::PARAM_KEY_PROTOCOL).set_string("tcp");
+		cparams.set_param(rofl::csocket::PARAM_SSL_KEY_CA_FILE).set_string(certfile);
+		cparams.set_param(rofl::csocket::PARAM_SSL_KEY_CERT).set_string(certfile);
+		cparams.set_param(rofl::csocket::PARAM_SSL_KEY_PRIVATE_KEY).set_string(keyfile);
+
+		client = rofl::csocket::csocket_factory(rofl::csocket::SOCKET_TYPE_OPENSSL, this);
+		client->connect(cparams);
+
+		timeout_timer_id = register_timer(TIMER_TEST_TIMEOUT, 30);
+
+		rofl::cioloop::get_loop().run();
+
+		CPPUNIT_ASSERT(NULL != worker);
+		CPPUNIT_ASSERT(num_bytes_sent > 0);
+		CPPUNIT_ASSERT(data_ok);
+		CPPUNIT_ASSERT(num_bytes_sent == num_bytes_rcvd);
+
+		delete client;
+		delete worker;
+		delete server;
+
+	} catch (rofl::eOpenSSL& e) {
+		std::cerr << e;
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eSocketBase& e) {
+		std::cerr << e;
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eSysCall& e) {
+		std::cerr << e;
+		CPPUNIT_ASSERT(false);
+	}
+}
+
+
+
+void
+csocket_openssl_test::handle_timeout(int opaque, void* data)
+{
+	switch (opaque) {
+	case TIMER_TEST_TIMEOUT: {
+		rofl::cioloop::get_loop().stop();
+	} break;
+	}
+}
+
+
+
+void
+csocket_openssl_test::handle_listen(
+		rofl::csocket& socket, int newsd)
+{
+	worker = rofl::csocket::csocket_factory(rofl::csocket::SOCKET_TYPE_OPENSSL, this);
+	worker->accept(sparams, newsd);
+}
+
+
+
+void
+csocket_openssl_test::handle_connected(
+		rofl::csocket& socket)
+{
+	/*
+	 * small messages are aggregated into TLS records, large ones exceed
+	 * TX_RECORD_SIZE. The volume exceeds the loopback socket buffers and
+	 * the worker cannot read before the client yields the loop, so the
+	 * client's SSL_write() runs into SSL_ERROR_WANT_WRITE and is retried.
+	 */
+	for (unsigned int i = 0; i < NUM_MSGS; i++) {
+		size_t len = (i % 16 == 15) ? LARGE_MSG_SIZE : 1 + (i * 37) % 300;
+		rofl::cmemory* mem = new rofl::cmemory(len);
+		for (size_t j = 0; j < len; j++) {
+			(*mem)[j] = stream_byte(num_bytes_sent + j);
+		}
+		num_bytes_sent += len;
+		client->send(mem);
+	}
+}
+
+
+
+void
+csocket_openssl_test::handle_read(
+		rofl::csocket& socket)
+{
+	if (&socket != worker)
+		return;
+
+	uint8_t buf[8192];
+	while (true) {
+		ssize_t rc = 0;
+		try {
+			rc = socket.recv(buf, sizeof(buf));
+		} catch (rofl::eSocketRxAgain& e) {
+			return;
+		}
+		for (ssize_t i = 0; i < rc; i++) {
+			if (buf[i] != stream_byte(num_bytes_rcvd + i))
+				data_ok = false;
+		}
+		num_bytes_rcvd += rc;
+
+		if (num_bytes_rcvd >= num_bytes_sent) {
+			rofl::cioloop::get_loop().stop();
+			return;
+		}
+	}
+}
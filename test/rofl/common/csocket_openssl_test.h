@@ -0,0 +1,101 @@
+/*
+ * csocket_openssl_test.h
+ */
+
+#ifndef CSOCKET_OPENSSL_TEST_H_
+#define CSOCKET_OPENSSL_TEST_H_
+
+#include <string>
+
+#include "rofl/common/ciosrv.h"
+#include "rofl/common/csocket.h"
+#include "rofl/common/csocket_openssl.h"
+#include "rofl/common/ctimerid.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class csocket_openssl_test :
+		public CppUnit::TestFixture,
+		public rofl::ciosrv,
+		public rofl::csocket_env {
+
+	CPPUNIT_TEST_SUITE( csocket_openssl_test );
+	CPPUNIT_TEST( testAggregatedWrite );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testAggregatedWrite();
+
+private:
+
+	enum csocket_openssl_test_timer_t {
+		TIMER_TEST_TIMEOUT = 1,
+	};
+
+	static unsigned int const	NUM_MSGS = 4096;
+	static size_t const			LARGE_MSG_SIZE = 100000;	// exceeds a single TLS record
+
+	std::string					certfile;
+	std::string					keyfile;
+
+	size_t						num_bytes_sent;
+	size_t						num_bytes_rcvd;
+	bool						data_ok;
+	rofl::ctimerid				timeout_timer_id;
+
+	rofl::csocket*				server;
+	rofl::csocket*				client;
+	rofl::csocket*				worker;
+	rofl::cparams				sparams;
+	rofl::cparams				cparams;
+
+	virtual void
+	handle_timeout(int opaque, void* data = NULL);
+
+private:
+
+	/*
+	 * csocket_env
+	 */
+
+	virtual void
+	handle_listen(
+			rofl::csocket& socket, int newsd);
+
+	virtual void
+	handle_accepted(
+			rofl::csocket& socket) {};
+
+	virtual void
+	handle_accept_refused(
+			rofl::csocket& socket) { rofl::cioloop::get_loop().stop(); };
+
+	virtual void
+	handle_connected(
+			rofl::csocket& socket);
+
+	virtual void
+	handle_connect_refused(
+			rofl::csocket& socket) { rofl::cioloop::get_loop().stop(); };
+
+	virtual void
+	handle_connect_failed(
+			rofl::csocket& socket) { rofl::cioloop::get_loop().stop(); };
+
+	virtual void
+	handle_read(
+			rofl::csocket& socket);
+
+	virtual void
+	handle_write(
+			rofl::csocket& socket) {};
+
+	virtual void
+	handle_closed(
+			rofl::csocket& socket) {};
+};
+
+#endif /* CSOCKET_OPENSSL_TEST_H_ */
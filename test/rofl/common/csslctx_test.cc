@@ -0,0 +1,190 @@
+/*
+ * csslctx_test.cc
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "csslctx_test.h"
+#include "ssl_cert_helper.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( csslctx_test );
+
+namespace {
+
+/*
+ * runs a handshake between client and server via a BIO pair, followed by
+ * a single byte sent by the server, which delivers TLS 1.3 session tickets
+ */
+bool
+handshake(SSL* client, SSL* server)
+{
+	BIO* cbio = NULL;
+	BIO* sbio = NULL;
+	if (!BIO_new_bio_pair(&cbio, 0, &sbio, 0))
+		return false;
+	SSL_set_bio(client, cbio, cbio);
+	SSL_set_bio(server, sbio, sbio);
+	SSL_set_connect_state(client);
+	SSL_set_accept_state(server);
+
+	bool client_done = false, server_done = false;
+	for (unsigned int i = 0; (i < 100) && not (client_done && server_done); i++) {
+		int rc;
+		if (not client_done) {
+			if ((rc = SSL_do_handshake(client)) == 1)
+				client_done = true;
+			else if (SSL_get_error(client, rc) != SSL_ERROR_WANT_READ)
+				return false;
+		}
+		if (not server_done) {
+			if ((rc = SSL_do_handshake(server)) == 1)
+				server_done = true;
+			else if (SSL_get_error(server, rc) != SSL_ERROR_WANT_READ)
+				return false;
+		}
+	}
+	if (not (client_done && server_done))
+		return false;
+
+	char c = 'x';
+	if (SSL_write(server, &c, 1) != 1)
+		return false;
+	return (SSL_read(client, &c, 1) == 1);
+}
+
+bool
+connect_once(rofl::csslctx* sslctx, const std::string& peer, bool tls12)
+{
+	SSL* client = SSL_new(sslctx->get_ssl_ctx());
+	SSL* server = SSL_new(sslctx->get_ssl_ctx());
+	if (tls12) {
+		// session id based resumption from the server's session cache
+		SSL_set_max_proto_version(client, TLS1_2_VERSION);
+		SSL_set_options(client, SSL_OP_NO_TICKET);
+		SSL_set_options(server, SSL_OP_NO_TICKET);
+	}
+	sslctx->prepare_client(client, peer);
+	CPPUNIT_ASSERT(handshake(client, server));
+	bool reused = SSL_session_reused(client) && SSL_session_reused(server);
+	// sessions of connections closed without close_notify are not resumed
+	SSL_shutdown(client);
+	SSL_shutdown(server);
+	SSL_free(client);
+	SSL_free(server);
+	return reused;
+}
+
+}; // end of anonymous namespace
+
+
+
+void
+csslctx_test::setUp()
+{
+	CPPUNIT_ASSERT(create_self_signed_cert("csslctx_test", certfile, keyfile));
+	key.cafile = certfile;
+	key.certfile = certfile;
+	key.keyfile = keyfile;
+	key.verify_mode = "PEER";
+	key.verify_depth = "1";
+}
+
+
+
+void
+csslctx_test::tearDown()
+{
+	rofl::csslctx::purge();
+	unlink(certfile.c_str());
+	unlink(keyfile.c_str());
+}
+
+
+
+void
+csslctx_test::testShared()
+{
+	rofl::csslctx* ctx1 = rofl::csslctx::acquire(key);
+	rofl::csslctx* ctx2 = rofl::csslctx::acquire(key);
+	CPPUNIT_ASSERT(ctx1 == ctx2);
+	CPPUNIT_ASSERT(2 == ctx1->get_refcnt());
+	CPPUNIT_ASSERT(1 == rofl::csslctx::get_num_contexts());
+
+	rofl::csslctx::ckey other(key);
+	other.ciphers = "HIGH:!aNULL";
+	rofl::csslctx* ctx3 = rofl::csslctx::acquire(other);
+	CPPUNIT_ASSERT(ctx3 != ctx1);
+	CPPUNIT_ASSERT(2 == rofl::csslctx::get_num_contexts());
+
+	// unreferenced contexts are kept until purged
+	rofl::csslctx::release(ctx1);
+	rofl::csslctx::release(ctx2);
+	rofl::csslctx::purge();
+	CPPUNIT_ASSERT(1 == rofl::csslctx::get_num_contexts());
+	rofl::csslctx::release(ctx3);
+	CPPUNIT_ASSERT(1 == rofl::csslctx::get_num_contexts());
+	CPPUNIT_ASSERT(ctx3 == rofl::csslctx::acquire(other));
+	rofl::csslctx::release(ctx3);
+	rofl::csslctx::purge();
+	CPPUNIT_ASSERT(0 == rofl::csslctx::get_num_contexts());
+}
+
+
+
+void
+csslctx_test::testLoadFailure()
+{
+	rofl::csslctx::ckey bad(key);
+	bad.keyfile = "/nonexistent/key.pem";
+	try {
+		rofl::csslctx::acquire(bad);
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eOpenSSL& e) {
+		// expected
+	}
+	CPPUNIT_ASSERT(0 == rofl::csslctx::get_num_contexts());
+}
+
+
+
+void
+csslctx_test::testResumeTicket()
+{
+	rofl::csslctx* sslctx = rofl::csslctx::acquire(key);
+
+	CPPUNIT_ASSERT(not connect_once(sslctx, "127.0.0.1:6653", false));
+	CPPUNIT_ASSERT(1 == sslctx->get_num_sessions());
+	CPPUNIT_ASSERT(connect_once(sslctx, "127.0.0.1:6653", false));
+
+	// other peer, no session stored yet
+	CPPUNIT_ASSERT(not connect_once(sslctx, "127.0.0.2:6653", false));
+	CPPUNIT_ASSERT(2 == sslctx->get_num_sessions());
+
+	// no session offered after drop
+	sslctx->drop_session("127.0.0.1:6653");
+	CPPUNIT_ASSERT(not connect_once(sslctx, "127.0.0.1:6653", false));
+
+	// empty peer disables resumption
+	CPPUNIT_ASSERT(not connect_once(sslctx, "", false));
+	CPPUNIT_ASSERT(not connect_once(sslctx, "", false));
+
+	rofl::csslctx::release(sslctx);
+}
+
+
+
+void
+csslctx_test::testResumeSessionCache()
+{
+	rofl::csslctx* sslctx = rofl::csslctx::acquire(key);
+
+	CPPUNIT_ASSERT(not connect_once(sslctx, "127.0.0.1:6653", true));
+	CPPUNIT_ASSERT(connect_once(sslctx, "127.0.0.1:6653", true));
+
+	rofl::csslctx::release(sslctx);
+}
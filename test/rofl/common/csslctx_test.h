@@ -0,0 +1,38 @@
+/*
+ * csslctx_test.h
+ */
+
+#ifndef CSSLCTX_TEST_H_
+#define CSSLCTX_TEST_H_
+
+#include <string>
+
+#include "rofl/common/csslctx.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class csslctx_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( csslctx_test );
+	CPPUNIT_TEST( testShared );
+	CPPUNIT_TEST( testLoadFailure );
+	CPPUNIT_TEST( testResumeTicket );
+	CPPUNIT_TEST( testResumeSessionCache );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testShared();
+	void testLoadFailure();
+	void testResumeTicket();
+	void testResumeSessionCache();
+
+private:
+	rofl::csslctx::ckey	key;
+	std::string			certfile;
+	std::string			keyfile;
+};
+
+#endif /* CSSLCTX_TEST_H_ */
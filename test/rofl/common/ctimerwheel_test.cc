@@ -0,0 +1,275 @@
+/*
+ * ctimerwheel_test.cc
+ */
+
+#include <stdlib.h>
+
+#include <set>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "ctimerwheel_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ctimerwheel_test );
+
+namespace {
+
+class timer_env : public rofl::ctimer_env {};
+
+rofl::ctimespec
+msecs(long ms)
+{
+	return rofl::ctimespec(ms / 1000, (ms % 1000) * 1000000);
+}
+
+unsigned int
+num_expired(rofl::ctimerwheel& wheel, const rofl::ctimespec& now)
+{
+	wheel.advance(now);
+	unsigned int num = 0;
+	rofl::ctimer timer;
+	while (wheel.get_expired_timer(timer)) {
+		num++;
+	}
+	return num;
+}
+
+}; // end of anonymous namespace
+
+
+
+void
+ctimerwheel_test::setUp()
+{
+}
+
+
+
+void
+ctimerwheel_test::tearDown()
+{
+}
+
+
+
+void
+ctimerwheel_test::testAddCancel()
+{
+	rofl::ctimerwheel wheel;
+	timer_env env;
+
+	rofl::ctimerid tid1 = wheel.add_timer(rofl::ctimer(&env, 1, msecs(100)));
+	rofl::ctimerid tid2 = wheel.add_timer(rofl::ctimer(&env, 2, msecs(200)));
+
+	CPPUNIT_ASSERT(2 == wheel.size());
+	CPPUNIT_ASSERT(2 == wheel.size(&env));
+	CPPUNIT_ASSERT(wheel.pending(tid1));
+	CPPUNIT_ASSERT(wheel.pending(tid2));
+
+	wheel.cancel(tid1);
+
+	CPPUNIT_ASSERT(1 == wheel.size());
+	CPPUNIT_ASSERT(not wheel.pending(tid1));
+	CPPUNIT_ASSERT(wheel.pending(tid2));
+
+	// cancelling an unknown timer is a no-op
+	wheel.cancel(tid1);
+	CPPUNIT_ASSERT(1 == wheel.size());
+
+	wheel.clear();
+	CPPUNIT_ASSERT(0 == wheel.size());
+	CPPUNIT_ASSERT(0 == wheel.size(&env));
+}
+
+
+
+void
+ctimerwheel_test::testExpiry()
+{
+	rofl::ctimerwheel wheel;
+	timer_env env;
+	rofl::ctimespec start(rofl::ctimespec::now());
+
+	wheel.add_timer(rofl::ctimer(&env, 2, msecs(20)));
+	wheel.add_timer(rofl::ctimer(&env, 1, msecs(10)));
+	wheel.add_timer(rofl::ctimer(&env, 3, msecs(5000)));
+
+	rofl::ctimer timer;
+
+	wheel.advance(start);
+	CPPUNIT_ASSERT(not wheel.get_expired_timer(timer));
+
+	wheel.advance(start + msecs(15));
+	CPPUNIT_ASSERT(wheel.get_expired_timer(timer));
+	CPPUNIT_ASSERT(1 == timer.get_opaque());
+	CPPUNIT_ASSERT(&env == timer.get_timer_env());
+	CPPUNIT_ASSERT(not wheel.get_expired_timer(timer));
+
+	wheel.advance(start + msecs(25));
+	CPPUNIT_ASSERT(wheel.get_expired_timer(timer));
+	CPPUNIT_ASSERT(2 == timer.get_opaque());
+
+	// low precision timer may be delayed by a few ticks, but never fires early
+	CPPUNIT_ASSERT(0 == num_expired(wheel, start + msecs(4990)));
+	CPPUNIT_ASSERT(1 == num_expired(wheel, start + msecs(5100)));
+	CPPUNIT_ASSERT(0 == wheel.size());
+}
+
+
+
+void
+ctimerwheel_test::testReset()
+{
+	rofl::ctimerwheel wheel;
+	timer_env env;
+	rofl::ctimespec start(rofl::ctimespec::now());
+
+	rofl::ctimerid tid = wheel.add_timer(rofl::ctimer(&env, 1, msecs(10)));
+	rofl::ctimerid tid_reset = wheel.reset(tid, msecs(1000));
+
+	CPPUNIT_ASSERT(tid.get_tid() == tid_reset.get_tid());
+	CPPUNIT_ASSERT(0 == num_expired(wheel, start + msecs(500)));
+	CPPUNIT_ASSERT(wheel.pending(tid));
+
+	// timer already expired, but not yet handled
+	wheel.advance(start + msecs(1100));
+	wheel.reset(tid, msecs(2000));
+	CPPUNIT_ASSERT(0 == num_expired(wheel, start + msecs(1200)));
+	CPPUNIT_ASSERT(1 == num_expired(wheel, start + msecs(3200)));
+
+	try {
+		wheel.reset(tid, msecs(10));
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eTimersNotFound& e) {}
+}
+
+
+
+void
+ctimerwheel_test::testCascade()
+{
+	rofl::ctimerwheel wheel;
+	timer_env env;
+	rofl::ctimespec start(rofl::ctimespec::now());
+
+	// level 2: 70s, level 3: 5h, beyond wheel's range: 100d
+	wheel.add_timer(rofl::ctimer(&env, 1, rofl::ctimespec(70)));
+	wheel.add_timer(rofl::ctimer(&env, 2, rofl::ctimespec(5 * 3600)));
+	wheel.add_timer(rofl::ctimer(&env, 3, rofl::ctimespec(100 * 86400)));
+
+	for (long s = 1; s < 70; s++) {
+		CPPUNIT_ASSERT(0 == num_expired(wheel, start + rofl::ctimespec(s)));
+	}
+	CPPUNIT_ASSERT(1 == num_expired(wheel, start + rofl::ctimespec(71)));
+	CPPUNIT_ASSERT(0 == num_expired(wheel, start + rofl::ctimespec(5 * 3600 - 1)));
+	CPPUNIT_ASSERT(1 == num_expired(wheel, start + rofl::ctimespec(5 * 3600 + 1)));
+	CPPUNIT_ASSERT(0 == num_expired(wheel, start + rofl::ctimespec(60 * 86400)));
+	CPPUNIT_ASSERT(0 == num_expired(wheel, start + rofl::ctimespec(100 * 86400 - 1)));
+	CPPUNIT_ASSERT(1 == num_expired(wheel, start + rofl::ctimespec(100 * 86400 + 1)));
+}
+
+
+
+void
+ctimerwheel_test::testClearEnv()
+{
+	rofl::ctimerwheel wheel;
+	timer_env env1;
+	timer_env env2;
+
+	rofl::ctimerid tid1 = wheel.add_timer(rofl::ctimer(&env1, 1, msecs(10)));
+	wheel.add_timer(rofl::ctimer(&env1, 2, msecs(2000)));
+	wheel.add_timer(rofl::ctimer(&env1, 3, rofl::ctimespec(100)));
+	rofl::ctimerid tid2 = wheel.add_timer(rofl::ctimer(&env2, 1, msecs(10)));
+	wheel.add_timer(rofl::ctimer(&env2, 2, msecs(20)));
+
+	CPPUNIT_ASSERT(3 == wheel.size(&env1));
+	CPPUNIT_ASSERT(2 == wheel.size(&env2));
+
+	// expired timers are removed as well
+	wheel.advance(rofl::ctimespec::now() + msecs(15));
+	wheel.clear(&env1);
+
+	CPPUNIT_ASSERT(0 == wheel.size(&env1));
+	CPPUNIT_ASSERT(2 == wheel.size(&env2));
+	CPPUNIT_ASSERT(not wheel.pending(tid1));
+	CPPUNIT_ASSERT(wheel.pending(tid2));
+
+	rofl::ctimer timer;
+	CPPUNIT_ASSERT(wheel.get_expired_timer(timer));
+	CPPUNIT_ASSERT(&env2 == timer.get_timer_env());
+	CPPUNIT_ASSERT(not wheel.get_expired_timer(timer));
+}
+
+
+
+void
+ctimerwheel_test::testNextTimeout()
+{
+	rofl::ctimerwheel wheel;
+	timer_env env;
+	rofl::ctimespec timeout;
+
+	CPPUNIT_ASSERT(not wheel.get_next_timeout(timeout));
+
+	rofl::ctimerid tid = wheel.add_timer(rofl::ctimer(&env, 1, rofl::ctimespec(2)));
+	rofl::ctimespec deadline(rofl::ctimespec::now() + rofl::ctimespec(2));
+
+	CPPUNIT_ASSERT(wheel.get_next_timeout(timeout));
+	CPPUNIT_ASSERT(timeout > rofl::ctimespec::now());
+	CPPUNIT_ASSERT(timeout <= deadline + msecs(20));
+
+	rofl::ctimer timer(&env, 2, msecs(10));
+	wheel.add_timer(timer);
+
+	CPPUNIT_ASSERT(wheel.get_next_timeout(timeout));
+	CPPUNIT_ASSERT(timeout >= timer.get_timespec());
+	CPPUNIT_ASSERT(timeout <= timer.get_timespec() + msecs(1));
+
+	// expired timer waiting for being handled: service immediately
+	wheel.advance(timer.get_timespec() + msecs(1));
+	CPPUNIT_ASSERT(wheel.get_next_timeout(timeout));
+	CPPUNIT_ASSERT(timeout < rofl::ctimespec::now());
+
+	wheel.cancel(tid);
+}
+
+
+
+void
+ctimerwheel_test::testManyTimers()
+{
+	static unsigned int const NUM_TIMERS = 100000;
+
+	rofl::ctimerwheel wheel;
+	timer_env env;
+	rofl::ctimespec start(rofl::ctimespec::now());
+
+	std::vector<rofl::ctimerid> tids;
+	for (unsigned int i = 0; i < NUM_TIMERS; i++) {
+		tids.push_back(wheel.add_timer(rofl::ctimer(&env, i, msecs(rand() % 10000))));
+	}
+	CPPUNIT_ASSERT(NUM_TIMERS == wheel.size());
+
+	std::set<int> cancelled;
+	for (unsigned int i = 0; i < NUM_TIMERS; i += 2) {
+		wheel.cancel(tids[i]);
+		cancelled.insert(i);
+	}
+	CPPUNIT_ASSERT(NUM_TIMERS / 2 == wheel.size());
+
+	unsigned int num = 0;
+	for (long ms = 0; ms <= 11000; ms += 100) {
+		rofl::ctimespec now = start + msecs(ms);
+		wheel.advance(now);
+		rofl::ctimer timer;
+		while (wheel.get_expired_timer(timer)) {
+			CPPUNIT_ASSERT(cancelled.find(timer.get_opaque()) == cancelled.end());
+			CPPUNIT_ASSERT(timer.get_timespec() <= now);
+			num++;
+		}
+	}
+	CPPUNIT_ASSERT(NUM_TIMERS / 2 == num);
+	CPPUNIT_ASSERT(0 == wheel.size());
+}
@@ -0,0 +1,37 @@
+/*
+ * ctimerwheel_test.h
+ */
+
+#ifndef CTIMERWHEEL_TEST_H_
+#define CTIMERWHEEL_TEST_H_
+
+#include "rofl/common/ctimerwheel.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class ctimerwheel_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( ctimerwheel_test );
+	CPPUNIT_TEST( testAddCancel );
+	CPPUNIT_TEST( testExpiry );
+	CPPUNIT_TEST( testReset );
+	CPPUNIT_TEST( testCascade );
+	CPPUNIT_TEST( testClearEnv );
+	CPPUNIT_TEST( testNextTimeout );
+	CPPUNIT_TEST( testManyTimers );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testAddCancel();
+	void testExpiry();
+	void testReset();
+	void testCascade();
+	void testClearEnv();
+	void testNextTimeout();
+	void testManyTimers();
+};
+
+#endif /* CTIMERWHEEL_TEST_H_ */
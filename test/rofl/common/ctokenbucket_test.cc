@@ -0,0 +1,181 @@
+/*
+ * ctokenbucket_test.cc
+ */
+
+#include <pthread.h>
+
+#include "ctokenbucket_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ctokenbucket_test );
+
+namespace {
+
+static unsigned int const NUM_THREADS = 4;
+static unsigned int const NUM_ADMITS_PER_THREAD = 10000;
+static uint64_t const NOW = 1000000000ULL;
+
+struct admit_ctx {
+	rofl::ctokenbucket*	bucket;
+	unsigned int		admitted;
+};
+
+void*
+admit(void* arg)
+{
+	admit_ctx* ctx = (admit_ctx*)arg;
+	for (unsigned int i = 0; i < NUM_ADMITS_PER_THREAD; i++) {
+		if (ctx->bucket->admit(NOW))
+			ctx->admitted++;
+	}
+	return NULL;
+}
+
+}; // end of anonymous namespace
+
+
+
+void
+ctokenbucket_test::setUp()
+{}
+
+
+
+void
+ctokenbucket_test::tearDown()
+{}
+
+
+
+void
+ctokenbucket_test::testUnlimited()
+{
+	rofl::ctokenbucket bucket;
+	CPPUNIT_ASSERT(not bucket.is_limited());
+	for (unsigned int i = 0; i < 1000; i++) {
+		CPPUNIT_ASSERT(bucket.admit());
+	}
+	bucket.set_rate(10, 2);
+	CPPUNIT_ASSERT(bucket.is_limited());
+	bucket.set_rate(0, 2);
+	CPPUNIT_ASSERT(not bucket.is_limited());
+	CPPUNIT_ASSERT(bucket.admit(NOW));
+}
+
+
+
+void
+ctokenbucket_test::testBurst()
+{
+	rofl::ctokenbucket bucket(1000, 16);
+	CPPUNIT_ASSERT(1000 == bucket.get_rate());
+	CPPUNIT_ASSERT(16 == bucket.get_burst());
+
+	for (unsigned int i = 0; i < 16; i++) {
+		CPPUNIT_ASSERT(bucket.admit(NOW));
+	}
+	CPPUNIT_ASSERT(not bucket.admit(NOW));
+
+	// a burst of 0 is treated as 1
+	rofl::ctokenbucket single(1000, 0);
+	CPPUNIT_ASSERT(1 == single.get_burst());
+	CPPUNIT_ASSERT(single.admit(NOW));
+	CPPUNIT_ASSERT(not single.admit(NOW));
+
+	// copies start with a full bucket
+	rofl::ctokenbucket copy(bucket);
+	CPPUNIT_ASSERT(16 == copy.get_burst());
+	CPPUNIT_ASSERT(copy.admit(NOW));
+}
+
+
+
+void
+ctokenbucket_test::testRate()
+{
+	// one token per millisecond
+	rofl::ctokenbucket bucket(1000, 4);
+
+	for (unsigned int i = 0; i < 4; i++) {
+		CPPUNIT_ASSERT(bucket.admit(NOW));
+	}
+	CPPUNIT_ASSERT(not bucket.admit(NOW));
+	CPPUNIT_ASSERT(not bucket.admit(NOW + 500000));
+	CPPUNIT_ASSERT(bucket.admit(NOW + 1000000));
+	CPPUNIT_ASSERT(not bucket.admit(NOW + 1000000));
+
+	// one second at full rate admits 1000 messages
+	unsigned int admitted = 0;
+	for (uint64_t t = NOW + 2000000; t < NOW + 1002000000; t += 100000) {
+		if (bucket.admit(t))
+			admitted++;
+	}
+	CPPUNIT_ASSERT(1000 == admitted);
+
+	// bucket refills to its depth after being idle, but not beyond
+	uint64_t later = NOW + 10 * 1000000000ULL;
+	for (unsigned int i = 0; i < 4; i++) {
+		CPPUNIT_ASSERT(bucket.admit(later));
+	}
+	CPPUNIT_ASSERT(not bucket.admit(later));
+}
+
+
+
+void
+ctokenbucket_test::testRefund()
+{
+	rofl::ctokenbucket bucket(1000, 2);
+
+	CPPUNIT_ASSERT(bucket.admit(NOW));
+	CPPUNIT_ASSERT(bucket.admit(NOW));
+	CPPUNIT_ASSERT(not bucket.admit(NOW));
+
+	// a refunded token is available again, once
+	bucket.refund();
+	CPPUNIT_ASSERT(bucket.admit(NOW));
+	CPPUNIT_ASSERT(not bucket.admit(NOW));
+
+	// refunds do not fill the bucket beyond its depth
+	bucket.refund();
+	bucket.refund();
+	bucket.refund();
+	CPPUNIT_ASSERT(bucket.admit(NOW));
+	CPPUNIT_ASSERT(bucket.admit(NOW));
+	CPPUNIT_ASSERT(not bucket.admit(NOW));
+
+	// refunds on a refilled bucket are ignored
+	bucket.set_rate(1000, 2);
+	bucket.refund();
+	CPPUNIT_ASSERT(bucket.admit(NOW));
+	CPPUNIT_ASSERT(bucket.admit(NOW));
+	CPPUNIT_ASSERT(not bucket.admit(NOW));
+
+	// no-op without limit
+	rofl::ctokenbucket unlimited;
+	unlimited.refund();
+	CPPUNIT_ASSERT(unlimited.admit(NOW));
+}
+
+
+
+void
+ctokenbucket_test::testConcurrent()
+{
+	rofl::ctokenbucket bucket(1000, 100);
+
+	pthread_t tids[NUM_THREADS];
+	admit_ctx ctxs[NUM_THREADS];
+	for (unsigned int i = 0; i < NUM_THREADS; i++) {
+		ctxs[i].bucket = &bucket;
+		ctxs[i].admitted = 0;
+		CPPUNIT_ASSERT(0 == pthread_create(&tids[i], NULL, &admit, &ctxs[i]));
+	}
+	unsigned int admitted = 0;
+	for (unsigned int i = 0; i < NUM_THREADS; i++) {
+		pthread_join(tids[i], NULL);
+		admitted += ctxs[i].admitted;
+	}
+
+	// no token is handed out twice
+	CPPUNIT_ASSERT(100 == admitted);
+}
@@ -0,0 +1,33 @@
+/*
+ * ctokenbucket_test.h
+ */
+
+#ifndef CTOKENBUCKET_TEST_H_
+#define CTOKENBUCKET_TEST_H_
+
+#include "rofl/common/ctokenbucket.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class ctokenbucket_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( ctokenbucket_test );
+	CPPUNIT_TEST( testUnlimited );
+	CPPUNIT_TEST( testBurst );
+	CPPUNIT_TEST( testRate );
+	CPPUNIT_TEST( testRefund );
+	CPPUNIT_TEST( testConcurrent );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testUnlimited();
+	void testBurst();
+	void testRate();
+	void testRefund();
+	void testConcurrent();
+};
+
+#endif /* CTOKENBUCKET_TEST_H_ */
@@ -0,0 +1,140 @@
+/*
+ * ctransactions_test.cc
+ */
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "ctransactions_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ctransactions_test );
+
+namespace {
+
+static unsigned int const NUM_TAS = 100000;
+
+}; // end of anonymous namespace
+
+
+
+void
+ctransactions_test::setUp()
+{
+#ifdef DEBUG
+	rofl::logging::set_debug_level(7);
+#endif
+	expired.clear();
+	num_expired = 0;
+}
+
+
+
+void
+ctransactions_test::tearDown()
+{
+	rofl::cioloop::get_loop().stop();
+	rofl::cioloop::get_loop().shutdown();
+}
+
+
+
+void
+ctransactions_test::testAddDrop()
+{
+	rofl::ctransactions tas(this);
+
+	CPPUNIT_ASSERT(tas.empty());
+
+	uint32_t xid1 = tas.add_ta(rofl::cclock(5), rofl::openflow13::OFPT_BARRIER_REQUEST);
+	uint32_t xid2 = tas.add_ta(rofl::cclock(1), rofl::openflow13::OFPT_FEATURES_REQUEST);
+	uint32_t xid3 = tas.add_ta(rofl::cclock(3), rofl::openflow13::OFPT_MULTIPART_REQUEST);
+
+	CPPUNIT_ASSERT(3 == tas.size());
+	CPPUNIT_ASSERT(tas.has_ta(xid1));
+	CPPUNIT_ASSERT(tas.has_ta(xid2));
+	CPPUNIT_ASSERT(tas.has_ta(xid3));
+
+	tas.drop_ta(xid2);
+
+	CPPUNIT_ASSERT(2 == tas.size());
+	CPPUNIT_ASSERT(not tas.has_ta(xid2));
+	CPPUNIT_ASSERT(tas.has_ta(xid1));
+	CPPUNIT_ASSERT(tas.has_ta(xid3));
+
+	// dropping an unknown xid is a no-op
+	tas.drop_ta(xid2);
+	CPPUNIT_ASSERT(2 == tas.size());
+
+	tas.clear();
+	CPPUNIT_ASSERT(tas.empty());
+	CPPUNIT_ASSERT(not tas.has_ta(xid1));
+}
+
+
+
+void
+ctransactions_test::testStress()
+{
+	rofl::ctransactions tas(this);
+
+	std::vector<uint32_t> xids;
+	for (unsigned int i = 0; i < NUM_TAS; i++) {
+		xids.push_back(tas.add_ta(rofl::cclock(1, (i % 1000) * 1000), rofl::openflow13::OFPT_BARRIER_REQUEST));
+	}
+	CPPUNIT_ASSERT(NUM_TAS == tas.size());
+
+	// drop every second transaction in scrambled order, as replies arrive
+	std::set<uint32_t> dropped;
+	for (unsigned int i = 0; i < NUM_TAS; i++) {
+		unsigned int j = (unsigned int)(((uint64_t)i * 104729) % NUM_TAS);
+		if (j % 2)
+			continue;
+		tas.drop_ta(xids[j]);
+		dropped.insert(xids[j]);
+	}
+	CPPUNIT_ASSERT(NUM_TAS / 2 == tas.size());
+
+	for (unsigned int i = 0; i < NUM_TAS; i++) {
+		CPPUNIT_ASSERT(tas.has_ta(xids[i]) == (dropped.find(xids[i]) == dropped.end()));
+	}
+
+	// all remaining transactions expire
+	register_timer(TIMER_TEST_TIMEOUT, rofl::ctimespec(4));
+
+	rofl::cioloop::get_loop().run();
+
+	CPPUNIT_ASSERT(NUM_TAS / 2 == num_expired);
+	CPPUNIT_ASSERT(NUM_TAS / 2 == expired.size());
+	CPPUNIT_ASSERT(tas.empty());
+	for (std::set<uint32_t>::iterator
+			it = dropped.begin(); it != dropped.end(); ++it) {
+		CPPUNIT_ASSERT(expired.find(*it) == expired.end());
+	}
+}
+
+
+
+void
+ctransactions_test::ta_expired(
+		rofl::ctransactions& tas, rofl::ctransaction& ta)
+{
+	expired.insert(ta.get_xid());
+	num_expired++;
+}
+
+
+
+void
+ctransactions_test::handle_timeout(
+		int opaque, void* data)
+{
+	switch (opaque) {
+	case TIMER_TEST_TIMEOUT: {
+		rofl::cioloop::get_loop().stop();
+	} break;
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ * ctransactions_test.h
+ */
+
+#ifndef CTRANSACTIONS_TEST_H_
+#define CTRANSACTIONS_TEST_H_
+
+#include <set>
+
+#include "rofl/common/ciosrv.h"
+#include "rofl/common/ctransactions.h"
+#include "rofl/common/openflow/openflow.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class ctransactions_test :
+		public CppUnit::TestFixture,
+		public rofl::ciosrv,
+		public rofl::ctransactions_env {
+
+	CPPUNIT_TEST_SUITE( ctransactions_test );
+	CPPUNIT_TEST( testAddDrop );
+	CPPUNIT_TEST( testStress );
+	CPPUNIT_TEST_SUITE_END();
+
+private:
+
+	enum ctransactions_test_timer_t {
+		TIMER_TEST_TIMEOUT = 1,
+	};
+
+	std::set<uint32_t>	expired;
+	unsigned int		num_expired;
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testAddDrop();
+	void testStress();
+
+protected:
+
+	virtual void
+	ta_expired(rofl::ctransactions& tas, rofl::ctransaction& ta);
+
+	virtual void
+	handle_timeout(int opaque, void* data = NULL);
+};
+
+#endif /* CTRANSACTIONS_TEST_H_ */
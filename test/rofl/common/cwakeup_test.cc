@@ -0,0 +1,198 @@
+/*
+ * cwakeup_test.cc
+ */
+
+#include <stdlib.h>
+#include <poll.h>
+#include <pthread.h>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "cwakeup_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( cwakeup_test );
+
+namespace {
+
+static unsigned int const NUM_THREADS = 4;
+static unsigned int const NUM_NOTIFICATIONS = 10000;
+
+bool
+is_readable(int fd)
+{
+	struct pollfd pfd;
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	return (poll(&pfd, 1, 0) > 0) && (pfd.revents & POLLIN);
+}
+
+void*
+run_notify(void* arg)
+{
+	rofl::cwakeup* wakeup = (rofl::cwakeup*)arg;
+	for (unsigned int i = 0; i < NUM_NOTIFICATIONS; i++) {
+		wakeup->notify();
+	}
+	return NULL;
+}
+
+/*
+ * Counts events sent from another thread and terminates its loop
+ * after the last one.
+ */
+class event_sink : public rofl::ciosrv {
+public:
+	event_sink() :
+		num_events(0),
+		requested(0),
+		delivered(0)
+	{};
+	virtual
+	~event_sink()
+	{};
+	virtual void
+	handle_event(const rofl::cevent& event) {
+		if (++num_events < NUM_NOTIFICATIONS)
+			return;
+		requested = rofl::cioloop::get_loop().get_wakeups_requested();
+		delivered = rofl::cioloop::get_loop().get_wakeups_delivered();
+		rofl::cioloop::get_loop().stop();
+	};
+	unsigned int	num_events;
+	uint64_t		requested;
+	uint64_t		delivered;
+};
+
+struct loop_thread {
+	event_sink*			sink;
+	pthread_mutex_t		lock;
+	pthread_cond_t		cond;
+	unsigned int		num_events;
+	uint64_t			requested;
+	uint64_t			delivered;
+};
+
+void*
+run_loop(void* arg)
+{
+	loop_thread* lt = (loop_thread*)arg;
+	event_sink sink;
+	pthread_mutex_lock(&lt->lock);
+	lt->sink = &sink;
+	pthread_cond_signal(&lt->cond);
+	pthread_mutex_unlock(&lt->lock);
+
+	rofl::cioloop::get_loop().run();
+
+	// hand over results before sink is destroyed
+	lt->num_events = sink.num_events;
+	lt->requested = sink.requested;
+	lt->delivered = sink.delivered;
+	return NULL;
+}
+
+}; // end of anonymous namespace
+
+
+
+void
+cwakeup_test::setUp()
+{
+}
+
+
+
+void
+cwakeup_test::tearDown()
+{
+}
+
+
+
+void
+cwakeup_test::testCoalesce()
+{
+	rofl::cwakeup wakeup;
+
+	CPPUNIT_ASSERT(wakeup.get_fd() >= 0);
+	CPPUNIT_ASSERT(not is_readable(wakeup.get_fd()));
+
+	wakeup.notify();
+	wakeup.notify();
+	wakeup.notify();
+
+	CPPUNIT_ASSERT(is_readable(wakeup.get_fd()));
+	CPPUNIT_ASSERT(3 == wakeup.get_requested());
+	CPPUNIT_ASSERT(1 == wakeup.get_delivered());
+
+	wakeup.drain();
+	CPPUNIT_ASSERT(not is_readable(wakeup.get_fd()));
+
+	// new wakeup after drain
+	wakeup.notify();
+	CPPUNIT_ASSERT(is_readable(wakeup.get_fd()));
+	CPPUNIT_ASSERT(4 == wakeup.get_requested());
+	CPPUNIT_ASSERT(2 == wakeup.get_delivered());
+	wakeup.drain();
+
+	// spurious drain is harmless
+	wakeup.drain();
+	CPPUNIT_ASSERT(not is_readable(wakeup.get_fd()));
+}
+
+
+
+void
+cwakeup_test::testConcurrentNotify()
+{
+	rofl::cwakeup wakeup;
+	pthread_t tids[NUM_THREADS];
+
+	for (unsigned int i = 0; i < NUM_THREADS; i++) {
+		CPPUNIT_ASSERT(0 == pthread_create(&tids[i], NULL, &run_notify, &wakeup));
+	}
+	for (unsigned int i = 0; i < NUM_THREADS; i++) {
+		CPPUNIT_ASSERT(0 == pthread_join(tids[i], NULL));
+	}
+
+	// no drain in between: all notifications merged into a single one
+	CPPUNIT_ASSERT(NUM_THREADS * NUM_NOTIFICATIONS == wakeup.get_requested());
+	CPPUNIT_ASSERT(1 == wakeup.get_delivered());
+	CPPUNIT_ASSERT(is_readable(wakeup.get_fd()));
+}
+
+
+
+void
+cwakeup_test::testLoopWakeups()
+{
+	loop_thread lt;
+	lt.sink = NULL;
+	pthread_mutex_init(&lt.lock, NULL);
+	pthread_cond_init(&lt.cond, NULL);
+
+	pthread_t tid;
+	CPPUNIT_ASSERT(0 == pthread_create(&tid, NULL, &run_loop, &lt));
+
+	pthread_mutex_lock(&lt.lock);
+	while (NULL == lt.sink) {
+		pthread_cond_wait(&lt.cond, &lt.lock);
+	}
+	pthread_mutex_unlock(&lt.lock);
+
+	// inject events from this thread, none of them may get lost
+	for (unsigned int i = 0; i < NUM_NOTIFICATIONS; i++) {
+		lt.sink->notify(rofl::cevent(i));
+	}
+
+	CPPUNIT_ASSERT(0 == pthread_join(tid, NULL));
+
+	CPPUNIT_ASSERT(NUM_NOTIFICATIONS == lt.num_events);
+	CPPUNIT_ASSERT(lt.requested >= NUM_NOTIFICATIONS);
+	CPPUNIT_ASSERT(lt.delivered >= 1);
+	CPPUNIT_ASSERT(lt.delivered <= lt.requested);
+	pthread_mutex_destroy(&lt.lock);
+	pthread_cond_destroy(&lt.cond);
+}
@@ -0,0 +1,30 @@
+/*
+ * cwakeup_test.h
+ */
+
+#ifndef CWAKEUP_TEST_H_
+#define CWAKEUP_TEST_H_
+
+#include "rofl/common/cwakeup.h"
+#include "rofl/common/ciosrv.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class cwakeup_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( cwakeup_test );
+	CPPUNIT_TEST( testCoalesce );
+	CPPUNIT_TEST( testConcurrentNotify );
+	CPPUNIT_TEST( testLoopWakeups );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testCoalesce();
+	void testConcurrentNotify();
+	void testLoopWakeups();
+};
+
+#endif /* CWAKEUP_TEST_H_ */
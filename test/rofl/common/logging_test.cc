@@ -0,0 +1,97 @@
+/*
+ * logging_test.cc
+ */
+
+#include <stdlib.h>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "logging_test.h"
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION( logging_test );
+
+
+namespace {
+
+unsigned int num_calls = 0;
+
+const char*
+count_call()
+{
+	num_calls++;
+	return "";
+}
+
+};
+
+
+
+void
+logging_test::setUp()
+{
+	saved_level = rofl::logging::level;
+	num_calls = 0;
+}
+
+
+
+void
+logging_test::tearDown()
+{
+	if (saved_level >= 0) {
+		rofl::logging::set_debug_level(saved_level);
+	} else {
+		rofl::logging::set_debug_level(rofl::logging::EMERG);
+	}
+}
+
+
+
+void
+logging_test::testLevelCheck()
+{
+	rofl::logging::set_debug_level(rofl::logging::INFO);
+
+	CPPUNIT_ASSERT(rofl::logging::is_enabled(rofl::logging::EMERG));
+	CPPUNIT_ASSERT(rofl::logging::is_enabled(rofl::logging::INFO));
+	CPPUNIT_ASSERT(not rofl::logging::is_enabled(rofl::logging::DBG));
+	CPPUNIT_ASSERT(not rofl::logging::is_enabled(rofl::logging::TRACE));
+
+	rofl::logging::set_debug_level(rofl::logging::DBG2);
+
+	CPPUNIT_ASSERT(rofl::logging::is_enabled(rofl::logging::DBG2));
+	CPPUNIT_ASSERT(not rofl::logging::is_enabled(rofl::logging::DBG3));
+}
+
+
+
+void
+logging_test::testLazyEvaluation()
+{
+	rofl::logging::set_debug_level(rofl::logging::INFO);
+
+	ROFL_DEBUG  << count_call();
+	ROFL_DEBUG2 << count_call();
+	ROFL_DEBUG3 << count_call();
+	ROFL_TRACE  << count_call();
+
+	CPPUNIT_ASSERT(0 == num_calls);
+
+	// a dangling else must bind to the enclosing if statement
+	bool taken = false;
+	if (false)
+		ROFL_DEBUG << count_call();
+	else
+		taken = true;
+
+	CPPUNIT_ASSERT(taken);
+
+	rofl::logging::set_debug_level(rofl::logging::DBG);
+
+	ROFL_DEBUG  << count_call();
+	ROFL_DEBUG2 << count_call();
+
+	CPPUNIT_ASSERT(1 == num_calls);
+}
@@ -0,0 +1,31 @@
+/*
+ * logging_test.h
+ */
+
+#ifndef LOGGING_TEST_H_
+#define LOGGING_TEST_H_
+
+#include "rofl/common/logging.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class logging_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( logging_test );
+	CPPUNIT_TEST( testLevelCheck );
+	CPPUNIT_TEST( testLazyEvaluation );
+	CPPUNIT_TEST_SUITE_END();
+
+private:
+
+	int saved_level;
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testLevelCheck();
+	void testLazyEvaluation();
+};
+
+#endif /* LOGGING_TEST_H_ */
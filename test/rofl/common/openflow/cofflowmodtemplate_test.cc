@@ -0,0 +1,182 @@
+/*
+ * cofflowmodtemplate_test.cc
+ */
+
+#include <stdlib.h>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "cofflowmodtemplate_test.h"
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION( cofflowmodtemplate_test );
+
+#if defined DEBUG
+#undef DEBUG
+#endif
+
+void
+cofflowmodtemplate_test::setUp()
+{
+}
+
+
+
+void
+cofflowmodtemplate_test::tearDown()
+{
+}
+
+
+
+rofl::openflow::cofflowmod
+cofflowmodtemplate_test::flowmod10(
+		uint64_t cookie, uint16_t priority, uint16_t port_no)
+{
+	rofl::openflow::cofflowmod flowmod(rofl::openflow10::OFP_VERSION);
+	flowmod.set_command(rofl::openflow::OFPFC_ADD);
+	flowmod.set_cookie(cookie);
+	flowmod.set_priority(priority);
+	flowmod.set_idle_timeout(30);
+	flowmod.set_match().set_eth_type(0x0800);
+	flowmod.set_actions().add_action_output(rofl::cindex(0)).set_port_no(port_no);
+	return flowmod;
+}
+
+
+
+rofl::openflow::cofflowmod
+cofflowmodtemplate_test::flowmod13(
+		uint64_t cookie, uint16_t priority, const rofl::cmacaddr& eth_dst, uint16_t vid, uint32_t port_no)
+{
+	rofl::openflow::cofflowmod flowmod(rofl::openflow13::OFP_VERSION);
+	flowmod.set_command(rofl::openflow::OFPFC_ADD);
+	flowmod.set_table_id(1);
+	flowmod.set_cookie(cookie);
+	flowmod.set_priority(priority);
+	flowmod.set_idle_timeout(30);
+	flowmod.set_match().set_eth_type(0x0800);
+	flowmod.set_match().set_eth_dst(eth_dst);
+	flowmod.set_match().set_vlan_vid(vid);
+	flowmod.set_instructions().set_inst_apply_actions().set_actions().
+			add_action_output(rofl::cindex(0)).set_port_no(port_no);
+	return flowmod;
+}
+
+
+
+void
+cofflowmodtemplate_test::check(
+		rofl::openflow::cofmsg_flow_mod* msg, uint8_t ofp_version, uint32_t xid, const rofl::openflow::cofflowmod& flowmod)
+{
+	rofl::openflow::cofmsg_flow_mod reference(ofp_version, xid, flowmod);
+	rofl::cmemory expected(reference.length());
+	reference.pack(expected.somem(), expected.memlen());
+
+	CPPUNIT_ASSERT(msg->length() == expected.memlen());
+	rofl::cmemory packed(msg->length());
+	msg->pack(packed.somem(), packed.memlen());
+	CPPUNIT_ASSERT(packed == expected);
+	CPPUNIT_ASSERT(msg->get_xid() == xid);
+
+	delete msg;
+}
+
+
+
+void
+cofflowmodtemplate_test::testTemplate10()
+{
+	rofl::openflow::cofflowmodtemplate tmpl(rofl::openflow10::OFP_VERSION, flowmod10(0, 0, 0));
+
+	unsigned int cookie = tmpl.add_field(rofl::openflow::cofflowmodtemplate::FIELD_COOKIE);
+	unsigned int priority = tmpl.add_field(rofl::openflow::cofflowmodtemplate::FIELD_PRIORITY);
+	unsigned int port_no = tmpl.add_field_output();
+
+	CPPUNIT_ASSERT(tmpl.get_num_fields() == 3);
+	CPPUNIT_ASSERT(tmpl.get_field_width(cookie) == 8);
+	CPPUNIT_ASSERT(tmpl.get_field_width(port_no) == 2);
+
+	for (uint32_t i = 1; i < 16; i++) {
+		tmpl.set_field(cookie, 0xa1a2a3a4a5a6a700ULL + i);
+		tmpl.set_field(priority, 0x8000 + i);
+		tmpl.set_field(port_no, i);
+		check(tmpl.create_message(i), rofl::openflow10::OFP_VERSION, i, flowmod10(0xa1a2a3a4a5a6a700ULL + i, 0x8000 + i, i));
+	}
+}
+
+
+
+void
+cofflowmodtemplate_test::testTemplate13()
+{
+	rofl::cmacaddr eth_dst("00:00:00:00:00:00");
+	rofl::openflow::cofflowmodtemplate tmpl(rofl::openflow13::OFP_VERSION, flowmod13(0, 0, eth_dst, 0, 0));
+
+	unsigned int cookie = tmpl.add_field(rofl::openflow::cofflowmodtemplate::FIELD_COOKIE);
+	unsigned int priority = tmpl.add_field(rofl::openflow::cofflowmodtemplate::FIELD_PRIORITY);
+	unsigned int dst = tmpl.add_field_oxm(rofl::openflow::OXM_TLV_BASIC_ETH_DST);
+	unsigned int vid = tmpl.add_field_oxm(rofl::openflow::OXM_TLV_BASIC_VLAN_VID);
+	unsigned int port_no = tmpl.add_field_output(0);
+
+	CPPUNIT_ASSERT(tmpl.get_field_width(dst) == 6);
+	CPPUNIT_ASSERT(tmpl.get_field_width(vid) == 2);
+	CPPUNIT_ASSERT(tmpl.get_field_width(port_no) == 4);
+
+	rofl::openflow::cofflowmodtemplate copy(tmpl);
+
+	for (uint32_t i = 1; i < 16; i++) {
+		rofl::cmacaddr mac("b1:b2:b3:b4:b5:00");
+		mac[5] = i;
+		tmpl.set_field(cookie, 0xd1d2d3d4d5d6d700ULL + i);
+		tmpl.set_field(priority, 0x4000 + i);
+		tmpl.set_field(dst, mac.somem(), mac.memlen());
+		tmpl.set_field(vid, rofl::openflow13::OFPVID_PRESENT | i);
+		tmpl.set_field(port_no, 0x10000 + i);
+		check(tmpl.create_message(0x100 + i), rofl::openflow13::OFP_VERSION, 0x100 + i,
+				flowmod13(0xd1d2d3d4d5d6d700ULL + i, 0x4000 + i, mac, rofl::openflow13::OFPVID_PRESENT | i, 0x10000 + i));
+	}
+
+	// 64-bit form of set_field() for a MAC address
+	copy.set_field(dst, rofl::cmacaddr("c1:c2:c3:c4:c5:c6").get_mac());
+	check(copy.create_message(7), rofl::openflow13::OFP_VERSION, 7,
+			flowmod13(0, 0, rofl::cmacaddr("c1:c2:c3:c4:c5:c6"), 0, 0));
+}
+
+
+
+void
+cofflowmodtemplate_test::testNotFound()
+{
+	rofl::openflow::cofflowmodtemplate tmpl(rofl::openflow13::OFP_VERSION,
+			flowmod13(0, 0, rofl::cmacaddr("00:00:00:00:00:00"), 0, 0));
+
+	try {
+		tmpl.add_field_oxm(rofl::openflow::OXM_TLV_BASIC_IPV4_DST);
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::openflow::eFlowModTemplateNotFound& e) {}
+
+	try {
+		tmpl.add_field_output(1);
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::openflow::eFlowModTemplateNotFound& e) {}
+
+	try {
+		tmpl.set_field(0, 1);
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::openflow::eFlowModTemplateInval& e) {}
+
+	unsigned int dst = tmpl.add_field_oxm(rofl::openflow::OXM_TLV_BASIC_ETH_DST);
+	uint8_t buf[4];
+	try {
+		tmpl.set_field(dst, buf, sizeof(buf));
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::openflow::eFlowModTemplateInval& e) {}
+
+	try {
+		rofl::openflow::cofflowmodtemplate(rofl::openflow::OFP_VERSION_UNKNOWN,
+				rofl::openflow::cofflowmod());
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eBadVersion& e) {}
+}
@@ -0,0 +1,40 @@
+/*
+ * cofflowmodtemplate_test.h
+ */
+
+#include "rofl/common/openflow/cofflowmodtemplate.h"
+#include "rofl/common/cmemory.h"
+#include "rofl/common/caddress.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class cofflowmodtemplate_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( cofflowmodtemplate_test );
+	CPPUNIT_TEST( testTemplate10 );
+	CPPUNIT_TEST( testTemplate13 );
+	CPPUNIT_TEST( testNotFound );
+	CPPUNIT_TEST_SUITE_END();
+
+private:
+
+	rofl::openflow::cofflowmod
+	flowmod10(
+			uint64_t cookie, uint16_t priority, uint16_t port_no);
+
+	rofl::openflow::cofflowmod
+	flowmod13(
+			uint64_t cookie, uint16_t priority, const rofl::cmacaddr& eth_dst, uint16_t vid, uint32_t port_no);
+
+	void
+	check(
+			rofl::openflow::cofmsg_flow_mod* msg, uint8_t ofp_version, uint32_t xid, const rofl::openflow::cofflowmod& flowmod);
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testTemplate10();
+	void testTemplate13();
+	void testNotFound();
+};
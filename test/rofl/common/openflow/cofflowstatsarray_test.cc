@@ -272,6 +272,79 @@ cofflowstatsarray_test::testPackUnpack()
 
 
 
+void
+cofflowstatsarray_test::testPackUnpackOF10()
+{
+	rofl::cindex index(0);
+
+	/*
+	 * OpenFlow 1.0 entries carry actions beyond struct ofp_flow_stats,
+	 * unpack() must advance by each entry's length field
+	 */
+	rofl::openflow::cofflowstatsarray array(rofl::openflow10::OFP_VERSION);
+
+	array.set_flow_stats(0).set_version(rofl::openflow10::OFP_VERSION);
+	array.set_flow_stats(0).set_table_id(1);
+	array.set_flow_stats(0).set_packet_count(0xb1b2);
+	array.set_flow_stats(0).set_actions().add_action_output(index++).set_port_no(6);
+	array.set_flow_stats(0).set_actions().add_action_output(index++).set_port_no(7);
+
+	array.set_flow_stats(1).set_version(rofl::openflow10::OFP_VERSION);
+	array.set_flow_stats(1).set_table_id(2);
+	array.set_flow_stats(1).set_packet_count(0xb3b4);
+
+	array.set_flow_stats(2).set_version(rofl::openflow10::OFP_VERSION);
+	array.set_flow_stats(2).set_table_id(3);
+	array.set_flow_stats(2).set_packet_count(0xb5b6);
+	array.set_flow_stats(2).set_actions().add_action_output(index++).set_port_no(8);
+
+	size_t len = 0;
+	for (unsigned int i = 0; i < 3; i++) {
+		len += array.get_flow_stats(i).length();
+	}
+	CPPUNIT_ASSERT(len == array.length());
+	CPPUNIT_ASSERT(len > 3 * sizeof(struct rofl::openflow10::ofp_flow_stats));
+
+	rofl::cmemory marray(array.length());
+	array.pack(marray.somem(), marray.memlen());
+
+	rofl::openflow::cofflowstatsarray clone(rofl::openflow10::OFP_VERSION);
+	clone.unpack(marray.somem(), marray.memlen());
+#ifdef DEBUG
+	std::cerr << "marray:" << std::endl << marray;
+	std::cerr << "clone:" << std::endl << clone;
+#endif
+
+	CPPUNIT_ASSERT(3 == clone.size());
+	CPPUNIT_ASSERT(array.length() == clone.length());
+	CPPUNIT_ASSERT(1 == clone.get_flow_stats(0).get_table_id());
+	CPPUNIT_ASSERT(2 == clone.get_flow_stats(1).get_table_id());
+	CPPUNIT_ASSERT(3 == clone.get_flow_stats(2).get_table_id());
+	CPPUNIT_ASSERT(0xb1b2 == clone.get_flow_stats(0).get_packet_count());
+	CPPUNIT_ASSERT(0xb3b4 == clone.get_flow_stats(1).get_packet_count());
+	CPPUNIT_ASSERT(0xb5b6 == clone.get_flow_stats(2).get_packet_count());
+	CPPUNIT_ASSERT(2 == clone.get_flow_stats(0).get_actions().size());
+	CPPUNIT_ASSERT(0 == clone.get_flow_stats(1).get_actions().size());
+	CPPUNIT_ASSERT(1 == clone.get_flow_stats(2).get_actions().size());
+
+	rofl::cmemory mclone(clone.length());
+	clone.pack(mclone.somem(), mclone.memlen());
+	CPPUNIT_ASSERT(marray == mclone);
+
+	// an entry's length field exceeding the buffer is rejected
+	struct rofl::openflow10::ofp_flow_stats* flow_stats =
+			(struct rofl::openflow10::ofp_flow_stats*)marray.somem();
+	flow_stats->length = htobe16(marray.memlen() + 1);
+	try {
+		clone.unpack(marray.somem(), marray.memlen());
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eInval& e) {
+		// expected
+	}
+}
+
+
+
 void
 cofflowstatsarray_test::testAddDropSetGetHas()
 {
@@ -11,6 +11,7 @@ class cofflowstatsarray_test : public CppUnit::TestFixture {
 	CPPUNIT_TEST( testCopyConstructor );
 	CPPUNIT_TEST( testOperatorPlus );
 	CPPUNIT_TEST( testPackUnpack );
+	CPPUNIT_TEST( testPackUnpackOF10 );
 	CPPUNIT_TEST( testAddDropSetGetHas );
 	CPPUNIT_TEST_SUITE_END();
 
@@ -25,6 +26,7 @@ public:
 	void testCopyConstructor();
 	void testOperatorPlus();
 	void testPackUnpack();
+	void testPackUnpackOF10();
 	void testAddDropSetGetHas();
 };
 
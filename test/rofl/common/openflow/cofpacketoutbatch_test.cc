@@ -0,0 +1,178 @@
+/*
+ * cofpacketoutbatch_test.cc
+ */
+
+#include <stdlib.h>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "cofpacketoutbatch_test.h"
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION( cofpacketoutbatch_test );
+
+#if defined DEBUG
+#undef DEBUG
+#endif
+
+void
+cofpacketoutbatch_test::setUp()
+{
+}
+
+
+
+void
+cofpacketoutbatch_test::tearDown()
+{
+}
+
+
+
+void
+cofpacketoutbatch_test::check(
+		uint8_t ofp_version)
+{
+	rofl::openflow::cofactions actions(ofp_version);
+	actions.add_action_output(rofl::cindex(0)).set_port_no(3);
+	actions.add_action_output(rofl::cindex(1)).set_port_no(4);
+
+	rofl::openflow::cofpacketoutbatch batch(ofp_version, actions, 64);
+
+	// expected: individually packed Packet-Outs, back-to-back
+	rofl::cmemory expected((size_t)0);
+	const unsigned int num = 16;
+	uint32_t xid = 0x1000;
+
+	for (unsigned int i = 0; i < num; i++) {
+		rofl::cmemory payload(60 + i);
+		for (unsigned int j = 0; j < payload.memlen(); j++) {
+			payload[j] = (uint8_t)(i + j);
+		}
+		batch.add_packet_out(i + 1, payload.somem(), payload.memlen());
+
+		rofl::openflow::cofmsg_packet_out msg(ofp_version, xid + i,
+				rofl::openflow13::OFP_NO_BUFFER, i + 1, actions, payload.somem(), payload.memlen());
+		rofl::cmemory packed(msg.length());
+		msg.pack(packed.somem(), packed.memlen());
+		expected += packed;
+	}
+
+	CPPUNIT_ASSERT(num == batch.get_num_messages());
+	CPPUNIT_ASSERT(expected.memlen() == batch.length());
+	CPPUNIT_ASSERT(batch.capacity() >= batch.length());
+
+	rofl::openflow::cofmsg_packet_out_batch* msg = batch.create_message(xid);
+
+	CPPUNIT_ASSERT(num == msg->get_num_messages());
+	CPPUNIT_ASSERT(expected.memlen() == msg->length());
+	CPPUNIT_ASSERT(ofp_version == msg->get_version());
+	CPPUNIT_ASSERT(rofl::openflow13::OFPT_PACKET_OUT == msg->get_type());
+	CPPUNIT_ASSERT(xid == msg->get_xid());
+
+	rofl::cmemory packed(msg->length());
+	msg->pack(packed.somem(), packed.memlen());
+	CPPUNIT_ASSERT(packed == expected);
+
+	// each message must be parsable on its own
+	size_t offset = 0;
+	for (unsigned int i = 0; i < num; i++) {
+		rofl::openflow::cofmsg_packet_out po(
+				new rofl::cmemory(packed.somem() + offset, be16toh(*(uint16_t*)(packed.somem() + offset + 2))));
+		po.validate();
+		CPPUNIT_ASSERT(i + 1 == po.get_in_port());
+		CPPUNIT_ASSERT(xid + i == po.get_xid());
+		CPPUNIT_ASSERT(60 + i == po.get_packet().length());
+		CPPUNIT_ASSERT(2 == po.get_actions().get_actions().size());
+		offset += po.get_length();
+	}
+	CPPUNIT_ASSERT(offset == packed.memlen());
+
+	delete msg;
+}
+
+
+
+void
+cofpacketoutbatch_test::testBatch10()
+{
+	check(rofl::openflow10::OFP_VERSION);
+}
+
+
+
+void
+cofpacketoutbatch_test::testBatch13()
+{
+	check(rofl::openflow12::OFP_VERSION);
+	check(rofl::openflow13::OFP_VERSION);
+}
+
+
+
+void
+cofpacketoutbatch_test::testReuse()
+{
+	rofl::openflow::cofactions actions(rofl::openflow13::OFP_VERSION);
+	actions.add_action_output(rofl::cindex(0)).set_port_no(rofl::openflow13::OFPP_FLOOD);
+
+	rofl::openflow::cofpacketoutbatch batch(rofl::openflow13::OFP_VERSION, actions, 0);
+	rofl::cmemory payload(128);
+
+	for (unsigned int i = 0; i < 64; i++) {
+		batch.add_packet_out(rofl::openflow13::OFPP_CONTROLLER, payload.somem(), payload.memlen());
+	}
+	size_t capacity = batch.capacity();
+	size_t length = batch.length();
+	CPPUNIT_ASSERT(64 * (24 + 16 + 128) == length);
+
+	batch.clear();
+	CPPUNIT_ASSERT(batch.empty());
+	CPPUNIT_ASSERT(0 == batch.length());
+	CPPUNIT_ASSERT(capacity == batch.capacity());
+
+	for (unsigned int i = 0; i < 64; i++) {
+		batch.add_packet_out(rofl::openflow13::OFPP_CONTROLLER, payload.somem(), payload.memlen());
+	}
+	CPPUNIT_ASSERT(capacity == batch.capacity());
+	CPPUNIT_ASSERT(length == batch.length());
+
+	// actions replaced for subsequent Packet-Outs only
+	rofl::openflow::cofactions none(rofl::openflow13::OFP_VERSION);
+	batch.set_actions(none);
+	batch.add_packet_out(rofl::openflow13::OFPP_CONTROLLER, payload.somem(), payload.memlen());
+	CPPUNIT_ASSERT(length + 24 + 128 == batch.length());
+}
+
+
+
+void
+cofpacketoutbatch_test::testInval()
+{
+	rofl::openflow::cofactions actions(rofl::openflow13::OFP_VERSION);
+	rofl::openflow::cofpacketoutbatch batch(rofl::openflow13::OFP_VERSION, actions);
+
+	try {
+		batch.create_message(1);
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::openflow::ePacketOutBatchInval& e) {}
+
+	rofl::cmemory payload(0x10000);
+	try {
+		batch.add_packet_out(1, payload.somem(), payload.memlen());
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::openflow::ePacketOutBatchInval& e) {}
+	CPPUNIT_ASSERT(batch.empty());
+
+	rofl::openflow::cofactions actions10(rofl::openflow10::OFP_VERSION);
+	try {
+		batch.set_actions(actions10);
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eBadVersion& e) {}
+
+	try {
+		rofl::openflow::cofpacketoutbatch batch2(0x7f, actions);
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eBadVersion& e) {}
+}
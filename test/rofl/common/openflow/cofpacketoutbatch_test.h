@@ -0,0 +1,33 @@
+/*
+ * cofpacketoutbatch_test.h
+ */
+
+#include "rofl/common/openflow/cofpacketoutbatch.h"
+#include "rofl/common/cmemory.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class cofpacketoutbatch_test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( cofpacketoutbatch_test );
+	CPPUNIT_TEST( testBatch10 );
+	CPPUNIT_TEST( testBatch13 );
+	CPPUNIT_TEST( testReuse );
+	CPPUNIT_TEST( testInval );
+	CPPUNIT_TEST_SUITE_END();
+
+private:
+
+	void
+	check(
+			uint8_t ofp_version);
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testBatch10();
+	void testBatch13();
+	void testReuse();
+	void testInval();
+};
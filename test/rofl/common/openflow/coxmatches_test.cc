@@ -437,7 +437,90 @@ coxmatches_test::testStrictMatching()
 void
 coxmatches_test::testNonStrictMatching()
 {
-	// TODO
+	uint16_t exact_hits = 0, wildcard_hits = 0, missed = 0;
+
+	rofl::openflow::coxmatches flow;
+	flow.add_match(rofl::openflow::coxmatch_ofb_in_port(1));
+	flow.add_match(rofl::openflow::coxmatch_ofb_eth_type(0x0800));
+	flow.add_match(rofl::openflow::coxmatch_ofb_ip_proto(6));
+	flow.add_match(rofl::openflow::coxmatch_ofb_tcp_dst(80));
+
+	rofl::openflow::coxmatches pattern;
+	pattern.add_match(rofl::openflow::coxmatch_ofb_eth_type(0x0800));
+	pattern.add_match(rofl::openflow::coxmatch_ofb_tcp_dst(80));
+
+	// all TLVs of pattern exist in flow with identical values
+	CPPUNIT_ASSERT(pattern.contains(flow, false));
+	CPPUNIT_ASSERT(not pattern.contains(flow, true));
+	CPPUNIT_ASSERT(not flow.contains(pattern, false));
+	CPPUNIT_ASSERT(flow.contains(flow, true));
+
+	// pattern wildcards in_port and ip_proto
+	CPPUNIT_ASSERT(pattern.is_part_of(flow, exact_hits, wildcard_hits, missed));
+	CPPUNIT_ASSERT(2 == exact_hits);
+	CPPUNIT_ASSERT(2 == wildcard_hits);
+	CPPUNIT_ASSERT(0 == missed);
+
+	pattern.add_match(rofl::openflow::coxmatch_ofb_tcp_dst(443));
+	CPPUNIT_ASSERT(not pattern.contains(flow, false));
+
+	exact_hits = wildcard_hits = missed = 0;
+	CPPUNIT_ASSERT(not pattern.is_part_of(flow, exact_hits, wildcard_hits, missed));
+	CPPUNIT_ASSERT(1 == exact_hits);
+	CPPUNIT_ASSERT(2 == wildcard_hits);
+	CPPUNIT_ASSERT(1 == missed);
+
+	// TLV beyond the last one in flow
+	pattern.drop_match(rofl::openflow::OXM_TLV_BASIC_TCP_DST);
+	pattern.add_match(rofl::openflow::coxmatch_ofb_ipv6_exthdr(1));
+	CPPUNIT_ASSERT(not pattern.contains(flow, false));
+}
+
+
+
+void
+coxmatches_test::testSortedOrder()
+{
+	// TLVs in descending order on the wire
+	rofl::openflow::coxmatches in;
+	rofl::openflow::coxmatch_ofb_tcp_dst tcp_dst(80);
+	rofl::openflow::coxmatch_ofb_ip_proto ip_proto(6);
+	rofl::openflow::coxmatch_ofb_in_port in_port(3);
+
+	rofl::cmemory mem(tcp_dst.length() + ip_proto.length() + in_port.length());
+	tcp_dst.pack(mem.somem(), tcp_dst.length());
+	ip_proto.pack(mem.somem() + tcp_dst.length(), ip_proto.length());
+	in_port.pack(mem.somem() + tcp_dst.length() + ip_proto.length(), in_port.length());
+
+	in.unpack(mem.somem(), mem.memlen());
+	CPPUNIT_ASSERT(3 == in.get_matches().size());
+	CPPUNIT_ASSERT(mem.memlen() == in.length());
+
+	uint32_t last = 0;
+	for (rofl::openflow::coxmatches::oxm_map_t::const_iterator
+			it = in.get_matches().begin(); it != in.get_matches().end(); ++it) {
+		CPPUNIT_ASSERT(it->first > last);
+		CPPUNIT_ASSERT(it->first == (it->second.get_oxm_id() & 0xfffffe00));
+		last = it->first;
+	}
+
+	// packed in ascending order of oxm-id
+	rofl::cmemory out(in.length());
+	in.pack(out.somem(), out.memlen());
+	CPPUNIT_ASSERT(0 == memcmp(out.somem(), in_port.somem(), in_port.length()));
+	CPPUNIT_ASSERT(0 == memcmp(out.somem() + in_port.length() + ip_proto.length(), tcp_dst.somem(), tcp_dst.length()));
+
+	// replacing a TLV keeps a single entry
+	in.add_match(rofl::openflow::coxmatch_ofb_ip_proto(17));
+	CPPUNIT_ASSERT(3 == in.get_matches().size());
+	CPPUNIT_ASSERT(17 == in.get_match(rofl::openflow::OXM_TLV_BASIC_IP_PROTO).get_u8value());
+
+	rofl::openflow::coxmatches copy(in);
+	CPPUNIT_ASSERT(copy == in);
+	copy.drop_match(rofl::openflow::OXM_TLV_BASIC_IN_PORT);
+	CPPUNIT_ASSERT(not (copy == in));
+	copy.add_match(rofl::openflow::coxmatch_ofb_in_port(4));
+	CPPUNIT_ASSERT(not (copy == in));
 }
 
 
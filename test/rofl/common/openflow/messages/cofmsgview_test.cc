@@ -0,0 +1,215 @@
+/*
+ * cofmsgview_test.cc
+ */
+
+#include <stdlib.h>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "cofmsgview_test.h"
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION( cofmsgviewTest );
+
+#if defined DEBUG
+#undef DEBUG
+#endif
+
+void
+cofmsgviewTest::setUp()
+{
+}
+
+
+
+void
+cofmsgviewTest::tearDown()
+{
+}
+
+
+
+void
+cofmsgviewTest::testPacketInOF10()
+{
+	rofl::cmemory data(64);
+	for (unsigned int i = 0; i < data.memlen(); i++) {
+		data[i] = i;
+	}
+
+	rofl::openflow::cofmsg_packet_in msg(
+			rofl::openflow10::OFP_VERSION, 0xa1a2a3a4, 0xb1b2b3b4, 64, rofl::openflow10::OFPR_ACTION,
+			0, 0, 5, rofl::openflow::cofmatch(), data.somem(), data.memlen());
+
+	rofl::cmemory packed(msg.length());
+	msg.pack(packed.somem(), packed.memlen());
+
+	rofl::openflow::cofmsg_view view(packed.somem(), packed.memlen());
+
+	std::cerr << "view:" << std::endl << view;
+
+	CPPUNIT_ASSERT(view.is_packet_in());
+	CPPUNIT_ASSERT(view.get_version() == rofl::openflow10::OFP_VERSION);
+	CPPUNIT_ASSERT(view.get_type() == rofl::openflow10::OFPT_PACKET_IN);
+	CPPUNIT_ASSERT(view.get_xid() == 0xa1a2a3a4);
+	CPPUNIT_ASSERT(view.get_buffer_id() == 0xb1b2b3b4);
+	CPPUNIT_ASSERT(view.get_total_len() == 64);
+	CPPUNIT_ASSERT(view.get_in_port() == 5);
+	CPPUNIT_ASSERT(view.get_match_tlvs() == NULL);
+	CPPUNIT_ASSERT(view.get_payload_len() == data.memlen());
+	CPPUNIT_ASSERT(0 == memcmp(view.get_payload(), data.somem(), data.memlen()));
+}
+
+
+
+void
+cofmsgviewTest::testPacketInOF13()
+{
+	rofl::cmemory data(60);
+	for (unsigned int i = 0; i < data.memlen(); i++) {
+		data[i] = 0xff - i;
+	}
+
+	rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION);
+	match.set_in_port(7);
+	match.set_eth_type(0x0800);
+
+	rofl::openflow::cofmsg_packet_in msg(
+			rofl::openflow13::OFP_VERSION, 0x11223344, rofl::openflow13::OFP_NO_BUFFER, 60, rofl::openflow13::OFPR_NO_MATCH,
+			3, 0x0102030405060708ULL, 0, match, data.somem(), data.memlen());
+
+	rofl::cmemory packed(msg.length());
+	msg.pack(packed.somem(), packed.memlen());
+
+	rofl::openflow::cofmsg_view view(packed.somem(), packed.memlen());
+
+	std::cerr << "view:" << std::endl << view;
+
+	CPPUNIT_ASSERT(view.is_packet_in());
+	CPPUNIT_ASSERT(view.get_xid() == 0x11223344);
+	CPPUNIT_ASSERT(view.get_buffer_id() == rofl::openflow13::OFP_NO_BUFFER);
+	CPPUNIT_ASSERT(view.get_total_len() == 60);
+	CPPUNIT_ASSERT(view.get_reason() == rofl::openflow13::OFPR_NO_MATCH);
+	CPPUNIT_ASSERT(view.get_table_id() == 3);
+	CPPUNIT_ASSERT(view.get_cookie() == 0x0102030405060708ULL);
+	CPPUNIT_ASSERT(view.get_in_port() == 7);
+	CPPUNIT_ASSERT(view.get_match_tlvs_len() == 8 + 6);
+	CPPUNIT_ASSERT(view.find_match_tlv(rofl::openflow::OXM_TLV_BASIC_ETH_TYPE) != NULL);
+	CPPUNIT_ASSERT(view.find_match_tlv(rofl::openflow::OXM_TLV_BASIC_VLAN_VID) == NULL);
+	CPPUNIT_ASSERT(view.get_payload_len() == data.memlen());
+	CPPUNIT_ASSERT(0 == memcmp(view.get_payload(), data.somem(), data.memlen()));
+}
+
+
+
+void
+cofmsgviewTest::testMaterialize()
+{
+	rofl::cmemory data(32);
+	rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION);
+	match.set_in_port(11);
+
+	rofl::openflow::cofmsg_packet_in msg(
+			rofl::openflow13::OFP_VERSION, 0x55, 0x66, 32, rofl::openflow13::OFPR_ACTION,
+			1, 0x77, 0, match, data.somem(), data.memlen());
+
+	rofl::cmemory packed(msg.length());
+	msg.pack(packed.somem(), packed.memlen());
+
+	rofl::openflow::cofmsg_view view(packed.somem(), packed.memlen());
+
+	rofl::openflow::cofmsg* full = rofl::crofsock::materialize(view);
+
+	rofl::openflow::cofmsg_packet_in* packet_in = dynamic_cast<rofl::openflow::cofmsg_packet_in*>( full );
+
+	CPPUNIT_ASSERT(NULL != packet_in);
+	CPPUNIT_ASSERT(packet_in->get_xid() == view.get_xid());
+	CPPUNIT_ASSERT(packet_in->get_buffer_id() == view.get_buffer_id());
+	CPPUNIT_ASSERT(packet_in->get_match().get_in_port() == view.get_in_port());
+	CPPUNIT_ASSERT(packet_in->get_packet().length() == view.get_payload_len());
+
+	delete full;
+}
+
+
+
+void
+cofmsgviewTest::testTooShort()
+{
+	rofl::cmemory data(16);
+	rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION);
+	match.set_in_port(1);
+
+	rofl::openflow::cofmsg_packet_in msg(
+			rofl::openflow13::OFP_VERSION, 0x01, 0x02, 16, rofl::openflow13::OFPR_ACTION,
+			0, 0, 0, match, data.somem(), data.memlen());
+
+	rofl::cmemory packed(msg.length());
+	msg.pack(packed.somem(), packed.memlen());
+
+	// length field in header does not match buffer length
+	try {
+		rofl::openflow::cofmsg_view view(packed.somem(), packed.memlen() - 1);
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eBadSyntaxTooShort& e) {}
+
+	// match length exceeds message
+	struct rofl::openflow13::ofp_packet_in* hdr = (struct rofl::openflow13::ofp_packet_in*)packed.somem();
+	hdr->match.length = htobe16(packed.memlen());
+	try {
+		rofl::openflow::cofmsg_view view(packed.somem(), packed.memlen());
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eBadSyntaxTooShort& e) {}
+
+	// non Packet-In messages offer header accessors only
+	rofl::openflow::cofmsg_echo_request echo(rofl::openflow13::OFP_VERSION, 0x99);
+	rofl::cmemory echomem(echo.length());
+	echo.pack(echomem.somem(), echomem.memlen());
+
+	rofl::openflow::cofmsg_view view(echomem.somem(), echomem.memlen());
+	CPPUNIT_ASSERT(not view.is_packet_in());
+	CPPUNIT_ASSERT(view.get_xid() == 0x99);
+	try {
+		view.get_buffer_id();
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eBadRequestBadType& e) {}
+}
+
+
+
+
+
+void
+cofmsgviewTest::testMatchTlvs()
+{
+	rofl::cmemory data(16);
+	rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION);
+	match.set_in_port(3);
+	match.set_eth_dst(rofl::cmacaddr("01:02:03:04:05:06"), rofl::cmacaddr("ff:ff:ff:00:00:00"));
+
+	rofl::openflow::cofmsg_packet_in msg(
+			rofl::openflow13::OFP_VERSION, 0x01, 0x02, 16, rofl::openflow13::OFPR_ACTION,
+			0, 0, 0, match, data.somem(), data.memlen());
+
+	rofl::cmemory packed(msg.length());
+	msg.pack(packed.somem(), packed.memlen());
+
+	// masked variants are found by their unmasked OXM id as well
+	rofl::openflow::cofmsg_view view(packed.somem(), packed.memlen());
+	uint8_t const* tlv = view.find_match_tlv(rofl::openflow::OXM_TLV_BASIC_ETH_DST);
+	CPPUNIT_ASSERT(NULL != tlv);
+	CPPUNIT_ASSERT(tlv[2] & 0x01);
+	CPPUNIT_ASSERT(tlv[3] == 12);
+	CPPUNIT_ASSERT(view.find_match_tlv(rofl::openflow::OXM_TLV_BASIC_ETH_DST_MASK) == tlv);
+	CPPUNIT_ASSERT(view.get_in_port() == 3);
+
+	// in_port TLV too short for a port number
+	tlv = view.find_match_tlv(rofl::openflow::OXM_TLV_BASIC_IN_PORT);
+	CPPUNIT_ASSERT(NULL != tlv);
+	packed[tlv - packed.somem() + 3] = 2;
+	try {
+		view.get_in_port();
+		CPPUNIT_ASSERT(false);
+	} catch (rofl::eBadSyntax& e) {}
+}
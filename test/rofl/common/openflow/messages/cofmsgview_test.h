@@ -0,0 +1,30 @@
+#include "rofl/common/openflow/messages/cofmsg_view.h"
+#include "rofl/common/openflow/messages/cofmsg_packet_in.h"
+#include "rofl/common/crofsock.h"
+#include "rofl/common/cmemory.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class cofmsgviewTest : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( cofmsgviewTest );
+	CPPUNIT_TEST( testPacketInOF10 );
+	CPPUNIT_TEST( testPacketInOF13 );
+	CPPUNIT_TEST( testMaterialize );
+	CPPUNIT_TEST( testTooShort );
+	CPPUNIT_TEST( testMatchTlvs );
+	CPPUNIT_TEST_SUITE_END();
+
+private:
+
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testPacketInOF10();
+	void testPacketInOF13();
+	void testMaterialize();
+	void testTooShort();
+	void testMatchTlvs();
+};
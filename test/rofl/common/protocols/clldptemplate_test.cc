@@ -0,0 +1,163 @@
+/*
+ * clldptemplate_test.cc
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "clldptemplate_test.h"
+
+using namespace rofl::protocol::lldp;
+
+CPPUNIT_TEST_SUITE_REGISTRATION( clldptemplateTest );
+
+#if defined DEBUG
+//#undef DEBUG
+#endif
+
+namespace {
+
+const uint8_t chassis_id[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x34 };
+const uint8_t port_id[] = { 'e', 't', 'h', '1' };
+
+rofl::cmemory
+pack_clldpmsg(const uint8_t* pid, size_t pidlen, uint16_t ttl)
+{
+	clldpmsg msg;
+	msg.set_eth_src() = rofl::cmacaddr("00:01:02:03:04:05");
+	msg.set_attrs().add_chassis_id().set_sub_type() = LLDPCHIDST_LOCAL;
+	msg.set_attrs().set_chassis_id().set_body() = rofl::cmemory((uint8_t*)chassis_id, sizeof(chassis_id));
+	msg.set_attrs().add_port_id().set_sub_type() = LLDPPRTIDST_IFNAME;
+	msg.set_attrs().set_port_id().set_body() = rofl::cmemory((uint8_t*)pid, pidlen);
+	msg.set_attrs().add_ttl().set_ttl() = ttl;
+	msg.set_attrs().add_end();
+	rofl::cmemory mem(msg.length());
+	msg.pack(mem.somem(), mem.memlen());
+	return mem;
+}
+
+};
+
+
+
+void
+clldptemplateTest::setUp()
+{
+}
+
+
+
+void
+clldptemplateTest::tearDown()
+{
+}
+
+
+
+void
+clldptemplateTest::testTemplate()
+{
+	clldptemplate tmpl(rofl::cmacaddr("00:01:02:03:04:05"),
+			LLDPCHIDST_LOCAL, chassis_id, sizeof(chassis_id),
+			LLDPPRTIDST_IFNAME, port_id, sizeof(port_id),
+			120, rofl::cmacaddr("01:80:c2:00:00:00"));
+
+	// identical to a frame packed by clldpmsg
+	rofl::cmemory expected = pack_clldpmsg(port_id, sizeof(port_id), 120);
+	CPPUNIT_ASSERT(expected.memlen() == tmpl.length());
+	CPPUNIT_ASSERT(0 == memcmp(expected.somem(), tmpl.somem(), tmpl.length()));
+	CPPUNIT_ASSERT(120 == tmpl.get_ttl());
+
+	try {
+		clldptemplate inval(rofl::cmacaddr("00:01:02:03:04:05"),
+				LLDPCHIDST_LOCAL, chassis_id, 0, LLDPPRTIDST_IFNAME, port_id, sizeof(port_id));
+		CPPUNIT_ASSERT(false);
+	} catch (eLLDPTemplateInval& e) {}
+}
+
+
+
+void
+clldptemplateTest::testPatch()
+{
+	clldptemplate tmpl(rofl::cmacaddr("00:0a:0b:0c:0d:0e"),
+			LLDPCHIDST_LOCAL, chassis_id, sizeof(chassis_id),
+			LLDPPRTIDST_IFNAME, port_id, sizeof(port_id),
+			120, rofl::cmacaddr("01:80:c2:00:00:00"));
+
+	tmpl.set_ttl(0);
+	tmpl.set_eth_src(rofl::cmacaddr("00:01:02:03:04:05"));
+	rofl::cmemory expected = pack_clldpmsg(port_id, sizeof(port_id), 0);
+	CPPUNIT_ASSERT(0 == memcmp(expected.somem(), tmpl.somem(), tmpl.length()));
+
+	// port ID of different length moves TTL and End TLVs
+	const uint8_t long_port_id[] = { 'p', 'o', 'r', 't', '-', '4', '8' };
+	tmpl.set_port_id(LLDPPRTIDST_IFNAME, long_port_id, sizeof(long_port_id));
+	expected = pack_clldpmsg(long_port_id, sizeof(long_port_id), 0);
+	CPPUNIT_ASSERT(expected.memlen() == tmpl.length());
+	CPPUNIT_ASSERT(0 == memcmp(expected.somem(), tmpl.somem(), tmpl.length()));
+
+	tmpl.set_port_id(LLDPPRTIDST_IFNAME, port_id, sizeof(port_id));
+	tmpl.set_ttl(120);
+	expected = pack_clldpmsg(port_id, sizeof(port_id), 120);
+	CPPUNIT_ASSERT(expected.memlen() == tmpl.length());
+	CPPUNIT_ASSERT(0 == memcmp(expected.somem(), tmpl.somem(), tmpl.length()));
+}
+
+
+
+void
+clldptemplateTest::testDecode()
+{
+	rofl::cmemory mem = pack_clldpmsg(port_id, sizeof(port_id), 0x1234);
+
+	clldpinfo info;
+	CPPUNIT_ASSERT(clldpdecoder::decode(mem.somem(), mem.memlen(), info));
+	CPPUNIT_ASSERT(0 == memcmp(info.eth_src, mem.somem() + 6, 6));
+	CPPUNIT_ASSERT(LLDPCHIDST_LOCAL == info.chassis_id_subtype);
+	CPPUNIT_ASSERT(sizeof(chassis_id) == info.chassis_id_len);
+	CPPUNIT_ASSERT(0 == memcmp(info.chassis_id, chassis_id, sizeof(chassis_id)));
+	CPPUNIT_ASSERT(LLDPPRTIDST_IFNAME == info.port_id_subtype);
+	CPPUNIT_ASSERT(sizeof(port_id) == info.port_id_len);
+	CPPUNIT_ASSERT(0 == memcmp(info.port_id, port_id, sizeof(port_id)));
+	CPPUNIT_ASSERT(0x1234 == info.ttl);
+
+	// VLAN tagged frame within a cpacket
+	rofl::cpacket pkt(mem.memlen() + 4);
+	memcpy(pkt.soframe(), mem.somem(), 12);
+	pkt.soframe()[12] = 0x81; pkt.soframe()[13] = 0x00;
+	pkt.soframe()[14] = 0x00; pkt.soframe()[15] = 0x0a;
+	memcpy(pkt.soframe() + 16, mem.somem() + 12, mem.memlen() - 12);
+	CPPUNIT_ASSERT(clldpdecoder::decode(pkt, info));
+	CPPUNIT_ASSERT(0x1234 == info.ttl);
+	CPPUNIT_ASSERT(0 == memcmp(info.port_id, port_id, sizeof(port_id)));
+}
+
+
+
+void
+clldptemplateTest::testDecodeInval()
+{
+	rofl::cmemory mem = pack_clldpmsg(port_id, sizeof(port_id), 120);
+	clldpinfo info;
+
+	// every truncation must be rejected without reading beyond the buffer
+	for (size_t len = 0; len < mem.memlen() - 2; len++) {
+		rofl::cmemory trunc(mem.somem(), len);
+		CPPUNIT_ASSERT(not clldpdecoder::decode(trunc.somem(), trunc.memlen(), info));
+	}
+	CPPUNIT_ASSERT(not clldpdecoder::decode(NULL, 0, info));
+
+	// wrong ethertype
+	rofl::cmemory other(mem);
+	other[12] = 0x08; other[13] = 0x00;
+	CPPUNIT_ASSERT(not clldpdecoder::decode(other.somem(), other.memlen(), info));
+
+	// TLV length exceeding frame
+	rofl::cmemory inval(mem);
+	inval[15] = 0xff;
+	CPPUNIT_ASSERT(not clldpdecoder::decode(inval.somem(), inval.memlen(), info));
+}
@@ -0,0 +1,33 @@
+/*
+ * clldptemplate_test.h
+ */
+
+#include "rofl/common/protocols/clldptemplate.h"
+#include "rofl/common/protocols/clldpdecoder.h"
+#include "rofl/common/protocols/clldpmsg.h"
+#include "rofl/common/cmemory.h"
+#include "rofl/common/caddress.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class clldptemplateTest : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( clldptemplateTest );
+	CPPUNIT_TEST( testTemplate );
+	CPPUNIT_TEST( testPatch );
+	CPPUNIT_TEST( testDecode );
+	CPPUNIT_TEST( testDecodeInval );
+	CPPUNIT_TEST_SUITE_END();
+
+private:
+
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testTemplate();
+	void testPatch();
+	void testDecode();
+	void testDecodeInval();
+};
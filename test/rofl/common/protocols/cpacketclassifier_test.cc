@@ -0,0 +1,309 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include "cpacketclassifier_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( cpacketclassifierTest );
+
+#if defined DEBUG
+//#undef DEBUG
+#endif
+
+namespace {
+
+// dst 00:11:22:33:44:55, src 00:aa:bb:cc:dd:ee
+const uint8_t eth_hdr[12] = {
+		0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x00, 0xaa, 0xbb, 0xcc, 0xdd, 0xee };
+
+// VLAN 100 pcp 5, IPv4 10.0.0.1 -> 10.0.0.2 dscp 46, TCP 1234 -> 80
+const uint8_t vlan_ipv4_tcp[] = {
+		0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x00, 0xaa, 0xbb, 0xcc, 0xdd, 0xee,
+		0x81, 0x00, 0xa0, 0x64, 0x08, 0x00,
+		0x45, 0xb8, 0x00, 0x28, 0x00, 0x00, 0x40, 0x00, 0x40, 0x06, 0x00, 0x00,
+		0x0a, 0x00, 0x00, 0x01, 0x0a, 0x00, 0x00, 0x02,
+		0x04, 0xd2, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x50, 0x02, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+		// Ethernet padding
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+};
+
+
+
+void
+cpacketclassifierTest::setUp()
+{
+}
+
+
+
+void
+cpacketclassifierTest::tearDown()
+{
+}
+
+
+
+void
+cpacketclassifierTest::testVlanIPv4Tcp()
+{
+	rofl::cpacketinfo info;
+
+	CPPUNIT_ASSERT(rofl::cpacketclassifier::classify(vlan_ipv4_tcp, sizeof(vlan_ipv4_tcp), info));
+
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_VLAN));
+	CPPUNIT_ASSERT(not info.has(rofl::cpacketinfo::HAS_QINQ));
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_IPV4));
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_TCP));
+	CPPUNIT_ASSERT(not info.has(rofl::cpacketinfo::HAS_FRAGMENT));
+	CPPUNIT_ASSERT(not info.has(rofl::cpacketinfo::IS_TRUNCATED));
+
+	CPPUNIT_ASSERT(0 == memcmp(info.eth_dst, eth_hdr, 6));
+	CPPUNIT_ASSERT(0 == memcmp(info.eth_src, eth_hdr + 6, 6));
+	CPPUNIT_ASSERT(0x0800 == info.eth_type);
+	CPPUNIT_ASSERT(1 == info.num_vlans);
+	CPPUNIT_ASSERT(100 == info.vlan_vid[0]);
+	CPPUNIT_ASSERT(5 == info.vlan_pcp[0]);
+
+	CPPUNIT_ASSERT(18 == info.l3_offset);
+	CPPUNIT_ASSERT(38 == info.l4_offset);
+	CPPUNIT_ASSERT(58 == info.payload_offset);
+	CPPUNIT_ASSERT(rofl::cpacketinfo::OFFSET_NONE == info.tunnel_offset);
+
+	CPPUNIT_ASSERT(6 == info.ip_proto);
+	CPPUNIT_ASSERT(46 == info.ip_dscp);
+	CPPUNIT_ASSERT(0 == info.ip_ecn);
+	CPPUNIT_ASSERT(64 == info.ip_ttl);
+	CPPUNIT_ASSERT(0 == memcmp(info.ipv4_dst, vlan_ipv4_tcp + 34, 4));
+	CPPUNIT_ASSERT(1234 == info.tp_src);
+	CPPUNIT_ASSERT(80 == info.tp_dst);
+
+	// the same frame held by a cpacket
+	rofl::cpacket pkt(sizeof(vlan_ipv4_tcp));
+	memcpy(pkt.soframe(), vlan_ipv4_tcp, sizeof(vlan_ipv4_tcp));
+	rofl::cpacketinfo info2;
+	CPPUNIT_ASSERT(rofl::cpacketclassifier::classify(pkt, info2));
+	CPPUNIT_ASSERT(0 == memcmp(&info, &info2, sizeof(info)));
+
+	// non-first fragment: no upper layer
+	rofl::cmemory frag((uint8_t*)vlan_ipv4_tcp, sizeof(vlan_ipv4_tcp));
+	frag[24] = 0x00; frag[25] = 0x10;
+	rofl::cpacketclassifier::classify(frag.somem(), frag.memlen(), info);
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_FRAGMENT));
+	CPPUNIT_ASSERT(not info.has(rofl::cpacketinfo::HAS_TCP));
+	CPPUNIT_ASSERT(rofl::cpacketinfo::OFFSET_NONE == info.l4_offset);
+}
+
+
+
+void
+cpacketclassifierTest::testQinQIPv6Udp()
+{
+	rofl::cmemory mem(14 + 4 + 40 + 8 + 8 + 8 + 4);
+	uint8_t* buf = mem.somem();
+	memcpy(buf, eth_hdr, 12);
+	// S-tag 200, C-tag 300
+	buf[12] = 0x88; buf[13] = 0xa8; buf[14] = 0x00; buf[15] = 0xc8;
+	buf[16] = 0x81; buf[17] = 0x00; buf[18] = 0x01; buf[19] = 0x2c;
+	buf[20] = 0x86; buf[21] = 0xdd;
+	// IPv6, traffic class 0x0b, flow label 0x12345
+	uint8_t* ip6 = buf + 22;
+	ip6[0] = 0x60; ip6[1] = 0xb1; ip6[2] = 0x23; ip6[3] = 0x45;
+	ip6[4] = 0x00; ip6[5] = 8 + 8 + 8 + 4;
+	ip6[6] = 0; /* hop-by-hop */ ip6[7] = 255;
+	for (unsigned int i = 0; i < 16; i++) {
+		ip6[8 + i] = 0x20 + i; ip6[24 + i] = 0x30 + i;
+	}
+	// hop-by-hop -> fragment (first) -> UDP
+	uint8_t* ext = ip6 + 40;
+	ext[0] = 44; ext[1] = 0;
+	ext[8] = 17; ext[10] = 0x00; ext[11] = 0x01;
+	uint8_t* udp = ext + 16;
+	udp[0] = 0x00; udp[1] = 0x35; udp[2] = 0x13; udp[3] = 0x88;
+
+	rofl::cpacketinfo info;
+	CPPUNIT_ASSERT(rofl::cpacketclassifier::classify(buf, mem.memlen(), info));
+
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_QINQ));
+	CPPUNIT_ASSERT(2 == info.num_vlans);
+	CPPUNIT_ASSERT(200 == info.vlan_vid[0]);
+	CPPUNIT_ASSERT(300 == info.vlan_vid[1]);
+	CPPUNIT_ASSERT(0x86dd == info.eth_type);
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_IPV6));
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_FRAGMENT));
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_UDP));
+	CPPUNIT_ASSERT(0x12345 == info.ipv6_flabel);
+	CPPUNIT_ASSERT((0x0b >> 2) == info.ip_dscp);
+	CPPUNIT_ASSERT((0x0b & 0x03) == info.ip_ecn);
+	CPPUNIT_ASSERT(17 == info.ip_proto);
+	CPPUNIT_ASSERT(0 == memcmp(info.ipv6_dst, ip6 + 24, 16));
+	CPPUNIT_ASSERT((rofl::openflow13::OFPIEH_HOP | rofl::openflow13::OFPIEH_FRAG) == info.ipv6_exthdr);
+	CPPUNIT_ASSERT(22 == info.l3_offset);
+	CPPUNIT_ASSERT(22 + 40 + 16 == info.l4_offset);
+	CPPUNIT_ASSERT(53 == info.tp_src);
+	CPPUNIT_ASSERT(5000 == info.tp_dst);
+
+	// hop-by-hop header not first in chain
+	ip6[6] = 60; ext[0] = 0;
+	rofl::cpacketclassifier::classify(buf, mem.memlen(), info);
+	CPPUNIT_ASSERT(info.ipv6_exthdr & rofl::openflow13::OFPIEH_UNSEQ);
+	CPPUNIT_ASSERT(info.ipv6_exthdr & rofl::openflow13::OFPIEH_DEST);
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_UDP));
+}
+
+
+
+void
+cpacketclassifierTest::testMpls()
+{
+	rofl::cmemory mem(14 + 8 + 20);
+	uint8_t* buf = mem.somem();
+	memcpy(buf, eth_hdr, 12);
+	buf[12] = 0x88; buf[13] = 0x47;
+	// label 1000 tc 3, label 2000 bos
+	buf[14] = 0x00; buf[15] = 0x3e; buf[16] = 0x86; buf[17] = 0x40;
+	buf[18] = 0x00; buf[19] = 0x7d; buf[20] = 0x01; buf[21] = 0x40;
+	buf[22] = 0x45; buf[31] = 17;
+
+	rofl::cpacketinfo info;
+	CPPUNIT_ASSERT(rofl::cpacketclassifier::classify(buf, mem.memlen(), info));
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_MPLS));
+	CPPUNIT_ASSERT(0x8847 == info.eth_type);
+	CPPUNIT_ASSERT(2 == info.num_mpls);
+	CPPUNIT_ASSERT(1000 == info.mpls_label);
+	CPPUNIT_ASSERT(3 == info.mpls_tc);
+	CPPUNIT_ASSERT(0 == info.mpls_bos);
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_IPV4));
+	CPPUNIT_ASSERT(22 == info.l3_offset);
+	// UDP header missing
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::IS_TRUNCATED));
+}
+
+
+
+void
+cpacketclassifierTest::testArp()
+{
+	rofl::cmemory mem(14 + 28);
+	uint8_t* buf = mem.somem();
+	memcpy(buf, eth_hdr, 12);
+	buf[12] = 0x08; buf[13] = 0x06;
+	uint8_t* arp = buf + 14;
+	arp[1] = 1; arp[2] = 0x08; arp[4] = 6; arp[5] = 4; arp[7] = 2;
+	memcpy(arp + 8, eth_hdr + 6, 6);
+	arp[14] = 192; arp[15] = 168; arp[16] = 0; arp[17] = 1;
+	memcpy(arp + 18, eth_hdr, 6);
+	arp[24] = 192; arp[25] = 168; arp[26] = 0; arp[27] = 2;
+
+	rofl::cpacketinfo info;
+	CPPUNIT_ASSERT(rofl::cpacketclassifier::classify(buf, mem.memlen(), info));
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_ARP));
+	CPPUNIT_ASSERT(2 == info.arp_op);
+	CPPUNIT_ASSERT(0 == memcmp(info.arp_sha, eth_hdr + 6, 6));
+	CPPUNIT_ASSERT(0 == memcmp(info.arp_tpa, arp + 24, 4));
+
+	rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION);
+	rofl::cpacketclassifier::get_flowkey(info, match);
+	CPPUNIT_ASSERT(2 == match.get_arp_opcode());
+	CPPUNIT_ASSERT(rofl::caddress_in4("192.168.0.1") == match.get_arp_spa());
+	CPPUNIT_ASSERT(rofl::caddress_in4("192.168.0.2") == match.get_arp_tpa());
+	CPPUNIT_ASSERT(rofl::cmacaddr("00:aa:bb:cc:dd:ee") == match.get_arp_sha());
+}
+
+
+
+void
+cpacketclassifierTest::testGtpu()
+{
+	rofl::cmemory mem(14 + 20 + 8 + 12 + 4 + 20);
+	uint8_t* buf = mem.somem();
+	memcpy(buf, eth_hdr, 12);
+	buf[12] = 0x08; buf[13] = 0x00;
+	uint8_t* ip = buf + 14;
+	ip[0] = 0x45; ip[3] = 20 + 8 + 12 + 4 + 20; ip[8] = 64; ip[9] = 17;
+	uint8_t* udp = ip + 20;
+	udp[0] = 0x08; udp[1] = 0x68; udp[2] = 0x08; udp[3] = 0x68;
+	uint8_t* gtpu = udp + 8;
+	// version 1, PT, E flag, TEID 0x01020304, one PDU session container
+	gtpu[0] = 0x34; gtpu[1] = 0xff;
+	gtpu[4] = 0x01; gtpu[5] = 0x02; gtpu[6] = 0x03; gtpu[7] = 0x04;
+	gtpu[11] = 0x85;
+	gtpu[12] = 1; gtpu[15] = 0;
+	// inner IPv4
+	gtpu[16] = 0x45;
+
+	rofl::cpacketinfo info;
+	CPPUNIT_ASSERT(rofl::cpacketclassifier::classify(buf, mem.memlen(), info));
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_UDP));
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_GTPU));
+	CPPUNIT_ASSERT(not info.has(rofl::cpacketinfo::IS_TRUNCATED));
+	CPPUNIT_ASSERT(0x01020304 == info.tunnel_id);
+	CPPUNIT_ASSERT(14 + 20 + 8 == info.tunnel_offset);
+	CPPUNIT_ASSERT(14 + 20 + 8 + 16 == info.payload_offset);
+	CPPUNIT_ASSERT(0x45 == buf[info.payload_offset]);
+
+	// L2TPv3 over IP, session 0x0a0b0c0d
+	ip[9] = 115;
+	ip[20] = 0x0a; ip[21] = 0x0b; ip[22] = 0x0c; ip[23] = 0x0d;
+	rofl::cpacketclassifier::classify(buf, mem.memlen(), info);
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::HAS_L2TPV3));
+	CPPUNIT_ASSERT(not info.has(rofl::cpacketinfo::HAS_UDP));
+	CPPUNIT_ASSERT(0x0a0b0c0d == info.tunnel_id);
+	CPPUNIT_ASSERT(14 + 20 + 4 == info.payload_offset);
+}
+
+
+
+void
+cpacketclassifierTest::testTruncated()
+{
+	rofl::cpacketinfo info;
+
+	CPPUNIT_ASSERT(not rofl::cpacketclassifier::classify(vlan_ipv4_tcp, 13, info));
+	CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::IS_TRUNCATED));
+	CPPUNIT_ASSERT(not rofl::cpacketclassifier::classify(NULL, 0, info));
+
+	// every prefix of the frame must be classified without reading beyond it
+	for (size_t len = 14; len < 58; len++) {
+		rofl::cmemory mem((uint8_t*)vlan_ipv4_tcp, len);
+		CPPUNIT_ASSERT(rofl::cpacketclassifier::classify(mem.somem(), mem.memlen(), info));
+		CPPUNIT_ASSERT(info.has(rofl::cpacketinfo::IS_TRUNCATED));
+		CPPUNIT_ASSERT(not info.has(rofl::cpacketinfo::HAS_TCP));
+	}
+}
+
+
+
+void
+cpacketclassifierTest::testFlowKey()
+{
+	rofl::cpacketinfo info;
+	rofl::cpacketclassifier::classify(vlan_ipv4_tcp, sizeof(vlan_ipv4_tcp), info);
+
+	rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION);
+	rofl::cpacketclassifier::get_flowkey(info, match, 7);
+
+	CPPUNIT_ASSERT(7 == match.get_in_port());
+	CPPUNIT_ASSERT(rofl::cmacaddr("00:11:22:33:44:55") == match.get_eth_dst());
+	CPPUNIT_ASSERT(rofl::cmacaddr("00:aa:bb:cc:dd:ee") == match.get_eth_src());
+	CPPUNIT_ASSERT(0x0800 == match.get_eth_type());
+	CPPUNIT_ASSERT((100 | rofl::openflow13::OFPVID_PRESENT) == match.get_vlan_vid());
+	CPPUNIT_ASSERT(5 == match.get_vlan_pcp());
+	CPPUNIT_ASSERT(rofl::caddress_in4("10.0.0.1") == match.get_ipv4_src());
+	CPPUNIT_ASSERT(rofl::caddress_in4("10.0.0.2") == match.get_ipv4_dst());
+	CPPUNIT_ASSERT(46 == match.get_ip_dscp());
+	CPPUNIT_ASSERT(6 == match.get_ip_proto());
+	CPPUNIT_ASSERT(1234 == match.get_tcp_src());
+	CPPUNIT_ASSERT(80 == match.get_tcp_dst());
+	CPPUNIT_ASSERT(not match.has_udp_src());
+
+	// packed match must be accepted by the OXM parser
+	rofl::cmemory mem(match.length());
+	match.pack(mem.somem(), mem.memlen());
+	rofl::openflow::cofmatch match2(rofl::openflow13::OFP_VERSION);
+	match2.unpack(mem.somem(), mem.memlen());
+	CPPUNIT_ASSERT(match2 == match);
+}
@@ -0,0 +1,32 @@
+#include "rofl/common/protocols/cpacketclassifier.h"
+#include "rofl/common/cmemory.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class cpacketclassifierTest : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( cpacketclassifierTest );
+	CPPUNIT_TEST( testVlanIPv4Tcp );
+	CPPUNIT_TEST( testQinQIPv6Udp );
+	CPPUNIT_TEST( testMpls );
+	CPPUNIT_TEST( testArp );
+	CPPUNIT_TEST( testGtpu );
+	CPPUNIT_TEST( testTruncated );
+	CPPUNIT_TEST( testFlowKey );
+	CPPUNIT_TEST_SUITE_END();
+
+private:
+
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testVlanIPv4Tcp();
+	void testQinQIPv6Udp();
+	void testMpls();
+	void testArp();
+	void testGtpu();
+	void testTruncated();
+	void testFlowKey();
+};
@@ -0,0 +1,104 @@
+/*
+ * ssl_cert_helper.h
+ *
+ * Self-signed certificate for unit tests and benchmarks of
+ * rofl::csslctx and rofl::csocket_openssl.
+ */
+
+#ifndef SSL_CERT_HELPER_H_
+#define SSL_CERT_HELPER_H_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+namespace {
+
+/*
+ * creates a new temporary file /tmp/<prefix>_XXXXXX for writing, returns NULL on failure
+ */
+inline FILE*
+open_tempfile(const std::string& prefix, std::string& filename)
+{
+	std::string name("/tmp/" + prefix + "_XXXXXX");
+	std::vector<char> tmpl(name.begin(), name.end());
+	tmpl.push_back('\0');
+	int fd = mkstemp(&tmpl[0]);
+	if (fd < 0)
+		return NULL;
+	filename = &tmpl[0];
+	FILE* fp = fdopen(fd, "w");
+	if (NULL == fp)
+		close(fd);
+	return fp;
+}
+
+/*
+ * writes a self-signed RSA-2048 certificate for common name "rofl.test" and
+ * its private key to temporary files named after prefix, the certificate
+ * serves as CA for both peers, the caller unlinks both files,
+ * returns false on failure
+ */
+inline bool
+create_self_signed_cert(const std::string& prefix, std::string& certfile, std::string& keyfile)
+{
+	certfile.clear();
+	keyfile.clear();
+
+	EVP_PKEY* pkey = NULL;
+	EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
+	bool ok = (NULL != pctx) &&
+			(EVP_PKEY_keygen_init(pctx) > 0) &&
+			(EVP_PKEY_CTX_set_rsa_keygen_bits(pctx, 2048) > 0) &&
+			(EVP_PKEY_keygen(pctx, &pkey) > 0);
+	EVP_PKEY_CTX_free(pctx);
+	if (not ok)
+		return false;
+
+	X509* x509 = X509_new();
+	X509_set_version(x509, 2);
+	ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+	X509_gmtime_adj(X509_get_notBefore(x509), -3600);
+	X509_gmtime_adj(X509_get_notAfter(x509), 3600);
+	X509_set_pubkey(x509, pkey);
+	X509_NAME* name = X509_get_subject_name(x509);
+	X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"rofl.test", -1, -1, 0);
+	X509_set_issuer_name(x509, name);
+	ok = (X509_sign(x509, pkey, EVP_sha256()) > 0);
+
+	FILE* fp = NULL;
+	if (ok) {
+		ok = (NULL != (fp = open_tempfile(prefix + "_cert", certfile))) &&
+				(PEM_write_X509(fp, x509) > 0);
+		if (NULL != fp)
+			ok = (fclose(fp) == 0) && ok;
+	}
+	fp = NULL;
+	if (ok) {
+		ok = (NULL != (fp = open_tempfile(prefix + "_key", keyfile))) &&
+				(PEM_write_PrivateKey(fp, pkey, NULL, NULL, 0, NULL, NULL) > 0);
+		if (NULL != fp)
+			ok = (fclose(fp) == 0) && ok;
+	}
+	if (not ok) {
+		if (not certfile.empty())
+			unlink(certfile.c_str());
+		if (not keyfile.empty())
+			unlink(keyfile.c_str());
+	}
+
+	X509_free(x509);
+	EVP_PKEY_free(pkey);
+	return ok;
+}
+
+}; // end of anonymous namespace
+
+#endif /* SSL_CERT_HELPER_H_ */
@@ -0,0 +1,138 @@
+/*
+ * cchecksum_bench.cc
+ *
+ * Microbenchmark for rofl::cchecksum over payloads of 64 bytes to 9 KB:
+ * Internet checksum with the former scalar 16-bit loop of the protocol
+ * frames as baseline and each implementation supported by the CPU,
+ * incremental update of a single field and CRC32C.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <endian.h>
+
+#include <vector>
+
+#include "rofl/common/cchecksum.h"
+
+namespace {
+
+static size_t const NUM_BYTES = 256 * 1024 * 1024;
+
+double
+now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void
+report(const char* op, size_t len, size_t num_ops, double elapsed)
+{
+	fprintf(stdout, "bench=cchecksum op=%s bytes=%lu ops=%lu ns_per_op=%.1f gbytes_per_s=%.2f\n",
+			op, (unsigned long)len, (unsigned long)num_ops, elapsed * 1e9 / (double)num_ops,
+			(double)len * (double)num_ops / elapsed / 1e9);
+}
+
+/*
+ * 16-bit loop with be16toh() per word as formerly used by fipv4frame and others
+ */
+uint16_t
+legacy(const uint8_t* buf, size_t len)
+{
+	const uint16_t* word16 = (const uint16_t*)buf;
+	uint32_t sum = 0;
+	for (size_t i = 0; i < len / 2; i++) {
+		sum += be16toh(word16[i]);
+	}
+	if (len & 1)
+		sum += (uint32_t)buf[len - 1] << 8;
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return htobe16(~sum);
+}
+
+void
+run(const std::vector<uint8_t>& buf, size_t len)
+{
+	size_t num_ops = NUM_BYTES / len;
+	uint16_t expected = legacy(&buf[0], len);
+	uint64_t sum = 0;
+
+	double start = now();
+	for (size_t i = 0; i < num_ops; i++) {
+		sum += legacy(&buf[0], len);
+	}
+	report("legacy", len, num_ops, now() - start);
+
+	rofl::cchecksum::cchecksum_impl_t const impls[] = {
+		rofl::cchecksum::IMPL_SCALAR,
+		rofl::cchecksum::IMPL_SSE2,
+		rofl::cchecksum::IMPL_AVX2,
+	};
+	for (unsigned int n = 0; n < sizeof(impls) / sizeof(impls[0]); n++) {
+		if (not rofl::cchecksum::has_impl(impls[n]))
+			continue;
+		rofl::cchecksum::set_impl(impls[n]);
+		if (rofl::cchecksum::checksum(&buf[0], len) != expected) {
+			fprintf(stderr, "checksum mismatch impl=%s bytes=%lu\n",
+					rofl::cchecksum::impl2str(impls[n]), (unsigned long)len);
+			exit(EXIT_FAILURE);
+		}
+		start = now();
+		for (size_t i = 0; i < num_ops; i++) {
+			sum += rofl::cchecksum::checksum(&buf[0], len);
+		}
+		report(rofl::cchecksum::impl2str(impls[n]), len, num_ops, now() - start);
+	}
+
+	start = now();
+	for (size_t i = 0; i < num_ops; i++) {
+		sum += rofl::cchecksum::crc32c(&buf[0], len);
+	}
+	report(rofl::cchecksum::has_crc32c_hw() ? "crc32c-sse42" : "crc32c-table", len, num_ops, now() - start);
+
+	if (0 == sum)
+		fprintf(stderr, "unexpected result\n");
+}
+
+}; // end of anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+	size_t const lens[] = { 64, 128, 256, 512, 1500, 4096, 9000 };
+	std::vector<uint8_t> buf(9000);
+	for (size_t i = 0; i < buf.size(); i++) {
+		buf[i] = rand();
+	}
+
+	rofl::cchecksum::cchecksum_impl_t impl = rofl::cchecksum::get_impl();
+	for (unsigned int l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+		run(buf, lens[l]);
+	}
+	rofl::cchecksum::set_impl(impl);
+
+	// incremental update of a rewritten IPv4 address versus full recalculation of a 20-byte header
+	size_t num_ops = 10000000;
+	uint16_t check = rofl::cchecksum::checksum(&buf[0], 20);
+	double start = now();
+	for (size_t i = 0; i < num_ops; i++) {
+		check = rofl::cchecksum::update32(check, (uint32_t)i, (uint32_t)(i + 1));
+	}
+	report("update32", 4, num_ops, now() - start);
+
+	uint64_t sum = check;
+	start = now();
+	for (size_t i = 0; i < num_ops; i++) {
+		sum += rofl::cchecksum::checksum(&buf[0], 20);
+	}
+	report("ipv4-header", 20, num_ops, now() - start);
+
+	if (0 == sum)
+		fprintf(stderr, "unexpected result\n");
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,167 @@
+/*
+ * cioloop_bench.cc
+ *
+ * Microbenchmark for rofl::cioloop internals with 10k registered file
+ * descriptors: registration of read events and dispatch latency, i.e.,
+ * the time from signalling a number of descriptors until the loop has
+ * delivered the last handle_revent() call. Descriptors are eventfds, so
+ * the kernel side of a dispatch is a single read() per event.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+
+#include <vector>
+
+#include "rofl/common/ciosrv.h"
+
+namespace {
+
+static size_t const NUM_FDS = 10000;
+
+double
+now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void
+report(const char* op, size_t active, size_t num_ops, double elapsed)
+{
+	fprintf(stdout, "bench=cioloop op=%s fds=%lu active=%lu ops=%lu ns_per_op=%.1f\n",
+			op, (unsigned long)NUM_FDS, (unsigned long)active, (unsigned long)num_ops,
+			elapsed * 1e9 / (double)num_ops);
+}
+
+class dispatcher : public rofl::ciosrv {
+
+	enum dispatcher_timer_t {
+		TIMER_START = 1,
+	};
+
+public:
+
+	dispatcher() :
+		active(0), rounds(0), round(0), pending(0), events(0), start(0), elapsed(0)
+	{};
+
+	virtual
+	~dispatcher() {
+		for (size_t i = 0; i < fds.size(); i++) {
+			deregister_filedesc_r(fds[i]);
+			close(fds[i]);
+		}
+	};
+
+	void
+	open_fds() {
+		fds.reserve(NUM_FDS);
+		for (size_t i = 0; i < NUM_FDS; i++) {
+			int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (fd < 0) {
+				perror("eventfd");
+				exit(EXIT_FAILURE);
+			}
+			fds.push_back(fd);
+		}
+		double t = now();
+		for (size_t i = 0; i < NUM_FDS; i++) {
+			register_filedesc_r(fds[i]);
+		}
+		report("register", NUM_FDS, NUM_FDS, now() - t);
+	};
+
+	/*
+	 * signals active descriptors, spread over the whole set, per round
+	 */
+	void
+	run(size_t active, size_t rounds) {
+		this->active = active;
+		this->rounds = rounds;
+		round = 0;
+		events = 0;
+		elapsed = 0;
+		register_timer(TIMER_START, rofl::ctimespec(0));
+		rofl::cioloop::get_loop().run();
+		report("dispatch", active, events, elapsed);
+	};
+
+private:
+
+	void
+	signal() {
+		uint64_t one = 1;
+		pending = active;
+		start = now();
+		for (size_t i = 0; i < active; i++) {
+			if (write(fds[(i * NUM_FDS) / active], &one, sizeof(one)) < 0) {
+				perror("write");
+				exit(EXIT_FAILURE);
+			}
+		}
+	};
+
+	virtual void
+	handle_timeout(int opaque, void* data) {
+		signal();
+	};
+
+	virtual void
+	handle_revent(int fd) {
+		uint64_t value;
+		if (read(fd, &value, sizeof(value)) < 0)
+			return;
+		events++;
+		if (--pending > 0)
+			return;
+		elapsed += now() - start;
+		if (++round < rounds) {
+			signal();
+		} else {
+			rofl::cioloop::get_loop().stop();
+		}
+	};
+
+private:
+
+	std::vector<int>	fds;
+	size_t				active;
+	size_t				rounds;
+	size_t				round;
+	size_t				pending;
+	size_t				events;
+	double				start;
+	double				elapsed;
+};
+
+}; // end of anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+	struct rlimit rlim;
+	if ((getrlimit(RLIMIT_NOFILE, &rlim) == 0) && (rlim.rlim_cur < NUM_FDS + 64)) {
+		rlim.rlim_cur = (rlim.rlim_max < NUM_FDS + 64) ? rlim.rlim_max : NUM_FDS + 64;
+		setrlimit(RLIMIT_NOFILE, &rlim);
+	}
+
+	{
+		dispatcher disp;
+		disp.open_fds();
+		// single descriptor per wakeup, e.g., one busy switch among many idle ones
+		disp.run(1, 20000);
+		disp.run(100, 2000);
+		// all descriptors ready at once
+		disp.run(NUM_FDS, 50);
+	}
+
+	rofl::cioloop::get_loop().shutdown();
+
+	return EXIT_SUCCESS;
+}
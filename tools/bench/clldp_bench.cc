@@ -0,0 +1,128 @@
+/*
+ * clldp_bench.cc
+ *
+ * Microbenchmark for LLDP discovery frames: encoding via clldpmsg with a
+ * clldpattr per TLV versus patching a precomputed clldptemplate, and
+ * decoding via clldpmsg::unpack() versus clldpdecoder.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "rofl/common/protocols/clldpmsg.h"
+#include "rofl/common/protocols/clldptemplate.h"
+#include "rofl/common/protocols/clldpdecoder.h"
+
+using namespace rofl::protocol::lldp;
+
+namespace {
+
+static size_t const NUM_PORTS = 48;
+static size_t const NUM_ROUNDS = 20000;
+
+double
+now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void
+report(const char* op, size_t num_ops, double elapsed)
+{
+	fprintf(stdout, "bench=clldp op=%s ops=%lu ns_per_op=%.1f mops_per_s=%.2f\n",
+			op, (unsigned long)num_ops, elapsed * 1e9 / (double)num_ops,
+			(double)num_ops / elapsed / 1e6);
+}
+
+void
+port_name(char* name, size_t namelen, size_t port_no)
+{
+	snprintf(name, namelen, "ge-0/0/%lu", (unsigned long)port_no);
+}
+
+}; // end of anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+	const uint8_t chassis_id[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xf4 };
+	rofl::cmacaddr eth_src("00:01:02:03:04:05");
+	size_t num_ops = NUM_PORTS * NUM_ROUNDS;
+	uint8_t frame[256];
+	uint64_t sum = 0;
+	char name[32];
+
+	// encode: one frame per port and discovery round
+	double start = now();
+	for (size_t round = 0; round < NUM_ROUNDS; round++) {
+		for (size_t port_no = 0; port_no < NUM_PORTS; port_no++) {
+			port_name(name, sizeof(name), port_no);
+			clldpmsg msg;
+			msg.set_eth_src() = eth_src;
+			msg.set_attrs().add_chassis_id().set_sub_type() = LLDPCHIDST_LOCAL;
+			msg.set_attrs().set_chassis_id().set_body() = rofl::cmemory((uint8_t*)chassis_id, sizeof(chassis_id));
+			msg.set_attrs().add_port_id().set_sub_type() = LLDPPRTIDST_IFNAME;
+			msg.set_attrs().set_port_id().set_body() = rofl::cmemory((uint8_t*)name, strlen(name));
+			msg.set_attrs().add_ttl().set_ttl() = 120;
+			msg.set_attrs().add_end();
+			msg.pack(frame, msg.length());
+			sum += frame[msg.length() - 3];
+		}
+	}
+	report("encode-clldpmsg", num_ops, now() - start);
+
+	std::vector<clldptemplate> templates;
+	for (size_t port_no = 0; port_no < NUM_PORTS; port_no++) {
+		port_name(name, sizeof(name), port_no);
+		templates.push_back(clldptemplate(eth_src, LLDPCHIDST_LOCAL, chassis_id, sizeof(chassis_id),
+				LLDPPRTIDST_IFNAME, (const uint8_t*)name, strlen(name)));
+	}
+
+	start = now();
+	for (size_t round = 0; round < NUM_ROUNDS; round++) {
+		for (size_t port_no = 0; port_no < NUM_PORTS; port_no++) {
+			clldptemplate& tmpl = templates[port_no];
+			tmpl.set_ttl(120 + (round & 1));
+			memcpy(frame, tmpl.somem(), tmpl.length());
+			sum += frame[tmpl.length() - 3];
+		}
+	}
+	report("encode-template", num_ops, now() - start);
+
+	// decode: frames of all ports as received in Packet-Ins
+	start = now();
+	for (size_t round = 0; round < NUM_ROUNDS; round++) {
+		for (size_t port_no = 0; port_no < NUM_PORTS; port_no++) {
+			const clldptemplate& tmpl = templates[port_no];
+			clldpmsg msg;
+			msg.unpack(const_cast<uint8_t*>(tmpl.somem()), tmpl.length());
+			sum += msg.set_attrs().get_ttl().get_ttl() + msg.set_attrs().get_port_id().get_body().memlen();
+		}
+	}
+	report("decode-clldpmsg", num_ops, now() - start);
+
+	start = now();
+	for (size_t round = 0; round < NUM_ROUNDS; round++) {
+		for (size_t port_no = 0; port_no < NUM_PORTS; port_no++) {
+			const clldptemplate& tmpl = templates[port_no];
+			clldpinfo info;
+			if (not clldpdecoder::decode(tmpl.somem(), tmpl.length(), info)) {
+				fprintf(stderr, "decoding failed port=%lu\n", (unsigned long)port_no);
+				return EXIT_FAILURE;
+			}
+			sum += info.ttl + info.port_id_len;
+		}
+	}
+	report("decode-fast", num_ops, now() - start);
+
+	if (0 == sum)
+		fprintf(stderr, "unexpected result\n");
+
+	return EXIT_SUCCESS;
+}
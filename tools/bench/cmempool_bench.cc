@@ -0,0 +1,139 @@
+/*
+ * cmempool_bench.cc
+ *
+ * Microbenchmark for rofl::cmempool: allocation and release of memory
+ * areas with sizes typical for OpenFlow messages, of heap allocated
+ * rofl::cpacket instances (object plus memory area) and of
+ * rofl::openflow::cofmsg instances. Each workload runs with the pool
+ * disabled, i.e., served by malloc(), and enabled.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <vector>
+
+#include "rofl/common/cmempool.h"
+#include "rofl/common/cpacket.h"
+#include "rofl/common/openflow/messages/cofmsg.h"
+
+namespace {
+
+static size_t const NUM_OPS = 1000000;
+static size_t const NUM_INFLIGHT = 256;
+
+double
+now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+size_t
+msglen(size_t i)
+{
+	// mostly small control messages, some packet-ins with full frames
+	static size_t const lens[] = { 8, 16, 24, 64, 80, 128, 256, 1518 };
+	return lens[(i * 7919) % (sizeof(lens) / sizeof(size_t))];
+}
+
+void
+report(const char* impl, const char* op, double elapsed)
+{
+	uint64_t hits = 0, misses = 0;
+	size_t high_water = 0;
+	for (unsigned int cls = 0; cls < rofl::cmempool::NUM_CLASSES; cls++) {
+		rofl::cmempool_stats stats = rofl::cmempool::get_stats(cls);
+		hits += stats.hits;
+		misses += stats.misses;
+		high_water += stats.high_water;
+	}
+	fprintf(stdout, "bench=mempool impl=%s op=%s ops=%lu ns_per_op=%.1f hits=%lu misses=%lu fallbacks=%lu high_water=%lu\n",
+			impl, op, (unsigned long)NUM_OPS, elapsed * 1e9 / (double)NUM_OPS,
+			(unsigned long)hits, (unsigned long)misses,
+			(unsigned long)rofl::cmempool::get_fallbacks(), (unsigned long)high_water);
+}
+
+/*
+ * Keeps NUM_INFLIGHT objects alive, replacing the oldest one per operation,
+ * like messages queued between socket and application.
+ */
+template<typename T, T* (*create)(size_t), void (*destroy)(T*)>
+void
+run(const char* impl, const char* op)
+{
+	std::vector<T*> inflight(NUM_INFLIGHT, (T*)0);
+	rofl::cmempool::reset_stats();
+	double start = now();
+	for (size_t i = 0; i < NUM_OPS; i++) {
+		size_t slot = i % NUM_INFLIGHT;
+		if (inflight[slot])
+			destroy(inflight[slot]);
+		inflight[slot] = create(msglen(i));
+	}
+	double elapsed = now() - start;
+	report(impl, op, elapsed);
+	for (size_t i = 0; i < NUM_INFLIGHT; i++) {
+		if (inflight[i])
+			destroy(inflight[i]);
+	}
+}
+
+uint8_t*
+create_area(size_t len)
+{
+	return (uint8_t*)rofl::cmempool::allocate(len);
+}
+
+void
+destroy_area(uint8_t* area)
+{
+	rofl::cmempool::release(area);
+}
+
+rofl::cpacket*
+create_packet(size_t len)
+{
+	return new rofl::cpacket(len);
+}
+
+void
+destroy_packet(rofl::cpacket* pkt)
+{
+	delete pkt;
+}
+
+rofl::openflow::cofmsg*
+create_msg(size_t len)
+{
+	return new rofl::openflow::cofmsg(len < 8 ? 8 : len);
+}
+
+void
+destroy_msg(rofl::openflow::cofmsg* msg)
+{
+	delete msg;
+}
+
+void
+run_all(const char* impl)
+{
+	run<uint8_t, create_area, destroy_area>(impl, "area");
+	run<rofl::cpacket, create_packet, destroy_packet>(impl, "cpacket");
+	run<rofl::openflow::cofmsg, create_msg, destroy_msg>(impl, "cofmsg");
+}
+
+}; // end of anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+	rofl::cmempool::set_enabled(false);
+	run_all("malloc");
+	rofl::cmempool::set_enabled(true);
+	run_all("cmempool");
+
+	return EXIT_SUCCESS;
+}
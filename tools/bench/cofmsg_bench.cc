@@ -0,0 +1,319 @@
+/*
+ * cofmsg_bench.cc
+ *
+ * Codec microbenchmark for the OpenFlow message layer: pack, unpack and
+ * validate of Flow-Mod, Packet-In, Packet-Out, flow, port, table and
+ * aggregate stats replies and Error messages for OpenFlow 1.0, 1.2 and 1.3.
+ *
+ * pack serializes a prepared message into a buffer, unpack parses a
+ * buffer into an existing message object and validate constructs a
+ * message from a received memory area and parses it as crofsock does.
+ * Allocations are counted by overriding global operator new and from the
+ * rofl::cmempool counters, i.e., allocs_per_op covers C++ objects and
+ * memory areas. One line of key=value pairs is written per message type,
+ * version and operation, e.g., for tracking results across releases.
+ *
+ * usage: cofmsg_bench [num_ops]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <new>
+#include <vector>
+
+#include "rofl/common/cmempool.h"
+#include "rofl/common/openflow/messages/cofmsg_flow_mod.h"
+#include "rofl/common/openflow/messages/cofmsg_packet_in.h"
+#include "rofl/common/openflow/messages/cofmsg_packet_out.h"
+#include "rofl/common/openflow/messages/cofmsg_flow_stats.h"
+#include "rofl/common/openflow/messages/cofmsg_port_stats.h"
+#include "rofl/common/openflow/messages/cofmsg_table_stats.h"
+#include "rofl/common/openflow/messages/cofmsg_aggr_stats.h"
+#include "rofl/common/openflow/messages/cofmsg_error.h"
+
+namespace {
+
+size_t		num_ops		= 20000;
+uint64_t	num_news	= 0;
+bool		failed		= false;
+
+double
+now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+uint64_t
+num_allocs()
+{
+	uint64_t allocs = num_news + rofl::cmempool::get_fallbacks();
+	for (unsigned int cls = 0; cls < rofl::cmempool::NUM_CLASSES; cls++) {
+		rofl::cmempool_stats stats = rofl::cmempool::get_stats(cls);
+		allocs += stats.hits + stats.misses;
+	}
+	return allocs;
+}
+
+void
+report(const char* msg, uint8_t ofp_version, const char* op, size_t len, double elapsed, uint64_t allocs)
+{
+	fprintf(stdout, "bench=cofmsg msg=%s ofp_version=%u op=%s ops=%lu ns_per_op=%.1f bytes_per_op=%lu allocs_per_op=%.2f\n",
+			msg, (unsigned int)ofp_version, op, (unsigned long)num_ops,
+			elapsed * 1e9 / (double)num_ops, (unsigned long)len, (double)allocs / (double)num_ops);
+}
+
+/*
+ * Runs pack, unpack and validate for a prepared message of type T.
+ */
+template<class T>
+void
+run(const char* name, uint8_t ofp_version, T& msg)
+{
+	try {
+		size_t len = msg.length();
+		std::vector<uint8_t> buf(len);
+
+		uint64_t allocs = num_allocs();
+		double start = now();
+		for (size_t i = 0; i < num_ops; i++) {
+			msg.pack(&buf[0], len);
+		}
+		double elapsed = now() - start;
+		report(name, ofp_version, "pack", len, elapsed, num_allocs() - allocs);
+
+		T parsed(msg);
+		allocs = num_allocs();
+		start = now();
+		for (size_t i = 0; i < num_ops; i++) {
+			parsed.unpack(&buf[0], len);
+		}
+		elapsed = now() - start;
+		report(name, ofp_version, "unpack", len, elapsed, num_allocs() - allocs);
+
+		if (parsed.length() != len) {
+			fprintf(stderr, "bench=cofmsg msg=%s ofp_version=%u length mismatch after unpack\n",
+					name, (unsigned int)ofp_version);
+			failed = true;
+		}
+
+		allocs = num_allocs();
+		start = now();
+		for (size_t i = 0; i < num_ops; i++) {
+			T* rcvd = new T(new rofl::cmemory(&buf[0], len));
+			rcvd->validate();
+			delete rcvd;
+		}
+		elapsed = now() - start;
+		report(name, ofp_version, "validate", len, elapsed, num_allocs() - allocs);
+
+	} catch (rofl::RoflException& e) {
+		fprintf(stderr, "bench=cofmsg msg=%s ofp_version=%u failed: %s\n",
+				name, (unsigned int)ofp_version, e.what());
+		failed = true;
+	}
+}
+
+rofl::openflow::cofmatch
+make_match(uint8_t ofp_version)
+{
+	rofl::openflow::cofmatch match(ofp_version);
+	match.set_in_port(1);
+	match.set_eth_dst(rofl::cmacaddr("00:11:22:33:44:55"));
+	match.set_eth_type(0x0800);
+	return match;
+}
+
+void
+bench_flow_mod(uint8_t ofp_version)
+{
+	rofl::openflow::cofflowmod flowmod(ofp_version);
+	flowmod.set_command(rofl::openflow::OFPFC_ADD);
+	flowmod.set_priority(0x8000);
+	flowmod.set_idle_timeout(30);
+	flowmod.set_match() = make_match(ofp_version);
+	if (rofl::openflow10::OFP_VERSION == ofp_version) {
+		flowmod.set_actions().add_action_output(rofl::cindex(0)).set_port_no(2);
+	} else {
+		flowmod.set_instructions().set_inst_apply_actions().set_actions().
+				add_action_output(rofl::cindex(0)).set_port_no(2);
+	}
+	rofl::openflow::cofmsg_flow_mod msg(ofp_version, 1, flowmod);
+	run("flow_mod", ofp_version, msg);
+}
+
+void
+bench_packet_in(uint8_t ofp_version)
+{
+	uint8_t data[128];
+	memset(data, 0xa5, sizeof(data));
+	rofl::openflow::cofmsg_packet_in msg(ofp_version, 1, rofl::openflow13::OFP_NO_BUFFER,
+			sizeof(data), rofl::openflow13::OFPR_NO_MATCH, 0, 0, 1,
+			(rofl::openflow10::OFP_VERSION == ofp_version) ? rofl::openflow::cofmatch(ofp_version) : make_match(ofp_version),
+			data, sizeof(data));
+	run("packet_in", ofp_version, msg);
+}
+
+void
+bench_packet_out(uint8_t ofp_version)
+{
+	uint8_t data[128];
+	memset(data, 0xa5, sizeof(data));
+	rofl::openflow::cofactions actions(ofp_version);
+	actions.add_action_output(rofl::cindex(0)).set_port_no(2);
+	rofl::openflow::cofmsg_packet_out msg(ofp_version, 1, rofl::openflow13::OFP_NO_BUFFER, 1,
+			actions, data, sizeof(data));
+	run("packet_out", ofp_version, msg);
+}
+
+void
+bench_flow_stats_reply(uint8_t ofp_version)
+{
+	rofl::openflow::cofflowstatsarray array(ofp_version);
+	for (uint32_t flow_id = 0; flow_id < 16; flow_id++) {
+		rofl::openflow::cofflow_stats_reply& stats = array.add_flow_stats(flow_id);
+		stats.set_priority(0x8000 + flow_id);
+		stats.set_packet_count(flow_id * 1000);
+		stats.set_byte_count(flow_id * 64000);
+		stats.set_match() = make_match(ofp_version);
+		if (rofl::openflow10::OFP_VERSION == ofp_version) {
+			stats.set_actions().add_action_output(rofl::cindex(0)).set_port_no(2);
+		} else {
+			stats.set_instructions().set_inst_apply_actions().set_actions().
+					add_action_output(rofl::cindex(0)).set_port_no(2);
+		}
+	}
+	rofl::openflow::cofmsg_flow_stats_reply msg(ofp_version, 1, 0, array);
+	run("flow_stats_reply", ofp_version, msg);
+}
+
+void
+bench_port_stats_reply(uint8_t ofp_version)
+{
+	rofl::openflow::cofportstatsarray array(ofp_version);
+	for (uint32_t port_no = 1; port_no <= 48; port_no++) {
+		rofl::openflow::cofport_stats_reply& stats = array.add_port_stats(port_no);
+		stats.set_port_no(port_no);
+		stats.set_rx_packets(port_no * 1000);
+		stats.set_tx_packets(port_no * 2000);
+		stats.set_rx_bytes(port_no * 64000);
+		stats.set_tx_bytes(port_no * 128000);
+	}
+	rofl::openflow::cofmsg_port_stats_reply msg(ofp_version, 1, 0, array);
+	run("port_stats_reply", ofp_version, msg);
+}
+
+void
+bench_table_stats_reply(uint8_t ofp_version)
+{
+	rofl::openflow::coftablestatsarray array(ofp_version);
+	for (unsigned int table_id = 0; table_id < 8; table_id++) {
+		rofl::openflow::coftable_stats_reply& stats = array.add_table_stats(table_id);
+		stats.set_table_id(table_id);
+		if (rofl::openflow13::OFP_VERSION != ofp_version) {
+			stats.set_name("table");
+		}
+		stats.set_active_count(table_id * 100);
+		stats.set_lookup_count(table_id * 10000);
+	}
+	rofl::openflow::cofmsg_table_stats_reply msg(ofp_version, 1, 0, array);
+	run("table_stats_reply", ofp_version, msg);
+}
+
+void
+bench_aggr_stats_reply(uint8_t ofp_version)
+{
+	rofl::openflow::cofmsg_aggr_stats_reply msg(ofp_version, 1, 0,
+			rofl::openflow::cofaggr_stats_reply(ofp_version, 1000000, 64000000, 16));
+	run("aggr_stats_reply", ofp_version, msg);
+}
+
+void
+bench_error(uint8_t ofp_version)
+{
+	uint8_t data[64];
+	memset(data, 0xa5, sizeof(data));
+	rofl::openflow::cofmsg_error msg(ofp_version, 1,
+			rofl::openflow13::OFPET_BAD_REQUEST, rofl::openflow13::OFPBRC_BAD_LEN, data, sizeof(data));
+	run("error", ofp_version, msg);
+}
+
+}; // end of anonymous namespace
+
+
+
+/*
+ * count all C++ allocations, including those within librofl_common
+ */
+#if __cplusplus >= 201103L
+#define BENCH_THROW_BAD_ALLOC
+#define BENCH_THROW_NONE noexcept
+#else
+#define BENCH_THROW_BAD_ALLOC throw (std::bad_alloc)
+#define BENCH_THROW_NONE throw ()
+#endif
+
+void*
+operator new(size_t size) BENCH_THROW_BAD_ALLOC
+{
+	num_news++;
+	void* ptr = malloc(size ? size : 1);
+	if (NULL == ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void*
+operator new[](size_t size) BENCH_THROW_BAD_ALLOC
+{
+	return operator new(size);
+}
+
+void
+operator delete(void* ptr) BENCH_THROW_NONE
+{
+	free(ptr);
+}
+
+void
+operator delete[](void* ptr) BENCH_THROW_NONE
+{
+	free(ptr);
+}
+
+
+
+int
+main(int argc, char** argv)
+{
+	if (argc > 1) {
+		num_ops = strtoul(argv[1], NULL, 0);
+		if (0 == num_ops) {
+			fprintf(stderr, "usage: %s [num_ops]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	uint8_t const versions[] = {
+		rofl::openflow10::OFP_VERSION,
+		rofl::openflow12::OFP_VERSION,
+		rofl::openflow13::OFP_VERSION,
+	};
+
+	for (unsigned int v = 0; v < sizeof(versions) / sizeof(versions[0]); v++) {
+		bench_flow_mod(versions[v]);
+		bench_packet_in(versions[v]);
+		bench_packet_out(versions[v]);
+		bench_flow_stats_reply(versions[v]);
+		bench_port_stats_reply(versions[v]);
+		bench_table_stats_reply(versions[v]);
+		bench_aggr_stats_reply(versions[v]);
+		bench_error(versions[v]);
+	}
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
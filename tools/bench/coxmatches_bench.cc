@@ -0,0 +1,138 @@
+/*
+ * coxmatches_bench.cc
+ *
+ * Microbenchmark for rofl::openflow::coxmatches with typical OpenFlow 1.3
+ * matches of 5, 10 and 15 OXM TLVs: building a match, pack, unpack into
+ * a reused and a fresh instance, copy and comparison via contains() and
+ * is_part_of().
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <vector>
+
+#include "rofl/common/openflow/coxmatches.h"
+
+namespace {
+
+static size_t const NUM_OPS = 200000;
+
+double
+now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void
+report(const char* op, unsigned int num_fields, double elapsed)
+{
+	fprintf(stdout, "bench=coxmatches op=%s fields=%u ops=%lu ns_per_op=%.1f\n",
+			op, num_fields, (unsigned long)NUM_OPS, elapsed * 1e9 / (double)NUM_OPS);
+}
+
+/*
+ * Adds the first num_fields OXM TLVs of an IPv4/TCP flow-mod match, in the
+ * order a controller application usually sets them.
+ */
+void
+build(rofl::openflow::coxmatches& matches, unsigned int num_fields, uint32_t seed)
+{
+	using namespace rofl::openflow;
+	for (unsigned int i = 0; i < num_fields; i++) {
+		switch (i) {
+		case 0:  matches.add_match(coxmatch_ofb_in_port(seed)); break;
+		case 1:  matches.add_match(coxmatch_ofb_eth_type(0x0800)); break;
+		case 2:  matches.add_match(coxmatch_ofb_ipv4_dst(0x0a000000 + seed, 0xffffff00)); break;
+		case 3:  matches.add_match(coxmatch_ofb_ip_proto(6)); break;
+		case 4:  matches.add_match(coxmatch_ofb_tcp_dst(80)); break;
+		case 5:  matches.add_match(coxmatch_ofb_eth_dst(rofl::cmacaddr("00:11:22:33:44:55"))); break;
+		case 6:  matches.add_match(coxmatch_ofb_eth_src(rofl::cmacaddr("00:66:77:88:99:aa"))); break;
+		case 7:  matches.add_match(coxmatch_ofb_vlan_vid(100)); break;
+		case 8:  matches.add_match(coxmatch_ofb_ipv4_src(0xc0a80000 + seed)); break;
+		case 9:  matches.add_match(coxmatch_ofb_tcp_src(1024 + (seed % 1000))); break;
+		case 10: matches.add_match(coxmatch_ofb_metadata(seed, 0xffffffff)); break;
+		case 11: matches.add_match(coxmatch_ofb_vlan_pcp(3)); break;
+		case 12: matches.add_match(coxmatch_ofb_ip_dscp(10)); break;
+		case 13: matches.add_match(coxmatch_ofb_ip_ecn(1)); break;
+		case 14: matches.add_match(coxmatch_ofb_tunnel_id(seed)); break;
+		}
+	}
+}
+
+void
+run(unsigned int num_fields)
+{
+	rofl::openflow::coxmatches matches;
+	build(matches, num_fields, 1);
+	std::vector<uint8_t> buf(matches.length());
+	uint16_t exact = 0, wildcard = 0, missed = 0;
+	size_t sum = 0;
+
+	double start = now();
+	for (size_t i = 0; i < NUM_OPS; i++) {
+		rofl::openflow::coxmatches oxms;
+		build(oxms, num_fields, i);
+		sum += oxms.length();
+	}
+	report("build", num_fields, now() - start);
+
+	start = now();
+	for (size_t i = 0; i < NUM_OPS; i++) {
+		matches.pack(&buf[0], buf.size());
+	}
+	report("pack", num_fields, now() - start);
+
+	rofl::openflow::coxmatches unpacked;
+	start = now();
+	for (size_t i = 0; i < NUM_OPS; i++) {
+		unpacked.unpack(&buf[0], buf.size());
+	}
+	report("unpack", num_fields, now() - start);
+
+	// as done when parsing a received message
+	start = now();
+	for (size_t i = 0; i < NUM_OPS; i++) {
+		rofl::openflow::coxmatches fresh;
+		fresh.unpack(&buf[0], buf.size());
+		sum += fresh.length();
+	}
+	report("unpack_fresh", num_fields, now() - start);
+
+	start = now();
+	for (size_t i = 0; i < NUM_OPS; i++) {
+		rofl::openflow::coxmatches copy(matches);
+		sum += copy.length();
+	}
+	report("copy", num_fields, now() - start);
+
+	start = now();
+	for (size_t i = 0; i < NUM_OPS; i++) {
+		sum += unpacked.contains(matches, true);
+	}
+	report("contains", num_fields, now() - start);
+
+	start = now();
+	for (size_t i = 0; i < NUM_OPS; i++) {
+		sum += unpacked.is_part_of(matches, exact, wildcard, missed);
+	}
+	report("is_part_of", num_fields, now() - start);
+
+	if (0 == sum)
+		fprintf(stderr, "unexpected result\n");
+}
+
+}; // end of anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+	run(5);
+	run(10);
+	run(15);
+
+	return EXIT_SUCCESS;
+}
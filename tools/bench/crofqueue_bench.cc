@@ -0,0 +1,146 @@
+/*
+ * crofqueue_bench.cc
+ *
+ * Microbenchmark for rofl::crofqueue: N producer threads store messages,
+ * a single consumer thread retrieves them. The lock-free ring is compared
+ * against the former std::list based queue guarded by a PthreadRwLock.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sched.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <list>
+#include <vector>
+
+#include "rofl/common/crofqueue.h"
+#include "rofl/common/thread_helper.h"
+#include "rofl/common/openflow/messages/cofmsg_echo.h"
+
+namespace {
+
+/*
+ * reference implementation: crofqueue as of rofl-common v0.6
+ */
+class crofqueue_locked {
+public:
+	bool
+	empty() {
+		rofl::RwLock rwlock(queuelock, rofl::RwLock::RWLOCK_READ);
+		return queue.empty();
+	};
+	size_t
+	store(rofl::openflow::cofmsg* msg) {
+		rofl::RwLock rwlock(queuelock, rofl::RwLock::RWLOCK_WRITE);
+		queue.push_back(msg);
+		return queue.size();
+	};
+	rofl::openflow::cofmsg*
+	retrieve() {
+		rofl::RwLock rwlock(queuelock, rofl::RwLock::RWLOCK_WRITE);
+		if (queue.empty())
+			return NULL;
+		rofl::openflow::cofmsg* msg = queue.front(); queue.pop_front();
+		return msg;
+	};
+private:
+	std::list<rofl::openflow::cofmsg*> 	queue;
+	rofl::PthreadRwLock					queuelock;
+};
+
+static size_t const NUM_MSGS_PER_PRODUCER = 1000000;
+
+template<class Q>
+struct bench_ctx {
+	Q*							queue;
+	rofl::openflow::cofmsg*		msg;
+	size_t						num_msgs;
+	volatile size_t				full;
+};
+
+double
+now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+template<class Q>
+void*
+producer(void* arg)
+{
+	bench_ctx<Q>* ctx = (bench_ctx<Q>*)arg;
+	for (size_t i = 0; i < ctx->num_msgs; i++) {
+		while (true) {
+			try {
+				ctx->queue->store(ctx->msg);
+				break;
+			} catch (rofl::eRofQueueFull& e) {
+				ctx->full++;
+				sched_yield();
+			}
+		}
+	}
+	return NULL;
+}
+
+template<class Q>
+void
+run(const char* name, Q& queue, unsigned int num_producers)
+{
+	rofl::openflow::cofmsg_echo_request msg(rofl::openflow13::OFP_VERSION, 0);
+	std::vector<pthread_t> tids(num_producers);
+	std::vector< bench_ctx<Q> > ctxs(num_producers);
+
+	size_t total = num_producers * NUM_MSGS_PER_PRODUCER;
+	size_t rcvd = 0;
+
+	double start = now();
+
+	for (unsigned int i = 0; i < num_producers; i++) {
+		ctxs[i].queue = &queue;
+		ctxs[i].msg = &msg;
+		ctxs[i].num_msgs = NUM_MSGS_PER_PRODUCER;
+		ctxs[i].full = 0;
+		pthread_create(&tids[i], NULL, producer<Q>, &ctxs[i]);
+	}
+
+	while (rcvd < total) {
+		if (queue.retrieve() != NULL) {
+			rcvd++;
+		}
+	}
+
+	double elapsed = now() - start;
+
+	size_t full = 0;
+	for (unsigned int i = 0; i < num_producers; i++) {
+		pthread_join(tids[i], NULL);
+		full += ctxs[i].full;
+	}
+
+	fprintf(stdout, "bench=crofqueue impl=%s producers=%u msgs=%lu ns_per_msg=%.1f mmsgs_per_sec=%.2f full=%lu\n",
+			name, num_producers, (unsigned long)total,
+			elapsed * 1e9 / (double)total, (double)total / elapsed / 1e6, (unsigned long)full);
+}
+
+}; // end of anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+	unsigned int producers[] = { 1, 2, 4 };
+
+	for (unsigned int i = 0; i < sizeof(producers) / sizeof(producers[0]); i++) {
+		crofqueue_locked locked;
+		run("locked", locked, producers[i]);
+
+		rofl::crofqueue ring(65536);
+		run("ring", ring, producers[i]);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,274 @@
+/*
+ * csocket_bench.cc
+ *
+ * Compares the epoll and io_uring backends of rofl::cioloop with 1k
+ * TCP connections on localhost. Each connection is served by a
+ * rofl::csocket_plain instance in a single loop thread echoing all
+ * received data. The benchmark driver writes a small message on a number
+ * of active connections per round and waits until all of them have been
+ * echoed, ns_per_op is the time per echoed message.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+
+#include <vector>
+
+#include "rofl/common/ciosrv.h"
+#include "rofl/common/csocket_plain.h"
+
+namespace {
+
+static size_t const NUM_CONNS = 1000;
+static size_t const MSG_SIZE = 64;
+
+double
+now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+const char*
+backend_name(enum rofl::cioloop::cioloop_backend_t backend)
+{
+	return (rofl::cioloop::BACKEND_IO_URING == backend) ? "io_uring" : "epoll";
+}
+
+/*
+ * echoes all data received and terminates its loop when all peers have closed
+ */
+class echo_env : public rofl::csocket_env {
+public:
+	echo_env() :
+		num_closed(0)
+	{};
+	virtual
+	~echo_env()
+	{};
+	virtual void
+	handle_read(rofl::csocket& socket) {
+		uint8_t buf[4096];
+		while (not socket.write_would_block()) {
+			ssize_t rc = 0;
+			try {
+				rc = socket.recv(buf, sizeof(buf));
+			} catch (rofl::eSocketRxAgain& e) {
+				return;
+			} catch (rofl::eSysCall& e) {
+				return;
+			}
+			try {
+				socket.send(new rofl::cmemory(buf, rc));
+			} catch (rofl::eSocketTxAgain& e) {
+				// queued
+			}
+			if ((size_t)rc < sizeof(buf))
+				return;
+		}
+	};
+	virtual void
+	handle_write(rofl::csocket& socket) {
+		if (not socket.write_would_block())
+			handle_read(socket);
+	};
+	virtual void
+	handle_closed(rofl::csocket& socket) {
+		if (++num_closed == NUM_CONNS)
+			rofl::cioloop::get_loop().stop();
+	};
+	virtual void handle_listen(rofl::csocket& socket, int newsd) {};
+	virtual void handle_accepted(rofl::csocket& socket) {};
+	virtual void handle_accept_refused(rofl::csocket& socket) {};
+	virtual void handle_connected(rofl::csocket& socket) {};
+	virtual void handle_connect_refused(rofl::csocket& socket) {};
+	virtual void handle_connect_failed(rofl::csocket& socket) {};
+
+	size_t	num_closed;
+};
+
+struct echo_thread {
+	std::vector<int>						sds;
+	enum rofl::cioloop::cioloop_backend_t	backend;
+	pthread_mutex_t							lock;
+	pthread_cond_t							cond;
+	bool									ready;
+};
+
+void*
+run_echo(void* arg)
+{
+	echo_thread* et = (echo_thread*)arg;
+	echo_env env;
+	std::vector<rofl::csocket_plain*> sockets;
+	for (size_t i = 0; i < et->sds.size(); i++) {
+		rofl::csocket_plain* socket = new rofl::csocket_plain(&env);
+		socket->accept(rofl::csocket_plain::get_default_params(), et->sds[i]);
+		sockets.push_back(socket);
+	}
+
+	pthread_mutex_lock(&et->lock);
+	et->backend = rofl::cioloop::get_loop().get_backend();
+	et->ready = true;
+	pthread_cond_signal(&et->cond);
+	pthread_mutex_unlock(&et->lock);
+
+	rofl::cioloop::get_loop().run();
+
+	for (size_t i = 0; i < sockets.size(); i++) {
+		delete sockets[i];
+	}
+	return NULL;
+}
+
+/*
+ * opens NUM_CONNS connections on localhost, returns client and server descriptors
+ */
+void
+open_conns(std::vector<int>& clients, std::vector<int>& servers)
+{
+	int lsd = socket(AF_INET, SOCK_STREAM, 0);
+	struct sockaddr_in sin;
+	memset(&sin, 0, sizeof(sin));
+	sin.sin_family = AF_INET;
+	sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	sin.sin_port = 0;
+	socklen_t salen = sizeof(sin);
+	if ((bind(lsd, (struct sockaddr*)&sin, sizeof(sin)) < 0) ||
+			(listen(lsd, NUM_CONNS) < 0) ||
+			(getsockname(lsd, (struct sockaddr*)&sin, &salen) < 0)) {
+		perror("listen");
+		exit(EXIT_FAILURE);
+	}
+	for (size_t i = 0; i < NUM_CONNS; i++) {
+		int csd = socket(AF_INET, SOCK_STREAM, 0);
+		int optval = 1;
+		if ((csd < 0) || (connect(csd, (struct sockaddr*)&sin, sizeof(sin)) < 0)) {
+			perror("connect");
+			exit(EXIT_FAILURE);
+		}
+		setsockopt(csd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+		int ssd = accept(lsd, NULL, NULL);
+		if (ssd < 0) {
+			perror("accept");
+			exit(EXIT_FAILURE);
+		}
+		setsockopt(ssd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+		clients.push_back(csd);
+		servers.push_back(ssd);
+	}
+	close(lsd);
+}
+
+/*
+ * writes a message on active connections per round, waits for all echoes
+ */
+void
+run(enum rofl::cioloop::cioloop_backend_t backend, const size_t* active, const size_t* rounds, size_t num)
+{
+	std::vector<int> clients;
+	echo_thread et;
+	open_conns(clients, et.sds);
+	et.backend = backend;
+	et.ready = false;
+	pthread_mutex_init(&et.lock, NULL);
+	pthread_cond_init(&et.cond, NULL);
+
+	// loop of the new thread is created with this backend
+	rofl::cioloop::set_default_backend(backend);
+
+	pthread_t tid;
+	if (pthread_create(&tid, NULL, &run_echo, &et) != 0) {
+		perror("pthread_create");
+		exit(EXIT_FAILURE);
+	}
+	pthread_mutex_lock(&et.lock);
+	while (not et.ready) {
+		pthread_cond_wait(&et.cond, &et.lock);
+	}
+	pthread_mutex_unlock(&et.lock);
+
+	int epfd = epoll_create1(EPOLL_CLOEXEC);
+	for (size_t i = 0; i < clients.size(); i++) {
+		struct epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.fd = clients[i];
+		epoll_ctl(epfd, EPOLL_CTL_ADD, clients[i], &ev);
+	}
+
+	uint8_t msg[MSG_SIZE];
+	memset(msg, 0xa5, sizeof(msg));
+	uint8_t buf[4096];
+	std::vector<struct epoll_event> events(NUM_CONNS);
+
+	for (size_t k = 0; k < num; k++) {
+		size_t echoed = 0;
+		double t = now();
+		for (size_t round = 0; round < rounds[k]; round++) {
+			for (size_t i = 0; i < active[k]; i++) {
+				if (write(clients[(i * NUM_CONNS) / active[k]], msg, sizeof(msg)) != (ssize_t)sizeof(msg)) {
+					perror("write");
+					exit(EXIT_FAILURE);
+				}
+			}
+			size_t pending = active[k] * MSG_SIZE;
+			while (pending > 0) {
+				int n = epoll_wait(epfd, &events[0], events.size(), 5000);
+				if (n <= 0) {
+					fprintf(stderr, "csocket_bench: echo timed out\n");
+					exit(EXIT_FAILURE);
+				}
+				for (int j = 0; j < n; j++) {
+					ssize_t rc = read(events[j].data.fd, buf, sizeof(buf));
+					if (rc > 0)
+						pending -= rc;
+				}
+			}
+			echoed += active[k];
+		}
+		fprintf(stdout, "bench=csocket op=echo backend=%s conns=%lu active=%lu ops=%lu ns_per_op=%.1f\n",
+				backend_name(et.backend), (unsigned long)NUM_CONNS, (unsigned long)active[k],
+				(unsigned long)echoed, (now() - t) * 1e9 / (double)echoed);
+	}
+
+	close(epfd);
+	for (size_t i = 0; i < clients.size(); i++) {
+		close(clients[i]);
+	}
+	pthread_join(tid, NULL);
+	rofl::cioloop::drop_loop(tid);
+	pthread_mutex_destroy(&et.lock);
+	pthread_cond_destroy(&et.cond);
+}
+
+}; // end of anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+	struct rlimit rlim;
+	if ((getrlimit(RLIMIT_NOFILE, &rlim) == 0) && (rlim.rlim_cur < 2 * NUM_CONNS + 64)) {
+		rlim.rlim_cur = (rlim.rlim_max < 2 * NUM_CONNS + 64) ? rlim.rlim_max : 2 * NUM_CONNS + 64;
+		setrlimit(RLIMIT_NOFILE, &rlim);
+	}
+
+	// single busy connection among many idle ones, some and all connections busy
+	size_t const active[] = { 1, 100, NUM_CONNS };
+	size_t const rounds[] = { 20000, 500, 100 };
+
+	run(rofl::cioloop::BACKEND_EPOLL, active, rounds, 3);
+	run(rofl::cioloop::BACKEND_IO_URING, active, rounds, 3);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,258 @@
+/*
+ * csocket_openssl_bench.cc
+ *
+ * Compares the transmit path of rofl::csocket_openssl with rofl::csocket_plain
+ * on a single TCP connection on localhost. The server socket runs in its own
+ * loop thread and sends a burst of small messages, e.g., flow-mods or
+ * multipart replies, whenever the client driver asks for it with a single
+ * byte. The driver waits for the complete burst before asking for the next
+ * one, ns_per_op is the time per message received. Each message is filled
+ * with its sequence number, the driver verifies the order of all messages.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <string>
+
+#include "rofl/common/ciosrv.h"
+#include "rofl/common/csocket_plain.h"
+#include "rofl/common/csocket_openssl.h"
+#include "ssl_cert_helper.h"
+
+namespace {
+
+static size_t const MSG_SIZE = 64;
+static size_t const NUM_BURSTS = 4;
+static size_t const BURSTS[NUM_BURSTS] = { 1, 16, 128, 1024 };
+static size_t const ROUNDS[NUM_BURSTS] = { 20000, 4000, 1000, 200 };
+
+double
+now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void
+fail(const char* msg)
+{
+	fprintf(stderr, "csocket_openssl_bench: %s\n", msg);
+	ERR_print_errors_fp(stderr);
+	exit(EXIT_FAILURE);
+}
+
+/*
+ * sends BURSTS[i] messages for each byte i received, stops its loop when the peer has closed
+ */
+class burst_env : public rofl::csocket_env {
+public:
+	burst_env() :
+		seqno(0)
+	{};
+	virtual
+	~burst_env()
+	{};
+	virtual void
+	handle_read(rofl::csocket& socket) {
+		uint8_t buf[64];
+		while (true) {
+			ssize_t rc = 0;
+			try {
+				rc = socket.recv(buf, sizeof(buf));
+			} catch (rofl::eSocketRxAgain& e) {
+				return;
+			} catch (rofl::RoflException& e) {
+				rofl::cioloop::get_loop().stop();
+				return;
+			}
+			if (rc <= 0) {
+				return;
+			}
+			for (ssize_t j = 0; j < rc; j++) {
+				for (size_t i = 0; i < BURSTS[buf[j] % NUM_BURSTS]; i++) {
+					rofl::cmemory* mem = new rofl::cmemory(MSG_SIZE);
+					memset(mem->somem(), (uint8_t)seqno++, MSG_SIZE);
+					try {
+						socket.send(mem);
+					} catch (rofl::eSocketTxAgain& e) {
+						// queued
+					}
+				}
+			}
+		}
+	};
+	virtual void
+	handle_closed(rofl::csocket& socket) {
+		rofl::cioloop::get_loop().stop();
+	};
+	virtual void handle_write(rofl::csocket& socket) {};
+	virtual void handle_listen(rofl::csocket& socket, int newsd) {};
+	virtual void handle_accepted(rofl::csocket& socket) {};
+	virtual void handle_accept_refused(rofl::csocket& socket) {
+		rofl::cioloop::get_loop().stop();
+	};
+	virtual void handle_connected(rofl::csocket& socket) {};
+	virtual void handle_connect_refused(rofl::csocket& socket) {};
+	virtual void handle_connect_failed(rofl::csocket& socket) {};
+
+	size_t	seqno;
+};
+
+struct server_thread {
+	int				sd;
+	bool			tls;
+	rofl::cparams	params;
+};
+
+void*
+run_server(void* arg)
+{
+	server_thread* st = (server_thread*)arg;
+	burst_env env;
+	rofl::csocket* socket = NULL;
+	if (st->tls) {
+		socket = new rofl::csocket_openssl(&env);
+	} else {
+		socket = new rofl::csocket_plain(&env);
+	}
+	socket->accept(st->params, st->sd);
+
+	rofl::cioloop::get_loop().run();
+
+	delete socket;
+	return NULL;
+}
+
+/*
+ * opens a TCP connection on localhost, returns client and server descriptors
+ */
+void
+open_conn(int& csd, int& ssd)
+{
+	int lsd = socket(AF_INET, SOCK_STREAM, 0);
+	struct sockaddr_in sin;
+	memset(&sin, 0, sizeof(sin));
+	sin.sin_family = AF_INET;
+	sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	sin.sin_port = 0;
+	socklen_t salen = sizeof(sin);
+	if ((bind(lsd, (struct sockaddr*)&sin, sizeof(sin)) < 0) ||
+			(listen(lsd, 1) < 0) ||
+			(getsockname(lsd, (struct sockaddr*)&sin, &salen) < 0)) {
+		perror("listen");
+		exit(EXIT_FAILURE);
+	}
+	int optval = 1;
+	if (((csd = socket(AF_INET, SOCK_STREAM, 0)) < 0) ||
+			(connect(csd, (struct sockaddr*)&sin, sizeof(sin)) < 0)) {
+		perror("connect");
+		exit(EXIT_FAILURE);
+	}
+	setsockopt(csd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+	if ((ssd = accept(lsd, NULL, NULL)) < 0) {
+		perror("accept");
+		exit(EXIT_FAILURE);
+	}
+	setsockopt(ssd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+	close(lsd);
+}
+
+void
+run(bool tls, const std::string& certfile, const std::string& keyfile)
+{
+	server_thread st;
+	int csd = -1;
+	open_conn(csd, st.sd);
+	st.tls = tls;
+	if (tls) {
+		st.params = rofl::csocket_openssl::get_default_params();
+		st.params.set_param(rofl::csocket::PARAM_SSL_KEY_CA_FILE).set_string(certfile);
+		st.params.set_param(rofl::csocket::PARAM_SSL_KEY_CERT).set_string(certfile);
+		st.params.set_param(rofl::csocket::PARAM_SSL_KEY_PRIVATE_KEY).set_string(keyfile);
+		st.params.set_param(rofl::csocket::PARAM_SSL_KEY_VERIFY_MODE).set_string("NONE");
+		st.params.set_param(rofl::csocket::PARAM_SSL_KEY_CIPHERS).set_string("");
+	} else {
+		st.params = rofl::csocket_plain::get_default_params();
+	}
+
+	pthread_t tid;
+	if (pthread_create(&tid, NULL, &run_server, &st) != 0) {
+		perror("pthread_create");
+		exit(EXIT_FAILURE);
+	}
+
+	SSL_CTX* ctx = NULL;
+	SSL* ssl = NULL;
+	if (tls) {
+		if ((ctx = SSL_CTX_new(SSLv23_client_method())) == NULL)
+			fail("SSL_CTX_new failed");
+		SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, NULL);
+		ssl = SSL_new(ctx);
+		SSL_set_fd(ssl, csd);
+		if (SSL_connect(ssl) != 1)
+			fail("SSL_connect failed");
+	}
+
+	uint8_t buf[16384];
+	size_t offset = 0;
+	for (size_t k = 0; k < NUM_BURSTS; k++) {
+		double t = now();
+		for (size_t round = 0; round < ROUNDS[k]; round++) {
+			uint8_t token = k;
+			if ((tls ? SSL_write(ssl, &token, 1) : write(csd, &token, 1)) != 1)
+				fail("write failed");
+			size_t pending = BURSTS[k] * MSG_SIZE;
+			while (pending > 0) {
+				int rc = tls ? SSL_read(ssl, buf, sizeof(buf)) : read(csd, buf, sizeof(buf));
+				if (rc <= 0)
+					fail("read failed");
+				for (int i = 0; i < rc; i++, offset++) {
+					if (buf[i] != (uint8_t)(offset / MSG_SIZE))
+						fail("messages out of order");
+				}
+				pending -= rc;
+			}
+		}
+		fprintf(stdout, "bench=csocket_openssl op=send transport=%s msg_size=%lu burst=%lu ops=%lu ns_per_op=%.1f\n",
+				tls ? "tls" : "plain", (unsigned long)MSG_SIZE, (unsigned long)BURSTS[k],
+				(unsigned long)(BURSTS[k] * ROUNDS[k]),
+				(now() - t) * 1e9 / (double)(BURSTS[k] * ROUNDS[k]));
+	}
+
+	if (tls) {
+		SSL_shutdown(ssl);
+		SSL_free(ssl);
+		SSL_CTX_free(ctx);
+	}
+	close(csd);
+	pthread_join(tid, NULL);
+	rofl::cioloop::drop_loop(tid);
+}
+
+}; // end of anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+	std::string certfile, keyfile;
+	if (not create_self_signed_cert("csocket_openssl_bench", certfile, keyfile))
+		fail("certificate generation failed");
+
+	run(false, certfile, keyfile);
+	run(true, certfile, keyfile);
+
+	unlink(certfile.c_str());
+	unlink(keyfile.c_str());
+
+	return EXIT_SUCCESS;
+}
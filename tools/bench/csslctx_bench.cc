@@ -0,0 +1,164 @@
+/*
+ * csslctx_bench.cc
+ *
+ * Reconnect storm against rofl::csslctx: runs a number of TLS handshakes
+ * with mutual authentication (RSA 2048, self-signed) between a client and
+ * a server SSL object connected via a BIO pair within a single thread.
+ * Compares a context created per connection (certificate and key files
+ * parsed for every connection, as csocket_openssl did before), a shared
+ * context with full handshakes and a shared context with session
+ * resumption. ns_per_op is the time per connection incl. both peers.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "rofl/common/csslctx.h"
+#include "ssl_cert_helper.h"
+
+namespace {
+
+static size_t const NUM_CONNS = 500;
+
+double
+now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void
+fail(const char* msg)
+{
+	fprintf(stderr, "csslctx_bench: %s\n", msg);
+	ERR_print_errors_fp(stderr);
+	exit(EXIT_FAILURE);
+}
+
+/*
+ * handshake via a BIO pair, the server sends a single byte afterwards
+ * for delivering TLS 1.3 session tickets, returns true when resumed
+ */
+bool
+connect_once(rofl::csslctx* sslctx, const std::string& peer)
+{
+	SSL* client = SSL_new(sslctx->get_ssl_ctx());
+	SSL* server = SSL_new(sslctx->get_ssl_ctx());
+	BIO* cbio = NULL;
+	BIO* sbio = NULL;
+	if (!BIO_new_bio_pair(&cbio, 0, &sbio, 0))
+		fail("BIO_new_bio_pair failed");
+	SSL_set_bio(client, cbio, cbio);
+	SSL_set_bio(server, sbio, sbio);
+	SSL_set_connect_state(client);
+	SSL_set_accept_state(server);
+	sslctx->prepare_client(client, peer);
+
+	bool client_done = false, server_done = false;
+	while (not (client_done && server_done)) {
+		int rc;
+		if (not client_done) {
+			if ((rc = SSL_do_handshake(client)) == 1)
+				client_done = true;
+			else if (SSL_get_error(client, rc) != SSL_ERROR_WANT_READ)
+				fail("client handshake failed");
+		}
+		if (not server_done) {
+			if ((rc = SSL_do_handshake(server)) == 1)
+				server_done = true;
+			else if (SSL_get_error(server, rc) != SSL_ERROR_WANT_READ)
+				fail("server handshake failed");
+		}
+	}
+	char c = 'x';
+	if ((SSL_write(server, &c, 1) != 1) || (SSL_read(client, &c, 1) != 1))
+		fail("data exchange failed");
+
+	bool reused = SSL_session_reused(client);
+	SSL_shutdown(client);
+	SSL_shutdown(server);
+	SSL_free(client);
+	SSL_free(server);
+	return reused;
+}
+
+enum bench_mode_t {
+	MODE_PER_CONNECTION,
+	MODE_SHARED,
+	MODE_RESUMED,
+};
+
+void
+run(const rofl::csslctx::ckey& key, enum bench_mode_t mode)
+{
+	static const char* names[] = { "per_connection_ctx", "shared_ctx", "shared_ctx_resumed" };
+
+	rofl::csslctx* shared = NULL;
+	if (MODE_PER_CONNECTION != mode) {
+		shared = rofl::csslctx::acquire(key);
+		// initial full handshake storing the peer's session
+		connect_once(shared, "127.0.0.1:6653");
+	}
+
+	size_t resumed = 0;
+	double t = now();
+	for (size_t i = 0; i < NUM_CONNS; i++) {
+		switch (mode) {
+		case MODE_PER_CONNECTION: {
+			rofl::csslctx* sslctx = rofl::csslctx::acquire(key);
+			resumed += connect_once(sslctx, "");
+			rofl::csslctx::release(sslctx);
+			rofl::csslctx::purge();
+		} break;
+		case MODE_SHARED: {
+			resumed += connect_once(shared, "");
+		} break;
+		case MODE_RESUMED: {
+			resumed += connect_once(shared, "127.0.0.1:6653");
+		} break;
+		}
+	}
+	double dt = now() - t;
+
+	fprintf(stdout, "bench=csslctx op=handshake mode=%s conns=%lu resumed=%lu ns_per_op=%.1f\n",
+			names[mode], (unsigned long)NUM_CONNS, (unsigned long)resumed,
+			dt * 1e9 / (double)NUM_CONNS);
+
+	rofl::csslctx::release(shared);
+	rofl::csslctx::purge();
+}
+
+}; // end of anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+	std::string certfile, keyfile;
+	if (not create_self_signed_cert("csslctx_bench", certfile, keyfile))
+		fail("certificate generation failed");
+
+	rofl::csslctx::ckey key;
+	key.cafile = certfile;
+	key.certfile = certfile;
+	key.keyfile = keyfile;
+	key.verify_mode = "PEER";
+	key.verify_depth = "1";
+
+	try {
+		run(key, MODE_PER_CONNECTION);
+		run(key, MODE_SHARED);
+		run(key, MODE_RESUMED);
+	} catch (rofl::eOpenSSL& e) {
+		fail("unable to create SSL context");
+	}
+
+	unlink(certfile.c_str());
+	unlink(keyfile.c_str());
+
+	return EXIT_SUCCESS;
+}
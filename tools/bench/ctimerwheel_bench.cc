@@ -0,0 +1,137 @@
+/*
+ * ctimerwheel_bench.cc
+ *
+ * Microbenchmark for timer management with 100k active timers: add,
+ * reset and cancel by rofl::ctimerid and expiry processing. The loop-wide
+ * rofl::ctimerwheel is compared against the former per ciosrv
+ * rofl::ctimers multiset, whose reset and cancel operations search
+ * linearly for the timer id. Expiry is measured for the wheel only, as
+ * rofl::ctimers depends on the wall clock.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <vector>
+
+#include "rofl/common/ctimers.h"
+#include "rofl/common/ctimerwheel.h"
+
+namespace {
+
+static size_t const NUM_TIMERS = 100000;
+
+class timer_env : public rofl::ctimer_env {};
+
+double
+now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+rofl::ctimespec
+timeout(size_t i)
+{
+	// spread timers over 1-60 seconds, like echo and transaction timers
+	long ms = 1000 + (i * 7919) % 59000;
+	return rofl::ctimespec(ms / 1000, (ms % 1000) * 1000000);
+}
+
+void
+report(const char* impl, const char* op, size_t num_ops, double elapsed)
+{
+	fprintf(stdout, "bench=timers impl=%s op=%s timers=%lu ops=%lu ns_per_op=%.1f\n",
+			impl, op, (unsigned long)NUM_TIMERS, (unsigned long)num_ops,
+			elapsed * 1e9 / (double)num_ops);
+}
+
+void
+run_ctimers(size_t num_lookups)
+{
+	timer_env env;
+	rofl::ctimers timers;
+	std::vector<rofl::ctimerid> tids;
+	tids.reserve(NUM_TIMERS);
+
+	double start = now();
+	for (size_t i = 0; i < NUM_TIMERS; i++) {
+		tids.push_back(timers.add_timer(rofl::ctimer(&env, i, timeout(i))));
+	}
+	report("ctimers", "add", NUM_TIMERS, now() - start);
+
+	// random picks, reset() creates a new timer handle
+	start = now();
+	for (size_t i = 0; i < num_lookups; i++) {
+		size_t j = (i * 104729) % NUM_TIMERS;
+		tids[j] = timers.reset(tids[j], timeout(i + 1));
+	}
+	report("ctimers", "reset", num_lookups, now() - start);
+
+	start = now();
+	for (size_t i = 0; i < num_lookups; i++) {
+		timers.cancel(tids[(i * 104729) % NUM_TIMERS]);
+	}
+	report("ctimers", "cancel", num_lookups, now() - start);
+}
+
+void
+run_ctimerwheel(size_t num_lookups)
+{
+	timer_env env;
+	rofl::ctimerwheel wheel;
+	std::vector<rofl::ctimerid> tids;
+	tids.reserve(NUM_TIMERS);
+
+	double start = now();
+	for (size_t i = 0; i < NUM_TIMERS; i++) {
+		tids.push_back(wheel.add_timer(rofl::ctimer(&env, i, timeout(i))));
+	}
+	report("ctimerwheel", "add", NUM_TIMERS, now() - start);
+
+	start = now();
+	for (size_t i = 0; i < num_lookups; i++) {
+		size_t j = (i * 104729) % NUM_TIMERS;
+		tids[j] = wheel.reset(tids[j], timeout(i + 1));
+	}
+	report("ctimerwheel", "reset", num_lookups, now() - start);
+
+	start = now();
+	for (size_t i = 0; i < num_lookups; i++) {
+		wheel.cancel(tids[(i * 104729) % NUM_TIMERS]);
+	}
+	report("ctimerwheel", "cancel", num_lookups, now() - start);
+
+	// expire all remaining timers by advancing the wheel in steps of 10ms, i.e., one wakeup per step
+	size_t num_expired = 0;
+	size_t num_wakeups = 0;
+	rofl::ctimespec t = rofl::ctimespec::now();
+	start = now();
+	while (wheel.size() > 0) {
+		t += rofl::ctimespec(0, 10000000);
+		wheel.advance(t);
+		num_wakeups++;
+		rofl::ctimer timer;
+		while (wheel.get_expired_timer(timer)) {
+			num_expired++;
+		}
+	}
+	double elapsed = now() - start;
+	report("ctimerwheel", "expire", num_expired, elapsed);
+	report("ctimerwheel", "wakeup", num_wakeups, elapsed);
+}
+
+}; // end of anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+	// linear search per operation in ctimers: keep the number of operations small
+	run_ctimers(1000);
+	// cancels half of the timers, the remaining ones expire
+	run_ctimerwheel(NUM_TIMERS / 2);
+
+	return EXIT_SUCCESS;
+}
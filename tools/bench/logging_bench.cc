@@ -0,0 +1,72 @@
+/*
+ * logging_bench.cc
+ *
+ * Microbenchmark for disabled debug logging on a message hot path: a
+ * Packet-In is logged at level debug2 while the active debug level is
+ * INFO. Writing to rofl::logging::debug2 directly (impl=stream) formats
+ * the message into /dev/null, the level-checked ROFL_DEBUG2 macro
+ * (impl=macro) skips evaluation of the stream expression entirely.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "rofl/common/logging.h"
+#include "rofl/common/openflow/messages/cofmsg_packet_in.h"
+
+namespace {
+
+static size_t const NUM_MSGS_STREAM = 20000;
+static size_t const NUM_MSGS_MACRO  = 100000000;
+
+double
+now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void
+report(const char* name, size_t num_msgs, double elapsed)
+{
+	fprintf(stdout, "bench=logging impl=%s level=debug2 enabled=%d msgs=%lu ns_per_msg=%.2f\n",
+			name, (int)ROFL_LOG_ENABLED(rofl::logging::DBG2), (unsigned long)num_msgs,
+			elapsed * 1e9 / (double)num_msgs);
+}
+
+}; // end of anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+	rofl::logging::set_debug_level(rofl::logging::INFO);
+
+	uint8_t frame[64];
+	for (unsigned int i = 0; i < sizeof(frame); i++) {
+		frame[i] = i;
+	}
+
+	rofl::openflow::cofmatch match(rofl::openflow13::OFP_VERSION);
+	match.set_in_port(1);
+	match.set_eth_type(0x0800);
+
+	rofl::openflow::cofmsg_packet_in msg(
+			rofl::openflow13::OFP_VERSION, 0x1234, 0xffffffff, sizeof(frame),
+			rofl::openflow13::OFPR_NO_MATCH, 0, 0, 0, match, frame, sizeof(frame));
+
+	double start = now();
+	for (size_t i = 0; i < NUM_MSGS_STREAM; i++) {
+		rofl::logging::debug2 << "[rofl-common][bench] msg:" << std::endl << msg;
+	}
+	report("stream", NUM_MSGS_STREAM, now() - start);
+
+	start = now();
+	for (size_t i = 0; i < NUM_MSGS_MACRO; i++) {
+		ROFL_DEBUG2 << "[rofl-common][bench] msg:" << std::endl << msg;
+	}
+	report("macro", NUM_MSGS_MACRO, now() - start);
+
+	return EXIT_SUCCESS;
+}